@@ -0,0 +1,371 @@
+/* benchmark.c: scripted benchmark runs for the demos
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Drives a window with scripted interactions for a while, and
+ * reports the frame timings the frame clock recorded meanwhile.
+ *
+ * The interactions cycle through phases of PHASE_FRAMES frames each:
+ * scrolling every scrolled window up and down, growing and shrinking
+ * the window, switching the pages of every notebook and stack, and
+ * toggling the dark theme variant.
+ *
+ * The results are printed as tab separated values, one line per run:
+ *
+ *   name  frames  mean  p50  p90  p99  max  dropped  cpu
+ *
+ * where the frame intervals are in microseconds, dropped counts the
+ * refresh cycles that passed without a frame, and cpu is the process
+ * CPU time of the run in milliseconds. Lines starting with # are
+ * comments.
+ */
+
+#include "config.h"
+
+#include "benchmark.h"
+
+#include <time.h>
+
+#define PHASE_FRAMES 60
+
+/* How much the window grows during the resize phase */
+#define RESIZE_DELTA 100
+
+typedef enum {
+  PHASE_SCROLL,
+  PHASE_RESIZE,
+  PHASE_SWITCH_PAGES,
+  PHASE_TOGGLE_THEME,
+  N_PHASES
+} Phase;
+
+typedef struct {
+  GtkWidget *window;
+  GMainLoop *loop;
+  guint tick_id;
+
+  gint64 duration;
+  gint64 start_time;
+  gint frame;
+  gint width;
+  gint height;
+
+  gint64 last_frame;          /* Last frame whose timings were collected */
+  gint64 last_frame_time;
+  GArray *intervals;
+  gint64 dropped;
+} Benchmark;
+
+static void
+collect_widgets (GtkWidget *widget,
+                 gpointer   data)
+{
+  GPtrArray *widgets = data;
+
+  g_ptr_array_add (widgets, widget);
+
+  if (GTK_IS_CONTAINER (widget))
+    gtk_container_forall (GTK_CONTAINER (widget), collect_widgets, widgets);
+}
+
+/* A triangle wave going from 0 to 1 and back once per phase */
+static gdouble
+phase_position (gint step)
+{
+  if (step < PHASE_FRAMES / 2)
+    return 2.0 * step / PHASE_FRAMES;
+  else
+    return 2.0 - 2.0 * step / PHASE_FRAMES;
+}
+
+static void
+scroll_widgets (GPtrArray *widgets,
+                gdouble    position)
+{
+  guint i;
+
+  for (i = 0; i < widgets->len; i++)
+    {
+      GtkAdjustment *adjustment;
+      gdouble lower, upper;
+
+      if (!GTK_IS_SCROLLED_WINDOW (g_ptr_array_index (widgets, i)))
+        continue;
+
+      adjustment = gtk_scrolled_window_get_vadjustment (g_ptr_array_index (widgets, i));
+      lower = gtk_adjustment_get_lower (adjustment);
+      upper = gtk_adjustment_get_upper (adjustment) - gtk_adjustment_get_page_size (adjustment);
+
+      gtk_adjustment_set_value (adjustment, lower + (upper - lower) * position);
+    }
+}
+
+static void
+switch_pages (GPtrArray *widgets)
+{
+  guint i;
+
+  for (i = 0; i < widgets->len; i++)
+    {
+      GtkWidget *widget = g_ptr_array_index (widgets, i);
+
+      if (GTK_IS_NOTEBOOK (widget))
+        {
+          GtkNotebook *notebook = GTK_NOTEBOOK (widget);
+          gint n_pages;
+
+          n_pages = gtk_notebook_get_n_pages (notebook);
+          if (n_pages > 1)
+            gtk_notebook_set_current_page (notebook,
+                                           (gtk_notebook_get_current_page (notebook) + 1) % n_pages);
+        }
+      else if (GTK_IS_STACK (widget))
+        {
+          GList *children, *l;
+
+          children = gtk_container_get_children (GTK_CONTAINER (widget));
+          l = g_list_find (children, gtk_stack_get_visible_child (GTK_STACK (widget)));
+          if (l && l->next)
+            gtk_stack_set_visible_child (GTK_STACK (widget), l->next->data);
+          else if (children)
+            gtk_stack_set_visible_child (GTK_STACK (widget), children->data);
+          g_list_free (children);
+        }
+    }
+}
+
+static void
+toggle_theme (void)
+{
+  GtkSettings *settings = gtk_settings_get_default ();
+  gboolean dark;
+
+  g_object_get (settings, "gtk-application-prefer-dark-theme", &dark, NULL);
+  g_object_set (settings, "gtk-application-prefer-dark-theme", !dark, NULL);
+}
+
+static void
+run_phase (Benchmark *bench)
+{
+  GPtrArray *widgets;
+  gint step;
+
+  step = bench->frame % PHASE_FRAMES;
+
+  widgets = g_ptr_array_new ();
+  collect_widgets (bench->window, widgets);
+
+  switch ((bench->frame / PHASE_FRAMES) % N_PHASES)
+    {
+    case PHASE_SCROLL:
+      scroll_widgets (widgets, phase_position (step));
+      break;
+
+    case PHASE_RESIZE:
+      gtk_window_resize (GTK_WINDOW (bench->window),
+                         bench->width + RESIZE_DELTA * phase_position (step),
+                         bench->height + RESIZE_DELTA * phase_position (step));
+      break;
+
+    case PHASE_SWITCH_PAGES:
+      if (step % 10 == 0)
+        switch_pages (widgets);
+      break;
+
+    case PHASE_TOGGLE_THEME:
+      if (step % 15 == 0)
+        toggle_theme ();
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+
+  g_ptr_array_unref (widgets);
+}
+
+static void
+collect_timings (Benchmark     *bench,
+                 GdkFrameClock *clock)
+{
+  gint64 frame;
+
+  frame = MAX (bench->last_frame + 1, gdk_frame_clock_get_history_start (clock));
+
+  for (; frame < gdk_frame_clock_get_frame_counter (clock); frame++)
+    {
+      GdkFrameTimings *timings;
+      gint64 frame_time, refresh_interval, interval;
+
+      timings = gdk_frame_clock_get_timings (clock, frame);
+      if (timings == NULL || !gdk_frame_timings_get_complete (timings))
+        break;
+
+      bench->last_frame = frame;
+
+      frame_time = gdk_frame_timings_get_presentation_time (timings);
+      if (frame_time == 0)
+        frame_time = gdk_frame_timings_get_frame_time (timings);
+
+      if (bench->last_frame_time != 0)
+        {
+          interval = frame_time - bench->last_frame_time;
+          g_array_append_val (bench->intervals, interval);
+
+          refresh_interval = gdk_frame_timings_get_refresh_interval (timings);
+          if (refresh_interval == 0)
+            refresh_interval = 16667; /* 1/60th of a second */
+
+          if (interval > refresh_interval * 3 / 2)
+            bench->dropped += (interval + refresh_interval / 2) / refresh_interval - 1;
+        }
+
+      bench->last_frame_time = frame_time;
+    }
+}
+
+static gboolean
+benchmark_tick (GtkWidget     *widget,
+                GdkFrameClock *clock,
+                gpointer       data)
+{
+  Benchmark *bench = data;
+  gint64 now;
+
+  now = gdk_frame_clock_get_frame_time (clock);
+
+  /* Frames before the first tick are the window appearing, skip them */
+  if (bench->start_time == 0)
+    {
+      bench->start_time = now;
+      bench->last_frame = gdk_frame_clock_get_frame_counter (clock) - 1;
+      gtk_window_get_size (GTK_WINDOW (widget), &bench->width, &bench->height);
+    }
+  else
+    collect_timings (bench, clock);
+
+  if (now - bench->start_time >= bench->duration)
+    {
+      bench->tick_id = 0;
+      g_main_loop_quit (bench->loop);
+      return G_SOURCE_REMOVE;
+    }
+
+  run_phase (bench);
+  bench->frame++;
+
+  return G_SOURCE_CONTINUE;
+}
+
+static gint
+compare_intervals (gconstpointer a,
+                   gconstpointer b)
+{
+  gint64 ia = *(const gint64 *) a;
+  gint64 ib = *(const gint64 *) b;
+
+  return ia < ib ? -1 : (ia > ib ? 1 : 0);
+}
+
+static gint64
+percentile (GArray  *sorted,
+            gdouble  p)
+{
+  if (sorted->len == 0)
+    return 0;
+
+  return g_array_index (sorted, gint64, MIN (sorted->len - 1, (guint) (p * sorted->len)));
+}
+
+static void
+print_results (Benchmark   *bench,
+               const gchar *name,
+               gdouble      cpu_ms)
+{
+  GArray *intervals = bench->intervals;
+  gint64 total = 0;
+  guint i;
+
+  g_array_sort (intervals, compare_intervals);
+
+  for (i = 0; i < intervals->len; i++)
+    total += g_array_index (intervals, gint64, i);
+
+  g_print ("%s\t%u\t%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT
+           "\t%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT "\t%.1f\n",
+           name, intervals->len,
+           intervals->len ? total / intervals->len : 0,
+           percentile (intervals, 0.5),
+           percentile (intervals, 0.9),
+           percentile (intervals, 0.99),
+           intervals->len ? g_array_index (intervals, gint64, intervals->len - 1) : 0,
+           bench->dropped,
+           cpu_ms);
+}
+
+void
+demo_benchmark_print_header (void)
+{
+  g_print ("# name\tframes\tmean\tp50\tp90\tp99\tmax\tdropped\tcpu\n");
+}
+
+/* Runs the interactions on @window for @seconds and prints a line
+ * of results named @name. Returns %FALSE if the window got destroyed
+ * during the run.
+ */
+gboolean
+demo_benchmark_run (GtkWidget   *window,
+                    const gchar *name,
+                    gdouble      seconds)
+{
+  Benchmark bench = { 0, };
+  GtkSettings *settings;
+  gboolean dark;
+  gulong destroy_id;
+  clock_t cpu_start;
+
+  settings = gtk_settings_get_default ();
+  g_object_get (settings, "gtk-application-prefer-dark-theme", &dark, NULL);
+
+  bench.window = window;
+  bench.loop = g_main_loop_new (NULL, FALSE);
+  bench.duration = seconds * G_USEC_PER_SEC;
+  bench.intervals = g_array_new (FALSE, FALSE, sizeof (gint64));
+
+  g_object_add_weak_pointer (G_OBJECT (window), (gpointer *) &bench.window);
+  destroy_id = g_signal_connect_swapped (window, "destroy",
+                                         G_CALLBACK (g_main_loop_quit), bench.loop);
+  bench.tick_id = gtk_widget_add_tick_callback (window, benchmark_tick, &bench, NULL);
+
+  cpu_start = clock ();
+  g_main_loop_run (bench.loop);
+
+  print_results (&bench, name, (clock () - cpu_start) * 1000.0 / CLOCKS_PER_SEC);
+
+  g_object_set (settings, "gtk-application-prefer-dark-theme", dark, NULL);
+
+  if (bench.window)
+    {
+      if (bench.tick_id)
+        gtk_widget_remove_tick_callback (bench.window, bench.tick_id);
+      g_signal_handler_disconnect (bench.window, destroy_id);
+      g_object_remove_weak_pointer (G_OBJECT (bench.window), (gpointer *) &bench.window);
+    }
+
+  g_array_unref (bench.intervals);
+  g_main_loop_unref (bench.loop);
+
+  return bench.window != NULL;
+}
@@ -0,0 +1,31 @@
+/* benchmark.h: scripted benchmark runs for the demos
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __DEMO_BENCHMARK_H__
+#define __DEMO_BENCHMARK_H__
+
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+void     demo_benchmark_print_header (void);
+gboolean demo_benchmark_run          (GtkWidget   *window,
+                                      const gchar *name,
+                                      gdouble      seconds);
+
+G_END_DECLS
+
+#endif /* __DEMO_BENCHMARK_H__ */
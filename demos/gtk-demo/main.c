@@ -10,6 +10,7 @@
 #include <glib/gstdio.h>
 
 #include "demos.h"
+#include "demos/benchmark.h"
 
 static GtkWidget *info_view;
 static GtkWidget *source_view;
@@ -18,6 +19,15 @@ static gchar *current_file = NULL;
 
 static GtkWidget *notebook;
 
+static gboolean benchmark = FALSE;
+static gdouble benchmark_time = 5.0;
+
+static GOptionEntry entries[] = {
+  { "benchmark", 0, 0, G_OPTION_ARG_NONE, &benchmark, "Run the demos with scripted interactions and print frame statistics", NULL },
+  { "benchmark-time", 0, 0, G_OPTION_ARG_DOUBLE, &benchmark_time, "How long to run each demo", "SECONDS" },
+  { NULL }
+};
+
 enum {
   NAME_COLUMN,
   TITLE_COLUMN,
@@ -898,12 +908,62 @@ setup_default_icon (void)
   g_object_unref (pixbuf);
 }
 
+static gboolean
+benchmark_wanted (Demo   *demo,
+                  gchar **names)
+{
+  gint i;
+
+  /* Printing pops up a print dialog right away */
+  if (names[0] == NULL)
+    return g_strcmp0 (demo->name, "printing") != 0;
+
+  for (i = 0; names[i]; i++)
+    {
+      if (g_strcmp0 (demo->name, names[i]) == 0)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static void
+run_benchmarks (GtkWidget  *do_widget,
+                Demo       *demos,
+                gchar     **names)
+{
+  Demo *d;
+
+  for (d = demos; d->title; d++)
+    {
+      GtkWidget *window;
+
+      if (d->children)
+        run_benchmarks (do_widget, d->children, names);
+
+      if (d->func == NULL || !benchmark_wanted (d, names))
+        continue;
+
+      window = (d->func) (do_widget);
+      if (window == NULL || !GTK_IS_WINDOW (window))
+        continue;
+
+      /* Calling the demo function again closes the demo */
+      if (demo_benchmark_run (window, d->name, benchmark_time))
+        (d->func) (do_widget);
+
+      while (gtk_events_pending ())
+        gtk_main_iteration ();
+    }
+}
+
 int
 main (int argc, char **argv)
 {
   GtkWidget *window;
   GtkWidget *hbox;
   GtkWidget *tree;
+  GError *error = NULL;
 
   /* Most code in gtk-demo is intended to be exemplary, but not
    * these few lines, which are just a hack so gtk-demo will work
@@ -915,7 +975,12 @@ main (int argc, char **argv)
     }
   /* -- End of hack -- */
 
-  gtk_init (&argc, &argv);
+  if (!gtk_init_with_args (&argc, &argv, "[DEMO...]", entries, NULL, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      g_error_free (error);
+      return 1;
+    }
   cgl_set_gtk3_emulation(TRUE);
   
   setup_default_icon ();
@@ -948,6 +1013,13 @@ main (int argc, char **argv)
 
   load_file (gtk_demos[0].name, gtk_demos[0].filename);
 
+  if (benchmark)
+    {
+      demo_benchmark_print_header ();
+      run_benchmarks (window, gtk_demos, argv + 1);
+      return 0;
+    }
+
   gtk_main ();
 
   return 0;
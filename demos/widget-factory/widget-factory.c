@@ -23,6 +23,19 @@
 #include "config.h"
 #include <gtk/gtk.h>
 
+#include "demos/benchmark.h"
+
+static gboolean dark = FALSE;
+static gboolean benchmark = FALSE;
+static gdouble benchmark_time = 20.0;
+
+static GOptionEntry entries[] = {
+  { "dark", 0, 0, G_OPTION_ARG_NONE, &dark, "Use the dark theme variant", NULL },
+  { "benchmark", 0, 0, G_OPTION_ARG_NONE, &benchmark, "Run scripted interactions and print frame statistics", NULL },
+  { "benchmark-time", 0, 0, G_OPTION_ARG_DOUBLE, &benchmark_time, "How long to run the benchmark", "SECONDS" },
+  { NULL }
+};
+
 static void
 dark_toggled (GtkCheckMenuItem *item, gpointer data)
 {
@@ -111,13 +124,15 @@ main (int argc, char *argv[])
   GtkWidget  *window;
   GtkWidget  *widget;
   GtkWidget  *notebook;
-  gboolean    dark = FALSE;
   GtkAdjustment *adj;
+  GError     *error = NULL;
 
-  gtk_init (&argc, &argv);
-
-  if (argc > 1 && (g_strcmp0 (argv[1], "--dark") == 0))
-    dark = TRUE;
+  if (!gtk_init_with_args (&argc, &argv, NULL, entries, NULL, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      g_error_free (error);
+      return 1;
+    }
 
   builder = gtk_builder_new ();
   gtk_builder_add_from_resource (builder, "/ui/widget-factory.ui", NULL);
@@ -152,6 +167,14 @@ main (int argc, char *argv[])
   g_object_unref (G_OBJECT (builder));
 
   gtk_widget_show (window);
+
+  if (benchmark)
+    {
+      demo_benchmark_print_header ();
+      demo_benchmark_run (window, "widget-factory", benchmark_time);
+      return 0;
+    }
+
   gtk_main ();
 
   return 0;
@@ -41,7 +41,7 @@ struct _BroadwayBuffer {
   int width, height, stride;
   int encoded;
   int block_stride, length, block_count, shift;
-  int stats[5];
+  int stats[BROADWAY_BUFFER_N_STATS];
   int clashes;
 };
 
@@ -164,6 +164,8 @@ struct encoder {
  *     - 0x00 2x xx xx 0x xxxx yyyy: block ref, block number x (20 bits) at x, y
  *     - 0x00 3x xx xx 0xaarrggbb : solid color run, length x
  *     - 0x00 4x xx xx 0xaarrggbb : delta run, length x
+ *     - 0x00 5x xx xx xxxx yyyy xxxx yyyy wwww hhhh : copy from the
+ *       previous frame, only at the start of the stream
  *
  */
 
@@ -298,6 +300,17 @@ broadway_buffer_get_height (BroadwayBuffer *buffer)
   return buffer->height;
 }
 
+/* Fills in how many blocks went into hash chains of each length, and
+ * how often a hash matched a block with different contents. */
+void
+broadway_buffer_get_stats (BroadwayBuffer *buffer,
+                           int            *stats,
+                           int            *clashes)
+{
+  memcpy (stats, buffer->stats, sizeof buffer->stats);
+  *clashes = buffer->clashes;
+}
+
 static void
 unpremultiply_line (void *destp, void *srcp, int width)
 {
@@ -358,8 +371,105 @@ broadway_buffer_create (int width, int height, guint8 *data, int stride)
   return buffer;
 }
 
+/* Finds the columns that changed since @prev, for every band of
+ * block_size rows starting at each row. damage_x0[y] > damage_x1[y]
+ * means that nothing changed in the rows y to y + block_size - 1.
+ * @prev_data is what the client has of @prev, which may differ from
+ * @prev itself by a scroll.
+ * Returns FALSE if the buffers can't be compared.
+ */
+static gboolean
+compute_damage (BroadwayBuffer *buffer, BroadwayBuffer *prev,
+                guint8 *prev_data, int *damage_x0, int *damage_x1)
+{
+  guint32 *line, *prev_line;
+  int x, y, k, width, height;
+
+  width = buffer->width;
+  height = buffer->height;
+
+  if (prev == NULL || prev->width != width || prev->height != height)
+    return FALSE;
+
+  for (y = 0; y < height; y++)
+    {
+      line = (guint32 *) (buffer->data + y * buffer->stride);
+      prev_line = (guint32 *) (prev_data + y * prev->stride);
+
+      damage_x0[y] = width;
+      damage_x1[y] = -1;
+
+      if (memcmp (line, prev_line, width * 4) == 0)
+        continue;
+
+      for (x = 0; line[x] == prev_line[x]; x++)
+        ;
+      damage_x0[y] = x;
+
+      for (x = width - 1; line[x] == prev_line[x]; x--)
+        ;
+      damage_x1[y] = x;
+    }
+
+  /* Going top down, the rows below y are not extended yet */
+  for (y = 0; y < height; y++)
+    {
+      for (k = y + 1; k < MIN (height, y + block_size); k++)
+        {
+          damage_x0[y] = MIN (damage_x0[y], damage_x0[k]);
+          damage_x1[y] = MAX (damage_x1[y], damage_x1[k]);
+        }
+    }
+
+  return TRUE;
+}
+
+/* Moves the part of the previous frame that was scrolled to where it
+ * ended up, both in @prev_data and on the client, so that the rest of
+ * the frame is encoded as a delta against the moved contents.
+ * Returns FALSE if nothing is left to move after clipping.
+ */
+static gboolean
+encode_scroll (struct encoder *encoder,
+               BroadwayBuffer *buffer, BroadwayBuffer *prev,
+               guint8 *prev_data, const BroadwayRect *scroll,
+               int dx, int dy)
+{
+  int x0, y0, x1, y1, y;
+
+  /* 0x00 5x xx xx xxxx yyyy xxxx yyyy wwww hhhh:
+   *	copy of the w x h area at the first x, y of the previous
+   *	frame to the second x, y */
+
+  x0 = MAX (scroll->x, MAX (0, dx));
+  y0 = MAX (scroll->y, MAX (0, dy));
+  x1 = MIN (scroll->x + scroll->width,
+            MIN (buffer->width, prev->width + dx));
+  y1 = MIN (scroll->y + scroll->height,
+            MIN (buffer->height, prev->height + dy));
+  x1 = MIN (x1, prev->width);
+  y1 = MIN (y1, prev->height);
+
+  if (x0 >= x1 || y0 >= y1)
+    return FALSE;
+
+  emit (encoder, 0x00500000);
+  emit (encoder, ((x0 - dx) << 16) | (y0 - dy));
+  emit (encoder, (x0 << 16) | y0);
+  emit (encoder, ((x1 - x0) << 16) | (y1 - y0));
+
+  for (y = y0; y < y1; y++)
+    memcpy (prev_data + y * prev->stride + x0 * 4,
+            prev->data + (y - dy) * prev->stride + (x0 - dx) * 4,
+            (x1 - x0) * 4);
+
+  return TRUE;
+}
+
 void
-broadway_buffer_encode (BroadwayBuffer *buffer, BroadwayBuffer *prev, GString *dest)
+broadway_buffer_encode (BroadwayBuffer *buffer, BroadwayBuffer *prev,
+                        const BroadwayRect *scroll, int scroll_dx, int scroll_dy,
+                        GString *dest)
 {
   struct entry *entry;
   int i, j, k;
@@ -369,6 +479,9 @@ broadway_buffer_encode (BroadwayBuffer *buffer, BroadwayBuffer *prev, GString *d
   int width, height;
   struct encoder encoder = { 0 };
   int *skyline, skyline_pixels;
+  int *damage_x0, *damage_x1;
+  gboolean have_damage;
+  guint8 *prev_data;
   int matches;
 
   width = buffer->width;
@@ -378,12 +491,33 @@ broadway_buffer_encode (BroadwayBuffer *buffer, BroadwayBuffer *prev, GString *d
   y0 = 0;
   y1 = height;
 
+  matches = 0;
+  encoder.dest = dest;
+
+  /* The copy is done by the client before anything else in the
+   * stream, so it has to be first */
+  prev_data = prev ? prev->data : NULL;
+  if (prev && scroll && (scroll_dx != 0 || scroll_dy != 0))
+    {
+      prev_data = g_memdup (prev->data, prev->height * prev->stride);
+      if (!encode_scroll (&encoder, buffer, prev, prev_data,
+                          scroll, scroll_dx, scroll_dy))
+        {
+          g_free (prev_data);
+          prev_data = prev->data;
+        }
+    }
+
   skyline = g_malloc0 ((width + block_size) * sizeof skyline[0]);
 
   block_hashes = g_malloc0 (width * sizeof block_hashes[0]);
 
-  matches = 0;
-  encoder.dest = dest;
+  /* A block that is unchanged since the previous frame is best
+   * encoded as a zero delta, so don't look for copies of it */
+  damage_x0 = g_new (int, height);
+  damage_x1 = g_new (int, height);
+  have_damage = compute_damage (buffer, prev, prev_data,
+                                damage_x0, damage_x1);
 
   // Calculate the block hashes for the first row
   for (i = y0; i < MIN(y1, y0 + block_size); i++)
@@ -420,7 +554,7 @@ broadway_buffer_encode (BroadwayBuffer *buffer, BroadwayBuffer *prev, GString *d
       skyline_pixels = 0;
 
       if (prev && i < prev->height)
-        prev_line = (guint32 *) (prev->data + i * prev->stride);
+        prev_line = (guint32 *) (prev_data + i * prev->stride);
       else
         prev_line = NULL;
 
@@ -451,7 +585,10 @@ broadway_buffer_encode (BroadwayBuffer *buffer, BroadwayBuffer *prev, GString *d
                * for consecutive blocks */
 
               h = block_hashes[j];
-              entry = lookup_block (prev, h);
+              entry = NULL;
+              if (!have_damage ||
+                  (j <= damage_x1[i] && j + block_size > damage_x0[i]))
+                entry = lookup_block (prev, h);
               if (entry && entry->count < 2 &&
                   skyline_pixels >= block_size &&
                   verify_block_match (buffer, j, i, prev, entry) &&
@@ -523,6 +660,10 @@ broadway_buffer_encode (BroadwayBuffer *buffer, BroadwayBuffer *prev, GString *d
 
   g_free (skyline);
   g_free (block_hashes);
+  g_free (damage_x0);
+  g_free (damage_x1);
+  if (prev_data != NULL && prev_data != prev->data)
+    g_free (prev_data);
 
   buffer->encoded = TRUE;
 }
@@ -6,6 +6,10 @@
 
 typedef struct _BroadwayBuffer BroadwayBuffer;
 
+/* Number of hash chain lengths that are counted, the last one being
+ * for chains at least that long */
+#define BROADWAY_BUFFER_N_STATS 5
+
 BroadwayBuffer *broadway_buffer_create     (int             width,
                                             int             height,
                                             guint8         *data,
@@ -13,8 +17,14 @@ BroadwayBuffer *broadway_buffer_create     (int             width,
 void            broadway_buffer_destroy    (BroadwayBuffer *buffer);
 void            broadway_buffer_encode     (BroadwayBuffer *buffer,
                                             BroadwayBuffer *prev,
+                                            const BroadwayRect *scroll,
+                                            int             scroll_dx,
+                                            int             scroll_dy,
                                             GString        *dest);
 int             broadway_buffer_get_width  (BroadwayBuffer *buffer);
 int             broadway_buffer_get_height (BroadwayBuffer *buffer);
+void            broadway_buffer_get_stats  (BroadwayBuffer *buffer,
+                                            int            *stats,
+                                            int            *clashes);
 
 #endif /* __BROADWAY_BUFFER__ */
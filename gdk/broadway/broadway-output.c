@@ -16,15 +16,32 @@ struct BroadwayOutput {
   GString *buf;
   int error;
   guint32 serial;
+
+  /* Estimated bandwidth to the client, in bytes per microsecond */
+  double bandwidth;
+  gint64 congested_until;
+
+  BroadwayOutputStats stats;
 };
 
-static void
-broadway_output_send_cmd (BroadwayOutput *output,
-			  gboolean fin, BroadwayWSOpCode code,
-			  const void *buf, gsize count)
+/* Only writes at least this large tell how fast the connection is */
+#define MIN_BANDWIDTH_SAMPLE (64 * 1024)
+/* A write that blocks this long (in microseconds) means the client
+ * is falling behind */
+#define CONGESTION_THRESHOLD (20 * 1000)
+
+/* The longest WebSocket frame header we send. Room for it is kept at
+ * the start of the output buffer, so that a whole flush goes out in a
+ * single write.
+ */
+#define WS_HEADER_MAX 10
+
+static gsize
+write_ws_header (guchar *header,
+                 gboolean fin, BroadwayWSOpCode code,
+                 gsize count)
 {
   gboolean mask = FALSE;
-  guchar header[16];
   size_t p;
 
   gboolean mid_header = count > 125 && count <= 65535;
@@ -45,10 +62,24 @@ broadway_output_send_cmd (BroadwayOutput *output,
       *(guint64 *)(header + p) = GUINT64_TO_BE( count );
       p += 8;
     }
+
+  return p;
+}
+
+static void
+broadway_output_send_cmd (BroadwayOutput *output,
+			  gboolean fin, BroadwayWSOpCode code,
+			  const void *buf, gsize count)
+{
+  guchar header[WS_HEADER_MAX];
+  size_t p;
+
+  p = write_ws_header (header, fin, code, count);
+
   // FIXME: if we are paranoid we should 'mask' the data
-  // FIXME: we should really emit these as a single write
   g_output_stream_write_all (output->out, header, p, NULL, NULL, NULL);
-  g_output_stream_write_all (output->out, buf, count, NULL, NULL, NULL);
+  if (count > 0)
+    g_output_stream_write_all (output->out, buf, count, NULL, NULL, NULL);
 }
 
 void broadway_output_pong (BroadwayOutput *output)
@@ -56,16 +87,87 @@ void broadway_output_pong (BroadwayOutput *output)
   broadway_output_send_cmd (output, TRUE, BROADWAY_WS_CNX_PONG, NULL, 0);
 }
 
+/* Browsers answer pings on their own, with the same payload, which
+ * makes it a convenient way to measure the round trip time. */
+void
+broadway_output_ping (BroadwayOutput *output)
+{
+  gint64 now;
+
+  now = g_get_monotonic_time ();
+  broadway_output_send_cmd (output, TRUE, BROADWAY_WS_CNX_PING,
+			    &now, sizeof (now));
+}
+
+void
+broadway_output_got_pong (BroadwayOutput *output,
+			  const guchar   *data,
+			  gsize           len)
+{
+  gint64 sent, elapsed;
+
+  if (len != sizeof (sent))
+    return;
+
+  memcpy (&sent, data, sizeof (sent));
+  elapsed = g_get_monotonic_time () - sent;
+  if (elapsed < 0)
+    return;
+
+  if (output->stats.round_trip == 0)
+    output->stats.round_trip = elapsed;
+  else
+    output->stats.round_trip = (3 * output->stats.round_trip + elapsed) / 4;
+}
+
+/* The socket is written to synchronously, so the time a write takes
+ * is the time the data spent waiting for the client to make room for
+ * it. */
+static void
+update_bandwidth (BroadwayOutput *output,
+                  gsize           len,
+                  gint64          elapsed)
+{
+  double sample;
+
+  if (elapsed > CONGESTION_THRESHOLD)
+    output->congested_until = g_get_monotonic_time () + elapsed;
+
+  if (len < MIN_BANDWIDTH_SAMPLE)
+    return;
+
+  /* Writes that return at once only tell that the connection is fast */
+  sample = (double) len / MAX (elapsed, 1000);
+
+  if (output->bandwidth == 0)
+    output->bandwidth = sample;
+  else
+    output->bandwidth = (3 * output->bandwidth + sample) / 4;
+}
+
 int
 broadway_output_flush (BroadwayOutput *output)
 {
-  if (output->buf->len == 0)
+  guchar header[WS_HEADER_MAX];
+  gint64 start;
+  gsize len, p;
+  char *data;
+
+  if (output->buf->len == WS_HEADER_MAX)
     return TRUE;
 
-  broadway_output_send_cmd (output, TRUE, BROADWAY_WS_BINARY,
-                            output->buf->str, output->buf->len);
+  len = output->buf->len - WS_HEADER_MAX;
+  p = write_ws_header (header, TRUE, BROADWAY_WS_BINARY, len);
+  data = output->buf->str + WS_HEADER_MAX - p;
+  memcpy (data, header, p);
+
+  start = g_get_monotonic_time ();
+
+  g_output_stream_write_all (output->out, data, p + len, NULL, NULL, NULL);
+
+  update_bandwidth (output, len, g_get_monotonic_time () - start);
 
-  g_string_set_size (output->buf, 0);
+  g_string_set_size (output->buf, WS_HEADER_MAX);
 
   return !output->error;
 
@@ -79,12 +181,47 @@ broadway_output_new (GOutputStream *out, guint32 serial)
   output = g_new0 (BroadwayOutput, 1);
 
   output->out = g_object_ref (out);
-  output->buf = g_string_new ("");
+  output->buf = g_string_sized_new (4096);
+  g_string_set_size (output->buf, WS_HEADER_MAX);
   output->serial = serial;
 
   return output;
 }
 
+/* Returns TRUE if the client recently couldn't keep up with what was
+ * sent to it, so that window contents should be held back for now.
+ */
+gboolean
+broadway_output_is_congested (BroadwayOutput *output)
+{
+  return g_get_monotonic_time () < output->congested_until;
+}
+
+void
+broadway_output_get_stats (BroadwayOutput      *output,
+			   BroadwayOutputStats *stats)
+{
+  *stats = output->stats;
+  stats->bandwidth = output->bandwidth * G_USEC_PER_SEC;
+}
+
+/* Picks how hard to compress window contents. On fast connections,
+ * usually local ones, compressing costs more time than sending the
+ * data does.
+ */
+static int
+get_compression_level (BroadwayOutput *output)
+{
+  if (output->bandwidth == 0)
+    return -1;
+  if (output->bandwidth >= 50)
+    return 0;
+  if (output->bandwidth >= 10)
+    return 1;
+
+  return -1;
+}
+
 void
 broadway_output_free (BroadwayOutput *output)
 {
@@ -290,13 +427,19 @@ void
 broadway_output_put_buffer (BroadwayOutput *output,
                             int             id,
                             BroadwayBuffer *prev_buffer,
-                            BroadwayBuffer *buffer)
+                            BroadwayBuffer *buffer,
+                            const BroadwayRect *scroll,
+                            int             scroll_dx,
+                            int             scroll_dy)
 {
   gsize len;
-  int w, h;
+  int w, h, i;
   GZlibCompressor *compressor;
   GOutputStream *out, *out_mem;
   GString *encoded;
+  int old_stats[BROADWAY_BUFFER_N_STATS], stats[BROADWAY_BUFFER_N_STATS];
+  int old_clashes, clashes;
+  gint64 start, encoded_time;
 
   write_header (output, BROADWAY_OP_PUT_BUFFER);
 
@@ -307,10 +450,19 @@ broadway_output_put_buffer (BroadwayOutput *output,
   append_uint16 (output, w);
   append_uint16 (output, h);
 
+  /* A buffer that is sent again has its blocks in the table already */
+  broadway_buffer_get_stats (buffer, old_stats, &old_clashes);
+
+  start = g_get_monotonic_time ();
+
   encoded = g_string_new ("");
-  broadway_buffer_encode (buffer, prev_buffer, encoded);
+  broadway_buffer_encode (buffer, prev_buffer,
+                          scroll, scroll_dx, scroll_dy, encoded);
+
+  encoded_time = g_get_monotonic_time ();
 
-  compressor = g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_RAW, -1);
+  compressor = g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_RAW,
+                                      get_compression_level (output));
   out_mem = g_memory_output_stream_new_resizable ();
   out = g_converter_output_stream_new (out_mem, G_CONVERTER (compressor));
   g_object_unref (compressor);
@@ -324,6 +476,18 @@ broadway_output_put_buffer (BroadwayOutput *output,
   len = g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (out_mem));
   append_uint32 (output, len);
 
+  output->stats.frames++;
+  output->stats.raw_bytes += w * h * 4;
+  output->stats.encoded_bytes += encoded->len;
+  output->stats.compressed_bytes += len;
+  output->stats.encode_time += encoded_time - start;
+  output->stats.compress_time += g_get_monotonic_time () - encoded_time;
+
+  broadway_buffer_get_stats (buffer, stats, &clashes);
+  for (i = 0; i < BROADWAY_BUFFER_N_STATS; i++)
+    output->stats.block_stats[i] += stats[i] - old_stats[i];
+  output->stats.block_clashes += clashes - old_clashes;
+
   g_string_append_len (output->buf, g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (out_mem)), len);
 
   g_string_free (encoded, TRUE);
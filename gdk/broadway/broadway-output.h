@@ -17,11 +17,31 @@ typedef enum {
   BROADWAY_WS_CNX_PONG = 0xa
 } BroadwayWSOpCode;
 
+typedef struct {
+  guint64 frames;
+  /* Window contents in bytes, as pixels, encoded and compressed */
+  guint64 raw_bytes;
+  guint64 encoded_bytes;
+  guint64 compressed_bytes;
+  /* In microseconds */
+  gint64 encode_time;
+  gint64 compress_time;
+  guint64 block_stats[BROADWAY_BUFFER_N_STATS];
+  guint64 block_clashes;
+  /* In bytes per second, 0 if not known yet */
+  double bandwidth;
+  /* In microseconds, 0 if not known yet */
+  gint64 round_trip;
+} BroadwayOutputStats;
+
 BroadwayOutput *broadway_output_new             (GOutputStream  *out,
 						 guint32         serial);
 void            broadway_output_free            (BroadwayOutput *output);
 int             broadway_output_flush           (BroadwayOutput *output);
 int             broadway_output_has_error       (BroadwayOutput *output);
+gboolean        broadway_output_is_congested    (BroadwayOutput *output);
+void            broadway_output_get_stats       (BroadwayOutput *output,
+						 BroadwayOutputStats *stats);
 void            broadway_output_set_next_serial (BroadwayOutput *output,
 						 guint32         serial);
 guint32         broadway_output_get_next_serial (BroadwayOutput *output);
@@ -57,12 +77,19 @@ void            broadway_output_set_transient_for (BroadwayOutput *output,
 void            broadway_output_put_buffer      (BroadwayOutput *output,
 						 int             id,
                                                  BroadwayBuffer *prev_buffer,
-                                                 BroadwayBuffer *buffer);
+                                                 BroadwayBuffer *buffer,
+                                                 const BroadwayRect *scroll,
+                                                 int             scroll_dx,
+                                                 int             scroll_dy);
 void            broadway_output_grab_pointer    (BroadwayOutput *output,
 						 int id,
 						 gboolean owner_event);
 guint32         broadway_output_ungrab_pointer  (BroadwayOutput *output);
 void            broadway_output_pong            (BroadwayOutput *output);
+void            broadway_output_ping            (BroadwayOutput *output);
+void            broadway_output_got_pong        (BroadwayOutput *output,
+						 const guchar   *data,
+						 gsize           len);
 void            broadway_output_set_show_keyboard (BroadwayOutput *output,
                                                    gboolean show);
 
@@ -50,6 +50,10 @@ struct _BroadwayServer {
   BroadwayInput *input;
   GList *input_messages;
   guint process_input_idle;
+  guint pending_buffers_timeout;
+  guint flush_idle;
+  guint ping_timeout;
+  guint32 session_count;
 
   GHashTable *id_ht;
   GList *toplevels;
@@ -99,8 +103,19 @@ struct BroadwayInput {
   gboolean seen_time;
   gint64 time_base;
   gboolean active;
+
+  /* Statistics for this session */
+  guint32 session_id;
+  guint64 frames_dropped;
+  guint64 input_events;
+  gint64 input_delay; /* in milliseconds */
+  gboolean seen_delay;
+  gint32 min_delay;
 };
 
+/* How often to measure the round trip time to the browser, in seconds */
+#define PING_INTERVAL 5
+
 struct BroadwayWindow {
   gint32 id;
   gint32 x;
@@ -113,6 +128,13 @@ struct BroadwayWindow {
 
   BroadwayBuffer *buffer;
   gboolean buffer_synced;
+  /* Newer contents, held back while the client is lagging */
+  BroadwayBuffer *pending_buffer;
+  /* Area of buffer that was scrolled since it was sent */
+  gboolean has_scroll;
+  BroadwayRect scroll_rect;
+  gint32 scroll_dx;
+  gint32 scroll_dy;
 
   char *cached_surface_name;
   cairo_surface_t *cached_surface;
@@ -152,6 +174,9 @@ broadway_server_finalize (GObject *object)
 {
   BroadwayServer *server = BROADWAY_SERVER (object);
 
+  if (server->ping_timeout != 0)
+    g_source_remove (server->ping_timeout);
+
   g_free (server->address);
 
   G_OBJECT_CLASS (broadway_server_parent_class)->finalize (object);
@@ -411,6 +436,28 @@ update_future_pointer_info (BroadwayServer *server, BroadwayInputPointerMsg *dat
   server->future_mouse_in_toplevel = data->mouse_window_id;
 }
 
+/* The clock of the browser can't be compared with ours, but the
+ * difference between the two only grows when an event takes longer
+ * than usual to get here. So the delay of an event is counted from
+ * the fastest one seen.
+ */
+static void
+update_input_delay (BroadwayInput *input, guint32 time_)
+{
+  gint32 delay;
+
+  delay = (guint32) (g_get_monotonic_time () / 1000) - time_;
+
+  if (!input->seen_delay || delay < input->min_delay)
+    {
+      input->seen_delay = TRUE;
+      input->min_delay = delay;
+    }
+
+  input->input_events++;
+  input->input_delay += delay - input->min_delay;
+}
+
 static void
 parse_input_message (BroadwayInput *input, const unsigned char *message)
 {
@@ -430,6 +477,8 @@ parse_input_message (BroadwayInput *input, const unsigned char *message)
   if (time_ == 0) {
     time_ = server->last_seen_time;
   } else {
+    update_input_delay (input, time_);
+
     if (!input->seen_time) {
       input->seen_time = TRUE;
       /* Calculate time base so that any following times are normalized to start
@@ -622,7 +671,8 @@ parse_input (BroadwayInput *input)
         broadway_output_pong (input->output);
         break;
       case BROADWAY_WS_CNX_PONG:
-        break; /* we never send pings, but tolerate pongs */
+        broadway_output_got_pong (input->output, data, payload_len);
+        break;
       case BROADWAY_WS_TEXT:
       case BROADWAY_WS_CONTINUATION:
       default:
@@ -740,9 +790,15 @@ broadway_server_get_screen_size (BroadwayServer   *server,
 }
 
 
-void
-broadway_server_flush (BroadwayServer *server)
+static void
+flush_output (BroadwayServer *server)
 {
+  if (server->flush_idle != 0)
+    {
+      g_source_remove (server->flush_idle);
+      server->flush_idle = 0;
+    }
+
   if (server->output &&
       !broadway_output_flush (server->output))
     {
@@ -752,10 +808,31 @@ broadway_server_flush (BroadwayServer *server)
     }
 }
 
+static gboolean
+flush_idle_cb (BroadwayServer *server)
+{
+  server->flush_idle = 0;
+  flush_output (server);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Clients flush after every batch of requests, and the server itself
+ * after many operations. Everything flushed while handling one round
+ * of input is sent to the browser together, as one WebSocket message.
+ */
+void
+broadway_server_flush (BroadwayServer *server)
+{
+  if (server->output != NULL && server->flush_idle == 0)
+    server->flush_idle =
+      g_idle_add_full (G_PRIORITY_DEFAULT, (GSourceFunc)flush_idle_cb, server, NULL);
+}
+
 void
 broadway_server_sync (BroadwayServer *server)
 {
-  broadway_server_flush (server);
+  flush_output (server);
 }
 
 
@@ -1049,6 +1126,15 @@ start_input (HttpRequest *request)
   g_strfreev (lines);
 }
 
+static gboolean
+ping_cb (BroadwayServer *server)
+{
+  if (server->output != NULL)
+    broadway_output_ping (server->output);
+
+  return G_SOURCE_CONTINUE;
+}
+
 static void
 start (BroadwayInput *input)
 {
@@ -1071,6 +1157,11 @@ start (BroadwayInput *input)
     }
 
   server->input = input;
+  input->session_id = ++server->session_count;
+
+  if (server->ping_timeout == 0)
+    server->ping_timeout =
+      g_timeout_add_seconds (PING_INTERVAL, (GSourceFunc)ping_cb, server);
 
   if (server->output)
     {
@@ -1116,6 +1207,114 @@ send_data (HttpRequest *request,
 #include "clienthtml.h"
 #include "broadwayjs.h"
 
+static void
+append_metric (GString    *str,
+	       const char *name,
+	       const char *type,
+	       const char *help)
+{
+  g_string_append_printf (str, "# HELP %s %s\n# TYPE %s %s\n",
+			  name, help, name, type);
+}
+
+/* Reports what the current session costs, in the Prometheus text
+ * format. Counters start over with every session. */
+static void
+send_metrics (HttpRequest *request)
+{
+  BroadwayServer *server = request->server;
+  BroadwayInput *input;
+  BroadwayOutputStats stats;
+  GString *str;
+  char *session;
+  int i;
+
+  str = g_string_new ("");
+
+  append_metric (str, "broadway_sessions_total", "counter",
+		 "Browser sessions started.");
+  g_string_append_printf (str, "broadway_sessions_total %u\n",
+			  server->session_count);
+
+  append_metric (str, "broadway_session_connected", "gauge",
+		 "Whether a browser is connected.");
+  g_string_append_printf (str, "broadway_session_connected %d\n",
+			  server->output != NULL);
+
+  input = server->input;
+  if (server->output != NULL && input != NULL)
+    {
+      broadway_output_get_stats (server->output, &stats);
+      session = g_strdup_printf ("session=\"%u\"", input->session_id);
+
+      append_metric (str, "broadway_frames_sent_total", "counter",
+		     "Window updates sent.");
+      g_string_append_printf (str, "broadway_frames_sent_total{%s} %"G_GUINT64_FORMAT"\n",
+			      session, stats.frames);
+
+      append_metric (str, "broadway_frames_dropped_total", "counter",
+		     "Window updates replaced by newer ones before they could be sent.");
+      g_string_append_printf (str, "broadway_frames_dropped_total{%s} %"G_GUINT64_FORMAT"\n",
+			      session, input->frames_dropped);
+
+      append_metric (str, "broadway_frame_bytes_total", "counter",
+		     "Size of the window updates sent.");
+      g_string_append_printf (str, "broadway_frame_bytes_total{%s,stage=\"raw\"} %"G_GUINT64_FORMAT"\n",
+			      session, stats.raw_bytes);
+      g_string_append_printf (str, "broadway_frame_bytes_total{%s,stage=\"encoded\"} %"G_GUINT64_FORMAT"\n",
+			      session, stats.encoded_bytes);
+      g_string_append_printf (str, "broadway_frame_bytes_total{%s,stage=\"compressed\"} %"G_GUINT64_FORMAT"\n",
+			      session, stats.compressed_bytes);
+
+      append_metric (str, "broadway_encode_seconds_total", "counter",
+		     "Time spent encoding window updates.");
+      g_string_append_printf (str, "broadway_encode_seconds_total{%s} %g\n",
+			      session, (double) stats.encode_time / G_USEC_PER_SEC);
+
+      append_metric (str, "broadway_compress_seconds_total", "counter",
+		     "Time spent compressing window updates.");
+      g_string_append_printf (str, "broadway_compress_seconds_total{%s} %g\n",
+			      session, (double) stats.compress_time / G_USEC_PER_SEC);
+
+      append_metric (str, "broadway_block_collisions_total", "counter",
+		     "Blocks hashed, by the number of collisions before they were inserted.");
+      for (i = 0; i < BROADWAY_BUFFER_N_STATS; i++)
+	g_string_append_printf (str, "broadway_block_collisions_total{%s,collisions=\"%d%s\"} %"G_GUINT64_FORMAT"\n",
+				session, i, i == BROADWAY_BUFFER_N_STATS - 1 ? "+" : "",
+				stats.block_stats[i]);
+
+      append_metric (str, "broadway_block_clashes_total", "counter",
+		     "Block hash matches whose contents differed.");
+      g_string_append_printf (str, "broadway_block_clashes_total{%s} %"G_GUINT64_FORMAT"\n",
+			      session, stats.block_clashes);
+
+      append_metric (str, "broadway_bandwidth_bytes_per_second", "gauge",
+		     "Estimated bandwidth to the browser, 0 if not known yet.");
+      g_string_append_printf (str, "broadway_bandwidth_bytes_per_second{%s} %g\n",
+			      session, stats.bandwidth);
+
+      append_metric (str, "broadway_round_trip_seconds", "gauge",
+		     "Smoothed round trip time to the browser, 0 if not known yet.");
+      g_string_append_printf (str, "broadway_round_trip_seconds{%s} %g\n",
+			      session, (double) stats.round_trip / G_USEC_PER_SEC);
+
+      append_metric (str, "broadway_input_events_total", "counter",
+		     "Input events received from the browser.");
+      g_string_append_printf (str, "broadway_input_events_total{%s} %"G_GUINT64_FORMAT"\n",
+			      session, input->input_events);
+
+      append_metric (str, "broadway_input_delay_seconds_total", "counter",
+		     "Time input events took to arrive, beyond the fastest one.");
+      g_string_append_printf (str, "broadway_input_delay_seconds_total{%s} %g\n",
+			      session, (double) input->input_delay / 1000);
+
+      g_free (session);
+    }
+
+  send_data (request, "text/plain; version=0.0.4", str->str, str->len);
+  g_string_free (str, TRUE);
+}
+
 static void
 got_request (HttpRequest *request)
 {
@@ -1156,6 +1355,8 @@ got_request (HttpRequest *request)
     send_data (request, "text/javascript", broadway_js, G_N_ELEMENTS(broadway_js) - 1);
   else if (strcmp (escaped, "/socket") == 0)
     start_input (request);
+  else if (strcmp (escaped, "/metrics") == 0)
+    send_metrics (request);
   else
     send_error (request, 404, "File not found");
 
@@ -1343,6 +1544,10 @@ broadway_server_destroy_window (BroadwayServer *server,
 	g_free (window->cached_surface_name);
       if (window->cached_surface != NULL)
 	cairo_surface_destroy (window->cached_surface);
+      if (window->buffer != NULL)
+	broadway_buffer_destroy (window->buffer);
+      if (window->pending_buffer != NULL)
+	broadway_buffer_destroy (window->pending_buffer);
 
       g_free (window);
     }
@@ -1471,12 +1676,107 @@ broadway_server_window_set_transient_for (BroadwayServer *server,
     }
 }
 
+/* Records that @area of the window was scrolled by @dx, @dy. The next
+ * update then tells the client to move what it already has, instead
+ * of sending the moved pixels again.
+ */
+gboolean
+broadway_server_window_translate (BroadwayServer *server,
+				  gint id,
+				  cairo_region_t *area,
+				  gint dx,
+				  gint dy)
+{
+  BroadwayWindow *window;
+  cairo_rectangle_int_t rect;
+
+  window = g_hash_table_lookup (server->id_ht,
+				GINT_TO_POINTER (id));
+  if (window == NULL || window->buffer == NULL)
+    return FALSE;
+
+  cairo_region_get_extents (area, &rect);
+
+  /* Consecutive scrolls of the same area add up. Otherwise keep only
+   * the latest one, anything else is sent as it is drawn. */
+  if (window->has_scroll &&
+      window->scroll_rect.x == rect.x &&
+      window->scroll_rect.y == rect.y &&
+      window->scroll_rect.width == rect.width &&
+      window->scroll_rect.height == rect.height)
+    {
+      window->scroll_dx += dx;
+      window->scroll_dy += dy;
+    }
+  else
+    {
+      window->has_scroll = TRUE;
+      window->scroll_rect.x = rect.x;
+      window->scroll_rect.y = rect.y;
+      window->scroll_rect.width = rect.width;
+      window->scroll_rect.height = rect.height;
+      window->scroll_dx = dx;
+      window->scroll_dy = dy;
+    }
+
+  return TRUE;
+}
+
 gboolean
 broadway_server_has_client (BroadwayServer *server)
 {
   return server->output != NULL;
 }
 
+static void
+set_window_buffer (BroadwayServer *server,
+		   BroadwayWindow *window,
+		   BroadwayBuffer *buffer)
+{
+  if (server->output != NULL)
+    {
+      window->buffer_synced = TRUE;
+      broadway_output_put_buffer (server->output, window->id,
+                                  window->buffer, buffer,
+                                  window->has_scroll ? &window->scroll_rect : NULL,
+                                  window->scroll_dx, window->scroll_dy);
+    }
+
+  window->has_scroll = FALSE;
+
+  if (window->buffer)
+    broadway_buffer_destroy (window->buffer);
+
+  window->buffer = buffer;
+}
+
+static gboolean
+send_pending_buffers_cb (BroadwayServer *server)
+{
+  GList *l;
+
+  if (server->output != NULL &&
+      broadway_output_is_congested (server->output))
+    return G_SOURCE_CONTINUE;
+
+  server->pending_buffers_timeout = 0;
+
+  for (l = server->toplevels; l != NULL; l = l->next)
+    {
+      BroadwayWindow *window = l->data;
+
+      if (window->pending_buffer != NULL)
+	{
+	  set_window_buffer (server, window, window->pending_buffer);
+	  window->pending_buffer = NULL;
+	}
+    }
+
+  broadway_server_flush (server);
+
+  return G_SOURCE_REMOVE;
+}
+
 void
 broadway_server_window_update (BroadwayServer *server,
 			       gint id,
@@ -1500,17 +1800,30 @@ broadway_server_window_update (BroadwayServer *server,
                                    cairo_image_surface_get_data (surface),
                                    cairo_image_surface_get_stride (surface));
 
-  if (server->output != NULL)
+  if (window->pending_buffer != NULL)
     {
-      window->buffer_synced = TRUE;
-      broadway_output_put_buffer (server->output, window->id,
-                                  window->buffer, buffer);
+      broadway_buffer_destroy (window->pending_buffer);
+      window->pending_buffer = NULL;
+      if (server->input != NULL)
+	server->input->frames_dropped++;
     }
 
-  if (window->buffer)
-    broadway_buffer_destroy (window->buffer);
+  /* Sending every frame to a client that can't keep up only makes it
+   * fall further behind. Keep the latest one instead, and send it
+   * when the connection has drained, as a delta against what the
+   * client has.
+   */
+  if (server->output != NULL &&
+      broadway_output_is_congested (server->output))
+    {
+      window->pending_buffer = buffer;
+      if (server->pending_buffers_timeout == 0)
+	server->pending_buffers_timeout =
+	  g_timeout_add (20, (GSourceFunc)send_pending_buffers_cb, server);
+      return;
+    }
 
-  window->buffer = buffer;
+  set_window_buffer (server, window, buffer);
 }
 
 gboolean
@@ -1534,6 +1847,8 @@ broadway_server_window_move_resize (BroadwayServer *server,
   with_resize = width != window->width || height != window->height;
   window->width = width;
   window->height = height;
+  if (with_resize)
+    window->has_scroll = FALSE;
 
   if (server->output != NULL)
     {
@@ -1795,11 +2110,21 @@ broadway_server_resync_windows (BroadwayServer *server)
 	{
 	  broadway_output_show_surface (server->output, window->id);
 
+	  if (window->pending_buffer != NULL)
+	    {
+	      if (window->buffer != NULL)
+		broadway_buffer_destroy (window->buffer);
+	      window->buffer = window->pending_buffer;
+	      window->pending_buffer = NULL;
+	    }
+
+	  window->has_scroll = FALSE;
 	  if (window->buffer != NULL)
 	    {
 	      window->buffer_synced = TRUE;
               broadway_output_put_buffer (server->output, window->id,
-                                          NULL, window->buffer);
+                                          NULL, window->buffer,
+                                          NULL, 0, 0);
 	    }
 	}
     }
@@ -101,6 +101,9 @@ var windowWithMouse = 0;
 var surfaces = {};
 var stackingOrder = [];
 var outstandingCommands = new Array();
+var decodeWorker = null;
+var coalescedInput = [];
+var coalescedInputFrame = false;
 var inputSocket = null;
 var fakeInput = null;
 var showKeyboard = false;
@@ -444,6 +447,33 @@ function decodeBuffer(context, oldData, w, h, data)
                 }
                 break;
 
+            case 0x50: // Copy of a scrolled area of the old frame
+                b = data[src++];
+                g = data[src++];
+                r = data[src++];
+                alpha = data[src++];
+                var srcX = alpha << 8 | r;
+                var srcY = g << 8 | b;
+
+                b = data[src++];
+                g = data[src++];
+                r = data[src++];
+                alpha = data[src++];
+                var destX = alpha << 8 | r;
+                var destY = g << 8 | b;
+
+                b = data[src++];
+                g = data[src++];
+                r = data[src++];
+                alpha = data[src++];
+                var width = alpha << 8 | r;
+                var height = g << 8 | b;
+
+                copyRect(oldData, srcX, srcY, imageData, destX, destY, width, height);
+
+                //log("Got copy (" + srcX + "," + srcY + ") to " + destX + "," + destY + " " + width + "x" + height);
+                break;
+
             default:
                 alert("Unknown buffer commend " + cmd);
             }
@@ -468,6 +498,99 @@ function cmdPutBuffer(id, w, h, compressed)
     surface.imageData = imageData;
 }
 
+// Browsers that can inflate natively can also do it in a worker, so
+// there both inflating and decoding are moved off the main thread,
+// where input is handled.
+function inflateBuffer(compressed)
+{
+    var stream = new Blob([compressed]).stream().pipeThrough(new DecompressionStream("deflate-raw"));
+    return new Response(stream).arrayBuffer().then(function(buffer) {
+        return new Uint8Array(buffer);
+    });
+}
+
+function decodeWorkerMain()
+{
+    var context = {
+        createImageData: function(w, h) {
+            return { width: w, height: h, data: new Uint8ClampedArray(w * h * 4) };
+        }
+    };
+
+    self.onmessage = function(e) {
+        var m = e.data;
+        inflateBuffer(m.compressed).then(function(data) {
+            var imageData = decodeBuffer(context, m.oldData, m.w, m.h, data);
+            self.postMessage(imageData, [imageData.data.buffer]);
+        }).catch(function(e) {
+            self.postMessage({ error: e.toString() });
+        });
+    };
+}
+
+function createDecodeWorker()
+{
+    try {
+        new DecompressionStream("deflate-raw");
+
+        var source = [copyRect, decodeBuffer, inflateBuffer, decodeWorkerMain].map(function(f) {
+            return f.toString();
+        }).join("\n") + "\ndecodeWorkerMain();\n";
+        var url = URL.createObjectURL(new Blob([source], { type: "text/javascript" }));
+        return new Worker(url);
+    } catch (e) {
+        return null;
+    }
+}
+
+// Returns false when the buffer is decoded in the background, in
+// which case handleOutstanding() is called again once it is shown.
+function putBuffer(id, w, h, compressed)
+{
+    if (decodeWorker == null) {
+        cmdPutBuffer(id, w, h, compressed);
+        return true;
+    }
+
+    var surface = surfaces[id];
+    var oldData = surface.imageData;
+    var msg = { w: w, h: h, compressed: compressed.slice(), oldData: null };
+    var transfer = [msg.compressed.buffer];
+
+    // The old frame is only needed again in the worker, so move it there
+    if (oldData != null) {
+        msg.oldData = { width: oldData.width, height: oldData.height, data: oldData.data };
+        transfer.push(oldData.data.buffer);
+    }
+
+    var failed = function(message) {
+        log("Decoding in worker failed: " + message);
+        decodeWorker = null;
+        surface.imageData = null;
+        handleOutstanding();
+    };
+
+    decodeWorker.onmessage = function(e) {
+        var m = e.data;
+        if (m.error) {
+            failed(m.error);
+            return;
+        }
+
+        var imageData = new ImageData(m.data, m.width, m.height);
+
+        surface.canvas.getContext("2d").putImageData(imageData, 0, 0);
+        surface.imageData = imageData;
+        handleOutstanding();
+    };
+    decodeWorker.onerror = function(e) {
+        failed(e.message);
+    };
+
+    decodeWorker.postMessage(msg, transfer);
+    return false;
+}
+
 function cmdGrabPointer(id, ownerEvents)
 {
     doGrab(id, ownerEvents, false);
@@ -561,7 +684,8 @@ function handleCommands(cmd)
 	    w = cmd.get_16();
 	    h = cmd.get_16();
             var data = cmd.get_data();
-            cmdPutBuffer(id, w, h, data);
+            if (!putBuffer(id, w, h, data))
+                return false;
             break;
 
 	case 'g': // Grab
@@ -660,12 +784,12 @@ function getSurfaceId(ev) {
     return 0;
 }
 
-function sendInput(cmd, args)
+function sendInputMessage(cmd, serial, time, args)
 {
     if (inputSocket == null)
         return;
 
-    var fullArgs = [cmd.charCodeAt(0), lastSerial, lastTimeStamp].concat(args);
+    var fullArgs = [cmd.charCodeAt(0), serial, time].concat(args);
     var buffer = new ArrayBuffer(fullArgs.length * 4);
     var view = new DataView(buffer);
     fullArgs.forEach(function(arg, i) {
@@ -675,6 +799,50 @@ function sendInput(cmd, args)
     inputSocket.send(buffer);
 }
 
+function flushCoalescedInput()
+{
+    var pending = coalescedInput;
+    coalescedInput = [];
+    for (var i = 0; i < pending.length; i++)
+        sendInputMessage(pending[i].cmd, pending[i].serial, pending[i].time, pending[i].args);
+}
+
+function sendInput(cmd, args)
+{
+    if (inputSocket == null)
+        return;
+
+    // Keep the order of events
+    flushCoalescedInput();
+    sendInputMessage(cmd, lastSerial, lastTimeStamp, args);
+}
+
+// Events that only update a position, like pointer motion, are sent
+// once per animation frame, as nothing can be drawn in between. An
+// event replaces the pending one with the same key.
+function sendCoalescedInput(cmd, key, args)
+{
+    if (inputSocket == null)
+        return;
+
+    for (var i = 0; i < coalescedInput.length; i++) {
+        if (coalescedInput[i].key == key) {
+            coalescedInput.splice(i, 1);
+            break;
+        }
+    }
+
+    coalescedInput.push({ cmd: cmd, key: key, serial: lastSerial, time: lastTimeStamp, args: args });
+
+    if (!coalescedInputFrame) {
+        coalescedInputFrame = true;
+        window.requestAnimationFrame(function() {
+            coalescedInputFrame = false;
+            flushCoalescedInput();
+        });
+    }
+}
+
 function getPositionsFromAbsCoord(absX, absY, relativeId) {
     var res = Object();
 
@@ -740,7 +908,7 @@ function onMouseMove (ev) {
     var id = getSurfaceId(ev);
     id = getEffectiveEventTarget (id);
     var pos = getPositionsFromEvent(ev, id);
-    sendInput ("m", [realWindowWithMouse, id, pos.rootX, pos.rootY, pos.winX, pos.winY, lastState]);
+    sendCoalescedInput ("m", "m", [realWindowWithMouse, id, pos.rootX, pos.rootY, pos.winX, pos.winY, lastState]);
 }
 
 function onMouseOver (ev) {
@@ -2472,7 +2640,7 @@ function onTouchMove(ev) {
             isEmulated = 1;
         }
 
-        sendInput ("t", [1, id, touch.identifier, isEmulated, pos.rootX, pos.rootY, pos.winX, pos.winY, lastState]);
+        sendCoalescedInput ("t", "t" + touch.identifier, [1, id, touch.identifier, isEmulated, pos.rootX, pos.rootY, pos.winX, pos.winY, lastState]);
     }
 }
 
@@ -2526,6 +2694,8 @@ function start()
 {
     setupDocument(document);
 
+    decodeWorker = createDecodeWorker();
+
     var w, h;
     w = window.innerWidth;
     h = window.innerHeight;
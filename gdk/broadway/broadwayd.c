@@ -198,7 +198,10 @@ client_handle_request (BroadwayClient *client,
   BroadwayReplyGrabPointer reply_grab_pointer;
   BroadwayReplyUngrabPointer reply_ungrab_pointer;
   cairo_surface_t *surface;
+  cairo_region_t *area;
+  cairo_rectangle_int_t rect;
   guint32 before_serial, now_serial;
+  guint32 i;
 
   before_serial = broadway_server_get_next_serial (server);
 
@@ -223,6 +226,9 @@ client_handle_request (BroadwayClient *client,
       broadway_server_flush (server);
       break;
     case BROADWAY_REQUEST_SYNC:
+      /* Clients sync after every frame, to know that their window
+       * surfaces have been read. That has happened by now, so don't
+       * keep them waiting until the browser got the frame too. */
       broadway_server_flush (server);
       send_reply (client, request, (BroadwayReply *)&reply_sync, sizeof (reply_sync),
 		  BROADWAY_REPLY_SYNC);
@@ -253,6 +259,23 @@ client_handle_request (BroadwayClient *client,
 						request->set_transient_for.id,
 						request->set_transient_for.parent);
       break;
+    case BROADWAY_REQUEST_TRANSLATE:
+      area = cairo_region_create ();
+      for (i = 0; i < request->translate.n_rects; i++)
+	{
+	  rect.x = request->translate.rects[i].x;
+	  rect.y = request->translate.rects[i].y;
+	  rect.width = request->translate.rects[i].width;
+	  rect.height = request->translate.rects[i].height;
+	  cairo_region_union_rectangle (area, &rect);
+	}
+      broadway_server_window_translate (server,
+					request->translate.id,
+					area,
+					request->translate.dx,
+					request->translate.dy);
+      cairo_region_destroy (area);
+      break;
     case BROADWAY_REQUEST_UPDATE:
       surface = broadway_server_open_surface (server,
 					      request->update.id,
@@ -520,6 +520,35 @@ _gdk_broadway_server_window_set_transient_for (GdkBroadwayServer *server,
 				    BROADWAY_REQUEST_SET_TRANSIENT_FOR);
 }
 
+gboolean
+_gdk_broadway_server_window_translate (GdkBroadwayServer *server,
+				       gint id,
+				       cairo_region_t *area,
+				       gint dx,
+				       gint dy)
+{
+  BroadwayRequestTranslate msg;
+  cairo_rectangle_int_t rect;
+
+  /* The daemon only uses the extents to tell the browser what to
+   * move, so there is no need to send every rectangle */
+  cairo_region_get_extents (area, &rect);
+
+  msg.id = id;
+  msg.dx = dx;
+  msg.dy = dy;
+  msg.n_rects = 1;
+  msg.rects[0].x = rect.x;
+  msg.rects[0].y = rect.y;
+  msg.rects[0].width = rect.width;
+  msg.rects[0].height = rect.height;
+
+  gdk_broadway_server_send_message (server, msg,
+				    BROADWAY_REQUEST_TRANSLATE);
+
+  return TRUE;
+}
+
 static void *
 map_named_shm (char *name, gsize size)
 {
@@ -71,9 +71,4 @@ gboolean           _gdk_broadway_server_window_move_resize       (GdkBroadwaySer
 								  int                 y,
 								  int                 width,
 								  int                 height);
-gboolean           _gdk_broadway_server_window_translate         (GdkBroadwayServer  *server,
-								  gint                id,
-								  cairo_region_t     *area,
-								  gint                dx,
-								  gint                dy);
 #endif /* __GDK_BROADWAY_SERVER__ */
@@ -68,13 +68,36 @@ static void      gdk_broadway_device_select_window_events (GdkDevice       *devi
 							   GdkEventMask     event_mask);
 
 
+/* Motion events are compressed before they are delivered, so keep
+ * this many positions around for applications that want them all */
+#define MAX_HISTORY 256
+
+typedef struct {
+  guint32 time;
+  gint root_x;
+  gint root_y;
+} HistoryEntry;
+
 G_DEFINE_TYPE (GdkBroadwayDevice, gdk_broadway_device, GDK_TYPE_DEVICE)
 
+static void
+gdk_broadway_device_finalize (GObject *object)
+{
+  GdkBroadwayDevice *device = GDK_BROADWAY_DEVICE (object);
+
+  g_array_free (device->history, TRUE);
+
+  G_OBJECT_CLASS (gdk_broadway_device_parent_class)->finalize (object);
+}
+
 static void
 gdk_broadway_device_class_init (GdkBroadwayDeviceClass *klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
   GdkDeviceClass *device_class = GDK_DEVICE_CLASS (klass);
 
+  object_class->finalize = gdk_broadway_device_finalize;
+
   device_class->get_history = gdk_broadway_device_get_history;
   device_class->get_state = gdk_broadway_device_get_state;
   device_class->set_window_cursor = gdk_broadway_device_set_window_cursor;
@@ -95,6 +118,25 @@ gdk_broadway_device_init (GdkBroadwayDevice *device_core)
 
   _gdk_device_add_axis (device, GDK_NONE, GDK_AXIS_X, 0, 0, 1);
   _gdk_device_add_axis (device, GDK_NONE, GDK_AXIS_Y, 0, 0, 1);
+
+  device_core->history = g_array_new (FALSE, FALSE, sizeof (HistoryEntry));
+}
+
+void
+_gdk_broadway_device_add_history (GdkBroadwayDevice *device,
+				  guint32            time,
+				  gint               root_x,
+				  gint               root_y)
+{
+  HistoryEntry entry;
+
+  if (device->history->len == MAX_HISTORY)
+    g_array_remove_index (device->history, 0);
+
+  entry.time = time;
+  entry.root_x = root_x;
+  entry.root_y = root_y;
+  g_array_append_val (device->history, entry);
 }
 
 static gboolean
@@ -105,7 +147,56 @@ gdk_broadway_device_get_history (GdkDevice      *device,
 				 GdkTimeCoord ***events,
 				 gint           *n_events)
 {
-  return FALSE;
+  GArray *history = GDK_BROADWAY_DEVICE (device)->history;
+  GdkTimeCoord **coords;
+  HistoryEntry *entry;
+  gint origin_x, origin_y, width, height;
+  gint x, y;
+  guint i;
+  gint n;
+
+  gdk_window_get_origin (window, &origin_x, &origin_y);
+  width = gdk_window_get_width (window);
+  height = gdk_window_get_height (window);
+
+  coords = _gdk_device_allocate_history (device, history->len);
+
+  n = 0;
+  for (i = 0; i < history->len; i++)
+    {
+      entry = &g_array_index (history, HistoryEntry, i);
+      x = entry->root_x - origin_x;
+      y = entry->root_y - origin_y;
+
+      if (entry->time >= start && entry->time <= stop &&
+          x >= 0 && x < width && y >= 0 && y < height)
+        {
+          coords[n]->time = entry->time;
+          coords[n]->axes[0] = x;
+          coords[n]->axes[1] = y;
+          n++;
+        }
+    }
+
+  /* free the events we allocated too much */
+  for (i = n; i < history->len; i++)
+    g_free (coords[i]);
+
+  if (n == 0)
+    {
+      g_free (coords);
+      return FALSE;
+    }
+
+  if (n_events)
+    *n_events = n;
+
+  if (events)
+    *events = coords;
+  else
+    gdk_device_free_history (coords, n);
+
+  return TRUE;
 }
 
 static void
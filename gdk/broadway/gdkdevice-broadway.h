@@ -35,6 +35,9 @@ typedef struct _GdkBroadwayDeviceClass GdkBroadwayDeviceClass;
 struct _GdkBroadwayDevice
 {
   GdkDevice parent_instance;
+
+  /* Recent motion, for gdk_device_get_history() */
+  GArray *history;
 };
 
 struct _GdkBroadwayDeviceClass
@@ -45,6 +48,11 @@ struct _GdkBroadwayDeviceClass
 G_GNUC_INTERNAL
 GType gdk_broadway_device_get_type (void) G_GNUC_CONST;
 
+void _gdk_broadway_device_add_history (GdkBroadwayDevice *device,
+                                       guint32            time,
+                                       gint               root_x,
+                                       gint               root_y);
+
 G_END_DECLS
 
 #endif /* __GDK_DEVICE_BROADWAY_H__ */
@@ -19,6 +19,7 @@
 
 #include "gdkeventsource.h"
 #include "gdkdevicemanager-broadway.h"
+#include "gdkdevice-broadway.h"
 
 #include "gdkinternals.h"
 
@@ -144,6 +145,11 @@ _gdk_broadway_events_got_input (BroadwayInputMsg *message)
       }
     break;
   case BROADWAY_EVENT_POINTER_MOVE:
+    _gdk_broadway_device_add_history (GDK_BROADWAY_DEVICE (display->core_pointer),
+                                      message->base.time,
+                                      message->pointer.root_x,
+                                      message->pointer.root_y);
+
     if (_gdk_broadway_moveresize_handle_event (display, message))
       break;
 
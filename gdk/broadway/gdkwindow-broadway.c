@@ -1562,7 +1562,7 @@ _gdk_broadway_window_translate (GdkWindow      *window,
 				gint            dx,
 				gint            dy)
 {
- /*  GdkWindowImplBroadway *impl;
+  GdkWindowImplBroadway *impl;
   GdkBroadwayDisplay *broadway_display;
 
   impl = GDK_WINDOW_IMPL_BROADWAY (window->impl);
@@ -1572,11 +1572,13 @@ _gdk_broadway_window_translate (GdkWindow      *window,
       copy_region (impl->surface, area, dx, dy);
       broadway_display = GDK_BROADWAY_DISPLAY (gdk_window_get_display (window));
 
+      /* The daemon sends the move along with the next update */
+      impl->dirty = TRUE;
       if (_gdk_broadway_server_window_translate (broadway_display->server,
 						 impl->id,
 						 area, dx, dy))
 	queue_flush (window);
-    }*/
+    }
 }
 
 guint32
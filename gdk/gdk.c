@@ -30,6 +30,7 @@
 
 #include "gdkinternals.h"
 #include "gdkintl.h"
+#include "gdkprofilerprivate.h"
 
 #ifndef HAVE_XCONVERTCASE
 #include "gdkkeysyms.h"
@@ -284,6 +285,14 @@ gdk_pre_parse_libgtk_only (void)
       else if (g_str_equal (rendering_mode, "recording"))
         _gdk_rendering_mode = GDK_RENDERING_MODE_RECORDING;
     }
+
+  /* GTK_TRACE_FD is set by sysprof when it launches an application,
+   * GTK_TRACE writes the capture to gtk.PID.syscap instead.
+   */
+  if (g_getenv ("GTK_TRACE_FD"))
+    gdk_profiler_start (atoi (g_getenv ("GTK_TRACE_FD")));
+  else if (g_getenv ("GTK_TRACE"))
+    gdk_profiler_start (-1);
 }
 
   
@@ -370,6 +379,7 @@ GdkDisplay *
 gdk_display_open_default_libgtk_only (void)
 {
   GdkDisplay *display;
+  gint64 begin;
 
   g_return_val_if_fail (gdk_initialized, NULL);
 
@@ -377,7 +387,9 @@ gdk_display_open_default_libgtk_only (void)
   if (display)
     return display;
 
+  begin = gdk_profiler_begin_mark ();
   display = gdk_display_open (gdk_get_display_arg_name ());
+  gdk_profiler_end_mark (begin, "display-open", NULL);
 
   return display;
 }
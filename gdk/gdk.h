@@ -41,6 +41,7 @@
 #include <gdk/gdkenumtypes.h>
 #include <gdk/gdkevents.h>
 #include <gdk/gdkframeclock.h>
+#include <gdk/gdkframesink.h>
 #include <gdk/gdkframetimings.h>
 #include <gdk/gdkkeys.h>
 #include <gdk/gdkkeysyms.h>
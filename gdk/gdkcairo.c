@@ -203,10 +203,14 @@ gdk_cairo_surface_paint_pixbuf (cairo_surface_t *surface,
   cairo_stride = cairo_image_surface_get_stride (surface);
   cairo_pixels = cairo_image_surface_get_data (surface);
 
+  /* Cairo pixels are native endian words, so they are written as such
+   * rather than byte by byte. Fully opaque and fully transparent pixels,
+   * which is most of them in the usual icon, don't need multiplying.
+   */
   for (j = height; j; j--)
     {
       guchar *p = gdk_pixels;
-      guchar *q = cairo_pixels;
+      guint32 *q = (guint32 *) cairo_pixels;
 
       if (n_channels == 3)
         {
@@ -214,42 +218,34 @@ gdk_cairo_surface_paint_pixbuf (cairo_surface_t *surface,
 
           while (p < end)
             {
-#if G_BYTE_ORDER == G_LITTLE_ENDIAN
-              q[0] = p[2];
-              q[1] = p[1];
-              q[2] = p[0];
-#else
-              q[1] = p[0];
-              q[2] = p[1];
-              q[3] = p[2];
-#endif
+              *q = 0xff000000 | (p[0] << 16) | (p[1] << 8) | p[2];
               p += 3;
-              q += 4;
+              q++;
             }
         }
       else
         {
           guchar *end = p + 4 * width;
-          guint t1,t2,t3;
+          guint a, t1, t2, t3;
 
-#define MULT(d,c,a,t) G_STMT_START { t = c * a + 0x80; d = ((t >> 8) + t) >> 8; } G_STMT_END
+#define MULT(c,a,t) (t = c * a + 0x80, ((t >> 8) + t) >> 8)
 
           while (p < end)
             {
-#if G_BYTE_ORDER == G_LITTLE_ENDIAN
-              MULT(q[0], p[2], p[3], t1);
-              MULT(q[1], p[1], p[3], t2);
-              MULT(q[2], p[0], p[3], t3);
-              q[3] = p[3];
-#else
-              q[0] = p[3];
-              MULT(q[1], p[0], p[3], t1);
-              MULT(q[2], p[1], p[3], t2);
-              MULT(q[3], p[2], p[3], t3);
-#endif
+              a = p[3];
+
+              if (a == 0xff)
+                *q = 0xff000000 | (p[0] << 16) | (p[1] << 8) | p[2];
+              else if (a == 0)
+                *q = 0;
+              else
+                *q = (a << 24) |
+                     (MULT (p[0], a, t1) << 16) |
+                     (MULT (p[1], a, t2) << 8) |
+                     MULT (p[2], a, t3);
 
               p += 4;
-              q += 4;
+              q++;
             }
 
 #undef MULT
@@ -289,9 +289,11 @@ gdk_device_dispose (GObject *object)
 
   g_free (device->name);
   g_free (device->keys);
+  g_free (device->history);
 
   device->name = NULL;
   device->keys = NULL;
+  device->history = NULL;
 
   G_OBJECT_CLASS (gdk_device_parent_class)->dispose (object);
 }
@@ -577,6 +579,131 @@ gdk_device_get_window_at_position (GdkDevice  *device,
   return window;
 }
 
+/* Number of motion samples kept per device */
+#define HISTORY_SIZE 512
+
+/* Called for every motion event as soon as it is read from the
+ * windowing system, before motion compression, so that the samples
+ * stay available through gdk_device_get_history() even when the
+ * application falls behind.
+ */
+void
+_gdk_device_record_motion (GdkDevice            *device,
+                           const GdkEventMotion *event)
+{
+  guint n_axes, stride, i;
+  gdouble *sample;
+
+  n_axes = event->axes ? device->axes->len : 0;
+  stride = 3 + n_axes;
+
+  if (device->history == NULL || device->history_stride != stride)
+    {
+      g_free (device->history);
+      device->history = g_new (gdouble, HISTORY_SIZE * stride);
+      device->history_stride = stride;
+      device->history_start = 0;
+      device->history_len = 0;
+    }
+
+  if (device->history_len < HISTORY_SIZE)
+    {
+      i = (device->history_start + device->history_len) % HISTORY_SIZE;
+      device->history_len++;
+    }
+  else
+    {
+      i = device->history_start;
+      device->history_start = (device->history_start + 1) % HISTORY_SIZE;
+    }
+
+  sample = device->history + i * stride;
+  sample[0] = event->time;
+  sample[1] = event->x_root;
+  sample[2] = event->y_root;
+
+  for (i = 0; i < n_axes; i++)
+    sample[3 + i] = event->axes[i];
+}
+
+static gboolean
+get_recorded_history (GdkDevice      *device,
+                      GdkWindow      *window,
+                      guint32         start,
+                      guint32         stop,
+                      GdkTimeCoord ***events,
+                      gint           *n_events)
+{
+  GdkTimeCoord **coords;
+  gint origin_x, origin_y;
+  guint i, j, n_found, n_axes;
+
+  if (!device->history)
+    return FALSE;
+
+  n_found = 0;
+  for (i = 0; i < device->history_len; i++)
+    {
+      gdouble *sample;
+      guint32 time;
+
+      sample = device->history + ((device->history_start + i) % HISTORY_SIZE) * device->history_stride;
+      time = (guint32) sample[0];
+
+      if (time >= start && time <= stop)
+        n_found++;
+    }
+
+  if (n_found == 0)
+    return FALSE;
+
+  if (n_events)
+    *n_events = n_found;
+
+  if (!events)
+    return TRUE;
+
+  gdk_window_get_root_coords (window, 0, 0, &origin_x, &origin_y);
+
+  n_axes = device->history_stride - 3;
+  coords = _gdk_device_allocate_history (device, n_found);
+
+  for (i = 0, j = 0; i < device->history_len; i++)
+    {
+      gdouble *sample;
+      guint32 time;
+      guint axis;
+
+      sample = device->history + ((device->history_start + i) % HISTORY_SIZE) * device->history_stride;
+      time = (guint32) sample[0];
+
+      if (time < start || time > stop)
+        continue;
+
+      coords[j]->time = time;
+
+      for (axis = 0; axis < device->axes->len; axis++)
+        {
+          GdkAxisUse use = gdk_device_get_axis_use (device, axis);
+
+          if (use == GDK_AXIS_X)
+            coords[j]->axes[axis] = sample[1] - origin_x;
+          else if (use == GDK_AXIS_Y)
+            coords[j]->axes[axis] = sample[2] - origin_y;
+          else if (axis < n_axes)
+            coords[j]->axes[axis] = sample[3 + axis];
+          else
+            coords[j]->axes[axis] = 0;
+        }
+
+      j++;
+    }
+
+  *events = coords;
+
+  return TRUE;
+}
+
 /**
  * gdk_device_get_history: (skip)
  * @device: a #GdkDevice
@@ -593,6 +720,11 @@ gdk_device_get_window_at_position (GdkDevice  *device,
  * be returned. (This is not distinguishable from the case where
  * motion history is supported and no events were found.)
  *
+ * If the windowing system doesn't keep a motion history itself, GDK
+ * returns the most recent motion events it has read for @device,
+ * including those that were merged by motion compression before
+ * they were delivered.
+ *
  * Return value: %TRUE if the windowing system supports motion history and
  *  at least one event was found.
  **/
@@ -617,12 +749,13 @@ gdk_device_get_history (GdkDevice      *device,
   if (GDK_WINDOW_DESTROYED (window))
     return FALSE;
 
-  if (!GDK_DEVICE_GET_CLASS (device)->get_history)
-    return FALSE;
+  if (GDK_DEVICE_GET_CLASS (device)->get_history &&
+      GDK_DEVICE_GET_CLASS (device)->get_history (device, window,
+                                                  start, stop,
+                                                  events, n_events))
+    return TRUE;
 
-  return GDK_DEVICE_GET_CLASS (device)->get_history (device, window,
-                                                     start, stop,
-                                                     events, n_events);
+  return get_recorded_history (device, window, start, stop, events, n_events);
 }
 
 GdkTimeCoord **
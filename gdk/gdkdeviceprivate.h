@@ -56,6 +56,15 @@ struct _GdkDevice
   GList *slaves;
   GdkDeviceType type;
   GArray *axes;
+
+  /* Ring of recent motion samples for gdk_device_get_history();
+   * each sample is history_stride doubles: time, x_root, y_root
+   * and the axes of the event
+   */
+  gdouble *history;
+  guint history_stride;
+  guint history_start;
+  guint history_len;
 };
 
 struct _GdkDeviceClass
@@ -153,6 +162,8 @@ gboolean   _gdk_device_translate_axis         (GdkDevice *device,
 
 GdkTimeCoord ** _gdk_device_allocate_history  (GdkDevice *device,
                                                gint       n_events);
+void _gdk_device_record_motion                (GdkDevice            *device,
+                                               const GdkEventMotion *event);
 
 void _gdk_device_add_slave (GdkDevice *device,
                             GdkDevice *slave);
@@ -58,6 +58,9 @@ struct _GdkIOClosure
 /* Private variable declarations
  */
 
+/* Number of freed events whose storage is kept around for reuse */
+#define EVENT_POOL_SIZE 128
+
 static GdkEventFunc   _gdk_event_func = NULL;    /* Callback for events */
 static gpointer       _gdk_event_data = NULL;
 static GDestroyNotify _gdk_event_notify = NULL;
@@ -155,6 +158,24 @@ _gdk_event_queue_append (GdkDisplay *display,
   return display->queued_tail;
 }
 
+/* The siblings passed to the insert functions are almost always
+ * events that were just queued, so look for them from the tail.
+ */
+static GList *
+find_queued_event (GdkDisplay *display,
+                   GdkEvent   *event)
+{
+  GList *tmp_list;
+
+  for (tmp_list = display->queued_tail; tmp_list; tmp_list = tmp_list->prev)
+    {
+      if (tmp_list->data == event)
+        return tmp_list;
+    }
+
+  return NULL;
+}
+
 /**
  * _gdk_event_queue_insert_after:
  * @display: a #GdkDisplay
@@ -173,7 +194,7 @@ _gdk_event_queue_insert_after (GdkDisplay *display,
                                GdkEvent   *sibling,
                                GdkEvent   *event)
 {
-  GList *prev = g_list_find (display->queued_events, sibling);
+  GList *prev = find_queued_event (display, sibling);
   if (prev && prev->next)
     {
       display->queued_events = g_list_insert_before (display->queued_events, prev->next, event);
@@ -201,7 +222,7 @@ _gdk_event_queue_insert_before (GdkDisplay *display,
 				GdkEvent   *sibling,
 				GdkEvent   *event)
 {
-  GList *next = g_list_find (display->queued_events, sibling);
+  GList *next = find_queued_event (display, sibling);
   if (next)
     {
       display->queued_events = g_list_insert_before (display->queued_events, next, event);
@@ -306,8 +327,10 @@ _gdk_event_queue_handle_motion_compression (GdkDisplay *display)
   while (pending_motions && pending_motions->next != NULL)
     {
       GList *next = pending_motions->next;
-      display->queued_events = g_list_delete_link (display->queued_events,
-                                                   pending_motions);
+
+      _gdk_event_queue_remove_link (display, pending_motions);
+      gdk_event_free (pending_motions->data);
+      g_list_free_1 (pending_motions);
       pending_motions = next;
     }
 
@@ -488,6 +511,12 @@ gdk_event_put (const GdkEvent *event)
 
 static GHashTable *event_hash = NULL;
 
+/* Storage of freed events, recycled by gdk_event_new() so that
+ * high-rate input does not go back to the allocator for each event
+ */
+static GTrashStack *event_pool = NULL;
+static guint event_pool_size = 0;
+
 /**
  * gdk_event_new:
  * @type: a #GdkEventType 
@@ -508,10 +537,14 @@ gdk_event_new (GdkEventType type)
   if (!event_hash)
     event_hash = g_hash_table_new (g_direct_hash, NULL);
 
-  new_private = g_slice_new0 (GdkEventPrivate);
-  
-  new_private->flags = 0;
-  new_private->screen = NULL;
+  if (event_pool)
+    {
+      new_private = g_trash_stack_pop (&event_pool);
+      event_pool_size--;
+      memset (new_private, 0, sizeof (GdkEventPrivate));
+    }
+  else
+    new_private = g_slice_new0 (GdkEventPrivate);
 
   g_hash_table_insert (event_hash, new_private, GUINT_TO_POINTER (1));
 
@@ -811,7 +844,14 @@ gdk_event_free (GdkEvent *event)
     _gdk_display_event_data_free (display, event);
 
   g_hash_table_remove (event_hash, event);
-  g_slice_free (GdkEventPrivate, (GdkEventPrivate*) event);
+
+  if (event_pool_size < EVENT_POOL_SIZE)
+    {
+      g_trash_stack_push (&event_pool, event);
+      event_pool_size++;
+    }
+  else
+    g_slice_free (GdkEventPrivate, (GdkEventPrivate*) event);
 }
 
 /**
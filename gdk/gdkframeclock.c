@@ -26,6 +26,7 @@
 
 #include "gdkframeclockprivate.h"
 #include "gdkinternals.h"
+#include "gdkprofilerprivate.h"
 
 /**
  * SECTION:gdkframeclock
@@ -90,6 +91,9 @@ struct _GdkFrameClockPrivate
   gint n_timings;
   gint current;
   GdkFrameTimings *timings[FRAME_HISTORY_MAX_LENGTH];
+
+  /* Time the first input event since the last frame began was received */
+  gint64 pending_input_time;
 };
 
 static void
@@ -429,6 +433,55 @@ _gdk_frame_clock_begin_frame (GdkFrameClock *frame_clock)
     }
 
   priv->timings[priv->current] = _gdk_frame_timings_new (priv->frame_counter);
+  priv->timings[priv->current]->input_time = priv->pending_input_time;
+  priv->pending_input_time = 0;
+}
+
+/* Notes that an input event for one of the windows of this clock was
+ * received at @time (in g_get_monotonic_time() units). The oldest such
+ * time is attached to the timings of the next frame, so that we can
+ * tell how long input waited until its effect reached the screen.
+ */
+void
+_gdk_frame_clock_add_input_time (GdkFrameClock *frame_clock,
+                                 gint64         time)
+{
+  GdkFrameClockPrivate *priv;
+
+  g_return_if_fail (GDK_IS_FRAME_CLOCK (frame_clock));
+
+  priv = frame_clock->priv;
+
+  if (priv->pending_input_time == 0)
+    priv->pending_input_time = time;
+}
+
+/* Called by the backends once @timings is complete */
+void
+_gdk_frame_clock_report_input_latency (GdkFrameClock   *frame_clock,
+                                       GdkFrameTimings *timings)
+{
+  static guint latency_counter = 0;
+  gint64 now, end_time;
+
+  if (timings->input_time == 0 || !gdk_profiler_is_running ())
+    return;
+
+  if (latency_counter == 0)
+    latency_counter = gdk_profiler_define_int_counter ("input-latency",
+                                                       "Time from receiving input until the frame showing it was presented, in microseconds");
+
+  now = g_get_monotonic_time ();
+
+  /* Without a compositor reporting presentation times, the best we
+   * know is when the frame was completed.
+   */
+  if (timings->presentation_time != 0)
+    end_time = timings->presentation_time;
+  else
+    end_time = now;
+
+  gdk_profiler_set_int_counter (latency_counter, now * 1000, end_time - timings->input_time);
 }
 
 /**
@@ -523,6 +576,8 @@ _gdk_frame_clock_debug_print_timings (GdkFrameClock   *clock,
     g_print (" predicted=%-4.1f", (timings->predicted_presentation_time - timings->frame_time) / 1000.);
   if (timings->refresh_interval != 0)
     g_print (" refresh_interval=%-4.1f", timings->refresh_interval / 1000.);
+  if (timings->input_time != 0 && timings->presentation_time != 0)
+    g_print (" input_latency=%-4.1f", (timings->presentation_time - timings->input_time) / 1000.);
   g_print ("\n");
 }
 #endif /* G_ENABLE_DEBUG */
@@ -27,6 +27,7 @@
 #include "gdkinternals.h"
 #include "gdkframeclockprivate.h"
 #include "gdkframeclockidle.h"
+#include "gdkprofilerprivate.h"
 #include "gdk.h"
 
 #ifdef G_OS_WIN32
@@ -292,12 +293,34 @@ compute_min_next_frame_time (GdkFrameClockIdle *clock_idle,
     return presentation_time + refresh_interval / 2;
 }
 
+static void
+profiler_end_frame (gint64           begin,
+                    GdkFrameTimings *timings)
+{
+  static guint frame_counter = 0;
+  gint64 now;
+  char *message;
+
+  if (frame_counter == 0)
+    frame_counter = gdk_profiler_define_int_counter ("frame-duration",
+                                                     "Time spent in the paint idle, in microseconds");
+
+  message = g_strdup_printf ("frame %" G_GINT64_FORMAT,
+                             timings ? gdk_frame_timings_get_frame_counter (timings) : -1);
+  gdk_profiler_end_mark (begin, "frameclock", message);
+  g_free (message);
+
+  now = g_get_monotonic_time ();
+  gdk_profiler_set_int_counter (frame_counter, now * 1000, now - begin);
+}
+
 static gboolean
 gdk_frame_clock_flush_idle (void *data)
 {
   GdkFrameClock *clock = GDK_FRAME_CLOCK (data);
   GdkFrameClockIdle *clock_idle = GDK_FRAME_CLOCK_IDLE (clock);
   GdkFrameClockIdlePrivate *priv = clock_idle->priv;
+  gint64 begin;
 
   priv->flush_idle_id = 0;
 
@@ -307,7 +330,9 @@ gdk_frame_clock_flush_idle (void *data)
   priv->phase = GDK_FRAME_CLOCK_PHASE_FLUSH_EVENTS;
   priv->requested &= ~GDK_FRAME_CLOCK_PHASE_FLUSH_EVENTS;
 
+  begin = gdk_profiler_begin_mark ();
   g_signal_emit_by_name (G_OBJECT (clock), "flush-events");
+  gdk_profiler_end_mark (begin, "flush-events", NULL);
 
   if ((priv->requested & ~GDK_FRAME_CLOCK_PHASE_FLUSH_EVENTS) != 0 ||
       priv->updating_count > 0)
@@ -326,6 +351,9 @@ gdk_frame_clock_paint_idle (void *data)
   GdkFrameClockIdlePrivate *priv = clock_idle->priv;
   gboolean skip_to_resume_events;
   GdkFrameTimings *timings = NULL;
+  gint64 frame_begin, begin;
+
+  frame_begin = gdk_profiler_begin_mark ();
 
   priv->paint_idle_id = 0;
   priv->in_paint_idle = TRUE;
@@ -366,7 +394,9 @@ gdk_frame_clock_paint_idle (void *data)
                * in them.
                */
               priv->requested &= ~GDK_FRAME_CLOCK_PHASE_BEFORE_PAINT;
+              begin = gdk_profiler_begin_mark ();
               g_signal_emit_by_name (G_OBJECT (clock), "before-paint");
+              gdk_profiler_end_mark (begin, "before-paint", NULL);
               priv->phase = GDK_FRAME_CLOCK_PHASE_UPDATE;
             }
           /* fallthrough */
@@ -377,7 +407,9 @@ gdk_frame_clock_paint_idle (void *data)
                   priv->updating_count > 0)
                 {
                   priv->requested &= ~GDK_FRAME_CLOCK_PHASE_UPDATE;
+                  begin = gdk_profiler_begin_mark ();
                   g_signal_emit_by_name (G_OBJECT (clock), "update");
+                  gdk_profiler_end_mark (begin, "update", NULL);
                 }
             }
           /* fallthrough */
@@ -397,7 +429,9 @@ gdk_frame_clock_paint_idle (void *data)
               if (priv->requested & GDK_FRAME_CLOCK_PHASE_LAYOUT)
                 {
                   priv->requested &= ~GDK_FRAME_CLOCK_PHASE_LAYOUT;
+                  begin = gdk_profiler_begin_mark ();
                   g_signal_emit_by_name (G_OBJECT (clock), "layout");
+                  gdk_profiler_end_mark (begin, "layout", NULL);
                 }
             }
           /* fallthrough */
@@ -417,7 +451,9 @@ gdk_frame_clock_paint_idle (void *data)
               if (priv->requested & GDK_FRAME_CLOCK_PHASE_PAINT)
                 {
                   priv->requested &= ~GDK_FRAME_CLOCK_PHASE_PAINT;
+                  begin = gdk_profiler_begin_mark ();
                   g_signal_emit_by_name (G_OBJECT (clock), "paint");
+                  gdk_profiler_end_mark (begin, "paint", NULL);
                 }
             }
           /* fallthrough */
@@ -425,7 +461,9 @@ gdk_frame_clock_paint_idle (void *data)
           if (priv->freeze_count == 0)
             {
               priv->requested &= ~GDK_FRAME_CLOCK_PHASE_AFTER_PAINT;
+              begin = gdk_profiler_begin_mark ();
               g_signal_emit_by_name (G_OBJECT (clock), "after-paint");
+              gdk_profiler_end_mark (begin, "after-paint", NULL);
               /* the ::after-paint phase doesn't get repeated on freeze/thaw,
                */
               priv->phase = GDK_FRAME_CLOCK_PHASE_NONE;
@@ -452,7 +490,9 @@ gdk_frame_clock_paint_idle (void *data)
   if (priv->requested & GDK_FRAME_CLOCK_PHASE_RESUME_EVENTS)
     {
       priv->requested &= ~GDK_FRAME_CLOCK_PHASE_RESUME_EVENTS;
+      begin = gdk_profiler_begin_mark ();
       g_signal_emit_by_name (G_OBJECT (clock), "resume-events");
+      gdk_profiler_end_mark (begin, "resume-events", NULL);
     }
 
   if (priv->freeze_count == 0)
@@ -474,6 +514,9 @@ gdk_frame_clock_paint_idle (void *data)
   if (priv->freeze_count == 0)
     priv->sleep_serial = get_sleep_serial ();
 
+  if (frame_begin != 0)
+    profiler_end_frame (frame_begin, timings);
+
   return FALSE;
 }
 
@@ -93,6 +93,7 @@ struct _GdkFrameTimings
   gint64 presentation_time;
   gint64 refresh_interval;
   gint64 predicted_presentation_time;
+  gint64 input_time;
 
 #ifdef G_ENABLE_DEBUG
   gint64 layout_start_time;
@@ -111,6 +112,11 @@ void _gdk_frame_clock_begin_frame         (GdkFrameClock   *clock);
 void _gdk_frame_clock_debug_print_timings (GdkFrameClock   *clock,
                                            GdkFrameTimings *timings);
 
+void _gdk_frame_clock_add_input_time        (GdkFrameClock   *clock,
+                                             gint64           time);
+void _gdk_frame_clock_report_input_latency  (GdkFrameClock   *clock,
+                                             GdkFrameTimings *timings);
+
 GdkFrameTimings *_gdk_frame_timings_new (gint64 frame_counter);
 
 G_END_DECLS
@@ -0,0 +1,259 @@
+/* GDK - The GIMP Drawing Kit
+ * Copyright (C) 2013 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gdkframesink.h"
+
+#include "gdkthreads.h"
+#include "gdkwindow.h"
+
+/**
+ * SECTION:gdkframesink
+ * @Short_description: Hands frames from other threads to a window
+ * @Title: GdkFrameSink
+ *
+ * A #GdkFrameSink lets a thread other than the main thread, such as
+ * a video decoder, deliver frames to a #GdkWindow.
+ *
+ * The producing thread calls gdk_frame_sink_push_surface() for every
+ * frame it finishes. The sink only keeps the most recent frame, and
+ * schedules one invalidation of the window no matter how many frames
+ * are pushed before the main thread gets to it. The drawing code then
+ * picks up the latest frame with gdk_frame_sink_get_surface() when the
+ * window is painted. Frames are passed by reference and never copied.
+ *
+ * <example>
+ * <title>Drawing the latest frame</title>
+ * <programlisting>
+ * static gboolean
+ * draw_cb (GtkWidget *widget, cairo_t *cr, GdkFrameSink *sink)
+ * {
+ *   cairo_surface_t *frame;
+ *
+ *   frame = gdk_frame_sink_get_surface (sink);
+ *   if (frame)
+ *     {
+ *       cairo_set_source_surface (cr, frame, 0, 0);
+ *       cairo_paint (cr);
+ *       cairo_surface_destroy (frame);
+ *     }
+ *
+ *   return FALSE;
+ * }
+ * </programlisting>
+ * </example>
+ */
+
+typedef struct _GdkFrameSinkClass GdkFrameSinkClass;
+
+struct _GdkFrameSink
+{
+  GObject parent_instance;
+
+  GdkWindow *window;
+
+  /* Everything below is protected by the lock */
+  GMutex lock;
+  cairo_surface_t *surface;
+  cairo_region_t *damage;
+  guint damage_all : 1;
+  guint invalidate_id;
+};
+
+struct _GdkFrameSinkClass
+{
+  GObjectClass parent_class;
+};
+
+G_DEFINE_TYPE (GdkFrameSink, gdk_frame_sink, G_TYPE_OBJECT)
+
+static void
+gdk_frame_sink_finalize (GObject *object)
+{
+  GdkFrameSink *sink = GDK_FRAME_SINK (object);
+
+  g_clear_pointer (&sink->surface, cairo_surface_destroy);
+  g_clear_pointer (&sink->damage, cairo_region_destroy);
+  g_clear_object (&sink->window);
+  g_mutex_clear (&sink->lock);
+
+  G_OBJECT_CLASS (gdk_frame_sink_parent_class)->finalize (object);
+}
+
+static void
+gdk_frame_sink_class_init (GdkFrameSinkClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = gdk_frame_sink_finalize;
+}
+
+static void
+gdk_frame_sink_init (GdkFrameSink *sink)
+{
+  g_mutex_init (&sink->lock);
+}
+
+/**
+ * gdk_frame_sink_new:
+ * @window: the #GdkWindow to deliver frames to
+ *
+ * Creates a new #GdkFrameSink for @window. This must be called
+ * from the main thread.
+ *
+ * Returns: (transfer full): a new #GdkFrameSink
+ *
+ * Since: 3.12
+ */
+GdkFrameSink *
+gdk_frame_sink_new (GdkWindow *window)
+{
+  GdkFrameSink *sink;
+
+  g_return_val_if_fail (GDK_IS_WINDOW (window), NULL);
+
+  sink = g_object_new (GDK_TYPE_FRAME_SINK, NULL);
+  sink->window = g_object_ref (window);
+
+  return sink;
+}
+
+/**
+ * gdk_frame_sink_get_window:
+ * @sink: a #GdkFrameSink
+ *
+ * Returns the window that @sink delivers frames to.
+ *
+ * Returns: (transfer none): the #GdkWindow of @sink
+ *
+ * Since: 3.12
+ */
+GdkWindow *
+gdk_frame_sink_get_window (GdkFrameSink *sink)
+{
+  g_return_val_if_fail (GDK_IS_FRAME_SINK (sink), NULL);
+
+  return sink->window;
+}
+
+static gboolean
+gdk_frame_sink_invalidate (gpointer data)
+{
+  GdkFrameSink *sink = data;
+  cairo_region_t *damage;
+  gboolean damage_all;
+
+  g_mutex_lock (&sink->lock);
+  damage = sink->damage;
+  damage_all = sink->damage_all;
+  sink->damage = NULL;
+  sink->damage_all = FALSE;
+  sink->invalidate_id = 0;
+  g_mutex_unlock (&sink->lock);
+
+  if (damage_all)
+    gdk_window_invalidate_rect (sink->window, NULL, FALSE);
+  else if (damage)
+    gdk_window_invalidate_region (sink->window, damage, FALSE);
+
+  if (damage)
+    cairo_region_destroy (damage);
+
+  return G_SOURCE_REMOVE;
+}
+
+/**
+ * gdk_frame_sink_push_surface:
+ * @sink: a #GdkFrameSink
+ * @surface: (allow-none): the new frame, or %NULL to clear it
+ * @area: (allow-none): the area of the window that changed, or
+ *     %NULL for all of it
+ *
+ * Makes @surface the current frame of @sink, replacing the previous
+ * one, and causes @area to be repainted. The surface is referenced,
+ * not copied, so it must not be changed after pushing it.
+ *
+ * This function can be called from any thread.
+ *
+ * Since: 3.12
+ */
+void
+gdk_frame_sink_push_surface (GdkFrameSink       *sink,
+                             cairo_surface_t    *surface,
+                             const GdkRectangle *area)
+{
+  cairo_surface_t *old_surface;
+
+  g_return_if_fail (GDK_IS_FRAME_SINK (sink));
+
+  g_mutex_lock (&sink->lock);
+
+  old_surface = sink->surface;
+  sink->surface = surface ? cairo_surface_reference (surface) : NULL;
+
+  if (area == NULL)
+    sink->damage_all = TRUE;
+  else if (!sink->damage_all)
+    {
+      if (sink->damage)
+        cairo_region_union_rectangle (sink->damage, area);
+      else
+        sink->damage = cairo_region_create_rectangle (area);
+    }
+
+  /* Frames pushed before the main thread ran share one invalidation */
+  if (sink->invalidate_id == 0)
+    sink->invalidate_id = gdk_threads_add_idle_full (G_PRIORITY_HIGH_IDLE,
+                                                     gdk_frame_sink_invalidate,
+                                                     g_object_ref (sink),
+                                                     g_object_unref);
+
+  g_mutex_unlock (&sink->lock);
+
+  if (old_surface)
+    cairo_surface_destroy (old_surface);
+}
+
+/**
+ * gdk_frame_sink_get_surface:
+ * @sink: a #GdkFrameSink
+ *
+ * Returns the most recently pushed frame of @sink. This is usually
+ * called when drawing the window.
+ *
+ * This function can be called from any thread.
+ *
+ * Returns: (transfer full): the current frame, or %NULL if there is
+ *     none. Free with cairo_surface_destroy().
+ *
+ * Since: 3.12
+ */
+cairo_surface_t *
+gdk_frame_sink_get_surface (GdkFrameSink *sink)
+{
+  cairo_surface_t *surface = NULL;
+
+  g_return_val_if_fail (GDK_IS_FRAME_SINK (sink), NULL);
+
+  g_mutex_lock (&sink->lock);
+  if (sink->surface)
+    surface = cairo_surface_reference (sink->surface);
+  g_mutex_unlock (&sink->lock);
+
+  return surface;
+}
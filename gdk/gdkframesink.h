@@ -0,0 +1,52 @@
+/* GDK - The GIMP Drawing Kit
+ * Copyright (C) 2013 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined (__GDK_H_INSIDE__) && !defined (GDK_COMPILATION)
+#error "Only <gdk/gdk.h> can be included directly."
+#endif
+
+#ifndef __GDK_FRAME_SINK_H__
+#define __GDK_FRAME_SINK_H__
+
+#include <gdk/gdkversionmacros.h>
+#include <gdk/gdktypes.h>
+
+G_BEGIN_DECLS
+
+#define GDK_TYPE_FRAME_SINK            (gdk_frame_sink_get_type ())
+#define GDK_FRAME_SINK(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), GDK_TYPE_FRAME_SINK, GdkFrameSink))
+#define GDK_IS_FRAME_SINK(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GDK_TYPE_FRAME_SINK))
+
+typedef struct _GdkFrameSink              GdkFrameSink;
+
+GDK_AVAILABLE_IN_3_12
+GType            gdk_frame_sink_get_type     (void) G_GNUC_CONST;
+
+GDK_AVAILABLE_IN_3_12
+GdkFrameSink    *gdk_frame_sink_new          (GdkWindow          *window);
+GDK_AVAILABLE_IN_3_12
+GdkWindow       *gdk_frame_sink_get_window   (GdkFrameSink       *sink);
+GDK_AVAILABLE_IN_3_12
+void             gdk_frame_sink_push_surface (GdkFrameSink       *sink,
+                                              cairo_surface_t    *surface,
+                                              const GdkRectangle *area);
+GDK_AVAILABLE_IN_3_12
+cairo_surface_t *gdk_frame_sink_get_surface  (GdkFrameSink       *sink);
+
+G_END_DECLS
+
+#endif /* __GDK_FRAME_SINK_H__ */
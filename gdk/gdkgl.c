@@ -145,6 +145,31 @@ make_program (GdkGLContextProgram *program,
   program->flip_location = glGetUniformLocation (program->program, "flipColors");
 }
 
+/* Programs can be used by every context in a share group, so take them
+ * from the shared context if it already compiled them, and hand the ones
+ * we compile back to it for the next context.
+ */
+static void
+ensure_program (GdkGLContextProgram *program,
+                GdkGLContextProgram *shared_program,
+                const char          *vertex_shader_path,
+                const char          *fragment_shader_path)
+{
+  if (program->program != 0)
+    return;
+
+  if (shared_program != NULL && shared_program->program != 0)
+    {
+      *program = *shared_program;
+      return;
+    }
+
+  make_program (program, vertex_shader_path, fragment_shader_path);
+
+  if (shared_program != NULL && program->program != 0)
+    *shared_program = *program;
+}
+
 static void
 bind_vao (GdkGLContextPaintData *paint_data)
 {
@@ -159,8 +184,8 @@ bind_vao (GdkGLContextPaintData *paint_data)
 static void
 use_texture_gles_program (GdkGLContextPaintData *paint_data)
 {
-  if (paint_data->texture_2d_quad_program.program == 0)
-    make_program (&paint_data->texture_2d_quad_program,
+  ensure_program (&paint_data->texture_2d_quad_program,
+                  paint_data->shared ? &paint_data->shared->texture_2d_quad_program : NULL,
                   "/org/gtk/libgdk/glsl/gles2-texture.vs.glsl",
                   "/org/gtk/libgdk/glsl/gles2-texture.fs.glsl");
 
@@ -182,8 +207,9 @@ use_texture_2d_program (GdkGLContextPaintData *paint_data)
     ? "/org/gtk/libgdk/glsl/gl2-texture-2d.fs.glsl"
     : "/org/gtk/libgdk/glsl/gl3-texture-2d.fs.glsl";
 
-  if (paint_data->texture_2d_quad_program.program == 0)
-    make_program (&paint_data->texture_2d_quad_program, vertex_shader_path, fragment_shader_path);
+  ensure_program (&paint_data->texture_2d_quad_program,
+                  paint_data->shared ? &paint_data->shared->texture_2d_quad_program : NULL,
+                  vertex_shader_path, fragment_shader_path);
 
   if (paint_data->current_program != &paint_data->texture_2d_quad_program)
     {
@@ -203,8 +229,9 @@ use_texture_rect_program (GdkGLContextPaintData *paint_data)
     ? "/org/gtk/libgdk/glsl/gl2-texture-rect.fs.glsl"
     : "/org/gtk/libgdk/glsl/gl3-texture-rect.vs.glsl";
 
-  if (paint_data->texture_rect_quad_program.program == 0)
-    make_program (&paint_data->texture_rect_quad_program, vertex_shader_path, fragment_shader_path);
+  ensure_program (&paint_data->texture_rect_quad_program,
+                  paint_data->shared ? &paint_data->shared->texture_rect_quad_program : NULL,
+                  vertex_shader_path, fragment_shader_path);
 
   if (paint_data->current_program != &paint_data->texture_rect_quad_program)
     {
@@ -646,6 +673,9 @@ gdk_cairo_draw_from_gl (cairo_t              *cr,
       /* Software fallback */
       int major, minor, version;
       gboolean es_read_bgra = FALSE;
+      cairo_format_t format;
+      GdkRectangle clip;
+      int read_x, read_y, read_width, read_height;
 
 #ifdef GDK_WINDOWING_WIN32
       /* on ANGLE GLES, we need to set the glReadPixel() format as GL_BGRA instead */
@@ -663,12 +693,41 @@ gdk_cairo_draw_from_gl (cairo_t              *cr,
           !(version >= 300 || gdk_gl_context_has_unpack_subimage (paint_context)))
         goto out;
 
-      /* TODO: avoid reading back non-required data due to dest clip */
-      image = cairo_surface_create_similar_image (cairo_get_target (cr),
-                                                  (alpha_size == 0) ? CAIRO_FORMAT_RGB24 : CAIRO_FORMAT_ARGB32,
-                                                  width, height);
+      /* Only read back the part of the source that ends up inside the
+       * clip. The clip is in user space, where the source covers
+       * width x height pixels at buffer_scale, flipped vertically.
+       */
+      if (!gdk_cairo_get_clip_rectangle (cr, &clip))
+        goto out;
+
+      read_x = MAX (clip.x * buffer_scale, 0);
+      read_y = MAX (height - (clip.y + clip.height) * buffer_scale, 0);
+      read_width = MIN ((clip.x + clip.width) * buffer_scale, width) - read_x;
+      read_height = MIN (height - clip.y * buffer_scale, height) - read_y;
 
-      cairo_surface_set_device_scale (image, buffer_scale, buffer_scale);
+      if (read_width <= 0 || read_height <= 0)
+        goto out;
+
+      /* Reuse the image surface from the last frame if it fits */
+      format = (alpha_size == 0) ? CAIRO_FORMAT_RGB24 : CAIRO_FORMAT_ARGB32;
+      image = paint_data->readback_surface;
+      if (image == NULL ||
+          cairo_image_surface_get_format (image) != format ||
+          cairo_image_surface_get_width (image) != read_width ||
+          cairo_image_surface_get_height (image) != read_height)
+        {
+          g_clear_pointer (&paint_data->readback_surface, cairo_surface_destroy);
+          image = cairo_surface_create_similar_image (cairo_get_target (cr), format,
+                                                      read_width, read_height);
+          cairo_surface_set_device_scale (image, buffer_scale, buffer_scale);
+          paint_data->readback_surface = image;
+        }
+      else
+        {
+          /* Detaches any snapshots the last frame's drawing took */
+          cairo_surface_flush (image);
+          cairo_surface_set_device_scale (image, buffer_scale, buffer_scale);
+        }
 
       framebuffer = paint_data->tmp_framebuffer;
       glBindFramebuffer (GL_FRAMEBUFFER, framebuffer);
@@ -691,10 +750,12 @@ gdk_cairo_draw_from_gl (cairo_t              *cr,
 
       /* The implicit format conversion is going to make this path slower */
       if (!gdk_gl_context_get_use_es (paint_context))
-        glReadPixels (x, y, width, height, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV,
+        glReadPixels (x + read_x, y + read_y, read_width, read_height,
+                      GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV,
                       cairo_image_surface_get_data (image));
       else
-        glReadPixels (x, y, width, height, es_read_bgra ? GL_BGRA : GL_RGBA, GL_UNSIGNED_BYTE,
+        glReadPixels (x + read_x, y + read_y, read_width, read_height,
+                      es_read_bgra ? GL_BGRA : GL_RGBA, GL_UNSIGNED_BYTE,
                       cairo_image_surface_get_data (image));
 
       glPixelStorei (GL_PACK_ROW_LENGTH, 0);
@@ -707,11 +768,11 @@ gdk_cairo_draw_from_gl (cairo_t              *cr,
       cairo_scale (cr, 1, -1);
       cairo_translate (cr, 0, -height / buffer_scale);
 
-      cairo_set_source_surface (cr, image, 0, 0);
+      cairo_set_source_surface (cr, image,
+                                (double) read_x / buffer_scale,
+                                (double) read_y / buffer_scale);
       cairo_set_operator (cr, CAIRO_OPERATOR_OVER);
       cairo_paint (cr);
-
-      cairo_surface_destroy (image);
     }
 
 out:
@@ -726,13 +787,13 @@ gdk_gl_texture_from_surface (cairo_surface_t *surface,
 			     cairo_region_t  *region)
 {
   GdkGLContext *paint_context;
+  GdkGLContextPaintData *paint_data;
   cairo_surface_t *image;
   double device_x_offset, device_y_offset;
   cairo_rectangle_int_t rect, e;
   int n_rects, i;
   GdkWindow *window;
   int unscaled_window_height;
-  unsigned int texture_id;
   int window_scale;
   double sx, sy;
   float umax, vmax;
@@ -758,19 +819,40 @@ gdk_gl_texture_from_surface (cairo_surface_t *surface,
   cairo_surface_get_device_offset (surface,
                                    &device_x_offset, &device_y_offset);
 
-  glGenTextures (1, &texture_id);
   if (use_texture_rectangle)
     target = GL_TEXTURE_RECTANGLE_ARB;
   else
     target = GL_TEXTURE_2D;
 
-  glBindTexture (target, texture_id);
-  glEnable (GL_SCISSOR_TEST);
+  /* Keep the texture around between calls, so that uploading the damaged
+   * rectangles only has to reallocate its storage when it grows.
+   */
+  paint_data = gdk_gl_context_get_paint_data (paint_context);
+  if (paint_data->upload_texture != 0 &&
+      paint_data->upload_texture_target != target)
+    {
+      glDeleteTextures (1, &paint_data->upload_texture);
+      paint_data->upload_texture = 0;
+    }
 
-  glTexParameteri (target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-  glTexParameteri (target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-  glTexParameteri (target, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-  glTexParameteri (target, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  if (paint_data->upload_texture == 0)
+    {
+      glGenTextures (1, &paint_data->upload_texture);
+      paint_data->upload_texture_target = target;
+      paint_data->upload_texture_width = 0;
+      paint_data->upload_texture_height = 0;
+
+      glBindTexture (target, paint_data->upload_texture);
+
+      glTexParameteri (target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+      glTexParameteri (target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+      glTexParameteri (target, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+      glTexParameteri (target, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+  else
+    glBindTexture (target, paint_data->upload_texture);
+
+  glEnable (GL_SCISSOR_TEST);
 
   n_rects = cairo_region_num_rectangles (region);
 
@@ -792,7 +874,15 @@ gdk_gl_texture_from_surface (cairo_surface_t *surface,
       e.height *= sy;
       image = cairo_surface_map_to_image (surface, &e);
 
-      gdk_gl_context_upload_texture (paint_context, image, e.width, e.height, target);
+      if (e.width > paint_data->upload_texture_width ||
+          e.height > paint_data->upload_texture_height)
+        {
+          gdk_gl_context_upload_texture (paint_context, image, e.width, e.height, target);
+          paint_data->upload_texture_width = e.width;
+          paint_data->upload_texture_height = e.height;
+        }
+      else
+        gdk_gl_context_update_texture (paint_context, image, e.width, e.height, target);
 
       cairo_surface_unmap_image (surface, image);
 
@@ -803,8 +893,8 @@ gdk_gl_texture_from_surface (cairo_surface_t *surface,
         }
       else
         {
-          umax = 1.0;
-          vmax = 1.0;
+          umax = (float) e.width / paint_data->upload_texture_width;
+          vmax = (float) e.height / paint_data->upload_texture_height;
         }
 
       {
@@ -824,5 +914,4 @@ gdk_gl_texture_from_surface (cairo_surface_t *surface,
 #undef FLIP_Y
 
   glDisable (GL_SCISSOR_TEST);
-  glDeleteTextures (1, &texture_id);
 }
@@ -143,6 +143,8 @@ gdk_gl_context_dispose (GObject *gobject)
   g_clear_object (&priv->display);
   g_clear_object (&priv->window);
   g_clear_object (&priv->shared_context);
+  if (priv->paint_data)
+    priv->paint_data->shared = NULL;
 
   G_OBJECT_CLASS (gdk_gl_context_parent_class)->dispose (gobject);
 }
@@ -153,6 +155,8 @@ gdk_gl_context_finalize (GObject *gobject)
   GdkGLContext *context = GDK_GL_CONTEXT (gobject);
   GdkGLContextPrivate *priv = gdk_gl_context_get_instance_private (context);
 
+  if (priv->paint_data)
+    g_clear_pointer (&priv->paint_data->readback_surface, cairo_surface_destroy);
   g_clear_pointer (&priv->paint_data, g_free);
   G_OBJECT_CLASS (gdk_gl_context_parent_class)->finalize (gobject);
 }
@@ -236,17 +240,16 @@ gdk_gl_context_get_property (GObject    *gobject,
     }
 }
 
-void
-gdk_gl_context_upload_texture (GdkGLContext    *context,
-                               cairo_surface_t *image_surface,
-                               int              width,
-                               int              height,
-                               guint            texture_target)
+static void
+upload_texture (GdkGLContext    *context,
+                cairo_surface_t *image_surface,
+                int              width,
+                int              height,
+                guint            texture_target,
+                gboolean         allocate)
 {
   GdkGLContextPrivate *priv = gdk_gl_context_get_instance_private (context);
 
-  g_return_if_fail (GDK_IS_GL_CONTEXT (context));
-
   /* GL_UNPACK_ROW_LENGTH is available on desktop GL, OpenGL ES >= 3.0, or if
    * the GL_EXT_unpack_subimage extension for OpenGL ES 2.0 is available
    */
@@ -257,11 +260,23 @@ gdk_gl_context_upload_texture (GdkGLContext    *context,
       glPixelStorei (GL_UNPACK_ROW_LENGTH, cairo_image_surface_get_stride (image_surface) / 4);
 
       if (priv->use_es)
-        glTexImage2D (texture_target, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
-                      cairo_image_surface_get_data (image_surface));
+        {
+          if (allocate)
+            glTexImage2D (texture_target, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                          cairo_image_surface_get_data (image_surface));
+          else
+            glTexSubImage2D (texture_target, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE,
+                             cairo_image_surface_get_data (image_surface));
+        }
       else
-        glTexImage2D (texture_target, 0, GL_RGBA, width, height, 0, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV,
-                      cairo_image_surface_get_data (image_surface));
+        {
+          if (allocate)
+            glTexImage2D (texture_target, 0, GL_RGBA, width, height, 0, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV,
+                          cairo_image_surface_get_data (image_surface));
+          else
+            glTexSubImage2D (texture_target, 0, 0, 0, width, height, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV,
+                             cairo_image_surface_get_data (image_surface));
+        }
 
       glPixelStorei (GL_UNPACK_ROW_LENGTH, 0);
     }
@@ -273,14 +288,16 @@ gdk_gl_context_upload_texture (GdkGLContext    *context,
 
       if (priv->use_es)
         {
-          glTexImage2D (texture_target, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+          if (allocate)
+            glTexImage2D (texture_target, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
 
           for (i = 0; i < height; i++)
             glTexSubImage2D (texture_target, 0, 0, i, width, 1, GL_RGBA, GL_UNSIGNED_BYTE, (unsigned char*) data + (i * stride));
         }
       else
         {
-          glTexImage2D (texture_target, 0, GL_RGBA, width, height, 0, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, NULL);
+          if (allocate)
+            glTexImage2D (texture_target, 0, GL_RGBA, width, height, 0, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, NULL);
 
           for (i = 0; i < height; i++)
             glTexSubImage2D (texture_target, 0, 0, i, width, 1, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, (unsigned char*) data + (i * stride));
@@ -288,6 +305,34 @@ gdk_gl_context_upload_texture (GdkGLContext    *context,
     }
 }
 
+void
+gdk_gl_context_upload_texture (GdkGLContext    *context,
+                               cairo_surface_t *image_surface,
+                               int              width,
+                               int              height,
+                               guint            texture_target)
+{
+  g_return_if_fail (GDK_IS_GL_CONTEXT (context));
+
+  upload_texture (context, image_surface, width, height, texture_target, TRUE);
+}
+
+/* Like gdk_gl_context_upload_texture(), but writes into the top-left
+ * corner of the storage of the currently bound texture, which must be
+ * at least @width x @height, instead of reallocating it.
+ */
+void
+gdk_gl_context_update_texture (GdkGLContext    *context,
+                               cairo_surface_t *image_surface,
+                               int              width,
+                               int              height,
+                               guint            texture_target)
+{
+  g_return_if_fail (GDK_IS_GL_CONTEXT (context));
+
+  upload_texture (context, image_surface, width, height, texture_target, FALSE);
+}
+
 static gboolean
 gdk_gl_context_real_realize (GdkGLContext  *self,
                              GError       **error)
@@ -404,6 +449,16 @@ gdk_gl_context_get_paint_data (GdkGLContext *context)
       priv->paint_data = g_new0 (GdkGLContextPaintData, 1);
       priv->paint_data->is_legacy = priv->is_legacy;
       priv->paint_data->use_es = priv->use_es;
+
+      if (priv->shared_context != NULL)
+        {
+          GdkGLContextPaintData *shared;
+
+          shared = gdk_gl_context_get_paint_data (priv->shared_context);
+          if (shared->is_legacy == priv->paint_data->is_legacy &&
+              shared->use_es == priv->paint_data->use_es)
+            priv->paint_data->shared = shared;
+        }
     }
 
   return priv->paint_data;
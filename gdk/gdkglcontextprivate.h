@@ -59,7 +59,13 @@ typedef struct {
   guint flip_location;
 } GdkGLContextProgram;
 
-typedef struct {
+typedef struct _GdkGLContextPaintData GdkGLContextPaintData;
+
+struct _GdkGLContextPaintData
+{
+  /* paint data of the shared context, if it is compatible */
+  GdkGLContextPaintData *shared;
+
   guint vertex_array_object;
   guint tmp_framebuffer;
   guint tmp_vertex_buffer;
@@ -69,9 +75,18 @@ typedef struct {
 
   GdkGLContextProgram *current_program;
 
+  /* reused by the software fallback of gdk_cairo_draw_from_gl() */
+  cairo_surface_t *readback_surface;
+
+  /* reused by the software fallback of gdk_gl_texture_from_surface() */
+  guint upload_texture;
+  guint upload_texture_target;
+  int upload_texture_width;
+  int upload_texture_height;
+
   guint is_legacy : 1;
   guint use_es : 1;
-} GdkGLContextPaintData;
+};
 
 void                    gdk_gl_context_set_is_legacy            (GdkGLContext    *context,
                                                                  gboolean         is_legacy);
@@ -81,6 +96,11 @@ void                    gdk_gl_context_upload_texture           (GdkGLContext
                                                                  int              width,
                                                                  int              height,
                                                                  guint            texture_target);
+void                    gdk_gl_context_update_texture           (GdkGLContext    *context,
+                                                                 cairo_surface_t *image_surface,
+                                                                 int              width,
+                                                                 int              height,
+                                                                 guint            texture_target);
 GdkGLContextPaintData * gdk_gl_context_get_paint_data           (GdkGLContext    *context);
 gboolean                gdk_gl_context_use_texture_rectangle    (GdkGLContext    *context);
 gboolean                gdk_gl_context_has_framebuffer_blit     (GdkGLContext    *context);
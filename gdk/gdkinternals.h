@@ -247,6 +247,10 @@ struct _GdkWindow
 
   guint num_offscreen_children;
 
+  /* Index of the children by position, used for finding the child
+     under the pointer. Built on demand, NULL when out of date */
+  struct _GdkWindowChildIndex *child_index;
+
   /* The clip region is the part of the window, in window coordinates
      that is fully or partially (i.e. semi transparently) visible in
      the window hierarchy from the toplevel and down */
@@ -262,6 +266,12 @@ struct _GdkWindow
   GHashTable *device_cursor;
 
   GSList *implicit_paint;
+  /* The surface of the last implicit paint, kept so that the next
+     one does not have to allocate a new one */
+  cairo_surface_t *implicit_paint_cache;
+  gint implicit_paint_cache_width;
+  gint implicit_paint_cache_height;
+  gint implicit_paint_cache_scale;
 
   GList *outstanding_moves;
 
@@ -340,6 +350,7 @@ void       _gdk_window_destroy           (GdkWindow      *window,
                                           gboolean        foreign_destroy);
 void       _gdk_window_clear_update_area (GdkWindow      *window);
 void       _gdk_window_update_size       (GdkWindow      *window);
+void       _gdk_window_invalidate_child_index (GdkWindow *window);
 gboolean   _gdk_window_update_viewable   (GdkWindow      *window);
 
 void       _gdk_window_process_updates_recurse (GdkWindow *window,
@@ -48,6 +48,15 @@ gboolean              gdk_init_check                      (gint           *argc,
                                                            gchar        ***argv);
 void                  gdk_add_option_entries_libgtk_only  (GOptionGroup   *group);
 void                  gdk_pre_parse_libgtk_only           (void);
+gint64                gdk_profiler_begin_mark_libgtk_only (void);
+void                  gdk_profiler_end_mark_libgtk_only   (gint64          begin,
+                                                           const char     *name,
+                                                           const char     *message);
+guint                 gdk_profiler_define_int_counter_libgtk_only (const char *name,
+                                                                   const char *description);
+void                  gdk_profiler_set_int_counter_libgtk_only    (guint       id,
+                                                                   gint64      time,
+                                                                   gint64      value);
 
 const gchar *         gdk_get_program_class               (void);
 void                  gdk_set_program_class               (const gchar    *program_class);
@@ -195,7 +195,10 @@ gdk_offscreen_window_reparent (GdkWindow *window,
   gdk_window_hide (window);
 
   if (window->parent)
-    window->parent->children = g_list_remove (window->parent->children, window);
+    {
+      window->parent->children = g_list_remove (window->parent->children, window);
+      _gdk_window_invalidate_child_index (window->parent);
+    }
 
   old_parent = window->parent;
   window->parent = new_parent;
@@ -203,7 +206,10 @@ gdk_offscreen_window_reparent (GdkWindow *window,
   window->y = y;
 
   if (new_parent)
-    window->parent->children = g_list_prepend (window->parent->children, window);
+    {
+      window->parent->children = g_list_prepend (window->parent->children, window);
+      _gdk_window_invalidate_child_index (window->parent);
+    }
 
   _gdk_synthesize_crossing_events_for_geometry_change (window);
   if (old_parent)
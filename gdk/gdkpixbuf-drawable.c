@@ -167,6 +167,13 @@ convert_alpha (guchar *dest_data,
           dest_data[x * 4 + 1] = 0;
           dest_data[x * 4 + 2] = 0;
         }
+      else if (alpha == 255)
+        {
+          /* Nothing to unpremultiply */
+          dest_data[x * 4 + 0] = src[x] >> 16;
+          dest_data[x * 4 + 1] = src[x] >>  8;
+          dest_data[x * 4 + 2] = src[x];
+        }
       else
         {
           dest_data[x * 4 + 0] = (((src[x] & 0xff0000) >> 16) * 255 + alpha / 2) / alpha;
@@ -20,6 +20,7 @@
 
 #include "config.h"
 
+#include <stdlib.h>
 #include <sys/types.h>
 
 #ifdef HAVE_UNISTD_H
@@ -228,3 +229,65 @@ gdk_profiler_set_int_counter (guint  id,
 }
 
 #endif /* G_OS_WIN32 */
+
+/* Convenience for timing a block of code:
+ *
+ *   gint64 begin = gdk_profiler_begin_mark ();
+ *   ...
+ *   gdk_profiler_end_mark (begin, "name", NULL);
+ *
+ * This only reads the clock if the profiler is running.
+ */
+gint64
+gdk_profiler_begin_mark (void)
+{
+  if (!gdk_profiler_is_running ())
+    return 0;
+
+  return g_get_monotonic_time ();
+}
+
+void
+gdk_profiler_end_mark (gint64      begin,
+                       const char *name,
+                       const char *message)
+{
+  gint64 now;
+
+  if (begin == 0 || !gdk_profiler_is_running ())
+    return;
+
+  now = g_get_monotonic_time ();
+  /* sysprof uses nanoseconds of the monotonic clock */
+  gdk_profiler_add_mark (begin * 1000, (now - begin) * 1000,
+                         name, message ? message : "");
+}
+
+gint64
+gdk_profiler_begin_mark_libgtk_only (void)
+{
+  return gdk_profiler_begin_mark ();
+}
+
+void
+gdk_profiler_end_mark_libgtk_only (gint64      begin,
+                                   const char *name,
+                                   const char *message)
+{
+  gdk_profiler_end_mark (begin, name, message);
+}
+
+guint
+gdk_profiler_define_int_counter_libgtk_only (const char *name,
+                                             const char *description)
+{
+  return gdk_profiler_define_int_counter (name, description);
+}
+
+void
+gdk_profiler_set_int_counter_libgtk_only (guint  id,
+                                          gint64 time,
+                                          gint64 value)
+{
+  gdk_profiler_set_int_counter (id, time, value);
+}
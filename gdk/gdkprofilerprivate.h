@@ -41,6 +41,11 @@ void     gdk_profiler_set_int_counter    (guint       id,
                                           gint64      time,
                                           gint64      value);
 
+gint64   gdk_profiler_begin_mark         (void);
+void     gdk_profiler_end_mark           (gint64      begin,
+                                          const char *name,
+                                          const char *message);
+
 G_END_DECLS
 
 #endif  /* __GDK_PROFILER_PRIVATE_H__ */
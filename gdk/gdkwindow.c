@@ -38,6 +38,8 @@
 #include "gdkvisualprivate.h"
 #include "gdkmarshalers.h"
 #include "gdkframeclockidle.h"
+#include "gdkframeclockprivate.h"
+#include "gdkprofilerprivate.h"
 #include "gdkwindowimpl.h"
 
 #include <math.h>
@@ -187,6 +189,8 @@ struct _GdkWindowPaint
   cairo_region_t *region;
   cairo_surface_t *surface;
   cairo_region_t *flushed;
+  /* The size of the surface of an implicit paint */
+  gint width, height;
   guint8 alpha;
   guint uses_implicit : 1;
 };
@@ -201,6 +205,7 @@ typedef struct {
 static void             gdk_window_drop_cairo_surface (GdkWindow *private);
 
 static void gdk_window_free_paint_stack (GdkWindow *window);
+static void gdk_window_drop_implicit_paint_cache (GdkWindow *window);
 
 static void gdk_window_finalize   (GObject              *object);
 
@@ -573,6 +578,8 @@ gdk_window_finalize (GObject *object)
   if (window->input_shape)
     cairo_region_destroy (window->input_shape);
 
+  _gdk_window_invalidate_child_index (window);
+
   if (window->cursor)
     g_object_unref (window->cursor);
 
@@ -1116,7 +1123,12 @@ recompute_visible_regions_internal (GdkWindow *private,
       should_apply_clip_as_shape (private))
     apply_clip_as_shape (private);
 
+  /* Input-only windows are never removed from the clip of their siblings
+   * or parent (see remove_child_area()), so moving or restacking them
+   * can't change it. Widgets like buttons move such windows on every
+   * size allocation, so this saves a lot of work. */
   if (recalculate_siblings &&
+      !private->input_only &&
       !gdk_window_is_toplevel (private))
     {
       /* If we moved a child window in parent or changed the stacking order, then we
@@ -1176,6 +1188,8 @@ recompute_visible_regions (GdkWindow *private,
 void
 _gdk_window_update_size (GdkWindow *window)
 {
+  _gdk_window_invalidate_child_index (window);
+  _gdk_window_invalidate_child_index (window->parent);
   recompute_visible_regions (window, TRUE, FALSE);
 }
 
@@ -1480,7 +1494,10 @@ gdk_window_new (GdkWindow     *parent,
     }
 
   if (window->parent)
-    window->parent->children = g_list_prepend (window->parent->children, window);
+    {
+      window->parent->children = g_list_prepend (window->parent->children, window);
+      _gdk_window_invalidate_child_index (window->parent);
+    }
 
   if (window->parent->window_type == GDK_WINDOW_ROOT)
     {
@@ -1700,13 +1717,17 @@ gdk_window_reparent (GdkWindow *window,
     }
 
   if (old_parent)
-    old_parent->children = g_list_remove (old_parent->children, window);
+    {
+      old_parent->children = g_list_remove (old_parent->children, window);
+      _gdk_window_invalidate_child_index (old_parent);
+    }
 
   window->parent = new_parent;
   window->x = x;
   window->y = y;
 
   new_parent->children = g_list_prepend (new_parent->children, window);
+  _gdk_window_invalidate_child_index (new_parent);
 
   /* Switch the window type as appropriate */
 
@@ -2066,6 +2087,7 @@ _gdk_window_destroy_hierarchy (GdkWindow *window,
 	    {
 	      if (window->parent->children)
 		window->parent->children = g_list_remove (window->parent->children, window);
+	      _gdk_window_invalidate_child_index (window->parent);
 
 	      if (!recursing &&
 		  GDK_WINDOW_IS_MAPPED (window))
@@ -2082,6 +2104,7 @@ _gdk_window_destroy_hierarchy (GdkWindow *window,
             }
 
 	  gdk_window_free_paint_stack (window);
+	  gdk_window_drop_implicit_paint_cache (window);
 
           if (window->background)
             {
@@ -2095,6 +2118,7 @@ _gdk_window_destroy_hierarchy (GdkWindow *window,
 	    {
 	      children = tmp = window->children;
 	      window->children = NULL;
+	      _gdk_window_invalidate_child_index (window);
 
 	      while (tmp)
 		{
@@ -2769,11 +2793,93 @@ gdk_window_get_content (GdkWindow *window)
  * The implicit paint will be automatically ended if someone draws
  * directly to the window or a child window.
  */
+static void
+gdk_window_drop_implicit_paint_cache (GdkWindow *window)
+{
+  if (window->implicit_paint_cache)
+    {
+      cairo_surface_destroy (window->implicit_paint_cache);
+      window->implicit_paint_cache = NULL;
+    }
+}
+
+/* Returns the cached implicit paint surface if it can hold @rect, with
+ * @region (in impl window coordinates) cleared, or %NULL.
+ */
+static cairo_surface_t *
+gdk_window_reuse_implicit_paint_cache (GdkWindow            *window,
+                                       GdkRectangle         *rect,
+                                       cairo_content_t       content,
+                                       const cairo_region_t *region)
+{
+  cairo_surface_t *surface = window->implicit_paint_cache;
+  cairo_t *cr;
+
+  if (surface == NULL)
+    return NULL;
+
+  if (cairo_surface_get_content (surface) != content ||
+      window->implicit_paint_cache_scale != gdk_window_get_scale_factor (window) ||
+      window->implicit_paint_cache_width < rect->width ||
+      window->implicit_paint_cache_height < rect->height)
+    {
+      gdk_window_drop_implicit_paint_cache (window);
+      return NULL;
+    }
+
+  window->implicit_paint_cache = NULL;
+
+  cairo_surface_set_device_offset (surface, -rect->x, -rect->y);
+
+  /* A new surface starts out cleared, and the paint relies on that
+   * for translucent backgrounds. Only clear what will be drawn, not
+   * the whole surface.
+   */
+  cr = cairo_create (surface);
+  cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
+  gdk_cairo_region (cr, region);
+  cairo_fill (cr);
+  cairo_destroy (cr);
+
+  return surface;
+}
+
+/* Keeps the surface of an implicit paint that has ended for the next
+ * one. This is only done for the outermost implicit paint, and only
+ * if nobody else holds on to the surface.
+ */
+static void
+gdk_window_cache_implicit_paint (GdkWindow      *window,
+                                 GdkWindowPaint *paint)
+{
+  if (window->implicit_paint != NULL ||
+      GDK_WINDOW_DESTROYED (window) ||
+      cairo_surface_get_type (paint->surface) == CAIRO_SURFACE_TYPE_RECORDING ||
+      cairo_surface_get_reference_count (paint->surface) != 1)
+    {
+      cairo_surface_destroy (paint->surface);
+      return;
+    }
+
+  gdk_window_drop_implicit_paint_cache (window);
+
+  window->implicit_paint_cache = paint->surface;
+  window->implicit_paint_cache_width = paint->width;
+  window->implicit_paint_cache_height = paint->height;
+  window->implicit_paint_cache_scale = gdk_window_get_scale_factor (window);
+}
+
+/* @region, if not %NULL, is the area that will be painted, in impl
+ * window coordinates. Only then may the surface of an earlier implicit
+ * paint be reused.
+ */
 static gboolean
 gdk_window_begin_implicit_paint (GdkWindow *window, GdkRectangle *rect,
+				 const cairo_region_t *region,
 				 gboolean with_alpha, guint8 alpha)
 {
   GdkWindowPaint *paint;
+  cairo_content_t content;
 
   g_assert (gdk_window_has_impl (window));
 
@@ -2796,11 +2902,27 @@ gdk_window_begin_implicit_paint (GdkWindow *window, GdkRectangle *rect,
   paint->uses_implicit = FALSE;
   paint->flushed = NULL;
   paint->alpha = alpha;
-  paint->surface = gdk_window_create_similar_surface (window,
-						      with_alpha ? CAIRO_CONTENT_COLOR_ALPHA : gdk_window_get_content (window),
-		                                      MAX (rect->width, 1),
-                                                      MAX (rect->height, 1));
-  cairo_surface_set_device_offset (paint->surface, -rect->x, -rect->y);
+
+  content = with_alpha ? CAIRO_CONTENT_COLOR_ALPHA : gdk_window_get_content (window);
+
+  paint->surface = NULL;
+  if (region != NULL && window->implicit_paint == NULL)
+    paint->surface = gdk_window_reuse_implicit_paint_cache (window, rect, content, region);
+
+  if (paint->surface != NULL)
+    {
+      paint->width = window->implicit_paint_cache_width;
+      paint->height = window->implicit_paint_cache_height;
+    }
+  else
+    {
+      paint->width = MAX (rect->width, 1);
+      paint->height = MAX (rect->height, 1);
+      paint->surface = gdk_window_create_similar_surface (window, content,
+                                                          paint->width,
+                                                          paint->height);
+      cairo_surface_set_device_offset (paint->surface, -rect->x, -rect->y);
+    }
 
   window->implicit_paint = g_slist_prepend (window->implicit_paint, paint);
 
@@ -2965,7 +3087,7 @@ gdk_window_end_implicit_paint (GdkWindow *window)
   cairo_region_destroy (paint->region);
   if (paint->flushed)
     cairo_region_destroy (paint->flushed);
-  cairo_surface_destroy (paint->surface);
+  gdk_window_cache_implicit_paint (window, paint);
   g_free (paint);
 }
 
@@ -3446,6 +3568,14 @@ move_region_on_impl (GdkWindow *impl_window,
 
   g_assert (impl_window == gdk_window_get_impl_window (impl_window));
 
+  /* Backends that can't copy bits around get the destination redrawn */
+  if (GDK_WINDOW_IMPL_GET_CLASS (impl_window->impl)->translate == NULL)
+    {
+      impl_window_add_update_area (impl_window, region);
+      cairo_region_destroy (region);
+      return;
+    }
+
   /* Move any old invalid regions in the copy source area by dx/dy */
   if (impl_window->update_area)
     {
@@ -3996,7 +4126,7 @@ _gdk_window_process_updates_recurse (GdkWindow *window,
       cairo_region_get_extents (expose_region, &clip_box);
       clip_box.x += window->abs_x;
       clip_box.y += window->abs_y;
-      end_implicit = gdk_window_begin_implicit_paint (window->impl_window, &clip_box, TRUE, window->alpha);
+      end_implicit = gdk_window_begin_implicit_paint (window->impl_window, &clip_box, NULL, TRUE, window->alpha);
     }
 
   /* Paint the window before the children, clipped to the window region
@@ -4088,6 +4218,9 @@ gdk_window_process_updates_internal (GdkWindow *window)
   gboolean save_region = FALSE;
   GdkRectangle clip_box;
   int iteration;
+  gint64 begin;
+
+  begin = gdk_profiler_begin_mark ();
 
   /* Ensure the window lives while updating it */
   g_object_ref (window);
@@ -4203,7 +4336,7 @@ gdk_window_process_updates_internal (GdkWindow *window)
 	   */
 
 	  cairo_region_get_extents (update_area, &clip_box);
-	  end_implicit = gdk_window_begin_implicit_paint (window, &clip_box, FALSE, 255);
+	  end_implicit = gdk_window_begin_implicit_paint (window, &clip_box, update_area, FALSE, 255);
 	  expose_region = cairo_region_copy (update_area);
 	  impl_class = GDK_WINDOW_IMPL_GET_CLASS (window->impl);
 	  if (!end_implicit)
@@ -4250,6 +4383,8 @@ gdk_window_process_updates_internal (GdkWindow *window)
   window->in_update = FALSE;
 
   g_object_unref (window);
+
+  gdk_profiler_end_mark (begin, "process-updates", NULL);
 }
 
 static void
@@ -4536,12 +4671,45 @@ draw_ugly_color (GdkWindow       *window,
   cairo_destroy (cr);
 }
 
+/* Updates areas that grow past this many rectangles are replaced by
+ * their bounding box, if that doesn't more than double the area to
+ * repaint. Many small damaged spots close to each other, like cells
+ * of a list, are cheaper to repaint in one go than to keep track of.
+ */
+#define MAX_UPDATE_RECTS 32
+
+static void
+simplify_update_area (cairo_region_t *update_area)
+{
+  cairo_rectangle_int_t extents, rect;
+  gint64 area;
+  int i, n_rects;
+
+  n_rects = cairo_region_num_rectangles (update_area);
+  if (n_rects <= MAX_UPDATE_RECTS)
+    return;
+
+  area = 0;
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_region_get_rectangle (update_area, i, &rect);
+      area += (gint64) rect.width * rect.height;
+    }
+
+  cairo_region_get_extents (update_area, &extents);
+  if ((gint64) extents.width * extents.height <= 2 * area)
+    cairo_region_union_rectangle (update_area, &extents);
+}
+
 static void
 impl_window_add_update_area (GdkWindow *impl_window,
 			     cairo_region_t *region)
 {
   if (impl_window->update_area)
-    cairo_region_union (impl_window->update_area, region);
+    {
+      cairo_region_union (impl_window->update_area, region);
+      simplify_update_area (impl_window->update_area);
+    }
   else
     {
       gdk_window_add_update_window (impl_window);
@@ -4550,6 +4718,51 @@ impl_window_add_update_area (GdkWindow *impl_window,
     }
 }
 
+static gboolean
+has_native_descendants (GdkWindow *window)
+{
+  GList *l;
+
+  for (l = window->children; l != NULL; l = l->next)
+    {
+      GdkWindow *child = l->data;
+
+      if (gdk_window_has_impl (child) || has_native_descendants (child))
+	return TRUE;
+    }
+
+  return FALSE;
+}
+
+/* Returns %TRUE if invalidating @region of @window can't change
+ * anything, because all of it is already going to be repainted.
+ * Widgets often invalidate the same spots many times per frame, and
+ * this saves clipping @region against the window hierarchy for each
+ * of them. Native descendants have update areas of their own, so
+ * they always need to be looked at.
+ */
+static gboolean
+gdk_window_region_is_invalid (GdkWindow            *window,
+			      const cairo_region_t *region,
+			      GdkWindowChildFunc    child_func)
+{
+  GdkWindow *impl_window;
+  cairo_rectangle_int_t extents;
+
+  impl_window = gdk_window_get_impl_window (window);
+  if (impl_window->update_area == NULL || debug_updates)
+    return FALSE;
+
+  cairo_region_get_extents (region, &extents);
+  extents.x += window->abs_x;
+  extents.y += window->abs_y;
+
+  if (cairo_region_contains_rectangle (impl_window->update_area, &extents) != CAIRO_REGION_OVERLAP_IN)
+    return FALSE;
+
+  return child_func == NULL || !has_native_descendants (window);
+}
+
 /* clear_bg controls if the region will be cleared to
  * the background pattern if the exposure mask is not
  * set for the window, whereas this might not otherwise be
@@ -4582,6 +4795,9 @@ gdk_window_invalidate_maybe_recurse_full (GdkWindow            *window,
       window->window_type == GDK_WINDOW_ROOT)
     return;
 
+  if (gdk_window_region_is_invalid (window, region, child_func))
+    return;
+
   visible_region = gdk_window_get_visible_region (window);
   cairo_region_intersect (visible_region, region);
 
@@ -4594,34 +4810,36 @@ gdk_window_invalidate_maybe_recurse_full (GdkWindow            *window,
 	{
 	  cairo_region_t *child_region;
 	  GdkRectangle child_rect;
-
-	  child_rect.x = child->x;
-	  child_rect.y = child->y;
-	  child_rect.width = child->width;
-	  child_rect.height = child->height;
-	  child_region = cairo_region_create_rectangle (&child_rect);
+	  gboolean subtract, recurse;
 
 	  /* remove child area from the invalid area of the parent */
-	  if (GDK_WINDOW_IS_MAPPED (child) && !child->shaped &&
-	      !child->composited &&
-	      !gdk_window_is_offscreen (child))
-	    cairo_region_subtract (visible_region, child_region);
+	  subtract = GDK_WINDOW_IS_MAPPED (child) && !child->shaped &&
+	             !child->composited &&
+	             !gdk_window_is_offscreen (child);
+	  recurse = child_func && (*child_func) ((GdkWindow *)child, user_data);
 
-	  if (child_func && (*child_func) ((GdkWindow *)child, user_data))
+	  if (subtract || recurse)
 	    {
-	      cairo_region_t *tmp = cairo_region_copy (region);
+	      child_rect.x = child->x;
+	      child_rect.y = child->y;
+	      child_rect.width = child->width;
+	      child_rect.height = child->height;
+	      child_region = cairo_region_create_rectangle (&child_rect);
 
-	      cairo_region_translate (tmp, - child_rect.x, - child_rect.y);
-	      cairo_region_translate (child_region, - child_rect.x, - child_rect.y);
-	      cairo_region_intersect (child_region, tmp);
+	      if (subtract)
+		cairo_region_subtract (visible_region, child_region);
 
-	      gdk_window_invalidate_maybe_recurse_full ((GdkWindow *)child,
-							child_region, clear_bg, child_func, user_data);
+	      if (recurse)
+		{
+		  cairo_region_intersect (child_region, region);
+		  cairo_region_translate (child_region, - child_rect.x, - child_rect.y);
 
-	      cairo_region_destroy (tmp);
-	    }
+		  gdk_window_invalidate_maybe_recurse_full ((GdkWindow *)child,
+							    child_region, clear_bg, child_func, user_data);
+		}
 
-	  cairo_region_destroy (child_region);
+	      cairo_region_destroy (child_region);
+	    }
 	}
 
       tmp_list = tmp_list->next;
@@ -5316,6 +5534,7 @@ gdk_window_raise_internal (GdkWindow *window)
     {
       parent->children = g_list_remove (parent->children, window);
       parent->children = g_list_prepend (parent->children, window);
+      _gdk_window_invalidate_child_index (parent);
     }
 
   impl_class = GDK_WINDOW_IMPL_GET_CLASS (window->impl);
@@ -5579,6 +5798,7 @@ gdk_window_lower_internal (GdkWindow *window)
     {
       parent->children = g_list_remove (parent->children, window);
       parent->children = g_list_append (parent->children, window);
+      _gdk_window_invalidate_child_index (parent);
     }
 
   impl_class = GDK_WINDOW_IMPL_GET_CLASS (window->impl);
@@ -5756,6 +5976,7 @@ gdk_window_restack (GdkWindow     *window,
 	parent->children = g_list_insert_before (parent->children,
 						 sibling_link->next,
 						 window);
+      _gdk_window_invalidate_child_index (parent);
 
       impl_class = GDK_WINDOW_IMPL_GET_CLASS (window->impl);
       if (gdk_window_has_impl (window))
@@ -6341,6 +6562,8 @@ gdk_window_move_resize_internal (GdkWindow *window,
       window->height = height;
     }
 
+  _gdk_window_invalidate_child_index (window->parent);
+
   dx = window->x - old_x;
   dy = window->y - old_y;
 
@@ -7917,12 +8140,33 @@ _gdk_window_add_damage (GdkWindow *toplevel,
 {
   GdkDisplay *display;
   GdkEvent event = { 0, };
+  GList *l;
+
+  /* Fold the damage into a damage event that is still queued for the
+   * same window, so that the embedder only redraws once for all the
+   * paints that happened since it last looked.
+   */
+  display = gdk_window_get_display (toplevel);
+  for (l = display->queued_tail; l; l = l->prev)
+    {
+      GdkEventPrivate *pending = l->data;
+
+      if (pending->event.any.type == GDK_DAMAGE &&
+          pending->event.any.window == toplevel &&
+          (pending->flags & GDK_EVENT_PENDING) == 0)
+        {
+          cairo_region_union (pending->event.expose.region, damaged_region);
+          cairo_region_get_extents (pending->event.expose.region,
+                                    &pending->event.expose.area);
+          return;
+        }
+    }
+
   event.expose.type = GDK_DAMAGE;
   event.expose.window = toplevel;
   event.expose.send_event = FALSE;
   event.expose.region = damaged_region;
   cairo_region_get_extents (event.expose.region, &event.expose.area);
-  display = gdk_window_get_display (event.expose.window);
   _gdk_event_queue_append (display, gdk_event_copy (&event));
 }
 
@@ -8107,6 +8351,203 @@ pick_embedded_child (GdkWindow *window,
   return res;
 }
 
+/* Windows with many children, like a GtkLayout full of widgets, keep
+ * an index of the children for finding the one under the pointer. The
+ * window is split into a grid of cells, and every cell lists the
+ * children that overlap it, topmost first. A lookup then only has to
+ * look at the children in one cell instead of all of them.
+ *
+ * The index only depends on the stacking order and the geometry of
+ * the children, whether they are mapped and their shapes are checked
+ * when looking up. It is dropped whenever the children change and
+ * rebuilt when it is needed next.
+ */
+
+/* Windows with fewer children are searched linearly */
+#define CHILD_INDEX_THRESHOLD 16
+#define CHILD_INDEX_MAX_CELLS 16 /* per row and column */
+
+typedef struct _GdkWindowChildIndex GdkWindowChildIndex;
+
+struct _GdkWindowChildIndex
+{
+  gint width;
+  gint height;
+  gint n_columns;
+  gint n_rows;
+  gint cell_width;
+  gint cell_height;
+  GPtrArray **cells; /* NULL if the children are not indexed */
+};
+
+void
+_gdk_window_invalidate_child_index (GdkWindow *window)
+{
+  GdkWindowChildIndex *index;
+  gint i;
+
+  if (window == NULL || window->child_index == NULL)
+    return;
+
+  index = window->child_index;
+  window->child_index = NULL;
+
+  if (index->cells)
+    {
+      for (i = 0; i < index->n_columns * index->n_rows; i++)
+        if (index->cells[i])
+          g_ptr_array_unref (index->cells[i]);
+      g_free (index->cells);
+    }
+
+  g_slice_free (GdkWindowChildIndex, index);
+}
+
+static GdkWindowChildIndex *
+gdk_window_get_child_index (GdkWindow *window)
+{
+  GdkWindowChildIndex *index;
+  gint n_children;
+  gint side;
+  GList *l;
+
+  index = window->child_index;
+
+  /* Backends can resize windows behind our back */
+  if (index &&
+      (index->width != window->width ||
+       index->height != window->height))
+    {
+      _gdk_window_invalidate_child_index (window);
+      index = NULL;
+    }
+
+  if (index)
+    return index;
+
+  index = g_slice_new0 (GdkWindowChildIndex);
+  index->width = window->width;
+  index->height = window->height;
+  window->child_index = index;
+
+  /* Toplevels are positioned by the window manager, so the root
+   * window is never indexed */
+  if (window->window_type == GDK_WINDOW_ROOT)
+    return index;
+
+  n_children = 0;
+  for (l = window->children; l != NULL; l = l->next)
+    {
+      /* Offscreen children can be transformed arbitrarily */
+      if (gdk_window_is_offscreen (l->data))
+        return index;
+      n_children++;
+    }
+
+  if (n_children < CHILD_INDEX_THRESHOLD)
+    return index;
+
+  side = 1;
+  while (side < CHILD_INDEX_MAX_CELLS &&
+         (side + 1) * (side + 1) <= n_children)
+    side++;
+
+  index->n_columns = MIN (side, window->width);
+  index->n_rows = MIN (side, window->height);
+  index->cell_width = (window->width + index->n_columns - 1) / index->n_columns;
+  index->cell_height = (window->height + index->n_rows - 1) / index->n_rows;
+  index->cells = g_new0 (GPtrArray *, index->n_columns * index->n_rows);
+
+  /* Children is ordered in reverse stack order, i.e. first is topmost */
+  for (l = window->children; l != NULL; l = l->next)
+    {
+      GdkWindow *child = l->data;
+      gint x1, y1, x2, y2;
+      gint column, row;
+
+      x1 = MAX (child->x, 0);
+      y1 = MAX (child->y, 0);
+      x2 = MIN (child->x + child->width, window->width);
+      y2 = MIN (child->y + child->height, window->height);
+
+      /* Only the part inside the window can be hit */
+      if (x1 >= x2 || y1 >= y2)
+        continue;
+
+      for (row = y1 / index->cell_height; row <= (y2 - 1) / index->cell_height; row++)
+        for (column = x1 / index->cell_width; column <= (x2 - 1) / index->cell_width; column++)
+          {
+            GPtrArray **cell = &index->cells[row * index->n_columns + column];
+
+            if (*cell == NULL)
+              *cell = g_ptr_array_new ();
+            g_ptr_array_add (*cell, child);
+          }
+    }
+
+  return index;
+}
+
+/* Returns the topmost mapped child of window containing x, y, which
+ * must be inside window. Offscreen children picked through the
+ * pick-embedded-child signal are not considered.
+ */
+static GdkWindow *
+find_mapped_child_at (GdkWindow *window,
+                      gdouble    x,
+                      gdouble    y,
+                      gdouble   *child_x,
+                      gdouble   *child_y)
+{
+  GdkWindowChildIndex *index;
+  GdkWindow *sub;
+  GList *l;
+
+  index = gdk_window_get_child_index (window);
+
+  if (index->cells)
+    {
+      GPtrArray *cell;
+      gint column, row;
+      guint i;
+
+      column = CLAMP ((gint) x / index->cell_width, 0, index->n_columns - 1);
+      row = CLAMP ((gint) y / index->cell_height, 0, index->n_rows - 1);
+      cell = index->cells[row * index->n_columns + column];
+      if (cell == NULL)
+        return NULL;
+
+      for (i = 0; i < cell->len; i++)
+        {
+          sub = g_ptr_array_index (cell, i);
+
+          if (!GDK_WINDOW_IS_MAPPED (sub))
+            continue;
+
+          gdk_window_coords_from_parent (sub, x, y, child_x, child_y);
+          if (point_in_window (sub, *child_x, *child_y))
+            return sub;
+        }
+
+      return NULL;
+    }
+
+  /* Children is ordered in reverse stack order, i.e. first is topmost */
+  for (l = window->children; l != NULL; l = l->next)
+    {
+      sub = l->data;
+
+      if (!GDK_WINDOW_IS_MAPPED (sub))
+        continue;
+
+      gdk_window_coords_from_parent (sub, x, y, child_x, child_y);
+      if (point_in_window (sub, *child_x, *child_y))
+        return sub;
+    }
+
+  return NULL;
+}
+
 GdkWindow *
 _gdk_window_find_child_at (GdkWindow *window,
 			   double     x,
@@ -8114,24 +8555,12 @@ _gdk_window_find_child_at (GdkWindow *window,
 {
   GdkWindow *sub;
   double child_x, child_y;
-  GList *l;
 
   if (point_in_window (window, x, y))
     {
-      /* Children is ordered in reverse stack order, i.e. first is topmost */
-      for (l = window->children; l != NULL; l = l->next)
-	{
-	  sub = l->data;
-
-	  if (!GDK_WINDOW_IS_MAPPED (sub))
-	    continue;
-
-	  gdk_window_coords_from_parent ((GdkWindow *)sub,
-                                         x, y,
-                                         &child_x, &child_y);
-	  if (point_in_window (sub, child_x, child_y))
-	    return (GdkWindow *)sub;
-	}
+      sub = find_mapped_child_at (window, x, y, &child_x, &child_y);
+      if (sub)
+        return sub;
 
       if (window->num_offscreen_children > 0)
 	{
@@ -8154,7 +8583,6 @@ _gdk_window_find_descendant_at (GdkWindow *window,
 {
   GdkWindow *sub;
   gdouble child_x, child_y;
-  GList *l;
   gboolean found;
 
   if (point_in_window (window, x, y))
@@ -8162,25 +8590,13 @@ _gdk_window_find_descendant_at (GdkWindow *window,
       do
 	{
 	  found = FALSE;
-	  /* Children is ordered in reverse stack order, i.e. first is topmost */
-	  for (l = window->children; l != NULL; l = l->next)
+	  sub = find_mapped_child_at (window, x, y, &child_x, &child_y);
+	  if (sub)
 	    {
-	      sub = l->data;
-
-	      if (!GDK_WINDOW_IS_MAPPED (sub))
-		continue;
-
-	      gdk_window_coords_from_parent ((GdkWindow *)sub,
-                                             x, y,
-                                             &child_x, &child_y);
-	      if (point_in_window (sub, child_x, child_y))
-		{
-		  x = child_x;
-		  y = child_y;
-		  window = sub;
-		  found = TRUE;
-		  break;
-		}
+	      x = child_x;
+	      y = child_y;
+	      window = sub;
+	      found = TRUE;
 	    }
 	  if (!found &&
 	      window->num_offscreen_children > 0)
@@ -10165,12 +10581,37 @@ _gdk_windowing_got_event (GdkDisplay *display,
           unlink_event = TRUE;
           goto out;
         }
+
+      if (event->type == GDK_MOTION_NOTIFY)
+        _gdk_device_record_motion (device, &event->motion);
     }
 
   event_window = event->any.window;
   if (!event_window)
     goto out;
 
+  switch ((guint) event->type)
+    {
+    case GDK_MOTION_NOTIFY:
+    case GDK_BUTTON_PRESS:
+    case GDK_BUTTON_RELEASE:
+    case GDK_KEY_PRESS:
+    case GDK_KEY_RELEASE:
+    case GDK_SCROLL:
+    case GDK_TOUCH_BEGIN:
+    case GDK_TOUCH_UPDATE:
+    case GDK_TOUCH_END:
+      {
+        GdkFrameClock *clock = gdk_window_get_frame_clock (event_window);
+
+        if (clock)
+          _gdk_frame_clock_add_input_time (clock, g_get_monotonic_time ());
+      }
+      break;
+    default:
+      break;
+    }
+
 #ifdef DEBUG_WINDOW_PRINTING
   if (event->type == GDK_KEY_PRESS &&
       (event->key.keyval == 0xa7 ||
@@ -10389,9 +10830,14 @@ gdk_window_create_similar_surface (GdkWindow *     window,
       }
       break;
     case GDK_RENDERING_MODE_IMAGE:
-      surface = cairo_image_surface_create (content == CAIRO_CONTENT_COLOR ? CAIRO_FORMAT_RGB24 :
-                                            content == CAIRO_CONTENT_ALPHA ? CAIRO_FORMAT_A8 : CAIRO_FORMAT_ARGB32,
-                                            width * sx, height * sy);
+      /* Let the backend pick the image: for a local X server, cairo
+       * puts it in a MIT-SHM segment, so it gets to the window without
+       * being copied over the socket.
+       */
+      surface = cairo_surface_create_similar_image (window_surface,
+                                                    content == CAIRO_CONTENT_COLOR ? CAIRO_FORMAT_RGB24 :
+                                                    content == CAIRO_CONTENT_ALPHA ? CAIRO_FORMAT_A8 : CAIRO_FORMAT_ARGB32,
+                                                    width * sx, height * sy);
 #ifdef HAVE_CAIRO_SURFACE_SET_DEVICE_SCALE
       cairo_surface_set_device_scale (surface, sx, sy);
 #endif
@@ -573,6 +573,16 @@
   if (GDK_WINDOW_DESTROYED (gdk_window))
     return;
 
+  /* Clear our own bookkeeping of regions that need display. This has
+   * to happen before bailing out below, since Cocoa considers the view
+   * displayed either way.
+   */
+  if (impl->needs_display_region)
+    {
+      cairo_region_destroy (impl->needs_display_region);
+      impl->needs_display_region = NULL;
+    }
+
   if (! (gdk_window->event_mask & GDK_EXPOSURE_MASK))
     return;
 
@@ -598,13 +608,6 @@
       return;
     }
 
-  /* Clear our own bookkeeping of regions that need display */
-  if (impl->needs_display_region)
-    {
-      cairo_region_destroy (impl->needs_display_region);
-      impl->needs_display_region = NULL;
-    }
-
   [self getRectsBeingDrawn: &drawn_rects count: &count];
   region = cairo_region_create ();
 
@@ -436,23 +436,33 @@ gdk_quartz_window_set_needs_display_in_region (GdkWindow    *window,
                                                cairo_region_t    *region)
 {
   GdkWindowImplQuartz *impl;
+  cairo_region_t *new_region;
   int i, n_rects;
 
   impl = GDK_WINDOW_IMPL_QUARTZ (window->impl);
 
-  if (!impl->needs_display_region)
+  /* Only pass on the parts that are not already pending, so that
+   * repeated small invalidations between two drawRect: calls don't
+   * keep growing the dirty area of the view.
+   */
+  new_region = cairo_region_copy (region);
+  if (impl->needs_display_region)
+    cairo_region_subtract (new_region, impl->needs_display_region);
+  else
     impl->needs_display_region = cairo_region_create ();
 
-  cairo_region_union (impl->needs_display_region, region);
+  cairo_region_union (impl->needs_display_region, new_region);
 
-  n_rects = cairo_region_num_rectangles (region);
+  n_rects = cairo_region_num_rectangles (new_region);
   for (i = 0; i < n_rects; i++)
     {
       cairo_rectangle_int_t rect;
-      cairo_region_get_rectangle (region, i, &rect);
+      cairo_region_get_rectangle (new_region, i, &rect);
       [impl->view setNeedsDisplayInRect:NSMakeRect (rect.x, rect.y,
                                                     rect.width, rect.height)];
     }
+
+  cairo_region_destroy (new_region);
 }
 
 void
@@ -71,56 +71,25 @@ G_DEFINE_TYPE (GdkWaylandCursor, _gdk_wayland_cursor, GDK_TYPE_CURSOR)
 
 static guint theme_serial = 0;
 
-struct cursor_cache_key
-{
-  GdkCursorType type;
-  const char *name;
-};
-
+/* Only named cursors are cached, by name */
 static void
 add_to_cache (GdkWaylandDisplay *display, GdkWaylandCursor *cursor)
 {
-  display->cursor_cache = g_slist_prepend (display->cursor_cache, cursor);
+  if (display->cursor_cache == NULL)
+    display->cursor_cache = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                   NULL, g_object_unref);
 
-  g_object_ref (cursor);
-}
-
-static gint
-cache_compare_func (gconstpointer listelem,
-                    gconstpointer target)
-{
-  GdkWaylandCursor *cursor = (GdkWaylandCursor *) listelem;
-  struct cursor_cache_key* key = (struct cursor_cache_key *) target;
-
-  if (cursor->cursor.type != key->type)
-    return 1; /* No match */
-
-  /* Elements marked as pixmap must be named cursors
-   * (since we don't store normal pixmap cursors
-   */
-  if (key->type == GDK_CURSOR_IS_PIXMAP)
-    return strcmp (key->name, cursor->name);
-
-  return 0; /* Match */
+  g_hash_table_insert (display->cursor_cache, cursor->name, g_object_ref (cursor));
 }
 
 static GdkWaylandCursor*
 find_in_cache (GdkWaylandDisplay *display,
-               GdkCursorType      type,
                const char        *name)
 {
-  GSList* res;
-  struct cursor_cache_key key;
-
-  key.type = type;
-  key.name = name;
-
-  res = g_slist_find_custom (display->cursor_cache, &key, cache_compare_func);
-
-  if (res)
-    return (GdkWaylandCursor *) res->data;
+  if (display->cursor_cache == NULL || name == NULL)
+    return NULL;
 
-  return NULL;
+  return g_hash_table_lookup (display->cursor_cache, name);
 }
 
 /* Called by gdk_wayland_display_finalize to flush any cached cursors
@@ -129,8 +98,8 @@ find_in_cache (GdkWaylandDisplay *display,
 void
 _gdk_wayland_display_finalize_cursors (GdkWaylandDisplay *display)
 {
-  g_slist_foreach (display->cursor_cache, (GFunc) g_object_unref, NULL);
-  g_slist_free (display->cursor_cache);
+  if (display->cursor_cache)
+    g_hash_table_destroy (display->cursor_cache);
 }
 
 static gboolean
@@ -159,7 +128,15 @@ void
 _gdk_wayland_display_update_cursors (GdkWaylandDisplay      *display,
                                      struct wl_cursor_theme *theme)
 {
-  g_slist_foreach (display->cursor_cache, (GFunc) set_cursor_from_theme, theme);
+  GHashTableIter iter;
+  gpointer cursor;
+
+  if (display->cursor_cache == NULL)
+    return;
+
+  g_hash_table_iter_init (&iter, display->cursor_cache);
+  while (g_hash_table_iter_next (&iter, NULL, &cursor))
+    set_cursor_from_theme (cursor, theme);
 }
 
 static void
@@ -302,7 +279,7 @@ _gdk_wayland_display_get_cursor_for_name (GdkDisplay  *display,
 
   g_return_val_if_fail (GDK_IS_DISPLAY (display), NULL);
 
-  private = find_in_cache (wayland_display, GDK_CURSOR_IS_PIXMAP, name);
+  private = find_in_cache (wayland_display, name);
   if (private)
     {
       /* Cache had it, add a ref for this user */
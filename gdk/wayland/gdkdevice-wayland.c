@@ -1447,41 +1447,51 @@ typedef struct
   GdkWaylandDeviceData *device;
   DataOffer *offer;
   GIOChannel *channel;
+  GByteArray *content;
   GdkDeviceWaylandRequestContentCallback cb;
   gpointer userdata;
 } RequestContentClosure;
 
+/* Reads whatever the source has written so far, without waiting for
+ * more, so that a big or slow transfer doesn't block the main loop.
+ */
 static gboolean
 _request_content_io_func (GIOChannel *channel,
                           GIOCondition condition,
                           gpointer userdata)
 {
   RequestContentClosure *closure = (RequestContentClosure *)userdata;
-  gchar *data = NULL;
-  gsize len = 0;
+  gchar buf[4096];
+  gsize len;
+  GIOStatus status;
   GError *error = NULL;
 
-  /* FIXME: We probably want to do something better than this to avoid
-   * blocking on the transfer of large pieces of data: call the callback
-   * multiple times I should think.
-   */
-  if (g_io_channel_read_to_end (channel,
-                                &data,
-                                &len,
-                                &error) != G_IO_STATUS_NORMAL)
+  do
+    {
+      len = 0;
+      status = g_io_channel_read_chars (channel, buf, sizeof (buf), &len, &error);
+      g_byte_array_append (closure->content, (guint8 *) buf, len);
+    }
+  while (status == G_IO_STATUS_NORMAL);
+
+  if (status == G_IO_STATUS_AGAIN)
+    return TRUE;
+
+  if (status == G_IO_STATUS_ERROR)
     {
       g_warning (G_STRLOC ": Error reading content from pipe: %s", error->message);
       g_clear_error (&error);
     }
 
-  /* Since we use _read_to_end we've got a guaranteed EOF and thus can go
-   * ahead and close the fd
-   */
   g_io_channel_shutdown (channel, TRUE, NULL);
 
-  closure->cb (closure->device->pointer, data, len, closure->userdata);
+  len = closure->content->len;
+  /* Keep the data nul-terminated, like it is for text targets */
+  g_byte_array_append (closure->content, (guint8 *) "", 1);
+
+  closure->cb (closure->device->pointer, (gchar *) closure->content->data, len, closure->userdata);
 
-  g_free (data);
+  g_byte_array_unref (closure->content);
   data_offer_unref (closure->offer);
   g_io_channel_unref (channel);
   g_free (closure);
@@ -1524,19 +1534,21 @@ gdk_wayland_device_request_selection_content (GdkDevice
   closure->device = device;
   closure->offer = device->selection_offer;
   closure->channel = g_io_channel_unix_new (pipe_fd[0]);
+  closure->content = g_byte_array_new ();
   closure->cb = cb;
   closure->userdata = userdata;
 
-  if (!g_io_channel_set_encoding (closure->channel, NULL, &error))
+  if (!g_io_channel_set_encoding (closure->channel, NULL, &error) ||
+      g_io_channel_set_flags (closure->channel, G_IO_FLAG_NONBLOCK, &error) != G_IO_STATUS_NORMAL)
     {
-      g_warning (G_STRLOC ": Error setting encoding on channel: %s",
+      g_warning (G_STRLOC ": Error setting up channel: %s",
                  error->message);
       g_clear_error (&error);
       goto error;
     }
 
   g_io_add_watch (closure->channel,
-                  G_IO_IN,
+                  G_IO_IN | G_IO_HUP | G_IO_ERR,
                   _request_content_io_func,
                   closure);
 
@@ -1544,8 +1556,9 @@ gdk_wayland_device_request_selection_content (GdkDevice
 
 error:
   data_offer_unref (closure->offer);
+  g_io_channel_shutdown (closure->channel, FALSE, NULL);
   g_io_channel_unref (closure->channel);
-  close (pipe_fd[1]);
+  g_byte_array_unref (closure->content);
   g_free (closure);
 
   return FALSE;
@@ -1567,6 +1580,56 @@ data_source_target (void                  *data,
            G_STRFUNC, source, mime_type);
 }
 
+typedef struct
+{
+  gchar *buf;
+  gssize len;
+  gssize written;
+} SendContentClosure;
+
+static void
+send_content_closure_free (SendContentClosure *closure)
+{
+  g_free (closure->buf);
+  g_free (closure);
+}
+
+/* Writes as much as the pipe takes, and waits for the reader to make
+ * room for the rest. Blocking here could deadlock if the reader is
+ * this same process.
+ */
+static gboolean
+_send_content_io_func (GIOChannel   *channel,
+                       GIOCondition  condition,
+                       gpointer      userdata)
+{
+  SendContentClosure *closure = userdata;
+  gint fd = g_io_channel_unix_get_fd (channel);
+  gssize bytes_written;
+
+  while (closure->written < closure->len)
+    {
+      bytes_written = write (fd,
+                             closure->buf + closure->written,
+                             closure->len - closure->written);
+      if (bytes_written == -1)
+        {
+          if (errno == EINTR)
+            continue;
+          if (errno == EAGAIN)
+            return TRUE;
+
+          g_warning (G_STRLOC ": Error writing data to client: %s",
+                     g_strerror (errno));
+          break;
+        }
+
+      closure->written += bytes_written;
+    }
+
+  return FALSE;
+}
+
 static void
 data_source_send (void                  *data,
                   struct wl_data_source *source,
@@ -1574,33 +1637,25 @@ data_source_send (void                  *data,
                   int32_t                fd)
 {
   GdkWaylandSelectionOffer *offer = (GdkWaylandSelectionOffer *)data;
-  gchar *buf;
-  gssize len, bytes_written = 0;
+  SendContentClosure *closure;
+  GIOChannel *channel;
 
   g_debug (G_STRLOC ": %s source = %p, mime_type = %s fd = %d",
            G_STRFUNC, source, mime_type, fd);
 
-  buf = offer->cb (offer->device->pointer, mime_type, &len, offer->userdata);
+  closure = g_new0 (SendContentClosure, 1);
+  closure->buf = offer->cb (offer->device->pointer, mime_type, &closure->len, offer->userdata);
 
-  while (len > 0)
-    {
-      bytes_written += write (fd, buf + bytes_written, len);
-      if (bytes_written == -1)
-        goto error;
-      len -= bytes_written;
-    }
+  fcntl (fd, F_SETFL, fcntl (fd, F_GETFL) | O_NONBLOCK);
 
-  close (fd);
-  g_free (buf);
-
-  return;
-error:
-
-  g_warning (G_STRLOC ": Error writing data to client: %s",
-             g_strerror (errno));
-
-  close (fd);
-  g_free (buf);
+  channel = g_io_channel_unix_new (fd);
+  g_io_channel_set_close_on_unref (channel, TRUE);
+  g_io_add_watch_full (channel, G_PRIORITY_DEFAULT,
+                       G_IO_OUT | G_IO_HUP | G_IO_ERR,
+                       _send_content_io_func,
+                       closure,
+                       (GDestroyNotify) send_content_closure_free);
+  g_io_channel_unref (channel);
 }
 
 static void
@@ -22,6 +22,7 @@
 #include <errno.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <time.h>
 
 #include <glib.h>
 #include "gdkwayland.h"
@@ -111,6 +112,20 @@ wait_for_roundtrip(GdkWaylandDisplay *display)
   wl_callback_add_listener(callback, &init_sync_listener, display);
 }
 
+static void
+presentation_clock_id (void                   *data,
+                       struct wp_presentation *presentation,
+                       uint32_t                clk_id)
+{
+  GdkWaylandDisplay *display_wayland = data;
+
+  display_wayland->presentation_clock_is_monotonic = (clk_id == CLOCK_MONOTONIC);
+}
+
+static const struct wp_presentation_listener presentation_listener = {
+  presentation_clock_id
+};
+
 static void
 gdk_registry_handle_global(void *data, struct wl_registry *registry, uint32_t id,
 					const char *interface, uint32_t version)
@@ -124,6 +139,9 @@ gdk_registry_handle_global(void *data, struct wl_registry *registry, uint32_t id
     display_wayland->compositor =
       wl_registry_bind(display_wayland->wl_registry, id, &wl_compositor_interface, MIN (version, 3));
     display_wayland->compositor_version = MIN (version, 3);
+  } else if (strcmp(interface, "wl_subcompositor") == 0) {
+    display_wayland->subcompositor =
+      wl_registry_bind(display_wayland->wl_registry, id, &wl_subcompositor_interface, 1);
   } else if (strcmp(interface, "wl_shm") == 0) {
    display_wayland->shm =
 	wl_registry_bind(display_wayland->wl_registry, id, &wl_shm_interface, 1);
@@ -159,6 +177,11 @@ gdk_registry_handle_global(void *data, struct wl_registry *registry, uint32_t id
       display_wayland->data_device_manager =
         wl_registry_bind(display_wayland->wl_registry, id,
 					&wl_data_device_manager_interface, 1);
+  } else if (strcmp(interface, "wp_presentation") == 0) {
+    display_wayland->presentation =
+      wl_registry_bind(display_wayland->wl_registry, id, &wp_presentation_interface, 1);
+    wp_presentation_add_listener(display_wayland->presentation,
+                                 &presentation_listener, display_wayland);
   }
 }
 
@@ -28,6 +28,7 @@
 #include <wayland-cursor.h>
 #include <gdk/wayland/gtk-shell-client-protocol.h>
 #include <gdk/wayland/xdg-shell-client-protocol.h>
+#include <gdk/wayland/presentation-time-client-protocol.h>
 
 #include <glib.h>
 #include <gdk/gdkkeys.h>
@@ -58,14 +59,18 @@ struct _GdkWaylandDisplay
   struct wl_display *wl_display;
   struct wl_registry *wl_registry;
   struct wl_compositor *compositor;
+  struct wl_subcompositor *subcompositor;
   struct wl_shm *shm;
   struct xdg_shell *xdg_shell;
   struct gtk_shell *gtk_shell;
   struct wl_input_device *input_device;
   struct wl_data_device_manager *data_device_manager;
+  struct wp_presentation *presentation;
+  /* Whether presentation timestamps are in the clock of g_get_monotonic_time() */
+  gboolean presentation_clock_is_monotonic;
 
   struct wl_cursor_theme *cursor_theme;
-  GSList *cursor_cache;
+  GHashTable *cursor_cache;
 
   GSource *event_source;
 
@@ -48,6 +48,10 @@ struct wl_surface       *gdk_wayland_window_get_wl_surface       (GdkWindow *win
 
 void                     gdk_wayland_window_set_use_custom_surface (GdkWindow *window);
 
+GDK_AVAILABLE_IN_3_12
+struct wl_subsurface    *gdk_wayland_window_create_subsurface    (GdkWindow         *window,
+                                                                  struct wl_surface *surface);
+
 GDK_AVAILABLE_IN_3_10
 void                     gdk_wayland_window_set_dbus_properties_libgtk_only (GdkWindow  *window,
 									     const char *application_id,
@@ -89,6 +89,8 @@ gdk_wayland_window_init (GdkWaylandWindow *wayland_window)
 typedef struct _GdkWindowImplWayland GdkWindowImplWayland;
 typedef struct _GdkWindowImplWaylandClass GdkWindowImplWaylandClass;
 
+#define N_BUFFERS 3
+
 struct _GdkWindowImplWayland
 {
   GdkWindowImpl parent_instance;
@@ -124,6 +126,11 @@ struct _GdkWindowImplWayland
    */
   cairo_surface_t *server_surface;
 
+  /* The buffers cairo_surface is picked from, so that the next frame can
+   * be drawn while the compositor still holds on to the previous one.
+   */
+  cairo_surface_t *buffers[N_BUFFERS];
+
   gchar *title;
 
   uint32_t resize_edges;
@@ -303,6 +310,40 @@ fill_presentation_time_from_frame_time (GdkFrameTimings *timings,
     }
 }
 
+/* The refresh interval of the output the window is on, in microseconds */
+static gint64
+get_refresh_interval (GdkWindow *window)
+{
+  GdkWindowImplWayland *impl = GDK_WINDOW_IMPL_WAYLAND (window->impl);
+  GdkWaylandDisplay *wayland_display = GDK_WAYLAND_DISPLAY (gdk_window_get_display (window));
+  gint64 refresh_interval = 16667; /* default to 1/60th of a second */
+
+  if (impl->outputs)
+    {
+      /* We pick a random output out of the outputs that the window touches
+       * The rate here is in milli-hertz */
+      int refresh_rate = _gdk_wayland_screen_get_output_refresh_rate (wayland_display->screen,
+                                                                      impl->outputs->data);
+      if (refresh_rate != 0)
+        refresh_interval = G_GINT64_CONSTANT(1000000000) / refresh_rate;
+    }
+
+  return refresh_interval;
+}
+
+static void
+complete_timings (GdkFrameClock   *clock,
+                  GdkFrameTimings *timings)
+{
+  timings->complete = TRUE;
+  _gdk_frame_clock_report_input_latency (clock, timings);
+
+#ifdef G_ENABLE_DEBUG
+  if ((_gdk_debug_flags & GDK_DEBUG_FRAMES) != 0)
+    _gdk_frame_clock_debug_print_timings (clock, timings);
+#endif
+}
+
 static void
 frame_callback (void               *data,
                 struct wl_callback *callback,
@@ -323,31 +364,116 @@ frame_callback (void               *data,
   if (timings == NULL)
     return;
 
-  timings->refresh_interval = 16667; /* default to 1/60th of a second */
-  if (impl->outputs)
-    {
-      /* We pick a random output out of the outputs that the window touches
-       * The rate here is in milli-hertz */
-      int refresh_rate = _gdk_wayland_screen_get_output_refresh_rate (wayland_display->screen,
-                                                                      impl->outputs->data);
-      if (refresh_rate != 0)
-        timings->refresh_interval = G_GINT64_CONSTANT(1000000000) / refresh_rate;
-    }
+  /* The timings are filled in from the presentation feedback instead */
+  if (wayland_display->presentation)
+    return;
 
+  timings->refresh_interval = get_refresh_interval (window);
   fill_presentation_time_from_frame_time (timings, time);
 
-  timings->complete = TRUE;
-
-#ifdef G_ENABLE_DEBUG
-  if ((_gdk_debug_flags & GDK_DEBUG_FRAMES) != 0)
-    _gdk_frame_clock_debug_print_timings (clock, timings);
-#endif
+  complete_timings (clock, timings);
 }
 
 static const struct wl_callback_listener listener = {
   frame_callback
 };
 
+typedef struct {
+  GdkWindow *window;
+  gint64 frame_counter;
+} GdkWaylandPresentationFrame;
+
+static GdkFrameTimings *
+presentation_frame_get_timings (GdkWaylandPresentationFrame *frame,
+                                GdkFrameClock              **clock)
+{
+  if (GDK_WINDOW_DESTROYED (frame->window))
+    return NULL;
+
+  *clock = gdk_window_get_frame_clock (frame->window);
+  if (*clock == NULL)
+    return NULL;
+
+  return gdk_frame_clock_get_timings (*clock, frame->frame_counter);
+}
+
+static void
+presentation_frame_free (GdkWaylandPresentationFrame     *frame,
+                         struct wp_presentation_feedback *feedback)
+{
+  wp_presentation_feedback_destroy (feedback);
+  g_object_unref (frame->window);
+  g_slice_free (GdkWaylandPresentationFrame, frame);
+}
+
+static void
+presentation_feedback_sync_output (void                            *data,
+                                   struct wp_presentation_feedback *feedback,
+                                   struct wl_output                *output)
+{
+}
+
+static void
+presentation_feedback_presented (void                            *data,
+                                 struct wp_presentation_feedback *feedback,
+                                 uint32_t                         tv_sec_hi,
+                                 uint32_t                         tv_sec_lo,
+                                 uint32_t                         tv_nsec,
+                                 uint32_t                         refresh,
+                                 uint32_t                         seq_hi,
+                                 uint32_t                         seq_lo,
+                                 uint32_t                         flags)
+{
+  GdkWaylandPresentationFrame *frame = data;
+  GdkWaylandDisplay *wayland_display;
+  GdkFrameClock *clock;
+  GdkFrameTimings *timings;
+
+  timings = presentation_frame_get_timings (frame, &clock);
+  if (timings)
+    {
+      wayland_display = GDK_WAYLAND_DISPLAY (gdk_window_get_display (frame->window));
+
+      if (refresh != 0)
+        timings->refresh_interval = refresh / 1000;
+      else
+        timings->refresh_interval = get_refresh_interval (frame->window);
+
+      /* Timestamps in another clock can't be compared to frame times */
+      if (wayland_display->presentation_clock_is_monotonic)
+        timings->presentation_time =
+          (((gint64) tv_sec_hi << 32) + tv_sec_lo) * G_USEC_PER_SEC + tv_nsec / 1000;
+
+      complete_timings (clock, timings);
+    }
+
+  presentation_frame_free (frame, feedback);
+}
+
+static void
+presentation_feedback_discarded (void                            *data,
+                                 struct wp_presentation_feedback *feedback)
+{
+  GdkWaylandPresentationFrame *frame = data;
+  GdkFrameClock *clock;
+  GdkFrameTimings *timings;
+
+  timings = presentation_frame_get_timings (frame, &clock);
+  if (timings)
+    {
+      timings->refresh_interval = get_refresh_interval (frame->window);
+      complete_timings (clock, timings);
+    }
+
+  presentation_frame_free (frame, feedback);
+}
+
+static const struct wp_presentation_feedback_listener presentation_feedback_listener = {
+  presentation_feedback_sync_output,
+  presentation_feedback_presented,
+  presentation_feedback_discarded
+};
+
 static void
 on_frame_clock_before_paint (GdkFrameClock *clock,
                              GdkWindow     *window)
@@ -380,15 +506,27 @@ on_frame_clock_before_paint (GdkFrameClock *clock,
 
 static const cairo_user_data_key_t gdk_wayland_cairo_key;
 
+/* The shared memory and wl_buffer behind a cairo surface. The pool
+ * and its file are kept for as long as the buffer is, so that it can
+ * be resized without creating a new pool.
+ */
 typedef struct _GdkWaylandCairoSurfaceData {
   gpointer buf;
   size_t buf_length;
+  int fd;
   struct wl_shm_pool *pool;
   struct wl_buffer *buffer;
   GdkWaylandDisplay *display;
   int32_t width, height;
   uint32_t scale;
   gboolean busy;
+
+  /* The area drawn to in the other buffers of the window since this
+   * one was last drawn to
+   */
+  cairo_region_t *damage;
+
+  guint ref_count;
 } GdkWaylandCairoSurfaceData;
 
 static void
@@ -396,6 +534,7 @@ on_frame_clock_after_paint (GdkFrameClock *clock,
                             GdkWindow     *window)
 {
   GdkWindowImplWayland *impl = GDK_WINDOW_IMPL_WAYLAND (window->impl);
+  GdkWaylandDisplay *wayland_display = GDK_WAYLAND_DISPLAY (gdk_window_get_display (window));
   GdkWaylandCairoSurfaceData *data;
   struct wl_callback *callback;
 
@@ -409,6 +548,19 @@ on_frame_clock_after_paint (GdkFrameClock *clock,
   wl_callback_add_listener (callback, &listener, window);
   _gdk_frame_clock_freeze (clock);
 
+  if (wayland_display->presentation)
+    {
+      GdkWaylandPresentationFrame *frame;
+      struct wp_presentation_feedback *feedback;
+
+      frame = g_slice_new (GdkWaylandPresentationFrame);
+      frame->window = g_object_ref (window);
+      frame->frame_counter = impl->pending_frame_counter;
+
+      feedback = wp_presentation_feedback (wayland_display->presentation, impl->surface);
+      wp_presentation_feedback_add_listener (feedback, &presentation_feedback_listener, frame);
+    }
+
   wl_surface_commit (impl->surface);
 
   data = cairo_surface_get_user_data (impl->cairo_surface,
@@ -591,10 +743,19 @@ gdk_wayland_window_attach_image (GdkWindow *window)
   impl->pending_commit = TRUE;
 }
 
+static GdkWaylandCairoSurfaceData *
+gdk_wayland_cairo_surface_data_ref (GdkWaylandCairoSurfaceData *data)
+{
+  data->ref_count++;
+
+  return data;
+}
+
 static void
-gdk_wayland_cairo_surface_destroy (void *p)
+gdk_wayland_cairo_surface_data_unref (GdkWaylandCairoSurfaceData *data)
 {
-  GdkWaylandCairoSurfaceData *data = p;
+  if (--data->ref_count > 0)
+    return;
 
   if (data->buffer)
     wl_buffer_destroy (data->buffer);
@@ -602,43 +763,68 @@ gdk_wayland_cairo_surface_destroy (void *p)
   if (data->pool)
     wl_shm_pool_destroy (data->pool);
 
-  munmap (data->buf, data->buf_length);
+  if (data->buf)
+    munmap (data->buf, data->buf_length);
+
+  if (data->fd >= 0)
+    close (data->fd);
+
+  cairo_region_destroy (data->damage);
   g_free (data);
 }
 
+static void
+gdk_wayland_cairo_surface_destroy (void *p)
+{
+  gdk_wayland_cairo_surface_data_unref (p);
+}
 
-struct wl_shm_pool *
-_create_shm_pool (struct wl_shm  *shm,
-                  int             width,
-                  int             height,
-                  size_t         *buf_length,
-                  void          **data_out)
+static int
+open_shm_file (size_t size)
 {
   char filename[] = "/tmp/wayland-shm-XXXXXX";
-  struct wl_shm_pool *pool;
-  int fd, size, stride;
-  void *data;
+  int fd;
 
   fd = mkstemp (filename);
   if (fd < 0)
     {
       g_critical (G_STRLOC ": Unable to create temporary file (%s): %s",
                   filename, g_strerror (errno));
-      return NULL;
+      return -1;
     }
 
-  stride = width * 4;
-  size = stride * height;
+  unlink (filename);
+
   if (ftruncate (fd, size) < 0)
     {
       g_critical (G_STRLOC ": Truncating temporary file failed: %s",
                   g_strerror (errno));
       close (fd);
-      return NULL;
+      return -1;
     }
 
+  return fd;
+}
+
+struct wl_shm_pool *
+_create_shm_pool (struct wl_shm  *shm,
+                  int             width,
+                  int             height,
+                  size_t         *buf_length,
+                  void          **data_out)
+{
+  struct wl_shm_pool *pool;
+  int fd, size, stride;
+  void *data;
+
+  stride = width * 4;
+  size = stride * height;
+
+  fd = open_shm_file (size);
+  if (fd < 0)
+    return NULL;
+
   data = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-  unlink (filename);
 
   if (data == MAP_FAILED)
     {
@@ -672,48 +858,106 @@ static const struct wl_buffer_listener buffer_listener = {
   buffer_release_callback
 };
 
-static cairo_surface_t *
-gdk_wayland_create_cairo_surface (GdkWaylandDisplay *display,
-                                  int                width,
-                                  int                height,
-                                  guint              scale)
+/* Gives @data a wl_buffer of the given size, growing its pool if
+ * necessary. Pools never shrink; a buffer that gets smaller keeps
+ * using the start of its pool.
+ */
+static gboolean
+gdk_wayland_cairo_surface_data_resize (GdkWaylandCairoSurfaceData *data,
+                                       int                         width,
+                                       int                         height,
+                                       guint                       scale)
 {
-  GdkWaylandCairoSurfaceData *data;
-  cairo_surface_t *surface = NULL;
-  cairo_status_t status;
+  cairo_rectangle_int_t rect;
   int stride;
+  size_t size;
+
+  stride = width * 4 * scale;
+  size = stride * height * scale;
+
+  if (data->buffer)
+    {
+      wl_buffer_destroy (data->buffer);
+      data->buffer = NULL;
+    }
+
+  if (data->pool == NULL)
+    {
+      data->fd = open_shm_file (size);
+      if (data->fd < 0)
+        return FALSE;
+
+      data->pool = wl_shm_create_pool (data->display->shm, data->fd, size);
+    }
+  else if (size > data->buf_length)
+    {
+      if (ftruncate (data->fd, size) < 0)
+        {
+          g_critical (G_STRLOC ": Truncating temporary file failed: %s",
+                      g_strerror (errno));
+          return FALSE;
+        }
+
+      wl_shm_pool_resize (data->pool, size);
+    }
+
+  if (size > data->buf_length)
+    {
+      if (data->buf)
+        munmap (data->buf, data->buf_length);
+
+      data->buf = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, data->fd, 0);
+      if (data->buf == MAP_FAILED)
+        {
+          g_critical (G_STRLOC ": mmap'ping temporary file failed: %s",
+                      g_strerror (errno));
+          data->buf = NULL;
+          data->buf_length = 0;
+          return FALSE;
+        }
+
+      data->buf_length = size;
+    }
 
-  data = g_new (GdkWaylandCairoSurfaceData, 1);
-  data->display = display;
-  data->buffer = NULL;
   data->width = width;
   data->height = height;
   data->scale = scale;
   data->busy = FALSE;
 
-  stride = width * 4;
-
-  data->pool = _create_shm_pool (display->shm,
-                                 width*scale, height*scale,
-                                 &data->buf_length,
-                                 &data->buf);
-
   data->buffer = wl_shm_pool_create_buffer (data->pool, 0,
                                             width*scale, height*scale,
-                                            stride*scale, WL_SHM_FORMAT_ARGB8888);
+                                            stride, WL_SHM_FORMAT_ARGB8888);
   wl_buffer_add_listener (data->buffer, &buffer_listener, data);
 
+  /* Nothing in the buffer can be trusted yet */
+  rect.x = 0;
+  rect.y = 0;
+  rect.width = width;
+  rect.height = height;
+  cairo_region_destroy (data->damage);
+  data->damage = cairo_region_create_rectangle (&rect);
+
+  return TRUE;
+}
+
+static cairo_surface_t *
+gdk_wayland_cairo_surface_data_create_surface (GdkWaylandCairoSurfaceData *data)
+{
+  cairo_surface_t *surface;
+  cairo_status_t status;
+
   surface = cairo_image_surface_create_for_data (data->buf,
                                                  CAIRO_FORMAT_ARGB32,
-                                                 width*scale,
-                                                 height*scale,
-                                                 stride*scale);
+                                                 data->width*data->scale,
+                                                 data->height*data->scale,
+                                                 data->width*4*data->scale);
 
   cairo_surface_set_user_data (surface, &gdk_wayland_cairo_key,
-                               data, gdk_wayland_cairo_surface_destroy);
+                               gdk_wayland_cairo_surface_data_ref (data),
+                               gdk_wayland_cairo_surface_destroy);
 
 #ifdef HAVE_CAIRO_SURFACE_SET_DEVICE_SCALE
-  cairo_surface_set_device_scale (surface, scale, scale);
+  cairo_surface_set_device_scale (surface, data->scale, data->scale);
 #endif
 
   status = cairo_surface_status (surface);
@@ -726,20 +970,203 @@ gdk_wayland_create_cairo_surface (GdkWaylandDisplay *display,
   return surface;
 }
 
+static cairo_surface_t *
+gdk_wayland_create_cairo_surface (GdkWaylandDisplay *display,
+                                  int                width,
+                                  int                height,
+                                  guint              scale)
+{
+  GdkWaylandCairoSurfaceData *data;
+  cairo_surface_t *surface;
+
+  data = g_new0 (GdkWaylandCairoSurfaceData, 1);
+  data->display = display;
+  data->fd = -1;
+  data->damage = cairo_region_create ();
+  data->ref_count = 1;
+
+  gdk_wayland_cairo_surface_data_resize (data, width, height, scale);
+  surface = gdk_wayland_cairo_surface_data_create_surface (data);
+  gdk_wayland_cairo_surface_data_unref (data);
+
+  return surface;
+}
+
+/* Returns a buffer for the next frame that the compositor doesn't
+ * hold on to. An idle buffer of the right size is used as is; an idle
+ * one that only the window knows about is resized. If there is none,
+ * a new buffer is added to the window's buffers, or replaces one
+ * that isn't on screen.
+ *
+ * The returned surface is owned by the window's buffers.
+ */
+static cairo_surface_t *
+gdk_wayland_window_get_free_buffer (GdkWindow *window)
+{
+  GdkWindowImplWayland *impl = GDK_WINDOW_IMPL_WAYLAND (window->impl);
+  GdkWaylandDisplay *display_wayland =
+    GDK_WAYLAND_DISPLAY (gdk_window_get_display (impl->wrapper));
+  GdkWaylandCairoSurfaceData *data;
+  cairo_surface_t *surface;
+  int width, height, i, slot;
+  guint scale;
+
+  width = impl->wrapper->width;
+  height = impl->wrapper->height;
+  scale = impl->scale;
+
+  for (i = 0; i < N_BUFFERS; i++)
+    {
+      surface = impl->buffers[i];
+      if (surface == NULL)
+        continue;
+
+      data = cairo_surface_get_user_data (surface, &gdk_wayland_cairo_key);
+      if (!data->busy &&
+          data->width == width && data->height == height && data->scale == scale)
+        return surface;
+    }
+
+  for (i = 0; i < N_BUFFERS; i++)
+    {
+      surface = impl->buffers[i];
+      if (surface == NULL)
+        continue;
+
+      data = cairo_surface_get_user_data (surface, &gdk_wayland_cairo_key);
+      if (data->busy || cairo_surface_get_reference_count (surface) != 1)
+        continue;
+
+      /* Nobody draws to the memory anymore once the surface is gone */
+      gdk_wayland_cairo_surface_data_ref (data);
+      cairo_surface_destroy (surface);
+
+      gdk_wayland_cairo_surface_data_resize (data, width, height, scale);
+      impl->buffers[i] = gdk_wayland_cairo_surface_data_create_surface (data);
+      gdk_wayland_cairo_surface_data_unref (data);
+
+      return impl->buffers[i];
+    }
+
+  slot = -1;
+  for (i = 0; i < N_BUFFERS && slot < 0; i++)
+    {
+      if (impl->buffers[i] == NULL)
+        slot = i;
+    }
+  for (i = 0; i < N_BUFFERS && slot < 0; i++)
+    {
+      if (impl->buffers[i] != impl->cairo_surface &&
+          impl->buffers[i] != impl->server_surface)
+        slot = i;
+    }
+
+  if (impl->buffers[slot])
+    cairo_surface_destroy (impl->buffers[slot]);
+
+  impl->buffers[slot] = gdk_wayland_create_cairo_surface (display_wayland,
+                                                          width, height,
+                                                          scale);
+
+  return impl->buffers[slot];
+}
+
+static void
+gdk_wayland_window_drop_buffers (GdkWindow *window)
+{
+  GdkWindowImplWayland *impl = GDK_WINDOW_IMPL_WAYLAND (window->impl);
+  int i;
+
+  for (i = 0; i < N_BUFFERS; i++)
+    {
+      if (impl->buffers[i])
+        {
+          cairo_surface_finish (impl->buffers[i]);
+          cairo_surface_set_user_data (impl->buffers[i], &gdk_wayland_cairo_key,
+                                       NULL, NULL);
+          cairo_surface_destroy (impl->buffers[i]);
+          impl->buffers[i] = NULL;
+        }
+    }
+}
+
 static void
 gdk_wayland_window_ensure_cairo_surface (GdkWindow *window)
 {
   GdkWindowImplWayland *impl = GDK_WINDOW_IMPL_WAYLAND (window->impl);
   if (!impl->cairo_surface)
     {
-      GdkWaylandDisplay *display_wayland =
-        GDK_WAYLAND_DISPLAY (gdk_window_get_display (impl->wrapper));
+      GdkWaylandCairoSurfaceData *data;
 
       impl->cairo_surface =
-        gdk_wayland_create_cairo_surface (display_wayland,
-                                          impl->wrapper->width,
-                                          impl->wrapper->height,
-                                          impl->scale);
+        cairo_surface_reference (gdk_wayland_window_get_free_buffer (window));
+
+      /* The window is redrawn completely after a resize, so there is
+       * nothing to bring up to date.
+       */
+      data = cairo_surface_get_user_data (impl->cairo_surface,
+                                          &gdk_wayland_cairo_key);
+      cairo_region_destroy (data->damage);
+      data->damage = cairo_region_create ();
+    }
+}
+
+/* Before drawing a frame, moves away from a buffer that the compositor
+ * is still reading from. The new buffer is brought up to date by
+ * copying what changed since it was last drawn to, so only the damage
+ * of the frame itself has to be repainted.
+ */
+static void
+gdk_wayland_window_ensure_free_buffer (GdkWindow *window)
+{
+  GdkWindowImplWayland *impl = GDK_WINDOW_IMPL_WAYLAND (window->impl);
+  GdkWaylandCairoSurfaceData *data;
+  cairo_surface_t *previous, *surface;
+  cairo_t *cr;
+
+  gdk_wayland_window_ensure_cairo_surface (window);
+
+  previous = impl->cairo_surface;
+  data = cairo_surface_get_user_data (previous, &gdk_wayland_cairo_key);
+  if (!data->busy)
+    return;
+
+  surface = gdk_wayland_window_get_free_buffer (window);
+  data = cairo_surface_get_user_data (surface, &gdk_wayland_cairo_key);
+
+  if (!cairo_region_is_empty (data->damage))
+    {
+      cr = cairo_create (surface);
+      cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
+      cairo_set_source_surface (cr, previous, 0, 0);
+      gdk_cairo_region (cr, data->damage);
+      cairo_fill (cr);
+      cairo_destroy (cr);
+
+      cairo_region_destroy (data->damage);
+      data->damage = cairo_region_create ();
+    }
+
+  impl->cairo_surface = cairo_surface_reference (surface);
+  cairo_surface_destroy (previous);
+}
+
+/* Records that @region was drawn to the current buffer */
+static void
+gdk_wayland_window_add_damage (GdkWindow      *window,
+                               cairo_region_t *region)
+{
+  GdkWindowImplWayland *impl = GDK_WINDOW_IMPL_WAYLAND (window->impl);
+  GdkWaylandCairoSurfaceData *data;
+  int i;
+
+  for (i = 0; i < N_BUFFERS; i++)
+    {
+      if (impl->buffers[i] == NULL || impl->buffers[i] == impl->cairo_surface)
+        continue;
+
+      data = cairo_surface_get_user_data (impl->buffers[i], &gdk_wayland_cairo_key);
+      cairo_region_union (data->damage, region);
     }
 }
 
@@ -1482,6 +1909,8 @@ gdk_wayland_window_destroy (GdkWindow *window,
       cairo_surface_set_user_data (impl->cairo_surface, &gdk_wayland_cairo_key,
                                    NULL, NULL);
     }
+
+  gdk_wayland_window_drop_buffers (window);
 }
 
 static void
@@ -1995,10 +2424,11 @@ gdk_wayland_window_process_updates_recurse (GdkWindow      *window,
 
   gdk_wayland_window_map (window);
 
-  gdk_wayland_window_ensure_cairo_surface (window);
+  gdk_wayland_window_ensure_free_buffer (window);
   gdk_wayland_window_attach_image (window);
 
   _gdk_window_process_updates_recurse (window, region);
+  gdk_wayland_window_add_damage (window, region);
 
   n = cairo_region_num_rectangles (region);
   for (i = 0; i < n; i++)
@@ -2317,6 +2747,58 @@ gdk_wayland_window_set_use_custom_surface (GdkWindow *window)
   impl->use_custom_surface = TRUE;
 }
 
+/**
+ * gdk_wayland_window_create_subsurface:
+ * @window: (type GdkWaylandWindow): a #GdkWindow
+ * @surface: a Wayland wl_surface owned by the caller
+ *
+ * Makes @surface a subsurface of the toplevel Wayland surface that
+ * @window is drawn to, placed above it at the position of @window.
+ *
+ * This is meant for content that changes much more often than the
+ * rest of the window, like video or GL rendering. The caller attaches
+ * its own buffers to @surface and commits it whenever a new frame is
+ * ready, so the compositor can show the frame (or scan it out
+ * directly) without GDK having to repaint and commit the whole window.
+ * The subsurface is created in desynchronized mode for that reason.
+ *
+ * The caller is responsible for keeping the subsurface in place with
+ * wl_subsurface_set_position() when @window moves, and for destroying
+ * it with wl_subsurface_destroy() before @window is unrealized.
+ *
+ * Returns: (transfer full): a new Wayland wl_subsurface, or %NULL if
+ *     the compositor does not support subsurfaces
+ *
+ * Since: 3.12
+ */
+struct wl_subsurface *
+gdk_wayland_window_create_subsurface (GdkWindow         *window,
+                                      struct wl_surface *surface)
+{
+  GdkWaylandDisplay *display_wayland;
+  GdkWindowImplWayland *impl;
+  struct wl_subsurface *subsurface;
+
+  g_return_val_if_fail (GDK_IS_WAYLAND_WINDOW (window), NULL);
+  g_return_val_if_fail (surface != NULL, NULL);
+
+  display_wayland = GDK_WAYLAND_DISPLAY (gdk_window_get_display (window));
+  if (display_wayland->subcompositor == NULL)
+    return NULL;
+
+  /* Child windows share the wl_surface of their native ancestor */
+  impl = GDK_WINDOW_IMPL_WAYLAND (window->impl);
+  if (!impl->surface)
+    gdk_wayland_window_create_surface (impl->wrapper);
+
+  subsurface = wl_subcompositor_get_subsurface (display_wayland->subcompositor,
+                                                surface, impl->surface);
+  wl_subsurface_set_position (subsurface, window->abs_x, window->abs_y);
+  wl_subsurface_set_desync (subsurface);
+
+  return subsurface;
+}
+
 void
 gdk_wayland_window_set_dbus_properties_libgtk_only (GdkWindow  *window,
                                                     const char *application_id,
@@ -802,6 +802,17 @@ gdk_win32_window_resize_cairo_surface (GdkWindow       *window,
                                        gint             width,
                                        gint             height)
 {
+  GdkWindowImplWin32 *impl = GDK_WINDOW_IMPL_WIN32 (window->impl);
+
+  /* The DC follows the window, so while the window shrinks (e.g. during
+   * an interactive resize) the surface created on it can be kept; only
+   * recreate it once the window grows past the extents cairo recorded.
+   */
+  if (surface == impl->cairo_surface &&
+      width <= impl->cairo_surface_extents.right &&
+      height <= impl->cairo_surface_extents.bottom)
+    return surface;
+
   /* XXX: Make Cairo surface use DC clip */
   cairo_surface_destroy (surface);
 
@@ -3413,6 +3424,10 @@ gdk_win32_ref_cairo_surface (GdkWindow *window)
 
       impl->cairo_surface = cairo_win32_surface_create (hdc);
 
+      /* cairo takes the surface extents from the clip box of the DC */
+      if (GetClipBox (hdc, &impl->cairo_surface_extents) == ERROR)
+        SetRectEmpty (&impl->cairo_surface_extents);
+
       cairo_surface_set_user_data (impl->cairo_surface, &gdk_win32_cairo_key,
 				   impl, gdk_win32_cairo_surface_destroy);
     }
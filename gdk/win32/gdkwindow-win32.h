@@ -80,6 +80,7 @@ struct _GdkWindowImplWin32
   guint override_redirect : 1;
 
   cairo_surface_t *cairo_surface;
+  RECT             cairo_surface_extents;
   HDC              hdc;
   int              hdc_count;
   HBITMAP          saved_dc_bitmap; /* Original bitmap for dc */
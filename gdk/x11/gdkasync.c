@@ -59,6 +59,7 @@ typedef struct _ListChildrenState ListChildrenState;
 typedef struct _SendEventState SendEventState;
 typedef struct _SetInputFocusState SetInputFocusState;
 typedef struct _RoundtripState RoundtripState;
+typedef struct _GetPropertyState GetPropertyState;
 
 typedef enum {
   CHILD_INFO_GET_PROPERTY,
@@ -124,6 +125,21 @@ struct _RoundtripState
   gpointer data;
 };
 
+struct _GetPropertyState
+{
+  Display *dpy;
+  _XAsyncHandler async;
+  gulong get_property_req;
+  GdkDisplay *display;
+  Window window;
+  Atom type;
+  gint format;
+  gulong nitems;
+  guchar *prop;
+  GdkGetPropertyCallback callback;
+  gpointer data;
+};
+
 static gboolean
 callback_idle (gpointer data)
 {
@@ -748,3 +764,173 @@ _gdk_x11_roundtrip_async (GdkDisplay           *display,
   UnlockDisplay(dpy);
   SyncHandle();
 }
+
+static gboolean
+get_property_callback_idle (gpointer data)
+{
+  GetPropertyState *state = (GetPropertyState *)data;
+
+  state->callback (state->display, state->window,
+                   state->type, state->format, state->nitems,
+                   state->prop, state->data);
+
+  g_free (state->prop);
+  g_free (state);
+
+  return FALSE;
+}
+
+static Bool
+get_property_handler (Display *dpy,
+		      xReply  *rep,
+		      char    *buf,
+		      int      len,
+		      XPointer data)
+{
+  GetPropertyState *state = (GetPropertyState *)data;
+
+  if (dpy->last_request_read != state->get_property_req)
+    return False;
+
+  /* Errors (typically BadWindow for a window that went away) are
+   * reported to the callback as a missing property, like an error
+   * trapped around XGetWindowProperty() would.
+   */
+  if (rep->generic.type != X_Error)
+    {
+      xGetPropertyReply replbuf;
+      xGetPropertyReply *repl;
+      gulong netbytes = 0;
+
+      repl = (xGetPropertyReply *)
+	_XGetAsyncReply(dpy, (char *)&replbuf, rep, buf, len,
+			(sizeof(xGetPropertyReply) - sizeof(xReply)) >> 2,
+			False);
+
+      if (repl->propertyType != None)
+        {
+          switch (repl->format)
+            {
+            case 8:
+              netbytes = repl->nItems;
+              break;
+            case 16:
+              netbytes = repl->nItems << 1;
+              break;
+            case 32:
+              netbytes = repl->nItems << 2;
+              break;
+            default:
+              break;
+            }
+        }
+
+      if (netbytes > 0 && netbytes <= ((gulong) repl->length << 2))
+        {
+          guchar *raw;
+
+          /* Keep a trailing nul for format 8, like Xlib does */
+          raw = g_malloc0 (netbytes + 1);
+          _XGetAsyncData (dpy, (char *) raw, buf, len,
+                          sizeof (xGetPropertyReply), netbytes,
+                          repl->length << 2);
+
+          if (repl->format == 32)
+            {
+              /* Hand out longs, as XGetWindowProperty() does */
+              gulong *longs = g_new (gulong, repl->nItems);
+              gulong i;
+
+              for (i = 0; i < repl->nItems; i++)
+                longs[i] = ((CARD32 *) raw)[i];
+
+              g_free (raw);
+              raw = (guchar *) longs;
+            }
+
+          state->type = repl->propertyType;
+          state->format = repl->format;
+          state->nitems = repl->nItems;
+          state->prop = raw;
+        }
+      else
+        _XGetAsyncData (dpy, NULL, buf, len,
+                        sizeof (xGetPropertyReply), 0,
+                        repl->length << 2);
+    }
+
+  DeqAsyncHandler(state->dpy, &state->async);
+
+  if (state->callback)
+    gdk_threads_add_idle (get_property_callback_idle, state);
+  else
+    {
+      g_free (state->prop);
+      g_free (state);
+    }
+
+  return True;
+}
+
+/**
+ * _gdk_x11_get_window_property_async:
+ * @display: a #GdkDisplay
+ * @window: the window to read the property from
+ * @property: the property to read
+ * @req_type: the type the property is expected to have
+ * @callback: function called with the property contents
+ * @data: user data for @callback
+ *
+ * Reads the whole of a window property without waiting for the
+ * reply. @callback is called from an idle once the reply has come
+ * in, with @type set to %None if the property doesn't exist or the
+ * request failed. The data passed to @callback is owned by the
+ * caller of @callback and must not be freed; it has the same layout
+ * as the data returned by XGetWindowProperty().
+ */
+void
+_gdk_x11_get_window_property_async (GdkDisplay            *display,
+				    Window                 window,
+				    Atom                   property,
+				    Atom                   req_type,
+				    GdkGetPropertyCallback callback,
+				    gpointer               data)
+{
+  Display *dpy;
+  GetPropertyState *state;
+
+  dpy = GDK_DISPLAY_XDISPLAY (display);
+
+  state = g_new0 (GetPropertyState, 1);
+
+  state->display = display;
+  state->dpy = dpy;
+  state->window = window;
+  state->type = None;
+  state->callback = callback;
+  state->data = data;
+
+  LockDisplay(dpy);
+
+  state->async.next = dpy->async_handlers;
+  state->async.handler = get_property_handler;
+  state->async.data = (XPointer) state;
+  dpy->async_handlers = &state->async;
+
+  {
+    xGetPropertyReq *req;
+
+    GetReq (GetProperty, req);
+    req->window = window;
+    req->property = property;
+    req->type = req_type;
+    req->delete = False;
+    req->longOffset = 0;
+    req->longLength = G_MAXINT32;
+
+    state->get_property_req = dpy->request;
+  }
+
+  UnlockDisplay(dpy);
+  SyncHandle();
+}
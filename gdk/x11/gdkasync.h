@@ -32,6 +32,13 @@ typedef void (*GdkSendXEventCallback) (Window   window,
 typedef void (*GdkRoundTripCallback)  (GdkDisplay *display,
 				       gpointer data,
 				       gulong serial);
+typedef void (*GdkGetPropertyCallback) (GdkDisplay *display,
+					Window      window,
+					Atom        type,
+					gint        format,
+					gulong      nitems,
+					guchar     *data,
+					gpointer    user_data);
 
 struct _GdkChildInfoX11
 {
@@ -64,6 +71,13 @@ void _gdk_x11_roundtrip_async           (GdkDisplay           *display,
 					 GdkRoundTripCallback callback,
 					 gpointer              data);
 
+void _gdk_x11_get_window_property_async (GdkDisplay            *display,
+					 Window                 window,
+					 Atom                   property,
+					 Atom                   req_type,
+					 GdkGetPropertyCallback callback,
+					 gpointer               data);
+
 G_END_DECLS
 
 #endif /* __GDK_ASYNC_H__ */
@@ -63,11 +63,10 @@ static guint theme_serial = 0;
 
 /* cursor_cache holds a cache of non-pixmap cursors to avoid expensive 
  * libXcursor searches, cursors are added to it but only removed when
- * their display is closed. We make the assumption that since there are 
- * a small number of display's and a small number of cursor's that this 
- * list will stay small enough not to be a problem.
+ * their display is closed. It maps a cursor_cache_key to its cursor,
+ * the key lives as long as the cursor.
  */
-static GSList* cursor_cache = NULL;
+static GHashTable *cursor_cache = NULL;
 
 struct cursor_cache_key
 {
@@ -76,6 +75,30 @@ struct cursor_cache_key
   const char* name;
 };
 
+static guint
+cursor_cache_key_hash (gconstpointer data)
+{
+  const struct cursor_cache_key *key = data;
+
+  return g_direct_hash (key->display) ^ key->type ^
+         (key->name ? g_str_hash (key->name) : 0);
+}
+
+static gboolean
+cursor_cache_key_equal (gconstpointer a,
+                        gconstpointer b)
+{
+  const struct cursor_cache_key *key_a = a;
+  const struct cursor_cache_key *key_b = b;
+
+  /* Elements marked as pixmap must be named cursors 
+   * (since we don't store normal pixmap cursors)
+   */
+  return key_a->display == key_b->display &&
+         key_a->type == key_b->type &&
+         g_strcmp0 (key_a->name, key_b->name) == 0;
+}
+
 /* Caller should check if there is already a match first.
  * Cursor MUST be either a typed cursor or a pixmap with 
  * a non-NULL name.
@@ -83,32 +106,20 @@ struct cursor_cache_key
 static void
 add_to_cache (GdkX11Cursor* cursor)
 {
-  cursor_cache = g_slist_prepend (cursor_cache, cursor);
+  struct cursor_cache_key *key;
 
-  /* Take a ref so that if the caller frees it we still have it */
-  g_object_ref (cursor);
-}
+  if (cursor_cache == NULL)
+    cursor_cache = g_hash_table_new_full (cursor_cache_key_hash,
+                                          cursor_cache_key_equal,
+                                          g_free, g_object_unref);
 
-/* Returns 0 on a match
- */
-static gint
-cache_compare_func (gconstpointer listelem, 
-                    gconstpointer target)
-{
-  GdkX11Cursor* cursor = (GdkX11Cursor*)listelem;
-  struct cursor_cache_key* key = (struct cursor_cache_key*)target;
+  key = g_new (struct cursor_cache_key, 1);
+  key->display = gdk_cursor_get_display (GDK_CURSOR (cursor));
+  key->type = cursor->cursor.type;
+  key->name = cursor->name;
 
-  if ((cursor->cursor.type != key->type) ||
-      (gdk_cursor_get_display (GDK_CURSOR (cursor)) != key->display))
-    return 1; /* No match */
-  
-  /* Elements marked as pixmap must be named cursors 
-   * (since we don't store normal pixmap cursors 
-   */
-  if (key->type == GDK_CURSOR_IS_PIXMAP)
-    return strcmp (key->name, cursor->name);
-
-  return 0; /* Match */
+  /* Take a ref so that if the caller frees it we still have it */
+  g_hash_table_insert (cursor_cache, key, g_object_ref (cursor));
 }
 
 /* Returns the cursor if there is a match, NULL if not
@@ -120,19 +131,24 @@ find_in_cache (GdkDisplay    *display,
                GdkCursorType  type,
                const char    *name)
 {
-  GSList* res;
   struct cursor_cache_key key;
 
+  if (cursor_cache == NULL)
+    return NULL;
+
   key.display = display;
   key.type = type;
   key.name = name;
 
-  res = g_slist_find_custom (cursor_cache, &key, cache_compare_func);
-
-  if (res)
-    return (GdkX11Cursor *) res->data;
+  return g_hash_table_lookup (cursor_cache, &key);
+}
 
-  return NULL;
+static gboolean
+cursor_is_on_display (gpointer key,
+                      gpointer value,
+                      gpointer user_data)
+{
+  return ((struct cursor_cache_key *) key)->display == user_data;
 }
 
 /* Called by gdk_x11_display_finalize to flush any cached cursors
@@ -141,29 +157,8 @@ find_in_cache (GdkDisplay    *display,
 void
 _gdk_x11_cursor_display_finalize (GdkDisplay *display)
 {
-  GSList* item;
-  GSList** itemp; /* Pointer to the thing to fix when we delete an item */
-  item = cursor_cache;
-  itemp = &cursor_cache;
-  while (item)
-    {
-      GdkX11Cursor* cursor = (GdkX11Cursor*)(item->data);
-      if (gdk_cursor_get_display (GDK_CURSOR (cursor)) == display)
-        {
-          GSList* olditem;
-          g_object_unref ((GdkCursor*) cursor);
-          /* Remove this item from the list */
-          *(itemp) = item->next;
-          olditem = item;
-          item = g_slist_next (item);
-          g_slist_free_1 (olditem);
-        } 
-      else 
-        {
-          itemp = &(item->next);
-          item = g_slist_next (item);
-        }
-    }
+  if (cursor_cache)
+    g_hash_table_foreach_remove (cursor_cache, cursor_is_on_display, display);
 }
 
 /*** GdkX11Cursor ***/
@@ -423,7 +418,8 @@ _gdk_x11_cursor_update_theme (GdkCursor *cursor)
 }
 
 static void
-update_cursor (gpointer data,
+update_cursor (gpointer key,
+               gpointer data,
                gpointer user_data)
 {
   GdkCursor *cursor;
@@ -484,7 +480,8 @@ gdk_x11_display_set_cursor_theme (GdkDisplay  *display,
   if (size > 0)
     XcursorSetDefaultSize (xdisplay, size);
 
-  g_slist_foreach (cursor_cache, update_cursor, NULL);
+  if (cursor_cache)
+    g_hash_table_foreach (cursor_cache, update_cursor, NULL);
 }
 
 #else
@@ -297,57 +297,78 @@ do_net_wm_state_changes (GdkWindow *window)
     }
 }
 
+/* The window state properties are fetched without waiting for the
+ * reply, since they change in response to PropertyNotify events and
+ * a round trip for each of them is noticeable on slow connections.
+ * Replies come back in request order, so the last one wins.
+ */
 static void
-gdk_check_wm_desktop_changed (GdkWindow *window)
+wm_desktop_received (GdkDisplay *display,
+                     Window      xwindow,
+                     Atom        type,
+                     gint        format,
+                     gulong      nitems,
+                     guchar     *data,
+                     gpointer    user_data)
 {
-  GdkToplevelX11 *toplevel = _gdk_x11_window_get_toplevel (window);
-  GdkDisplay *display = GDK_WINDOW_DISPLAY (window);
+  GdkWindow *window = user_data;
+  GdkToplevelX11 *toplevel;
 
-  Atom type;
-  gint format;
-  gulong nitems;
-  gulong bytes_after;
-  guchar *data;
-  gulong *desktop;
+  if (GDK_WINDOW_DESTROYED (window))
+    goto out;
 
-  type = None;
-  gdk_x11_display_error_trap_push (display);
-  XGetWindowProperty (GDK_DISPLAY_XDISPLAY (display),
-                      GDK_WINDOW_XID (window),
-                      gdk_x11_get_xatom_by_name_for_display (display, "_NET_WM_DESKTOP"),
-                      0, G_MAXLONG, False, XA_CARDINAL, &type,
-                      &format, &nitems,
-                      &bytes_after, &data);
-  gdk_x11_display_error_trap_pop_ignored (display);
+  toplevel = _gdk_x11_window_get_toplevel (window);
 
-  if (type != None)
+  if (type != None && format == 32 && nitems > 0)
     {
-      desktop = (gulong *)data;
+      gulong *desktop = (gulong *)data;
       toplevel->on_all_desktops = ((*desktop & 0xFFFFFFFF) == 0xFFFFFFFF);
-      XFree (desktop);
     }
   else
     toplevel->on_all_desktops = FALSE;
 
   do_net_wm_state_changes (window);
+
+ out:
+  g_object_unref (window);
 }
 
 static void
-gdk_check_wm_state_changed (GdkWindow *window)
+gdk_check_wm_desktop_changed (GdkWindow *window)
 {
-  GdkToplevelX11 *toplevel = _gdk_x11_window_get_toplevel (window);
   GdkDisplay *display = GDK_WINDOW_DISPLAY (window);
-  GdkScreen *screen = GDK_WINDOW_SCREEN (window);
-
-  Atom type;
-  gint format;
-  gulong nitems;
-  gulong bytes_after;
-  guchar *data;
-  Atom *atoms = NULL;
+
+  _gdk_x11_get_window_property_async (display,
+                                      GDK_WINDOW_XID (window),
+                                      gdk_x11_get_xatom_by_name_for_display (display, "_NET_WM_DESKTOP"),
+                                      XA_CARDINAL,
+                                      wm_desktop_received,
+                                      g_object_ref (window));
+}
+
+static void
+wm_state_received (GdkDisplay *display,
+                   Window      xwindow,
+                   Atom        type,
+                   gint        format,
+                   gulong      nitems,
+                   guchar     *data,
+                   gpointer    user_data)
+{
+  GdkWindow *window = user_data;
+  GdkToplevelX11 *toplevel;
+  GdkScreen *screen;
+  gboolean had_sticky;
+  Atom *atoms;
   gulong i;
 
-  gboolean had_sticky = toplevel->have_sticky;
+  if (GDK_WINDOW_DESTROYED (window))
+    goto out;
+
+  toplevel = _gdk_x11_window_get_toplevel (window);
+  screen = GDK_WINDOW_SCREEN (window);
+
+  had_sticky = toplevel->have_sticky;
 
   toplevel->have_sticky = FALSE;
   toplevel->have_maxvert = FALSE;
@@ -356,15 +377,7 @@ gdk_check_wm_state_changed (GdkWindow *window)
   toplevel->have_focused = FALSE;
   toplevel->have_hidden = FALSE;
 
-  type = None;
-  gdk_x11_display_error_trap_push (display);
-  XGetWindowProperty (GDK_DISPLAY_XDISPLAY (display), GDK_WINDOW_XID (window),
-		      gdk_x11_get_xatom_by_name_for_display (display, "_NET_WM_STATE"),
-		      0, G_MAXLONG, False, XA_ATOM, &type, &format, &nitems,
-		      &bytes_after, &data);
-  gdk_x11_display_error_trap_pop_ignored (display);
-
-  if (type != None)
+  if (type != None && format == 32)
     {
       Atom sticky_atom = gdk_x11_get_xatom_by_name_for_display (display, "_NET_WM_STATE_STICKY");
       Atom maxvert_atom = gdk_x11_get_xatom_by_name_for_display (display, "_NET_WM_STATE_MAXIMIZED_VERT");
@@ -393,8 +406,6 @@ gdk_check_wm_state_changed (GdkWindow *window)
 
           ++i;
         }
-
-      XFree (atoms);
     }
 
   if (!gdk_x11_screen_supports_net_wm_hint (screen,
@@ -408,6 +419,22 @@ gdk_check_wm_state_changed (GdkWindow *window)
     gdk_check_wm_desktop_changed (window);
   else
     do_net_wm_state_changes (window);
+
+ out:
+  g_object_unref (window);
+}
+
+static void
+gdk_check_wm_state_changed (GdkWindow *window)
+{
+  GdkDisplay *display = GDK_WINDOW_DISPLAY (window);
+
+  _gdk_x11_get_window_property_async (display,
+                                      GDK_WINDOW_XID (window),
+                                      gdk_x11_get_xatom_by_name_for_display (display, "_NET_WM_STATE"),
+                                      XA_ATOM,
+                                      wm_state_received,
+                                      g_object_ref (window));
 }
 
 static Window
@@ -445,6 +472,49 @@ get_event_xwindow (XEvent             *xevent)
   return xwindow;
 }
 
+typedef struct {
+  Window window;
+  Window event;
+  gboolean found;
+} LaterConfigureData;
+
+static Bool
+later_configure_predicate (Display  *xdisplay,
+                           XEvent   *xevent,
+                           XPointer  arg)
+{
+  LaterConfigureData *data = (LaterConfigureData *) arg;
+
+  if (xevent->type == ConfigureNotify &&
+      xevent->xconfigure.window == data->window &&
+      xevent->xconfigure.event == data->event)
+    data->found = TRUE;
+
+  /* Only look, never take events out of the queue */
+  return False;
+}
+
+/* Whether another ConfigureNotify for the same window is already
+ * waiting in the queue. During interactive resizes the window manager
+ * sends a stream of them, and each one would otherwise cost a round
+ * trip for finding the root position of the window.
+ */
+static gboolean
+has_later_configure (XEvent *xevent)
+{
+  LaterConfigureData data;
+  XEvent tmp_event;
+
+  data.window = xevent->xconfigure.window;
+  data.event = xevent->xconfigure.event;
+  data.found = FALSE;
+
+  XCheckIfEvent (xevent->xany.display, &tmp_event,
+                 later_configure_predicate, (XPointer) &data);
+
+  return data.found;
+}
+
 static gboolean
 gdk_x11_display_translate_event (GdkEventTranslator *translator,
                                  GdkDisplay         *display,
@@ -820,7 +890,17 @@ gdk_x11_display_translate_event (GdkEventTranslator *translator,
 
 	  if (!xevent->xconfigure.send_event &&
 	      !xevent->xconfigure.override_redirect &&
-	      !GDK_WINDOW_DESTROYED (window))
+	      !GDK_WINDOW_DESTROYED (window) &&
+	      has_later_configure (xevent))
+	    {
+	      /* The position is only needed for the last event, keep
+	       * the old one until then */
+	      event->configure.x = window->x;
+	      event->configure.y = window->y;
+	    }
+	  else if (!xevent->xconfigure.send_event &&
+		   !xevent->xconfigure.override_redirect &&
+		   !GDK_WINDOW_DESTROYED (window))
 	    {
 	      gint tx = 0;
 	      gint ty = 0;
@@ -1204,6 +1284,7 @@ _gdk_wm_protocols_filter (GdkXEvent *xev,
                 timings->refresh_interval = refresh_interval;
 
               timings->complete = TRUE;
+              _gdk_frame_clock_report_input_latency (clock, timings);
 #ifdef G_ENABLE_DEBUG
               if ((_gdk_debug_flags & GDK_DEBUG_FRAMES) != 0)
                 _gdk_frame_clock_debug_print_timings (clock, timings);
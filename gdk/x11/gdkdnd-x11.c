@@ -59,6 +59,15 @@ typedef struct {
   gboolean shape_selected;
   gboolean shape_valid;
   cairo_region_t *shape;
+  /* The children of the window, as last queried; this is what a
+   * drag looks at on every motion, so it is kept for the lifetime
+   * of the cache and dropped when the window changes size or gets
+   * mapped or unmapped.
+   */
+  GdkChildInfoX11 *children;
+  guint nchildren;
+  gboolean has_wm_state;
+  gboolean children_valid;
 } GdkCacheChild;
 
 typedef struct {
@@ -302,6 +311,8 @@ free_cache_child (GdkCacheChild *child,
   if (child->shape)
     cairo_region_destroy (child->shape);
 
+  g_free (child->children);
+
   if (child->shape_selected && display)
     {
       GdkX11Display *display_x11 = GDK_X11_DISPLAY (display);
@@ -332,6 +343,10 @@ gdk_window_cache_add (GdkWindowCache *cache,
   child->shape_selected = FALSE;
   child->shape_valid = FALSE;
   child->shape = NULL;
+  child->children = NULL;
+  child->nchildren = 0;
+  child->has_wm_state = FALSE;
+  child->children_valid = FALSE;
 
   cache->children = g_list_prepend (cache->children, child);
   g_hash_table_insert (cache->child_hash, GUINT_TO_POINTER (xid),
@@ -395,6 +410,8 @@ gdk_window_cache_filter (GdkXEvent *xev,
         if (node)
           {
             GdkCacheChild *child = node->data;
+            if (child->width != xce->width || child->height != xce->height)
+              child->children_valid = FALSE;
             child->x = xce->x;
             child->y = xce->y;
             child->width = xce->width;
@@ -469,6 +486,7 @@ gdk_window_cache_filter (GdkXEvent *xev,
           {
             GdkCacheChild *child = node->data;
             child->mapped = TRUE;
+            child->children_valid = FALSE;
           }
         break;
       }
@@ -485,6 +503,7 @@ gdk_window_cache_filter (GdkXEvent *xev,
           {
             GdkCacheChild *child = node->data;
             child->mapped = FALSE;
+            child->children_valid = FALSE;
           }
         break;
       }
@@ -693,31 +712,22 @@ is_pointer_within_shape (GdkDisplay    *display,
          cairo_region_contains_point (child->shape, x_pos, y_pos);
 }
 
+static Window get_client_window_at_coords_recurse (GdkDisplay *display,
+                                                   Window      win,
+                                                   gboolean    is_toplevel,
+                                                   gint        x,
+                                                   gint        y);
+
 static Window
-get_client_window_at_coords_recurse (GdkDisplay *display,
-                                     Window      win,
-                                     gboolean    is_toplevel,
-                                     gint        x,
-                                     gint        y)
+get_client_window_in_children (GdkDisplay      *display,
+                               GdkChildInfoX11 *children,
+                               guint            nchildren,
+                               gint             x,
+                               gint             y)
 {
-  GdkChildInfoX11 *children;
-  unsigned int nchildren;
   int i;
   gboolean found_child = FALSE;
   GdkChildInfoX11 child = { 0, };
-  gboolean has_wm_state = FALSE;
-
-  if (!_gdk_x11_get_window_child_info (display, win, TRUE,
-                                       is_toplevel? &has_wm_state : NULL,
-                                       &children, &nchildren))
-    return None;
-
-  if (has_wm_state)
-    {
-      g_free (children);
-
-      return win;
-    }
 
   for (i = nchildren - 1; (i >= 0) && !found_child; i--)
     {
@@ -734,8 +744,6 @@ get_client_window_at_coords_recurse (GdkDisplay *display,
         }
     }
 
-  g_free (children);
-
   if (found_child)
     {
       if (child.has_wm_state)
@@ -747,6 +755,33 @@ get_client_window_at_coords_recurse (GdkDisplay *display,
     return None;
 }
 
+static Window
+get_client_window_at_coords_recurse (GdkDisplay *display,
+                                     Window      win,
+                                     gboolean    is_toplevel,
+                                     gint        x,
+                                     gint        y)
+{
+  GdkChildInfoX11 *children;
+  unsigned int nchildren;
+  gboolean has_wm_state = FALSE;
+  Window retval;
+
+  if (!_gdk_x11_get_window_child_info (display, win, TRUE,
+                                       is_toplevel? &has_wm_state : NULL,
+                                       &children, &nchildren))
+    return None;
+
+  if (has_wm_state)
+    retval = win;
+  else
+    retval = get_client_window_in_children (display, children, nchildren, x, y);
+
+  g_free (children);
+
+  return retval;
+}
+
 static Window
 get_client_window_at_coords (GdkWindowCache *cache,
                              Window          ignore,
@@ -780,10 +815,29 @@ get_client_window_at_coords (GdkWindowCache *cache,
                   continue;
                 }
 
-              retval = get_client_window_at_coords_recurse (display,
-                  child->xid, TRUE,
-                  x_root - child->x,
-                  y_root - child->y);
+              if (!child->children_valid)
+                {
+                  g_free (child->children);
+                  child->children = NULL;
+                  child->nchildren = 0;
+                  child->has_wm_state = FALSE;
+                  child->children_valid =
+                    _gdk_x11_get_window_child_info (display, child->xid, TRUE,
+                                                    &child->has_wm_state,
+                                                    &child->children,
+                                                    &child->nchildren);
+                }
+
+              if (!child->children_valid)
+                retval = None;
+              else if (child->has_wm_state)
+                retval = child->xid;
+              else
+                retval = get_client_window_in_children (display,
+                                                        child->children,
+                                                        child->nchildren,
+                                                        x_root - child->x,
+                                                        y_root - child->y);
               if (!retval)
                 retval = child->xid;
             }
@@ -309,6 +309,42 @@ gdk_event_source_check (GSource *source)
   return retval;
 }
 
+/* Whether @next, which directly follows @xevent in the Xlib queue,
+ * makes @xevent redundant: consecutive pointer motions with the same
+ * state on a window that allows compression, and consecutive
+ * configure notifies for the same window.
+ */
+static gboolean
+gdk_event_source_can_compress (GdkDisplay *display,
+                               XEvent     *xevent,
+                               XEvent     *next)
+{
+  GdkWindow *window;
+
+  if (next->type != xevent->type ||
+      next->xany.window != xevent->xany.window ||
+      next->xany.send_event != xevent->xany.send_event)
+    return FALSE;
+
+  switch (xevent->type)
+    {
+    case MotionNotify:
+      if (next->xmotion.state != xevent->xmotion.state ||
+          next->xmotion.subwindow != xevent->xmotion.subwindow ||
+          next->xmotion.same_screen != xevent->xmotion.same_screen)
+        return FALSE;
+
+      window = gdk_x11_window_lookup_for_display (display, xevent->xany.window);
+      return window != NULL && gdk_window_get_event_compression (window);
+
+    case ConfigureNotify:
+      return next->xconfigure.window == xevent->xconfigure.window;
+
+    default:
+      return FALSE;
+    }
+}
+
 void
 _gdk_x11_display_queue_events (GdkDisplay *display)
 {
@@ -335,6 +371,20 @@ _gdk_x11_display_queue_events (GdkDisplay *display)
             continue;
         }
 
+      /* Drop events that are superseded by the ones already read
+       * after them, so that only the last one gets translated
+       */
+      while (XEventsQueued (xdisplay, QueuedAlready) > 0)
+        {
+          XEvent next;
+
+          XPeekEvent (xdisplay, &next);
+          if (!gdk_event_source_can_compress (display, &xevent, &next))
+            break;
+
+          XNextEvent (xdisplay, &xevent);
+        }
+
       event = gdk_event_source_translate_event (event_source, &xevent);
 
       if (event)
@@ -78,6 +78,10 @@ struct _GdkX11Keymap
   guint modifier_state;
   guint current_serial;
 
+  /* Maps keyvals to arrays of all the GdkKeymapKeys producing them */
+  GHashTable *keyval_entries;
+  guint keyval_entries_serial;
+
 #ifdef HAVE_XKB
   XkbDescPtr xkb_desc;
   /* We cache the directions */
@@ -138,6 +142,9 @@ gdk_x11_keymap_finalize (GObject *object)
   if (keymap_x11->mod_keymap)
     XFreeModifiermap (keymap_x11->mod_keymap);
 
+  if (keymap_x11->keyval_entries)
+    g_hash_table_unref (keymap_x11->keyval_entries);
+
 #ifdef HAVE_XKB
   if (keymap_x11->xkb_desc)
     XkbFreeKeyboard (keymap_x11->xkb_desc, XkbAllComponentsMask, True);
@@ -757,19 +764,60 @@ gdk_x11_keymap_get_modifier_state (GdkKeymap *keymap)
   return keymap_x11->modifier_state;
 }
 
-static gboolean
-gdk_x11_keymap_get_entries_for_keyval (GdkKeymap     *keymap,
-                                       guint          keyval,
-                                       GdkKeymapKey **keys,
-                                       gint          *n_keys)
+static void
+add_keyval_entry (GHashTable *entries,
+                  guint       keyval,
+                  gint        keycode,
+                  gint        group,
+                  gint        level)
 {
-  GdkX11Keymap *keymap_x11 = GDK_X11_KEYMAP (keymap);
-  GArray *retval;
+  GArray *array;
+  GdkKeymapKey key;
+
+  array = g_hash_table_lookup (entries, GUINT_TO_POINTER (keyval));
+  if (array == NULL)
+    {
+      array = g_array_new (FALSE, FALSE, sizeof (GdkKeymapKey));
+      g_hash_table_insert (entries, GUINT_TO_POINTER (keyval), array);
+    }
 
-  retval = g_array_new (FALSE, FALSE, sizeof (GdkKeymapKey));
+  key.keycode = keycode;
+  key.group = group;
+  key.level = level;
+
+  g_array_append_val (array, key);
+}
+
+/* Looking up the keys for a keyval means going through the whole
+ * keymap, and it happens several times per key press for accelerators
+ * and mnemonics. So we do it once for all keyvals and keep the result
+ * until the keymap changes.
+ */
+static GHashTable *
+get_keyval_entries (GdkX11Keymap *keymap_x11)
+{
+  GHashTable *entries;
 
 #ifdef HAVE_XKB
-  if (KEYMAP_USE_XKB (keymap))
+  if (KEYMAP_USE_XKB (GDK_KEYMAP (keymap_x11)))
+    get_xkb (keymap_x11);
+  else
+#endif
+    get_keymap (keymap_x11);
+
+  if (keymap_x11->keyval_entries &&
+      keymap_x11->keyval_entries_serial == keymap_x11->current_serial)
+    return keymap_x11->keyval_entries;
+
+  if (keymap_x11->keyval_entries)
+    g_hash_table_unref (keymap_x11->keyval_entries);
+
+  entries = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) g_array_unref);
+  keymap_x11->keyval_entries = entries;
+  keymap_x11->keyval_entries_serial = keymap_x11->current_serial;
+
+#ifdef HAVE_XKB
+  if (KEYMAP_USE_XKB (GDK_KEYMAP (keymap_x11)))
     {
       /* See sec 15.3.4 in XKB docs */
 
@@ -798,20 +846,7 @@ gdk_x11_keymap_get_entries_for_keyval (GdkKeymap     *keymap,
               /* check out our cool loop invariant */
               g_assert (i == (group * max_shift_levels + level));
 
-              if (entry[i] == keyval)
-                {
-                  /* Found a match */
-                  GdkKeymapKey key;
-
-                  key.keycode = keycode;
-                  key.group = group;
-                  key.level = level;
-
-                  g_array_append_val (retval, key);
-
-                  g_assert (XkbKeySymEntry (xkb, keycode, level, group) ==
-                            keyval);
-                }
+              add_keyval_entry (entries, entry[i], keycode, group, level);
 
               ++level;
 
@@ -841,19 +876,8 @@ gdk_x11_keymap_get_entries_for_keyval (GdkKeymap     *keymap,
 
           while (i < keymap_x11->keysyms_per_keycode)
             {
-              if (syms[i] == keyval)
-                {
-                  /* found a match */
-                  GdkKeymapKey key;
-
-                  key.keycode = keycode;
-
-                  /* The "classic" non-XKB keymap has 2 levels per group */
-                  key.group = i / 2;
-                  key.level = i % 2;
-
-                  g_array_append_val (retval, key);
-                }
+              /* The "classic" non-XKB keymap has 2 levels per group */
+              add_keyval_entry (entries, syms[i], keycode, i / 2, i % 2);
 
               ++i;
             }
@@ -862,10 +886,25 @@ gdk_x11_keymap_get_entries_for_keyval (GdkKeymap     *keymap,
         }
     }
 
-  if (retval->len > 0)
+  return entries;
+}
+
+static gboolean
+gdk_x11_keymap_get_entries_for_keyval (GdkKeymap     *keymap,
+                                       guint          keyval,
+                                       GdkKeymapKey **keys,
+                                       gint          *n_keys)
+{
+  GdkX11Keymap *keymap_x11 = GDK_X11_KEYMAP (keymap);
+  GArray *array;
+
+  array = g_hash_table_lookup (get_keyval_entries (keymap_x11),
+                               GUINT_TO_POINTER (keyval));
+
+  if (array)
     {
-      *keys = (GdkKeymapKey*) retval->data;
-      *n_keys = retval->len;
+      *keys = g_memdup (array->data, array->len * sizeof (GdkKeymapKey));
+      *n_keys = array->len;
     }
   else
     {
@@ -873,8 +912,6 @@ gdk_x11_keymap_get_entries_for_keyval (GdkKeymap     *keymap,
       *n_keys = 0;
     }
 
-  g_array_free (retval, retval->len > 0 ? FALSE : TRUE);
-
   return *n_keys > 0;
 }
 
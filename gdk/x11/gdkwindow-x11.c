@@ -435,7 +435,10 @@ gdk_x11_window_end_frame (GdkWindow *window)
     }
 
   if (!impl->toplevel->frame_pending)
-    timings->complete = TRUE;
+    {
+      timings->complete = TRUE;
+      _gdk_frame_clock_report_input_latency (clock, timings);
+    }
 }
 
 /*****************************************************
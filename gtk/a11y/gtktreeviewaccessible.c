@@ -35,9 +35,18 @@
 #include "gtkcellaccessibleparent.h"
 #include "gtkcellaccessibleprivate.h"
 
+/* Updates touching more cells than this don't emit a children-changed
+ * signal per cell, but a single model-changed from an idle.
+ */
+#define MAX_CHILDREN_CHANGED 256
+
 struct _GtkTreeViewAccessiblePrivate
 {
   GHashTable *cell_infos;
+
+  guint notify_idle;
+  guint model_changed_pending        : 1;
+  guint visible_data_changed_pending : 1;
 };
 
 typedef struct _GtkTreeViewAccessibleCellInfo  GtkTreeViewAccessibleCellInfo;
@@ -136,6 +145,65 @@ cell_info_equal (gconstpointer a, gconstpointer b)
          cell_info_a->cell_col_ref == cell_info_b->cell_col_ref;
 }
 
+static gboolean
+gtk_tree_view_accessible_notify_idle (gpointer data)
+{
+  GtkTreeViewAccessible *accessible = data;
+  GtkTreeViewAccessiblePrivate *priv = accessible->priv;
+  gboolean model_changed, visible_data_changed;
+
+  model_changed = priv->model_changed_pending;
+  visible_data_changed = priv->visible_data_changed_pending || model_changed;
+
+  priv->notify_idle = 0;
+  priv->model_changed_pending = FALSE;
+  priv->visible_data_changed_pending = FALSE;
+
+  g_object_freeze_notify (G_OBJECT (accessible));
+  if (model_changed)
+    g_signal_emit_by_name (accessible, "model-changed");
+  if (visible_data_changed)
+    g_signal_emit_by_name (accessible, "visible-data-changed");
+  g_object_thaw_notify (G_OBJECT (accessible));
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Coalesces notifications about bulk changes, so that loading a large
+ * model emits a handful of signals instead of one per row and cell.
+ */
+static void
+gtk_tree_view_accessible_queue_notify (GtkTreeViewAccessible *accessible,
+                                       gboolean               model_changed)
+{
+  GtkTreeViewAccessiblePrivate *priv = accessible->priv;
+
+  if (model_changed)
+    priv->model_changed_pending = TRUE;
+  else
+    priv->visible_data_changed_pending = TRUE;
+
+  if (priv->notify_idle == 0)
+    {
+      priv->notify_idle = gdk_threads_add_idle (gtk_tree_view_accessible_notify_idle, accessible);
+      g_source_set_name_by_id (priv->notify_idle, "[gtk+] gtk_tree_view_accessible_notify_idle");
+    }
+}
+
+static void
+gtk_tree_view_accessible_cancel_notify (GtkTreeViewAccessible *accessible)
+{
+  GtkTreeViewAccessiblePrivate *priv = accessible->priv;
+
+  if (priv->notify_idle != 0)
+    {
+      g_source_remove (priv->notify_idle);
+      priv->notify_idle = 0;
+    }
+  priv->model_changed_pending = FALSE;
+  priv->visible_data_changed_pending = FALSE;
+}
+
 static void
 gtk_tree_view_accessible_initialize (AtkObject *obj,
                                      gpointer   data)
@@ -170,6 +238,8 @@ gtk_tree_view_accessible_finalize (GObject *object)
 {
   GtkTreeViewAccessible *accessible = GTK_TREE_VIEW_ACCESSIBLE (object);
 
+  gtk_tree_view_accessible_cancel_notify (accessible);
+
   if (accessible->priv->cell_infos)
     g_hash_table_destroy (accessible->priv->cell_infos);
 
@@ -222,6 +292,7 @@ gtk_tree_view_accessible_widget_unset (GtkAccessible *gtkaccessible)
 {
   GtkTreeViewAccessible *accessible = GTK_TREE_VIEW_ACCESSIBLE (gtkaccessible);
 
+  gtk_tree_view_accessible_cancel_notify (accessible);
   g_hash_table_remove_all (accessible->priv->cell_infos);
 
   GTK_ACCESSIBLE_CLASS (gtk_tree_view_accessible_parent_class)->widget_unset (gtkaccessible);
@@ -1583,7 +1654,11 @@ _gtk_tree_view_accessible_add (GtkTreeView *treeview,
   g_signal_emit_by_name (accessible, "row-inserted", row, n_rows);
 
   n_cols = get_n_columns (treeview);
-  if (n_cols)
+  if (n_rows * n_cols > MAX_CHILDREN_CHANGED)
+    {
+      gtk_tree_view_accessible_queue_notify (accessible, TRUE);
+    }
+  else if (n_cols)
     {
       for (i = (row + 1) * n_cols; i < (row + n_rows + 1) * n_cols; i++)
         {
@@ -1627,10 +1702,15 @@ _gtk_tree_view_accessible_remove (GtkTreeView *treeview,
   n_cols = get_n_columns (treeview);
   if (n_cols)
     {
-      for (i = (n_rows + row + 1) * n_cols - 1; i >= (row + 1) * n_cols; i--)
+      if (n_rows * n_cols > MAX_CHILDREN_CHANGED)
+        gtk_tree_view_accessible_queue_notify (accessible, TRUE);
+      else
         {
-         /* Pass NULL as the child object, i.e. 4th argument */
-          g_signal_emit_by_name (accessible, "children-changed::remove", i, NULL, NULL);
+          for (i = (n_rows + row + 1) * n_cols - 1; i >= (row + 1) * n_cols; i--)
+            {
+             /* Pass NULL as the child object, i.e. 4th argument */
+              g_signal_emit_by_name (accessible, "children-changed::remove", i, NULL, NULL);
+            }
         }
 
       g_hash_table_iter_init (&iter, accessible->priv->cell_infos);
@@ -1652,7 +1732,9 @@ _gtk_tree_view_accessible_changed (GtkTreeView *treeview,
   GtkTreeViewAccessible *accessible;
   guint i;
 
-  accessible = GTK_TREE_VIEW_ACCESSIBLE (gtk_widget_get_accessible (GTK_WIDGET (treeview)));
+  accessible = GTK_TREE_VIEW_ACCESSIBLE (_gtk_widget_peek_accessible (GTK_WIDGET (treeview)));
+  if (accessible == NULL)
+    return;
 
   for (i = 0; i < gtk_tree_view_get_n_columns (treeview); i++)
     {
@@ -1667,7 +1749,7 @@ _gtk_tree_view_accessible_changed (GtkTreeView *treeview,
       _gtk_cell_accessible_update_cache (cell);
     }
 
-  g_signal_emit_by_name (accessible, "visible-data-changed");
+  gtk_tree_view_accessible_queue_notify (accessible, FALSE);
 }
 
 /* NB: id is not checked, only columns < id are.
@@ -83,6 +83,7 @@
 #include <gtk/gtkcolorchooserwidget.h>
 #include <gtk/gtkcolorsel.h>
 #include <gtk/gtkcolorseldialog.h>
+#include <gtk/gtkcolumnstore.h>
 #include <gtk/gtkcombobox.h>
 #include <gtk/gtkcomboboxtext.h>
 #include <gtk/gtkcomboboxentry.h>
@@ -183,6 +183,26 @@ _gtk_accel_map_init (void)
     accel_entry_ht = g_hash_table_new (accel_entry_hash, accel_entry_equal);
 }
 
+static AccelEntry*
+accel_entry_new (const gchar    *accel_path,
+                 guint           accel_key,
+                 GdkModifierType accel_mods)
+{
+  AccelEntry *entry;
+
+  entry = g_slice_new0 (AccelEntry);
+  entry->accel_path = g_intern_string (accel_path);
+  entry->std_accel_key = accel_key;
+  entry->std_accel_mods = accel_mods;
+  entry->accel_key = accel_key;
+  entry->accel_mods = accel_mods;
+  entry->changed = FALSE;
+  entry->lock_count = 0;
+  g_hash_table_insert (accel_entry_ht, entry, entry);
+
+  return entry;
+}
+
 gboolean
 _gtk_accel_path_is_valid (const gchar *accel_path)
 {
@@ -241,15 +261,7 @@ gtk_accel_map_add_entry (const gchar    *accel_path,
     }
   else
     {
-      entry = g_slice_new0 (AccelEntry);
-      entry->accel_path = g_intern_string (accel_path);
-      entry->std_accel_key = accel_key;
-      entry->std_accel_mods = accel_mods;
-      entry->accel_key = accel_key;
-      entry->accel_mods = accel_mods;
-      entry->changed = FALSE;
-      entry->lock_count = 0;
-      g_hash_table_insert (accel_entry_ht, entry, entry);
+      entry = accel_entry_new (accel_path, accel_key, accel_mods);
 
       do_accel_map_changed (entry);
     }
@@ -322,13 +334,15 @@ internal_change_entry (const gchar    *accel_path,
   GQuark entry_quark;
   AccelEntry *entry = accel_path_lookup (accel_path);
 
-  /* not much todo if there's no entry yet */
+  /* not much todo if there's no entry yet; this is the common
+   * case when loading an accel map at startup, so only notify
+   * once for the new entry
+   */
   if (!entry)
     {
       if (!simulate)
 	{
-	  gtk_accel_map_add_entry (accel_path, 0, 0);
-	  entry = accel_path_lookup (accel_path);
+	  entry = accel_entry_new (accel_path, 0, 0);
 	  entry->accel_key = accel_key;
 	  entry->accel_mods = accel_mods;
 	  entry->changed = TRUE;
@@ -536,10 +550,7 @@ accel_map_parse_accel_path (GScanner *scanner)
   g_scanner_get_next_token (scanner);
   accel = g_strdup (scanner->value.v_string);
 
-  /* ensure the entry is present */
-  gtk_accel_map_add_entry (path, 0, 0);
-
-  /* and propagate it */
+  /* propagate it; this creates the entry if it isn't present yet */
   gtk_accelerator_parse (accel, &accel_key, &accel_mods);
   gtk_accel_map_change_entry (path, accel_key, accel_mods, TRUE);
 
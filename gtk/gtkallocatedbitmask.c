@@ -50,6 +50,10 @@ gtk_allocated_bitmask_resize (GtkBitmask *mask,
 {
   gsize i;
 
+  /* Lookups clear bits one by one, don't realloc for each of them */
+  if (size == mask->len)
+    return mask;
+
   mask = g_realloc (mask, sizeof (GtkBitmask) + sizeof(VALUE_TYPE) * (size - 1));
 
   for (i = mask->len; i < size; i++)
@@ -216,9 +220,9 @@ _gtk_allocated_bitmask_subtract (GtkBitmask       *mask,
   mask = gtk_bitmask_ensure_allocated (mask);
   ENSURE_ALLOCATED (other, other_allocated);
 
-  for (i = 0; i < other->len; i++)
+  for (i = 0; i < MIN (mask->len, other->len); i++)
     {
-      mask->data[i] |= ~other->data[i];
+      mask->data[i] &= ~other->data[i];
     }
 
   return gtk_allocated_bitmask_shrink (mask);
@@ -285,6 +289,7 @@ _gtk_allocated_bitmask_invert_range (GtkBitmask *mask,
                                      guint       start,
                                      guint       end)
 {
+  guint start_word, start_bit, end_word, end_bit;
   guint i;
 
   g_return_val_if_fail (mask != NULL, NULL);
@@ -292,11 +297,25 @@ _gtk_allocated_bitmask_invert_range (GtkBitmask *mask,
 
   mask = gtk_bitmask_ensure_allocated (mask);
 
-  /* I CAN HAS SPEEDUP? */
-  for (i = start; i < end; i++)
-    mask = _gtk_allocated_bitmask_set (mask, i, !_gtk_allocated_bitmask_get (mask, i));
+  gtk_allocated_bitmask_indexes (start, &start_word, &start_bit);
+  gtk_allocated_bitmask_indexes (end - 1, &end_word, &end_bit);
 
-  return mask;
+  if (end_word >= mask->len)
+    mask = gtk_allocated_bitmask_resize (mask, end_word + 1);
+
+  for (i = start_word; i <= end_word; i++)
+    {
+      VALUE_TYPE invert = ~(VALUE_TYPE) 0;
+
+      if (i == start_word)
+        invert &= ~(VALUE_BIT (start_bit) - 1);
+      if (i == end_word && end_bit + 1 < VALUE_SIZE_BITS)
+        invert &= VALUE_BIT (end_bit + 1) - 1;
+
+      mask->data[i] ^= invert;
+    }
+
+  return gtk_allocated_bitmask_shrink (mask);
 }
 
 gboolean
@@ -522,6 +522,43 @@ compare_apps_func (gconstpointer a,
   return !g_app_info_equal (G_APP_INFO (a), G_APP_INFO (b));
 }
 
+/* Getting all applications means reading all the desktop files on the
+ * system, and the result is the same for every app chooser. So we keep
+ * it around until the app info monitor tells us that it changed.
+ */
+static GAppInfoMonitor *all_applications_monitor = NULL;
+static GList *all_applications_cache = NULL;
+
+static void
+all_applications_changed (GAppInfoMonitor *monitor,
+                          gpointer         data)
+{
+  g_list_free_full (all_applications_cache, g_object_unref);
+  all_applications_cache = NULL;
+}
+
+static void
+ensure_all_applications_monitor (void)
+{
+  /* This needs to be connected before the handler of any app chooser,
+   * so that refreshing them doesn't pick up the old list */
+  if (all_applications_monitor == NULL)
+    {
+      all_applications_monitor = g_app_info_monitor_get ();
+      g_signal_connect (all_applications_monitor, "changed",
+                        G_CALLBACK (all_applications_changed), NULL);
+    }
+}
+
+static GList *
+get_all_applications (void)
+{
+  if (all_applications_cache == NULL)
+    all_applications_cache = g_app_info_get_all ();
+
+  return g_list_copy_deep (all_applications_cache, (GCopyFunc) g_object_ref, NULL);
+}
+
 static gboolean
 gtk_app_chooser_widget_add_section (GtkAppChooserWidget *self,
                                     const gchar         *heading_title,
@@ -537,11 +574,23 @@ gtk_app_chooser_widget_add_section (GtkAppChooserWidget *self,
   gchar *app_string, *bold_string;
   GIcon *icon;
   GList *l;
+  GHashTable *exclude_ids;
+  const gchar *id;
   gboolean retval;
 
   retval = FALSE;
   heading_added = FALSE;
   bold_string = g_strdup_printf ("<b>%s</b>", heading_title);
+
+  /* The list of all applications can be long, so look up the
+   * excluded ones by id where possible */
+  exclude_ids = g_hash_table_new (g_str_hash, g_str_equal);
+  for (l = exclude_apps; l != NULL; l = l->next)
+    {
+      id = g_app_info_get_id (l->data);
+      if (id != NULL)
+        g_hash_table_add (exclude_ids, (gpointer) id);
+    }
   
   for (l = applications; l != NULL; l = l->next)
     {
@@ -551,8 +600,10 @@ gtk_app_chooser_widget_add_section (GtkAppChooserWidget *self,
           !g_app_info_supports_files (app))
         continue;
 
-      if (g_list_find_custom (exclude_apps, app,
-                              (GCompareFunc) compare_apps_func))
+      id = g_app_info_get_id (app);
+      if (id != NULL ? g_hash_table_contains (exclude_ids, id)
+                     : g_list_find_custom (exclude_apps, app,
+                                           (GCompareFunc) compare_apps_func) != NULL)
         continue;
 
       if (!heading_added && show_headings)
@@ -600,6 +651,7 @@ gtk_app_chooser_widget_add_section (GtkAppChooserWidget *self,
     }
 
   g_free (bold_string);
+  g_hash_table_unref (exclude_ids);
 
   return retval;
 }
@@ -780,7 +832,7 @@ gtk_app_chooser_widget_real_add_items (GtkAppChooserWidget *self)
 
   if (self->priv->show_other || self->priv->show_all)
     {
-      all_applications = g_app_info_get_all ();
+      all_applications = get_all_applications ();
 
       apps_added |= gtk_app_chooser_widget_add_section (self, _("Other Applications"),
                                                         show_headings,
@@ -1224,6 +1276,8 @@ gtk_app_chooser_widget_init (GtkAppChooserWidget *self)
                     G_CALLBACK (widget_button_press_event_cb),
                     self);
                     
+  ensure_all_applications_monitor ();
+
   self->priv->monitor = g_app_info_monitor_get ();
   g_signal_connect (self->priv->monitor, "changed",
 		    G_CALLBACK (app_info_changed), self);
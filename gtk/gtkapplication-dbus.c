@@ -208,10 +208,9 @@ gtk_application_impl_dbus_shutdown (GtkApplicationImpl *impl)
 G_DEFINE_QUARK (GtkApplicationImplDBus export id, gtk_application_impl_dbus_export_id)
 
 static void
-gtk_application_impl_dbus_window_added (GtkApplicationImpl *impl,
-                                        GtkWindow          *window)
+gtk_application_impl_dbus_export_window (GtkApplicationImplDBus *dbus,
+                                         GtkWindow              *window)
 {
-  GtkApplicationImplDBus *dbus = (GtkApplicationImplDBus *) impl;
   GActionGroup *actions;
   gchar *path;
   guint id;
@@ -219,6 +218,9 @@ gtk_application_impl_dbus_window_added (GtkApplicationImpl *impl,
   if (!dbus->session || !GTK_IS_APPLICATION_WINDOW (window))
     return;
 
+  if (g_object_get_qdata (G_OBJECT (window), gtk_application_impl_dbus_export_id_quark ()))
+    return;
+
   /* Export the action group of this window, based on its id */
   actions = gtk_application_window_get_action_group (GTK_APPLICATION_WINDOW (window));
 
@@ -229,6 +231,30 @@ gtk_application_impl_dbus_window_added (GtkApplicationImpl *impl,
   g_object_set_qdata (G_OBJECT (window), gtk_application_impl_dbus_export_id_quark (), GUINT_TO_POINTER (id));
 }
 
+static void
+gtk_application_impl_dbus_window_added (GtkApplicationImpl *impl,
+                                        GtkWindow          *window)
+{
+  GtkApplicationImplDBus *dbus = (GtkApplicationImplDBus *) impl;
+
+  /* The object path of the window is only advertised on the realized
+   * window, so windows that are never shown don't need to be exported.
+   * Applications often create windows and fill their action groups
+   * long before showing them.
+   */
+  if (gtk_widget_get_realized (GTK_WIDGET (window)))
+    gtk_application_impl_dbus_export_window (dbus, window);
+}
+
+static void
+gtk_application_impl_dbus_handle_window_realize (GtkApplicationImpl *impl,
+                                                 GtkWindow          *window)
+{
+  GtkApplicationImplDBus *dbus = (GtkApplicationImplDBus *) impl;
+
+  gtk_application_impl_dbus_export_window (dbus, window);
+}
+
 static void
 gtk_application_impl_dbus_window_removed (GtkApplicationImpl *impl,
                                           GtkWindow          *window)
@@ -436,6 +462,7 @@ gtk_application_impl_dbus_class_init (GtkApplicationImplDBusClass *class)
   impl_class->shutdown = gtk_application_impl_dbus_shutdown;
   impl_class->window_added = gtk_application_impl_dbus_window_added;
   impl_class->window_removed = gtk_application_impl_dbus_window_removed;
+  impl_class->handle_window_realize = gtk_application_impl_dbus_handle_window_realize;
   impl_class->active_window_changed = gtk_application_impl_dbus_active_window_changed;
   impl_class->set_app_menu = gtk_application_impl_dbus_set_app_menu;
   impl_class->set_menubar = gtk_application_impl_dbus_set_menubar;
@@ -42,6 +42,9 @@ gtk_application_impl_x11_handle_window_realize (GtkApplicationImpl *impl,
   GdkWindow *gdk_window;
   gchar *window_path;
 
+  /* Export the window before advertising its path */
+  GTK_APPLICATION_IMPL_CLASS (gtk_application_impl_x11_parent_class)->handle_window_realize (impl, window);
+
   gdk_window = gtk_widget_get_window (GTK_WIDGET (window));
 
   if (!GDK_IS_X11_WINDOW (gdk_window))
@@ -63,7 +63,12 @@ static inline GtkBitmask *
 _gtk_bitmask_intersect (GtkBitmask       *mask,
                         const GtkBitmask *other)
 {
-  return _gtk_allocated_bitmask_intersect (mask, other);
+  if (_gtk_bitmask_is_allocated (mask) ||
+      _gtk_bitmask_is_allocated (other))
+    return _gtk_allocated_bitmask_intersect (mask, other);
+  else
+    return _gtk_bitmask_from_bits (_gtk_bitmask_to_bits (mask)
+                                   & _gtk_bitmask_to_bits (other));
 }
 
 static inline GtkBitmask *
@@ -82,7 +87,12 @@ static inline GtkBitmask *
 _gtk_bitmask_subtract (GtkBitmask       *mask,
                        const GtkBitmask *other)
 {
-  return _gtk_allocated_bitmask_subtract (mask, other);
+  if (_gtk_bitmask_is_allocated (mask) ||
+      _gtk_bitmask_is_allocated (other))
+    return _gtk_allocated_bitmask_subtract (mask, other);
+  else
+    return _gtk_bitmask_from_bits (_gtk_bitmask_to_bits (mask)
+                                   & ~_gtk_bitmask_to_bits (other));
 }
 
 static inline gboolean
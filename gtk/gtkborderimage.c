@@ -219,6 +219,56 @@ gtk_border_image_render_slice (cairo_t           *cr,
   cairo_pattern_destroy (pattern);
 }
 
+/* Computed images never change, so the source rendered at the size
+ * it was last used at is kept with it. For images with an intrinsic
+ * size, that is every size the border image is ever drawn at.
+ */
+typedef struct {
+  cairo_surface_t *surface;
+  int width;
+  int height;
+} GtkBorderImageSurface;
+
+static GQuark quark_border_image_surface = 0;
+
+static void
+gtk_border_image_surface_free (gpointer data)
+{
+  GtkBorderImageSurface *cached = data;
+
+  cairo_surface_destroy (cached->surface);
+  g_slice_free (GtkBorderImageSurface, cached);
+}
+
+static cairo_surface_t *
+gtk_border_image_get_surface (GtkBorderImage  *image,
+                              cairo_surface_t *target,
+                              int              width,
+                              int              height)
+{
+  GtkBorderImageSurface *cached;
+
+  if (G_UNLIKELY (quark_border_image_surface == 0))
+    quark_border_image_surface = g_quark_from_static_string ("gtk-border-image-surface");
+
+  cached = g_object_get_qdata (G_OBJECT (image->source), quark_border_image_surface);
+  if (cached &&
+      cached->width == width &&
+      cached->height == height &&
+      cairo_surface_get_type (cached->surface) == cairo_surface_get_type (target))
+    return cairo_surface_reference (cached->surface);
+
+  cached = g_slice_new (GtkBorderImageSurface);
+  cached->surface = _gtk_css_image_get_surface (image->source, target, width, height);
+  cached->width = width;
+  cached->height = height;
+
+  g_object_set_qdata_full (G_OBJECT (image->source), quark_border_image_surface,
+                           cached, gtk_border_image_surface_free);
+
+  return cairo_surface_reference (cached->surface);
+}
+
 static void
 gtk_border_image_compute_slice_size (GtkBorderImageSliceSize sizes[3],
                                      int                     surface_size,
@@ -257,9 +307,9 @@ _gtk_border_image_render (GtkBorderImage   *image,
 
   /* XXX: Optimize for (source_width == width && source_height == height) */
 
-  surface = _gtk_css_image_get_surface (image->source,
-                                        cairo_get_target (cr),
-                                        source_width, source_height);
+  surface = gtk_border_image_get_surface (image,
+                                          cairo_get_target (cr),
+                                          source_width, source_height);
 
   gtk_border_image_compute_slice_size (horizontal_slice,
                                        source_width, 
@@ -105,6 +105,16 @@
  * An id is also necessary to use the object as property value in other parts of
  * the UI definition. GTK+ reserves ids starting and ending with ___ (3 underscores)
  * for its own purposes.
+ *
+ * Toplevel objects which are not needed right away, like dialogs or
+ * popup menus, can be given a "lazy" attribute with a true value. Such
+ * an object and everything inside it is not constructed when the UI
+ * definition is added, but only when gtk_builder_get_object() is first
+ * called for it or for one of the objects it contains, or when another
+ * object refers to one of them. Objects which are not constructed yet
+ * are not returned by gtk_builder_get_objects(), and their signals are
+ * only connected by calls to gtk_builder_connect_signals() made after
+ * they have been constructed.
  * </para>
  * <para>
  * Setting properties of objects is pretty straightforward with the
@@ -273,8 +283,22 @@ struct _GtkBuilderPrivate
   gchar *resource_prefix;
   GType template_type;
   GtkApplication *application;
+  GHashTable *lazy_objects;
 };
 
+/* The part of a UI definition that describes a lazy toplevel object,
+ * shared by the ids of all the objects inside it
+ */
+typedef struct {
+  gint ref_count;
+  gchar *id;
+  GBytes *buffer;
+  gchar *filename_for_errors;
+  gchar *filename;
+  gchar *resource_prefix;
+  gchar *domain;
+} LazyObject;
+
 G_DEFINE_TYPE (GtkBuilder, gtk_builder, G_TYPE_OBJECT)
 
 static void
@@ -338,6 +362,8 @@ gtk_builder_finalize (GObject *object)
   g_hash_table_destroy (priv->objects);
   if (priv->callbacks)
     g_hash_table_destroy (priv->callbacks);
+  if (priv->lazy_objects)
+    g_hash_table_destroy (priv->lazy_objects);
 
   g_slist_foreach (priv->signals, (GFunc) _free_signal_info, NULL);
   g_slist_free (priv->signals);
@@ -609,6 +635,128 @@ _gtk_builder_add_object (GtkBuilder  *builder,
   g_hash_table_insert (builder->priv->objects, g_strdup (id), g_object_ref (object));
 }
 
+static LazyObject *
+lazy_object_ref (LazyObject *lazy)
+{
+  lazy->ref_count++;
+
+  return lazy;
+}
+
+static void
+lazy_object_unref (LazyObject *lazy)
+{
+  if (--lazy->ref_count > 0)
+    return;
+
+  g_free (lazy->id);
+  g_bytes_unref (lazy->buffer);
+  g_free (lazy->filename_for_errors);
+  g_free (lazy->filename);
+  g_free (lazy->resource_prefix);
+  g_free (lazy->domain);
+  g_slice_free (LazyObject, lazy);
+}
+
+void
+_gtk_builder_add_lazy_object (GtkBuilder  *builder,
+                              const gchar *id,
+                              const gchar *toplevel_id,
+                              GBytes      *buffer,
+                              const gchar *filename)
+{
+  GtkBuilderPrivate *priv = builder->priv;
+  LazyObject *lazy;
+
+  if (priv->lazy_objects == NULL)
+    priv->lazy_objects = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                g_free, (GDestroyNotify) lazy_object_unref);
+
+  if (strcmp (id, toplevel_id) == 0)
+    {
+      lazy = g_slice_new0 (LazyObject);
+      lazy->ref_count = 1;
+      lazy->id = g_strdup (id);
+      lazy->buffer = g_bytes_ref (buffer);
+      lazy->filename_for_errors = g_strdup (filename);
+      lazy->filename = g_strdup (priv->filename);
+      lazy->resource_prefix = g_strdup (priv->resource_prefix);
+      lazy->domain = g_strdup (priv->domain);
+    }
+  else
+    {
+      lazy = g_hash_table_lookup (priv->lazy_objects, toplevel_id);
+      g_assert (lazy != NULL);
+      lazy_object_ref (lazy);
+    }
+
+  g_hash_table_insert (priv->lazy_objects, g_strdup (id), lazy);
+}
+
+static gboolean
+lazy_object_matches (gpointer key,
+                     gpointer value,
+                     gpointer lazy)
+{
+  return value == lazy;
+}
+
+static void
+gtk_builder_build_lazy_object (GtkBuilder *builder,
+                               LazyObject *lazy)
+{
+  GtkBuilderPrivate *priv = builder->priv;
+  gchar *filename, *resource_prefix, *domain;
+  gchar *object_ids[2];
+  GSList *delayed_properties;
+  const gchar *buffer;
+  gsize length;
+  GError *error = NULL;
+
+  /* Forget about the subtree first, so that it is only built once */
+  lazy_object_ref (lazy);
+  g_hash_table_foreach_remove (priv->lazy_objects, lazy_object_matches, lazy);
+
+  /* This may happen in the middle of parsing another UI definition,
+   * so keep its state out of the way while parsing this one.
+   */
+  filename = priv->filename;
+  resource_prefix = priv->resource_prefix;
+  domain = g_strdup (priv->domain);
+  delayed_properties = priv->delayed_properties;
+
+  priv->filename = g_strdup (lazy->filename);
+  priv->resource_prefix = g_strdup (lazy->resource_prefix);
+  priv->delayed_properties = NULL;
+  gtk_builder_set_translation_domain (builder, lazy->domain);
+
+  object_ids[0] = lazy->id;
+  object_ids[1] = NULL;
+  buffer = g_bytes_get_data (lazy->buffer, &length);
+
+  _gtk_builder_parser_parse_buffer (builder, lazy->filename_for_errors,
+                                    buffer, length,
+                                    object_ids,
+                                    &error);
+  if (error)
+    {
+      g_warning ("Failed to construct lazy object '%s': %s",
+                 lazy->id, error->message);
+      g_error_free (error);
+    }
+
+  g_free (priv->filename);
+  g_free (priv->resource_prefix);
+  priv->filename = filename;
+  priv->resource_prefix = resource_prefix;
+  priv->delayed_properties = g_slist_concat (priv->delayed_properties,
+                                             delayed_properties);
+  gtk_builder_set_translation_domain (builder, domain);
+  g_free (domain);
+
+  lazy_object_unref (lazy);
+}
+
 GObject *
 _gtk_builder_construct (GtkBuilder *builder,
                         ObjectInfo *info,
@@ -922,7 +1070,7 @@ gtk_builder_apply_delayed_properties (GtkBuilder *builder)
         {
           GObject *obj;
 
-          obj = g_hash_table_lookup (builder->priv->objects, property->value);
+          obj = gtk_builder_get_object (builder, property->value);
           if (!obj)
             g_warning ("No object called: %s", property->value);
           else
@@ -1419,10 +1567,25 @@ GObject *
 gtk_builder_get_object (GtkBuilder  *builder,
                         const gchar *name)
 {
+  GObject *object;
+
   g_return_val_if_fail (GTK_IS_BUILDER (builder), NULL);
   g_return_val_if_fail (name != NULL, NULL);
 
-  return g_hash_table_lookup (builder->priv->objects, name);
+  object = g_hash_table_lookup (builder->priv->objects, name);
+  if (object == NULL && builder->priv->lazy_objects != NULL)
+    {
+      LazyObject *lazy;
+
+      lazy = g_hash_table_lookup (builder->priv->lazy_objects, name);
+      if (lazy)
+        {
+          gtk_builder_build_lazy_object (builder, lazy);
+          object = g_hash_table_lookup (builder->priv->objects, name);
+        }
+    }
+
+  return object;
 }
 
 static void
@@ -1686,8 +1849,8 @@ gtk_builder_connect_signals_full (GtkBuilder            *builder,
       
       if (signal->connect_object_name)
 	{
-	  connect_object = g_hash_table_lookup (builder->priv->objects,
-						signal->connect_object_name);
+	  connect_object = gtk_builder_get_object (builder,
+						   signal->connect_object_name);
 	  if (!connect_object)
 	      g_warning ("Could not lookup object %s on signal %s of object %s",
 			 signal->connect_object_name, signal->name,
@@ -322,6 +322,8 @@ parse_object (GMarkupParseContext  *context,
   gchar *object_class = NULL;
   gchar *object_id = NULL;
   gchar *constructor = NULL;
+  gboolean has_id = FALSE;
+  gboolean lazy = FALSE;
   gint line, line2;
 
   child_info = state_peek_info (data, ChildInfo);
@@ -339,6 +341,11 @@ parse_object (GMarkupParseContext  *context,
         object_id = g_strdup (values[i]);
       else if (strcmp (names[i], "constructor") == 0)
         constructor = g_strdup (values[i]);
+      else if (strcmp (names[i], "lazy") == 0)
+        {
+          if (!_gtk_builder_boolean_from_string (values[i], &lazy, error))
+            return;
+        }
       else if (strcmp (names[i], "type-func") == 0)
         {
 	  /* Call the GType function, and return the name of the GType,
@@ -371,13 +378,64 @@ parse_object (GMarkupParseContext  *context,
 
   data->object_counter++;
 
-  if (!object_id)
+  if (object_id)
+    has_id = TRUE;
+  else
     {
       object_id = g_strdup_printf ("___object_%d___", data->object_counter++);
     }
 
   ++data->cur_object_level;
 
+  /* Lazy objects are only remembered here, and built from the same
+   * buffer as a requested object once somebody asks for them.
+   */
+  if (lazy && !data->requested_objects && !data->inside_lazy_object)
+    {
+      if (child_info)
+        {
+          error_invalid_attribute (data, element_name, "lazy", error);
+          g_free (object_class);
+          g_free (object_id);
+          g_free (constructor);
+          return;
+        }
+
+      if (!data->lazy_buffer)
+        data->lazy_buffer = g_bytes_new (data->buffer,
+                                         data->length == (gsize) -1 ? strlen (data->buffer) : data->length);
+
+      data->inside_lazy_object = TRUE;
+      data->lazy_object_level = data->cur_object_level;
+      data->lazy_object_id = g_strdup (object_id);
+    }
+
+  if (data->inside_lazy_object)
+    {
+      g_markup_parse_context_get_position (context, &line, NULL);
+      line2 = GPOINTER_TO_INT (g_hash_table_lookup (data->object_ids, object_id));
+      if (line2 != 0)
+        g_set_error (error, GTK_BUILDER_ERROR,
+                     GTK_BUILDER_ERROR_DUPLICATE_ID,
+                     _("Duplicate object ID '%s' on line %d (previously on line %d)"),
+                     object_id, line, line2);
+      else
+        {
+          g_hash_table_insert (data->object_ids, g_strdup (object_id), GINT_TO_POINTER (line));
+
+          if (has_id)
+            _gtk_builder_add_lazy_object (data->builder, object_id,
+                                          data->lazy_object_id,
+                                          data->lazy_buffer,
+                                          data->filename);
+        }
+
+      g_free (object_class);
+      g_free (object_id);
+      g_free (constructor);
+      return;
+    }
+
   /* check if we reached a requested object (if it is specified) */
   if (data->requested_objects && !data->inside_requested_object)
     {
@@ -587,7 +645,7 @@ parse_property (ParserData   *data,
                 GError      **error)
 {
   PropertyInfo *info;
-  gchar *name = NULL;
+  const gchar *name = NULL;
   gchar *context = NULL;
   gboolean translatable = FALSE;
   ObjectInfo *object_info;
@@ -605,7 +663,19 @@ parse_property (ParserData   *data,
   for (i = 0; names[i] != NULL; i++)
     {
       if (strcmp (names[i], "name") == 0)
-        name = g_strdelimit (g_strdup (values[i]), "_", '-');
+        {
+          /* The same few property names are used over and over, so
+           * intern them instead of copying each of them */
+          if (strchr (values[i], '_'))
+            {
+              gchar *canonical = g_strdelimit (g_strdup (values[i]), "_", '-');
+
+              name = g_intern_string (canonical);
+              g_free (canonical);
+            }
+          else
+            name = g_intern_string (values[i]);
+        }
       else if (strcmp (names[i], "translatable") == 0)
 	{
 	  if (!_gtk_builder_boolean_from_string (values[i], &translatable,
@@ -647,7 +717,6 @@ static void
 free_property_info (PropertyInfo *info)
 {
   g_free (info->data);
-  g_free (info->name);
   g_slice_free (PropertyInfo, info);
 }
 
@@ -985,7 +1054,8 @@ start_element (GMarkupParseContext *context,
     parse_object (context, data, element_name, names, values, error);
   else if (strcmp (element_name, "template") == 0)
     parse_template (context, data, element_name, names, values, error);
-  else if (data->requested_objects && !data->inside_requested_object)
+  else if ((data->requested_objects && !data->inside_requested_object) ||
+           data->inside_lazy_object)
     {
       /* If outside a requested object, simply ignore this tag */
       return;
@@ -1071,6 +1141,16 @@ end_element (GMarkupParseContext *context,
   else if (strcmp (element_name, "interface") == 0)
     {
     }
+  else if (data->inside_lazy_object)
+    {
+      if (strcmp (element_name, "object") == 0 &&
+          data->cur_object_level-- == data->lazy_object_level)
+        {
+          data->inside_lazy_object = FALSE;
+          g_free (data->lazy_object_id);
+          data->lazy_object_id = NULL;
+        }
+    }
   else if (data->requested_objects && !data->inside_requested_object)
     {
       /* If outside a requested object, simply ignore this tag */
@@ -1256,6 +1336,8 @@ _gtk_builder_parser_parse_buffer (GtkBuilder   *builder,
   data = g_new0 (ParserData, 1);
   data->builder = builder;
   data->filename = filename;
+  data->buffer = buffer;
+  data->length = length;
   data->domain = g_strdup (domain);
   data->object_ids = g_hash_table_new_full (g_str_hash, g_str_equal,
 					    (GDestroyNotify)g_free, NULL);
@@ -1318,6 +1400,9 @@ _gtk_builder_parser_parse_buffer (GtkBuilder   *builder,
   g_slist_foreach (data->requested_objects, (GFunc) g_free, NULL);
   g_slist_free (data->requested_objects);
   g_free (data->domain);
+  g_free (data->lazy_object_id);
+  if (data->lazy_buffer)
+    g_bytes_unref (data->lazy_buffer);
   g_hash_table_destroy (data->object_ids);
   g_markup_parse_context_free (data->ctx);
   g_free (data);
@@ -59,7 +59,7 @@ typedef struct {
 
 typedef struct {
   TagInfo tag;
-  gchar *name;
+  const gchar *name; /* interned */
   GString *text;
   gchar *data;
   gboolean translatable;
@@ -107,6 +107,14 @@ typedef struct {
   gint requested_object_level;
   gint cur_object_level;
 
+  /* Set while skipping over the subtree of a lazy="true" object */
+  gboolean inside_lazy_object;
+  gint lazy_object_level;
+  gchar *lazy_object_id;
+  const gchar *buffer;
+  gsize length;
+  GBytes *lazy_buffer;
+
   gint object_counter;
 
   GHashTable *object_ids;
@@ -130,6 +138,11 @@ void      _gtk_builder_apply_properties (GtkBuilder *builder,
 void      _gtk_builder_add_object (GtkBuilder  *builder,
                                    const gchar *id,
                                    GObject     *object);
+void      _gtk_builder_add_lazy_object (GtkBuilder  *builder,
+                                        const gchar *id,
+                                        const gchar *toplevel_id,
+                                        GBytes      *buffer,
+                                        const gchar *filename);
 void      _gtk_builder_add (GtkBuilder *builder,
                             ChildInfo *child_info);
 void      _gtk_builder_add_signals (GtkBuilder *builder,
@@ -24,134 +24,405 @@
 #include "gtkcairoblurprivate.h"
 
 #include <math.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/* Surfaces with fewer pixels than this are always blurred on the
+ * calling thread, the overhead of waking up workers isn't worth it.
+ */
+#define PARALLEL_MIN_PIXELS (256 * 256)
+#define MAX_WORKERS 7
+
+/* Rows and columns are blurred in bands of this size, a band is the
+ * unit of work handed to a thread. Column bands also keep the column
+ * pass walking the image row by row instead of a whole column at a
+ * time, 16 ARGB pixels are exactly one cache line.
+ */
+#define ROW_BAND 8
+#define COLUMN_BAND 16
+
+/* Precision of the alpha parameter in fixed-point format 0.APREC and
+ * of the filter state in fixed-point format 8.ZPREC. These are
+ * constants so the shifts in the inner loops are too.
+ */
+#define APREC 16
+#define ZPREC 7
 
 /*
  * Notes:
  *   based on exponential-blur algorithm by Jani Huhtanen
+ *
+ *   The state of the filter for one pixel is kept in a BlurState, which
+ *   holds the four channels in a single vector register where the
+ *   platform has one. All arithmetic stays in 32bit integers so every
+ *   implementation produces exactly the same output.
  */
+#if defined(__SSE2__)
+
+typedef __m128i BlurState;
+
+static inline __m128i
+_loadpixel (const guchar *pixel)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  guint32 value;
+  __m128i v;
+
+  memcpy (&value, pixel, 4);
+  v = _mm_cvtsi32_si128 (value);
+  v = _mm_unpacklo_epi8 (v, zero);
+
+  return _mm_unpacklo_epi16 (v, zero);
+}
+
+/* SSE2 has no 32bit multiply, but the low half of an unsigned
+ * product is the same as the one of a signed product. */
+static inline __m128i
+_mullo (__m128i a,
+        __m128i b)
+{
+  __m128i even, odd;
+
+  even = _mm_mul_epu32 (a, b);
+  odd = _mm_mul_epu32 (_mm_srli_epi64 (a, 32), _mm_srli_epi64 (b, 32));
+
+  return _mm_unpacklo_epi32 (_mm_shuffle_epi32 (even, _MM_SHUFFLE (0, 0, 2, 0)),
+                             _mm_shuffle_epi32 (odd, _MM_SHUFFLE (0, 0, 2, 0)));
+}
+
+static inline void
+_blurinit (const guchar *pixel,
+           BlurState    *z,
+           gint          zprec)
+{
+  *z = _mm_sll_epi32 (_loadpixel (pixel), _mm_cvtsi32_si128 (zprec));
+}
+
+static inline void
+_blurinner (guchar    *pixel,
+            BlurState *z,
+            gint       alpha,
+            gint       aprec,
+            gint       zprec)
+{
+  __m128i diff, result;
+  guint32 value;
+
+  diff = _mm_sub_epi32 (_mm_sll_epi32 (_loadpixel (pixel), _mm_cvtsi32_si128 (zprec)), *z);
+  *z = _mm_add_epi32 (*z, _mm_sra_epi32 (_mullo (_mm_set1_epi32 (alpha), diff),
+                                         _mm_cvtsi32_si128 (aprec)));
+
+  result = _mm_sra_epi32 (*z, _mm_cvtsi32_si128 (zprec));
+  result = _mm_packs_epi32 (result, result);
+  result = _mm_packus_epi16 (result, result);
+  value = _mm_cvtsi128_si32 (result);
+  memcpy (pixel, &value, 4);
+}
+
+#elif defined(__ARM_NEON)
+
+typedef int32x4_t BlurState;
+
+static inline int32x4_t
+_loadpixel (const guchar *pixel)
+{
+  guint32 value;
+  uint16x8_t v;
+
+  memcpy (&value, pixel, 4);
+  v = vmovl_u8 (vreinterpret_u8_u32 (vdup_n_u32 (value)));
+
+  return vreinterpretq_s32_u32 (vmovl_u16 (vget_low_u16 (v)));
+}
+
+static inline void
+_blurinit (const guchar *pixel,
+           BlurState    *z,
+           gint          zprec)
+{
+  *z = vshlq_s32 (_loadpixel (pixel), vdupq_n_s32 (zprec));
+}
+
+static inline void
+_blurinner (guchar    *pixel,
+            BlurState *z,
+            gint       alpha,
+            gint       aprec,
+            gint       zprec)
+{
+  int32x4_t diff;
+  uint16x4_t result;
+  guint32 value;
+
+  diff = vsubq_s32 (vshlq_s32 (_loadpixel (pixel), vdupq_n_s32 (zprec)), *z);
+  *z = vaddq_s32 (*z, vshlq_s32 (vmulq_s32 (diff, vdupq_n_s32 (alpha)),
+                                 vdupq_n_s32 (-aprec)));
+
+  result = vqmovun_s32 (vshlq_s32 (*z, vdupq_n_s32 (-zprec)));
+  value = vget_lane_u32 (vreinterpret_u32_u8 (vqmovn_u16 (vcombine_u16 (result, result))), 0);
+  memcpy (pixel, &value, 4);
+}
+
+#else
+
+typedef struct {
+  gint R;
+  gint G;
+  gint B;
+  gint A;
+} BlurState;
+
+static inline void
+_blurinit (const guchar *pixel,
+           BlurState    *z,
+           gint          zprec)
+{
+  z->R = *pixel << zprec;
+  z->G = *(pixel + 1) << zprec;
+  z->B = *(pixel + 2) << zprec;
+  z->A = *(pixel + 3) << zprec;
+}
+
 static inline void
-_blurinner (guchar* pixel,
-            gint   *zR,
-            gint   *zG,
-            gint   *zB,
-            gint   *zA,
-            gint    alpha,
-            gint    aprec,
-            gint    zprec)
+_blurinner (guchar    *pixel,
+            BlurState *z,
+            gint       alpha,
+            gint       aprec,
+            gint       zprec)
 {
   gint R;
   gint G;
   gint B;
-  guchar A;
+  gint A;
 
   R = *pixel;
   G = *(pixel + 1);
   B = *(pixel + 2);
   A = *(pixel + 3);
 
-  *zR += (alpha * ((R << zprec) - *zR)) >> aprec;
-  *zG += (alpha * ((G << zprec) - *zG)) >> aprec;
-  *zB += (alpha * ((B << zprec) - *zB)) >> aprec;
-  *zA += (alpha * ((A << zprec) - *zA)) >> aprec;
+  R = z->R + ((alpha * ((R << zprec) - z->R)) >> aprec);
+  G = z->G + ((alpha * ((G << zprec) - z->G)) >> aprec);
+  B = z->B + ((alpha * ((B << zprec) - z->B)) >> aprec);
+  A = z->A + ((alpha * ((A << zprec) - z->A)) >> aprec);
 
-  *pixel       = *zR >> zprec;
-  *(pixel + 1) = *zG >> zprec;
-  *(pixel + 2) = *zB >> zprec;
-  *(pixel + 3) = *zA >> zprec;
-} 
+  z->R = R;
+  z->G = G;
+  z->B = B;
+  z->A = A;
 
+  *pixel       = R >> zprec;
+  *(pixel + 1) = G >> zprec;
+  *(pixel + 2) = B >> zprec;
+  *(pixel + 3) = A >> zprec;
+}
+
+#endif
+
+/* Blurs the rows y0 to y1 - 1, which must be at most ROW_BAND rows.
+ * The rows are independent, interleaving them keeps several filters
+ * in flight instead of waiting on a single one.
+ */
 static inline void
-_blurrow (guchar* pixels,
-          gint    width,
-          gint    height,
-          gint    rowstride,
-          gint    channels,
-          gint    line,
-          gint    alpha,
-          gint    aprec,
-          gint    zprec)
-{
-  gint    zR;
-  gint    zG;
-  gint    zB;
-  gint    zA;
-  gint    index;
-  guchar* scanline;
-
-  scanline = &pixels[line * rowstride];
-
-  zR = *scanline << zprec;
-  zG = *(scanline + 1) << zprec;
-  zB = *(scanline + 2) << zprec;
-  zA = *(scanline + 3) << zprec;
-
-  for (index = 0; index < width; index ++)
-    _blurinner (&scanline[index * channels],
-                &zR,
-                &zG,
-                &zB,
-                &zA,
-                alpha,
-                aprec,
-                zprec);
+_blurrows (guchar* pixels,
+           gint    width,
+           gint    rowstride,
+           gint    channels,
+           gint    y0,
+           gint    y1,
+           gint    alpha,
+           gint    aprec,
+           gint    zprec)
+{
+  BlurState z[ROW_BAND];
+  gint      index, y;
+  guchar*   ptr;
+
+  ptr = pixels + y0 * rowstride;
+
+  for (y = 0; y < y1 - y0; y++)
+    _blurinit (&ptr[y * rowstride], &z[y], zprec);
+
+  for (index = 0; index < width; index++)
+    for (y = 0; y < y1 - y0; y++)
+      _blurinner (&ptr[y * rowstride + index * channels],
+                  &z[y],
+                  alpha,
+                  aprec,
+                  zprec);
 
   for (index = width - 2; index >= 0; index--)
-    _blurinner (&scanline[index * channels],
-                &zR,
-                &zG,
-                &zB,
-                &zA,
-                alpha,
-                aprec,
-                zprec);
+    for (y = 0; y < y1 - y0; y++)
+      _blurinner (&ptr[y * rowstride + index * channels],
+                  &z[y],
+                  alpha,
+                  aprec,
+                  zprec);
 }
 
+/* Blurs the columns x0 to x1 - 1, which must be at most COLUMN_BAND
+ * columns. Each column is filtered independently, exactly like a
+ * column at a time would, but memory is read row by row.
+ */
 static inline void
-_blurcol (guchar* pixels,
-          gint    width,
-          gint    height,
-          gint    rowstride,
-          gint    channels,
-          gint    x,
-          gint    alpha,
-          gint    aprec,
-          gint    zprec)
-{
-  gint zR;
-  gint zG;
-  gint zB;
-  gint zA;
-  gint index;
-  guchar* ptr;
-
-  ptr = pixels;
-  
-  ptr += x * channels;
-
-  zR = *((guchar*) ptr    ) << zprec;
-  zG = *((guchar*) ptr + 1) << zprec;
-  zB = *((guchar*) ptr + 2) << zprec;
-  zA = *((guchar*) ptr + 3) << zprec;
+_blurcols (guchar* pixels,
+           gint    height,
+           gint    rowstride,
+           gint    channels,
+           gint    x0,
+           gint    x1,
+           gint    alpha,
+           gint    aprec,
+           gint    zprec)
+{
+  BlurState z[COLUMN_BAND];
+  gint      index, x;
+  guchar*   ptr;
+
+  ptr = pixels + x0 * channels;
+
+  for (x = 0; x < x1 - x0; x++)
+    _blurinit (&ptr[x * channels], &z[x], zprec);
 
   for (index = 0; index < height; index++)
-    _blurinner (&ptr[index * rowstride],
-                &zR,
-                &zG,
-                &zB,
-                &zA,
-                alpha,
-                aprec,
-                zprec);
+    for (x = 0; x < x1 - x0; x++)
+      _blurinner (&ptr[index * rowstride + x * channels],
+                  &z[x],
+                  alpha,
+                  aprec,
+                  zprec);
 
   for (index = height - 2; index >= 0; index--)
-    _blurinner (&ptr[index * rowstride],
-                &zR,
-                &zG,
-                &zB,
-                &zA,
-                alpha,
-                aprec,
-                zprec);
+    for (x = 0; x < x1 - x0; x++)
+      _blurinner (&ptr[index * rowstride + x * channels],
+                  &z[x],
+                  alpha,
+                  aprec,
+                  zprec);
+}
+
+typedef struct {
+  guchar  *pixels;
+  gint     width;
+  gint     height;
+  gint     rowstride;
+  gint     channels;
+  gint     alpha;
+  gboolean columns;
+
+  gint     n_bands;
+  gint     next_band;     /* atomic */
+
+  GMutex   lock;
+  GCond    cond;
+  gint     n_running;     /* workers still busy, protected by lock */
+} BlurPass;
+
+static void
+_blurpass_run (BlurPass *pass)
+{
+  gint band, i, end;
+
+  while ((band = g_atomic_int_add (&pass->next_band, 1)) < pass->n_bands)
+    {
+      if (pass->columns)
+        {
+          i = band * COLUMN_BAND;
+          end = MIN (i + COLUMN_BAND, pass->width);
+          _blurcols (pass->pixels,
+                     pass->height,
+                     pass->rowstride,
+                     pass->channels,
+                     i, end,
+                     pass->alpha,
+                     APREC,
+                     ZPREC);
+        }
+      else
+        {
+          i = band * ROW_BAND;
+          end = MIN (i + ROW_BAND, pass->height);
+          _blurrows (pass->pixels,
+                     pass->width,
+                     pass->rowstride,
+                     pass->channels,
+                     i, end,
+                     pass->alpha,
+                     APREC,
+                     ZPREC);
+        }
+    }
+}
+
+static void
+_blurpass_worker (gpointer data,
+                  gpointer user_data)
+{
+  BlurPass *pass = data;
+
+  _blurpass_run (pass);
+
+  g_mutex_lock (&pass->lock);
+  pass->n_running--;
+  if (pass->n_running == 0)
+    g_cond_signal (&pass->cond);
+  g_mutex_unlock (&pass->lock);
+}
+
+static GThreadPool *
+_blurpool_get (void)
+{
+  static GThreadPool *pool = NULL;
+  static gsize initialized = 0;
+
+  if (g_once_init_enter (&initialized))
+    {
+      gint n_workers = MIN ((gint) g_get_num_processors () - 1, MAX_WORKERS);
+
+      if (n_workers > 0)
+        pool = g_thread_pool_new (_blurpass_worker, NULL, n_workers, FALSE, NULL);
+
+      g_once_init_leave (&initialized, 1);
+    }
+
+  return pool;
+}
+
+/* Runs one pass over all bands, sharing the work between the calling
+ * thread and the worker pool. Returns when every band is done. */
+static void
+_blurpass (BlurPass *pass)
+{
+  GThreadPool *pool = NULL;
+  gint i, n_workers = 0;
+
+  pass->next_band = 0;
+  pass->n_running = 0;
+
+  if (pass->width * pass->height >= PARALLEL_MIN_PIXELS)
+    pool = _blurpool_get ();
+
+  if (pool)
+    {
+      n_workers = MIN ((gint) g_thread_pool_get_max_threads (pool), pass->n_bands - 1);
+      pass->n_running = n_workers;
+      for (i = 0; i < n_workers; i++)
+        g_thread_pool_push (pool, pass, NULL);
+    }
+
+  _blurpass_run (pass);
+
+  if (n_workers > 0)
+    {
+      g_mutex_lock (&pass->lock);
+      while (pass->n_running > 0)
+        g_cond_wait (&pass->cond, &pass->lock);
+      g_mutex_unlock (&pass->lock);
+    }
 }
 
 /*
@@ -162,14 +433,14 @@ _blurcol (guchar* pixels,
  * @rowstride: image rowstride
  * @channels: image channels
  * @radius: kernel radius
- * @aprec: precision of alpha parameter in fixed-point format 0.aprec
- * @zprec: precision of state parameters zR,zG,zB and zA in fp format 8.zprec
  *
  * Performs an in-place blur of image data 'pixels'
  * with kernel of approximate radius 'radius'.
  *
  * Blurs with two sided exponential impulse response.
  *
+ * Large images are split into bands of rows and columns that
+ * are blurred in parallel.
  */
 static void
 _expblur (guchar* pixels,
@@ -177,39 +448,36 @@ _expblur (guchar* pixels,
           gint    height,
           gint    rowstride,
           gint    channels,
-          double  radius,
-          gint    aprec,
-          gint    zprec)
+          double  radius)
 {
-  gint alpha;
-  int row, col;
+  BlurPass pass;
+
+  if (width <= 0 || height <= 0)
+    return;
+
+  pass.pixels = pixels;
+  pass.width = width;
+  pass.height = height;
+  pass.rowstride = rowstride;
+  pass.channels = channels;
+  g_mutex_init (&pass.lock);
+  g_cond_init (&pass.cond);
 
   /* Calculate the alpha such that 90% of 
    * the kernel is within the radius.
    * (Kernel extends to infinity) */
-  alpha = (gint) ((1 << aprec) * (1.0f - expf (-2.3f / (radius + 1.f))));
-
-  for (row = 0; row < height; row++)
-    _blurrow (pixels,
-              width,
-              height,
-              rowstride,
-              channels,
-              row,
-              alpha,
-              aprec,
-              zprec);
-
-  for(col = 0; col < width; col++)
-    _blurcol (pixels,
-              width,
-              height,
-              rowstride,
-              channels,
-              col,
-              alpha,
-              aprec,
-              zprec);
+  pass.alpha = (gint) ((1 << APREC) * (1.0f - expf (-2.3f / (radius + 1.f))));
+
+  pass.columns = FALSE;
+  pass.n_bands = (height + ROW_BAND - 1) / ROW_BAND;
+  _blurpass (&pass);
+
+  pass.columns = TRUE;
+  pass.n_bands = (width + COLUMN_BAND - 1) / COLUMN_BAND;
+  _blurpass (&pass);
+
+  g_mutex_clear (&pass.lock);
+  g_cond_clear (&pass.cond);
 }
 
 
@@ -244,9 +512,7 @@ _gtk_cairo_blur_surface (cairo_surface_t* surface,
             cairo_image_surface_get_height (surface),
             cairo_image_surface_get_stride (surface),
             4,
-            radius,
-            16,
-            7);
+            radius);
 
   /* Inform cairo we altered the surfaces contents. */
   cairo_surface_mark_dirty (surface);
@@ -287,6 +287,12 @@ struct _GtkCalendarPrivate
   guint max_label_char_descent;
   guint max_week_char_width;
 
+  /* Layouts for the day numbers and the day names, these only depend
+   * on the font, so they are kept until the style changes
+   */
+  PangoLayout *day_layouts[31];
+  PangoLayout *day_name_layouts[7];
+
   /* flags */
   guint year_before : 1;
 
@@ -361,6 +367,9 @@ static void     gtk_calendar_grab_notify    (GtkWidget        *widget,
                                              gboolean          was_grabbed);
 static void     gtk_calendar_state_flags_changed  (GtkWidget     *widget,
                                                    GtkStateFlags  previous_state);
+static void     gtk_calendar_style_updated  (GtkWidget        *widget);
+static void     gtk_calendar_direction_changed (GtkWidget        *widget,
+                                                GtkTextDirection  previous_direction);
 static gboolean gtk_calendar_query_tooltip  (GtkWidget        *widget,
                                              gint              x,
                                              gint              y,
@@ -407,6 +416,7 @@ static void calendar_invalidate_arrow   (GtkCalendar *widget,
                                          guint      arrow);
 
 static void calendar_compute_days      (GtkCalendar *calendar);
+static void calendar_clear_layouts     (GtkCalendar *calendar);
 static gint calendar_get_xsep          (GtkCalendar *calendar);
 static gint calendar_get_ysep          (GtkCalendar *calendar);
 static gint calendar_get_inner_border  (GtkCalendar *calendar);
@@ -446,6 +456,8 @@ gtk_calendar_class_init (GtkCalendarClass *class)
   widget_class->key_press_event = gtk_calendar_key_press;
   widget_class->scroll_event = gtk_calendar_scroll;
   widget_class->state_flags_changed = gtk_calendar_state_flags_changed;
+  widget_class->style_updated = gtk_calendar_style_updated;
+  widget_class->direction_changed = gtk_calendar_direction_changed;
   widget_class->grab_notify = gtk_calendar_grab_notify;
   widget_class->focus_out_event = gtk_calendar_focus_out;
   widget_class->query_tooltip = gtk_calendar_query_tooltip;
@@ -1393,6 +1405,8 @@ calendar_set_month_prev (GtkCalendar *calendar)
 static void
 gtk_calendar_finalize (GObject *object)
 {
+  calendar_clear_layouts (GTK_CALENDAR (object));
+
   G_OBJECT_CLASS (gtk_calendar_parent_class)->finalize (object);
 }
 
@@ -2327,7 +2341,6 @@ calendar_paint_day_names (GtkCalendar *calendar,
   GtkStateFlags state;
   GtkBorder padding;
   GtkAllocation allocation;
-  char buffer[255];
   int day,i;
   int day_width, cal_width;
   int day_wid_sep;
@@ -2382,8 +2395,6 @@ calendar_paint_day_names (GtkCalendar *calendar,
   /*
    * Write the labels
    */
-  layout = gtk_widget_create_pango_layout (widget, NULL);
-
   for (i = 0; i < 7; i++)
     {
       if (gtk_widget_get_direction (GTK_WIDGET (calendar)) == GTK_TEXT_DIR_RTL)
@@ -2391,9 +2402,12 @@ calendar_paint_day_names (GtkCalendar *calendar,
       else
         day = i;
       day = (day + priv->week_start) % 7;
-      g_snprintf (buffer, sizeof (buffer), "%s", default_abbreviated_dayname[day]);
 
-      pango_layout_set_text (layout, buffer, -1);
+      if (priv->day_name_layouts[day] == NULL)
+        priv->day_name_layouts[day] = gtk_widget_create_pango_layout (widget,
+                                                                      default_abbreviated_dayname[day]);
+
+      layout = priv->day_name_layouts[day];
       pango_layout_get_pixel_extents (layout, NULL, &logical_rect);
 
       gtk_render_layout (context, cr,
@@ -2407,8 +2421,6 @@ calendar_paint_day_names (GtkCalendar *calendar,
                          layout);
     }
 
-  g_object_unref (layout);
-
   gtk_style_context_restore (context);
   cairo_restore (cr);
 }
@@ -2563,6 +2575,50 @@ is_color_attribute (PangoAttribute *attribute,
           attribute->klass->type == PANGO_ATTR_BACKGROUND);
 }
 
+static PangoLayout *
+calendar_get_day_layout (GtkCalendar *calendar,
+                         gint         day)
+{
+  GtkCalendarPrivate *priv = GTK_CALENDAR_GET_PRIVATE (calendar);
+
+  if (priv->day_layouts[day - 1] == NULL)
+    {
+      gchar buffer[32];
+      PangoLayout *layout;
+
+      /* Translators: this defines whether the day numbers should use
+       * localized digits or the ones used in English (0123...).
+       *
+       * Translate to "%Id" if you want to use localized digits, or
+       * translate to "%d" otherwise.
+       *
+       * Note that translating this doesn't guarantee that you get localized
+       * digits. That needs support from your system and locale definition
+       * too.
+       */
+      g_snprintf (buffer, sizeof (buffer), C_("calendar:day:digits", "%d"), day);
+
+      layout = gtk_widget_create_pango_layout (GTK_WIDGET (calendar), buffer);
+      pango_layout_set_alignment (layout, PANGO_ALIGN_CENTER);
+      priv->day_layouts[day - 1] = layout;
+    }
+
+  return priv->day_layouts[day - 1];
+}
+
+static void
+calendar_clear_layouts (GtkCalendar *calendar)
+{
+  GtkCalendarPrivate *priv = GTK_CALENDAR_GET_PRIVATE (calendar);
+  gint i;
+
+  for (i = 0; i < 31; i++)
+    g_clear_object (&priv->day_layouts[i]);
+
+  for (i = 0; i < 7; i++)
+    g_clear_object (&priv->day_name_layouts[i]);
+}
+
 static void
 calendar_paint_day (GtkCalendar *calendar,
                     cairo_t     *cr,
@@ -2574,7 +2630,6 @@ calendar_paint_day (GtkCalendar *calendar,
   GtkStyleContext *context;
   GtkStateFlags state = 0;
   gchar *detail;
-  gchar buffer[32];
   gint day;
   gint x_loc, y_loc;
   GdkRectangle day_rect;
@@ -2620,24 +2675,11 @@ calendar_paint_day (GtkCalendar *calendar,
 
   gtk_style_context_set_state (context, state);
 
-  /* Translators: this defines whether the day numbers should use
-   * localized digits or the ones used in English (0123...).
-   *
-   * Translate to "%Id" if you want to use localized digits, or
-   * translate to "%d" otherwise.
-   *
-   * Note that translating this doesn't guarantee that you get localized
-   * digits. That needs support from your system and locale definition
-   * too.
-   */
-  g_snprintf (buffer, sizeof (buffer), C_("calendar:day:digits", "%d"), day);
-
   /* Get extra information to show, if any: */
 
   detail = gtk_calendar_get_detail (calendar, row, col);
 
-  layout = gtk_widget_create_pango_layout (widget, buffer);
-  pango_layout_set_alignment (layout, PANGO_ALIGN_CENTER);
+  layout = calendar_get_day_layout (calendar, day);
   pango_layout_get_pixel_extents (layout, NULL, &logical_rect);
 
   x_loc = day_rect.x + (day_rect.width - logical_rect.width) / 2;
@@ -2673,6 +2715,8 @@ calendar_paint_day (GtkCalendar *calendar,
   if (detail && show_details)
     {
       gchar *markup = g_strconcat ("<small>", detail, "</small>", NULL);
+      layout = gtk_widget_create_pango_layout (widget, NULL);
+      pango_layout_set_alignment (layout, PANGO_ALIGN_CENTER);
       pango_layout_set_markup (layout, markup, -1);
       g_free (markup);
 
@@ -2701,6 +2745,7 @@ calendar_paint_day (GtkCalendar *calendar,
 
       cairo_move_to (cr, day_rect.x, y_loc);
       pango_cairo_show_layout (cr, layout);
+      g_object_unref (layout);
     }
 
   if (gtk_widget_has_visible_focus (widget) &&
@@ -2715,7 +2760,6 @@ calendar_paint_day (GtkCalendar *calendar,
     priv->detail_overflow[row] &= ~(1 << col);
 
   gtk_style_context_restore (context);
-  g_object_unref (layout);
   g_free (detail);
 }
 
@@ -2723,13 +2767,24 @@ static void
 calendar_paint_main (GtkCalendar *calendar,
                      cairo_t     *cr)
 {
+  GdkRectangle clip, day_rect;
   gint row, col;
 
+  if (!gdk_cairo_get_clip_rectangle (cr, &clip))
+    return;
+
   cairo_save (cr);
 
+  /* Selection and focus changes only invalidate single days, so
+   * skip the ones that are not going to be visible
+   */
   for (col = 0; col < 7; col++)
     for (row = 0; row < 6; row++)
-      calendar_paint_day (calendar, cr, row, col);
+      {
+        calendar_day_rectangle (calendar, row, col, &day_rect);
+        if (gdk_rectangle_intersect (&clip, &day_rect, NULL))
+          calendar_paint_day (calendar, cr, row, col);
+      }
 
   cairo_restore (cr);
 }
@@ -3342,6 +3397,23 @@ gtk_calendar_state_flags_changed (GtkWidget     *widget,
     }
 }
 
+static void
+gtk_calendar_style_updated (GtkWidget *widget)
+{
+  GTK_WIDGET_CLASS (gtk_calendar_parent_class)->style_updated (widget);
+
+  calendar_clear_layouts (GTK_CALENDAR (widget));
+}
+
+static void
+gtk_calendar_direction_changed (GtkWidget        *widget,
+                                GtkTextDirection  previous_direction)
+{
+  calendar_clear_layouts (GTK_CALENDAR (widget));
+
+  GTK_WIDGET_CLASS (gtk_calendar_parent_class)->direction_changed (widget, previous_direction);
+}
+
 static void
 gtk_calendar_grab_notify (GtkWidget *widget,
                           gboolean   was_grabbed)
@@ -516,6 +516,15 @@ typedef struct {
   GdkRectangle     cell_area;
 } CellByPositionData;
 
+/* Cached size request of a renderer */
+typedef struct {
+  gint minimum_size;
+  gint natural_size;
+} CachedRequest;
+
+/* Limits the memory used for models where few rows look alike */
+#define MAX_CACHED_REQUESTS 4096
+
 /* Attribute/Cell metadata */
 typedef struct {
   const gchar *attribute;
@@ -591,6 +600,12 @@ struct _GtkCellAreaPrivate
 
   /* Tracking which cells are focus siblings of focusable cells */
   GHashTable      *focus_siblings;
+
+  /* Cached renderer requests by request key, only
+   * if enabled with _gtk_cell_area_set_cache_requests()
+   */
+  GHashTable      *request_cache;
+  GString         *request_key;
 };
 
 enum {
@@ -936,6 +951,8 @@ gtk_cell_area_finalize (GObject *object)
   g_hash_table_destroy (priv->cell_info);
   g_hash_table_destroy (priv->focus_siblings);
 
+  _gtk_cell_area_set_cache_requests (area, FALSE);
+
   g_free (priv->current_path);
 
   G_OBJECT_CLASS (gtk_cell_area_parent_class)->finalize (object);
@@ -1699,6 +1716,9 @@ gtk_cell_area_remove (GtkCellArea        *area,
 
   g_list_free (renderers);
 
+  /* A new renderer may end up at the same address */
+  _gtk_cell_area_reset_request_cache (area);
+
   GTK_CELL_AREA_GET_CLASS (area)->remove (area, renderer);
 }
 
@@ -3556,6 +3576,32 @@ gtk_cell_area_inner_cell_area (GtkCellArea        *area,
   inner_area->height -= focus_line_width * 2;
 }
 
+static void
+request_renderer_uncached (GtkCellRenderer *renderer,
+                           GtkOrientation   orientation,
+                           GtkWidget       *widget,
+                           gint             for_size,
+                           gint            *minimum_size,
+                           gint            *natural_size)
+{
+  if (orientation == GTK_ORIENTATION_HORIZONTAL)
+    {
+      if (for_size < 0)
+        gtk_cell_renderer_get_preferred_width (renderer, widget, minimum_size, natural_size);
+      else
+        gtk_cell_renderer_get_preferred_width_for_height (renderer, widget, for_size,
+                                                          minimum_size, natural_size);
+    }
+  else /* GTK_ORIENTATION_VERTICAL */
+    {
+      if (for_size < 0)
+        gtk_cell_renderer_get_preferred_height (renderer, widget, minimum_size, natural_size);
+      else
+        gtk_cell_renderer_get_preferred_height_for_width (renderer, widget, for_size,
+                                                          minimum_size, natural_size);
+    }
+}
+
 /**
  * gtk_cell_area_request_renderer:
  * @area: a #GtkCellArea
@@ -3584,6 +3630,8 @@ gtk_cell_area_request_renderer (GtkCellArea        *area,
                                 gint               *minimum_size,
                                 gint               *natural_size)
 {
+  GtkCellAreaPrivate *priv;
+  CachedRequest *cached;
   gint focus_line_width;
 
   g_return_if_fail (GTK_IS_CELL_AREA (area));
@@ -3592,32 +3640,47 @@ gtk_cell_area_request_renderer (GtkCellArea        *area,
   g_return_if_fail (minimum_size != NULL);
   g_return_if_fail (natural_size != NULL);
 
+  priv = area->priv;
+
   gtk_widget_style_get (widget, "focus-line-width", &focus_line_width, NULL);
 
   focus_line_width *= 2;
 
-  if (orientation == GTK_ORIENTATION_HORIZONTAL)
+  if (for_size >= 0)
+    for_size = MAX (0, for_size - focus_line_width);
+
+  cached = NULL;
+  if (priv->request_cache)
     {
-      if (for_size < 0)
-          gtk_cell_renderer_get_preferred_width (renderer, widget, minimum_size, natural_size);
+      g_string_printf (priv->request_key, "%p %p %d %d ",
+                       renderer, widget, orientation, for_size);
+
+      if (_gtk_cell_renderer_get_request_key (renderer, widget, priv->request_key))
+        cached = g_hash_table_lookup (priv->request_cache, priv->request_key->str);
       else
-        {
-          for_size = MAX (0, for_size - focus_line_width);
+        g_string_truncate (priv->request_key, 0);
+    }
 
-          gtk_cell_renderer_get_preferred_width_for_height (renderer, widget, for_size,
-                                                            minimum_size, natural_size);
-        }
+  if (cached)
+    {
+      *minimum_size = cached->minimum_size;
+      *natural_size = cached->natural_size;
     }
-  else /* GTK_ORIENTATION_VERTICAL */
+  else
     {
-      if (for_size < 0)
-        gtk_cell_renderer_get_preferred_height (renderer, widget, minimum_size, natural_size);
-      else
-        {
-          for_size = MAX (0, for_size - focus_line_width);
+      request_renderer_uncached (renderer, orientation, widget, for_size,
+                                 minimum_size, natural_size);
 
-          gtk_cell_renderer_get_preferred_height_for_width (renderer, widget, for_size,
-                                                            minimum_size, natural_size);
+      if (priv->request_cache && priv->request_key->len > 0)
+        {
+          if (g_hash_table_size (priv->request_cache) >= MAX_CACHED_REQUESTS)
+            g_hash_table_remove_all (priv->request_cache);
+
+          cached = g_slice_new (CachedRequest);
+          cached->minimum_size = *minimum_size;
+          cached->natural_size = *natural_size;
+          g_hash_table_insert (priv->request_cache,
+                               g_strdup (priv->request_key->str), cached);
         }
     }
 
@@ -3625,6 +3688,63 @@ gtk_cell_area_request_renderer (GtkCellArea        *area,
   *natural_size += focus_line_width;
 }
 
+static void
+cached_request_free (CachedRequest *cached)
+{
+  g_slice_free (CachedRequest, cached);
+}
+
+/*
+ * _gtk_cell_area_set_cache_requests:
+ * @area: a #GtkCellArea
+ * @cache_requests: whether to cache renderer requests
+ *
+ * Makes gtk_cell_area_request_renderer() remember the sizes of
+ * renderers that can describe their cell data with a request key,
+ * so rows that look alike are only measured once.
+ *
+ * The cache doesn't know about anything but the renderers, so
+ * whoever enables it must call _gtk_cell_area_reset_request_cache()
+ * when the style of the widget changes.
+ */
+void
+_gtk_cell_area_set_cache_requests (GtkCellArea *area,
+                                   gboolean     cache_requests)
+{
+  GtkCellAreaPrivate *priv;
+
+  g_return_if_fail (GTK_IS_CELL_AREA (area));
+
+  priv = area->priv;
+
+  if (cache_requests == (priv->request_cache != NULL))
+    return;
+
+  if (cache_requests)
+    {
+      priv->request_cache = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                   g_free,
+                                                   (GDestroyNotify)cached_request_free);
+      priv->request_key = g_string_new (NULL);
+    }
+  else
+    {
+      g_hash_table_destroy (priv->request_cache);
+      priv->request_cache = NULL;
+      g_string_free (priv->request_key, TRUE);
+      priv->request_key = NULL;
+    }
+}
+
+void
+_gtk_cell_area_reset_request_cache (GtkCellArea *area)
+{
+  g_return_if_fail (GTK_IS_CELL_AREA (area));
+
+  if (area->priv->request_cache)
+    g_hash_table_remove_all (area->priv->request_cache);
+}
+
 void
 _gtk_cell_area_set_cell_data_func_with_proxy (GtkCellArea           *area,
 					      GtkCellRenderer       *cell,
@@ -479,6 +479,10 @@ void                 _gtk_cell_area_set_cell_data_func_with_proxy  (GtkCellArea
 								    GDestroyNotify         destroy,
 								    gpointer               proxy);
 
+void                 _gtk_cell_area_set_cache_requests             (GtkCellArea           *area,
+                                                                    gboolean               cache_requests);
+void                 _gtk_cell_area_reset_request_cache            (GtkCellArea           *area);
+
 G_END_DECLS
 
 #endif /* __GTK_CELL_AREA_H__ */
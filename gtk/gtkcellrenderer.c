@@ -132,6 +132,11 @@ struct _GtkCellRendererPrivate
 struct _GtkCellRendererClassPrivate
 {
   GType accessible_type;
+
+  GType request_key_type;
+  gboolean (* get_request_key) (GtkCellRenderer *cell,
+                                GtkWidget       *widget,
+                                GString         *key);
 };
 
 enum {
@@ -1809,3 +1814,69 @@ _gtk_cell_renderer_get_accessible_type (GtkCellRenderer *renderer)
   return GTK_CELL_RENDERER_GET_CLASS (renderer)->priv->accessible_type;
 }
 
+/*
+ * _gtk_cell_renderer_class_set_request_key_func:
+ * @renderer_class: class to set the function for
+ * @func: function appending everything that the size requests of
+ *   the renderer depend on to a string
+ *
+ * Lets #GtkCellArea cache the size requests of renderers of this
+ * class, see _gtk_cell_area_set_cache_requests(). Two renderers
+ * producing the same key must request the same sizes. @func may
+ * return %FALSE if the current cell data can't be described by a key.
+ *
+ * The function is not inherited by subclasses, since they may
+ * override the size request vfuncs.
+ */
+void
+_gtk_cell_renderer_class_set_request_key_func (GtkCellRendererClass *renderer_class,
+                                               gboolean            (* func) (GtkCellRenderer *cell,
+                                                                             GtkWidget       *widget,
+                                                                             GString         *key))
+{
+  GtkCellRendererClassPrivate *priv;
+
+  g_return_if_fail (GTK_IS_CELL_RENDERER_CLASS (renderer_class));
+
+  priv = renderer_class->priv;
+
+  priv->request_key_type = G_TYPE_FROM_CLASS (renderer_class);
+  priv->get_request_key = func;
+}
+
+/*
+ * _gtk_cell_renderer_get_request_key:
+ * @cell: a #GtkCellRenderer
+ * @widget: the widget @cell is measured for
+ * @key: string to append the key to
+ *
+ * Appends a key describing the size requests of @cell with its
+ * current cell data to @key.
+ *
+ * Returns: %FALSE if the requests of @cell can't be cached, @key
+ *   is then left in an undefined state
+ */
+gboolean
+_gtk_cell_renderer_get_request_key (GtkCellRenderer *cell,
+                                    GtkWidget       *widget,
+                                    GString         *key)
+{
+  GtkCellRendererClassPrivate *class_priv;
+  GtkCellRendererPrivate *priv;
+
+  class_priv = GTK_CELL_RENDERER_GET_CLASS (cell)->priv;
+
+  if (class_priv->get_request_key == NULL ||
+      class_priv->request_key_type != G_OBJECT_TYPE (cell))
+    return FALSE;
+
+  priv = cell->priv;
+
+  g_string_append_printf (key, "%d %d %d %d %d:",
+                          priv->width, priv->height,
+                          priv->xpad, priv->ypad,
+                          gtk_widget_get_scale_factor (widget));
+
+  return class_priv->get_request_key (cell, widget, key);
+}
+
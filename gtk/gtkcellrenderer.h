@@ -299,6 +299,16 @@ void            gtk_cell_renderer_class_set_accessible_type
 GType           _gtk_cell_renderer_get_accessible_type
                                                   (GtkCellRenderer *     renderer);
 
+void            _gtk_cell_renderer_class_set_request_key_func
+                                                  (GtkCellRendererClass *renderer_class,
+                                                   gboolean            (* func) (GtkCellRenderer *cell,
+                                                                                 GtkWidget       *widget,
+                                                                                 GString         *key));
+gboolean        _gtk_cell_renderer_get_request_key
+                                                  (GtkCellRenderer      *cell,
+                                                   GtkWidget            *widget,
+                                                   GString              *key);
+
 G_END_DECLS
 
 #endif /* __GTK_CELL_RENDERER_H__ */
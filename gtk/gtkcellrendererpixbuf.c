@@ -70,6 +70,9 @@ static void gtk_cell_renderer_pixbuf_render     (GtkCellRenderer            *cel
 						 const GdkRectangle         *background_area,
 						 const GdkRectangle         *cell_area,
 						 GtkCellRendererState        flags);
+static gboolean gtk_cell_renderer_pixbuf_get_request_key (GtkCellRenderer    *cell,
+                                                          GtkWidget          *widget,
+                                                          GString            *key);
 
 
 enum {
@@ -149,6 +152,8 @@ gtk_cell_renderer_pixbuf_class_init (GtkCellRendererPixbufClass *class)
   cell_class->get_size = gtk_cell_renderer_pixbuf_get_size;
   cell_class->render = gtk_cell_renderer_pixbuf_render;
 
+  _gtk_cell_renderer_class_set_request_key_func (cell_class, gtk_cell_renderer_pixbuf_get_request_key);
+
   g_object_class_install_property (object_class,
 				   PROP_PIXBUF,
 				   g_param_spec_object ("pixbuf",
@@ -420,6 +425,63 @@ gtk_cell_renderer_pixbuf_new (void)
   return g_object_new (GTK_TYPE_CELL_RENDERER_PIXBUF, NULL);
 }
 
+/* Sizing icons may mean loading them, so the key describes
+ * where the icon comes from instead of the icon itself.
+ */
+static gboolean
+gtk_cell_renderer_pixbuf_get_request_key (GtkCellRenderer *cell,
+                                          GtkWidget       *widget,
+                                          GString         *key)
+{
+  GtkCellRendererPixbuf *cellpixbuf = (GtkCellRendererPixbuf *) cell;
+  GtkCellRendererPixbufPrivate *priv = cellpixbuf->priv;
+  GtkIconHelper *helper = priv->icon_helper;
+  GdkPixbuf *pixbuf;
+
+  g_string_append_printf (key, "%d %d %d %d %d ",
+                          _gtk_icon_helper_get_storage_type (helper),
+                          _gtk_icon_helper_get_icon_size (helper),
+                          _gtk_icon_helper_get_pixel_size (helper),
+                          _gtk_icon_helper_get_use_fallback (helper),
+                          _gtk_icon_helper_get_force_scale_pixbuf (helper));
+
+  switch (_gtk_icon_helper_get_storage_type (helper))
+    {
+    case GTK_IMAGE_EMPTY:
+      break;
+
+    case GTK_IMAGE_PIXBUF:
+      pixbuf = _gtk_icon_helper_peek_pixbuf (helper);
+      g_string_append_printf (key, "%dx%d@%d ",
+                              gdk_pixbuf_get_width (pixbuf),
+                              gdk_pixbuf_get_height (pixbuf),
+                              _gtk_icon_helper_get_pixbuf_scale (helper));
+      break;
+
+    case GTK_IMAGE_ICON_NAME:
+      g_string_append (key, _gtk_icon_helper_get_icon_name (helper));
+      break;
+
+    case GTK_IMAGE_STOCK:
+      g_string_append (key, _gtk_icon_helper_get_stock_id (helper));
+      break;
+
+    default:
+      return FALSE;
+    }
+
+  if (priv->pixbuf_expander_open)
+    g_string_append_printf (key, " %dx%d",
+                            gdk_pixbuf_get_width (priv->pixbuf_expander_open),
+                            gdk_pixbuf_get_height (priv->pixbuf_expander_open));
+  if (priv->pixbuf_expander_closed)
+    g_string_append_printf (key, " %dx%d",
+                            gdk_pixbuf_get_width (priv->pixbuf_expander_closed),
+                            gdk_pixbuf_get_height (priv->pixbuf_expander_closed));
+
+  return TRUE;
+}
+
 static void
 gtk_cell_renderer_pixbuf_get_size (GtkCellRenderer    *cell,
 				   GtkWidget          *widget,
@@ -22,6 +22,7 @@
 #include "gtkcellrenderertext.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "gtkeditable.h"
 #include "gtkentry.h"
@@ -90,6 +91,9 @@ static void       gtk_cell_renderer_text_get_aligned_area               (GtkCell
 									 GtkCellRendererState   flags,
 									 const GdkRectangle    *cell_area,
 									 GdkRectangle          *aligned_area);
+static gboolean   gtk_cell_renderer_text_get_request_key                (GtkCellRenderer       *cell,
+                                                                         GtkWidget             *widget,
+                                                                         GString               *key);
 
 
 
@@ -159,6 +163,16 @@ static guint text_cell_renderer_signals [LAST_SIGNAL];
 
 #define GTK_CELL_RENDERER_TEXT_PATH "gtk-cell-renderer-text-path"
 
+/* The number of shaped layouts kept around per renderer */
+#define N_CACHED_LAYOUTS 16
+
+typedef struct
+{
+  gchar       *key;
+  PangoLayout *layout;
+  gint         width;
+} CachedLayout;
+
 struct _GtkCellRendererTextPrivate
 {
   GtkWidget *entry;
@@ -204,6 +218,8 @@ struct _GtkCellRendererTextPrivate
   gulong focus_out_id;
   gulong populate_popup_id;
   gulong entry_menu_popdown_timeout;
+
+  GQueue layout_cache;
 };
 
 G_DEFINE_TYPE (GtkCellRendererText, gtk_cell_renderer_text, GTK_TYPE_CELL_RENDERER)
@@ -231,6 +247,7 @@ gtk_cell_renderer_text_init (GtkCellRendererText *celltext)
   priv->wrap_mode = PANGO_WRAP_CHAR;
   priv->align = PANGO_ALIGN_LEFT;
   priv->align_set = FALSE;
+  g_queue_init (&priv->layout_cache);
 }
 
 static void
@@ -251,6 +268,8 @@ gtk_cell_renderer_text_class_init (GtkCellRendererTextClass *class)
   cell_class->get_preferred_height_for_width = gtk_cell_renderer_text_get_preferred_height_for_width;
   cell_class->get_aligned_area = gtk_cell_renderer_text_get_aligned_area;
 
+  _gtk_cell_renderer_class_set_request_key_func (cell_class, gtk_cell_renderer_text_get_request_key);
+
   g_object_class_install_property (object_class,
                                    PROP_TEXT,
                                    g_param_spec_string ("text",
@@ -722,12 +741,23 @@ gtk_cell_renderer_text_class_init (GtkCellRendererTextClass *class)
   gtk_cell_renderer_class_set_accessible_type (cell_class, GTK_TYPE_TEXT_CELL_ACCESSIBLE);
 }
 
+static void
+cached_layout_free (CachedLayout *cached)
+{
+  g_free (cached->key);
+  g_object_unref (cached->layout);
+  g_slice_free (CachedLayout, cached);
+}
+
 static void
 gtk_cell_renderer_text_finalize (GObject *object)
 {
   GtkCellRendererText *celltext = GTK_CELL_RENDERER_TEXT (object);
   GtkCellRendererTextPrivate *priv = celltext->priv;
 
+  g_queue_foreach (&priv->layout_cache, (GFunc) cached_layout_free, NULL);
+  g_queue_clear (&priv->layout_cache);
+
   pango_font_description_free (priv->font);
 
   g_free (priv->text);
@@ -1562,6 +1592,55 @@ show_placeholder_text (GtkCellRendererText *celltext)
     (!priv->text || !priv->text[0]);
 }
 
+/* Everything in here must match what get_layout() uses when
+ * called without a cell area, plus the sizing properties used
+ * by the size request vfuncs.
+ */
+static gboolean
+gtk_cell_renderer_text_get_request_key (GtkCellRenderer *cell,
+                                        GtkWidget       *widget,
+                                        GString         *key)
+{
+  GtkCellRendererText *celltext = GTK_CELL_RENDERER_TEXT (cell);
+  GtkCellRendererTextPrivate *priv = celltext->priv;
+  gchar *font;
+
+  /* Markup can change the size in too many ways */
+  if (priv->extra_attrs)
+    return FALSE;
+
+  font = pango_font_description_to_string (priv->font);
+
+  g_string_append_printf (key, "%s %g %p %d %d %d %d %d %d %d %d %d ",
+                          font,
+                          priv->scale_set ? priv->font_scale : 1.0,
+                          priv->language_set ? (gpointer) priv->language : NULL,
+                          priv->underline_set ? priv->underline_style : PANGO_UNDERLINE_NONE,
+                          priv->rise_set ? priv->rise : 0,
+                          priv->ellipsize_set ? priv->ellipsize : PANGO_ELLIPSIZE_NONE,
+                          priv->wrap_width,
+                          priv->wrap_mode,
+                          priv->width_chars,
+                          priv->max_width_chars,
+                          priv->single_paragraph,
+                          gtk_widget_get_direction (widget));
+  g_free (font);
+
+  if (show_placeholder_text (celltext))
+    {
+      g_string_append_c (key, 'P');
+      g_string_append (key, priv->placeholder_text);
+    }
+  else
+    {
+      g_string_append_c (key, 'T');
+      if (priv->text)
+        g_string_append (key, priv->text);
+    }
+
+  return TRUE;
+}
+
 static void
 add_attr (PangoAttrList  *attr_list,
           PangoAttribute *attr)
@@ -1573,10 +1652,10 @@ add_attr (PangoAttrList  *attr_list,
 }
 
 static PangoLayout*
-get_layout (GtkCellRendererText *celltext,
-            GtkWidget           *widget,
-            const GdkRectangle  *cell_area,
-            GtkCellRendererState flags)
+create_layout (GtkCellRendererText *celltext,
+               GtkWidget           *widget,
+               const GdkRectangle  *cell_area,
+               GtkCellRendererState flags)
 {
   GtkCellRendererTextPrivate *priv = celltext->priv;
   PangoAttrList *attr_list;
@@ -1727,6 +1806,125 @@ get_layout (GtkCellRendererText *celltext,
   return layout;
 }
 
+/* Everything create_layout() looks at must be part of the key.
+ * The layout keeps a reference on its context, so the context
+ * pointer can't be reused by another widget while it is cached.
+ */
+static gboolean
+get_layout_key (GtkCellRendererText *celltext,
+                GtkWidget           *widget,
+                const GdkRectangle  *cell_area,
+                GtkCellRendererState flags,
+                GString             *key)
+{
+  GtkCellRendererTextPrivate *priv = celltext->priv;
+  PangoContext *context;
+  gint xpad;
+
+  if (cell_area)
+    {
+      /* The placeholder color comes from the theme */
+      if (show_placeholder_text (celltext))
+        return FALSE;
+
+      /* render() changes the width of ellipsized layouts after
+       * measuring them, a cached one would measure differently
+       */
+      if (priv->ellipsize_set && priv->ellipsize != PANGO_ELLIPSIZE_NONE)
+        return FALSE;
+    }
+
+  context = gtk_widget_get_pango_context (widget);
+  gtk_cell_renderer_get_padding (GTK_CELL_RENDERER (celltext), &xpad, NULL);
+
+  g_string_append_printf (key, "%p %u %d %d %d ",
+                          context,
+                          pango_context_get_serial (context),
+                          xpad,
+                          priv->align_set ? (gint) priv->align : -1,
+                          (flags & GTK_CELL_RENDERER_PRELIT) != 0);
+
+  if (cell_area)
+    {
+      if (priv->foreground_set && (flags & GTK_CELL_RENDERER_SELECTED) == 0)
+        g_string_append_printf (key, "%d %g %g %g ",
+                                cell_area->width,
+                                priv->foreground.red,
+                                priv->foreground.green,
+                                priv->foreground.blue);
+      else
+        g_string_append_printf (key, "%d - ", cell_area->width);
+
+      g_string_append_printf (key, "%d ",
+                              priv->strikethrough_set ? priv->strikethrough : -1);
+    }
+  else
+    g_string_append (key, "- ");
+
+  return gtk_cell_renderer_text_get_request_key (GTK_CELL_RENDERER (celltext),
+                                                 widget, key);
+}
+
+/* Tree and icon views ask the same renderer for the same text over
+ * and over while measuring and drawing rows, so keep the most recently
+ * used layouts around instead of shaping the text again each time.
+ */
+static PangoLayout*
+get_layout (GtkCellRendererText *celltext,
+            GtkWidget           *widget,
+            const GdkRectangle  *cell_area,
+            GtkCellRendererState flags)
+{
+  GtkCellRendererTextPrivate *priv = celltext->priv;
+  CachedLayout *cached;
+  PangoLayout *layout;
+  GString *key;
+  GList *l;
+
+  key = g_string_new (NULL);
+  if (!get_layout_key (celltext, widget, cell_area, flags, key))
+    {
+      g_string_free (key, TRUE);
+      return create_layout (celltext, widget, cell_area, flags);
+    }
+
+  for (l = priv->layout_cache.head; l; l = l->next)
+    {
+      cached = l->data;
+
+      if (strcmp (cached->key, key->str) == 0)
+        {
+          g_string_free (key, TRUE);
+
+          if (l != priv->layout_cache.head)
+            {
+              g_queue_unlink (&priv->layout_cache, l);
+              g_queue_push_head_link (&priv->layout_cache, l);
+            }
+
+          /* The size request vfuncs change the width of the layout
+           * they are given, put back the one it was created with
+           */
+          pango_layout_set_width (cached->layout, cached->width);
+
+          return g_object_ref (cached->layout);
+        }
+    }
+
+  layout = create_layout (celltext, widget, cell_area, flags);
+
+  cached = g_slice_new (CachedLayout);
+  cached->key = g_string_free (key, FALSE);
+  cached->layout = g_object_ref (layout);
+  cached->width = pango_layout_get_width (layout);
+  g_queue_push_head (&priv->layout_cache, cached);
+
+  if (g_queue_get_length (&priv->layout_cache) > N_CACHED_LAYOUTS)
+    cached_layout_free (g_queue_pop_tail (&priv->layout_cache));
+
+  return layout;
+}
+
 
 static void
 get_size (GtkCellRenderer    *cell,
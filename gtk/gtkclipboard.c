@@ -162,6 +162,7 @@ struct _RequestTargetsInfo
 {
   GtkClipboardTargetsReceivedFunc callback;
   gpointer user_data;
+  guint serial;
 };
 
 static void gtk_clipboard_class_init   (GtkClipboardClass   *class);
@@ -187,6 +188,7 @@ static void gtk_clipboard_real_store            (GtkClipboard
 
 
 static void          clipboard_unset      (GtkClipboard     *clipboard);
+static void          clipboard_clear_cached_targets (GtkClipboard *clipboard);
 static void          selection_received   (GtkWidget        *widget,
 					   GtkSelectionData *selection_data,
 					   guint             time);
@@ -593,12 +595,7 @@ gtk_clipboard_set_contents (GtkClipboard         *clipboard,
     {
       clipboard->have_selection = TRUE;
 
-      if (clipboard->n_cached_targets != -1)
-        {
-          g_free (clipboard->cached_targets);
-	  clipboard->cached_targets = NULL;
-          clipboard->n_cached_targets = -1;
-        }
+      clipboard_clear_cached_targets (clipboard);
 
       if (!(clipboard->have_owner && have_owner) ||
 	  clipboard->user_data != user_data)
@@ -1295,6 +1292,40 @@ gtk_clipboard_request_uris (GtkClipboard                *clipboard,
 				  info);
 }
 
+/* If the display tells us when the selection owner changes, the
+ * TARGETS of the current owner are kept until the next change, so
+ * that availability checks don't need to ask the owner again.
+ * The serial catches owner changes that happen while a TARGETS
+ * request is in flight.
+ */
+static void
+clipboard_clear_cached_targets (GtkClipboard *clipboard)
+{
+  clipboard->cached_targets_serial++;
+
+  if (clipboard->n_cached_targets != -1)
+    {
+      g_free (clipboard->cached_targets);
+      clipboard->cached_targets = NULL;
+      clipboard->n_cached_targets = -1;
+    }
+}
+
+static void
+clipboard_cache_targets (GtkClipboard *clipboard,
+                         guint         serial,
+                         GdkAtom      *targets,
+                         gint          n_targets)
+{
+  if (!gdk_display_supports_selection_notification (gtk_clipboard_get_display (clipboard)) ||
+      clipboard->cached_targets_serial != serial ||
+      clipboard->n_cached_targets != -1)
+    return;
+
+  clipboard->n_cached_targets = n_targets;
+  clipboard->cached_targets = g_memdup (targets, n_targets * sizeof (GdkAtom));
+}
+
 static void 
 request_targets_received_func (GtkClipboard     *clipboard,
 			       GtkSelectionData *selection_data,
@@ -1304,7 +1335,8 @@ request_targets_received_func (GtkClipboard     *clipboard,
   GdkAtom *targets = NULL;
   gint n_targets = 0;
 
-  gtk_selection_data_get_targets (selection_data, &targets, &n_targets);
+  if (gtk_selection_data_get_targets (selection_data, &targets, &n_targets))
+    clipboard_cache_targets (clipboard, info->serial, targets, n_targets);
 
   info->callback (clipboard, targets, n_targets, info->user_data);
 
@@ -1349,6 +1381,7 @@ gtk_clipboard_request_targets (GtkClipboard                *clipboard,
   info = g_new (RequestTargetsInfo, 1);
   info->callback = callback;
   info->user_data = user_data;
+  info->serial = clipboard->cached_targets_serial;
 
   gtk_clipboard_request_contents (clipboard, gdk_atom_intern_static_string ("TARGETS"),
 				  request_targets_received_func,
@@ -1692,14 +1725,16 @@ gtk_clipboard_get_display (GtkClipboard *clipboard)
 gboolean
 gtk_clipboard_wait_is_text_available (GtkClipboard *clipboard)
 {
-  GtkSelectionData *data;
+  GdkAtom *targets;
+  gint n_targets;
   gboolean result = FALSE;
 
-  data = gtk_clipboard_wait_for_contents (clipboard, gdk_atom_intern_static_string ("TARGETS"));
-  if (data)
+  /* Goes through the targets cache, so this doesn't need to ask
+   * the owner again until the clipboard changes */
+  if (gtk_clipboard_wait_for_targets (clipboard, &targets, &n_targets))
     {
-      result = gtk_selection_data_targets_include_text (data);
-      gtk_selection_data_free (data);
+      result = gtk_targets_include_text (targets, n_targets);
+      g_free (targets);
     }
 
   return result;
@@ -1728,17 +1763,19 @@ gboolean
 gtk_clipboard_wait_is_rich_text_available (GtkClipboard  *clipboard,
                                            GtkTextBuffer *buffer)
 {
-  GtkSelectionData *data;
+  GdkAtom *targets;
+  gint n_targets;
   gboolean result = FALSE;
 
   g_return_val_if_fail (GTK_IS_CLIPBOARD (clipboard), FALSE);
   g_return_val_if_fail (GTK_IS_TEXT_BUFFER (buffer), FALSE);
 
-  data = gtk_clipboard_wait_for_contents (clipboard, gdk_atom_intern_static_string ("TARGETS"));
-  if (data)
+  /* Goes through the targets cache, so this doesn't need to ask
+   * the owner again until the clipboard changes */
+  if (gtk_clipboard_wait_for_targets (clipboard, &targets, &n_targets))
     {
-      result = gtk_selection_data_targets_include_rich_text (data, buffer);
-      gtk_selection_data_free (data);
+      result = gtk_targets_include_rich_text (targets, n_targets, buffer);
+      g_free (targets);
     }
 
   return result;
@@ -1765,15 +1802,16 @@ gtk_clipboard_wait_is_rich_text_available (GtkClipboard  *clipboard,
 gboolean
 gtk_clipboard_wait_is_image_available (GtkClipboard *clipboard)
 {
-  GtkSelectionData *data;
+  GdkAtom *targets;
+  gint n_targets;
   gboolean result = FALSE;
 
-  data = gtk_clipboard_wait_for_contents (clipboard, 
-					  gdk_atom_intern_static_string ("TARGETS"));
-  if (data)
+  /* Goes through the targets cache, so this doesn't need to ask
+   * the owner again until the clipboard changes */
+  if (gtk_clipboard_wait_for_targets (clipboard, &targets, &n_targets))
     {
-      result = gtk_selection_data_targets_include_image (data, FALSE);
-      gtk_selection_data_free (data);
+      result = gtk_targets_include_image (targets, n_targets, FALSE);
+      g_free (targets);
     }
 
   return result;
@@ -1800,15 +1838,16 @@ gtk_clipboard_wait_is_image_available (GtkClipboard *clipboard)
 gboolean
 gtk_clipboard_wait_is_uris_available (GtkClipboard *clipboard)
 {
-  GtkSelectionData *data;
+  GdkAtom *targets;
+  gint n_targets;
   gboolean result = FALSE;
 
-  data = gtk_clipboard_wait_for_contents (clipboard, 
-					  gdk_atom_intern_static_string ("TARGETS"));
-  if (data)
+  /* Goes through the targets cache, so this doesn't need to ask
+   * the owner again until the clipboard changes */
+  if (gtk_clipboard_wait_for_targets (clipboard, &targets, &n_targets))
     {
-      result = gtk_selection_data_targets_include_uri (data);
-      gtk_selection_data_free (data);
+      result = gtk_targets_include_uri (targets, n_targets);
+      g_free (targets);
     }
 
   return result;
@@ -1840,6 +1879,7 @@ gtk_clipboard_wait_for_targets (GtkClipboard  *clipboard,
 {
   GtkSelectionData *data;
   gboolean result = FALSE;
+  guint serial;
   
   g_return_val_if_fail (clipboard != NULL, FALSE);
 
@@ -1863,6 +1903,7 @@ gtk_clipboard_wait_for_targets (GtkClipboard  *clipboard,
   if (targets)
     *targets = NULL;      
 
+  serial = clipboard->cached_targets_serial;
   data = gtk_clipboard_wait_for_contents (clipboard, gdk_atom_intern_static_string ("TARGETS"));
 
   if (data)
@@ -1872,12 +1913,8 @@ gtk_clipboard_wait_for_targets (GtkClipboard  *clipboard,
        
       result = gtk_selection_data_get_targets (data, &tmp_targets, &tmp_n_targets);
  
-      if (gdk_display_supports_selection_notification (gtk_clipboard_get_display (clipboard)))
- 	{
- 	  clipboard->n_cached_targets = tmp_n_targets;
- 	  clipboard->cached_targets = g_memdup (tmp_targets,
- 						tmp_n_targets * sizeof (GdkAtom));
- 	}
+      if (result)
+        clipboard_cache_targets (clipboard, serial, tmp_targets, tmp_n_targets);
  
       if (n_targets)
  	*n_targets = tmp_n_targets;
@@ -1944,12 +1981,7 @@ static void
 gtk_clipboard_owner_change (GtkClipboard        *clipboard,
 			    GdkEventOwnerChange *event)
 {
-  if (clipboard->n_cached_targets != -1)
-    {
-      g_free (clipboard->cached_targets);
-      clipboard->cached_targets = NULL;
-      clipboard->n_cached_targets = -1;
-    }
+  clipboard_clear_cached_targets (clipboard);
 }
 
 /**
@@ -46,6 +46,7 @@ struct _GtkClipboard
 
   GdkAtom *cached_targets;
   gint     n_cached_targets;
+  guint    cached_targets_serial;
 
   gulong     notify_signal_id;
   gboolean   storing_selection;
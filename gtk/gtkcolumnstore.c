@@ -0,0 +1,1179 @@
+/* gtkcolumnstore.c
+ * Copyright (C) 2013 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkcolumnstore.h"
+
+#include <string.h>
+#include <gobject/gvaluecollector.h>
+
+/**
+ * SECTION:gtkcolumnstore
+ * @Short_description: A list model that stores its data one column at a time
+ * @Title: GtkColumnStore
+ * @See_also: #GtkListStore, #GtkTreeModel
+ *
+ * The #GtkColumnStore object is a list model for use with a #GtkTreeView
+ * or #GtkComboBox, like #GtkListStore. Instead of keeping a linked list
+ * of cells for every row, it keeps one array per column, so numbers are
+ * stored without any allocation and reading a cell does not need to
+ * walk the other cells of its row. Strings are interned per store, so
+ * repeated values are only stored once.
+ *
+ * This makes #GtkColumnStore a good choice for large tables of numbers
+ * or of strings from a small set of values. Rows are addressed by their
+ * position, so unlike #GtkListStore, iterators do not persist when rows
+ * are inserted or removed before the end. #GtkColumnStore does not
+ * implement #GtkTreeSortable; use a #GtkTreeModelSort to sort it.
+ *
+ * Columns can hold any type that #GtkListStore can hold.
+ */
+
+typedef struct _GtkColumnStoreColumn GtkColumnStoreColumn;
+
+struct _GtkColumnStoreColumn
+{
+  GType type;
+  GType fundamental;
+  gsize cell_size;
+  guint8 *cells;
+};
+
+struct _GtkColumnStorePrivate
+{
+  gint n_columns;
+  GtkColumnStoreColumn *columns;
+
+  gint length;
+  gint allocated;
+  gint stamp;
+
+  /* interned string -> reference count */
+  GHashTable *strings;
+};
+
+#define CELL(column, type, row) (((type *) (column)->cells)[(row)])
+
+#define ROW(iter) (GPOINTER_TO_INT ((iter)->user_data))
+
+static void         gtk_column_store_tree_model_init (GtkTreeModelIface *iface);
+static void         gtk_column_store_finalize        (GObject           *object);
+
+G_DEFINE_TYPE_WITH_CODE (GtkColumnStore, gtk_column_store, G_TYPE_OBJECT,
+                         G_ADD_PRIVATE (GtkColumnStore)
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_MODEL,
+                                                gtk_column_store_tree_model_init))
+
+static gsize
+get_cell_size (GType fundamental)
+{
+  switch (fundamental)
+    {
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_CHAR:
+    case G_TYPE_UCHAR:
+      return sizeof (guint8);
+    case G_TYPE_INT:
+    case G_TYPE_UINT:
+    case G_TYPE_ENUM:
+    case G_TYPE_FLAGS:
+      return sizeof (gint);
+    case G_TYPE_LONG:
+    case G_TYPE_ULONG:
+      return sizeof (glong);
+    case G_TYPE_INT64:
+    case G_TYPE_UINT64:
+      return sizeof (gint64);
+    case G_TYPE_FLOAT:
+      return sizeof (gfloat);
+    case G_TYPE_DOUBLE:
+      return sizeof (gdouble);
+    case G_TYPE_STRING:
+    case G_TYPE_POINTER:
+    case G_TYPE_BOXED:
+    case G_TYPE_OBJECT:
+    case G_TYPE_VARIANT:
+      return sizeof (gpointer);
+    default:
+      return 0;
+    }
+}
+
+static const gchar *
+intern_string (GtkColumnStorePrivate *priv,
+               const gchar           *str)
+{
+  gpointer key, count;
+
+  if (str == NULL)
+    return NULL;
+
+  if (g_hash_table_lookup_extended (priv->strings, str, &key, &count))
+    {
+      g_hash_table_insert (priv->strings, key, GUINT_TO_POINTER (GPOINTER_TO_UINT (count) + 1));
+      return key;
+    }
+
+  key = g_strdup (str);
+  g_hash_table_insert (priv->strings, key, GUINT_TO_POINTER (1));
+
+  return key;
+}
+
+static void
+release_string (GtkColumnStorePrivate *priv,
+                const gchar           *str)
+{
+  guint count;
+
+  if (str == NULL)
+    return;
+
+  count = GPOINTER_TO_UINT (g_hash_table_lookup (priv->strings, str));
+  if (count > 1)
+    g_hash_table_insert (priv->strings, (gpointer) str, GUINT_TO_POINTER (count - 1));
+  else
+    g_hash_table_remove (priv->strings, str);
+}
+
+static gboolean
+column_owns_cells (GtkColumnStoreColumn *column)
+{
+  return column->fundamental == G_TYPE_STRING ||
+         column->fundamental == G_TYPE_BOXED ||
+         column->fundamental == G_TYPE_OBJECT ||
+         column->fundamental == G_TYPE_VARIANT;
+}
+
+/* Drops what a cell of @column owned, @p is a copy of the cell */
+static void
+release_cell_contents (GtkColumnStorePrivate *priv,
+                       GtkColumnStoreColumn  *column,
+                       gpointer               p)
+{
+  if (p == NULL)
+    return;
+
+  switch (column->fundamental)
+    {
+    case G_TYPE_STRING:
+      release_string (priv, p);
+      break;
+    case G_TYPE_BOXED:
+      g_boxed_free (column->type, p);
+      break;
+    case G_TYPE_OBJECT:
+      g_object_unref (p);
+      break;
+    case G_TYPE_VARIANT:
+      g_variant_unref (p);
+      break;
+    default:
+      break;
+    }
+}
+
+static void
+release_rows (GtkColumnStorePrivate *priv,
+              gint                   first,
+              gint                   n_rows)
+{
+  gint i, row;
+
+  for (i = 0; i < priv->n_columns; i++)
+    {
+      GtkColumnStoreColumn *column = &priv->columns[i];
+
+      if (!column_owns_cells (column))
+        continue;
+
+      for (row = first; row < first + n_rows; row++)
+        {
+          release_cell_contents (priv, column, CELL (column, gpointer, row));
+          CELL (column, gpointer, row) = NULL;
+        }
+    }
+}
+
+static void
+set_cell (GtkColumnStorePrivate *priv,
+          GtkColumnStoreColumn  *column,
+          gint                   row,
+          const GValue          *value)
+{
+  gpointer old = NULL;
+
+  /* Released after setting, the new value may be the old one */
+  if (column_owns_cells (column))
+    old = CELL (column, gpointer, row);
+
+  switch (column->fundamental)
+    {
+    case G_TYPE_BOOLEAN:
+      CELL (column, guint8, row) = g_value_get_boolean (value) ? TRUE : FALSE;
+      break;
+    case G_TYPE_CHAR:
+      CELL (column, gint8, row) = g_value_get_schar (value);
+      break;
+    case G_TYPE_UCHAR:
+      CELL (column, guint8, row) = g_value_get_uchar (value);
+      break;
+    case G_TYPE_INT:
+      CELL (column, gint, row) = g_value_get_int (value);
+      break;
+    case G_TYPE_UINT:
+      CELL (column, guint, row) = g_value_get_uint (value);
+      break;
+    case G_TYPE_ENUM:
+      CELL (column, gint, row) = g_value_get_enum (value);
+      break;
+    case G_TYPE_FLAGS:
+      CELL (column, guint, row) = g_value_get_flags (value);
+      break;
+    case G_TYPE_LONG:
+      CELL (column, glong, row) = g_value_get_long (value);
+      break;
+    case G_TYPE_ULONG:
+      CELL (column, gulong, row) = g_value_get_ulong (value);
+      break;
+    case G_TYPE_INT64:
+      CELL (column, gint64, row) = g_value_get_int64 (value);
+      break;
+    case G_TYPE_UINT64:
+      CELL (column, guint64, row) = g_value_get_uint64 (value);
+      break;
+    case G_TYPE_FLOAT:
+      CELL (column, gfloat, row) = g_value_get_float (value);
+      break;
+    case G_TYPE_DOUBLE:
+      CELL (column, gdouble, row) = g_value_get_double (value);
+      break;
+    case G_TYPE_STRING:
+      CELL (column, const gchar *, row) = intern_string (priv, g_value_get_string (value));
+      break;
+    case G_TYPE_POINTER:
+      CELL (column, gpointer, row) = g_value_get_pointer (value);
+      break;
+    case G_TYPE_BOXED:
+      CELL (column, gpointer, row) = g_value_dup_boxed (value);
+      break;
+    case G_TYPE_OBJECT:
+      CELL (column, gpointer, row) = g_value_dup_object (value);
+      break;
+    case G_TYPE_VARIANT:
+      CELL (column, gpointer, row) = g_value_dup_variant (value);
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+
+  release_cell_contents (priv, column, old);
+}
+
+static void
+get_cell (GtkColumnStoreColumn *column,
+          gint                  row,
+          GValue               *value)
+{
+  g_value_init (value, column->type);
+
+  switch (column->fundamental)
+    {
+    case G_TYPE_BOOLEAN:
+      g_value_set_boolean (value, CELL (column, guint8, row));
+      break;
+    case G_TYPE_CHAR:
+      g_value_set_schar (value, CELL (column, gint8, row));
+      break;
+    case G_TYPE_UCHAR:
+      g_value_set_uchar (value, CELL (column, guint8, row));
+      break;
+    case G_TYPE_INT:
+      g_value_set_int (value, CELL (column, gint, row));
+      break;
+    case G_TYPE_UINT:
+      g_value_set_uint (value, CELL (column, guint, row));
+      break;
+    case G_TYPE_ENUM:
+      g_value_set_enum (value, CELL (column, gint, row));
+      break;
+    case G_TYPE_FLAGS:
+      g_value_set_flags (value, CELL (column, guint, row));
+      break;
+    case G_TYPE_LONG:
+      g_value_set_long (value, CELL (column, glong, row));
+      break;
+    case G_TYPE_ULONG:
+      g_value_set_ulong (value, CELL (column, gulong, row));
+      break;
+    case G_TYPE_INT64:
+      g_value_set_int64 (value, CELL (column, gint64, row));
+      break;
+    case G_TYPE_UINT64:
+      g_value_set_uint64 (value, CELL (column, guint64, row));
+      break;
+    case G_TYPE_FLOAT:
+      g_value_set_float (value, CELL (column, gfloat, row));
+      break;
+    case G_TYPE_DOUBLE:
+      g_value_set_double (value, CELL (column, gdouble, row));
+      break;
+    case G_TYPE_STRING:
+      g_value_set_string (value, CELL (column, const gchar *, row));
+      break;
+    case G_TYPE_POINTER:
+      g_value_set_pointer (value, CELL (column, gpointer, row));
+      break;
+    case G_TYPE_BOXED:
+      g_value_set_boxed (value, CELL (column, gpointer, row));
+      break;
+    case G_TYPE_OBJECT:
+      g_value_set_object (value, CELL (column, gpointer, row));
+      break;
+    case G_TYPE_VARIANT:
+      g_value_set_variant (value, CELL (column, gpointer, row));
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+static void
+gtk_column_store_class_init (GtkColumnStoreClass *class)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (class);
+
+  object_class->finalize = gtk_column_store_finalize;
+}
+
+static void
+gtk_column_store_init (GtkColumnStore *column_store)
+{
+  GtkColumnStorePrivate *priv;
+
+  column_store->priv = gtk_column_store_get_instance_private (column_store);
+  priv = column_store->priv;
+
+  priv->stamp = g_random_int ();
+  priv->strings = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+}
+
+static void
+gtk_column_store_finalize (GObject *object)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (object);
+  GtkColumnStorePrivate *priv = column_store->priv;
+  gint i;
+
+  release_rows (priv, 0, priv->length);
+
+  for (i = 0; i < priv->n_columns; i++)
+    g_free (priv->columns[i].cells);
+  g_free (priv->columns);
+
+  g_hash_table_destroy (priv->strings);
+
+  G_OBJECT_CLASS (gtk_column_store_parent_class)->finalize (object);
+}
+
+static gboolean
+gtk_column_store_set_column_types (GtkColumnStore *column_store,
+                                   gint            n_columns,
+                                   GType          *types)
+{
+  GtkColumnStorePrivate *priv = column_store->priv;
+  gint i;
+
+  priv->n_columns = n_columns;
+  priv->columns = g_new0 (GtkColumnStoreColumn, n_columns);
+
+  for (i = 0; i < n_columns; i++)
+    {
+      GtkColumnStoreColumn *column = &priv->columns[i];
+
+      column->type = types[i];
+      column->fundamental = G_TYPE_FUNDAMENTAL (types[i]);
+      column->cell_size = get_cell_size (column->fundamental);
+
+      if (column->cell_size == 0)
+        {
+          g_warning ("%s: Invalid type %s\n", G_STRLOC, g_type_name (types[i]));
+          return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
+/**
+ * gtk_column_store_new:
+ * @n_columns: number of columns in the column store
+ * @...: all #GType types for the columns, from first to last
+ *
+ * Creates a new column store as with @n_columns columns each of the
+ * types passed in. The types are the same that #GtkListStore accepts.
+ *
+ * Return value: a new #GtkColumnStore
+ *
+ * Since: 3.12
+ */
+GtkColumnStore *
+gtk_column_store_new (gint n_columns,
+                      ...)
+{
+  GtkColumnStore *retval;
+  GType *types;
+  va_list args;
+  gint i;
+
+  g_return_val_if_fail (n_columns > 0, NULL);
+
+  types = g_new (GType, n_columns);
+
+  va_start (args, n_columns);
+  for (i = 0; i < n_columns; i++)
+    types[i] = va_arg (args, GType);
+  va_end (args);
+
+  retval = gtk_column_store_newv (n_columns, types);
+  g_free (types);
+
+  return retval;
+}
+
+/**
+ * gtk_column_store_newv:
+ * @n_columns: number of columns in the column store
+ * @types: (array length=n_columns): an array of #GType types for the
+ *     columns, from first to last
+ *
+ * Non-vararg creation function. Used primarily by language bindings.
+ *
+ * Return value: (transfer full): a new #GtkColumnStore
+ *
+ * Since: 3.12
+ */
+GtkColumnStore *
+gtk_column_store_newv (gint   n_columns,
+                       GType *types)
+{
+  GtkColumnStore *retval;
+
+  g_return_val_if_fail (n_columns > 0, NULL);
+
+  retval = g_object_new (GTK_TYPE_COLUMN_STORE, NULL);
+  if (!gtk_column_store_set_column_types (retval, n_columns, types))
+    {
+      g_object_unref (retval);
+      return NULL;
+    }
+
+  return retval;
+}
+
+/* GtkTreeModel implementation */
+
+static gboolean
+iter_is_valid (GtkColumnStore *column_store,
+               GtkTreeIter    *iter)
+{
+  return iter != NULL &&
+         iter->stamp == column_store->priv->stamp &&
+         ROW (iter) >= 0 &&
+         ROW (iter) < column_store->priv->length;
+}
+
+static void
+set_iter (GtkColumnStore *column_store,
+          GtkTreeIter    *iter,
+          gint            row)
+{
+  iter->stamp = column_store->priv->stamp;
+  iter->user_data = GINT_TO_POINTER (row);
+  iter->user_data2 = NULL;
+  iter->user_data3 = NULL;
+}
+
+static GtkTreeModelFlags
+gtk_column_store_get_flags (GtkTreeModel *tree_model)
+{
+  return GTK_TREE_MODEL_LIST_ONLY;
+}
+
+static gint
+gtk_column_store_get_n_columns (GtkTreeModel *tree_model)
+{
+  return GTK_COLUMN_STORE (tree_model)->priv->n_columns;
+}
+
+static GType
+gtk_column_store_get_column_type (GtkTreeModel *tree_model,
+                                  gint          index)
+{
+  GtkColumnStorePrivate *priv = GTK_COLUMN_STORE (tree_model)->priv;
+
+  g_return_val_if_fail (index >= 0 && index < priv->n_columns, G_TYPE_INVALID);
+
+  return priv->columns[index].type;
+}
+
+static gboolean
+gtk_column_store_get_iter (GtkTreeModel *tree_model,
+                           GtkTreeIter  *iter,
+                           GtkTreePath  *path)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (tree_model);
+  gint i;
+
+  if (gtk_tree_path_get_depth (path) != 1)
+    {
+      iter->stamp = 0;
+      return FALSE;
+    }
+
+  i = gtk_tree_path_get_indices (path)[0];
+  if (i < 0 || i >= column_store->priv->length)
+    {
+      iter->stamp = 0;
+      return FALSE;
+    }
+
+  set_iter (column_store, iter, i);
+
+  return TRUE;
+}
+
+static GtkTreePath *
+gtk_column_store_get_path (GtkTreeModel *tree_model,
+                           GtkTreeIter  *iter)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (tree_model);
+
+  g_return_val_if_fail (iter_is_valid (column_store, iter), NULL);
+
+  return gtk_tree_path_new_from_indices (ROW (iter), -1);
+}
+
+static void
+gtk_column_store_get_value (GtkTreeModel *tree_model,
+                            GtkTreeIter  *iter,
+                            gint          column,
+                            GValue       *value)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (tree_model);
+  GtkColumnStorePrivate *priv = column_store->priv;
+
+  g_return_if_fail (column >= 0 && column < priv->n_columns);
+  g_return_if_fail (iter_is_valid (column_store, iter));
+
+  get_cell (&priv->columns[column], ROW (iter), value);
+}
+
+static gboolean
+gtk_column_store_iter_next (GtkTreeModel *tree_model,
+                            GtkTreeIter  *iter)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (tree_model);
+
+  g_return_val_if_fail (iter->stamp == column_store->priv->stamp, FALSE);
+
+  if (ROW (iter) + 1 >= column_store->priv->length)
+    {
+      iter->stamp = 0;
+      return FALSE;
+    }
+
+  iter->user_data = GINT_TO_POINTER (ROW (iter) + 1);
+
+  return TRUE;
+}
+
+static gboolean
+gtk_column_store_iter_previous (GtkTreeModel *tree_model,
+                                GtkTreeIter  *iter)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (tree_model);
+
+  g_return_val_if_fail (iter->stamp == column_store->priv->stamp, FALSE);
+
+  if (ROW (iter) <= 0)
+    {
+      iter->stamp = 0;
+      return FALSE;
+    }
+
+  iter->user_data = GINT_TO_POINTER (ROW (iter) - 1);
+
+  return TRUE;
+}
+
+static gboolean
+gtk_column_store_iter_children (GtkTreeModel *tree_model,
+                                GtkTreeIter  *iter,
+                                GtkTreeIter  *parent)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (tree_model);
+
+  /* this is a list, nodes have no children */
+  if (parent || column_store->priv->length == 0)
+    {
+      iter->stamp = 0;
+      return FALSE;
+    }
+
+  set_iter (column_store, iter, 0);
+
+  return TRUE;
+}
+
+static gboolean
+gtk_column_store_iter_has_child (GtkTreeModel *tree_model,
+                                 GtkTreeIter  *iter)
+{
+  return FALSE;
+}
+
+static gint
+gtk_column_store_iter_n_children (GtkTreeModel *tree_model,
+                                  GtkTreeIter  *iter)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (tree_model);
+
+  if (iter == NULL)
+    return column_store->priv->length;
+
+  g_return_val_if_fail (iter->stamp == column_store->priv->stamp, -1);
+
+  return 0;
+}
+
+static gboolean
+gtk_column_store_iter_nth_child (GtkTreeModel *tree_model,
+                                 GtkTreeIter  *iter,
+                                 GtkTreeIter  *parent,
+                                 gint          n)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (tree_model);
+
+  if (parent || n < 0 || n >= column_store->priv->length)
+    {
+      iter->stamp = 0;
+      return FALSE;
+    }
+
+  set_iter (column_store, iter, n);
+
+  return TRUE;
+}
+
+static gboolean
+gtk_column_store_iter_parent (GtkTreeModel *tree_model,
+                              GtkTreeIter  *iter,
+                              GtkTreeIter  *child)
+{
+  iter->stamp = 0;
+  return FALSE;
+}
+
+static void
+gtk_column_store_tree_model_init (GtkTreeModelIface *iface)
+{
+  iface->get_flags = gtk_column_store_get_flags;
+  iface->get_n_columns = gtk_column_store_get_n_columns;
+  iface->get_column_type = gtk_column_store_get_column_type;
+  iface->get_iter = gtk_column_store_get_iter;
+  iface->get_path = gtk_column_store_get_path;
+  iface->get_value = gtk_column_store_get_value;
+  iface->iter_next = gtk_column_store_iter_next;
+  iface->iter_previous = gtk_column_store_iter_previous;
+  iface->iter_children = gtk_column_store_iter_children;
+  iface->iter_has_child = gtk_column_store_iter_has_child;
+  iface->iter_n_children = gtk_column_store_iter_n_children;
+  iface->iter_nth_child = gtk_column_store_iter_nth_child;
+  iface->iter_parent = gtk_column_store_iter_parent;
+}
+
+/* Public accessors */
+
+static gboolean
+gtk_column_store_real_set_value (GtkColumnStore *column_store,
+                                 gint            row,
+                                 gint            column,
+                                 GValue         *value)
+{
+  GtkColumnStorePrivate *priv = column_store->priv;
+  GType type = priv->columns[column].type;
+  GValue real_value = G_VALUE_INIT;
+
+  if (g_type_is_a (G_VALUE_TYPE (value), type))
+    {
+      set_cell (priv, &priv->columns[column], row, value);
+      return TRUE;
+    }
+
+  if (!g_value_type_transformable (G_VALUE_TYPE (value), type))
+    {
+      g_warning ("%s: Unable to convert from %s to %s\n",
+                 G_STRLOC,
+                 g_type_name (G_VALUE_TYPE (value)),
+                 g_type_name (type));
+      return FALSE;
+    }
+
+  g_value_init (&real_value, type);
+  if (!g_value_transform (value, &real_value))
+    {
+      g_warning ("%s: Unable to make conversion from %s to %s\n",
+                 G_STRLOC,
+                 g_type_name (G_VALUE_TYPE (value)),
+                 g_type_name (type));
+      g_value_unset (&real_value);
+      return FALSE;
+    }
+
+  set_cell (priv, &priv->columns[column], row, &real_value);
+  g_value_unset (&real_value);
+
+  return TRUE;
+}
+
+static void
+emit_row_changed (GtkColumnStore *column_store,
+                  GtkTreeIter    *iter)
+{
+  GtkTreePath *path;
+
+  path = gtk_tree_path_new_from_indices (ROW (iter), -1);
+  gtk_tree_model_row_changed (GTK_TREE_MODEL (column_store), path, iter);
+  gtk_tree_path_free (path);
+}
+
+/**
+ * gtk_column_store_set_value:
+ * @column_store: A #GtkColumnStore
+ * @iter: A valid #GtkTreeIter for the row being modified
+ * @column: column number to modify
+ * @value: new value for the cell
+ *
+ * Sets the data in the cell specified by @iter and @column.
+ * The type of @value must be convertible to the type of the
+ * column.
+ *
+ * Since: 3.12
+ */
+void
+gtk_column_store_set_value (GtkColumnStore *column_store,
+                            GtkTreeIter    *iter,
+                            gint            column,
+                            GValue         *value)
+{
+  g_return_if_fail (GTK_IS_COLUMN_STORE (column_store));
+  g_return_if_fail (iter_is_valid (column_store, iter));
+  g_return_if_fail (G_IS_VALUE (value));
+  g_return_if_fail (column >= 0 && column < column_store->priv->n_columns);
+
+  if (gtk_column_store_real_set_value (column_store, ROW (iter), column, value))
+    emit_row_changed (column_store, iter);
+}
+
+static gboolean
+gtk_column_store_set_vector_internal (GtkColumnStore *column_store,
+                                      gint            row,
+                                      gint           *columns,
+                                      GValue         *values,
+                                      gint            n_values)
+{
+  GtkColumnStorePrivate *priv = column_store->priv;
+  gboolean changed = FALSE;
+  gint i;
+
+  for (i = 0; i < n_values; i++)
+    {
+      if (columns[i] < 0 || columns[i] >= priv->n_columns)
+        {
+          g_warning ("%s: Invalid column number %d", G_STRLOC, columns[i]);
+          continue;
+        }
+
+      changed = gtk_column_store_real_set_value (column_store, row,
+                                                 columns[i], &values[i]) || changed;
+    }
+
+  return changed;
+}
+
+/**
+ * gtk_column_store_set_valuesv:
+ * @column_store: A #GtkColumnStore
+ * @iter: A valid #GtkTreeIter for the row being modified
+ * @columns: (array length=n_values): an array of column numbers
+ * @values: (array length=n_values): an array of GValues
+ * @n_values: the length of the @columns and @values arrays
+ *
+ * A variant of gtk_column_store_set_valist() which
+ * takes the columns and values as two arrays, instead of
+ * varargs. This function is mainly intended for
+ * language-bindings and in case the number of columns to
+ * change is not known until run-time.
+ *
+ * Since: 3.12
+ */
+void
+gtk_column_store_set_valuesv (GtkColumnStore *column_store,
+                              GtkTreeIter    *iter,
+                              gint           *columns,
+                              GValue         *values,
+                              gint            n_values)
+{
+  g_return_if_fail (GTK_IS_COLUMN_STORE (column_store));
+  g_return_if_fail (iter_is_valid (column_store, iter));
+
+  if (gtk_column_store_set_vector_internal (column_store, ROW (iter),
+                                            columns, values, n_values))
+    emit_row_changed (column_store, iter);
+}
+
+/**
+ * gtk_column_store_set_valist:
+ * @column_store: A #GtkColumnStore
+ * @iter: A valid #GtkTreeIter for the row being modified
+ * @var_args: va_list of column/value pairs
+ *
+ * See gtk_column_store_set(); this version takes a va_list for use by
+ * language bindings.
+ *
+ * Since: 3.12
+ */
+void
+gtk_column_store_set_valist (GtkColumnStore *column_store,
+                             GtkTreeIter    *iter,
+                             va_list         var_args)
+{
+  GtkColumnStorePrivate *priv;
+  gboolean changed = FALSE;
+  gint column;
+
+  g_return_if_fail (GTK_IS_COLUMN_STORE (column_store));
+  g_return_if_fail (iter_is_valid (column_store, iter));
+
+  priv = column_store->priv;
+
+  column = va_arg (var_args, gint);
+
+  while (column != -1)
+    {
+      GValue value = G_VALUE_INIT;
+      gchar *error = NULL;
+
+      if (column < 0 || column >= priv->n_columns)
+        {
+          g_warning ("%s: Invalid column number %d added to iter (remember to end your list of columns with a -1)", G_STRLOC, column);
+          break;
+        }
+
+      G_VALUE_COLLECT_INIT (&value, priv->columns[column].type,
+                            var_args, 0, &error);
+      if (error)
+        {
+          g_warning ("%s: %s", G_STRLOC, error);
+          g_free (error);
+
+          /* we purposely leak the value here, it might not be
+           * in a sane state if an error condition occoured
+           */
+          break;
+        }
+
+      changed = gtk_column_store_real_set_value (column_store, ROW (iter),
+                                                 column, &value) || changed;
+
+      g_value_unset (&value);
+
+      column = va_arg (var_args, gint);
+    }
+
+  if (changed)
+    emit_row_changed (column_store, iter);
+}
+
+/**
+ * gtk_column_store_set:
+ * @column_store: a #GtkColumnStore
+ * @iter: row iterator
+ * @...: pairs of column number and value, terminated with -1
+ *
+ * Sets the value of one or more cells in the row referenced by @iter.
+ * The variable argument list should contain integer column numbers,
+ * each column number followed by the value to be set.
+ * The list is terminated by a -1. For example, to set column 0 with type
+ * %G_TYPE_STRING to "Foo", you would write
+ * <literal>gtk_column_store_set (store, iter, 0, "Foo", -1)</literal>.
+ *
+ * Since: 3.12
+ */
+void
+gtk_column_store_set (GtkColumnStore *column_store,
+                      GtkTreeIter    *iter,
+                      ...)
+{
+  va_list var_args;
+
+  va_start (var_args, iter);
+  gtk_column_store_set_valist (column_store, iter, var_args);
+  va_end (var_args);
+}
+
+static gint
+insert_row (GtkColumnStore *column_store,
+            gint            position)
+{
+  GtkColumnStorePrivate *priv = column_store->priv;
+  gint i;
+
+  if (position < 0 || position > priv->length)
+    position = priv->length;
+
+  if (priv->length == priv->allocated)
+    {
+      priv->allocated = MAX (16, priv->allocated * 2);
+      for (i = 0; i < priv->n_columns; i++)
+        priv->columns[i].cells = g_realloc_n (priv->columns[i].cells,
+                                              priv->allocated,
+                                              priv->columns[i].cell_size);
+    }
+
+  for (i = 0; i < priv->n_columns; i++)
+    {
+      GtkColumnStoreColumn *column = &priv->columns[i];
+      guint8 *cell = column->cells + position * column->cell_size;
+
+      memmove (cell + column->cell_size, cell,
+               (priv->length - position) * column->cell_size);
+      memset (cell, 0, column->cell_size);
+    }
+
+  priv->length++;
+
+  /* Rows after the new one moved, so their iters are stale */
+  if (position < priv->length - 1)
+    {
+      do
+        priv->stamp++;
+      while (priv->stamp == 0);
+    }
+
+  return position;
+}
+
+/**
+ * gtk_column_store_insert_with_valuesv:
+ * @column_store: A #GtkColumnStore
+ * @iter: (out) (allow-none): An unset #GtkTreeIter to set to the new row, or %NULL.
+ * @position: position to insert the new row, or -1 to append
+ * @columns: (array length=n_values): an array of column numbers
+ * @values: (array length=n_values): an array of GValues
+ * @n_values: the length of the @columns and @values arrays
+ *
+ * Creates a new row at @position, filled in with @values, and emits
+ * #GtkTreeModel::row-inserted once. This is the fastest way to fill
+ * a #GtkColumnStore.
+ *
+ * Since: 3.12
+ */
+void
+gtk_column_store_insert_with_valuesv (GtkColumnStore *column_store,
+                                      GtkTreeIter    *iter,
+                                      gint            position,
+                                      gint           *columns,
+                                      GValue         *values,
+                                      gint            n_values)
+{
+  GtkTreeIter tmp_iter;
+  GtkTreePath *path;
+
+  g_return_if_fail (GTK_IS_COLUMN_STORE (column_store));
+
+  if (!iter)
+    iter = &tmp_iter;
+
+  position = insert_row (column_store, position);
+  gtk_column_store_set_vector_internal (column_store, position,
+                                        columns, values, n_values);
+
+  set_iter (column_store, iter, position);
+
+  path = gtk_tree_path_new_from_indices (position, -1);
+  gtk_tree_model_row_inserted (GTK_TREE_MODEL (column_store), path, iter);
+  gtk_tree_path_free (path);
+}
+
+/**
+ * gtk_column_store_insert:
+ * @column_store: A #GtkColumnStore
+ * @iter: (out): An unset #GtkTreeIter to set to the new row
+ * @position: position to insert the new row, or -1 to append
+ *
+ * Creates a new row at @position. @iter will be changed to point to
+ * this new row. If @position is -1 or larger than the number of rows
+ * on the list, then the new row will be appended to the list. The row
+ * will be empty after this function is called. To fill in values, you
+ * need to call gtk_column_store_set() or gtk_column_store_set_value().
+ *
+ * Since: 3.12
+ */
+void
+gtk_column_store_insert (GtkColumnStore *column_store,
+                         GtkTreeIter    *iter,
+                         gint            position)
+{
+  g_return_if_fail (iter != NULL);
+
+  gtk_column_store_insert_with_valuesv (column_store, iter, position,
+                                        NULL, NULL, 0);
+}
+
+/**
+ * gtk_column_store_append:
+ * @column_store: A #GtkColumnStore
+ * @iter: (out): An unset #GtkTreeIter to set to the appended row
+ *
+ * Appends a new row to @column_store. Appending does not invalidate
+ * the iters of other rows.
+ *
+ * Since: 3.12
+ */
+void
+gtk_column_store_append (GtkColumnStore *column_store,
+                         GtkTreeIter    *iter)
+{
+  gtk_column_store_insert (column_store, iter, -1);
+}
+
+/**
+ * gtk_column_store_remove:
+ * @column_store: A #GtkColumnStore
+ * @iter: A valid #GtkTreeIter
+ *
+ * Removes the given row from the column store. After being removed,
+ * @iter is set to be the next valid row, or invalidated if it pointed
+ * to the last row in @column_store. Iters of all other rows are
+ * invalidated.
+ *
+ * Return value: %TRUE if @iter is valid, %FALSE if not.
+ *
+ * Since: 3.12
+ */
+gboolean
+gtk_column_store_remove (GtkColumnStore *column_store,
+                         GtkTreeIter    *iter)
+{
+  GtkColumnStorePrivate *priv;
+  GtkTreePath *path;
+  gint row, i;
+
+  g_return_val_if_fail (GTK_IS_COLUMN_STORE (column_store), FALSE);
+  g_return_val_if_fail (iter_is_valid (column_store, iter), FALSE);
+
+  priv = column_store->priv;
+  row = ROW (iter);
+
+  release_rows (priv, row, 1);
+
+  for (i = 0; i < priv->n_columns; i++)
+    {
+      GtkColumnStoreColumn *column = &priv->columns[i];
+      guint8 *cell = column->cells + row * column->cell_size;
+
+      memmove (cell, cell + column->cell_size,
+               (priv->length - row - 1) * column->cell_size);
+    }
+
+  priv->length--;
+  do
+    priv->stamp++;
+  while (priv->stamp == 0);
+
+  path = gtk_tree_path_new_from_indices (row, -1);
+  gtk_tree_model_row_deleted (GTK_TREE_MODEL (column_store), path);
+  gtk_tree_path_free (path);
+
+  if (row < priv->length)
+    {
+      set_iter (column_store, iter, row);
+      return TRUE;
+    }
+
+  iter->stamp = 0;
+  return FALSE;
+}
+
+/**
+ * gtk_column_store_clear:
+ * @column_store: a #GtkColumnStore.
+ *
+ * Removes all rows from the column store.
+ *
+ * Since: 3.12
+ */
+void
+gtk_column_store_clear (GtkColumnStore *column_store)
+{
+  GtkColumnStorePrivate *priv;
+  GtkTreePath *path;
+
+  g_return_if_fail (GTK_IS_COLUMN_STORE (column_store));
+
+  priv = column_store->priv;
+
+  /* Rows go from the end so views never see a hole */
+  path = gtk_tree_path_new_from_indices (0, -1);
+  while (priv->length > 0)
+    {
+      priv->length--;
+      release_rows (priv, priv->length, 1);
+      do
+        priv->stamp++;
+      while (priv->stamp == 0);
+
+      gtk_tree_path_get_indices (path)[0] = priv->length;
+      gtk_tree_model_row_deleted (GTK_TREE_MODEL (column_store), path);
+    }
+  gtk_tree_path_free (path);
+}
+
+/**
+ * gtk_column_store_iter_is_valid:
+ * @column_store: A #GtkColumnStore.
+ * @iter: A #GtkTreeIter.
+ *
+ * Checks if the given iter is a valid iter for this #GtkColumnStore.
+ * Unlike the same check for #GtkListStore, this is cheap.
+ *
+ * Return value: %TRUE if the iter is valid, %FALSE if the iter is invalid.
+ *
+ * Since: 3.12
+ */
+gboolean
+gtk_column_store_iter_is_valid (GtkColumnStore *column_store,
+                                GtkTreeIter    *iter)
+{
+  g_return_val_if_fail (GTK_IS_COLUMN_STORE (column_store), FALSE);
+  g_return_val_if_fail (iter != NULL, FALSE);
+
+  return iter_is_valid (column_store, iter);
+}
@@ -249,6 +249,12 @@ static guint combo_box_signals[LAST_SIGNAL] = {0,};
 #define BONUS_PADDING 4
 #define SCROLL_TIME  100
 
+/* Menu mode creates a menu item for every row up front, which makes
+ * popping up long lists slow. Above this many rows we use the list
+ * mode popup instead, whose tree view only renders the visible rows.
+ */
+#define MENU_MODE_MAX_ROWS 200
+
 /* common */
 
 static void     gtk_combo_box_cell_layout_init     (GtkCellLayoutIface *iface);
@@ -1482,7 +1488,12 @@ gtk_combo_box_check_appearance (GtkComboBox *combo_box)
     gtk_widget_style_get (GTK_WIDGET (combo_box),
                           "appears-as-list", &appears_as_list,
                           NULL);
-  
+
+  if (!appears_as_list && !priv->wrap_width && !priv->add_tearoffs &&
+      priv->model != NULL &&
+      gtk_tree_model_iter_n_children (priv->model, NULL) > MENU_MODE_MAX_ROWS)
+    appears_as_list = TRUE;
+
   if (appears_as_list)
     {
       /* Destroy all the menu mode widgets, if they exist. */
@@ -3325,8 +3336,16 @@ gtk_combo_box_model_row_inserted (GtkTreeModel     *model,
                                   gpointer          user_data)
 {
   GtkComboBox *combo_box = GTK_COMBO_BOX (user_data);
+  GtkComboBoxPrivate *priv = combo_box->priv;
 
-  if (combo_box->priv->tree_view)
+  /* Switch to list mode once the model grows too large for a menu */
+  if (GTK_IS_MENU (priv->popup_widget) &&
+      !gtk_widget_get_mapped (priv->popup_widget) &&
+      gtk_tree_path_get_depth (path) == 1 &&
+      gtk_tree_model_iter_n_children (model, NULL) == MENU_MODE_MAX_ROWS + 1)
+    gtk_combo_box_check_appearance (combo_box);
+
+  if (priv->tree_view)
     gtk_combo_box_list_popup_resize (combo_box);
 
   gtk_combo_box_update_sensitivity (combo_box);
@@ -4485,6 +4504,12 @@ gtk_combo_box_set_model (GtkComboBox  *combo_box,
                       G_CALLBACK (gtk_combo_box_model_row_changed),
                       combo_box);
 
+  /* The size of the model may decide between menu and list mode;
+   * switch before the menu gets populated.
+   */
+  if (combo_box->priv->popup_widget)
+    gtk_combo_box_check_appearance (combo_box);
+
   if (combo_box->priv->tree_view)
     {
       /* list mode */
@@ -0,0 +1,692 @@
+/* GTK - The GIMP Toolkit
+ * Copyright (C) 2013 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkcomposetableprivate.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <glib/gstdio.h>
+#include <gdk/gdk.h>
+
+#include "gtkimcontextsimple.h"
+#include "gtkdebug.h"
+
+/* The user's compose file (~/.XCompose, or $XCOMPOSEFILE) compiled
+ * into a trie, so that GtkIMContextSimple can look up each keystroke
+ * by walking one node per key of the compose buffer.
+ *
+ * The trie is an array of nodes; node 0 is the root. The children of
+ * a node are next to each other in the array, sorted by keysym, and
+ * found by binary search. A node with a value ends a sequence; if it
+ * also has children, the value is only a tentative match.
+ *
+ * Parsing the file is slow compared to a keystroke, so the compiled
+ * trie is written to the user cache directory and mapped from there
+ * by every process. The cache file records the modification time
+ * and size of the compose file, and is rebuilt when either changes.
+ * Files included from it are only looked at again at that point.
+ */
+
+#define GTK_COMPOSE_TRIE_MAGIC   "GtkCompT"
+#define GTK_COMPOSE_TRIE_VERSION 1
+
+/* Nested includes of the user's own files */
+#define MAX_INCLUDE_DEPTH 4
+
+typedef struct
+{
+  gchar   magic[8];
+  guint32 version;
+  guint32 n_nodes;
+  guint64 mtime;
+  guint64 size;
+} GtkComposeTrieHeader;
+
+typedef struct
+{
+  guint32 keysym;
+  guint32 value;
+  guint32 first_child;
+  guint32 n_children;
+} GtkComposeTrieNode;
+
+struct _GtkComposeTrie
+{
+  GMappedFile *map;
+  gchar *data;
+
+  const GtkComposeTrieNode *nodes;
+  guint n_nodes;
+};
+
+typedef struct
+{
+  guint keysym;
+  gunichar value;
+  GArray *children;
+} BuildNode;
+
+static void
+build_node_clear (gpointer data)
+{
+  BuildNode *node = data;
+
+  if (node->children)
+    g_array_free (node->children, TRUE);
+}
+
+static guint
+build_add_child (GArray *nodes,
+                 guint   parent,
+                 guint   keysym)
+{
+  BuildNode *node = &g_array_index (nodes, BuildNode, parent);
+  BuildNode child = { keysym, 0, NULL };
+  guint i, index;
+
+  if (node->children == NULL)
+    node->children = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  for (i = 0; i < node->children->len; i++)
+    {
+      index = g_array_index (node->children, guint, i);
+      if (g_array_index (nodes, BuildNode, index).keysym == keysym)
+        return index;
+    }
+
+  index = nodes->len;
+  g_array_append_val (node->children, index);
+  /* This may move the node, so it must be the last use of it */
+  g_array_append_val (nodes, child);
+
+  return index;
+}
+
+static guint
+keysym_from_name (const gchar *name)
+{
+  guint keysym;
+
+  keysym = gdk_keyval_from_name (name);
+  if (keysym != GDK_KEY_VoidSymbol && keysym != 0)
+    return keysym;
+
+  /* Unicode keysyms, as in <U00E9> */
+  if (name[0] == 'U' && g_ascii_isxdigit (name[1]))
+    {
+      gchar *end;
+      gulong ch;
+
+      ch = strtoul (name + 1, &end, 16);
+      if (*end == '\0' && g_unichar_validate (ch))
+        return gdk_unicode_to_keyval (ch);
+    }
+
+  return 0;
+}
+
+/* Parses the "<a> <b>" part of a line */
+static gint
+parse_sequence (const gchar *str,
+                guint       *keysyms)
+{
+  const gchar *p, *end;
+  gint n_keysyms = 0;
+
+  p = str;
+  while (TRUE)
+    {
+      gchar *name;
+      guint keysym;
+
+      while (g_ascii_isspace (*p))
+        p++;
+
+      if (*p == '\0')
+        break;
+
+      if (*p != '<' || n_keysyms == GTK_MAX_COMPOSE_LEN)
+        return 0;
+
+      end = strchr (p, '>');
+      if (end == NULL)
+        return 0;
+
+      name = g_strndup (p + 1, end - p - 1);
+      keysym = keysym_from_name (name);
+      g_free (name);
+
+      if (keysym == 0)
+        return 0;
+
+      keysyms[n_keysyms++] = keysym;
+      p = end + 1;
+    }
+
+  return n_keysyms;
+}
+
+/* Parses the ": "string" keysym" part of a line */
+static gunichar
+parse_value (const gchar *str)
+{
+  const gchar *p = str;
+  GString *string = NULL;
+  gunichar value = 0;
+
+  while (g_ascii_isspace (*p))
+    p++;
+
+  if (*p == '"')
+    {
+      string = g_string_new (NULL);
+
+      for (p++; *p != '"'; p++)
+        {
+          if (*p == '\0')
+            {
+              g_string_free (string, TRUE);
+              return 0;
+            }
+
+          if (*p != '\\')
+            {
+              g_string_append_c (string, *p);
+              continue;
+            }
+
+          p++;
+          if (*p >= '0' && *p <= '7')
+            {
+              gint i, c = 0;
+
+              for (i = 0; i < 3 && *p >= '0' && *p <= '7'; i++, p++)
+                c = c * 8 + (*p - '0');
+              g_string_append_c (string, c);
+              p--;
+            }
+          else if ((*p == 'x' || *p == 'X') && g_ascii_isxdigit (p[1]))
+            {
+              gint i, c = 0;
+
+              for (i = 0, p++; i < 2 && g_ascii_isxdigit (*p); i++, p++)
+                c = c * 16 + g_ascii_xdigit_value (*p);
+              g_string_append_c (string, c);
+              p--;
+            }
+          else if (*p == 'n')
+            g_string_append_c (string, '\n');
+          else if (*p == 'r')
+            g_string_append_c (string, '\r');
+          else if (*p == 't')
+            g_string_append_c (string, '\t');
+          else if (*p != '\0')
+            g_string_append_c (string, *p);
+          else
+            {
+              g_string_free (string, TRUE);
+              return 0;
+            }
+        }
+      p++;
+
+      /* Only single characters can be committed */
+      if (g_utf8_validate (string->str, string->len, NULL) &&
+          g_utf8_strlen (string->str, string->len) == 1)
+        value = g_utf8_get_char (string->str);
+
+      g_string_free (string, TRUE);
+
+      if (value != 0)
+        return value;
+    }
+
+  /* Fall back to the keysym, if there is one */
+  while (g_ascii_isspace (*p))
+    p++;
+
+  if (*p != '\0' && *p != '#')
+    {
+      const gchar *end = p;
+      gchar *name;
+      guint keysym;
+
+      while (*end != '\0' && !g_ascii_isspace (*end))
+        end++;
+
+      name = g_strndup (p, end - p);
+      keysym = keysym_from_name (name);
+      g_free (name);
+
+      if (keysym != 0)
+        value = gdk_keyval_to_unicode (keysym);
+    }
+
+  return value;
+}
+
+static void parse_file (GArray      *nodes,
+                        const gchar *path,
+                        gint         depth);
+
+static void
+parse_include (GArray      *nodes,
+               const gchar *arg,
+               const gchar *path,
+               gint         depth)
+{
+  const gchar *start, *end;
+  GString *include;
+  const gchar *p;
+
+  start = strchr (arg, '"');
+  end = start ? strchr (start + 1, '"') : NULL;
+  if (end == NULL)
+    return;
+
+  include = g_string_new (NULL);
+  for (p = start + 1; p < end; p++)
+    {
+      if (*p != '%' || p + 1 == end)
+        {
+          g_string_append_c (include, *p);
+          continue;
+        }
+
+      p++;
+      switch (*p)
+        {
+        case 'H':
+          g_string_append (include, g_get_home_dir ());
+          break;
+        case 'L':
+        case 'S':
+          /* The system tables for the locale are built into
+           * GtkIMContextSimple and always searched after this one
+           */
+          g_string_free (include, TRUE);
+          return;
+        case '%':
+          g_string_append_c (include, '%');
+          break;
+        default:
+          g_string_append_c (include, '%');
+          g_string_append_c (include, *p);
+          break;
+        }
+    }
+
+  if (depth >= MAX_INCLUDE_DEPTH)
+    g_warning ("Too many nested includes in compose file %s", path);
+  else
+    parse_file (nodes, include->str, depth + 1);
+
+  g_string_free (include, TRUE);
+}
+
+static void
+parse_line (GArray      *nodes,
+            const gchar *line,
+            const gchar *path,
+            gint         depth)
+{
+  guint keysyms[GTK_MAX_COMPOSE_LEN];
+  const gchar *colon;
+  gchar *sequence;
+  gint n_keysyms, i;
+  guint index;
+  gunichar value;
+
+  while (g_ascii_isspace (*line))
+    line++;
+
+  if (*line == '\0' || *line == '#')
+    return;
+
+  if (g_str_has_prefix (line, "include"))
+    {
+      parse_include (nodes, line + strlen ("include"), path, depth);
+      return;
+    }
+
+  colon = strchr (line, ':');
+  if (colon == NULL)
+    return;
+
+  sequence = g_strndup (line, colon - line);
+  n_keysyms = parse_sequence (sequence, keysyms);
+  g_free (sequence);
+
+  if (n_keysyms == 0)
+    return;
+
+  value = parse_value (colon + 1);
+  if (value == 0)
+    return;
+
+  index = 0;
+  for (i = 0; i < n_keysyms; i++)
+    index = build_add_child (nodes, index, keysyms[i]);
+
+  /* Later definitions override earlier ones, as in Xlib */
+  g_array_index (nodes, BuildNode, index).value = value;
+}
+
+static void
+parse_file (GArray      *nodes,
+            const gchar *path,
+            gint         depth)
+{
+  gchar *contents;
+  gchar **lines;
+  gint i;
+
+  if (!g_file_get_contents (path, &contents, NULL, NULL))
+    return;
+
+  lines = g_strsplit (contents, "\n", -1);
+  g_free (contents);
+
+  for (i = 0; lines[i] != NULL; i++)
+    parse_line (nodes, lines[i], path, depth);
+
+  g_strfreev (lines);
+}
+
+static gint
+compare_build_nodes (gconstpointer a,
+                     gconstpointer b,
+                     gpointer      data)
+{
+  GArray *nodes = data;
+  guint keysym_a = g_array_index (nodes, BuildNode, *(const guint *) a).keysym;
+  guint keysym_b = g_array_index (nodes, BuildNode, *(const guint *) b).keysym;
+
+  return keysym_a < keysym_b ? -1 : keysym_a > keysym_b;
+}
+
+/* Lays the nodes out breadth first, so that the children of
+ * each node end up next to each other
+ */
+static gchar *
+serialize_trie (GArray          *nodes,
+                const GStatBuf  *st,
+                gsize           *length)
+{
+  GtkComposeTrieHeader *header;
+  GtkComposeTrieNode *out;
+  GArray *order;
+  gchar *data;
+  guint i, j;
+
+  *length = sizeof (GtkComposeTrieHeader) + nodes->len * sizeof (GtkComposeTrieNode);
+  data = g_malloc0 (*length);
+
+  header = (GtkComposeTrieHeader *) data;
+  memcpy (header->magic, GTK_COMPOSE_TRIE_MAGIC, sizeof (header->magic));
+  header->version = GTK_COMPOSE_TRIE_VERSION;
+  header->n_nodes = nodes->len;
+  header->mtime = st->st_mtime;
+  header->size = st->st_size;
+
+  out = (GtkComposeTrieNode *) (data + sizeof (GtkComposeTrieHeader));
+
+  order = g_array_sized_new (FALSE, FALSE, sizeof (guint), nodes->len);
+  i = 0;
+  g_array_append_val (order, i);
+
+  for (i = 0; i < order->len; i++)
+    {
+      BuildNode *node = &g_array_index (nodes, BuildNode, g_array_index (order, guint, i));
+
+      out[i].keysym = node->keysym;
+      out[i].value = node->value;
+      out[i].first_child = order->len;
+      out[i].n_children = 0;
+
+      if (node->children == NULL)
+        continue;
+
+      g_array_sort_with_data (node->children, compare_build_nodes, nodes);
+      for (j = 0; j < node->children->len; j++)
+        g_array_append_val (order, g_array_index (node->children, guint, j));
+      out[i].n_children = node->children->len;
+    }
+
+  g_array_free (order, TRUE);
+
+  return data;
+}
+
+static gboolean
+validate_trie (const gchar    *data,
+               gsize           length,
+               const GStatBuf *st)
+{
+  const GtkComposeTrieHeader *header = (const GtkComposeTrieHeader *) data;
+  const GtkComposeTrieNode *nodes;
+  guint i;
+
+  if (length < sizeof (GtkComposeTrieHeader) ||
+      memcmp (header->magic, GTK_COMPOSE_TRIE_MAGIC, sizeof (header->magic)) != 0 ||
+      header->version != GTK_COMPOSE_TRIE_VERSION ||
+      header->mtime != (guint64) st->st_mtime ||
+      header->size != (guint64) st->st_size ||
+      header->n_nodes == 0 ||
+      header->n_nodes > (length - sizeof (GtkComposeTrieHeader)) / sizeof (GtkComposeTrieNode) ||
+      length != sizeof (GtkComposeTrieHeader) + header->n_nodes * sizeof (GtkComposeTrieNode))
+    return FALSE;
+
+  nodes = (const GtkComposeTrieNode *) (data + sizeof (GtkComposeTrieHeader));
+  for (i = 0; i < header->n_nodes; i++)
+    {
+      if (nodes[i].first_child > header->n_nodes ||
+          nodes[i].n_children > header->n_nodes - nodes[i].first_child ||
+          (nodes[i].value != 0 && !g_unichar_validate (nodes[i].value)))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gchar *
+get_cache_path (const gchar *path)
+{
+  gchar *dir, *checksum, *basename, *cache_path;
+
+  dir = g_build_filename (g_get_user_cache_dir (), "gtk-3.0", "compose", NULL);
+  if (g_mkdir_with_parents (dir, 0755) != 0)
+    {
+      g_free (dir);
+      return NULL;
+    }
+
+  checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, path, -1);
+  basename = g_strconcat (checksum, ".cache", NULL);
+  cache_path = g_build_filename (dir, basename, NULL);
+
+  g_free (basename);
+  g_free (checksum);
+  g_free (dir);
+
+  return cache_path;
+}
+
+static GtkComposeTrie *
+gtk_compose_trie_new (GMappedFile *map,
+                      gchar       *data)
+{
+  GtkComposeTrie *trie;
+  const gchar *contents = map ? g_mapped_file_get_contents (map) : data;
+
+  trie = g_new0 (GtkComposeTrie, 1);
+  trie->map = map;
+  trie->data = data;
+  trie->nodes = (const GtkComposeTrieNode *) (contents + sizeof (GtkComposeTrieHeader));
+  trie->n_nodes = ((const GtkComposeTrieHeader *) contents)->n_nodes;
+
+  return trie;
+}
+
+static GtkComposeTrie *
+gtk_compose_trie_load (const gchar *path)
+{
+  GStatBuf st;
+  GMappedFile *map;
+  GArray *nodes;
+  BuildNode root = { 0, 0, NULL };
+  gchar *cache_path, *data;
+  gsize length = 0;
+  gboolean empty;
+
+  if (g_stat (path, &st) != 0)
+    return NULL;
+
+  cache_path = get_cache_path (path);
+
+  if (cache_path)
+    {
+      map = g_mapped_file_new (cache_path, FALSE, NULL);
+      if (map)
+        {
+          if (validate_trie (g_mapped_file_get_contents (map),
+                             g_mapped_file_get_length (map),
+                             &st))
+            {
+              GTK_NOTE (MISC, g_print ("Using compose cache %s for %s\n", cache_path, path));
+              g_free (cache_path);
+              return gtk_compose_trie_new (map, NULL);
+            }
+
+          g_mapped_file_unref (map);
+        }
+    }
+
+  nodes = g_array_new (FALSE, FALSE, sizeof (BuildNode));
+  g_array_set_clear_func (nodes, build_node_clear);
+  g_array_append_val (nodes, root);
+
+  parse_file (nodes, path, 0);
+
+  empty = nodes->len == 1;
+  data = empty ? NULL : serialize_trie (nodes, &st, &length);
+  g_array_free (nodes, TRUE);
+
+  GTK_NOTE (MISC, g_print ("Compiled compose file %s\n", path));
+
+  /* Written to a temporary file and renamed, so that other
+   * processes never map a partial file
+   */
+  if (cache_path && data)
+    g_file_set_contents (cache_path, data, length, NULL);
+  g_free (cache_path);
+
+  if (empty)
+    return NULL;
+
+  return gtk_compose_trie_new (NULL, data);
+}
+
+static gchar *
+get_user_compose_file (void)
+{
+  const gchar *env;
+  gchar *path;
+
+  env = g_getenv ("XCOMPOSEFILE");
+  if (env && *env)
+    return g_strdup (env);
+
+  path = g_build_filename (g_get_home_dir (), ".XCompose", NULL);
+  if (g_file_test (path, G_FILE_TEST_EXISTS))
+    return path;
+
+  g_free (path);
+
+  return NULL;
+}
+
+/* Returns the compiled trie of the user's compose file, or %NULL
+ * if there is none. It is loaded on first use and kept for the
+ * lifetime of the process.
+ */
+const GtkComposeTrie *
+_gtk_compose_trie_get_user (void)
+{
+  static GtkComposeTrie *trie = NULL;
+  static gsize initialized = 0;
+
+  if (g_once_init_enter (&initialized))
+    {
+      gchar *path = get_user_compose_file ();
+
+      if (path)
+        trie = gtk_compose_trie_load (path);
+      g_free (path);
+
+      g_once_init_leave (&initialized, 1);
+    }
+
+  return trie;
+}
+
+/* Walks @keysyms down the trie. Returns %FALSE if no sequence
+ * starts with them. Otherwise @value is set to the character of
+ * the sequence ending there, or 0, and @finished to whether no
+ * longer sequence starts with them.
+ */
+gboolean
+_gtk_compose_trie_lookup (const GtkComposeTrie *trie,
+                          const guint          *keysyms,
+                          gint                  n_keysyms,
+                          gunichar             *value,
+                          gboolean             *finished)
+{
+  const GtkComposeTrieNode *node = &trie->nodes[0];
+  gint i;
+
+  for (i = 0; i < n_keysyms; i++)
+    {
+      guint lo = node->first_child;
+      guint hi = lo + node->n_children;
+      guint end = hi;
+
+      while (lo < hi)
+        {
+          guint mid = (lo + hi) / 2;
+
+          if (trie->nodes[mid].keysym < keysyms[i])
+            lo = mid + 1;
+          else
+            hi = mid;
+        }
+
+      if (lo == end || trie->nodes[lo].keysym != keysyms[i])
+        return FALSE;
+
+      node = &trie->nodes[lo];
+    }
+
+  *value = node->value;
+  *finished = node->n_children == 0;
+
+  return TRUE;
+}
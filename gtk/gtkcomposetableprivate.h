@@ -0,0 +1,37 @@
+/* GTK - The GIMP Toolkit
+ * Copyright (C) 2013 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_COMPOSE_TABLE_PRIVATE_H__
+#define __GTK_COMPOSE_TABLE_PRIVATE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GtkComposeTrie GtkComposeTrie;
+
+const GtkComposeTrie * _gtk_compose_trie_get_user  (void);
+
+gboolean               _gtk_compose_trie_lookup    (const GtkComposeTrie *trie,
+                                                    const guint          *keysyms,
+                                                    gint                  n_keysyms,
+                                                    gunichar             *value,
+                                                    gboolean             *finished);
+
+G_END_DECLS
+
+#endif /* __GTK_COMPOSE_TABLE_PRIVATE_H__ */
@@ -239,6 +239,9 @@ struct _GtkContainerPrivate
   guint resize_handler;
   GdkFrameClock *resize_clock;
 
+  /* Widgets to allocate again without a full resize */
+  GSList *reallocate_widgets;
+
   guint border_width : 16;
 
   guint has_focus_chain    : 1;
@@ -496,6 +499,8 @@ gtk_container_class_init (GtkContainerClass *class)
                   _gtk_marshal_VOID__OBJECT,
                   G_TYPE_NONE, 1,
                   GTK_TYPE_WIDGET);
+  g_signal_set_va_marshaller (container_signals[ADD], G_OBJECT_CLASS_TYPE (gobject_class),
+                              _gtk_marshal_VOID__OBJECTv);
   container_signals[REMOVE] =
     g_signal_new (I_("remove"),
                   G_OBJECT_CLASS_TYPE (gobject_class),
@@ -505,6 +510,8 @@ gtk_container_class_init (GtkContainerClass *class)
                   _gtk_marshal_VOID__OBJECT,
                   G_TYPE_NONE, 1,
                   GTK_TYPE_WIDGET);
+  g_signal_set_va_marshaller (container_signals[REMOVE], G_OBJECT_CLASS_TYPE (gobject_class),
+                              _gtk_marshal_VOID__OBJECTv);
   container_signals[CHECK_RESIZE] =
     g_signal_new (I_("check-resize"),
                   G_OBJECT_CLASS_TYPE (gobject_class),
@@ -522,6 +529,8 @@ gtk_container_class_init (GtkContainerClass *class)
                   _gtk_marshal_VOID__OBJECT,
                   G_TYPE_NONE, 1,
                   GTK_TYPE_WIDGET);
+  g_signal_set_va_marshaller (container_signals[SET_FOCUS_CHILD], G_OBJECT_CLASS_TYPE (gobject_class),
+                              _gtk_marshal_VOID__OBJECTv);
 
   g_type_class_add_private (class, sizeof (GtkContainerPrivate));
 
@@ -1376,6 +1385,12 @@ gtk_container_destroy (GtkWidget *widget)
   if (priv->restyle_pending)
     priv->restyle_pending = FALSE;
 
+  if (priv->reallocate_widgets)
+    {
+      g_slist_free_full (priv->reallocate_widgets, g_object_unref);
+      priv->reallocate_widgets = NULL;
+    }
+
   if (priv->focus_child)
     {
       g_object_unref (priv->focus_child);
@@ -1659,10 +1674,11 @@ gtk_container_idle_sizer (GdkFrameClock *clock,
   if (container->priv->restyle_pending)
     {
       GtkBitmask *empty;
-      gint64 current_time;
+      gint64 current_time, begin;
 
       empty = _gtk_bitmask_new ();
       current_time = g_get_monotonic_time ();
+      begin = gdk_profiler_begin_mark_libgtk_only ();
 
       container->priv->restyle_pending = FALSE;
       _gtk_style_context_validate (gtk_widget_get_style_context (GTK_WIDGET (container)),
@@ -1670,6 +1686,7 @@ gtk_container_idle_sizer (GdkFrameClock *clock,
                                    0,
                                    empty);
 
+      gdk_profiler_end_mark_libgtk_only (begin, "css-validation", G_OBJECT_TYPE_NAME (container));
       _gtk_bitmask_free (empty);
     }
 
@@ -1679,13 +1696,40 @@ gtk_container_idle_sizer (GdkFrameClock *clock,
    * than trying to explicitly work around them with some extra flags,
    * since it doesn't cause any actual harm.
    */
+  if (container->priv->reallocate_widgets)
+    {
+      gint64 begin = gdk_profiler_begin_mark_libgtk_only ();
+      GSList *widgets, *l;
+
+      /* Done before a pending full resize, so that widgets whose size
+       * changed after all can still join it.
+       */
+      widgets = g_slist_reverse (container->priv->reallocate_widgets);
+      container->priv->reallocate_widgets = NULL;
+
+      for (l = widgets; l; l = l->next)
+        _gtk_widget_reallocate (l->data);
+
+      g_slist_free_full (widgets, g_object_unref);
+
+      gdk_profiler_end_mark_libgtk_only (begin, "reallocation", G_OBJECT_TYPE_NAME (container));
+    }
+
   if (container->priv->resize_pending)
     {
+      gint64 begin = gdk_profiler_begin_mark_libgtk_only ();
+
       container->priv->resize_pending = FALSE;
       gtk_container_check_resize (container);
+
+      gdk_profiler_end_mark_libgtk_only (begin, "size-allocation", G_OBJECT_TYPE_NAME (container));
     }
 
-  if (!container->priv->restyle_pending && !container->priv->resize_pending)
+  _gtk_size_request_cache_report ();
+
+  if (!container->priv->restyle_pending &&
+      !container->priv->resize_pending &&
+      !container->priv->reallocate_widgets)
     {
       _gtk_container_stop_idle_sizer (container);
     }
@@ -1788,6 +1832,39 @@ _gtk_container_queue_resize_internal (GtkContainer *container,
     gtk_container_queue_resize_handler (GTK_CONTAINER (widget));
 }
 
+/* Queues @widget to be allocated again by its resize container at the
+ * next layout phase, using the allocation it got last time. Returns
+ * %FALSE if the resize container doesn't do its layout at idle, in
+ * which case a regular resize has to be queued instead.
+ */
+gboolean
+_gtk_container_queue_reallocate (GtkWidget *widget)
+{
+  GtkContainerPrivate *priv;
+  GtkWidget *parent;
+
+  parent = gtk_widget_get_parent (widget);
+  while (parent && !GTK_IS_RESIZE_CONTAINER (parent))
+    parent = gtk_widget_get_parent (parent);
+
+  if (parent == NULL ||
+      !gtk_widget_get_visible (parent) ||
+      !(gtk_widget_is_toplevel (parent) || gtk_widget_get_realized (parent)))
+    return FALSE;
+
+  priv = GTK_CONTAINER (parent)->priv;
+
+  if (priv->resize_mode != GTK_RESIZE_QUEUE)
+    return FALSE;
+
+  if (!g_slist_find (priv->reallocate_widgets, widget))
+    priv->reallocate_widgets = g_slist_prepend (priv->reallocate_widgets,
+                                                g_object_ref (widget));
+  gtk_container_start_idle_sizer (GTK_CONTAINER (parent));
+
+  return TRUE;
+}
+
 void
 _gtk_container_queue_restyle (GtkContainer *container)
 {
@@ -1837,7 +1914,9 @@ _gtk_container_resize_invalidate (GtkContainer *container)
 void
 _gtk_container_maybe_start_idle_sizer (GtkContainer *container)
 {
-  if (container->priv->restyle_pending || container->priv->resize_pending)
+  if (container->priv->restyle_pending ||
+      container->priv->resize_pending ||
+      container->priv->reallocate_widgets)
     gtk_container_start_idle_sizer (container);
 }
 
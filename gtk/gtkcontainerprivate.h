@@ -41,6 +41,7 @@ gboolean _gtk_container_get_reallocate_redraws (GtkContainer *container);
 
 void      _gtk_container_stop_idle_sizer        (GtkContainer *container);
 void      _gtk_container_maybe_start_idle_sizer (GtkContainer *container);
+gboolean  _gtk_container_queue_reallocate       (GtkWidget    *widget);
 
 G_END_DECLS
 
@@ -0,0 +1,270 @@
+/* GTK - The GIMP Toolkit
+ * Copyright (C) 2013 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkcsscacheprivate.h"
+
+#include "gtkdebug.h"
+
+#include <glib/gstdio.h>
+#include <string.h>
+
+/* The cache files are written by gtk-update-css-cache, see
+ * updatecsscache.c. They contain the text of a CSS file and of
+ * all the files it imports, in the order the parser would see
+ * it, with the @import rules and comments already resolved.
+ * Every piece of text is tagged with the file it came from so
+ * that relative urls keep resolving the same way. All numbers
+ * are big-endian.
+ *
+ * Header:
+ * 2			CARD16		MAJOR_VERSION	1
+ * 2			CARD16		MINOR_VERSION	0
+ * 4			CARD32		N_FILES
+ * 4			CARD32		FILE_LIST_OFFSET
+ * 4			CARD32		N_CHUNKS
+ * 4			CARD32		CHUNK_LIST_OFFSET
+ *
+ * FileList:
+ * N_FILES times these 16 bytes, the first file is the one the
+ * cache was built for:
+ * 4			CARD32		PATH_OFFSET
+ * 4			CARD32		MTIME_HIGH
+ * 4			CARD32		MTIME_LOW
+ * 4			CARD32		SIZE
+ *
+ * ChunkList:
+ * N_CHUNKS times these 8 bytes:
+ * 4			CARD32		FILE_INDEX
+ * 4			CARD32		TEXT_OFFSET
+ *
+ * Paths and texts are nul-terminated. The cache is only used
+ * when the modification time and size of all files match.
+ */
+
+#define MAJOR_VERSION 1
+#define MINOR_VERSION 0
+
+#define HEADER_SIZE 20
+#define FILE_SIZE 16
+#define CHUNK_SIZE 8
+
+#define GET_UINT16(cache, offset) (GUINT16_FROM_BE (*(guint16 *)((cache) + (offset))))
+#define GET_UINT32(cache, offset) (GUINT32_FROM_BE (*(guint32 *)((cache) + (offset))))
+
+struct _GtkCssCache {
+  GMappedFile *map;
+  const char *buffer;
+
+  guint n_files;
+  GFile **files;
+
+  guint n_chunks;
+  guint32 chunk_list_offset;
+};
+
+static gboolean
+gtk_css_cache_check_table (gsize   size,
+                           guint32 offset,
+                           guint32 n_entries,
+                           guint   entry_size)
+{
+  return (offset % 4) == 0 &&
+         (guint64) offset + (guint64) n_entries * entry_size <= size;
+}
+
+static gboolean
+gtk_css_cache_check_string (const char *buffer,
+                            gsize       size,
+                            guint32     offset)
+{
+  return offset < size &&
+         memchr (buffer + offset, '\0', size - offset) != NULL;
+}
+
+static gboolean
+gtk_css_cache_validate (const char *buffer,
+                        gsize       size,
+                        GFile      *file)
+{
+  guint32 n_files, file_list_offset, n_chunks, chunk_list_offset;
+  guint32 i;
+
+  if (size < HEADER_SIZE ||
+      GET_UINT16 (buffer, 0) != MAJOR_VERSION)
+    return FALSE;
+
+  n_files = GET_UINT32 (buffer, 4);
+  file_list_offset = GET_UINT32 (buffer, 8);
+  n_chunks = GET_UINT32 (buffer, 12);
+  chunk_list_offset = GET_UINT32 (buffer, 16);
+
+  if (n_files == 0 ||
+      !gtk_css_cache_check_table (size, file_list_offset, n_files, FILE_SIZE) ||
+      !gtk_css_cache_check_table (size, chunk_list_offset, n_chunks, CHUNK_SIZE))
+    return FALSE;
+
+  for (i = 0; i < n_files; i++)
+    {
+      guint32 offset = file_list_offset + i * FILE_SIZE;
+      const char *path;
+      guint64 mtime;
+      GStatBuf st;
+
+      if (!gtk_css_cache_check_string (buffer, size, GET_UINT32 (buffer, offset)))
+        return FALSE;
+
+      path = buffer + GET_UINT32 (buffer, offset);
+      mtime = ((guint64) GET_UINT32 (buffer, offset + 4) << 32) | GET_UINT32 (buffer, offset + 8);
+
+      if (g_stat (path, &st) < 0 ||
+          (guint64) st.st_mtime != mtime ||
+          (guint64) st.st_size != GET_UINT32 (buffer, offset + 12))
+        return FALSE;
+
+      if (i == 0)
+        {
+          GFile *cached = g_file_new_for_path (path);
+          gboolean equal = g_file_equal (cached, file);
+
+          g_object_unref (cached);
+          if (!equal)
+            return FALSE;
+        }
+    }
+
+  for (i = 0; i < n_chunks; i++)
+    {
+      guint32 offset = chunk_list_offset + i * CHUNK_SIZE;
+
+      if (GET_UINT32 (buffer, offset) >= n_files ||
+          !gtk_css_cache_check_string (buffer, size, GET_UINT32 (buffer, offset + 4)))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/*
+ * _gtk_css_cache_new_for_file:
+ * @file: the CSS file to look up a cache for
+ *
+ * Maps the cache file next to @file, if there is one and it is
+ * up to date with @file and everything @file imports.
+ *
+ * Returns: a new cache or %NULL
+ */
+GtkCssCache *
+_gtk_css_cache_new_for_file (GFile *file)
+{
+  GtkCssCache *cache;
+  GMappedFile *map;
+  char *path, *cache_path;
+  const char *buffer;
+  gsize size;
+
+  if (gtk_get_debug_flags () & GTK_DEBUG_NO_CSS_CACHE)
+    return NULL;
+
+  path = g_file_get_path (file);
+  if (path == NULL)
+    return NULL;
+
+  cache_path = g_strconcat (path, ".cache", NULL);
+  g_free (path);
+
+  map = g_mapped_file_new (cache_path, FALSE, NULL);
+  g_free (cache_path);
+  if (map == NULL)
+    return NULL;
+
+  buffer = g_mapped_file_get_contents (map);
+  size = g_mapped_file_get_length (map);
+
+  if (!gtk_css_cache_validate (buffer, size, file))
+    {
+      g_mapped_file_unref (map);
+      return NULL;
+    }
+
+  cache = g_slice_new0 (GtkCssCache);
+  cache->map = map;
+  cache->buffer = buffer;
+  cache->n_files = GET_UINT32 (buffer, 4);
+  cache->files = g_new0 (GFile *, cache->n_files);
+  cache->n_chunks = GET_UINT32 (buffer, 12);
+  cache->chunk_list_offset = GET_UINT32 (buffer, 16);
+
+  return cache;
+}
+
+void
+_gtk_css_cache_free (GtkCssCache *cache)
+{
+  guint i;
+
+  for (i = 0; i < cache->n_files; i++)
+    {
+      if (cache->files[i])
+        g_object_unref (cache->files[i]);
+    }
+  g_free (cache->files);
+
+  g_mapped_file_unref (cache->map);
+
+  g_slice_free (GtkCssCache, cache);
+}
+
+guint
+_gtk_css_cache_get_n_chunks (GtkCssCache *cache)
+{
+  return cache->n_chunks;
+}
+
+/*
+ * _gtk_css_cache_get_chunk:
+ * @cache: a cache
+ * @i: index of the chunk
+ * @file: (out) (transfer none): return location for the file
+ *   the text was read from
+ *
+ * Returns: (transfer none): the text of the chunk. It is owned
+ *   by @cache and points directly into the mapped file.
+ */
+const char *
+_gtk_css_cache_get_chunk (GtkCssCache  *cache,
+                          guint         i,
+                          GFile       **file)
+{
+  guint32 offset, file_index, file_offset;
+
+  g_return_val_if_fail (i < cache->n_chunks, NULL);
+
+  offset = cache->chunk_list_offset + i * CHUNK_SIZE;
+  file_index = GET_UINT32 (cache->buffer, offset);
+
+  if (cache->files[file_index] == NULL)
+    {
+      file_offset = GET_UINT32 (cache->buffer, 8) + file_index * FILE_SIZE;
+      cache->files[file_index] = g_file_new_for_path (cache->buffer + GET_UINT32 (cache->buffer, file_offset));
+    }
+
+  *file = cache->files[file_index];
+
+  return cache->buffer + GET_UINT32 (cache->buffer, offset + 4);
+}
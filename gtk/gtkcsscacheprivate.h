@@ -0,0 +1,37 @@
+/* GTK - The GIMP Toolkit
+ * Copyright (C) 2013 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_CSS_CACHE_PRIVATE_H__
+#define __GTK_CSS_CACHE_PRIVATE_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GtkCssCache GtkCssCache;
+
+GtkCssCache *   _gtk_css_cache_new_for_file       (GFile                 *file);
+void            _gtk_css_cache_free               (GtkCssCache           *cache);
+
+guint           _gtk_css_cache_get_n_chunks       (GtkCssCache           *cache);
+const char *    _gtk_css_cache_get_chunk          (GtkCssCache           *cache,
+                                                   guint                  i,
+                                                   GFile                **file);
+
+G_END_DECLS
+
+#endif /* __GTK_CSS_CACHE_PRIVATE_H__ */
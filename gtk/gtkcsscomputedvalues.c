@@ -20,6 +20,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include "gtkprivate.h"
 #include "gtkcsscomputedvaluesprivate.h"
 
@@ -33,6 +35,7 @@
 #include "gtkcssstringvalueprivate.h"
 #include "gtkcssstylepropertyprivate.h"
 #include "gtkcsstransitionprivate.h"
+#include "gtkdebug.h"
 #include "gtkstyleanimationprivate.h"
 #include "gtkstylepropertiesprivate.h"
 #include "gtkstylepropertyprivate.h"
@@ -40,15 +43,346 @@
 
 G_DEFINE_TYPE (GtkCssComputedValues, _gtk_css_computed_values, G_TYPE_OBJECT)
 
+/* VALUE BLOCKS */
+
+struct _GtkCssValueBlock
+{
+  guint                 ref_count;
+  guint                 type     : 8;
+  guint                 interned : 1;
+  guint                 n_values;
+  GtkCssValue          *values[1];
+};
+
+#define GTK_CSS_VALUE_BLOCK_SIZE(n_values) (G_STRUCT_OFFSET (GtkCssValueBlock, values) + (n_values) * sizeof (GtkCssValue *))
+
+/* maps property ids to their slot and back, set up in class_init */
+static guint8 property_block[GTK_CSS_PROPERTY_N_PROPERTIES];
+static guint8 property_index[GTK_CSS_PROPERTY_N_PROPERTIES];
+static guint8 block_properties[GTK_CSS_VALUE_BLOCK_N_BLOCKS][GTK_CSS_PROPERTY_N_PROPERTIES];
+static guint  block_n_properties[GTK_CSS_VALUE_BLOCK_N_BLOCKS];
+
+static GHashTable *interned_blocks = NULL;
+
+static GtkCssValueBlockType
+gtk_css_value_block_type_for_property (guint id)
+{
+  switch (id)
+    {
+    case GTK_CSS_PROPERTY_COLOR:
+    case GTK_CSS_PROPERTY_BACKGROUND_COLOR:
+    case GTK_CSS_PROPERTY_BORDER_TOP_COLOR:
+    case GTK_CSS_PROPERTY_BORDER_RIGHT_COLOR:
+    case GTK_CSS_PROPERTY_BORDER_BOTTOM_COLOR:
+    case GTK_CSS_PROPERTY_BORDER_LEFT_COLOR:
+    case GTK_CSS_PROPERTY_OUTLINE_COLOR:
+      return GTK_CSS_VALUE_BLOCK_COLOR;
+
+    case GTK_CSS_PROPERTY_FONT_SIZE:
+    case GTK_CSS_PROPERTY_FONT_FAMILY:
+    case GTK_CSS_PROPERTY_FONT_STYLE:
+    case GTK_CSS_PROPERTY_FONT_VARIANT:
+    case GTK_CSS_PROPERTY_FONT_WEIGHT:
+    case GTK_CSS_PROPERTY_TEXT_SHADOW:
+    case GTK_CSS_PROPERTY_ICON_SHADOW:
+      return GTK_CSS_VALUE_BLOCK_FONT;
+
+    case GTK_CSS_PROPERTY_MARGIN_TOP:
+    case GTK_CSS_PROPERTY_MARGIN_LEFT:
+    case GTK_CSS_PROPERTY_MARGIN_BOTTOM:
+    case GTK_CSS_PROPERTY_MARGIN_RIGHT:
+    case GTK_CSS_PROPERTY_PADDING_TOP:
+    case GTK_CSS_PROPERTY_PADDING_LEFT:
+    case GTK_CSS_PROPERTY_PADDING_BOTTOM:
+    case GTK_CSS_PROPERTY_PADDING_RIGHT:
+    case GTK_CSS_PROPERTY_BORDER_TOP_WIDTH:
+    case GTK_CSS_PROPERTY_BORDER_LEFT_WIDTH:
+    case GTK_CSS_PROPERTY_BORDER_BOTTOM_WIDTH:
+    case GTK_CSS_PROPERTY_BORDER_RIGHT_WIDTH:
+      return GTK_CSS_VALUE_BLOCK_BOX;
+
+    case GTK_CSS_PROPERTY_BOX_SHADOW:
+    case GTK_CSS_PROPERTY_BORDER_TOP_STYLE:
+    case GTK_CSS_PROPERTY_BORDER_LEFT_STYLE:
+    case GTK_CSS_PROPERTY_BORDER_BOTTOM_STYLE:
+    case GTK_CSS_PROPERTY_BORDER_RIGHT_STYLE:
+    case GTK_CSS_PROPERTY_BORDER_TOP_LEFT_RADIUS:
+    case GTK_CSS_PROPERTY_BORDER_TOP_RIGHT_RADIUS:
+    case GTK_CSS_PROPERTY_BORDER_BOTTOM_RIGHT_RADIUS:
+    case GTK_CSS_PROPERTY_BORDER_BOTTOM_LEFT_RADIUS:
+    case GTK_CSS_PROPERTY_OUTLINE_STYLE:
+    case GTK_CSS_PROPERTY_OUTLINE_WIDTH:
+    case GTK_CSS_PROPERTY_OUTLINE_OFFSET:
+    case GTK_CSS_PROPERTY_BORDER_IMAGE_SOURCE:
+    case GTK_CSS_PROPERTY_BORDER_IMAGE_REPEAT:
+    case GTK_CSS_PROPERTY_BORDER_IMAGE_SLICE:
+    case GTK_CSS_PROPERTY_BORDER_IMAGE_WIDTH:
+      return GTK_CSS_VALUE_BLOCK_BORDER;
+
+    case GTK_CSS_PROPERTY_BACKGROUND_CLIP:
+    case GTK_CSS_PROPERTY_BACKGROUND_ORIGIN:
+    case GTK_CSS_PROPERTY_BACKGROUND_SIZE:
+    case GTK_CSS_PROPERTY_BACKGROUND_POSITION:
+    case GTK_CSS_PROPERTY_BACKGROUND_REPEAT:
+    case GTK_CSS_PROPERTY_BACKGROUND_IMAGE:
+      return GTK_CSS_VALUE_BLOCK_BACKGROUND;
+
+    case GTK_CSS_PROPERTY_TRANSITION_PROPERTY:
+    case GTK_CSS_PROPERTY_TRANSITION_DURATION:
+    case GTK_CSS_PROPERTY_TRANSITION_TIMING_FUNCTION:
+    case GTK_CSS_PROPERTY_TRANSITION_DELAY:
+    case GTK_CSS_PROPERTY_ANIMATION_NAME:
+    case GTK_CSS_PROPERTY_ANIMATION_DURATION:
+    case GTK_CSS_PROPERTY_ANIMATION_TIMING_FUNCTION:
+    case GTK_CSS_PROPERTY_ANIMATION_ITERATION_COUNT:
+    case GTK_CSS_PROPERTY_ANIMATION_DIRECTION:
+    case GTK_CSS_PROPERTY_ANIMATION_PLAY_STATE:
+    case GTK_CSS_PROPERTY_ANIMATION_DELAY:
+    case GTK_CSS_PROPERTY_ANIMATION_FILL_MODE:
+      return GTK_CSS_VALUE_BLOCK_ANIMATION;
+
+    default:
+      return GTK_CSS_VALUE_BLOCK_OTHER;
+    }
+}
+
+static void
+gtk_css_value_blocks_init (void)
+{
+  guint id, block;
+
+  for (id = 0; id < GTK_CSS_PROPERTY_N_PROPERTIES; id++)
+    {
+      block = gtk_css_value_block_type_for_property (id);
+
+      property_block[id] = block;
+      property_index[id] = block_n_properties[block];
+      block_properties[block][block_n_properties[block]] = id;
+      block_n_properties[block]++;
+    }
+}
+
+static inline void
+gtk_css_value_block_get_slot (guint  id,
+                              guint *block,
+                              guint *index)
+{
+  if (G_LIKELY (id < GTK_CSS_PROPERTY_N_PROPERTIES))
+    {
+      *block = property_block[id];
+      *index = property_index[id];
+    }
+  else
+    {
+      /* custom properties go at the end of the "other" block */
+      *block = GTK_CSS_VALUE_BLOCK_OTHER;
+      *index = block_n_properties[GTK_CSS_VALUE_BLOCK_OTHER] + id - GTK_CSS_PROPERTY_N_PROPERTIES;
+    }
+}
+
+static guint
+gtk_css_value_block_get_property (guint block,
+                                  guint index)
+{
+  if (index < block_n_properties[block])
+    return block_properties[block][index];
+
+  g_assert (block == GTK_CSS_VALUE_BLOCK_OTHER);
+
+  return GTK_CSS_PROPERTY_N_PROPERTIES + index - block_n_properties[block];
+}
+
+static guint
+gtk_css_value_block_get_default_size (guint block)
+{
+  if (block == GTK_CSS_VALUE_BLOCK_OTHER)
+    return block_n_properties[block] + _gtk_css_style_property_get_n_properties () - GTK_CSS_PROPERTY_N_PROPERTIES;
+
+  return block_n_properties[block];
+}
+
+static GtkCssValueBlock *
+gtk_css_value_block_new (guint block_type,
+                         guint n_values)
+{
+  GtkCssValueBlock *block;
+
+  block = g_slice_alloc0 (GTK_CSS_VALUE_BLOCK_SIZE (n_values));
+  block->ref_count = 1;
+  block->type = block_type;
+  block->n_values = n_values;
+
+  return block;
+}
+
+static GtkCssValueBlock *
+gtk_css_value_block_copy (const GtkCssValueBlock *block,
+                          guint                   n_values)
+{
+  GtkCssValueBlock *copy;
+  guint i;
+
+  copy = gtk_css_value_block_new (block->type, MAX (n_values, block->n_values));
+
+  for (i = 0; i < block->n_values; i++)
+    {
+      if (block->values[i])
+        copy->values[i] = _gtk_css_value_ref (block->values[i]);
+    }
+
+  return copy;
+}
+
+static GtkCssValueBlock *
+gtk_css_value_block_ref (GtkCssValueBlock *block)
+{
+  block->ref_count++;
+
+  return block;
+}
+
+static void
+gtk_css_value_block_unref (GtkCssValueBlock *block)
+{
+  guint i;
+
+  block->ref_count--;
+  if (block->ref_count > 0)
+    return;
+
+  if (block->interned)
+    g_hash_table_remove (interned_blocks, block);
+
+  for (i = 0; i < block->n_values; i++)
+    {
+      if (block->values[i])
+        _gtk_css_value_unref (block->values[i]);
+    }
+
+  g_slice_free1 (GTK_CSS_VALUE_BLOCK_SIZE (block->n_values), block);
+}
+
+/* Values are usually not copied when computing, so identical
+ * declarations result in identical pointers. Comparing pointers
+ * is therefore good enough to find almost all duplicate blocks. */
+static guint
+gtk_css_value_block_hash (gconstpointer data)
+{
+  const GtkCssValueBlock *block = data;
+  guint i, hash;
+
+  hash = block->type;
+  for (i = 0; i < block->n_values; i++)
+    hash = (hash << 5) - hash + GPOINTER_TO_UINT (block->values[i]);
+
+  return hash;
+}
+
+static gboolean
+gtk_css_value_block_equal (gconstpointer data1,
+                           gconstpointer data2)
+{
+  const GtkCssValueBlock *block1 = data1;
+  const GtkCssValueBlock *block2 = data2;
+
+  return block1->type == block2->type &&
+         block1->n_values == block2->n_values &&
+         memcmp (block1->values, block2->values, block1->n_values * sizeof (GtkCssValue *)) == 0;
+}
+
+static GtkCssValueBlock *
+gtk_css_value_block_intern (GtkCssValueBlock *block)
+{
+  GtkCssValueBlock *interned;
+
+  if (block->interned)
+    return block;
+
+  if (G_UNLIKELY (interned_blocks == NULL))
+    interned_blocks = g_hash_table_new (gtk_css_value_block_hash, gtk_css_value_block_equal);
+
+  interned = g_hash_table_lookup (interned_blocks, block);
+  if (interned)
+    {
+      gtk_css_value_block_ref (interned);
+      gtk_css_value_block_unref (block);
+      return interned;
+    }
+
+  block->interned = TRUE;
+  g_hash_table_add (interned_blocks, block);
+
+  return block;
+}
+
+/* Returns a block for @values that can be modified and has room for @index */
+static GtkCssValueBlock *
+gtk_css_computed_values_get_writable_block (GtkCssComputedValues *values,
+                                            guint                 block_type,
+                                            guint                 index)
+{
+  GtkCssValueBlock *block = values->blocks[block_type];
+
+  if (block == NULL)
+    {
+      block = gtk_css_value_block_new (block_type,
+                                       MAX (index + 1, gtk_css_value_block_get_default_size (block_type)));
+    }
+  else if (block->ref_count > 1 || index >= block->n_values)
+    {
+      GtkCssValueBlock *copy = gtk_css_value_block_copy (block, index + 1);
+
+      gtk_css_value_block_unref (block);
+      block = copy;
+    }
+  else if (block->interned)
+    {
+      /* we're the only user, so we can just take it back */
+      g_hash_table_remove (interned_blocks, block);
+      block->interned = FALSE;
+    }
+
+  values->blocks[block_type] = block;
+
+  return block;
+}
+
+/*
+ * _gtk_css_computed_values_intern_blocks:
+ * @values: the values
+ *
+ * Replaces all blocks of @values with identical blocks already in use
+ * by other values, so the memory can be shared. Call this after all
+ * values have been set. Setting values afterwards is still possible but
+ * will cause the modified blocks to be copied.
+ */
+void
+_gtk_css_computed_values_intern_blocks (GtkCssComputedValues *values)
+{
+  guint i;
+
+  gtk_internal_return_if_fail (GTK_IS_CSS_COMPUTED_VALUES (values));
+
+  for (i = 0; i < GTK_CSS_VALUE_BLOCK_N_BLOCKS; i++)
+    {
+      if (values->blocks[i])
+        values->blocks[i] = gtk_css_value_block_intern (values->blocks[i]);
+    }
+}
+
 static void
 gtk_css_computed_values_dispose (GObject *object)
 {
   GtkCssComputedValues *values = GTK_CSS_COMPUTED_VALUES (object);
+  guint i;
 
-  if (values->values)
+  for (i = 0; i < GTK_CSS_VALUE_BLOCK_N_BLOCKS; i++)
     {
-      g_ptr_array_unref (values->values);
-      values->values = NULL;
+      if (values->blocks[i])
+        {
+          gtk_css_value_block_unref (values->blocks[i]);
+          values->blocks[i] = NULL;
+        }
     }
   if (values->sections)
     {
@@ -77,6 +411,8 @@ gtk_css_computed_values_finalize (GObject *object)
   _gtk_bitmask_free (values->depends_on_color);
   _gtk_bitmask_free (values->depends_on_font_size);
 
+  _gtk_counter_add (GTK_COUNTER_CSS_COMPUTED_VALUES, -1);
+
   G_OBJECT_CLASS (_gtk_css_computed_values_parent_class)->finalize (object);
 }
 
@@ -87,6 +423,8 @@ _gtk_css_computed_values_class_init (GtkCssComputedValuesClass *klass)
 
   object_class->dispose = gtk_css_computed_values_dispose;
   object_class->finalize = gtk_css_computed_values_finalize;
+
+  gtk_css_value_blocks_init ();
 }
 
 static void
@@ -96,6 +434,8 @@ _gtk_css_computed_values_init (GtkCssComputedValues *values)
   values->equals_parent = _gtk_bitmask_new ();
   values->depends_on_color = _gtk_bitmask_new ();
   values->depends_on_font_size = _gtk_bitmask_new ();
+
+  _gtk_counter_add (GTK_COUNTER_CSS_COMPUTED_VALUES, 1);
 }
 
 GtkCssComputedValues *
@@ -137,7 +477,22 @@ _gtk_css_computed_values_compute_value (GtkCssComputedValues    *values,
       GtkCssStyleProperty *prop = _gtk_css_style_property_lookup_by_id (id);
 
       if (_gtk_css_style_property_is_inherit (prop))
-        specified = _gtk_css_inherit_value_new ();
+        {
+          /* Most inherited properties are not set for most widgets.
+           * Take the parent's value directly, it's what computing
+           * 'inherit' would do, too. */
+          if (parent_values)
+            {
+              _gtk_css_computed_values_set_value (values,
+                                                  id,
+                                                  _gtk_css_computed_values_get_value (parent_values, id),
+                                                  GTK_CSS_EQUALS_PARENT,
+                                                  section);
+              return;
+            }
+
+          specified = _gtk_css_inherit_value_new ();
+        }
       else
         specified = _gtk_css_initial_value_new ();
     }
@@ -178,17 +533,23 @@ _gtk_css_computed_values_set_value (GtkCssComputedValues *values,
                                     GtkCssDependencies    dependencies,
                                     GtkCssSection        *section)
 {
+  GtkCssValueBlock *block;
+  guint block_type, index;
+
   gtk_internal_return_if_fail (GTK_IS_CSS_COMPUTED_VALUES (values));
 
-  if (values->values == NULL)
-    values->values = g_ptr_array_new_full (_gtk_css_style_property_get_n_properties (),
-					   (GDestroyNotify)_gtk_css_value_unref);
-  if (id >= values->values->len)
-   g_ptr_array_set_size (values->values, id + 1);
+  gtk_css_value_block_get_slot (id, &block_type, &index);
+  block = values->blocks[block_type];
 
-  if (g_ptr_array_index (values->values, id))
-    _gtk_css_value_unref (g_ptr_array_index (values->values, id));
-  g_ptr_array_index (values->values, id) = _gtk_css_value_ref (value);
+  /* setting the same value again is common when updating, don't copy
+   * a shared block for it */
+  if (block == NULL || index >= block->n_values || block->values[index] != value)
+    {
+      block = gtk_css_computed_values_get_writable_block (values, block_type, index);
+      if (block->values[index])
+        _gtk_css_value_unref (block->values[index]);
+      block->values[index] = _gtk_css_value_ref (value);
+    }
 
   if (dependencies & (GTK_CSS_DEPENDS_ON_PARENT | GTK_CSS_EQUALS_PARENT))
     values->depends_on_parent = _gtk_bitmask_set (values->depends_on_parent, id, TRUE);
@@ -205,7 +566,9 @@ _gtk_css_computed_values_set_value (GtkCssComputedValues *values,
       g_ptr_array_index (values->sections, id) = NULL;
     }
 
-  if (section)
+  /* Tracking sections is expensive and only useful for debugging,
+   * so only do it when asked for. */
+  if (section && G_UNLIKELY (gtk_get_debug_flags () & GTK_DEBUG_CSS_SECTIONS))
     {
       if (values->sections == NULL)
         values->sections = g_ptr_array_new_with_free_func (maybe_unref_section);
@@ -234,13 +597,19 @@ GtkCssValue *
 _gtk_css_computed_values_get_intrinsic_value (GtkCssComputedValues *values,
                                               guint                 id)
 {
+  GtkCssValueBlock *block;
+  guint block_type, index;
+
   gtk_internal_return_val_if_fail (GTK_IS_CSS_COMPUTED_VALUES (values), NULL);
 
-  if (values->values == NULL ||
-      id >= values->values->len)
+  gtk_css_value_block_get_slot (id, &block_type, &index);
+  block = values->blocks[block_type];
+
+  if (block == NULL ||
+      index >= block->n_values)
     return NULL;
 
-  return g_ptr_array_index (values->values, id);
+  return block->values[index];
 }
 
 GtkCssSection *
@@ -261,18 +630,31 @@ _gtk_css_computed_values_get_difference (GtkCssComputedValues *values,
                                          GtkCssComputedValues *other)
 {
   GtkBitmask *result;
-  guint i, len;
+  guint b, i;
 
-  len = MIN (values->values->len, other->values->len);
   result = _gtk_bitmask_new ();
-  if (values->values->len != other->values->len)
-    result = _gtk_bitmask_invert_range (result, len, MAX (values->values->len, other->values->len));
-  
-  for (i = 0; i < len; i++)
+
+  for (b = 0; b < GTK_CSS_VALUE_BLOCK_N_BLOCKS; b++)
     {
-      if (!_gtk_css_value_equal (g_ptr_array_index (values->values, i),
-                                 g_ptr_array_index (other->values, i)))
-        result = _gtk_bitmask_set (result, i, TRUE);
+      GtkCssValueBlock *block = values->blocks[b];
+      GtkCssValueBlock *other_block = other->blocks[b];
+      guint len;
+
+      /* shared blocks are identical, no need to look at them */
+      if (block == other_block)
+        continue;
+
+      len = MAX (block ? block->n_values : 0, other_block ? other_block->n_values : 0);
+      for (i = 0; i < len; i++)
+        {
+          GtkCssValue *value, *other_value;
+
+          value = block && i < block->n_values ? block->values[i] : NULL;
+          other_value = other_block && i < other_block->n_values ? other_block->values[i] : NULL;
+
+          if (!_gtk_css_value_equal0 (value, other_value))
+            result = _gtk_bitmask_set (result, gtk_css_value_block_get_property (b, i), TRUE);
+        }
     }
 
   return result;
@@ -595,6 +977,52 @@ _gtk_css_computed_values_is_static (GtkCssComputedValues *values)
   return TRUE;
 }
 
+/*
+ * _gtk_css_computed_values_may_animate:
+ * @values: the values to check
+ *
+ * Checks if _gtk_css_computed_values_create_animations() could ever
+ * create any animations or transitions for @values. If it cannot,
+ * @values will never change after being computed and can be shared.
+ *
+ * Returns: %TRUE if @values specifies animations or transitions
+ */
+gboolean
+_gtk_css_computed_values_may_animate (GtkCssComputedValues *values)
+{
+  GtkCssValue *animations, *transitions, *durations, *delays;
+  guint i;
+
+  gtk_internal_return_val_if_fail (GTK_IS_CSS_COMPUTED_VALUES (values), TRUE);
+
+  if (values->animations)
+    return TRUE;
+
+  animations = _gtk_css_computed_values_get_intrinsic_value (values, GTK_CSS_PROPERTY_ANIMATION_NAME);
+  for (i = 0; i < _gtk_css_array_value_get_n_values (animations); i++)
+    {
+      const char *name = _gtk_css_ident_value_get (_gtk_css_array_value_get_nth (animations, i));
+
+      if (g_ascii_strcasecmp (name, "none") != 0)
+        return TRUE;
+    }
+
+  transitions = _gtk_css_computed_values_get_intrinsic_value (values, GTK_CSS_PROPERTY_TRANSITION_PROPERTY);
+  durations = _gtk_css_computed_values_get_intrinsic_value (values, GTK_CSS_PROPERTY_TRANSITION_DURATION);
+  delays = _gtk_css_computed_values_get_intrinsic_value (values, GTK_CSS_PROPERTY_TRANSITION_DELAY);
+  for (i = 0; i < _gtk_css_array_value_get_n_values (transitions); i++)
+    {
+      double duration, delay;
+
+      duration = _gtk_css_number_value_get (_gtk_css_array_value_get_nth (durations, i), 100);
+      delay = _gtk_css_number_value_get (_gtk_css_array_value_get_nth (delays, i), 100);
+      if (duration + delay != 0.0)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
 void
 _gtk_css_computed_values_cancel_animations (GtkCssComputedValues *values)
 {
@@ -610,6 +1038,60 @@ _gtk_css_computed_values_cancel_animations (GtkCssComputedValues *values)
   values->animations = NULL;
 }
 
+/*
+ * _gtk_css_computed_values_update_inherited:
+ * @values: the values to update
+ * @parent_values: the new values of the parent
+ * @changes: (transfer full): the properties that need to be updated
+ *
+ * Updates all properties in @changes that are defined to be equal to
+ * the parent's value by copying them from @parent_values. This avoids
+ * doing a full lookup for properties that are only inherited.
+ *
+ * Returns: (transfer full): the properties from @changes that still
+ *     need to be computed
+ */
+GtkBitmask *
+_gtk_css_computed_values_update_inherited (GtkCssComputedValues *values,
+                                           GtkCssComputedValues *parent_values,
+                                           GtkBitmask           *changes)
+{
+  guint i, n;
+
+  gtk_internal_return_val_if_fail (GTK_IS_CSS_COMPUTED_VALUES (values), changes);
+  gtk_internal_return_val_if_fail (GTK_IS_CSS_COMPUTED_VALUES (parent_values), changes);
+
+  n = _gtk_css_style_property_get_n_properties ();
+  for (i = 0; i < n; i++)
+    {
+      GtkCssSection *section;
+
+      if (!_gtk_bitmask_get (changes, i) ||
+          !_gtk_bitmask_get (values->equals_parent, i))
+        continue;
+
+      /* _gtk_css_computed_values_set_value() drops the old section first */
+      section = _gtk_css_computed_values_get_section (values, i);
+      if (section)
+        gtk_css_section_ref (section);
+
+      _gtk_css_computed_values_set_value (values,
+                                          i,
+                                          _gtk_css_computed_values_get_value (parent_values, i),
+                                          GTK_CSS_EQUALS_PARENT,
+                                          section);
+
+      if (section)
+        gtk_css_section_unref (section);
+
+      changes = _gtk_bitmask_set (changes, i, FALSE);
+    }
+
+  _gtk_css_computed_values_intern_blocks (values);
+
+  return changes;
+}
+
 GtkBitmask *
 _gtk_css_computed_values_compute_dependencies (GtkCssComputedValues *values,
                                                const GtkBitmask     *parent_changes)
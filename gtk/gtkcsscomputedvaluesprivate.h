@@ -38,13 +38,30 @@ G_BEGIN_DECLS
 
 /* typedef struct _GtkCssComputedValues           GtkCssComputedValues; */
 typedef struct _GtkCssComputedValuesClass      GtkCssComputedValuesClass;
+typedef struct _GtkCssValueBlock               GtkCssValueBlock;
+
+/* Properties are grouped into blocks that are likely to change together.
+ * Blocks are immutable once interned, so styles that only differ in a few
+ * properties share all blocks of the properties they don't differ in.
+ */
+typedef enum {
+  GTK_CSS_VALUE_BLOCK_COLOR,
+  GTK_CSS_VALUE_BLOCK_FONT,
+  GTK_CSS_VALUE_BLOCK_BOX,
+  GTK_CSS_VALUE_BLOCK_BORDER,
+  GTK_CSS_VALUE_BLOCK_BACKGROUND,
+  GTK_CSS_VALUE_BLOCK_ANIMATION,
+  GTK_CSS_VALUE_BLOCK_OTHER,            /* also contains custom properties */
+  /* add more */
+  GTK_CSS_VALUE_BLOCK_N_BLOCKS
+} GtkCssValueBlockType;
 
 struct _GtkCssComputedValues
 {
   GObject parent;
 
-  GPtrArray             *values;               /* the unanimated (aka intrinsic) values */
-  GPtrArray             *sections;             /* sections the values are defined in */
+  GtkCssValueBlock      *blocks[GTK_CSS_VALUE_BLOCK_N_BLOCKS]; /* the unanimated (aka intrinsic) values */
+  GPtrArray             *sections;             /* sections the values are defined in, only kept with GTK_DEBUG=css-sections */
 
   GPtrArray             *animated_values;      /* NULL or array of animated values/NULL if not animated */
   gint64                 current_time;         /* the current time in our world */
@@ -91,6 +108,9 @@ GtkBitmask *            _gtk_css_computed_values_get_difference       (GtkCssCom
                                                                        GtkCssComputedValues     *other);
 GtkBitmask *            _gtk_css_computed_values_compute_dependencies (GtkCssComputedValues     *values,
                                                                        const GtkBitmask         *parent_changes);
+GtkBitmask *            _gtk_css_computed_values_update_inherited     (GtkCssComputedValues     *values,
+                                                                       GtkCssComputedValues     *parent_values,
+                                                                       GtkBitmask               *changes);
 
 void                    _gtk_css_computed_values_create_animations    (GtkCssComputedValues     *values,
                                                                        GtkCssComputedValues     *parent_values,
@@ -102,6 +122,9 @@ GtkBitmask *            _gtk_css_computed_values_advance              (GtkCssCom
                                                                        gint64                    timestamp);
 void                    _gtk_css_computed_values_cancel_animations    (GtkCssComputedValues     *values);
 gboolean                _gtk_css_computed_values_is_static            (GtkCssComputedValues     *values);
+gboolean                _gtk_css_computed_values_may_animate          (GtkCssComputedValues     *values);
+
+void                    _gtk_css_computed_values_intern_blocks        (GtkCssComputedValues     *values);
 
 G_END_DECLS
 
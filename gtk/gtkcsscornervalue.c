@@ -27,9 +27,34 @@ struct _GtkCssValue {
   GtkCssValue *y;
 };
 
+/* Corners are interned by the pointers of their radii. As numbers
+ * are interned, too, that shares all corners with equal radii.
+ */
+static GHashTable *corner_values = NULL;
+
+static guint
+gtk_css_value_corner_hash (gconstpointer data)
+{
+  const GtkCssValue *corner = data;
+
+  return g_direct_hash (corner->x) ^ (g_direct_hash (corner->y) << 1);
+}
+
+static gboolean
+gtk_css_value_corner_hash_equal (gconstpointer a,
+                                 gconstpointer b)
+{
+  const GtkCssValue *corner1 = a;
+  const GtkCssValue *corner2 = b;
+
+  return corner1->x == corner2->x && corner1->y == corner2->y;
+}
+
 static void
 gtk_css_value_corner_free (GtkCssValue *value)
 {
+  g_hash_table_remove (corner_values, value);
+
   _gtk_css_value_unref (value->x);
   _gtk_css_value_unref (value->y);
 
@@ -114,12 +139,28 @@ GtkCssValue *
 _gtk_css_corner_value_new (GtkCssValue *x,
                            GtkCssValue *y)
 {
-  GtkCssValue *result;
+  GtkCssValue key, *result;
+
+  if (G_UNLIKELY (corner_values == NULL))
+    corner_values = g_hash_table_new (gtk_css_value_corner_hash,
+                                      gtk_css_value_corner_hash_equal);
+
+  key.x = x;
+  key.y = y;
+  result = g_hash_table_lookup (corner_values, &key);
+  if (result)
+    {
+      _gtk_css_value_unref (x);
+      _gtk_css_value_unref (y);
+      return _gtk_css_value_ref (result);
+    }
 
   result = _gtk_css_value_new (GtkCssValue, &GTK_CSS_VALUE_CORNER);
   result->x = x;
   result->y = y;
 
+  g_hash_table_add (corner_values, result);
+
   return result;
 }
 
@@ -129,43 +129,53 @@ gtk_css_image_linear_compute_start_point (double angle_in_degrees,
 }
                                          
 static void
-gtk_css_image_linear_draw (GtkCssImage        *image,
-                           cairo_t            *cr,
-                           double              width,
-                           double              height)
+gtk_css_image_linear_get_start_point (GtkCssImageLinear *linear,
+                                      double             width,
+                                      double             height,
+                                      double            *x,
+                                      double            *y)
 {
-  GtkCssImageLinear *linear = GTK_CSS_IMAGE_LINEAR (image);
-  cairo_pattern_t *pattern;
-  double x, y; /* coordinates of start point */
-  double length; /* distance in pixels for 100% */
-  double start, end; /* position of first/last point on gradient line - with gradient line being [0, 1] */
-  double offset;
-  int i, last;
-
   if (_gtk_css_number_value_get_unit (linear->angle) == GTK_CSS_NUMBER)
     {
       guint side = _gtk_css_number_value_get (linear->angle, 100);
 
       if (side & (1 << GTK_CSS_RIGHT))
-        x = width;
+        *x = width;
       else if (side & (1 << GTK_CSS_LEFT))
-        x = -width;
+        *x = -width;
       else
-        x = 0;
+        *x = 0;
 
       if (side & (1 << GTK_CSS_TOP))
-        y = -height;
+        *y = -height;
       else if (side & (1 << GTK_CSS_BOTTOM))
-        y = height;
+        *y = height;
       else
-        y = 0;
+        *y = 0;
     }
   else
     {
       gtk_css_image_linear_compute_start_point (_gtk_css_number_value_get (linear->angle, 100),
                                                 width, height,
-                                                &x, &y);
+                                                x, y);
     }
+}
+
+/* Fills @width x @height with the gradient whose line goes from
+ * (-@x/2, -@y/2) to (@x/2, @y/2) around the center. */
+static void
+gtk_css_image_linear_paint (GtkCssImageLinear *linear,
+                            cairo_t           *cr,
+                            double             x,
+                            double             y,
+                            double             width,
+                            double             height)
+{
+  cairo_pattern_t *pattern;
+  double length; /* distance in pixels for 100% */
+  double start, end; /* position of first/last point on gradient line - with gradient line being [0, 1] */
+  double offset;
+  int i, last;
 
   length = sqrt (x * x + y * y);
   gtk_css_image_linear_get_start_end (linear, length, &start, &end);
@@ -228,6 +238,244 @@ gtk_css_image_linear_draw (GtkCssImage        *image,
   cairo_pattern_destroy (pattern);
 }
 
+/* Vertical and horizontal gradients only vary along one axis, so
+ * they are rendered once into a strip of 1 pixel that is then
+ * stretched over the image. The strips are cached by the stops,
+ * which are shared between equal gradients because numbers and
+ * colors are interned, so widgets of the same size and style share
+ * them.
+ */
+#define STRIP_CACHE_SIZE 64
+
+typedef struct _GradientStripKey GradientStripKey;
+typedef struct _GradientStrip GradientStrip;
+
+struct _GradientStripKey {
+  double x;
+  double y;
+  double scale;
+  gboolean repeating;
+  guint n_stops;
+  GtkCssImageLinearColorStop *stops;
+};
+
+struct _GradientStrip {
+  GradientStripKey key;
+  cairo_surface_t *surface;
+  GList link;
+};
+
+static GHashTable *strip_cache = NULL;
+static GQueue strip_lru = G_QUEUE_INIT;
+
+static guint
+gradient_strip_key_hash (gconstpointer data)
+{
+  const GradientStripKey *key = data;
+  guint i, hash;
+
+  hash = g_double_hash (&key->x)
+       ^ (g_double_hash (&key->y) << 1)
+       ^ (g_double_hash (&key->scale) << 2)
+       ^ key->repeating;
+
+  for (i = 0; i < key->n_stops; i++)
+    {
+      hash = hash * 31 + g_direct_hash (key->stops[i].offset);
+      hash = hash * 31 + g_direct_hash (key->stops[i].color);
+    }
+
+  return hash;
+}
+
+static gboolean
+gradient_strip_key_equal (gconstpointer a,
+                          gconstpointer b)
+{
+  const GradientStripKey *key1 = a;
+  const GradientStripKey *key2 = b;
+  guint i;
+
+  if (key1->x != key2->x ||
+      key1->y != key2->y ||
+      key1->scale != key2->scale ||
+      key1->repeating != key2->repeating ||
+      key1->n_stops != key2->n_stops)
+    return FALSE;
+
+  for (i = 0; i < key1->n_stops; i++)
+    {
+      if (key1->stops[i].offset != key2->stops[i].offset ||
+          key1->stops[i].color != key2->stops[i].color)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+gradient_strip_free (GradientStrip *strip)
+{
+  guint i;
+
+  for (i = 0; i < strip->key.n_stops; i++)
+    {
+      if (strip->key.stops[i].offset)
+        _gtk_css_value_unref (strip->key.stops[i].offset);
+      _gtk_css_value_unref (strip->key.stops[i].color);
+    }
+  g_free (strip->key.stops);
+
+  cairo_surface_destroy (strip->surface);
+  g_slice_free (GradientStrip, strip);
+}
+
+static cairo_surface_t *
+gradient_strip_create (GtkCssImageLinear *linear,
+                       double             x,
+                       double             y,
+                       double             scale)
+{
+  cairo_surface_t *surface;
+  double width, height;
+  cairo_t *cr;
+
+  width = x == 0 ? 1 : 2 * fabs (x);
+  height = y == 0 ? 1 : 2 * fabs (y);
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                        ceil (width * scale),
+                                        ceil (height * scale));
+#ifdef HAVE_CAIRO_SURFACE_SET_DEVICE_SCALE
+  cairo_surface_set_device_scale (surface, scale, scale);
+#endif
+
+  cr = cairo_create (surface);
+  gtk_css_image_linear_paint (linear, cr, x, y, width, height);
+  cairo_destroy (cr);
+
+  return surface;
+}
+
+static cairo_surface_t *
+gradient_strip_lookup (GtkCssImageLinear *linear,
+                       double             x,
+                       double             y,
+                       double             scale)
+{
+  GradientStripKey key;
+  GradientStrip *strip;
+  guint i;
+
+  if (G_UNLIKELY (strip_cache == NULL))
+    strip_cache = g_hash_table_new (gradient_strip_key_hash, gradient_strip_key_equal);
+
+  key.x = x;
+  key.y = y;
+  key.scale = scale;
+  key.repeating = linear->repeating;
+  key.n_stops = linear->stops->len;
+  key.stops = (GtkCssImageLinearColorStop *) linear->stops->data;
+
+  strip = g_hash_table_lookup (strip_cache, &key);
+  if (strip)
+    {
+      g_queue_unlink (&strip_lru, &strip->link);
+      g_queue_push_head_link (&strip_lru, &strip->link);
+      return strip->surface;
+    }
+
+  if (strip_lru.length >= STRIP_CACHE_SIZE)
+    {
+      GradientStrip *last = g_queue_peek_tail (&strip_lru);
+
+      g_queue_unlink (&strip_lru, &last->link);
+      g_hash_table_remove (strip_cache, &last->key);
+      gradient_strip_free (last);
+    }
+
+  strip = g_slice_new0 (GradientStrip);
+  strip->key = key;
+  strip->key.stops = g_memdup (key.stops, key.n_stops * sizeof (GtkCssImageLinearColorStop));
+  for (i = 0; i < key.n_stops; i++)
+    {
+      if (key.stops[i].offset)
+        _gtk_css_value_ref (key.stops[i].offset);
+      _gtk_css_value_ref (key.stops[i].color);
+    }
+  strip->surface = gradient_strip_create (linear, x, y, scale);
+  strip->link.data = strip;
+
+  g_hash_table_insert (strip_cache, &strip->key, strip);
+  g_queue_push_head_link (&strip_lru, &strip->link);
+
+  return strip->surface;
+}
+
+static double
+get_device_scale (cairo_t *cr)
+{
+#ifdef HAVE_CAIRO_SURFACE_SET_DEVICE_SCALE
+  double x_scale, y_scale;
+
+  cairo_surface_get_device_scale (cairo_get_target (cr), &x_scale, &y_scale);
+
+  return x_scale;
+#else
+  return 1.0;
+#endif
+}
+
+/* The strips have the resolution of an untransformed target, so they
+ * would look blurry when scaled or rotated. */
+static gboolean
+can_use_strip (cairo_t *cr,
+               double   x,
+               double   y)
+{
+  cairo_matrix_t matrix;
+
+  if ((x != 0) == (y != 0))
+    return FALSE;
+
+  cairo_get_matrix (cr, &matrix);
+
+  return matrix.xx == 1.0 && matrix.yy == 1.0 &&
+         matrix.xy == 0.0 && matrix.yx == 0.0;
+}
+
+static void
+gtk_css_image_linear_draw (GtkCssImage        *image,
+                           cairo_t            *cr,
+                           double              width,
+                           double              height)
+{
+  GtkCssImageLinear *linear = GTK_CSS_IMAGE_LINEAR (image);
+  double x, y; /* coordinates of start point */
+
+  gtk_css_image_linear_get_start_point (linear, width, height, &x, &y);
+
+  if (can_use_strip (cr, x, y))
+    {
+      cairo_surface_t *surface;
+      cairo_pattern_t *pattern;
+
+      surface = gradient_strip_lookup (linear, x, y, get_device_scale (cr));
+
+      pattern = cairo_pattern_create_for_surface (surface);
+      cairo_pattern_set_extend (pattern, CAIRO_EXTEND_PAD);
+
+      cairo_rectangle (cr, 0, 0, width, height);
+      cairo_set_source (cr, pattern);
+      cairo_fill (cr);
+
+      cairo_pattern_destroy (pattern);
+    }
+  else
+    {
+      gtk_css_image_linear_paint (linear, cr, x, y, width, height);
+    }
+}
 
 static gboolean
 gtk_css_image_linear_parse (GtkCssImage  *image,
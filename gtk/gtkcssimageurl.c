@@ -27,34 +27,80 @@
 
 G_DEFINE_TYPE (GtkCssImageUrl, _gtk_css_image_url, GTK_TYPE_CSS_IMAGE)
 
+/* Decoded images are shared by all url images that load the same
+ * file, so themes and providers that use the same assets decode
+ * each of them only once. The cache only holds weak references,
+ * but the most recently loaded images are kept alive for a while so
+ * that reloading a theme doesn't decode everything again.
+ */
+#define MAX_RECENT_IMAGE_BYTES (4 * 1024 * 1024)
+
+static GHashTable *image_cache = NULL;
+static GQueue recent_images = G_QUEUE_INIT;
+static gsize recent_image_bytes = 0;
+
+static gsize
+get_image_bytes (GtkCssImage *image)
+{
+  return (gsize) _gtk_css_image_get_width (image) * _gtk_css_image_get_height (image) * 4;
+}
+
+static void
+image_cache_remove (gpointer  uri,
+                    GObject  *where_the_image_was)
+{
+  g_hash_table_remove (image_cache, uri);
+}
+
+static void
+image_cache_add (char        *uri,
+                 GtkCssImage *image)
+{
+  if (image_cache == NULL)
+    image_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  g_hash_table_insert (image_cache, uri, image);
+  g_object_weak_ref (G_OBJECT (image), image_cache_remove, uri);
+
+  g_queue_push_head (&recent_images, g_object_ref (image));
+  recent_image_bytes += get_image_bytes (image);
+
+  while (recent_image_bytes > MAX_RECENT_IMAGE_BYTES &&
+         recent_images.length > 1)
+    {
+      GtkCssImage *old = g_queue_pop_tail (&recent_images);
+
+      recent_image_bytes -= get_image_bytes (old);
+      g_object_unref (old);
+    }
+}
+
 static GtkCssImage *
-gtk_css_image_url_load_image (GtkCssImageUrl *url)
+gtk_css_image_url_load_file (GFile   *file,
+                             GError **error)
 {
+  GtkCssImage *image;
   GdkPixbuf *pixbuf;
-  GError *error = NULL;
   GFileInputStream *input;
 
-  if (url->loaded_image)
-    return url->loaded_image;
-
   /* We special case resources here so we can use
      gdk_pixbuf_new_from_resource, which in turn has some special casing
      for GdkPixdata files to avoid duplicating the memory for the pixbufs */
-  if (g_file_has_uri_scheme (url->file, "resource"))
+  if (g_file_has_uri_scheme (file, "resource"))
     {
-      char *uri = g_file_get_uri (url->file);
+      char *uri = g_file_get_uri (file);
       char *resource_path = g_uri_unescape_string (uri + strlen ("resource://"), NULL);
 
-      pixbuf = gdk_pixbuf_new_from_resource (resource_path, &error);
+      pixbuf = gdk_pixbuf_new_from_resource (resource_path, error);
       g_free (resource_path);
       g_free (uri);
     }
   else
     {
-      input = g_file_read (url->file, NULL, &error);
+      input = g_file_read (file, NULL, error);
       if (input != NULL)
 	{
-          pixbuf = gdk_pixbuf_new_from_stream (G_INPUT_STREAM (input), NULL, &error);
+          pixbuf = gdk_pixbuf_new_from_stream (G_INPUT_STREAM (input), NULL, error);
           g_object_unref (input);
 	}
       else
@@ -64,13 +110,44 @@ gtk_css_image_url_load_image (GtkCssImageUrl *url)
     }
 
   if (pixbuf == NULL)
+    return NULL;
+
+  image = _gtk_css_image_surface_new_for_pixbuf (pixbuf);
+  g_object_unref (pixbuf);
+
+  return image;
+}
+
+static GtkCssImage *
+gtk_css_image_url_load_image (GtkCssImageUrl *url)
+{
+  GError *error = NULL;
+  char *uri;
+
+  if (url->loaded_image)
+    return url->loaded_image;
+
+  uri = g_file_get_uri (url->file);
+
+  if (image_cache)
+    {
+      GtkCssImage *cached = g_hash_table_lookup (image_cache, uri);
+
+      if (cached)
+        {
+          g_free (uri);
+          url->loaded_image = g_object_ref (cached);
+          return url->loaded_image;
+        }
+    }
+
+  url->loaded_image = gtk_css_image_url_load_file (url->file, &error);
+  if (url->loaded_image == NULL)
     {
       cairo_surface_t *empty = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 0, 0);
-      char *uri;
 
       /* XXX: Can we get the error somehow sent to the CssProvider?
        * I don't like just dumping it to stderr or losing it completely. */
-      uri = g_file_get_uri (url->file);
       g_warning ("Error loading image '%s': %s", uri, error->message);
       g_error_free (error);
       g_free (uri);
@@ -79,8 +156,8 @@ gtk_css_image_url_load_image (GtkCssImageUrl *url)
       return url->loaded_image; 
     }
 
-  url->loaded_image = _gtk_css_image_surface_new_for_pixbuf (pixbuf);
-  g_object_unref (pixbuf);
+  /* takes the uri */
+  image_cache_add (uri, url->loaded_image);
 
   return url->loaded_image;
 }
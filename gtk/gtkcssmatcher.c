@@ -19,7 +19,107 @@
 
 #include "gtkcssmatcherprivate.h"
 
-#include "gtkwidgetpath.h"
+#include <string.h>
+
+#include "gtkwidgetpathprivate.h"
+
+/* ANCESTOR FILTER */
+
+/* salts so types, classes and names don't collide */
+#define GTK_CSS_ANCESTOR_FILTER_TYPE  0x1b873593u
+#define GTK_CSS_ANCESTOR_FILTER_CLASS 0x85ebca6bu
+#define GTK_CSS_ANCESTOR_FILTER_ID    0xc2b2ae35u
+
+static inline guint
+gtk_css_ancestor_filter_hash (guint64 value,
+                              guint   salt)
+{
+  guint hash;
+
+  hash = ((guint) value ^ (guint) (value >> 32) ^ salt) * 0x9e3779b1;
+  hash ^= hash >> 15;
+
+  return hash;
+}
+
+static inline void
+gtk_css_ancestor_filter_add (GtkCssAncestorFilter *filter,
+                             guint                 hash)
+{
+  guint a = hash % GTK_CSS_ANCESTOR_FILTER_BITS;
+  guint b = (hash >> 16) % GTK_CSS_ANCESTOR_FILTER_BITS;
+
+  filter->bits[a / 32] |= 1u << (a % 32);
+  filter->bits[b / 32] |= 1u << (b % 32);
+}
+
+static inline gboolean
+gtk_css_ancestor_filter_contains (const GtkCssAncestorFilter *filter,
+                                  guint                       hash)
+{
+  guint a = hash % GTK_CSS_ANCESTOR_FILTER_BITS;
+  guint b = (hash >> 16) % GTK_CSS_ANCESTOR_FILTER_BITS;
+
+  return (filter->bits[a / 32] & (1u << (a % 32))) &&
+         (filter->bits[b / 32] & (1u << (b % 32)));
+}
+
+static void
+gtk_css_ancestor_filter_init (GtkCssAncestorFilter *filter,
+                              const GtkWidgetPath  *path)
+{
+  const GQuark *classes;
+  const char *name;
+  guint i, j, n_classes;
+  GType type;
+
+  memset (filter, 0, sizeof (GtkCssAncestorFilter));
+
+  /* Only ancestors of the head are interesting, siblings
+   * are reached via get_previous() and are never ancestors */
+  for (i = 0; i + 1 < gtk_widget_path_length (path); i++)
+    {
+      for (type = gtk_widget_path_iter_get_object_type (path, i);
+           type != G_TYPE_INVALID;
+           type = g_type_parent (type))
+        gtk_css_ancestor_filter_add (filter, gtk_css_ancestor_filter_hash (type, GTK_CSS_ANCESTOR_FILTER_TYPE));
+
+      classes = _gtk_widget_path_iter_get_qclasses (path, i, &n_classes);
+      for (j = 0; j < n_classes; j++)
+        gtk_css_ancestor_filter_add (filter, gtk_css_ancestor_filter_hash (classes[j], GTK_CSS_ANCESTOR_FILTER_CLASS));
+
+      /* names are interned, so hashing the pointer is enough */
+      name = gtk_widget_path_iter_get_name (path, i);
+      if (name)
+        gtk_css_ancestor_filter_add (filter, gtk_css_ancestor_filter_hash (GPOINTER_TO_SIZE (name), GTK_CSS_ANCESTOR_FILTER_ID));
+    }
+}
+
+gboolean
+_gtk_css_ancestor_filter_may_have_type (const GtkCssAncestorFilter *filter,
+                                        GType                       type)
+{
+  /* Interfaces are matched with g_type_is_a(), but we only
+   * record the class hierarchy, so we can't exclude them. */
+  if (type == G_TYPE_INVALID || G_TYPE_IS_INTERFACE (type))
+    return TRUE;
+
+  return gtk_css_ancestor_filter_contains (filter, gtk_css_ancestor_filter_hash (type, GTK_CSS_ANCESTOR_FILTER_TYPE));
+}
+
+gboolean
+_gtk_css_ancestor_filter_may_have_class (const GtkCssAncestorFilter *filter,
+                                         GQuark                      class_name)
+{
+  return gtk_css_ancestor_filter_contains (filter, gtk_css_ancestor_filter_hash (class_name, GTK_CSS_ANCESTOR_FILTER_CLASS));
+}
+
+gboolean
+_gtk_css_ancestor_filter_may_have_id (const GtkCssAncestorFilter *filter,
+                                      const char                 *id)
+{
+  return gtk_css_ancestor_filter_contains (filter, gtk_css_ancestor_filter_hash (GPOINTER_TO_SIZE (id), GTK_CSS_ANCESTOR_FILTER_ID));
+}
 
 /* GTK_CSS_MATCHER_WIDGET_PATH */
 
@@ -35,6 +135,7 @@ gtk_css_matcher_widget_path_get_parent (GtkCssMatcher       *matcher,
   matcher->path.state_flags = 0;
   matcher->path.index = child->path.index - 1;
   matcher->path.sibling_index = gtk_widget_path_iter_get_sibling_index (matcher->path.path, matcher->path.index);
+  matcher->path.filter = child->path.filter;
 
   return TRUE;
 }
@@ -51,6 +152,7 @@ gtk_css_matcher_widget_path_get_previous (GtkCssMatcher       *matcher,
   matcher->path.state_flags = 0;
   matcher->path.index = next->path.index;
   matcher->path.sibling_index = next->path.sibling_index - 1;
+  matcher->path.filter = next->path.filter;
 
   return TRUE;
 }
@@ -200,9 +302,31 @@ _gtk_css_matcher_init (GtkCssMatcher       *matcher,
   matcher->path.index = gtk_widget_path_length (path) - 1;
   matcher->path.sibling_index = gtk_widget_path_iter_get_sibling_index (path, matcher->path.index);
 
+  gtk_css_ancestor_filter_init (&matcher->path.filter_storage, path);
+  matcher->path.filter = &matcher->path.filter_storage;
+
   return TRUE;
 }
 
+/*
+ * _gtk_css_matcher_get_ancestor_filter:
+ * @matcher: a matcher
+ *
+ * Returns the filter describing the ancestors of @matcher, if any.
+ * The filter stays valid as long as the matcher that @matcher was
+ * derived from via _gtk_css_matcher_init().
+ *
+ * Returns: the filter or %NULL if @matcher doesn't have one
+ */
+const GtkCssAncestorFilter *
+_gtk_css_matcher_get_ancestor_filter (const GtkCssMatcher *matcher)
+{
+  if (matcher->klass != &GTK_CSS_MATCHER_WIDGET_PATH)
+    return NULL;
+
+  return matcher->path.filter;
+}
+
 /* GTK_CSS_MATCHER_WIDGET_ANY */
 
 static gboolean
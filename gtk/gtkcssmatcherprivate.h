@@ -28,6 +28,7 @@ typedef union _GtkCssMatcher GtkCssMatcher;
 typedef struct _GtkCssMatcherSuperset GtkCssMatcherSuperset;
 typedef struct _GtkCssMatcherWidgetPath GtkCssMatcherWidgetPath;
 typedef struct _GtkCssMatcherClass GtkCssMatcherClass;
+typedef struct _GtkCssAncestorFilter GtkCssAncestorFilter;
 
 struct _GtkCssMatcherClass {
   gboolean        (* get_parent)                  (GtkCssMatcher          *matcher,
@@ -53,12 +54,24 @@ struct _GtkCssMatcherClass {
   gboolean is_any;
 };
 
+/* A small bloom filter over the types, classes and names of all
+ * ancestors of the matched element. It can only tell for sure that
+ * something is not there, which is enough to skip walking up the
+ * path for descendant selectors that cannot match. */
+#define GTK_CSS_ANCESTOR_FILTER_BITS 256
+
+struct _GtkCssAncestorFilter {
+  guint32 bits[GTK_CSS_ANCESTOR_FILTER_BITS / 32];
+};
+
 struct _GtkCssMatcherWidgetPath {
   const GtkCssMatcherClass *klass;
   const GtkWidgetPath      *path;
   GtkStateFlags             state_flags;
   guint                     index;
   guint                     sibling_index;
+  const GtkCssAncestorFilter *filter;     /* shared by all matchers derived from the same init */
+  GtkCssAncestorFilter      filter_storage;
 };
 
 struct _GtkCssMatcherSuperset {
@@ -81,6 +94,18 @@ void              _gtk_css_matcher_superset_init  (GtkCssMatcher          *match
                                                    const GtkCssMatcher    *subset,
                                                    GtkCssChange            relevant);
 
+const GtkCssAncestorFilter *
+                  _gtk_css_matcher_get_ancestor_filter
+                                                  (const GtkCssMatcher    *matcher);
+gboolean          _gtk_css_ancestor_filter_may_have_type
+                                                  (const GtkCssAncestorFilter *filter,
+                                                   GType                   type);
+gboolean          _gtk_css_ancestor_filter_may_have_class
+                                                  (const GtkCssAncestorFilter *filter,
+                                                   GQuark                  class_name);
+gboolean          _gtk_css_ancestor_filter_may_have_id
+                                                  (const GtkCssAncestorFilter *filter,
+                                                   const char             *id);
 
 static inline gboolean
 _gtk_css_matcher_get_parent (GtkCssMatcher       *matcher,
@@ -17,6 +17,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include "gtkcssnumbervalueprivate.h"
 
 #include "gtkcssenumvalueprivate.h"
@@ -29,9 +31,44 @@ struct _GtkCssValue {
   double value;
 };
 
+/* Numbers are interned: there is at most one live value for every
+ * unit and value, so equal numbers are usually the same pointer and
+ * values built from numbers can be interned by pointer, too.
+ * NaN is never equal to itself and so is not interned.
+ */
+static GHashTable *number_values = NULL;
+
+static guint
+gtk_css_value_number_hash (gconstpointer data)
+{
+  const GtkCssValue *number = data;
+  double value;
+  guint64 bits;
+
+  /* -0 and 0 compare equal, so they need to hash the same */
+  value = number->value == 0 ? 0 : number->value;
+  memcpy (&bits, &value, sizeof (bits));
+
+  return (guint) (bits ^ (bits >> 32)) ^ (number->unit << 24);
+}
+
+static gboolean
+gtk_css_value_number_hash_equal (gconstpointer a,
+                                 gconstpointer b)
+{
+  const GtkCssValue *number1 = a;
+  const GtkCssValue *number2 = b;
+
+  return number1->unit == number2->unit &&
+         number1->value == number2->value;
+}
+
 static void
 gtk_css_value_number_free (GtkCssValue *value)
 {
+  if (value->value == value->value)
+    g_hash_table_remove (number_values, value);
+
   g_slice_free (GtkCssValue, value);
 }
 
@@ -201,7 +238,7 @@ _gtk_css_number_value_new (double     value,
     { &GTK_CSS_VALUE_NUMBER, 1, GTK_CSS_PX, 3 },
     { &GTK_CSS_VALUE_NUMBER, 1, GTK_CSS_PX, 4 },
   };
-  GtkCssValue *result;
+  GtkCssValue key, *result;
 
   if (unit == GTK_CSS_NUMBER && (value == 0 || value == 1))
     return _gtk_css_value_ref (&number_singletons[(int) value]);
@@ -216,10 +253,23 @@ _gtk_css_number_value_new (double     value,
       return _gtk_css_value_ref (&px_singletons[(int) value]);
     }
 
+  if (G_UNLIKELY (number_values == NULL))
+    number_values = g_hash_table_new (gtk_css_value_number_hash,
+                                      gtk_css_value_number_hash_equal);
+
+  key.unit = unit;
+  key.value = value;
+  result = g_hash_table_lookup (number_values, &key);
+  if (result)
+    return _gtk_css_value_ref (result);
+
   result = _gtk_css_value_new (GtkCssValue, &GTK_CSS_VALUE_NUMBER);
   result->unit = unit;
   result->value = value;
 
+  if (value == value)
+    g_hash_table_add (number_values, result);
+
   return result;
 }
 
@@ -47,6 +47,8 @@ struct _GtkCssParser
 
   const char            *line_start;
   guint                  line;
+
+  GString               *scratch;
 };
 
 GtkCssParser *
@@ -71,6 +73,8 @@ _gtk_css_parser_new (const char            *data,
   parser->line_start = data;
   parser->line = 0;
 
+  parser->scratch = g_string_new (NULL);
+
   return parser;
 }
 
@@ -82,6 +86,8 @@ _gtk_css_parser_free (GtkCssParser *parser)
   if (parser->file)
     g_object_unref (parser->file);
 
+  g_string_free (parser->scratch, TRUE);
+
   g_slice_free (GtkCssParser, parser);
 }
 
@@ -393,58 +399,160 @@ _gtk_css_parser_read_char (GtkCssParser *parser,
   return FALSE;
 }
 
+/* Skips the characters in @allowed (and non-ASCII ones) in the
+ * same way as _gtk_css_parser_read_char(), but stops at escapes.
+ */
+static const char *
+gtk_css_parser_skip_plain_chars (const char *data,
+                                 const char *allowed)
+{
+  while (*data)
+    {
+      if (strchr (allowed, *data))
+        data++;
+      else if (*data >= 127)
+        data += g_utf8_skip[(guint) *(guchar *) data];
+      else
+        break;
+    }
+
+  return data;
+}
+
+/* Reads a name or identifier and returns it as a span of @length
+ * bytes. Unless it contains escapes, the span points into the
+ * parsed data and nothing is copied. Otherwise the unescaped string
+ * is built in parser->scratch, which is only valid until the next
+ * call.
+ */
+static const char *
+gtk_css_parser_read_name_span (GtkCssParser *parser,
+                               gboolean      ident,
+                               gsize        *length)
+{
+  const char *start, *end;
+
+  start = end = parser->data;
+
+  if (ident)
+    {
+      const char *first;
+
+      if (*end == '-')
+        end++;
+
+      first = end;
+      end = gtk_css_parser_skip_plain_chars (end, NMSTART);
+      if (end == first && *end != '\\')
+        return NULL;
+    }
+
+  end = gtk_css_parser_skip_plain_chars (end, NMCHAR);
+  parser->data = end;
+
+  if (*end != '\\')
+    {
+      *length = end - start;
+      return start;
+    }
+
+  g_string_truncate (parser->scratch, 0);
+  g_string_append_len (parser->scratch, start, end - start);
+
+  while (_gtk_css_parser_read_char (parser, parser->scratch, NMCHAR))
+    ;
+
+  *length = parser->scratch->len;
+  return parser->scratch->str;
+}
+
+static const char *
+gtk_css_parser_intern_span (GtkCssParser *parser,
+                            const char   *span,
+                            gsize         length)
+{
+  if (span != parser->scratch->str)
+    {
+      g_string_truncate (parser->scratch, 0);
+      g_string_append_len (parser->scratch, span, length);
+    }
+
+  return g_intern_string (parser->scratch->str);
+}
+
 char *
 _gtk_css_parser_try_name (GtkCssParser *parser,
                           gboolean      skip_whitespace)
 {
-  GString *name;
+  const char *name;
+  gsize length;
 
   g_return_val_if_fail (GTK_IS_CSS_PARSER (parser), NULL);
 
-  name = g_string_new (NULL);
-
-  while (_gtk_css_parser_read_char (parser, name, NMCHAR))
-    ;
+  name = gtk_css_parser_read_name_span (parser, FALSE, &length);
 
   if (skip_whitespace)
     _gtk_css_parser_skip_whitespace (parser);
 
-  return g_string_free (name, FALSE);
+  return g_strndup (name, length);
 }
 
 char *
 _gtk_css_parser_try_ident (GtkCssParser *parser,
                            gboolean      skip_whitespace)
 {
-  const char *start;
-  GString *ident;
+  const char *ident;
+  gsize length;
 
   g_return_val_if_fail (GTK_IS_CSS_PARSER (parser), NULL);
 
-  start = parser->data;
-  
-  ident = g_string_new (NULL);
+  ident = gtk_css_parser_read_name_span (parser, TRUE, &length);
+  if (ident == NULL)
+    return NULL;
 
-  if (*parser->data == '-')
-    {
-      g_string_append_c (ident, '-');
-      parser->data++;
-    }
+  if (skip_whitespace)
+    _gtk_css_parser_skip_whitespace (parser);
 
-  if (!_gtk_css_parser_read_char (parser, ident, NMSTART))
-    {
-      parser->data = start;
-      g_string_free (ident, TRUE);
-      return NULL;
-    }
+  return g_strndup (ident, length);
+}
 
-  while (_gtk_css_parser_read_char (parser, ident, NMCHAR))
-    ;
+/* Like _gtk_css_parser_try_name(), but returns an interned string.
+ * Nothing is allocated for names that have been seen before.
+ */
+const char *
+_gtk_css_parser_try_interned_name (GtkCssParser *parser,
+                                   gboolean      skip_whitespace)
+{
+  const char *name;
+  gsize length;
+
+  g_return_val_if_fail (GTK_IS_CSS_PARSER (parser), NULL);
+
+  name = gtk_css_parser_read_name_span (parser, FALSE, &length);
 
   if (skip_whitespace)
     _gtk_css_parser_skip_whitespace (parser);
 
-  return g_string_free (ident, FALSE);
+  return gtk_css_parser_intern_span (parser, name, length);
+}
+
+const char *
+_gtk_css_parser_try_interned_ident (GtkCssParser *parser,
+                                    gboolean      skip_whitespace)
+{
+  const char *ident;
+  gsize length;
+
+  g_return_val_if_fail (GTK_IS_CSS_PARSER (parser), NULL);
+
+  ident = gtk_css_parser_read_name_span (parser, TRUE, &length);
+  if (ident == NULL)
+    return NULL;
+
+  if (skip_whitespace)
+    _gtk_css_parser_skip_whitespace (parser);
+
+  return gtk_css_parser_intern_span (parser, ident, length);
 }
 
 gboolean
@@ -460,6 +568,7 @@ _gtk_css_parser_read_string (GtkCssParser *parser)
 {
   GString *str;
   char quote;
+  gsize len;
 
   g_return_val_if_fail (GTK_IS_CSS_PARSER (parser), NULL);
 
@@ -472,11 +581,23 @@ _gtk_css_parser_read_string (GtkCssParser *parser)
     }
   
   parser->data++;
+
+  /* Most strings contain neither escapes nor the other quote */
+  len = strcspn (parser->data, "\\'\"\n\r\f");
+  if (parser->data[len] == quote)
+    {
+      char *result = g_strndup (parser->data, len);
+
+      parser->data += len + 1;
+      _gtk_css_parser_skip_whitespace (parser);
+      return result;
+    }
+
   str = g_string_new (NULL);
 
   while (TRUE)
     {
-      gsize len = strcspn (parser->data, "\\'\"\n\r\f");
+      len = strcspn (parser->data, "\\'\"\n\r\f");
 
       g_string_append_len (str, parser->data, len);
 
@@ -749,22 +870,22 @@ _gtk_css_parser_try_enum (GtkCssParser *parser,
 {
   GEnumClass *enum_class;
   gboolean result;
-  const char *start;
-  char *str;
+  const char *start, *str;
+  gsize length;
 
   g_return_val_if_fail (GTK_IS_CSS_PARSER (parser), FALSE);
   g_return_val_if_fail (value != NULL, FALSE);
 
   result = FALSE;
 
-  enum_class = g_type_class_ref (enum_type);
-
   start = parser->data;
 
-  str = _gtk_css_parser_try_ident (parser, TRUE);
+  str = gtk_css_parser_read_name_span (parser, TRUE, &length);
   if (str == NULL)
     return FALSE;
 
+  enum_class = g_type_class_ref (enum_type);
+
   if (enum_class->n_values)
     {
       GEnumValue *enum_value;
@@ -772,7 +893,8 @@ _gtk_css_parser_try_enum (GtkCssParser *parser,
       for (enum_value = enum_class->values; enum_value->value_name; enum_value++)
 	{
 	  if (enum_value->value_nick &&
-	      g_ascii_strcasecmp (str, enum_value->value_nick) == 0)
+	      strlen (enum_value->value_nick) == length &&
+	      g_ascii_strncasecmp (str, enum_value->value_nick, length) == 0)
 	    {
 	      *value = enum_value->value;
 	      result = TRUE;
@@ -781,10 +903,11 @@ _gtk_css_parser_try_enum (GtkCssParser *parser,
 	}
     }
 
-  g_free (str);
   g_type_class_unref (enum_class);
 
-  if (!result)
+  if (result)
+    _gtk_css_parser_skip_whitespace (parser);
+  else
     parser->data = start;
 
   return result;
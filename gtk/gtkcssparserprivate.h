@@ -75,6 +75,10 @@ char *          _gtk_css_parser_try_ident         (GtkCssParser          *parser
                                                    gboolean               skip_whitespace);
 char *          _gtk_css_parser_try_name          (GtkCssParser          *parser,
                                                    gboolean               skip_whitespace);
+const char *    _gtk_css_parser_try_interned_ident (GtkCssParser         *parser,
+                                                   gboolean               skip_whitespace);
+const char *    _gtk_css_parser_try_interned_name (GtkCssParser          *parser,
+                                                   gboolean               skip_whitespace);
 gboolean        _gtk_css_parser_try_int           (GtkCssParser          *parser,
                                                    int                   *value);
 gboolean        _gtk_css_parser_try_uint          (GtkCssParser          *parser,
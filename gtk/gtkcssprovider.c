@@ -29,6 +29,7 @@
 
 #include "gtkbitmaskprivate.h"
 #include "gtkcssarrayvalueprivate.h"
+#include "gtkcsscacheprivate.h"
 #include "gtkcsscolorvalueprivate.h"
 #include "gtkcsskeyframesprivate.h"
 #include "gtkcssparserprivate.h"
@@ -2529,6 +2530,7 @@ gtk_css_provider_load_internal (GtkCssProvider *css_provider,
                                 GError        **error)
 {
   GtkCssScanner *scanner;
+  GtkCssCache *cache = NULL;
   gulong error_handler;
   char *free_data = NULL;
 
@@ -2540,7 +2542,36 @@ gtk_css_provider_load_internal (GtkCssProvider *css_provider,
   else
     error_handler = 0; /* silence gcc */
 
-  if (text == NULL)
+  /* A theme cache already contains the text of all imported files */
+  if (parent == NULL && text == NULL)
+    cache = _gtk_css_cache_new_for_file (file);
+
+  if (cache)
+    {
+      guint i;
+
+      for (i = 0; i < _gtk_css_cache_get_n_chunks (cache); i++)
+        {
+          GFile *chunk_file;
+          const char *chunk;
+
+          chunk = _gtk_css_cache_get_chunk (cache, i, &chunk_file);
+          scanner = gtk_css_scanner_new (css_provider,
+                                         NULL,
+                                         NULL,
+                                         chunk_file,
+                                         chunk);
+
+          parse_stylesheet (scanner);
+
+          gtk_css_scanner_destroy (scanner);
+        }
+
+      _gtk_css_cache_free (cache);
+
+      gtk_css_provider_postprocess (css_provider);
+    }
+  else if (text == NULL)
     {
       GError *load_error = NULL;
 
@@ -2603,6 +2634,48 @@ gtk_css_provider_load_internal (GtkCssProvider *css_provider,
   return TRUE;
 }
 
+/* Reloading unchanged contents, like a file monitor does whenever
+ * a stylesheet is saved, would otherwise restyle every widget. So
+ * remember what the provider contained before, and only announce
+ * the change if the new contents turn out to be different.
+ */
+static char *
+gtk_css_provider_begin_reload (GtkCssProvider *css_provider)
+{
+  GtkCssProviderPrivate *priv = css_provider->priv;
+  char *previous = NULL;
+
+  if (priv->rulesets->len > 0 ||
+      g_hash_table_size (priv->symbolic_colors) > 0 ||
+      g_hash_table_size (priv->keyframes) > 0)
+    previous = gtk_css_provider_to_string (css_provider);
+
+  gtk_css_provider_reset (css_provider);
+
+  return previous;
+}
+
+static void
+gtk_css_provider_end_reload (GtkCssProvider *css_provider,
+                             char           *previous)
+{
+  char *current;
+  gboolean unchanged;
+
+  if (previous)
+    {
+      current = gtk_css_provider_to_string (css_provider);
+      unchanged = g_str_equal (previous, current);
+      g_free (previous);
+      g_free (current);
+
+      if (unchanged)
+        return;
+    }
+
+  _gtk_style_provider_private_changed (GTK_STYLE_PROVIDER_PRIVATE (css_provider));
+}
+
 /**
  * gtk_css_provider_load_from_data:
  * @css_provider: a #GtkCssProvider
@@ -2626,7 +2699,7 @@ gtk_css_provider_load_from_data (GtkCssProvider  *css_provider,
                                  gssize           length,
                                  GError         **error)
 {
-  char *free_data;
+  char *free_data, *previous;
   gboolean ret;
 
   g_return_val_if_fail (GTK_IS_CSS_PROVIDER (css_provider), FALSE);
@@ -2643,13 +2716,13 @@ gtk_css_provider_load_from_data (GtkCssProvider  *css_provider,
       data = free_data;
     }
 
-  gtk_css_provider_reset (css_provider);
+  previous = gtk_css_provider_begin_reload (css_provider);
 
   ret = gtk_css_provider_load_internal (css_provider, NULL, NULL, data, error);
 
   g_free (free_data);
 
-  _gtk_style_provider_private_changed (GTK_STYLE_PROVIDER_PRIVATE (css_provider));
+  gtk_css_provider_end_reload (css_provider, previous);
 
   return ret;
 }
@@ -2674,15 +2747,16 @@ gtk_css_provider_load_from_file (GtkCssProvider  *css_provider,
                                  GError         **error)
 {
   gboolean success;
+  char *previous;
 
   g_return_val_if_fail (GTK_IS_CSS_PROVIDER (css_provider), FALSE);
   g_return_val_if_fail (G_IS_FILE (file), FALSE);
 
-  gtk_css_provider_reset (css_provider);
+  previous = gtk_css_provider_begin_reload (css_provider);
 
   success = gtk_css_provider_load_internal (css_provider, NULL, file, NULL, error);
 
-  _gtk_style_provider_private_changed (GTK_STYLE_PROVIDER_PRIVATE (css_provider));
+  gtk_css_provider_end_reload (css_provider, previous);
 
   return success;
 }
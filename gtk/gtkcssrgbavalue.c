@@ -27,9 +27,32 @@ struct _GtkCssValue {
   GdkRGBA rgba;
 };
 
+/* Colors are interned like numbers, see gtkcssnumbervalue.c */
+static GHashTable *rgba_values = NULL;
+
+static guint
+gtk_css_value_rgba_hash (gconstpointer data)
+{
+  const GtkCssValue *rgba = data;
+
+  return gdk_rgba_hash (&rgba->rgba);
+}
+
+static gboolean
+gtk_css_value_rgba_hash_equal (gconstpointer a,
+                               gconstpointer b)
+{
+  const GtkCssValue *rgba1 = a;
+  const GtkCssValue *rgba2 = b;
+
+  return gdk_rgba_equal (&rgba1->rgba, &rgba2->rgba);
+}
+
 static void
 gtk_css_value_rgba_free (GtkCssValue *value)
 {
+  g_hash_table_remove (rgba_values, value);
+
   g_slice_free (GtkCssValue, value);
 }
 
@@ -89,13 +112,24 @@ static const GtkCssValueClass GTK_CSS_VALUE_RGBA = {
 GtkCssValue *
 _gtk_css_rgba_value_new_from_rgba (const GdkRGBA *rgba)
 {
-  GtkCssValue *value;
+  GtkCssValue key, *value;
 
   g_return_val_if_fail (rgba != NULL, NULL);
 
+  if (G_UNLIKELY (rgba_values == NULL))
+    rgba_values = g_hash_table_new (gtk_css_value_rgba_hash,
+                                    gtk_css_value_rgba_hash_equal);
+
+  key.rgba = *rgba;
+  value = g_hash_table_lookup (rgba_values, &key);
+  if (value)
+    return _gtk_css_value_ref (value);
+
   value = _gtk_css_value_new (GtkCssValue, &GTK_CSS_VALUE_RGBA);
   value->rgba = *rgba;
 
+  g_hash_table_add (rgba_values, value);
+
   return value;
 }
 
@@ -208,6 +208,35 @@ gtk_css_selector_tree_match_previous (const GtkCssSelectorTree *tree,
     gtk_css_selector_tree_match (prev, matcher, res);
 }
 
+static gboolean gtk_css_selector_may_match_ancestor (const GtkCssSelector       *selector,
+                                                     const GtkCssAncestorFilter *filter);
+
+/* Like gtk_css_selector_tree_match_previous(), but skips branches that
+ * the ancestor filter proves can't match. Returns %FALSE if no branch
+ * was left to try. */
+static gboolean
+gtk_css_selector_tree_match_previous_ancestor (const GtkCssSelectorTree   *tree,
+                                               const GtkCssMatcher        *matcher,
+                                               const GtkCssAncestorFilter *filter,
+                                               GHashTable                 *res)
+{
+  const GtkCssSelectorTree *prev;
+  gboolean tried = FALSE;
+
+  for (prev = gtk_css_selector_tree_get_previous (tree);
+       prev != NULL;
+       prev = gtk_css_selector_tree_get_sibling (prev))
+    {
+      if (filter && !gtk_css_selector_may_match_ancestor (&prev->selector, filter))
+        continue;
+
+      gtk_css_selector_tree_match (prev, matcher, res);
+      tried = TRUE;
+    }
+
+  return tried;
+}
+
 static GtkCssChange
 gtk_css_selector_tree_get_previous_change (const GtkCssSelectorTree *tree,
 					   const GtkCssMatcher      *matcher)
@@ -236,8 +265,13 @@ static gboolean
 gtk_css_selector_descendant_match (const GtkCssSelector *selector,
                                    const GtkCssMatcher  *matcher)
 {
+  const GtkCssAncestorFilter *filter;
   GtkCssMatcher ancestor;
 
+  filter = _gtk_css_matcher_get_ancestor_filter (matcher);
+  if (filter && !gtk_css_selector_may_match_ancestor (gtk_css_selector_previous (selector), filter))
+    return FALSE;
+
   while (_gtk_css_matcher_get_parent (&ancestor, matcher))
     {
       matcher = &ancestor;
@@ -254,13 +288,19 @@ gtk_css_selector_descendant_tree_match (const GtkCssSelectorTree *tree,
 					const GtkCssMatcher  *matcher,
 					GHashTable *res)
 {
+  const GtkCssAncestorFilter *filter;
   GtkCssMatcher ancestor;
 
+  filter = _gtk_css_matcher_get_ancestor_filter (matcher);
+
   while (_gtk_css_matcher_get_parent (&ancestor, matcher))
     {
       matcher = &ancestor;
 
-      gtk_css_selector_tree_match_previous (tree, matcher, res);
+      /* If the filter rules out every branch, no ancestor can match
+       * and there's no need to walk further up the path */
+      if (!gtk_css_selector_tree_match_previous_ancestor (tree, matcher, filter, res))
+        break;
 
       /* any matchers are dangerous here, as we may loop forever, but
 	 we can terminate now as all possible matches have already been added */
@@ -351,7 +391,9 @@ gtk_css_selector_child_tree_match (const GtkCssSelectorTree *tree,
   if (!_gtk_css_matcher_get_parent (&parent, matcher))
     return;
 
-  gtk_css_selector_tree_match_previous (tree, &parent, res);
+  gtk_css_selector_tree_match_previous_ancestor (tree, &parent,
+                                                 _gtk_css_matcher_get_ancestor_filter (matcher),
+                                                 res);
 }
 
 
@@ -1094,6 +1136,25 @@ static const GtkCssSelectorClass GTK_CSS_SELECTOR_ID = {
   TRUE, FALSE, FALSE, TRUE, FALSE
 };
 
+/* ANCESTOR FILTER */
+
+static gboolean
+gtk_css_selector_may_match_ancestor (const GtkCssSelector       *selector,
+                                     const GtkCssAncestorFilter *filter)
+{
+  if (selector == NULL)
+    return TRUE;
+
+  if (selector->class == &GTK_CSS_SELECTOR_CLASS)
+    return _gtk_css_ancestor_filter_may_have_class (filter, GPOINTER_TO_UINT (selector->data));
+  else if (selector->class == &GTK_CSS_SELECTOR_ID)
+    return _gtk_css_ancestor_filter_may_have_id (filter, selector->data);
+  else if (selector->class == &GTK_CSS_SELECTOR_NAME)
+    return _gtk_css_ancestor_filter_may_have_type (filter, ((const TypeReference *) selector->data)->type);
+  else
+    return TRUE;
+}
+
 /* PSEUDOCLASS FOR STATE */
 
 static void
@@ -1639,9 +1700,9 @@ gtk_css_selector_new (const GtkCssSelectorClass *class,
 static GtkCssSelector *
 parse_selector_class (GtkCssParser *parser, GtkCssSelector *selector)
 {
-  char *name;
+  const char *name;
     
-  name = _gtk_css_parser_try_name (parser, FALSE);
+  name = _gtk_css_parser_try_interned_name (parser, FALSE);
 
   if (name == NULL)
     {
@@ -1655,17 +1716,15 @@ parse_selector_class (GtkCssParser *parser, GtkCssSelector *selector)
                                    selector,
                                    GUINT_TO_POINTER (g_quark_from_string (name)));
 
-  g_free (name);
-
   return selector;
 }
 
 static GtkCssSelector *
 parse_selector_id (GtkCssParser *parser, GtkCssSelector *selector)
 {
-  char *name;
+  const char *name;
     
-  name = _gtk_css_parser_try_name (parser, FALSE);
+  name = _gtk_css_parser_try_interned_name (parser, FALSE);
 
   if (name == NULL)
     {
@@ -1677,9 +1736,7 @@ parse_selector_id (GtkCssParser *parser, GtkCssSelector *selector)
 
   selector = gtk_css_selector_new (&GTK_CSS_SELECTOR_ID,
                                    selector,
-                                   g_intern_string (name));
-
-  g_free (name);
+                                   name);
 
   return selector;
 }
@@ -1866,20 +1923,19 @@ static GtkCssSelector *
 try_parse_name (GtkCssParser   *parser,
                 GtkCssSelector *selector)
 {
-  char *name;
+  const char *name;
 
-  name = _gtk_css_parser_try_ident (parser, FALSE);
+  name = _gtk_css_parser_try_interned_ident (parser, FALSE);
   if (name)
     {
       if (_gtk_style_context_check_region_name (name))
 	selector = gtk_css_selector_new (&GTK_CSS_SELECTOR_REGION,
 					 selector,
-					 g_intern_string (name));
+					 name);
       else
 	selector = gtk_css_selector_new (&GTK_CSS_SELECTOR_NAME,
 					 selector,
 					 get_type_reference (name));
-      g_free (name);
     }
   else if (_gtk_css_parser_try (parser, "*", FALSE))
     selector = gtk_css_selector_new (&GTK_CSS_SELECTOR_ANY, selector, NULL);
@@ -37,6 +37,9 @@
    so we add an extra pixel to make the clips less dramatic */
 #define CLIP_RADIUS_EXTRA 4
 
+/* Number of blurred corner and side masks kept around */
+#define MASK_CACHE_SIZE 32
+
 struct _GtkCssValue {
   GTK_CSS_VALUE_BASE
   guint inset :1;
@@ -522,6 +525,302 @@ draw_shadow (const GtkCssValue   *shadow,
     gtk_css_shadow_value_finish_drawing (shadow, shadow_cr);
 }
 
+/* Blurred outset box shadows are drawn in 9 parts, see below. Away from
+ * the interior, the blurred alpha of a corner only depends on the blur
+ * radius, the shape of the corner and where the box edge falls inside
+ * its first pixel. The one of a side only depends on the radius and
+ * that offset. So we blur those shapes once into a mask in the corner
+ * or side's own orientation and mirror it into place when painting.
+ */
+typedef struct _ShadowMaskKey ShadowMaskKey;
+typedef struct _ShadowMask ShadowMask;
+
+struct _ShadowMaskKey {
+  double radius;
+  double scale;
+  double offset_x;
+  double offset_y;
+  GtkRoundedBoxCorner corner;
+  gboolean side;
+};
+
+struct _ShadowMask {
+  ShadowMaskKey key;
+  cairo_surface_t *surface;
+  GList link;
+};
+
+static GHashTable *mask_cache = NULL;
+static GQueue mask_lru = G_QUEUE_INIT;
+
+static guint
+shadow_mask_key_hash (gconstpointer data)
+{
+  const ShadowMaskKey *key = data;
+
+  return g_double_hash (&key->radius)
+       ^ (g_double_hash (&key->scale) << 1)
+       ^ (g_double_hash (&key->offset_x) << 2)
+       ^ (g_double_hash (&key->offset_y) << 3)
+       ^ (g_double_hash (&key->corner.horizontal) << 4)
+       ^ (g_double_hash (&key->corner.vertical) << 5)
+       ^ key->side;
+}
+
+static gboolean
+shadow_mask_key_equal (gconstpointer a,
+                       gconstpointer b)
+{
+  const ShadowMaskKey *key1 = a;
+  const ShadowMaskKey *key2 = b;
+
+  return key1->radius == key2->radius
+      && key1->scale == key2->scale
+      && key1->offset_x == key2->offset_x
+      && key1->offset_y == key2->offset_y
+      && key1->corner.horizontal == key2->corner.horizontal
+      && key1->corner.vertical == key2->corner.vertical
+      && key1->side == key2->side;
+}
+
+static void
+shadow_mask_free (ShadowMask *mask)
+{
+  cairo_surface_destroy (mask->surface);
+  g_slice_free (ShadowMask, mask);
+}
+
+/* Creates the mask for the top left corner or, for sides, for the
+ * top side, of a box whose edges are @key->offset_x and
+ * @key->offset_y plus the clip radius away from the origin. The mask
+ * is @width x @height and extends far enough to the bottom right
+ * that the blur doesn't see the end of the box there.
+ */
+static cairo_surface_t *
+shadow_mask_create (const ShadowMaskKey *key,
+                    double               clip_radius,
+                    int                  width,
+                    int                  height)
+{
+  cairo_surface_t *surface;
+  GtkRoundedBox box;
+  cairo_t *cr;
+  int margin;
+
+  margin = ceil (clip_radius);
+  width += margin;
+  height += margin;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                        ceil (width * key->scale),
+                                        ceil (height * key->scale));
+#ifdef HAVE_CAIRO_SURFACE_SET_DEVICE_SCALE
+  cairo_surface_set_device_scale (surface, key->scale, key->scale);
+#endif
+
+  cr = cairo_create (surface);
+
+  /* Sides are straight, so their box covers the full width */
+  _gtk_rounded_box_init_rect (&box,
+                              key->side ? - width : key->offset_x + clip_radius,
+                              key->offset_y + clip_radius,
+                              3 * width,
+                              2 * height);
+  box.corner[GTK_CSS_TOP_LEFT] = key->corner;
+  _gtk_rounded_box_path (&box, cr);
+  cairo_fill (cr);
+
+  cairo_destroy (cr);
+
+  _gtk_cairo_blur_surface (surface, key->radius * key->scale);
+
+  return surface;
+}
+
+static cairo_surface_t *
+shadow_mask_lookup (const ShadowMaskKey *key,
+                    double               clip_radius,
+                    int                  width,
+                    int                  height)
+{
+  ShadowMask *mask;
+
+  if (G_UNLIKELY (mask_cache == NULL))
+    mask_cache = g_hash_table_new (shadow_mask_key_hash, shadow_mask_key_equal);
+
+  mask = g_hash_table_lookup (mask_cache, key);
+  if (mask)
+    {
+      g_queue_unlink (&mask_lru, &mask->link);
+      g_queue_push_head_link (&mask_lru, &mask->link);
+      return mask->surface;
+    }
+
+  if (mask_lru.length >= MASK_CACHE_SIZE)
+    {
+      ShadowMask *last = g_queue_peek_tail (&mask_lru);
+
+      g_queue_unlink (&mask_lru, &last->link);
+      g_hash_table_remove (mask_cache, &last->key);
+      shadow_mask_free (last);
+    }
+
+  mask = g_slice_new0 (ShadowMask);
+  mask->key = *key;
+  mask->surface = shadow_mask_create (key, clip_radius, width, height);
+  mask->link.data = mask;
+
+  g_hash_table_insert (mask_cache, &mask->key, mask);
+  g_queue_push_head_link (&mask_lru, &mask->link);
+
+  return mask->surface;
+}
+
+static double
+get_device_scale (cairo_t *cr)
+{
+#ifdef HAVE_CAIRO_SURFACE_SET_DEVICE_SCALE
+  double x_scale, y_scale;
+
+  cairo_surface_get_device_scale (cairo_get_target (cr), &x_scale, &y_scale);
+
+  return x_scale;
+#else
+  return 1.0;
+#endif
+}
+
+/* The cached masks only look right if the blur around one corner
+ * never reaches the next one. */
+static gboolean
+box_fits_masks (const GtkRoundedBox *box,
+                double               clip_radius)
+{
+  return box->box.width >= MAX (box->corner[GTK_CSS_TOP_LEFT].horizontal + box->corner[GTK_CSS_TOP_RIGHT].horizontal,
+                                box->corner[GTK_CSS_BOTTOM_LEFT].horizontal + box->corner[GTK_CSS_BOTTOM_RIGHT].horizontal) + 2 * clip_radius
+      && box->box.height >= MAX (box->corner[GTK_CSS_TOP_LEFT].vertical + box->corner[GTK_CSS_BOTTOM_LEFT].vertical,
+                                 box->corner[GTK_CSS_TOP_RIGHT].vertical + box->corner[GTK_CSS_BOTTOM_RIGHT].vertical) + 2 * clip_radius;
+}
+
+static void
+paint_shadow_mask (const GtkCssValue    *shadow,
+                   cairo_t              *cr,
+                   cairo_surface_t      *surface,
+                   const cairo_matrix_t *matrix)
+{
+  cairo_pattern_t *pattern;
+
+  if (has_empty_clip (cr))
+    return;
+
+  pattern = cairo_pattern_create_for_surface (surface);
+  cairo_pattern_set_matrix (pattern, matrix);
+  cairo_pattern_set_extend (pattern, CAIRO_EXTEND_PAD);
+
+  gdk_cairo_set_source_rgba (cr, _gtk_css_rgba_value_get_rgba (shadow->color));
+  cairo_mask (cr, pattern);
+
+  cairo_pattern_destroy (pattern);
+}
+
+static void
+draw_shadow_corner (const GtkCssValue   *shadow,
+                    cairo_t             *cr,
+                    const GtkRoundedBox *box,
+                    GtkCssCorner         corner,
+                    double               clip_radius,
+                    int                  x1,
+                    int                  y1,
+                    int                  x2,
+                    int                  y2)
+{
+  ShadowMaskKey key;
+  cairo_surface_t *surface;
+  cairo_matrix_t matrix;
+  gboolean left, top;
+
+  left = corner == GTK_CSS_TOP_LEFT || corner == GTK_CSS_BOTTOM_LEFT;
+  top = corner == GTK_CSS_TOP_LEFT || corner == GTK_CSS_TOP_RIGHT;
+
+  key.radius = _gtk_css_number_value_get (shadow->radius, 0);
+  key.scale = get_device_scale (cr);
+  if (left)
+    key.offset_x = box->box.x - clip_radius - x1;
+  else
+    key.offset_x = x2 - (box->box.x + box->box.width + clip_radius);
+  if (top)
+    key.offset_y = box->box.y - clip_radius - y1;
+  else
+    key.offset_y = y2 - (box->box.y + box->box.height + clip_radius);
+  key.corner = box->corner[corner];
+  key.side = FALSE;
+
+  surface = shadow_mask_lookup (&key, clip_radius, x2 - x1, y2 - y1);
+
+  cairo_matrix_init (&matrix,
+                     left ? 1 : -1, 0,
+                     0, top ? 1 : -1,
+                     left ? -x1 : x2, top ? -y1 : y2);
+  paint_shadow_mask (shadow, cr, surface, &matrix);
+}
+
+static void
+draw_shadow_side (const GtkCssValue   *shadow,
+                  cairo_t             *cr,
+                  const GtkRoundedBox *box,
+                  GtkCssSide           side,
+                  double               clip_radius,
+                  int                  x1,
+                  int                  y1,
+                  int                  x2,
+                  int                  y2)
+{
+  ShadowMaskKey key;
+  cairo_surface_t *surface;
+  cairo_matrix_t matrix;
+  int size;
+
+  key.radius = _gtk_css_number_value_get (shadow->radius, 0);
+  key.scale = get_device_scale (cr);
+  key.offset_x = 0;
+  key.corner.horizontal = 0;
+  key.corner.vertical = 0;
+  key.side = TRUE;
+
+  /* The mask is for the top side, the others are that one
+   * flipped and/or transposed. */
+  switch (side)
+    {
+    case GTK_CSS_TOP:
+      key.offset_y = box->box.y - clip_radius - y1;
+      size = y2 - y1;
+      cairo_matrix_init (&matrix, 1, 0, 0, 1, 0, -y1);
+      break;
+    case GTK_CSS_BOTTOM:
+      key.offset_y = y2 - (box->box.y + box->box.height + clip_radius);
+      size = y2 - y1;
+      cairo_matrix_init (&matrix, 1, 0, 0, -1, 0, y2);
+      break;
+    case GTK_CSS_LEFT:
+      key.offset_y = box->box.x - clip_radius - x1;
+      size = x2 - x1;
+      cairo_matrix_init (&matrix, 0, 1, 1, 0, 0, -x1);
+      break;
+    case GTK_CSS_RIGHT:
+      key.offset_y = x2 - (box->box.x + box->box.width + clip_radius);
+      size = x2 - x1;
+      cairo_matrix_init (&matrix, 0, -1, 1, 0, 0, x2);
+      break;
+    default:
+      g_assert_not_reached ();
+      return;
+    }
+
+  surface = shadow_mask_lookup (&key, clip_radius, 1, size);
+
+  paint_shadow_mask (shadow, cr, surface, &matrix);
+}
+
 void
 _gtk_css_shadow_value_paint_box (const GtkCssValue   *shadow,
                                  cairo_t             *cr,
@@ -582,6 +881,7 @@ _gtk_css_shadow_value_paint_box (const GtkCssValue   *shadow,
       int i, x1, x2, y1, y2;
       cairo_region_t *remaining;
       cairo_rectangle_int_t r;
+      gboolean use_masks;
 
       /* For the blurred case we divide the rendering into 9 parts,
        * 4 of the corners, 4 for the horizonat/vertical lines and
@@ -614,6 +914,8 @@ _gtk_css_shadow_value_paint_box (const GtkCssValue   *shadow,
 	  remaining = cairo_region_create_rectangle (&r);
 	}
 
+      use_masks = !shadow->inset && box_fits_masks (&box, clip_radius);
+
       /* First do the corners of box */
       for (i = 0; i < 4; i++)
 	{
@@ -646,7 +948,10 @@ _gtk_css_shadow_value_paint_box (const GtkCssValue   *shadow,
 	  /* Also clip with remaining to ensure we never draw any area twice */
 	  gdk_cairo_region (cr, remaining);
 	  cairo_clip (cr);
-	  draw_shadow (shadow, cr, &box, &clip_box, TRUE);
+	  if (use_masks)
+	    draw_shadow_corner (shadow, cr, &box, i, clip_radius, x1, y1, x2, y2);
+	  else
+	    draw_shadow (shadow, cr, &box, &clip_box, TRUE);
 	  cairo_restore (cr);
 
 	  /* We drew the region, remove it from remaining */
@@ -698,7 +1003,10 @@ _gtk_css_shadow_value_paint_box (const GtkCssValue   *shadow,
 	  /* Also clip with remaining to ensure we never draw any area twice */
 	  gdk_cairo_region (cr, remaining);
 	  cairo_clip (cr);
-	  draw_shadow (shadow, cr, &box, &clip_box, TRUE);
+	  if (use_masks)
+	    draw_shadow_side (shadow, cr, &box, i, clip_radius, x1, y1, x2, y2);
+	  else
+	    draw_shadow (shadow, cr, &box, &clip_box, TRUE);
 	  cairo_restore (cr);
 
 	  /* We drew the region, remove it from remaining */
@@ -40,6 +40,8 @@ _gtk_css_value_alloc (const GtkCssValueClass *klass,
   value->class = klass;
   value->ref_count = 1;
 
+  _gtk_counter_add (GTK_COUNTER_CSS_VALUES, 1);
+
   return value;
 }
 
@@ -62,6 +64,8 @@ _gtk_css_value_unref (GtkCssValue *value)
   if (!g_atomic_int_dec_and_test (&value->ref_count))
     return;
 
+  _gtk_counter_add (GTK_COUNTER_CSS_VALUES, -1);
+
   value->class->free (value);
 }
 
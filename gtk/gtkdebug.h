@@ -49,7 +49,9 @@ typedef enum {
   GTK_DEBUG_PRINTING        = 1 << 10,
   GTK_DEBUG_BUILDER         = 1 << 11,
   GTK_DEBUG_SIZE_REQUEST    = 1 << 12,
-  GTK_DEBUG_NO_CSS_CACHE    = 1 << 13
+  GTK_DEBUG_NO_CSS_CACHE    = 1 << 13,
+  GTK_DEBUG_CSS_SECTIONS    = 1 << 14,
+  GTK_DEBUG_MEMORY          = 1 << 15
 } GtkDebugFlag;
 
 #ifdef G_ENABLE_DEBUG
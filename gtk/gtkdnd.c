@@ -752,12 +752,11 @@ ensure_drag_cursor_pixbuf (int i)
   if (drag_cursors[i].pixbuf == NULL)
     {
       char *path = g_strconcat ("/org/gtk/libgtk/cursor/",  drag_cursors[i].name, ".png", NULL);
-      GInputStream *stream = g_resources_open_stream (path, 0, NULL);
-      if (stream != NULL)
-	{
-	  drag_cursors[i].pixbuf = gdk_pixbuf_new_from_stream (stream, NULL, NULL);
-	  g_object_unref (stream);
-	}
+
+      /* The cursors are stored as pixdata, so this uses the pixels
+       * in the resource directly instead of decoding a PNG.
+       */
+      drag_cursors[i].pixbuf = gdk_pixbuf_new_from_resource (path, NULL);
       g_free (path);
     }
 }
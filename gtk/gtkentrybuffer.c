@@ -75,6 +75,11 @@ struct _GtkEntryBufferPrivate
   gsize  normal_text_bytes;
   guint  normal_text_chars;
 
+  /* A known char offset and its byte offset in normal_text, usually
+   * where the last change happened */
+  guint  cached_char;
+  gsize  cached_byte;
+
   gint   max_length;
 };
 
@@ -98,6 +103,57 @@ trash_area (gchar *area,
     *varea++ = 0;
 }
 
+/* Converts a char offset into a byte offset in normal_text.
+ *
+ * Edits tend to happen close to each other, so instead of counting
+ * from the start of the text every time, this starts from whichever of
+ * the start, the end or the position of the last edit is closest. That
+ * keeps typing into a long text from being linear in its length.
+ */
+static gsize
+gtk_entry_buffer_normal_get_byte_offset (GtkEntryBufferPrivate *pv,
+                                         guint                  position)
+{
+  const gchar *p;
+  guint offset;
+
+  if (position <= pv->cached_char / 2)
+    return g_utf8_offset_to_pointer (pv->normal_text, position) - pv->normal_text;
+
+  if (position >= pv->cached_char)
+    {
+      if (position - pv->cached_char <= pv->normal_text_chars - position)
+        {
+          p = pv->normal_text + pv->cached_byte;
+          offset = pv->cached_char;
+        }
+      else
+        {
+          p = pv->normal_text + pv->normal_text_bytes;
+          offset = pv->normal_text_chars;
+        }
+    }
+  else
+    {
+      p = pv->normal_text + pv->cached_byte;
+      offset = pv->cached_char;
+    }
+
+  while (offset < position)
+    {
+      p = g_utf8_next_char (p);
+      offset++;
+    }
+
+  while (offset > position)
+    {
+      p = g_utf8_prev_char (p);
+      offset--;
+    }
+
+  return p - pv->normal_text;
+}
+
 static const gchar*
 gtk_entry_buffer_normal_get_text (GtkEntryBuffer *buffer,
                                   gsize          *n_bytes)
@@ -158,16 +214,18 @@ gtk_entry_buffer_normal_insert_text (GtkEntryBuffer *buffer,
             }
         }
 
-      /* Could be a password, so can't leave stuff in memory. */
+      /* Could be a password, so can't leave stuff in memory. Only the
+       * text is copied, the rest of the old allocation is unused. */
       et_new = g_malloc (pv->normal_text_size);
-      memcpy (et_new, pv->normal_text, MIN (prev_size, pv->normal_text_size));
+      if (pv->normal_text)
+        memcpy (et_new, pv->normal_text, pv->normal_text_bytes + 1);
       trash_area (pv->normal_text, prev_size);
       g_free (pv->normal_text);
       pv->normal_text = et_new;
     }
 
   /* Actual text insertion */
-  at = g_utf8_offset_to_pointer (pv->normal_text, position) - pv->normal_text;
+  at = gtk_entry_buffer_normal_get_byte_offset (pv, position);
   g_memmove (pv->normal_text + at + n_bytes, pv->normal_text + at, pv->normal_text_bytes - at);
   memcpy (pv->normal_text + at, chars, n_bytes);
 
@@ -175,6 +233,8 @@ gtk_entry_buffer_normal_insert_text (GtkEntryBuffer *buffer,
   pv->normal_text_bytes += n_bytes;
   pv->normal_text_chars += n_chars;
   pv->normal_text[pv->normal_text_bytes] = '\0';
+  pv->cached_char = position + n_chars;
+  pv->cached_byte = at + n_bytes;
 
   gtk_entry_buffer_emit_inserted_text (buffer, position, chars, n_chars);
   return n_chars;
@@ -195,12 +255,14 @@ gtk_entry_buffer_normal_delete_text (GtkEntryBuffer *buffer,
 
   if (n_chars > 0)
     {
-      start = g_utf8_offset_to_pointer (pv->normal_text, position) - pv->normal_text;
-      end = g_utf8_offset_to_pointer (pv->normal_text, position + n_chars) - pv->normal_text;
+      start = gtk_entry_buffer_normal_get_byte_offset (pv, position);
+      end = g_utf8_offset_to_pointer (pv->normal_text + start, n_chars) - pv->normal_text;
 
       g_memmove (pv->normal_text + start, pv->normal_text + end, pv->normal_text_bytes + 1 - end);
       pv->normal_text_chars -= n_chars;
       pv->normal_text_bytes -= (end - start);
+      pv->cached_char = position;
+      pv->cached_byte = start;
 
       /*
        * Could be a password, make sure we don't leave anything sensitive after
@@ -253,6 +315,8 @@ gtk_entry_buffer_init (GtkEntryBuffer *buffer)
   pv->normal_text_chars = 0;
   pv->normal_text_bytes = 0;
   pv->normal_text_size = 0;
+  pv->cached_char = 0;
+  pv->cached_byte = 0;
 }
 
 static void
@@ -778,6 +778,9 @@ gtk_entry_completion_finalize (GObject *object)
   g_free (priv->case_normalized_key);
   g_free (priv->completion_prefix);
 
+  if (priv->normalized_texts)
+    g_hash_table_unref (priv->normalized_texts);
+
   if (priv->match_notify)
     (* priv->match_notify) (priv->match_data);
 
@@ -921,6 +924,7 @@ gtk_entry_completion_default_completion_func (GtkEntryCompletion *completion,
                                               GtkTreeIter        *iter,
                                               gpointer            user_data)
 {
+  GtkEntryCompletionPrivate *priv = completion->priv;
   gchar *item = NULL;
   gchar *normalized_string;
   gchar *case_normalized_string;
@@ -929,30 +933,44 @@ gtk_entry_completion_default_completion_func (GtkEntryCompletion *completion,
 
   GtkTreeModel *model;
 
-  model = gtk_tree_model_filter_get_model (completion->priv->filter_model);
+  model = gtk_tree_model_filter_get_model (priv->filter_model);
 
-  g_return_val_if_fail (gtk_tree_model_get_column_type (model, completion->priv->text_column) == G_TYPE_STRING,
+  g_return_val_if_fail (gtk_tree_model_get_column_type (model, priv->text_column) == G_TYPE_STRING,
                         FALSE);
 
   gtk_tree_model_get (model, iter,
-                      completion->priv->text_column, &item,
+                      priv->text_column, &item,
                       -1);
 
-  if (item != NULL)
+  if (item == NULL)
+    return FALSE;
+
+  /* Normalizing every row again on each keystroke dominates the cost
+   * of refiltering large models, so remember the normalized texts.
+   */
+  if (priv->normalized_texts == NULL)
+    priv->normalized_texts = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                    g_free, g_free);
+
+  if (!g_hash_table_lookup_extended (priv->normalized_texts, item,
+                                     NULL, (gpointer *) &case_normalized_string))
     {
       normalized_string = g_utf8_normalize (item, -1, G_NORMALIZE_ALL);
 
       if (normalized_string != NULL)
-        {
-          case_normalized_string = g_utf8_casefold (normalized_string, -1);
-
-          if (!strncmp (key, case_normalized_string, strlen (key)))
-            ret = TRUE;
-
-          g_free (case_normalized_string);
-        }
+        case_normalized_string = g_utf8_casefold (normalized_string, -1);
+      else
+        case_normalized_string = NULL;
       g_free (normalized_string);
+
+      g_hash_table_insert (priv->normalized_texts, item, case_normalized_string);
+      item = NULL;
     }
+
+  if (case_normalized_string != NULL &&
+      g_str_has_prefix (case_normalized_string, key))
+    ret = TRUE;
+
   g_free (item);
 
   return ret;
@@ -1212,6 +1230,9 @@ gtk_entry_completion_set_model (GtkEntryCompletion *completion,
   g_return_if_fail (GTK_IS_ENTRY_COMPLETION (completion));
   g_return_if_fail (model == NULL || GTK_IS_TREE_MODEL (model));
 
+  if (completion->priv->normalized_texts)
+    g_hash_table_remove_all (completion->priv->normalized_texts);
+
   if (!model)
     {
       gtk_tree_view_set_model (GTK_TREE_VIEW (completion->priv->tree_view),
@@ -49,6 +49,9 @@ struct _GtkEntryCompletionPrivate
 
   gchar *case_normalized_key;
 
+  /* maps row texts to their case normalized form */
+  GHashTable *normalized_texts;
+
   /* only used by GtkEntry when attached: */
   GtkWidget *popup_window;
   GtkWidget *vbox;
@@ -199,6 +199,14 @@ typedef enum {
 #define MODEL_ATTRIBUTES "standard::name,standard::type,standard::display-name," \
                          "standard::is-hidden,standard::is-backup,standard::size," \
                          "standard::content-type,time::modified"
+/* Used for listing folders when the filter doesn't need mime types.
+ * Finding the real content type may mean reading every file, which is
+ * slow on network mounts; the rows that are shown get it later, along
+ * with their icon.
+ */
+#define MODEL_ATTRIBUTES_CHEAP "standard::name,standard::type,standard::display-name," \
+                               "standard::is-hidden,standard::is-backup,standard::size," \
+                               "time::modified"
 enum {
   /* the first 3 must be these due to settings caching sort column */
   MODEL_COL_NAME,
@@ -406,6 +414,10 @@ static void location_switch_to_path_bar (GtkFileChooserDefault *impl);
 static void stop_loading_and_clear_list_model (GtkFileChooserDefault *impl,
                                                gboolean remove_from_treeview);
 
+static void cancel_thumbnail_loads   (GtkFileChooserDefault *impl);
+static void browse_files_scrolled_cb (GtkAdjustment         *adjustment,
+                                      GtkFileChooserDefault *impl);
+
 static void     search_setup_widgets         (GtkFileChooserDefault *impl);
 static void     search_stop_searching        (GtkFileChooserDefault *impl,
                                               gboolean               remove_query);
@@ -742,6 +754,7 @@ _gtk_file_chooser_default_init (GtkFileChooserDefault *impl)
   impl->sort_order = GTK_SORT_ASCENDING;
   impl->recent_manager = gtk_recent_manager_get_default ();
   impl->create_folders = TRUE;
+  impl->thumbnail_loads = g_hash_table_new (g_file_hash, (GEqualFunc) g_file_equal);
 
   gtk_orientable_set_orientation (GTK_ORIENTABLE (impl),
                                   GTK_ORIENTATION_VERTICAL);
@@ -837,6 +850,8 @@ gtk_file_chooser_default_finalize (GObject *object)
 
   unset_file_system_backend (impl);
 
+  g_hash_table_destroy (impl->thumbnail_loads);
+
   if (impl->shortcuts_pane_filter_model)
     g_object_unref (impl->shortcuts_pane_filter_model);
 
@@ -4427,6 +4442,9 @@ create_file_list (GtkFileChooserDefault *impl)
 				  GTK_POLICY_AUTOMATIC, GTK_POLICY_ALWAYS);
   gtk_scrolled_window_set_shadow_type (GTK_SCROLLED_WINDOW (swin),
 				       GTK_SHADOW_IN);
+  g_signal_connect (gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (swin)),
+                    "value-changed",
+                    G_CALLBACK (browse_files_scrolled_cb), impl);
 
   /* Tree/list view */
 
@@ -5751,6 +5769,8 @@ cancel_all_operations (GtkFileChooserDefault *impl)
 
   pending_select_files_free (impl);
 
+  cancel_thumbnail_loads (impl);
+
   if (impl->reload_icon_cancellables)
     {
       for (l = impl->reload_icon_cancellables; l; l = l->next)
@@ -6622,6 +6642,8 @@ stop_loading_and_clear_list_model (GtkFileChooserDefault *impl,
                                    gboolean remove_from_treeview)
 {
   load_remove_timer (impl, LOAD_EMPTY);
+
+  cancel_thumbnail_loads (impl);
   
   if (impl->browse_files_model)
     {
@@ -6774,6 +6796,7 @@ file_system_model_got_thumbnail (GObject *object, GAsyncResult *res, gpointer da
   copy_attribute (info, queried, G_FILE_ATTRIBUTE_THUMBNAIL_PATH);
   copy_attribute (info, queried, G_FILE_ATTRIBUTE_THUMBNAILING_FAILED);
   copy_attribute (info, queried, G_FILE_ATTRIBUTE_STANDARD_ICON);
+  copy_attribute (info, queried, G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE);
 
   _gtk_file_system_model_update_file (model, file, info);
 
@@ -6782,6 +6805,208 @@ file_system_model_got_thumbnail (GObject *object, GAsyncResult *res, gpointer da
   GDK_THREADS_LEAVE ();
 }
 
+/* Whether the row of @file is in the visible part of the file list */
+static gboolean
+browse_file_is_visible (GtkFileChooserDefault *impl,
+                        GtkFileSystemModel    *model,
+                        GFile                 *file)
+{
+  GtkTreeModel *tree_model;
+  GtkTreePath *path, *start, *end;
+  GtkTreeIter iter;
+  gboolean visible;
+
+  if (impl->browse_files_tree_view == NULL)
+    return FALSE;
+
+  tree_model = gtk_tree_view_get_model (GTK_TREE_VIEW (impl->browse_files_tree_view));
+  if (tree_model != GTK_TREE_MODEL (model))
+    return FALSE;
+
+  if (!_gtk_file_system_model_get_iter_for_file (model, &iter, file))
+    return FALSE;
+
+  if (!gtk_tree_view_get_visible_range (GTK_TREE_VIEW (impl->browse_files_tree_view), &start, &end))
+    return FALSE;
+
+  path = gtk_tree_model_get_path (tree_model, &iter);
+  visible = (gtk_tree_path_compare (start, path) != 1 &&
+             gtk_tree_path_compare (path, end) != 1);
+
+  gtk_tree_path_free (path);
+  gtk_tree_path_free (start);
+  gtk_tree_path_free (end);
+
+  return visible;
+}
+
+/* Thumbnails are decoded in worker threads, and only for the rows
+ * that are visible; the rows show the icon of their file type until
+ * the thumbnail is ready. The decoded thumbnail is kept in the file
+ * info of the row, so that it is not decoded again when the row is
+ * scrolled away and back.
+ */
+#define THUMBNAIL_ATTRIBUTE		"filechooser::thumbnail"
+#define THUMBNAIL_SIZE_ATTRIBUTE	"filechooser::thumbnail-size"
+#define THUMBNAIL_FAILED_ATTRIBUTE	"filechooser::thumbnail-failed"
+
+typedef struct
+{
+  GtkFileChooserDefault *impl;
+  GtkFileSystemModel *model;
+  GFile *file;
+  GCancellable *cancellable;
+  gint icon_size;
+} ThumbnailLoadData;
+
+static void
+thumbnail_load_data_free (ThumbnailLoadData *data)
+{
+  g_object_unref (data->model);
+  g_object_unref (data->file);
+  g_object_unref (data->cancellable);
+  g_slice_free (ThumbnailLoadData, data);
+}
+
+/* Drops the cached icon of the row, so that the thumbnail is requested
+ * again when the row is shown
+ */
+static void
+thumbnail_load_reset_row (ThumbnailLoadData *data)
+{
+  GtkTreeIter iter;
+  GFileInfo *info;
+
+  if (!_gtk_file_system_model_get_iter_for_file (data->model, &iter, data->file))
+    return;
+
+  info = g_file_info_dup (_gtk_file_system_model_get_info (data->model, &iter));
+  _gtk_file_system_model_update_file (data->model, data->file, info);
+  g_object_unref (info);
+}
+
+static void
+thumbnail_loaded_cb (GObject      *source_object,
+                     GAsyncResult *result,
+                     gpointer      user_data)
+{
+  ThumbnailLoadData *data = user_data;
+  GdkPixbuf *pixbuf;
+  GError *error = NULL;
+  GtkTreeIter iter;
+
+  pixbuf = _gtk_file_info_load_thumbnail_finish (result, &error);
+
+  /* whoever cancelled the load has already forgotten about it, and
+   * impl may be gone
+   */
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    {
+      g_error_free (error);
+      thumbnail_load_data_free (data);
+      return;
+    }
+
+  GDK_THREADS_ENTER ();
+
+  g_hash_table_remove (data->impl->thumbnail_loads, data->file);
+
+  if (_gtk_file_system_model_get_iter_for_file (data->model, &iter, data->file))
+    {
+      GFileInfo *info;
+
+      info = g_file_info_dup (_gtk_file_system_model_get_info (data->model, &iter));
+
+      if (pixbuf)
+        {
+          g_file_info_set_attribute_object (info, THUMBNAIL_ATTRIBUTE, G_OBJECT (pixbuf));
+          g_file_info_set_attribute_uint32 (info, THUMBNAIL_SIZE_ATTRIBUTE, data->icon_size);
+        }
+      else
+        g_file_info_set_attribute_boolean (info, THUMBNAIL_FAILED_ATTRIBUTE, TRUE);
+
+      _gtk_file_system_model_update_file (data->model, data->file, info);
+      g_object_unref (info);
+    }
+
+  GDK_THREADS_LEAVE ();
+
+  if (pixbuf)
+    g_object_unref (pixbuf);
+  if (error)
+    g_error_free (error);
+
+  thumbnail_load_data_free (data);
+}
+
+static void
+load_thumbnail (GtkFileChooserDefault *impl,
+                GtkFileSystemModel    *model,
+                GFile                 *file,
+                GFileInfo             *info)
+{
+  ThumbnailLoadData *data;
+
+  data = g_slice_new (ThumbnailLoadData);
+  data->impl = impl;
+  data->model = g_object_ref (model);
+  data->file = g_object_ref (file);
+  data->cancellable = g_cancellable_new ();
+  data->icon_size = impl->icon_size;
+
+  g_hash_table_insert (impl->thumbnail_loads, data->file, data);
+
+  _gtk_file_info_load_thumbnail_async (info,
+                                       impl->icon_size,
+                                       data->cancellable,
+                                       thumbnail_loaded_cb,
+                                       data);
+}
+
+static void
+cancel_thumbnail_loads (GtkFileChooserDefault *impl)
+{
+  GHashTableIter iter;
+  ThumbnailLoadData *data;
+
+  g_hash_table_iter_init (&iter, impl->thumbnail_loads);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &data))
+    g_cancellable_cancel (data->cancellable);
+
+  g_hash_table_remove_all (impl->thumbnail_loads);
+}
+
+/* Cancels the thumbnail loads of the rows that were scrolled away */
+static void
+browse_files_scrolled_cb (GtkAdjustment         *adjustment,
+                          GtkFileChooserDefault *impl)
+{
+  GHashTableIter iter;
+  ThumbnailLoadData *data;
+  GSList *hidden, *l;
+
+  hidden = NULL;
+
+  g_hash_table_iter_init (&iter, impl->thumbnail_loads);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &data))
+    {
+      if (!browse_file_is_visible (impl, data->model, data->file))
+        {
+          g_cancellable_cancel (data->cancellable);
+          g_hash_table_iter_remove (&iter);
+          hidden = g_slist_prepend (hidden, data);
+        }
+    }
+
+  /* updating the rows may run the model's callbacks, so don't do it
+   * while iterating
+   */
+  for (l = hidden; l; l = l->next)
+    thumbnail_load_reset_row (l->data);
+
+  g_slist_free (hidden);
+}
+
 static gboolean
 file_system_model_set (GtkFileSystemModel *model,
                        GFile              *file,
@@ -6845,46 +7070,56 @@ file_system_model_set (GtkFileSystemModel *model,
         {
           if (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_ICON))
             {
-              g_value_take_object (value, _gtk_file_info_render_icon (info, GTK_WIDGET (impl), impl->icon_size));
+              GObject *thumbnail;
+
+              if (!g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_THUMBNAIL_PATH) ||
+                  g_file_info_has_attribute (info, THUMBNAIL_FAILED_ATTRIBUTE))
+                {
+                  g_value_take_object (value, _gtk_file_info_render_type_icon (info, GTK_WIDGET (impl), impl->icon_size));
+                  break;
+                }
+
+              thumbnail = g_file_info_get_attribute_object (info, THUMBNAIL_ATTRIBUTE);
+              if (thumbnail != NULL &&
+                  g_file_info_get_attribute_uint32 (info, THUMBNAIL_SIZE_ATTRIBUTE) == (guint32) impl->icon_size)
+                {
+                  g_value_set_object (value, thumbnail);
+                  break;
+                }
+
+              if (g_hash_table_lookup (impl->thumbnail_loads, file) == NULL)
+                {
+                  /* Leave the rows that are not shown empty; their
+                   * thumbnails are loaded once they are scrolled to
+                   */
+                  if (!browse_file_is_visible (impl, model, file))
+                    return FALSE;
+
+                  load_thumbnail (impl, model, file, info);
+                }
+
+              g_value_take_object (value, _gtk_file_info_render_type_icon (info, GTK_WIDGET (impl), impl->icon_size));
             }
           else
             {
-              GtkTreeModel *tree_model;
-              GtkTreePath *path, *start, *end;
-              GtkTreeIter iter;
-
               if (impl->browse_files_tree_view == NULL ||
                   g_file_info_has_attribute (info, "filechooser::queried"))
                 return FALSE;
 
-              tree_model = gtk_tree_view_get_model (GTK_TREE_VIEW (impl->browse_files_tree_view));
-              if (tree_model != GTK_TREE_MODEL (model))
-                return FALSE;
-
-              if (!_gtk_file_system_model_get_iter_for_file (model,
-                                                             &iter,
-                                                             file))
-                g_assert_not_reached ();
-              if (!gtk_tree_view_get_visible_range (GTK_TREE_VIEW (impl->browse_files_tree_view), &start, &end))
-                return FALSE;
-              path = gtk_tree_model_get_path (tree_model, &iter);
-              if (gtk_tree_path_compare (start, path) != 1 &&
-                  gtk_tree_path_compare (path, end) != 1)
+              if (browse_file_is_visible (impl, model, file))
                 {
                   g_file_info_set_attribute_boolean (info, "filechooser::queried", TRUE);
                   g_file_query_info_async (file,
                                            G_FILE_ATTRIBUTE_THUMBNAIL_PATH ","
                                            G_FILE_ATTRIBUTE_THUMBNAILING_FAILED ","
-                                           G_FILE_ATTRIBUTE_STANDARD_ICON,
+                                           G_FILE_ATTRIBUTE_STANDARD_ICON ","
+                                           G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE,
                                            G_FILE_QUERY_INFO_NONE,
                                            G_PRIORITY_DEFAULT,
                                            _gtk_file_system_model_get_cancellable (model),
                                            file_system_model_got_thumbnail,
                                            model);
                 }
-              gtk_tree_path_free (path);
-              gtk_tree_path_free (start);
-              gtk_tree_path_free (end);
               return FALSE;
             }
         }
@@ -6926,6 +7161,13 @@ file_system_model_set (GtkFileSystemModel *model,
   return TRUE;
 }
 
+static gboolean
+filter_needs_content_type (GtkFileFilter *filter)
+{
+  return filter != NULL &&
+         (gtk_file_filter_get_needed (filter) & GTK_FILE_FILTER_MIME_TYPE) != 0;
+}
+
 /* Gets rid of the old list model and creates a new one for the current folder */
 static gboolean
 set_list_model (GtkFileChooserDefault *impl,
@@ -6939,9 +7181,12 @@ set_list_model (GtkFileChooserDefault *impl,
 
   set_busy_cursor (impl, TRUE);
 
+  impl->browse_files_have_content_type = filter_needs_content_type (impl->current_filter);
   impl->browse_files_model = 
     _gtk_file_system_model_new_for_directory (impl->current_folder,
-					      MODEL_ATTRIBUTES,
+					      impl->browse_files_have_content_type
+					      ? MODEL_ATTRIBUTES
+					      : MODEL_ATTRIBUTES_CHEAP,
 					      file_system_model_set,
 					      impl,
 					      MODEL_COLUMN_TYPES);
@@ -9670,8 +9915,16 @@ set_current_filter (GtkFileChooserDefault *impl,
 
       if (impl->browse_files_model)
         {
-          _gtk_file_system_model_set_filter (impl->browse_files_model, impl->current_filter);
-          _gtk_file_system_model_clear_cache (impl->browse_files_model, MODEL_COL_IS_SENSITIVE);
+          /* The folder was listed without content types; list it again */
+          if (!impl->browse_files_have_content_type &&
+              filter_needs_content_type (impl->current_filter) &&
+              impl->current_folder != NULL)
+            set_list_model (impl, NULL);
+          else
+            {
+              _gtk_file_system_model_set_filter (impl->browse_files_model, impl->current_filter);
+              _gtk_file_system_model_clear_cache (impl->browse_files_model, MODEL_COL_IS_SENSITIVE);
+            }
         }
 
       if (impl->search_model)
@@ -248,6 +248,7 @@ struct _GtkFileChooserDefault
   GCancellable *file_exists_get_info_cancellable;
   GCancellable *update_from_entry_cancellable;
   GCancellable *shortcuts_activate_iter_cancellable;
+  GHashTable *thumbnail_loads;
 
   LoadState load_state;
   ReloadState reload_state;
@@ -313,6 +314,7 @@ struct _GtkFileChooserDefault
   guint has_recent: 1;
   guint show_size_column : 1;
   guint create_folders : 1;
+  guint browse_files_have_content_type : 1;
 
 #if 0
   guint shortcuts_drag_outside : 1;
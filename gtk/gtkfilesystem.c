@@ -1718,12 +1718,35 @@ _gtk_file_system_volume_unref (GtkFileSystemVolume *volume)
 }
 
 /* GFileInfo helper functions */
+GdkPixbuf *
+_gtk_file_info_render_type_icon (GFileInfo *info,
+				 GtkWidget *widget,
+				 gint       icon_size)
+{
+  GIcon *icon;
+  GdkPixbuf *pixbuf = NULL;
+
+  icon = g_file_info_get_icon (info);
+
+  if (icon)
+    pixbuf = get_pixbuf_from_gicon (icon, widget, icon_size, NULL);
+
+  if (!pixbuf)
+    {
+       /* Use general fallback for all files without icon */
+      icon = g_themed_icon_new ("text-x-generic");
+      pixbuf = get_pixbuf_from_gicon (icon, widget, icon_size, NULL);
+      g_object_unref (icon);
+    }
+
+  return pixbuf;
+}
+
 GdkPixbuf *
 _gtk_file_info_render_icon (GFileInfo *info,
 			   GtkWidget *widget,
 			   gint       icon_size)
 {
-  GIcon *icon;
   GdkPixbuf *pixbuf = NULL;
   const gchar *thumbnail_path;
 
@@ -1735,22 +1758,88 @@ _gtk_file_info_render_icon (GFileInfo *info,
 					       NULL);
 
   if (!pixbuf)
-    {
-      icon = g_file_info_get_icon (info);
+    pixbuf = _gtk_file_info_render_type_icon (info, widget, icon_size);
 
-      if (icon)
-	pixbuf = get_pixbuf_from_gicon (icon, widget, icon_size, NULL);
+  return pixbuf;
+}
 
-      if (!pixbuf)
-	{
-	   /* Use general fallback for all files without icon */
-	  icon = g_themed_icon_new ("text-x-generic");
-	  pixbuf = get_pixbuf_from_gicon (icon, widget, icon_size, NULL);
-	  g_object_unref (icon);
-	}
+typedef struct
+{
+  gchar *thumbnail_path;
+  gint icon_size;
+} ThumbnailLoad;
+
+static void
+thumbnail_load_free (ThumbnailLoad *load)
+{
+  g_free (load->thumbnail_path);
+  g_slice_free (ThumbnailLoad, load);
+}
+
+static void
+load_thumbnail_thread (GTask        *task,
+                       gpointer      source_object,
+                       gpointer      task_data,
+                       GCancellable *cancellable)
+{
+  ThumbnailLoad *load = task_data;
+  GdkPixbuf *pixbuf;
+  GError *error = NULL;
+
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
+  pixbuf = gdk_pixbuf_new_from_file_at_size (load->thumbnail_path,
+                                             load->icon_size, load->icon_size,
+                                             &error);
+  if (pixbuf)
+    g_task_return_pointer (task, pixbuf, g_object_unref);
+  else
+    g_task_return_error (task, error);
+}
+
+/* Decodes the thumbnail of @info in a worker thread. The thumbnails
+ * are loaded with a low priority, so that loading the thumbnails of
+ * a large folder doesn't hold up other I/O; cancel @cancellable when
+ * the thumbnail is no longer needed.
+ */
+void
+_gtk_file_info_load_thumbnail_async (GFileInfo           *info,
+                                     gint                 icon_size,
+                                     GCancellable        *cancellable,
+                                     GAsyncReadyCallback  callback,
+                                     gpointer             user_data)
+{
+  const gchar *thumbnail_path;
+  ThumbnailLoad *load;
+  GTask *task;
+
+  task = g_task_new (NULL, cancellable, callback, user_data);
+  g_task_set_priority (task, G_PRIORITY_LOW);
+
+  thumbnail_path = g_file_info_get_attribute_byte_string (info, G_FILE_ATTRIBUTE_THUMBNAIL_PATH);
+  if (thumbnail_path == NULL)
+    {
+      g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_NOT_FOUND,
+                               "No thumbnail");
+      g_object_unref (task);
+      return;
     }
 
-  return pixbuf;
+  load = g_slice_new (ThumbnailLoad);
+  load->thumbnail_path = g_strdup (thumbnail_path);
+  load->icon_size = icon_size;
+
+  g_task_set_task_data (task, load, (GDestroyNotify) thumbnail_load_free);
+  g_task_run_in_thread (task, load_thumbnail_thread);
+  g_object_unref (task);
+}
+
+GdkPixbuf *
+_gtk_file_info_load_thumbnail_finish (GAsyncResult  *result,
+                                      GError       **error)
+{
+  return g_task_propagate_pointer (G_TASK (result), error);
 }
 
 gboolean
@@ -177,6 +177,17 @@ void                   _gtk_file_system_bookmark_free          (GtkFileSystemBoo
 GdkPixbuf *     _gtk_file_info_render_icon (GFileInfo *info,
 					    GtkWidget *widget,
 					    gint       icon_size);
+GdkPixbuf *     _gtk_file_info_render_type_icon (GFileInfo *info,
+						 GtkWidget *widget,
+						 gint       icon_size);
+
+void            _gtk_file_info_load_thumbnail_async  (GFileInfo           *info,
+						      gint                 icon_size,
+						      GCancellable        *cancellable,
+						      GAsyncReadyCallback  callback,
+						      gpointer             user_data);
+GdkPixbuf *     _gtk_file_info_load_thumbnail_finish (GAsyncResult        *result,
+						      GError             **error);
 
 gboolean	_gtk_file_info_consider_as_directory (GFileInfo *info);
 
@@ -117,6 +117,20 @@
  * freeze_updates()) during the intial population process.  When the model is
  * frozen, sorting will not happen.  The model will sort itself when the freeze
  * count goes back to zero, via corresponding calls to thaw_updates().
+ *
+ * Sorting works on an array of indexes, and the nodes are moved into their
+ * new places only once at the end, as nodes are large and moving them around
+ * during the sort would be expensive.
+ *
+ * Loading
+ * -------
+ *
+ * When a directory is loaded, the first FILES_SHOWN_IMMEDIATELY files are
+ * added and shown right away, so that the first screenful appears quickly.
+ * The model then stays frozen while the rest of the directory is enumerated,
+ * and only sorts and emits the new rows once, when loading is done.  For
+ * non-native directories, which may load slowly, the model is also thawed
+ * every LOAD_THAW_INTERVAL milliseconds, so that progress is visible.
  */
 
 /*** DEFINES ***/
@@ -129,6 +143,12 @@
 /* random number that everyone else seems to use, too */
 #define FILES_PER_QUERY 100
 
+/* number of files shown before the rest of the directory is loaded */
+#define FILES_SHOWN_IMMEDIATELY FILES_PER_QUERY
+
+/* milliseconds between updates while loading a non-native directory */
+#define LOAD_THAW_INTERVAL 1000
+
 typedef struct _FileModelNode           FileModelNode;
 typedef struct _GtkFileSystemModelClass GtkFileSystemModelClass;
 
@@ -186,6 +206,8 @@ struct _GtkFileSystemModel
 
   gboolean              filter_on_thaw :1;/* set when filtering needs to happen upon thawing */
   gboolean              sort_on_thaw :1;/* set when sorting needs to happen upon thawing */
+  guint                 loading_frozen :1;/* set while the model is frozen for loading the directory */
+  guint                 shown_first_files :1;/* set once the first files of the directory are shown */
 
   guint                 show_hidden :1; /* whether to show hidden files */
   guint                 show_folders :1;/* whether to show folders */
@@ -755,13 +777,13 @@ sort_data_init (SortData *data, GtkFileSystemModel *model)
 }
 
 static int
-compare_array_element (gconstpointer a, gconstpointer b, gpointer user_data)
+compare_node_indexes (gconstpointer a, gconstpointer b, gpointer user_data)
 {
   SortData *data = user_data;
   GtkTreeIter itera, iterb;
 
-  ITER_INIT_FROM_INDEX (data->model, &itera, node_index (data->model, a));
-  ITER_INIT_FROM_INDEX (data->model, &iterb, node_index (data->model, b));
+  ITER_INIT_FROM_INDEX (data->model, &itera, *(const guint *) a);
+  ITER_INIT_FROM_INDEX (data->model, &iterb, *(const guint *) b);
   return data->func (GTK_TREE_MODEL (data->model), &itera, &iterb, data->data) * data->order;
 }
 
@@ -779,18 +801,37 @@ gtk_file_system_model_sort (GtkFileSystemModel *model)
   if (sort_data_init (&data, model))
     {
       GtkTreePath *path;
-      guint i;
+      GArray *sorted;
+      guint *indexes;
+      guint i, n_indexes;
       guint r, n_visible_rows;
 
       node_validate_rows (model, G_MAXUINT, G_MAXUINT);
       n_visible_rows = node_get_tree_row (model, model->files->len - 1) + 1;
       model->n_nodes_valid = 0;
       g_hash_table_remove_all (model->file_lookup);
-      g_qsort_with_data (get_node (model, 1), /* start at index 1; don't sort the editable row */
-                         model->files->len - 1,
-                         model->node_size,
-                         compare_array_element,
+
+      /* start at index 1; don't sort the editable row */
+      n_indexes = model->files->len - 1;
+      indexes = g_new (guint, n_indexes);
+      for (i = 0; i < n_indexes; i++)
+        indexes[i] = i + 1;
+      g_qsort_with_data (indexes,
+                         n_indexes,
+                         sizeof (guint),
+                         compare_node_indexes,
                          &data);
+
+      sorted = g_array_sized_new (FALSE, FALSE, model->node_size, model->files->len);
+      g_array_append_vals (sorted, get_node (model, 0), 1);
+      for (i = 0; i < n_indexes; i++)
+        g_array_append_vals (sorted, get_node (model, indexes[i]), 1);
+      g_free (indexes);
+
+      /* the nodes were moved, not copied */
+      g_array_free (model->files, TRUE);
+      model->files = sorted;
+
       g_assert (model->n_nodes_valid == 0);
       g_assert (g_hash_table_size (model->file_lookup) == 0);
       if (n_visible_rows)
@@ -1122,18 +1163,46 @@ thaw_func (gpointer data)
 {
   GtkFileSystemModel *model = data;
 
-  thaw_updates (model);
   model->dir_thaw_source = 0;
+  model->loading_frozen = FALSE;
+  thaw_updates (model);
 
   return FALSE;
 }
 
+static void
+add_enumerated_files (GtkFileSystemModel *model,
+                      GList              *files)
+{
+  GList *walk;
+
+  for (walk = files; walk; walk = walk->next)
+    {
+      const char *name;
+      GFileInfo *info;
+      GFile *file;
+
+      info = walk->data;
+      name = g_file_info_get_name (info);
+      if (name == NULL)
+        {
+          /* Shouldn't happen, but the APIs allow it */
+          g_object_unref (info);
+          continue;
+        }
+      file = g_file_get_child (model->dir, name);
+      add_file (model, file, info);
+      g_object_unref (file);
+      g_object_unref (info);
+    }
+}
+
 static void
 gtk_file_system_model_got_files (GObject *object, GAsyncResult *res, gpointer data)
 {
   GFileEnumerator *enumerator = G_FILE_ENUMERATOR (object);
   GtkFileSystemModel *model = data;
-  GList *walk, *files;
+  GList *files;
   GError *error = NULL;
 
   gdk_threads_enter ();
@@ -1142,34 +1211,30 @@ gtk_file_system_model_got_files (GObject *object, GAsyncResult *res, gpointer da
 
   if (files)
     {
-      if (model->dir_thaw_source == 0)
+      if (!model->shown_first_files)
         {
+          /* Show the first files right away, sorted */
           freeze_updates (model);
-          model->dir_thaw_source = gdk_threads_add_timeout_full (IO_PRIORITY + 1,
-                                                                 50,
-                                                                 thaw_func,
-                                                                 model,
-                                                                 NULL);
+          add_enumerated_files (model, files);
+          thaw_updates (model);
+          model->shown_first_files = TRUE;
         }
-
-      for (walk = files; walk; walk = walk->next)
+      else
         {
-          const char *name;
-          GFileInfo *info;
-          GFile *file;
-          
-          info = walk->data;
-          name = g_file_info_get_name (info);
-          if (name == NULL)
+          /* Collect the rest, to sort and show it all at once */
+          if (!model->loading_frozen)
             {
-              /* Shouldn't happen, but the APIs allow it */
-              g_object_unref (info);
-              continue;
+              freeze_updates (model);
+              model->loading_frozen = TRUE;
+              if (!g_file_is_native (model->dir))
+                model->dir_thaw_source = gdk_threads_add_timeout_full (IO_PRIORITY + 1,
+                                                                       LOAD_THAW_INTERVAL,
+                                                                       thaw_func,
+                                                                       model,
+                                                                       NULL);
             }
-          file = g_file_get_child (model->dir, name);
-          add_file (model, file, info);
-          g_object_unref (file);
-          g_object_unref (info);
+
+          add_enumerated_files (model, files);
         }
       g_list_free (files);
 
@@ -1193,6 +1258,10 @@ gtk_file_system_model_got_files (GObject *object, GAsyncResult *res, gpointer da
             {
               g_source_remove (model->dir_thaw_source);
               model->dir_thaw_source = 0;
+            }
+          if (model->loading_frozen)
+            {
+              model->loading_frozen = FALSE;
               thaw_updates (model);
             }
 
@@ -1286,8 +1355,9 @@ gtk_file_system_model_got_enumerator (GObject *dir, GAsyncResult *res, gpointer
     }
   else
     {
+      /* Ask for few files first, so they can be shown quickly */
       g_file_enumerator_next_files_async (enumerator,
-                                          g_file_is_native (model->dir) ? 50 * FILES_PER_QUERY : FILES_PER_QUERY,
+                                          FILES_SHOWN_IMMEDIATELY,
                                           IO_PRIORITY,
                                           model->cancellable,
                                           gtk_file_system_model_got_files,
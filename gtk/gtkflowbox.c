@@ -59,6 +59,7 @@
 #include "gtkmarshalers.h"
 #include "gtkprivate.h"
 #include "gtkintl.h"
+#include "gtkwidgetprivate.h"
 
 #include "a11y/gtkflowboxaccessibleprivate.h"
 #include "a11y/gtkflowboxchildaccessible.h"
@@ -1447,52 +1448,32 @@ get_largest_size_for_line_in_opposing_orientation (GtkFlowBox       *box,
 /* fit_aligned_item_requests() helper */
 static gint
 gather_aligned_item_requests (GtkFlowBox       *box,
-                              GtkOrientation    orientation,
                               gint              line_length,
                               gint              item_spacing,
                               gint              n_children,
+                              GtkRequestedSize *child_sizes,
                               GtkRequestedSize *item_sizes)
 {
-  GSequenceIter *iter;
   gint i;
   gint extra_items, natural_line_size = 0;
+  GtkAlign item_align;
 
   extra_items = n_children % line_length;
+  item_align = ORIENTATION_ALIGN (box);
 
-  i = 0;
-  for (iter = g_sequence_get_begin_iter (BOX_PRIV (box)->children);
-       !g_sequence_iter_is_end (iter);
-       iter = g_sequence_iter_next (iter))
+  for (i = 0; i < n_children; i++)
     {
-      GtkWidget *child;
-      GtkAlign item_align;
-      gint child_min, child_nat;
       gint position;
 
-      child = g_sequence_get (iter);
-
-      if (!child_is_visible (child))
-        continue;
-
-      if (orientation == GTK_ORIENTATION_HORIZONTAL)
-        gtk_widget_get_preferred_width (child,
-                                        &child_min, &child_nat);
-      else
-        gtk_widget_get_preferred_height (child,
-                                         &child_min, &child_nat);
-
       /* Get the index and push it over for the last line when spreading to the end */
       position = i % line_length;
 
-      item_align = ORIENTATION_ALIGN (box);
       if (item_align == GTK_ALIGN_END && i >= n_children - extra_items)
         position += line_length - extra_items;
 
       /* Round up the size of every column/row */
-      item_sizes[position].minimum_size = MAX (item_sizes[position].minimum_size, child_min);
-      item_sizes[position].natural_size = MAX (item_sizes[position].natural_size, child_nat);
-
-      i++;
+      item_sizes[position].minimum_size = MAX (item_sizes[position].minimum_size, child_sizes[i].minimum_size);
+      item_sizes[position].natural_size = MAX (item_sizes[position].natural_size, child_sizes[i].natural_size);
     }
 
   for (i = 0; i < line_length; i++)
@@ -1512,17 +1493,46 @@ fit_aligned_item_requests (GtkFlowBox     *box,
                            gint            items_per_line,
                            gint            n_children)
 {
-  GtkRequestedSize *sizes, *try_sizes;
-  gint try_line_size, try_length;
+  GtkRequestedSize *sizes, *try_sizes, *child_sizes;
+  GSequenceIter *iter;
+  gint try_line_size, try_length, i;
+
+  /* Every try below looks at the requests of all children, so
+   * query them only once */
+  child_sizes = g_new (GtkRequestedSize, n_children);
+
+  i = 0;
+  for (iter = g_sequence_get_begin_iter (BOX_PRIV (box)->children);
+       !g_sequence_iter_is_end (iter) && i < n_children;
+       iter = g_sequence_iter_next (iter))
+    {
+      GtkWidget *child;
+
+      child = g_sequence_get (iter);
+
+      if (!child_is_visible (child))
+        continue;
+
+      if (orientation == GTK_ORIENTATION_HORIZONTAL)
+        gtk_widget_get_preferred_width (child,
+                                        &child_sizes[i].minimum_size,
+                                        &child_sizes[i].natural_size);
+      else
+        gtk_widget_get_preferred_height (child,
+                                         &child_sizes[i].minimum_size,
+                                         &child_sizes[i].natural_size);
+
+      i++;
+    }
 
   sizes = g_new0 (GtkRequestedSize, *line_length);
 
   /* get the sizes for the initial guess */
   try_line_size = gather_aligned_item_requests (box,
-                                                orientation,
                                                 *line_length,
                                                 item_spacing,
                                                 n_children,
+                                                child_sizes,
                                                 sizes);
 
   /* Try columnizing the whole thing and adding an item to the end of
@@ -1533,10 +1543,10 @@ fit_aligned_item_requests (GtkFlowBox     *box,
     {
       try_sizes = g_new0 (GtkRequestedSize, try_length);
       try_line_size = gather_aligned_item_requests (box,
-                                                    orientation,
                                                     try_length,
                                                     item_spacing,
                                                     n_children,
+                                                    child_sizes,
                                                     try_sizes);
 
       if (try_line_size <= avail_size &&
@@ -1555,6 +1565,8 @@ fit_aligned_item_requests (GtkFlowBox     *box,
         }
     }
 
+  g_free (child_sizes);
+
   return sizes;
 }
 
@@ -3625,6 +3637,7 @@ gtk_flow_box_class_init (GtkFlowBoxClass *class)
   widget_class->get_preferred_height = gtk_flow_box_get_preferred_height;
   widget_class->get_preferred_height_for_width = gtk_flow_box_get_preferred_height_for_width;
   widget_class->get_preferred_width_for_height = gtk_flow_box_get_preferred_width_for_height;
+  _gtk_widget_class_set_request_cache_size (widget_class, 10);
 
   container_class->add = gtk_flow_box_add;
   container_class->remove = gtk_flow_box_remove;
@@ -87,6 +87,12 @@ struct _GtkHSVPrivate
   /* Dragging mode */
   DragMode mode;
 
+  /* Cached renderings of the ring and the triangle, the ring only
+   * depends on the metrics and the triangle also on the hue
+   */
+  cairo_surface_t *ring_surface;
+  cairo_surface_t *triangle_surface;
+
   guint focus_on_ring : 1;
 };
 
@@ -231,6 +237,12 @@ gtk_hsv_init (GtkHSV *hsv)
 static void
 gtk_hsv_destroy (GtkWidget *widget)
 {
+  GtkHSV *hsv = GTK_HSV (widget);
+  GtkHSVPrivate *priv = hsv->priv;
+
+  g_clear_pointer (&priv->ring_surface, cairo_surface_destroy);
+  g_clear_pointer (&priv->triangle_surface, cairo_surface_destroy);
+
   GTK_WIDGET_CLASS (gtk_hsv_parent_class)->destroy (widget);
 }
 
@@ -329,6 +341,15 @@ gtk_hsv_size_allocate (GtkWidget     *widget,
 {
   GtkHSV *hsv = GTK_HSV (widget);
   GtkHSVPrivate *priv = hsv->priv;
+  GtkAllocation old_allocation;
+
+  gtk_widget_get_allocation (widget, &old_allocation);
+  if (old_allocation.width != allocation->width ||
+      old_allocation.height != allocation->height)
+    {
+      g_clear_pointer (&priv->ring_surface, cairo_surface_destroy);
+      g_clear_pointer (&priv->triangle_surface, cairo_surface_destroy);
+    }
 
   gtk_widget_set_allocation (widget, allocation);
 
@@ -843,14 +864,14 @@ gtk_hsv_motion (GtkWidget      *widget,
 
 /* Redrawing */
 
-/* Paints the hue ring */
-static void
-paint_ring (GtkHSV  *hsv,
-            cairo_t *cr)
+/* Renders the colors of the hue ring */
+static cairo_surface_t *
+create_ring_surface (GtkHSV *hsv,
+                     int     width,
+                     int     height)
 {
   GtkHSVPrivate *priv = hsv->priv;
-  GtkWidget *widget = GTK_WIDGET (hsv);
-  int xx, yy, width, height;
+  int xx, yy;
   gdouble dx, dy, dist;
   gdouble center_x;
   gdouble center_y;
@@ -859,27 +880,24 @@ paint_ring (GtkHSV  *hsv,
   gdouble angle;
   gdouble hue;
   gdouble r, g, b;
-  cairo_surface_t *source;
-  cairo_t *source_cr;
+  cairo_surface_t *surface;
   gint stride;
 
-  width = gtk_widget_get_allocated_width (widget);
-  height = gtk_widget_get_allocated_height (widget);
-
   center_x = width / 2.0;
   center_y = height / 2.0;
 
   outer = priv->size / 2.0;
   inner = outer - priv->ring_width;
 
-  /* Create an image initialized with the ring colors */
+  surface = cairo_image_surface_create (CAIRO_FORMAT_RGB24, width, height);
+  cairo_surface_flush (surface);
 
-  stride = cairo_format_stride_for_width (CAIRO_FORMAT_RGB24, width);
-  buf = g_new (guint32, height * stride / 4);
+  buf = (guint32 *) cairo_image_surface_get_data (surface);
+  stride = cairo_image_surface_get_stride (surface);
 
   for (yy = 0; yy < height; yy++)
     {
-      p = buf + yy * width;
+      p = buf + yy * stride / 4;
 
       dy = -(yy - center_y);
 
@@ -911,38 +929,41 @@ paint_ring (GtkHSV  *hsv,
         }
     }
 
-  source = cairo_image_surface_create_for_data ((unsigned char *)buf,
-                                                CAIRO_FORMAT_RGB24,
-                                                width, height, stride);
+  cairo_surface_mark_dirty (surface);
 
-  /* Now draw the value marker onto the source image, so that it
-   * will get properly clipped at the edges of the ring
-   */
-  source_cr = cairo_create (source);
-  
-  r = priv->h;
-  g = 1.0;
-  b = 1.0;
-  hsv_to_rgb (&r, &g, &b);
-  
-  if (INTENSITY (r, g, b) > 0.5)
-    cairo_set_source_rgb (source_cr, 0., 0., 0.);
-  else
-    cairo_set_source_rgb (source_cr, 1., 1., 1.);
+  return surface;
+}
 
-  cairo_move_to (source_cr, center_x, center_y);
-  cairo_line_to (source_cr,
-                 center_x + cos (priv->h * 2.0 * G_PI) * priv->size / 2,
-                 center_y - sin (priv->h * 2.0 * G_PI) * priv->size / 2);
-  cairo_stroke (source_cr);
-  cairo_destroy (source_cr);
+/* Paints the hue ring */
+static void
+paint_ring (GtkHSV  *hsv,
+            cairo_t *cr)
+{
+  GtkHSVPrivate *priv = hsv->priv;
+  GtkWidget *widget = GTK_WIDGET (hsv);
+  int width, height;
+  gdouble center_x;
+  gdouble center_y;
+  gdouble inner, outer;
+  gdouble r, g, b;
+
+  width = gtk_widget_get_allocated_width (widget);
+  height = gtk_widget_get_allocated_height (widget);
+
+  center_x = width / 2.0;
+  center_y = height / 2.0;
+
+  outer = priv->size / 2.0;
+  inner = outer - priv->ring_width;
+
+  if (priv->ring_surface == NULL)
+    priv->ring_surface = create_ring_surface (hsv, width, height);
 
-  /* Draw the ring using the source image */
+  /* Draw the ring using the cached image */
 
   cairo_save (cr);
     
-  cairo_set_source_surface (cr, source, 0, 0);
-  cairo_surface_destroy (source);
+  cairo_set_source_surface (cr, priv->ring_surface, 0, 0);
 
   cairo_set_line_width (cr, priv->ring_width);
   cairo_new_path (cr);
@@ -951,10 +972,32 @@ paint_ring (GtkHSV  *hsv,
              priv->size / 2. - priv->ring_width / 2.,
              0, 2 * G_PI);
   cairo_stroke (cr);
+
+  /* Now draw the value marker, clipped to the ring */
+
+  cairo_arc (cr, center_x, center_y, outer, 0, 2 * G_PI);
+  cairo_new_sub_path (cr);
+  cairo_arc_negative (cr, center_x, center_y, inner, 2 * G_PI, 0);
+  cairo_clip (cr);
+
+  r = priv->h;
+  g = 1.0;
+  b = 1.0;
+  hsv_to_rgb (&r, &g, &b);
   
-  cairo_restore (cr);
+  if (INTENSITY (r, g, b) > 0.5)
+    cairo_set_source_rgb (cr, 0., 0., 0.);
+  else
+    cairo_set_source_rgb (cr, 1., 1., 1.);
+
+  cairo_set_line_width (cr, 2.0);
+  cairo_move_to (cr, center_x, center_y);
+  cairo_line_to (cr,
+                 center_x + cos (priv->h * 2.0 * G_PI) * priv->size / 2,
+                 center_y - sin (priv->h * 2.0 * G_PI) * priv->size / 2);
+  cairo_stroke (cr);
   
-  g_free (buf);
+  cairo_restore (cr);
 }
 
 /* Converts an HSV triplet to an integer RGB triplet */
@@ -984,14 +1027,13 @@ get_color (gdouble h,
  */
 #define PAD 3
 
-/* Paints the HSV triangle */
-static void
-paint_triangle (GtkHSV   *hsv,
-                cairo_t  *cr,
-                gboolean  draw_focus)
+/* Renders the shading of the HSV triangle for the current hue */
+static cairo_surface_t *
+create_triangle_surface (GtkHSV *hsv,
+                         int     width,
+                         int     height)
 {
   GtkHSVPrivate *priv = hsv->priv;
-  GtkWidget *widget = GTK_WIDGET (hsv);
   gint hx, hy, sx, sy, vx, vy; /* HSV vertices */
   gint x1, y1, r1, g1, b1; /* First vertex in scanline order */
   gint x2, y2, r2, g2, b2; /* Second vertex */
@@ -1002,15 +1044,9 @@ paint_triangle (GtkHSV   *hsv,
   gint xx, yy;
   gint x_interp, y_interp;
   gint x_start, x_end;
-  cairo_surface_t *source;
-  gdouble r, g, b;
+  cairo_surface_t *surface;
   gint stride;
-  int width, height;
-  GtkStyleContext *context;
 
-  priv = hsv->priv;
-  width = gtk_widget_get_allocated_width (widget); 
-  height = gtk_widget_get_allocated_height (widget); 
   /* Compute triangle's vertices */
   
   compute_triangle (hsv, &hx, &hy, &sx, &sy, &vx, &vy);
@@ -1056,12 +1092,15 @@ paint_triangle (GtkHSV   *hsv,
 
   /* Shade the triangle */
 
-  stride = cairo_format_stride_for_width (CAIRO_FORMAT_RGB24, width);
-  buf = g_new (guint32, height * stride / 4);
+  surface = cairo_image_surface_create (CAIRO_FORMAT_RGB24, width, height);
+  cairo_surface_flush (surface);
+
+  buf = (guint32 *) cairo_image_surface_get_data (surface);
+  stride = cairo_image_surface_get_stride (surface);
 
   for (yy = 0; yy < height; yy++)
     {
-      p = buf + yy * width;
+      p = buf + yy * stride / 4;
 
       if (yy >= y1 - PAD && yy < y3 + PAD) {
         y_interp = CLAMP (yy, y1, y3);
@@ -1122,23 +1161,42 @@ paint_triangle (GtkHSV   *hsv,
       }
     }
 
-  source = cairo_image_surface_create_for_data ((unsigned char *)buf,
-                                                CAIRO_FORMAT_RGB24,
-                                                width, height, stride);
-  
-  /* Draw a triangle with the image as a source */
+  cairo_surface_mark_dirty (surface);
+
+  return surface;
+}
 
-  cairo_set_source_surface (cr, source, 0, 0);
-  cairo_surface_destroy (source);
+/* Paints the HSV triangle */
+static void
+paint_triangle (GtkHSV   *hsv,
+                cairo_t  *cr,
+                gboolean  draw_focus)
+{
+  GtkHSVPrivate *priv = hsv->priv;
+  GtkWidget *widget = GTK_WIDGET (hsv);
+  gint hx, hy, sx, sy, vx, vy; /* HSV vertices */
+  gint xx, yy;
+  gdouble r, g, b;
+  GtkStyleContext *context;
+
+  compute_triangle (hsv, &hx, &hy, &sx, &sy, &vx, &vy);
+
+  if (priv->triangle_surface == NULL)
+    priv->triangle_surface =
+      create_triangle_surface (hsv,
+                               gtk_widget_get_allocated_width (widget),
+                               gtk_widget_get_allocated_height (widget));
+
+  /* Draw a triangle with the cached image as a source */
+
+  cairo_set_source_surface (cr, priv->triangle_surface, 0, 0);
   
-  cairo_move_to (cr, x1, y1);
-  cairo_line_to (cr, x2, y2);
-  cairo_line_to (cr, x3, y3);
+  cairo_move_to (cr, hx, hy);
+  cairo_line_to (cr, sx, sy);
+  cairo_line_to (cr, vx, vy);
   cairo_close_path (cr);
   cairo_fill (cr);
   
-  g_free (buf);
-  
   /* Draw value marker */
   
   xx = floor (sx + (vx - sx) * priv->v + (hx - vx) * priv->s * priv->v + 0.5);
@@ -1320,6 +1378,9 @@ gtk_hsv_set_color (GtkHSV *hsv,
 
   priv = hsv->priv;
 
+  if (priv->h != h)
+    g_clear_pointer (&priv->triangle_surface, cairo_surface_destroy);
+
   priv->h = h;
   priv->s = s;
   priv->v = v;
@@ -1390,6 +1451,12 @@ gtk_hsv_set_metrics (GtkHSV *hsv,
 
   same_size = (priv->size == size);
 
+  if (priv->size != size || priv->ring_width != ring_width)
+    {
+      g_clear_pointer (&priv->ring_surface, cairo_surface_destroy);
+      g_clear_pointer (&priv->triangle_surface, cairo_surface_destroy);
+    }
+
   priv->size = size;
   priv->ring_width = ring_width;
   
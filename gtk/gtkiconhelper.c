@@ -23,6 +23,8 @@
 
 #include <math.h>
 #include "gtkiconhelperprivate.h"
+#include "gtkcssenumvalueprivate.h"
+#include "gtkstylecontextprivate.h"
 
 G_DEFINE_TYPE (GtkIconHelper, _gtk_icon_helper, G_TYPE_OBJECT)
 
@@ -497,6 +499,98 @@ get_scale_factor (GtkIconHelper *self,
   return gdk_screen_get_monitor_scale_factor (screen, 0);
 }
 
+/* Surfaces made from pixbufs and themed icons are shared between all
+ * helpers, so that e.g. a tree view showing the same few icons in
+ * thousands of rows only converts each of them once. The cache lives
+ * on the default icon theme and is dropped when the theme changes.
+ */
+#define MAX_SHARED_SURFACES 128
+
+typedef struct {
+  cairo_surface_t *surface;
+  gint width;
+  gint height;
+  /* Keeps the pixbuf address in the key from being reused */
+  GdkPixbuf *pixbuf;
+} SharedSurface;
+
+static void
+shared_surface_free (SharedSurface *shared)
+{
+  cairo_surface_destroy (shared->surface);
+  g_clear_object (&shared->pixbuf);
+  g_slice_free (SharedSurface, shared);
+}
+
+static void
+shared_surfaces_clear (GtkIconTheme *icon_theme,
+                       GHashTable   *surfaces)
+{
+  g_hash_table_remove_all (surfaces);
+}
+
+static GHashTable *
+get_shared_surfaces (void)
+{
+  GtkIconTheme *icon_theme;
+  GHashTable *surfaces;
+
+  icon_theme = gtk_icon_theme_get_default ();
+  surfaces = g_object_get_data (G_OBJECT (icon_theme), "gtk-icon-helper-surfaces");
+  if (surfaces == NULL)
+    {
+      surfaces = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                        g_free, (GDestroyNotify) shared_surface_free);
+      g_object_set_data_full (G_OBJECT (icon_theme), "gtk-icon-helper-surfaces",
+                              surfaces, (GDestroyNotify) g_hash_table_unref);
+      g_signal_connect (icon_theme, "changed",
+                        G_CALLBACK (shared_surfaces_clear), surfaces);
+    }
+
+  return surfaces;
+}
+
+static gboolean
+lookup_shared_surface (GtkIconHelper *self,
+                       const gchar   *key)
+{
+  SharedSurface *shared;
+
+  shared = g_hash_table_lookup (get_shared_surfaces (), key);
+  if (shared == NULL)
+    return FALSE;
+
+  self->priv->rendered_surface = cairo_surface_reference (shared->surface);
+  self->priv->rendered_surface_width = shared->width;
+  self->priv->rendered_surface_height = shared->height;
+
+  return TRUE;
+}
+
+static void
+add_shared_surface (GtkIconHelper *self,
+                    const gchar   *key,
+                    GdkPixbuf     *pixbuf)
+{
+  GHashTable *surfaces;
+  SharedSurface *shared;
+
+  if (self->priv->rendered_surface == NULL)
+    return;
+
+  surfaces = get_shared_surfaces ();
+  if (g_hash_table_size (surfaces) >= MAX_SHARED_SURFACES)
+    g_hash_table_remove_all (surfaces);
+
+  shared = g_slice_new (SharedSurface);
+  shared->surface = cairo_surface_reference (self->priv->rendered_surface);
+  shared->width = self->priv->rendered_surface_width;
+  shared->height = self->priv->rendered_surface_height;
+  shared->pixbuf = pixbuf ? g_object_ref (pixbuf) : NULL;
+
+  g_hash_table_insert (surfaces, g_strdup (key), shared);
+}
+
 static gboolean
 check_invalidate_surface (GtkIconHelper *self,
 			  GtkStyleContext *context)
@@ -546,6 +640,7 @@ ensure_surface_from_pixbuf (GtkIconHelper   *self,
 {
   gint width, height;
   GdkPixbuf *pixbuf;
+  gchar *key;
   int scale;
 
   if (!check_invalidate_surface (self, context))
@@ -559,9 +654,21 @@ ensure_surface_from_pixbuf (GtkIconHelper   *self,
   if (self->priv->force_scale_pixbuf &&
       (self->priv->pixel_size != -1 ||
        self->priv->icon_size != GTK_ICON_SIZE_INVALID))
+    ensure_icon_size (self, context, &width, &height);
+  else
+    width = height = -1;
+
+  key = g_strdup_printf ("pixbuf %p %d %d %d %d %d",
+                         self->priv->orig_pixbuf, self->priv->orig_pixbuf_scale,
+                         scale, width, height, self->priv->window != NULL);
+  if (lookup_shared_surface (self, key))
     {
-      ensure_icon_size (self, context, &width, &height);
+      g_free (key);
+      return;
+    }
 
+  if (width != -1)
+    {
       if (scale != self->priv->orig_pixbuf_scale ||
 	  width < gdk_pixbuf_get_width (self->priv->orig_pixbuf) / self->priv->orig_pixbuf_scale ||
           height < gdk_pixbuf_get_height (self->priv->orig_pixbuf) / self->priv->orig_pixbuf_scale)
@@ -590,6 +697,9 @@ ensure_surface_from_pixbuf (GtkIconHelper   *self,
 
   self->priv->rendered_surface = gdk_cairo_surface_create_from_pixbuf (pixbuf, scale, self->priv->window);
   g_object_unref (pixbuf);
+
+  add_shared_surface (self, key, self->priv->orig_pixbuf);
+  g_free (key);
 }
 
 static void
@@ -615,7 +725,10 @@ ensure_surface_for_icon_set (GtkIconHelper *self,
 		      &self->priv->rendered_surface_height);
 }
 
-static void
+/* Returns %FALSE if the surface depends on more than the state,
+ * i.e. for symbolic icons which are colored from the style
+ */
+static gboolean
 ensure_stated_surface_from_info (GtkIconHelper *self,
 				 GtkStyleContext *context,
 				 GtkIconInfo *info,
@@ -664,6 +777,8 @@ ensure_stated_surface_from_info (GtkIconHelper *self,
     }
 
   self->priv->rendered_surface = surface;
+
+  return !symbolic;
 }
 
 static void
@@ -674,6 +789,7 @@ ensure_surface_for_icon_name_or_gicon (GtkIconHelper *self,
   gint width, height, scale;
   GtkIconInfo *info;
   GtkIconLookupFlags flags;
+  gchar *key = NULL;
 
   if (!check_invalidate_surface (self, context))
     return;
@@ -687,6 +803,21 @@ ensure_surface_for_icon_name_or_gicon (GtkIconHelper *self,
   if (self->priv->storage_type == GTK_IMAGE_ICON_NAME &&
       self->priv->icon_name != NULL)
     {
+      GtkCssImageEffect effect;
+
+      effect = _gtk_css_image_effect_value_get
+        (_gtk_style_context_peek_property (context, GTK_CSS_PROPERTY_GTK_IMAGE_EFFECT));
+
+      key = g_strdup_printf ("icon %s %d %d %d %d %d %d %d",
+                             self->priv->icon_name, width, height, scale, flags,
+                             gtk_style_context_get_state (context), effect,
+                             self->priv->window != NULL);
+      if (lookup_shared_surface (self, key))
+        {
+          g_free (key);
+          return;
+        }
+
       info = gtk_icon_theme_lookup_icon_for_scale (icon_theme,
 						   self->priv->icon_name,
 						   MIN (width, height),
@@ -706,7 +837,10 @@ ensure_surface_for_icon_name_or_gicon (GtkIconHelper *self,
       return;
     }
 
-  ensure_stated_surface_from_info (self, context, info, scale);
+  if (ensure_stated_surface_from_info (self, context, info, scale) && key)
+    add_shared_surface (self, key, NULL);
+
+  g_free (key);
 
   if (info)
     g_object_unref (info);
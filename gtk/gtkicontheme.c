@@ -29,6 +29,7 @@
 #include <math.h>
 #include <glib.h>
 #include <glib/gstdio.h>
+#include <gdk-pixbuf/gdk-pixdata.h>
 
 #ifdef G_OS_WIN32
 #ifndef S_ISDIR
@@ -203,6 +204,11 @@ struct _GtkIconThemePrivate
   GList *dir_mtimes;
 
   gulong theme_changed_idle;
+
+  /* The themes being loaded in a thread, see start_theme_load() */
+  GTask *load_task;
+  guint load_serial;
+  GList *pending_lookups;
 };
 
 typedef struct {
@@ -275,6 +281,11 @@ struct _GtkIconInfo
 
   SymbolicPixbufCache *symbolic_pixbuf_cache;
 
+  /* The symbolic icon with the colors encoded in the channels,
+   * see icon_info_render_symbolic_mask()
+   */
+  GdkPixbuf *symbolic_mask;
+
   GtkRequisition *symbolic_pixbuf_size;
 };
 
@@ -330,6 +341,43 @@ typedef struct
   GtkIconCache *cache;
 } IconThemeDirMtime;
 
+/* Everything load_themes() reads and builds. It doesn't point back to
+ * the GtkIconTheme, so it can be filled in on a thread and then be
+ * installed into the icon theme in one go.
+ */
+typedef struct
+{
+  gchar *current_theme;
+  gchar *fallback_theme;
+  gchar **search_path;
+  gint search_path_len;
+
+  GList *themes;
+  GHashTable *unthemed_icons;
+  GHashTable *all_icons;
+  GList *dir_mtimes;
+  glong last_stat_time;
+} IconThemeIndex;
+
+typedef struct
+{
+  IconThemeIndex *index;
+  guint serial;
+
+  GMutex lock;
+  GCond cond;
+  gboolean done;
+} IconThemeLoad;
+
+typedef struct
+{
+  gchar *icon_name;
+  gchar **icon_names;
+  gint size;
+  gint scale;
+  GtkIconLookupFlags flags;
+} IconLookupData;
+
 static void  gtk_icon_theme_finalize   (GObject              *object);
 static void  theme_dir_destroy         (IconThemeDir         *dir);
 
@@ -345,11 +393,17 @@ static void         theme_list_icons  (IconTheme        *theme,
 				       GQuark            context);
 static void         theme_list_contexts  (IconTheme        *theme,
 					  GHashTable       *contexts);
-static void         theme_subdir_load (GtkIconTheme     *icon_theme,
+static void         theme_subdir_load (IconThemeIndex   *index,
 				       IconTheme        *theme,
 				       GKeyFile         *theme_file,
 				       char             *subdir);
 static void         do_theme_change   (GtkIconTheme     *icon_theme);
+static void         start_theme_load  (GtkIconTheme     *icon_theme);
+static GtkIconInfo *choose_icon       (GtkIconTheme       *icon_theme,
+				       const gchar        *icon_names[],
+				       gint                size,
+				       gint                scale,
+				       GtkIconLookupFlags  flags);
 
 static void     blow_themes               (GtkIconTheme    *icon_themes);
 static gboolean rescan_themes             (GtkIconTheme    *icon_themes);
@@ -509,6 +563,11 @@ gtk_icon_theme_get_for_screen (GdkScreen *screen)
       priv->is_screen_singleton = TRUE;
 
       g_object_set_data (G_OBJECT (screen), I_("gtk-icon-theme"), icon_theme);
+
+      /* Most applications will want icons soon, so start indexing the
+       * themes while they build their UI.
+       */
+      start_theme_load (icon_theme);
     }
 
   return icon_theme;
@@ -840,6 +899,9 @@ do_theme_change (GtkIconTheme *icon_theme)
 
   g_hash_table_remove_all (priv->info_cache);
 
+  /* Any themes being loaded now were loaded for the old settings */
+  priv->load_serial++;
+
   if (!priv->themes_valid)
     return;
 
@@ -1101,32 +1163,29 @@ gtk_icon_theme_set_custom_theme (GtkIconTheme *icon_theme,
 }
 
 static void
-insert_theme (GtkIconTheme *icon_theme, const char *theme_name)
+insert_theme (IconThemeIndex *index, const char *theme_name)
 {
   int i;
   GList *l;
   char **dirs;
   char **themes;
-  GtkIconThemePrivate *priv;
   IconTheme *theme = NULL;
   char *path;
   GKeyFile *theme_file;
   GError *error = NULL;
   IconThemeDirMtime *dir_mtime;
   GStatBuf stat_buf;
-  
-  priv = icon_theme->priv;
 
-  for (l = priv->themes; l != NULL; l = l->next)
+  for (l = index->themes; l != NULL; l = l->next)
     {
       theme = l->data;
       if (strcmp (theme->name, theme_name) == 0)
 	return;
     }
   
-  for (i = 0; i < priv->search_path_len; i++)
+  for (i = 0; i < index->search_path_len; i++)
     {
-      path = g_build_filename (priv->search_path[i],
+      path = g_build_filename (index->search_path[i],
 			       theme_name,
 			       NULL);
       dir_mtime = g_slice_new (IconThemeDirMtime);
@@ -1137,14 +1196,14 @@ insert_theme (GtkIconTheme *icon_theme, const char *theme_name)
       else
 	dir_mtime->mtime = 0;
 
-      priv->dir_mtimes = g_list_prepend (priv->dir_mtimes, dir_mtime);
+      index->dir_mtimes = g_list_prepend (index->dir_mtimes, dir_mtime);
     }
-  priv->dir_mtimes = g_list_reverse (priv->dir_mtimes);
+  index->dir_mtimes = g_list_reverse (index->dir_mtimes);
 
   theme_file = NULL;
-  for (i = 0; i < priv->search_path_len && !theme_file; i++)
+  for (i = 0; i < index->search_path_len && !theme_file; i++)
     {
-      path = g_build_filename (priv->search_path[i],
+      path = g_build_filename (index->search_path[i],
 			       theme_name,
 			       "index.theme",
 			       NULL);
@@ -1168,7 +1227,7 @@ insert_theme (GtkIconTheme *icon_theme, const char *theme_name)
     {
       theme = g_new0 (IconTheme, 1);
       theme->name = g_strdup (theme_name);
-      priv->themes = g_list_prepend (priv->themes, theme);
+      index->themes = g_list_prepend (index->themes, theme);
     }
 
   if (theme_file == NULL)
@@ -1183,7 +1242,7 @@ insert_theme (GtkIconTheme *icon_theme, const char *theme_name)
   if (!dirs)
     {
       g_warning ("Theme file for %s has no directories\n", theme_name);
-      priv->themes = g_list_remove (priv->themes, theme);
+      index->themes = g_list_remove (index->themes, theme);
       g_free (theme->name);
       g_free (theme->display_name);
       g_free (theme);
@@ -1202,7 +1261,7 @@ insert_theme (GtkIconTheme *icon_theme, const char *theme_name)
 
   theme->dirs = NULL;
   for (i = 0; dirs[i] != NULL; i++)
-    theme_subdir_load (icon_theme, theme, theme_file, dirs[i]);
+    theme_subdir_load (index, theme, theme_file, dirs[i]);
 
   g_strfreev (dirs);
 
@@ -1216,7 +1275,7 @@ insert_theme (GtkIconTheme *icon_theme, const char *theme_name)
   if (themes)
     {
       for (i = 0; themes[i] != NULL; i++)
-	insert_theme (icon_theme, themes[i]);
+	insert_theme (index, themes[i]);
       
       g_strfreev (themes);
     }
@@ -1246,9 +1305,8 @@ strip_suffix (const char *filename)
 }
 
 static void
-load_themes (GtkIconTheme *icon_theme)
+load_themes (IconThemeIndex *index)
 {
-  GtkIconThemePrivate *priv;
   GDir *gdir;
   int base;
   char *dir;
@@ -1258,30 +1316,28 @@ load_themes (GtkIconTheme *icon_theme)
   GTimeVal tv;
   IconThemeDirMtime *dir_mtime;
   GStatBuf stat_buf;
-  
-  priv = icon_theme->priv;
 
-  priv->all_icons = g_hash_table_new (g_str_hash, g_str_equal);
+  index->all_icons = g_hash_table_new (g_str_hash, g_str_equal);
   
-  if (priv->current_theme)
-    insert_theme (icon_theme, priv->current_theme);
+  if (index->current_theme)
+    insert_theme (index, index->current_theme);
 
   /* Always look in the "default" icon theme, and in a fallback theme */
-  if (priv->fallback_theme)
-    insert_theme (icon_theme, priv->fallback_theme);
-  insert_theme (icon_theme, DEFAULT_THEME_NAME);
-  priv->themes = g_list_reverse (priv->themes);
+  if (index->fallback_theme)
+    insert_theme (index, index->fallback_theme);
+  insert_theme (index, DEFAULT_THEME_NAME);
+  index->themes = g_list_reverse (index->themes);
 
 
-  priv->unthemed_icons = g_hash_table_new_full (g_str_hash, g_str_equal,
-						g_free, (GDestroyNotify)free_unthemed_icon);
+  index->unthemed_icons = g_hash_table_new_full (g_str_hash, g_str_equal,
+						 g_free, (GDestroyNotify)free_unthemed_icon);
 
-  for (base = 0; base < icon_theme->priv->search_path_len; base++)
+  for (base = 0; base < index->search_path_len; base++)
     {
-      dir = icon_theme->priv->search_path[base];
+      dir = index->search_path[base];
 
       dir_mtime = g_slice_new (IconThemeDirMtime);
-      priv->dir_mtimes = g_list_append (priv->dir_mtimes, dir_mtime);
+      index->dir_mtimes = g_list_append (index->dir_mtimes, dir_mtime);
       
       dir_mtime->dir = g_strdup (dir);
       dir_mtime->mtime = 0;
@@ -1311,7 +1367,7 @@ load_themes (GtkIconTheme *icon_theme)
 	      abs_file = g_build_filename (dir, file, NULL);
 	      base_name = strip_suffix (file);
 
-	      if ((unthemed_icon = g_hash_table_lookup (priv->unthemed_icons,
+	      if ((unthemed_icon = g_hash_table_lookup (index->unthemed_icons,
 							base_name)))
 		{
 		  if (new_suffix == ICON_SUFFIX_SVG)
@@ -1350,10 +1406,10 @@ load_themes (GtkIconTheme *icon_theme)
 		    unthemed_icon->no_svg_filename = abs_file;
 
 		  /* takes ownership of base_name */
-		  g_hash_table_replace (priv->unthemed_icons,
+		  g_hash_table_replace (index->unthemed_icons,
 					base_name,
 					unthemed_icon);
-		  g_hash_table_insert (priv->all_icons,
+		  g_hash_table_insert (index->all_icons,
 				       base_name, NULL);
 		}
 	    }
@@ -1361,10 +1417,261 @@ load_themes (GtkIconTheme *icon_theme)
       g_dir_close (gdir);
     }
 
-  priv->themes_valid = TRUE;
-  
   g_get_current_time(&tv);
-  priv->last_stat_time = tv.tv_sec;
+  index->last_stat_time = tv.tv_sec;
+}
+
+static IconThemeIndex *
+icon_theme_index_new (GtkIconThemePrivate *priv)
+{
+  IconThemeIndex *index;
+  gint i;
+
+  index = g_slice_new0 (IconThemeIndex);
+  index->current_theme = g_strdup (priv->current_theme);
+  index->fallback_theme = g_strdup (priv->fallback_theme);
+  index->search_path_len = priv->search_path_len;
+  index->search_path = g_new (gchar *, priv->search_path_len + 1);
+  for (i = 0; i < priv->search_path_len; i++)
+    index->search_path[i] = g_strdup (priv->search_path[i]);
+  index->search_path[i] = NULL;
+
+  return index;
+}
+
+static void
+icon_theme_index_free (IconThemeIndex *index)
+{
+  g_free (index->current_theme);
+  g_free (index->fallback_theme);
+  g_strfreev (index->search_path);
+
+  if (index->all_icons)
+    g_hash_table_destroy (index->all_icons);
+  g_list_free_full (index->themes, (GDestroyNotify) theme_destroy);
+  g_list_free_full (index->dir_mtimes, (GDestroyNotify) free_dir_mtime);
+  if (index->unthemed_icons)
+    g_hash_table_destroy (index->unthemed_icons);
+
+  g_slice_free (IconThemeIndex, index);
+}
+
+/* Takes over the loaded themes of @index, which is freed */
+static void
+icon_theme_index_install (GtkIconTheme   *icon_theme,
+                          IconThemeIndex *index)
+{
+  GtkIconThemePrivate *priv = icon_theme->priv;
+
+  g_assert (!priv->themes_valid);
+
+  priv->themes = index->themes;
+  priv->unthemed_icons = index->unthemed_icons;
+  priv->all_icons = index->all_icons;
+  priv->dir_mtimes = index->dir_mtimes;
+  priv->last_stat_time = index->last_stat_time;
+  priv->themes_valid = TRUE;
+
+  index->themes = NULL;
+  index->unthemed_icons = NULL;
+  index->all_icons = NULL;
+  index->dir_mtimes = NULL;
+  icon_theme_index_free (index);
+}
+
+static void
+icon_theme_load_free (IconThemeLoad *load)
+{
+  if (load->index)
+    icon_theme_index_free (load->index);
+  g_mutex_clear (&load->lock);
+  g_cond_clear (&load->cond);
+  g_slice_free (IconThemeLoad, load);
+}
+
+static void
+theme_load_thread (GTask        *task,
+                   gpointer      source_object,
+                   gpointer      task_data,
+                   GCancellable *cancellable)
+{
+  IconThemeLoad *load = task_data;
+
+  /* Only touches load->index, never the icon theme */
+  load_themes (load->index);
+
+  g_mutex_lock (&load->lock);
+  load->done = TRUE;
+  g_cond_signal (&load->cond);
+  g_mutex_unlock (&load->lock);
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+icon_lookup_data_free (IconLookupData *data)
+{
+  g_free (data->icon_name);
+  g_strfreev (data->icon_names);
+  g_slice_free (IconLookupData, data);
+}
+
+static void
+complete_lookup (GtkIconTheme *icon_theme,
+                 GTask        *task)
+{
+  IconLookupData *data = g_task_get_task_data (task);
+  GtkIconInfo *info;
+
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
+  if (data->icon_name)
+    info = gtk_icon_theme_lookup_icon_for_scale (icon_theme, data->icon_name,
+                                                 data->size, data->scale, data->flags);
+  else
+    info = choose_icon (icon_theme, (const gchar **) data->icon_names,
+                        data->size, data->scale, data->flags);
+
+  g_task_return_pointer (task, info, g_object_unref);
+}
+
+static void
+complete_pending_lookups (GtkIconTheme *icon_theme)
+{
+  GtkIconThemePrivate *priv = icon_theme->priv;
+  GList *pending, *l;
+
+  pending = priv->pending_lookups;
+  priv->pending_lookups = NULL;
+
+  for (l = pending; l; l = l->next)
+    {
+      complete_lookup (icon_theme, l->data);
+      g_object_unref (l->data);
+    }
+
+  g_list_free (pending);
+}
+
+static void
+finish_theme_load (GtkIconTheme *icon_theme)
+{
+  GtkIconThemePrivate *priv = icon_theme->priv;
+  GTask *task = priv->load_task;
+  IconThemeLoad *load = g_task_get_task_data (task);
+
+  priv->load_task = NULL;
+
+  if (load->serial == priv->load_serial)
+    {
+      gboolean was_valid = priv->themes_valid;
+
+      /* A reload because the themes changed on disk, see
+       * ensure_valid_themes(). Only now drop the old themes.
+       */
+      if (was_valid)
+        {
+          g_hash_table_remove_all (priv->info_cache);
+          blow_themes (icon_theme);
+        }
+
+      icon_theme_index_install (icon_theme, load->index);
+      load->index = NULL;
+
+      if (was_valid)
+        queue_theme_changed (icon_theme);
+    }
+
+  g_object_unref (task);
+}
+
+static void
+theme_load_done (GObject      *source,
+                 GAsyncResult *result,
+                 gpointer      user_data)
+{
+  GtkIconTheme *icon_theme = GTK_ICON_THEME (source);
+  GtkIconThemePrivate *priv = icon_theme->priv;
+  GTask *task = G_TASK (result);
+
+  /* Unless ensure_valid_themes() already took the result */
+  if (priv->load_task == task)
+    finish_theme_load (icon_theme);
+
+  if (priv->themes_valid)
+    complete_pending_lookups (icon_theme);
+  else if (priv->pending_lookups)
+    start_theme_load (icon_theme);
+}
+
+/* Loads the themes on a thread. The result is installed when the
+ * thread is done, or earlier by ensure_valid_themes() if someone
+ * needs it synchronously in the meantime.
+ */
+static void
+run_theme_load (GtkIconTheme *icon_theme)
+{
+  GtkIconThemePrivate *priv = icon_theme->priv;
+  IconThemeLoad *load;
+  GTask *task;
+
+  load = g_slice_new0 (IconThemeLoad);
+  load->index = icon_theme_index_new (priv);
+  load->serial = priv->load_serial;
+  g_mutex_init (&load->lock);
+  g_cond_init (&load->cond);
+
+  task = g_task_new (icon_theme, NULL, theme_load_done, NULL);
+  g_task_set_task_data (task, load, (GDestroyNotify) icon_theme_load_free);
+  priv->load_task = task;
+
+  g_task_run_in_thread (task, theme_load_thread);
+}
+
+static void
+start_theme_load (GtkIconTheme *icon_theme)
+{
+  GtkIconThemePrivate *priv = icon_theme->priv;
+
+  if (priv->themes_valid || priv->load_task != NULL)
+    return;
+
+  run_theme_load (icon_theme);
+}
+
+/* Waits for the themes being loaded on a thread and returns them,
+ * or %NULL if there are none for the current settings.
+ */
+static IconThemeIndex *
+steal_theme_load (GtkIconTheme *icon_theme)
+{
+  GtkIconThemePrivate *priv = icon_theme->priv;
+  IconThemeIndex *index = NULL;
+  IconThemeLoad *load;
+  GTask *task;
+
+  task = priv->load_task;
+  if (task == NULL)
+    return NULL;
+
+  priv->load_task = NULL;
+  load = g_task_get_task_data (task);
+
+  if (load->serial == priv->load_serial)
+    {
+      g_mutex_lock (&load->lock);
+      while (!load->done)
+        g_cond_wait (&load->cond, &load->lock);
+      g_mutex_unlock (&load->lock);
+
+      index = load->index;
+      load->index = NULL;
+    }
+
+  g_object_unref (task);
+
+  return index;
 }
 
 void
@@ -1416,17 +1723,43 @@ ensure_valid_themes (GtkIconTheme *icon_theme)
     {
       g_get_current_time (&tv);
 
-      if (ABS (tv.tv_sec - priv->last_stat_time) > 5 &&
+      /* Installing packages touches the theme directories many
+       * times in a row, so keep using the current themes while the
+       * new ones are loaded on a thread instead of reloading them
+       * right here.
+       */
+      if (priv->load_task == NULL &&
+          ABS (tv.tv_sec - priv->last_stat_time) > 5 &&
 	  rescan_themes (icon_theme))
+        run_theme_load (icon_theme);
+      else if (priv->load_task != NULL)
         {
-          g_hash_table_remove_all (priv->info_cache);
-          blow_themes (icon_theme);
+          IconThemeLoad *load = g_task_get_task_data (priv->load_task);
+          gboolean done;
+
+          /* Don't wait for the main loop to install a finished reload,
+           * there may not be one running.
+           */
+          g_mutex_lock (&load->lock);
+          done = load->done;
+          g_mutex_unlock (&load->lock);
+
+          if (done)
+            finish_theme_load (icon_theme);
         }
     }
   
   if (!priv->themes_valid)
     {
-      load_themes (icon_theme);
+      IconThemeIndex *index;
+
+      index = steal_theme_load (icon_theme);
+      if (index == NULL)
+        {
+          index = icon_theme_index_new (priv);
+          load_themes (index);
+        }
+      icon_theme_index_install (icon_theme, index);
 
       if (was_valid)
         queue_theme_changed (icon_theme);
@@ -2019,6 +2352,180 @@ gtk_icon_theme_choose_icon_for_scale (GtkIconTheme       *icon_theme,
   return choose_icon (icon_theme, icon_names, size, scale, flags);
 }
 
+static void
+lookup_async (GtkIconTheme   *icon_theme,
+              IconLookupData *data,
+              GCancellable   *cancellable,
+              GAsyncReadyCallback callback,
+              gpointer        user_data)
+{
+  GtkIconThemePrivate *priv = icon_theme->priv;
+  GTask *task;
+
+  task = g_task_new (icon_theme, cancellable, callback, user_data);
+  g_task_set_task_data (task, data, (GDestroyNotify) icon_lookup_data_free);
+
+  start_theme_load (icon_theme);
+
+  if (!priv->themes_valid && priv->load_task != NULL)
+    {
+      /* Completed by theme_load_done() */
+      priv->pending_lookups = g_list_append (priv->pending_lookups, task);
+    }
+  else
+    {
+      complete_lookup (icon_theme, task);
+      g_object_unref (task);
+    }
+}
+
+/**
+ * gtk_icon_theme_lookup_icon_async:
+ * @icon_theme: a #GtkIconTheme
+ * @icon_name: the name of the icon to lookup
+ * @size: desired icon size
+ * @scale: the desired scale
+ * @flags: flags modifying the behavior of the icon lookup
+ * @cancellable: (allow-none): optional #GCancellable object,
+ *     %NULL to ignore
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the
+ *     request is satisfied
+ * @user_data: (closure): the data to pass to callback function
+ *
+ * Asynchronously looks up a named icon. If the icon theme has not
+ * been loaded yet, or has changed since, its directories are
+ * indexed on a thread first, so the main loop keeps running.
+ *
+ * For more details, see gtk_icon_theme_lookup_icon_for_scale()
+ * which is the synchronous version of this call.
+ *
+ * Since: 3.12
+ */
+void
+gtk_icon_theme_lookup_icon_async (GtkIconTheme        *icon_theme,
+                                  const gchar         *icon_name,
+                                  gint                 size,
+                                  gint                 scale,
+                                  GtkIconLookupFlags   flags,
+                                  GCancellable        *cancellable,
+                                  GAsyncReadyCallback  callback,
+                                  gpointer             user_data)
+{
+  IconLookupData *data;
+
+  g_return_if_fail (GTK_IS_ICON_THEME (icon_theme));
+  g_return_if_fail (icon_name != NULL);
+  g_return_if_fail ((flags & GTK_ICON_LOOKUP_NO_SVG) == 0 ||
+		    (flags & GTK_ICON_LOOKUP_FORCE_SVG) == 0);
+  g_return_if_fail (scale >= 1);
+
+  data = g_slice_new0 (IconLookupData);
+  data->icon_name = g_strdup (icon_name);
+  data->size = size;
+  data->scale = scale;
+  data->flags = flags;
+
+  lookup_async (icon_theme, data, cancellable, callback, user_data);
+}
+
+/**
+ * gtk_icon_theme_lookup_icon_finish:
+ * @icon_theme: a #GtkIconTheme
+ * @result: a #GAsyncResult
+ * @error: (allow-none): location to store error information on failure,
+ *     or %NULL.
+ *
+ * Finishes an async icon lookup, see gtk_icon_theme_lookup_icon_async().
+ *
+ * Return value: (transfer full): a #GtkIconInfo object containing
+ * information about the icon, or %NULL if the icon wasn't found.
+ *
+ * Since: 3.12
+ */
+GtkIconInfo *
+gtk_icon_theme_lookup_icon_finish (GtkIconTheme  *icon_theme,
+                                   GAsyncResult  *result,
+                                   GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, icon_theme), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+/**
+ * gtk_icon_theme_choose_icon_async:
+ * @icon_theme: a #GtkIconTheme
+ * @icon_names: (array zero-terminated=1): %NULL-terminated array of
+ *     icon names to lookup
+ * @size: desired icon size
+ * @scale: desired scale
+ * @flags: flags modifying the behavior of the icon lookup
+ * @cancellable: (allow-none): optional #GCancellable object,
+ *     %NULL to ignore
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the
+ *     request is satisfied
+ * @user_data: (closure): the data to pass to callback function
+ *
+ * Asynchronously looks up the first of @icon_names that is found,
+ * indexing the icon theme on a thread first if needed, like
+ * gtk_icon_theme_lookup_icon_async().
+ *
+ * For more details, see gtk_icon_theme_choose_icon_for_scale()
+ * which is the synchronous version of this call.
+ *
+ * Since: 3.12
+ */
+void
+gtk_icon_theme_choose_icon_async (GtkIconTheme        *icon_theme,
+                                  const gchar         *icon_names[],
+                                  gint                 size,
+                                  gint                 scale,
+                                  GtkIconLookupFlags   flags,
+                                  GCancellable        *cancellable,
+                                  GAsyncReadyCallback  callback,
+                                  gpointer             user_data)
+{
+  IconLookupData *data;
+
+  g_return_if_fail (GTK_IS_ICON_THEME (icon_theme));
+  g_return_if_fail (icon_names != NULL);
+  g_return_if_fail ((flags & GTK_ICON_LOOKUP_NO_SVG) == 0 ||
+		    (flags & GTK_ICON_LOOKUP_FORCE_SVG) == 0);
+  g_return_if_fail (scale >= 1);
+
+  data = g_slice_new0 (IconLookupData);
+  data->icon_names = g_strdupv ((gchar **) icon_names);
+  data->size = size;
+  data->scale = scale;
+  data->flags = flags;
+
+  lookup_async (icon_theme, data, cancellable, callback, user_data);
+}
+
+/**
+ * gtk_icon_theme_choose_icon_finish:
+ * @icon_theme: a #GtkIconTheme
+ * @result: a #GAsyncResult
+ * @error: (allow-none): location to store error information on failure,
+ *     or %NULL.
+ *
+ * Finishes an async icon lookup, see gtk_icon_theme_choose_icon_async().
+ *
+ * Return value: (transfer full): a #GtkIconInfo object containing
+ * information about the icon, or %NULL if the icon wasn't found.
+ *
+ * Since: 3.12
+ */
+GtkIconInfo *
+gtk_icon_theme_choose_icon_finish (GtkIconTheme  *icon_theme,
+                                   GAsyncResult  *result,
+                                   GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, icon_theme), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
 
 /* Error quark */
 GQuark
@@ -3097,8 +3604,9 @@ load_icon_data (IconThemeDir *dir, const char *path, const char *name)
 }
 
 static void
-scan_directory (GtkIconThemePrivate *icon_theme,
-		IconThemeDir *dir, char *full_dir)
+scan_directory (IconThemeIndex *index,
+		IconThemeDir   *dir,
+		char           *full_dir)
 {
   GDir *gdir;
   const char *name;
@@ -3141,7 +3649,7 @@ scan_directory (GtkIconThemePrivate *icon_theme,
       base_name = strip_suffix (name);
 
       hash_suffix = GPOINTER_TO_INT (g_hash_table_lookup (dir->icons, base_name));
-      g_hash_table_replace (icon_theme->all_icons, base_name, NULL);
+      g_hash_table_replace (index->all_icons, base_name, NULL);
       /* takes ownership of base_name */
       g_hash_table_replace (dir->icons, base_name, GUINT_TO_POINTER (hash_suffix| suffix));
     }
@@ -3150,10 +3658,10 @@ scan_directory (GtkIconThemePrivate *icon_theme,
 }
 
 static void
-theme_subdir_load (GtkIconTheme *icon_theme,
-		   IconTheme    *theme,
-		   GKeyFile     *theme_file,
-		   char         *subdir)
+theme_subdir_load (IconThemeIndex *index,
+		   IconTheme      *theme,
+		   GKeyFile       *theme_file,
+		   char           *subdir)
 {
   GList *d;
   char *type_string;
@@ -3221,7 +3729,7 @@ theme_subdir_load (GtkIconTheme *icon_theme,
   else
     scale = 1;
 
-  for (d = icon_theme->priv->dir_mtimes; d; d = d->next)
+  for (d = index->dir_mtimes; d; d = d->next)
     {
       dir_mtime = (IconThemeDirMtime *)d->data;
 
@@ -3260,7 +3768,7 @@ theme_subdir_load (GtkIconTheme *icon_theme,
 	    {
 	      dir->cache = NULL;
               dir->subdir_index = -1;
-	      scan_directory (icon_theme->priv, dir, full_dir);
+	      scan_directory (index, dir, full_dir);
 	    }
 
 	  theme->dirs = g_list_prepend (theme->dirs, dir);
@@ -3371,6 +3879,10 @@ icon_info_dup (GtkIconInfo *icon_info)
 
   if (icon_info->cache_pixbuf)
     dup->cache_pixbuf = g_object_ref (icon_info->cache_pixbuf);
+  if (icon_info->symbolic_mask)
+    dup->symbolic_mask = g_object_ref (icon_info->symbolic_mask);
+  if (icon_info->symbolic_pixbuf_size)
+    dup->symbolic_pixbuf_size = gtk_requisition_copy (icon_info->symbolic_pixbuf_size);
 
   dup->data = icon_data_dup (icon_info->data);
   dup->unscaled_scale = icon_info->unscaled_scale;
@@ -3456,6 +3968,7 @@ gtk_icon_info_finalize (GObject *object)
     g_object_unref (icon_info->cache_pixbuf);
   if (icon_info->symbolic_pixbuf_size)
     gtk_requisition_free (icon_info->symbolic_pixbuf_size);
+  g_clear_object (&icon_info->symbolic_mask);
   icon_data_unref (icon_info->data);
   
   g_clear_object (&icon_info->proxy_pixbuf);
@@ -3705,6 +4218,128 @@ icon_info_get_pixbuf_ready (GtkIconInfo *icon_info)
   return FALSE;
 }
 
+/* Rendering SVG icons is expensive, and every process renders the
+ * same icons at the same sizes. If GTK_RENDERED_ICON_CACHE names a
+ * directory, rendered icons are stored there as pixdata, keyed by
+ * the file, its modification time, the size and a variant for the
+ * color-encoded masks of symbolic icons. Other processes map them
+ * from there. There is no expiry; entries for changed files are just
+ * not found anymore, so the directory can be cleaned out at any time.
+ */
+static const gchar *
+rendered_cache_get_dir (void)
+{
+  static const gchar *dir = NULL;
+  static gsize initialized = 0;
+
+  if (g_once_init_enter (&initialized))
+    {
+      const gchar *env = g_getenv ("GTK_RENDERED_ICON_CACHE");
+
+      if (env && *env && g_mkdir_with_parents (env, 0755) == 0)
+        dir = g_strdup (env);
+
+      g_once_init_leave (&initialized, 1);
+    }
+
+  return dir;
+}
+
+static gchar *
+rendered_cache_get_path (GFile       *file,
+                         gint         size,
+                         const gchar *variant)
+{
+  GFileInfo *info;
+  gchar *uri, *key, *checksum, *basename, *path;
+  guint64 mtime;
+
+  if (rendered_cache_get_dir () == NULL)
+    return NULL;
+
+  info = g_file_query_info (file, G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                            G_FILE_QUERY_INFO_NONE, NULL, NULL);
+  if (info == NULL)
+    return NULL;
+
+  mtime = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+  g_object_unref (info);
+
+  uri = g_file_get_uri (file);
+  key = g_strdup_printf ("%s\n%" G_GUINT64_FORMAT "\n%d\n%s",
+                         uri, mtime, size, variant ? variant : "");
+  checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, key, -1);
+  basename = g_strconcat (checksum, ".pixdata", NULL);
+  path = g_build_filename (rendered_cache_get_dir (), basename, NULL);
+
+  g_free (basename);
+  g_free (checksum);
+  g_free (key);
+  g_free (uri);
+
+  return path;
+}
+
+static GdkPixbuf *
+rendered_cache_lookup (const gchar *path)
+{
+  GMappedFile *map;
+  GdkPixdata pixdata;
+  GdkPixbuf *pixbuf;
+
+  /* Writable, so that code modifying the pixels gets private copies
+   * of the pages instead of crashing
+   */
+  map = g_mapped_file_new (path, TRUE, NULL);
+  if (map == NULL)
+    return NULL;
+
+  if (!gdk_pixdata_deserialize (&pixdata,
+                                g_mapped_file_get_length (map),
+                                (const guint8 *) g_mapped_file_get_contents (map),
+                                NULL) ||
+      pixdata.pixdata_type != (GDK_PIXDATA_COLOR_TYPE_RGBA |
+                               GDK_PIXDATA_SAMPLE_WIDTH_8 |
+                               GDK_PIXDATA_ENCODING_RAW) ||
+      pixdata.length != GDK_PIXDATA_HEADER_LENGTH + pixdata.rowstride * pixdata.height ||
+      pixdata.length > g_mapped_file_get_length (map))
+    {
+      g_mapped_file_unref (map);
+      return NULL;
+    }
+
+  pixbuf = gdk_pixbuf_new_from_data (pixdata.pixel_data, GDK_COLORSPACE_RGB, TRUE, 8,
+                                     pixdata.width, pixdata.height, pixdata.rowstride,
+                                     (GdkPixbufDestroyNotify) g_mapped_file_unref, map);
+  if (pixbuf == NULL)
+    g_mapped_file_unref (map);
+
+  return pixbuf;
+}
+
+static void
+rendered_cache_store (const gchar *path,
+                      GdkPixbuf   *pixbuf)
+{
+  GdkPixdata pixdata;
+  guint8 *data;
+  guint length;
+
+  if (!gdk_pixbuf_get_has_alpha (pixbuf) ||
+      gdk_pixbuf_get_bits_per_sample (pixbuf) != 8)
+    return;
+
+  gdk_pixdata_from_pixbuf (&pixdata, pixbuf, FALSE);
+  data = gdk_pixdata_serialize (&pixdata, &length);
+
+  /* Written to a temporary file and renamed, so that other processes
+   * never see a partial file
+   */
+  g_file_set_contents (path, (const gchar *) data, length, NULL);
+
+  g_free (data);
+}
+
 /* This function contains the complicated logic for deciding
  * on the size at which to load the icon and loading it at
  * that size.
@@ -3767,28 +4402,42 @@ icon_info_ensure_scale_and_pixbuf (GtkIconInfo  *icon_info,
   if (is_svg)
     {
       GInputStream *stream;
+      gchar *cache_path;
 
       icon_info->scale = scaled_desired_size / 1000.;
 
       if (scale_only)
 	return TRUE;
 
-      /* TODO: We should have a load_at_scale */
-      stream = g_loadable_icon_load (icon_info->loadable,
-                                     scaled_desired_size,
-                                     NULL, NULL,
-                                     &icon_info->load_error);
-      if (stream)
+      cache_path = rendered_cache_get_path (g_file_icon_get_file (G_FILE_ICON (icon_info->loadable)),
+                                            scaled_desired_size, NULL);
+      if (cache_path)
+        icon_info->pixbuf = rendered_cache_lookup (cache_path);
+
+      if (!icon_info->pixbuf)
         {
-          icon_info->pixbuf = gdk_pixbuf_new_from_stream_at_scale (stream,
-                                                                   scaled_desired_size,
-                                                                   scaled_desired_size,
-                                                                   TRUE,
-                                                                   NULL,
-                                                                   &icon_info->load_error);
-          g_object_unref (stream);
+          /* TODO: We should have a load_at_scale */
+          stream = g_loadable_icon_load (icon_info->loadable,
+                                         scaled_desired_size,
+                                         NULL, NULL,
+                                         &icon_info->load_error);
+          if (stream)
+            {
+              icon_info->pixbuf = gdk_pixbuf_new_from_stream_at_scale (stream,
+                                                                       scaled_desired_size,
+                                                                       scaled_desired_size,
+                                                                       TRUE,
+                                                                       NULL,
+                                                                       &icon_info->load_error);
+              g_object_unref (stream);
+            }
+
+          if (icon_info->pixbuf && cache_path)
+            rendered_cache_store (cache_path, icon_info->pixbuf);
         }
 
+      g_free (cache_path);
+
       if (!icon_info->pixbuf)
         return FALSE;
 
@@ -4142,15 +4791,6 @@ gtk_icon_info_load_icon_finish (GtkIconInfo          *icon_info,
   return gtk_icon_info_load_icon (icon_info, error);
 }
 
-static gchar *
-gdk_color_to_css (GdkColor *color)
-{
-  return g_strdup_printf ("rgb(%d,%d,%d)",
-                          color->red >> 8,
-                          color->green >> 8,
-                          color->blue >> 8);
-}
-
 static void
 proxy_symbolic_pixbuf_destroy (guchar *pixels, gpointer data)
 {
@@ -4200,67 +4840,24 @@ symbolic_cache_get_proxy (SymbolicPixbufCache *symbolic_cache,
   return symbolic_cache->proxy_pixbuf;
 }
 
+/* Renders the symbolic icon of @icon_info once, with the colors
+ * encoded into the channels: success is red, warning is green,
+ * error is blue and the foreground is black. Since compositing is
+ * linear in the colors, each channel of the result is the fraction
+ * of that color in the pixel, and the foreground gets the rest.
+ * icon_info_recolor_symbolic() turns this into the final icon for
+ * any set of colors without touching the SVG again.
+ */
 static GdkPixbuf *
-_gtk_icon_info_load_symbolic_internal (GtkIconInfo  *icon_info,
-				       const GdkRGBA  *fg,
-				       const GdkRGBA  *success_color,
-				       const GdkRGBA  *warning_color,
-				       const GdkRGBA  *error_color,
-				       gboolean        use_cache,
-                                       GError        **error)
+icon_info_render_symbolic_mask (GtkIconInfo  *icon_info,
+                                GError      **error)
 {
   GInputStream *stream;
   GdkPixbuf *pixbuf;
-  gchar *css_fg;
-  gchar *css_success;
-  gchar *css_warning;
-  gchar *css_error;
   gchar *data;
   gchar *width, *height;
   gchar *file_data, *escaped_file_data;
   gsize file_len;
-  SymbolicPixbufCache *symbolic_cache;
-
-  if (use_cache)
-    {
-      symbolic_cache = symbolic_pixbuf_cache_matches (icon_info->symbolic_pixbuf_cache,
-						      fg, success_color, warning_color, error_color);
-      if (symbolic_cache)
-	return symbolic_cache_get_proxy (symbolic_cache, icon_info);
-    }
-
-  /* css_fg can't possibly have failed, otherwise
-   * that would mean we have a broken style */
-  g_return_val_if_fail (fg != NULL, NULL);
-
-  css_fg = gdk_rgba_to_string (fg);
-
-  css_success = css_warning = css_error = NULL;
-
-  if (warning_color)
-    css_warning = gdk_rgba_to_string (warning_color);
-
-  if (error_color)
-    css_error = gdk_rgba_to_string (error_color);
-
-  if (success_color)
-    css_success = gdk_rgba_to_string (success_color);
-
-  if (!css_success)
-    {
-      GdkColor success_default_color = { 0, 0x4e00, 0x9a00, 0x0600 };
-      css_success = gdk_color_to_css (&success_default_color);
-    }
-  if (!css_warning)
-    {
-      GdkColor warning_default_color = { 0, 0xf500, 0x7900, 0x3e00 };
-      css_warning = gdk_color_to_css (&warning_default_color);
-    }
-  if (!css_error)
-    {
-      GdkColor error_default_color = { 0, 0xcc00, 0x0000, 0x0000 };
-      css_error = gdk_color_to_css (&error_default_color);
-    }
 
   if (!g_file_load_contents (icon_info->icon_file, NULL, &file_data, &file_len, NULL, error))
     return NULL;
@@ -4273,7 +4870,10 @@ _gtk_icon_info_load_symbolic_internal (GtkIconInfo  *icon_info,
       g_object_unref (stream);
 
       if (!pixbuf)
-        return NULL;
+        {
+          g_free (file_data);
+          return NULL;
+        }
 
       icon_info->symbolic_pixbuf_size = gtk_requisition_new ();
       icon_info->symbolic_pixbuf_size->width = gdk_pixbuf_get_width (pixbuf);
@@ -4295,26 +4895,22 @@ _gtk_icon_info_load_symbolic_internal (GtkIconInfo  *icon_info,
                       "     height=\"", height, "\">\n"
                       "  <style type=\"text/css\">\n"
                       "    rect,path {\n"
-                      "      fill: ", css_fg," !important;\n"
+                      "      fill: #000000 !important;\n"
                       "    }\n"
                       "    .warning {\n"
-                      "      fill: ", css_warning, " !important;\n"
+                      "      fill: #00ff00 !important;\n"
                       "    }\n"
                       "    .error {\n"
-                      "      fill: ", css_error ," !important;\n"
+                      "      fill: #0000ff !important;\n"
                       "    }\n"
                       "    .success {\n"
-                      "      fill: ", css_success, " !important;\n"
+                      "      fill: #ff0000 !important;\n"
                       "    }\n"
                       "  </style>\n"
                       "  <xi:include href=\"data:text/xml,", escaped_file_data, "\"/>\n"
                       "</svg>",
                       NULL);
   g_free (escaped_file_data);
-  g_free (css_fg);
-  g_free (css_warning);
-  g_free (css_error);
-  g_free (css_success);
   g_free (width);
   g_free (height);
 
@@ -4327,21 +4923,191 @@ _gtk_icon_info_load_symbolic_internal (GtkIconInfo  *icon_info,
                                                 error);
   g_object_unref (stream);
 
-  if (pixbuf != NULL)
+  return pixbuf;
+}
+
+static gboolean
+icon_info_ensure_symbolic_mask (GtkIconInfo  *icon_info,
+                                GError      **error)
+{
+  GdkPixbuf *mask;
+  gchar *cache_path;
+
+  if (icon_info->symbolic_mask)
+    return TRUE;
+
+  cache_path = rendered_cache_get_path (icon_info->icon_file,
+                                        icon_info->desired_size * icon_info->desired_scale,
+                                        "symbolic-mask");
+
+  mask = NULL;
+  if (cache_path)
+    mask = rendered_cache_lookup (cache_path);
+
+  if (mask == NULL)
     {
-      if (use_cache)
-	{
-	  icon_info->symbolic_pixbuf_cache =
-	    symbolic_pixbuf_cache_new (pixbuf, fg, success_color, warning_color, error_color,
-				       icon_info->symbolic_pixbuf_cache);
-	  g_object_unref (pixbuf);
-	  return symbolic_cache_get_proxy (icon_info->symbolic_pixbuf_cache, icon_info);
-	}
-      else
-	return pixbuf;
+      mask = icon_info_render_symbolic_mask (icon_info, error);
+      if (mask && cache_path)
+        rendered_cache_store (cache_path, mask);
     }
 
-  return NULL;
+  g_free (cache_path);
+
+  /* The recoloring below relies on this layout, and the SVG loader
+   * always gives us it
+   */
+  if (mask && (!gdk_pixbuf_get_has_alpha (mask) ||
+               gdk_pixbuf_get_n_channels (mask) != 4 ||
+               gdk_pixbuf_get_bits_per_sample (mask) != 8))
+    {
+      GdkPixbuf *tmp = gdk_pixbuf_add_alpha (mask, FALSE, 0, 0, 0);
+      g_object_unref (mask);
+      mask = tmp;
+    }
+
+  icon_info->symbolic_mask = mask;
+
+  return mask != NULL;
+}
+
+static void
+rgba_to_bytes (const GdkRGBA *rgba,
+               const GdkRGBA *fallback,
+               guint          bytes[4])
+{
+  if (rgba == NULL)
+    rgba = fallback;
+
+  bytes[0] = CLAMP (rgba->red, 0., 1.) * 255. + .5;
+  bytes[1] = CLAMP (rgba->green, 0., 1.) * 255. + .5;
+  bytes[2] = CLAMP (rgba->blue, 0., 1.) * 255. + .5;
+  bytes[3] = CLAMP (rgba->alpha, 0., 1.) * 255. + .5;
+}
+
+/* Mixes the colors according to the fractions stored in the mask
+ * made by icon_info_render_symbolic_mask(). This is a plain loop over
+ * bytes without branches in the inner part, which compilers turn
+ * into vector code, so it is much cheaper than rendering the SVG.
+ */
+static GdkPixbuf *
+icon_info_recolor_symbolic (GdkPixbuf     *mask,
+                            const GdkRGBA *fg,
+                            const GdkRGBA *success_color,
+                            const GdkRGBA *warning_color,
+                            const GdkRGBA *error_color)
+{
+  static const GdkRGBA success_default = { 0x4e / 255., 0x9a / 255., 0x06 / 255., 1.0 };
+  static const GdkRGBA warning_default = { 0xf5 / 255., 0x79 / 255., 0x3e / 255., 1.0 };
+  static const GdkRGBA error_default = { 0xcc / 255., 0x00 / 255., 0x00 / 255., 1.0 };
+  guint f[4], s[4], w[4], e[4];
+  GdkPixbuf *pixbuf;
+  const guchar *src_row;
+  guchar *dest_row;
+  gint width, height, src_stride, dest_stride;
+  gint x, y, c;
+
+  rgba_to_bytes (fg, fg, f);
+  rgba_to_bytes (success_color, &success_default, s);
+  rgba_to_bytes (warning_color, &warning_default, w);
+  rgba_to_bytes (error_color, &error_default, e);
+
+  width = gdk_pixbuf_get_width (mask);
+  height = gdk_pixbuf_get_height (mask);
+  pixbuf = gdk_pixbuf_new (GDK_COLORSPACE_RGB, TRUE, 8, width, height);
+  if (pixbuf == NULL)
+    return NULL;
+
+  src_row = gdk_pixbuf_get_pixels (mask);
+  src_stride = gdk_pixbuf_get_rowstride (mask);
+  dest_row = gdk_pixbuf_get_pixels (pixbuf);
+  dest_stride = gdk_pixbuf_get_rowstride (pixbuf);
+
+  for (y = 0; y < height; y++)
+    {
+      const guchar *src = src_row;
+      guchar *dest = dest_row;
+
+      for (x = 0; x < width; x++)
+        {
+          guint ss = src[0];
+          guint ws = src[1];
+          guint es = src[2];
+          guint sum = ss + ws + es;
+          /* Antialiasing can make the fractions add up to slightly
+           * more than one
+           */
+          guint fs = sum < 255 ? 255 - sum : 0;
+          guint a;
+
+          for (c = 0; c < 3; c++)
+            dest[c] = MIN (f[c] * fs + s[c] * ss + w[c] * ws + e[c] * es, 255 * 255) / 255;
+
+          a = MIN (f[3] * fs + s[3] * ss + w[3] * ws + e[3] * es, 255 * 255) / 255;
+          dest[3] = (a * src[3] + 127) / 255;
+
+          src += 4;
+          dest += 4;
+        }
+
+      src_row += src_stride;
+      dest_row += dest_stride;
+    }
+
+  return pixbuf;
+}
+
+static GdkPixbuf *
+_gtk_icon_info_load_symbolic_internal (GtkIconInfo  *icon_info,
+				       const GdkRGBA  *fg,
+				       const GdkRGBA  *success_color,
+				       const GdkRGBA  *warning_color,
+				       const GdkRGBA  *error_color,
+				       gboolean        use_cache,
+                                       GError        **error)
+{
+  GdkPixbuf *pixbuf;
+  SymbolicPixbufCache *symbolic_cache;
+
+  if (use_cache)
+    {
+      symbolic_cache = symbolic_pixbuf_cache_matches (icon_info->symbolic_pixbuf_cache,
+						      fg, success_color, warning_color, error_color);
+      if (symbolic_cache)
+	return symbolic_cache_get_proxy (symbolic_cache, icon_info);
+    }
+
+  /* fg can't possibly have failed, otherwise
+   * that would mean we have a broken style */
+  g_return_val_if_fail (fg != NULL, NULL);
+
+  /* Only the first load of an icon renders the SVG; new colors,
+   * e.g. from state changes or a dark theme, only recolor the mask
+   */
+  if (!icon_info_ensure_symbolic_mask (icon_info, error))
+    return NULL;
+
+  pixbuf = icon_info_recolor_symbolic (icon_info->symbolic_mask,
+                                       fg, success_color,
+                                       warning_color, error_color);
+  if (pixbuf == NULL)
+    {
+      g_set_error_literal (error,
+                           GDK_PIXBUF_ERROR,
+                           GDK_PIXBUF_ERROR_INSUFFICIENT_MEMORY,
+                           _("Not enough memory to recolor symbolic icon"));
+      return NULL;
+    }
+
+  if (use_cache)
+    {
+      icon_info->symbolic_pixbuf_cache =
+        symbolic_pixbuf_cache_new (pixbuf, fg, success_color, warning_color, error_color,
+                                   icon_info->symbolic_pixbuf_cache);
+      g_object_unref (pixbuf);
+      return symbolic_cache_get_proxy (icon_info->symbolic_pixbuf_cache, icon_info);
+    }
+
+  return pixbuf;
 }
 
 /**
@@ -4689,6 +5455,12 @@ gtk_icon_info_load_symbolic_finish (GtkIconInfo   *icon_info,
 
       g_assert (pixbuf != NULL); /* we checked for !had_error above */
 
+      /* Keep the mask the thread rendered, so that other colors
+       * don't need to render the SVG again
+       */
+      if (icon_info->symbolic_mask == NULL && data->dup->symbolic_mask != NULL)
+        icon_info->symbolic_mask = g_object_ref (data->dup->symbolic_mask);
+
       symbolic_cache = symbolic_pixbuf_cache_matches (icon_info->symbolic_pixbuf_cache,
 						      data->fg_set ? &data->fg : NULL,
 						      data->success_color_set ? &data->success_color : NULL,
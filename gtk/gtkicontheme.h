@@ -311,6 +311,29 @@ cairo_surface_t * gtk_icon_theme_load_surface      (GtkIconTheme        *icon_th
 						    GtkIconLookupFlags   flags,
 						    GError             **error);
 
+void          gtk_icon_theme_lookup_icon_async     (GtkIconTheme                *icon_theme,
+                                                    const gchar                 *icon_name,
+                                                    gint                         size,
+                                                    gint                         scale,
+                                                    GtkIconLookupFlags           flags,
+                                                    GCancellable                *cancellable,
+                                                    GAsyncReadyCallback          callback,
+                                                    gpointer                     user_data);
+GtkIconInfo * gtk_icon_theme_lookup_icon_finish    (GtkIconTheme                *icon_theme,
+                                                    GAsyncResult                *result,
+                                                    GError                     **error);
+void          gtk_icon_theme_choose_icon_async     (GtkIconTheme                *icon_theme,
+                                                    const gchar                 *icon_names[],
+                                                    gint                         size,
+                                                    gint                         scale,
+                                                    GtkIconLookupFlags           flags,
+                                                    GCancellable                *cancellable,
+                                                    GAsyncReadyCallback          callback,
+                                                    gpointer                     user_data);
+GtkIconInfo * gtk_icon_theme_choose_icon_finish    (GtkIconTheme                *icon_theme,
+                                                    GAsyncResult                *result,
+                                                    GError                     **error);
+
 /* Non-public methods */
 void _gtk_icon_theme_ensure_builtin_cache             (void);
 
@@ -34,6 +34,7 @@
 #include "gtkmarshalers.h"
 #include "gtkbindings.h"
 #include "gtkdnd.h"
+#include "gtkdebug.h"
 #include "gtkmain.h"
 #include "gtkintl.h"
 #include "gtkaccessible.h"
@@ -45,6 +46,7 @@
 #include "gtktreednd.h"
 #include "gtktypebuiltins.h"
 #include "gtkprivate.h"
+#include "gtkwidgetprivate.h"
 #include "a11y/gtkiconviewaccessibleprivate.h"
 
 /**
@@ -1047,6 +1049,9 @@ gtk_icon_view_dispose (GObject *object)
       priv->add_editable_id = 0;
       priv->remove_editable_id = 0;
 
+      /* The area may be shared with other widgets */
+      _gtk_cell_area_set_cache_requests (priv->cell_area, FALSE);
+
       g_object_unref (priv->cell_area);
       priv->cell_area = NULL;
     }
@@ -1371,9 +1376,17 @@ gtk_icon_view_state_flags_changed (GtkWidget     *widget,
 static void
 gtk_icon_view_style_updated (GtkWidget *widget)
 {
+  GtkIconViewPrivate *priv = GTK_ICON_VIEW (widget)->priv;
+
   GTK_WIDGET_CLASS (gtk_icon_view_parent_class)->style_updated (widget);
 
   _gtk_icon_view_update_background (GTK_ICON_VIEW (widget));
+
+  /* Fonts and icon sizes may have changed */
+  priv->item_widths_valid = FALSE;
+  if (priv->cell_area)
+    _gtk_cell_area_reset_request_cache (priv->cell_area);
+
   gtk_widget_queue_resize (widget);
 }
 
@@ -1507,6 +1520,36 @@ gtk_icon_view_is_empty (GtkIconView *icon_view)
   return icon_view->priv->items == NULL;
 }
 
+/* Measures the widths of all items into priv->cell_area_context,
+ * unless it still holds them from an earlier call. The widths are
+ * needed several times per size request and allocation cycle, see
+ * the notes about layout below.
+ */
+static void
+gtk_icon_view_ensure_item_widths (GtkIconView *icon_view)
+{
+  GtkIconViewPrivate *priv = icon_view->priv;
+  GList *items;
+
+  if (priv->item_widths_valid)
+    return;
+
+  gtk_cell_area_context_reset (priv->cell_area_context);
+
+  for (items = priv->items; items; items = items->next)
+    {
+      _gtk_icon_view_set_cell_data (icon_view, items->data);
+      if (items == priv->items)
+        adjust_wrap_width (icon_view);
+      gtk_cell_area_get_preferred_width (priv->cell_area,
+                                         priv->cell_area_context,
+                                         GTK_WIDGET (icon_view),
+                                         NULL, NULL);
+    }
+
+  priv->item_widths_valid = TRUE;
+}
+
 static void
 gtk_icon_view_get_preferred_item_size (GtkIconView    *icon_view,
                                        GtkOrientation  orientation,
@@ -1520,32 +1563,50 @@ gtk_icon_view_get_preferred_item_size (GtkIconView    *icon_view,
 
   g_assert (!gtk_icon_view_is_empty (icon_view));
 
-  context = gtk_cell_area_create_context (priv->cell_area);
-
   for_size -= 2 * priv->item_padding;
 
-  if (for_size > 0)
+  if (orientation == GTK_ORIENTATION_HORIZONTAL && for_size <= 0)
     {
-      /* This is necessary for the context to work properly */
+      gtk_icon_view_ensure_item_widths (icon_view);
+      context = g_object_ref (priv->cell_area_context);
+    }
+  else
+    {
+      if (orientation == GTK_ORIENTATION_VERTICAL && for_size > 0)
+        {
+          /* The context needs the widths of all items first,
+           * we already have them */
+          gtk_icon_view_ensure_item_widths (icon_view);
+          context = gtk_cell_area_copy_context (priv->cell_area, priv->cell_area_context);
+        }
+      else
+        {
+          context = gtk_cell_area_create_context (priv->cell_area);
+
+          if (for_size > 0)
+            {
+              /* This is necessary for the context to work properly */
+              for (items = priv->items; items; items = items->next)
+                {
+                  GtkIconViewItem *item = items->data;
+
+                  _gtk_icon_view_set_cell_data (icon_view, item);
+                  cell_area_get_preferred_size (icon_view, context, 1 - orientation, -1, NULL, NULL);
+                }
+            }
+        }
+
       for (items = priv->items; items; items = items->next)
         {
           GtkIconViewItem *item = items->data;
 
           _gtk_icon_view_set_cell_data (icon_view, item);
-          cell_area_get_preferred_size (icon_view, context, 1 - orientation, -1, NULL, NULL);
+          if (items == priv->items)
+            adjust_wrap_width (icon_view);
+          cell_area_get_preferred_size (icon_view, context, orientation, for_size, NULL, NULL);
         }
     }
 
-  for (items = priv->items; items; items = items->next)
-    {
-      GtkIconViewItem *item = items->data;
-
-      _gtk_icon_view_set_cell_data (icon_view, item);
-      if (items == priv->items)
-        adjust_wrap_width (icon_view);
-      cell_area_get_preferred_size (icon_view, context, orientation, for_size, NULL, NULL);
-    }
-
   if (orientation == GTK_ORIENTATION_HORIZONTAL)
     {
       if (for_size > 0)
@@ -1681,6 +1742,10 @@ gtk_icon_view_get_preferred_width (GtkWidget *widget,
   GtkIconViewPrivate *priv = icon_view->priv;
   int item_min, item_nat;
 
+  /* We only get here after a resize was queued, so the cells
+   * may have changed in ways we weren't told about */
+  priv->item_widths_valid = FALSE;
+
   if (gtk_icon_view_is_empty (icon_view))
     {
       *minimum = *natural = 2 * priv->margin;
@@ -2120,7 +2185,7 @@ gtk_icon_view_item_selected_changed (GtkIconView      *icon_view,
   AtkObject *obj;
   AtkObject *item_obj;
 
-  obj = gtk_widget_get_accessible (GTK_WIDGET (icon_view));
+  obj = _gtk_widget_peek_accessible (GTK_WIDGET (icon_view));
   if (obj != NULL)
     {
       item_obj = atk_object_ref_accessible_child (obj, item->index);
@@ -2987,18 +3052,7 @@ gtk_icon_view_layout (GtkIconView *icon_view)
   /* Clear the per row contexts */
   g_ptr_array_set_size (icon_view->priv->row_contexts, 0);
 
-  gtk_cell_area_context_reset (priv->cell_area_context);
-  /* because layouting is complicated. We designed an API
-   * that is O(N²) and nonsensical.
-   * And we're proud of it. */
-  for (items = priv->items; items; items = items->next)
-    {
-      _gtk_icon_view_set_cell_data (icon_view, items->data);
-      gtk_cell_area_get_preferred_width (priv->cell_area,
-                                         priv->cell_area_context,
-                                         widget,
-                                         NULL, NULL);
-    }
+  gtk_icon_view_ensure_item_widths (icon_view);
 
   sizes = g_newa (GtkRequestedSize, n_rows);
   items = priv->items;
@@ -3082,6 +3136,7 @@ gtk_icon_view_invalidate_sizes (GtkIconView *icon_view)
   /* Clear all item sizes */
   g_list_foreach (icon_view->priv->items,
 		  (GFunc)gtk_icon_view_item_invalidate_size, NULL);
+  icon_view->priv->item_widths_valid = FALSE;
 
   /* Re-layout the items */
   gtk_widget_queue_resize (GTK_WIDGET (icon_view));
@@ -3258,7 +3313,7 @@ _gtk_icon_view_set_cursor_item (GtkIconView     *icon_view,
       (cursor_cell == NULL || cursor_cell == gtk_cell_area_get_focus_cell (icon_view->priv->cell_area)))
     return;
 
-  obj = gtk_widget_get_accessible (GTK_WIDGET (icon_view));
+  obj = _gtk_widget_peek_accessible (GTK_WIDGET (icon_view));
   if (icon_view->priv->cursor_item != NULL)
     {
       gtk_icon_view_queue_draw_item (icon_view, icon_view->priv->cursor_item);
@@ -3280,6 +3335,9 @@ _gtk_icon_view_set_cursor_item (GtkIconView     *icon_view,
 	gtk_cell_area_focus (icon_view->priv->cell_area, GTK_DIR_TAB_FORWARD);
     }
   
+  if (obj == NULL)
+    return;
+
   /* Notify that accessible focus object has changed */
   item_obj = atk_object_ref_accessible_child (obj, item->index);
 
@@ -3416,6 +3474,10 @@ verify_items (GtkIconView *icon_view)
   GList *items;
   int i = 0;
 
+  /* This walks all items for every change of the model */
+  if (!(gtk_get_debug_flags () & GTK_DEBUG_TREE))
+    return;
+
   for (items = icon_view->priv->items; items; items = items->next)
     {
       GtkIconViewItem *item = items->data;
@@ -3426,6 +3488,9 @@ verify_items (GtkIconView *icon_view)
 
       i++;
     }
+
+  if (icon_view->priv->last_item != g_list_last (icon_view->priv->items))
+    g_error ("Last item pointer does not point to the last item");
 }
 
 static void
@@ -3435,6 +3500,7 @@ gtk_icon_view_row_changed (GtkTreeModel *model,
                            gpointer      data)
 {
   GtkIconView *icon_view = GTK_ICON_VIEW (data);
+  GtkIconViewItem *item;
 
   /* ignore changes in branches */
   if (gtk_tree_path_get_depth (path) > 1)
@@ -3447,15 +3513,17 @@ gtk_icon_view_row_changed (GtkTreeModel *model,
   if (icon_view->priv->cell_area)
     gtk_cell_area_stop_editing (icon_view->priv->cell_area, TRUE);
 
-  /* Here we can use a "grow-only" strategy for optimization
-   * and only invalidate a single item and queue a relayout
-   * instead of invalidating the whole thing.
-   *
-   * For now GtkIconView still cant deal with huge models
-   * so just invalidate the whole thing when the model
-   * changes.
+  /* Only the changed item needs to be hidden until the next
+   * layout, the relayout measures all items anyway since the
+   * item size is shared by all of them.
    */
-  gtk_icon_view_invalidate_sizes (icon_view);
+  item = g_list_nth_data (icon_view->priv->items,
+                          gtk_tree_path_get_indices (path)[0]);
+  if (item)
+    gtk_icon_view_item_invalidate_size (item);
+
+  icon_view->priv->item_widths_valid = FALSE;
+  gtk_widget_queue_resize (GTK_WIDGET (icon_view));
 
   verify_items (icon_view);
 }
@@ -3467,6 +3535,7 @@ gtk_icon_view_row_inserted (GtkTreeModel *model,
 			    gpointer      data)
 {
   GtkIconView *icon_view = GTK_ICON_VIEW (data);
+  GtkIconViewPrivate *priv = icon_view->priv;
   gint index;
   GtkIconViewItem *item;
   GList *list;
@@ -3481,23 +3550,33 @@ gtk_icon_view_row_inserted (GtkTreeModel *model,
 
   item->index = index;
 
-  /* FIXME: We can be more efficient here,
-     we can store a tail pointer and use that when
-     appending (which is a rather common operation)
-  */
-  icon_view->priv->items = g_list_insert (icon_view->priv->items,
-					 item, index);
-  
-  list = g_list_nth (icon_view->priv->items, index + 1);
-  for (; list; list = list->next)
+  /* Appending is a rather common operation, use the tail
+   * pointer for it instead of walking the whole list */
+  if (priv->last_item &&
+      ((GtkIconViewItem *) priv->last_item->data)->index == index - 1)
     {
-      item = list->data;
+      g_list_append (priv->last_item, item);
+      priv->last_item = priv->last_item->next;
+    }
+  else
+    {
+      list = g_list_nth (priv->items, index);
+      priv->items = g_list_insert_before (priv->items, list, item);
+
+      if (list == NULL)
+        priv->last_item = g_list_last (priv->items);
+
+      for (; list; list = list->next)
+        {
+          item = list->data;
 
-      item->index++;
+          item->index++;
+        }
     }
-    
+
   verify_items (icon_view);
 
+  priv->item_widths_valid = FALSE;
   gtk_widget_queue_resize (GTK_WIDGET (icon_view));
 }
 
@@ -3545,10 +3624,14 @@ gtk_icon_view_row_deleted (GtkTreeModel *model,
       item->index--;
     }
   
+  if (list == icon_view->priv->last_item)
+    icon_view->priv->last_item = list->prev;
+
   icon_view->priv->items = g_list_delete_link (icon_view->priv->items, list);
 
   verify_items (icon_view);  
   
+  icon_view->priv->item_widths_valid = FALSE;
   gtk_widget_queue_resize (GTK_WIDGET (icon_view));
 
   if (emit)
@@ -3596,6 +3679,7 @@ gtk_icon_view_rows_reordered (GtkTreeModel *model,
   g_free (item_array);
   g_list_free (icon_view->priv->items);
   icon_view->priv->items = items;
+  icon_view->priv->last_item = g_list_last (items);
 
   gtk_widget_queue_resize (GTK_WIDGET (icon_view));
 
@@ -3627,6 +3711,7 @@ gtk_icon_view_build_items (GtkIconView *icon_view)
       
     } while (gtk_tree_model_iter_next (icon_view->priv->model, &iter));
 
+  icon_view->priv->last_item = items;
   icon_view->priv->items = g_list_reverse (items);
 }
 
@@ -4311,6 +4396,9 @@ gtk_icon_view_ensure_cell_area (GtkIconView *icon_view,
 
   g_object_ref_sink (priv->cell_area);
 
+  /* Icon views tend to show many items with the same icon */
+  _gtk_cell_area_set_cache_requests (priv->cell_area, TRUE);
+
   if (GTK_IS_ORIENTABLE (priv->cell_area))
     gtk_orientable_set_orientation (GTK_ORIENTABLE (priv->cell_area), priv->item_orientation);
 
@@ -5049,6 +5137,8 @@ gtk_icon_view_set_model (GtkIconView *icon_view,
       
       g_list_free_full (icon_view->priv->items, (GDestroyNotify) gtk_icon_view_item_free);
       icon_view->priv->items = NULL;
+      icon_view->priv->last_item = NULL;
+      icon_view->priv->item_widths_valid = FALSE;
       icon_view->priv->anchor_item = NULL;
       icon_view->priv->cursor_item = NULL;
       icon_view->priv->last_single_clicked = NULL;
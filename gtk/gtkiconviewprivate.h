@@ -59,6 +59,7 @@ struct _GtkIconViewPrivate
   GtkTreeModel *model;
 
   GList *items;
+  GList *last_item;
 
   GtkAdjustment *hadjustment;
   GtkAdjustment *vadjustment;
@@ -131,6 +132,9 @@ struct _GtkIconViewPrivate
 
   guint doing_rubberband : 1;
 
+  /* cell_area_context holds the widths of all items */
+  guint item_widths_valid : 1;
+
 };
 
 void                 _gtk_icon_view_set_cell_data                  (GtkIconView            *icon_view,
@@ -25,6 +25,7 @@
 #include "gtkprivate.h"
 #include "gtkaccelgroup.h"
 #include "gtkimcontextsimple.h"
+#include "gtkcomposetableprivate.h"
 #include "gtksettings.h"
 #include "gtkwidget.h"
 #include "gtkdebug.h"
@@ -35,6 +36,14 @@
  * SECTION:gtkimcontextsimple
  * @Short_description: An input method context supporting table-based input methods
  * @Title: GtkIMContextSimple
+ *
+ * GtkIMContextSimple supports compose sequences from the built-in
+ * table, from tables added with gtk_im_context_simple_add_table(),
+ * and from the user's compose file: <filename>~/.XCompose</filename>,
+ * or the file named by the <envar>XCOMPOSEFILE</envar> environment
+ * variable. Sequences in the user's file take precedence over the
+ * built-in ones. Only sequences that produce a single character
+ * are supported.
  */
 
 
@@ -297,6 +306,46 @@ check_table (GtkIMContextSimple    *context_simple,
   return FALSE;
 }
 
+/* Looks the compose buffer up in the user's compose file, see
+ * gtkcomposetable.c. This behaves like check_table().
+ */
+static gboolean
+check_user_table (GtkIMContextSimple *context_simple,
+                  gint                n_compose)
+{
+  GtkIMContextSimplePrivate *priv = context_simple->priv;
+  const GtkComposeTrie *trie;
+  gunichar value;
+  gboolean finished;
+
+  trie = _gtk_compose_trie_get_user ();
+  if (trie == NULL)
+    return FALSE;
+
+  if (!_gtk_compose_trie_lookup (trie, priv->compose_buffer, n_compose,
+                                 &value, &finished))
+    return FALSE;
+
+  if (value != 0)
+    {
+      if (!finished)
+        {
+          /* A longer sequence starts with this one */
+          priv->tentative_match = value;
+          priv->tentative_match_len = n_compose;
+
+          g_signal_emit_by_name (context_simple, "preedit-changed");
+
+          return TRUE;
+        }
+
+      gtk_im_context_simple_commit_char (GTK_IM_CONTEXT (context_simple), value);
+      priv->compose_buffer[0] = 0;
+    }
+
+  return TRUE;
+}
+
 /* Checks if a keysym is a dead key. Dead key keysym values are defined in
  * ../gdk/gdkkeysyms.h and the first is GDK_KEY_dead_grave. As X.Org is updated,
  * more dead keys are added and we need to update the upper limit.
@@ -1066,6 +1115,9 @@ g_print ("committing tentative match on release\n");
 	  g_print ("] ");
 	});
 
+      if (check_user_table (context_simple, n_compose))
+        return TRUE;
+
 #ifdef GDK_WINDOWING_WIN32
       if (check_win32_special_cases (context_simple, n_compose))
 	return TRUE;
@@ -320,6 +320,7 @@ gtk_im_module_initialize (void)
   gchar *filename = gtk_rc_get_im_module_file();
   FILE *file;
   gboolean have_error = FALSE;
+  gint64 begin = gdk_profiler_begin_mark_libgtk_only ();
 
   GtkIMModule *module = NULL;
   GSList *infos = NULL;
@@ -395,6 +396,7 @@ gtk_im_module_initialize (void)
       g_string_free (line_buf, TRUE);
       g_string_free (tmp_buf, TRUE);
       g_free (filename);
+      gdk_profiler_end_mark_libgtk_only (begin, "im-modules", NULL);
       return;
     }
 
@@ -499,6 +501,8 @@ gtk_im_module_initialize (void)
   g_string_free (line_buf, TRUE);
   g_string_free (tmp_buf, TRUE);
   g_free (filename);
+
+  gdk_profiler_end_mark_libgtk_only (begin, "im-modules", NULL);
 }
 
 static gint
@@ -259,7 +259,7 @@ _gtk_key_hash_remove_entry (GtkKeyHash *key_hash,
 	    }
 	}
 	  
-      g_hash_table_remove (key_hash->reverse_hash, entry_node);
+      g_hash_table_remove (key_hash->reverse_hash, value);
       key_hash->entries_list = g_list_delete_link (key_hash->entries_list, entry_node);
 
       key_hash_free_entry (key_hash, entry);
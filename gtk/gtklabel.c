@@ -52,6 +52,7 @@
 #include "gtktooltip.h"
 #include "gtkprivate.h"
 #include "gtktypebuiltins.h"
+#include "gtkwidgetprivate.h"
 #include "gtkmain.h"
 
 #include "a11y/gtklabelaccessibleprivate.h"
@@ -237,6 +238,9 @@
  * </refsect2>
  */
 
+/* Number of height-for-width (or width-for-height) results to keep */
+#define N_CACHED_SIZES 4
+
 struct _GtkLabelPrivate
 {
   GtkLabelSelectionInfo *select_info;
@@ -270,6 +274,15 @@ struct _GtkLabelPrivate
   gint     width_chars;
   gint     max_width_chars;
   gint     lines;
+
+  /* Results of get_size_for_allocation() since the layout was last
+   * cleared, for the pango context serial in size_cache_serial
+   */
+  gint     size_cache_for_size[N_CACHED_SIZES];
+  gint     size_cache_size[N_CACHED_SIZES];
+  guint    size_cache_serial;
+  guint    n_cached_sizes;
+  guint    next_cached_size;
 };
 
 /* Notes about the handling of links:
@@ -584,6 +597,11 @@ gtk_label_class_init (GtkLabelClass *class)
   widget_class->get_preferred_width_for_height = gtk_label_get_preferred_width_for_height;
   widget_class->get_preferred_height_for_width = gtk_label_get_preferred_height_for_width;
 
+  /* Wrapping labels get asked for a new width on every step
+   * of an interactive resize, and measuring them means running
+   * Pango, so keep more results around. */
+  _gtk_widget_class_set_request_cache_size (widget_class, 10);
+
   class->move_cursor = gtk_label_move_cursor;
   class->copy_clipboard = gtk_label_copy_clipboard;
   class->activate_link = gtk_label_activate_link;
@@ -2116,7 +2134,7 @@ gtk_label_recalculate (GtkLabel *label)
 
   gtk_label_clear_layout (label);
   gtk_label_clear_select_info (label);
-  gtk_widget_queue_resize (GTK_WIDGET (label));
+  _gtk_widget_queue_resize_if_changed (GTK_WIDGET (label));
 }
 
 /**
@@ -3090,7 +3108,8 @@ gtk_label_set_line_wrap_mode (GtkLabel *label,
     {
       priv->wrap_mode = wrap_mode;
       g_object_notify (G_OBJECT (label), "wrap-mode");
-      
+
+      gtk_label_clear_layout (label);
       gtk_widget_queue_resize (GTK_WIDGET (label));
     }
 }
@@ -3157,6 +3176,8 @@ gtk_label_clear_layout (GtkLabel *label)
       g_object_unref (priv->layout);
       priv->layout = NULL;
     }
+
+  priv->n_cached_sizes = 0;
 }
 
 /**
@@ -3466,6 +3487,59 @@ gtk_label_get_request_mode (GtkWidget *widget)
     return GTK_SIZE_REQUEST_CONSTANT_SIZE;
 }
 
+static gboolean
+get_cached_size (GtkLabel *label,
+                 gint      for_size,
+                 gint     *size)
+{
+  GtkLabelPrivate *priv = label->priv;
+  PangoContext *context;
+  guint i;
+
+  context = gtk_widget_get_pango_context (GTK_WIDGET (label));
+  if (priv->size_cache_serial != pango_context_get_serial (context))
+    {
+      priv->n_cached_sizes = 0;
+      return FALSE;
+    }
+
+  for (i = 0; i < priv->n_cached_sizes; i++)
+    {
+      if (priv->size_cache_for_size[i] == for_size)
+        {
+          *size = priv->size_cache_size[i];
+          return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
+static void
+add_cached_size (GtkLabel *label,
+                 gint      for_size,
+                 gint      size)
+{
+  GtkLabelPrivate *priv = label->priv;
+  PangoContext *context;
+  guint i;
+
+  context = gtk_widget_get_pango_context (GTK_WIDGET (label));
+  if (priv->n_cached_sizes == 0)
+    priv->size_cache_serial = pango_context_get_serial (context);
+
+  if (priv->n_cached_sizes < N_CACHED_SIZES)
+    i = priv->n_cached_sizes++;
+  else
+    {
+      i = priv->next_cached_size;
+      priv->next_cached_size = (i + 1) % N_CACHED_SIZES;
+    }
+
+  priv->size_cache_for_size[i] = for_size;
+  priv->size_cache_size[i] = size;
+}
+
 static void
 get_size_for_allocation (GtkLabel        *label,
                          GtkOrientation   orientation,
@@ -3473,20 +3547,36 @@ get_size_for_allocation (GtkLabel        *label,
                          gint            *minimum_size,
                          gint            *natural_size)
 {
+  GtkLabelPrivate *priv = label->priv;
   PangoLayout *layout;
   gint text_height;
 
-  layout = gtk_label_get_measuring_layout (label, NULL, allocation * PANGO_SCALE);
+  /* Containers tend to ask for the same sizes over and over during
+   * one allocation, so don't shape the text again for those.
+   */
+  if (!get_cached_size (label, allocation, &text_height))
+    {
+      /* Measure on a fresh layout, but keep the other cached sizes */
+      if (priv->layout)
+        {
+          g_object_unref (priv->layout);
+          priv->layout = NULL;
+        }
 
-  pango_layout_get_pixel_size (layout, NULL, &text_height);
+      layout = gtk_label_get_measuring_layout (label, NULL, allocation * PANGO_SCALE);
+
+      pango_layout_get_pixel_size (layout, NULL, &text_height);
+
+      g_object_unref (layout);
+
+      add_cached_size (label, allocation, text_height);
+    }
 
   if (minimum_size)
     *minimum_size = text_height;
 
   if (natural_size)
     *natural_size = text_height;
-
-  g_object_unref (layout);
 }
 
 static gint
@@ -3718,9 +3808,6 @@ gtk_label_get_preferred_width_for_height (GtkWidget *widget,
 
       _gtk_misc_get_padding_and_border (GTK_MISC (label), &border);
 
-      if (priv->wrap)
-        gtk_label_clear_layout (label);
-
       get_size_for_allocation (label, GTK_ORIENTATION_VERTICAL,
                                MAX (1, height - border.top - border.bottom),
                                minimum_width, natural_width);
@@ -3750,9 +3837,6 @@ gtk_label_get_preferred_height_for_width (GtkWidget *widget,
 
       _gtk_misc_get_padding_and_border (GTK_MISC (label), &border);
 
-      if (priv->wrap)
-        gtk_label_clear_layout (label);
-
       get_size_for_allocation (label, GTK_ORIENTATION_HORIZONTAL,
                                MAX (1, width - border.left - border.right),
                                minimum_height, natural_height);
@@ -6523,6 +6607,7 @@ gtk_label_set_lines (GtkLabel *label,
     {
       priv->lines = lines;
       g_object_notify (G_OBJECT (label), "lines");
+      gtk_label_clear_layout (label);
       gtk_widget_queue_resize (GTK_WIDGET (label));
     }
 }
@@ -90,6 +90,12 @@ typedef struct
 
   int n_visible_rows;
   gboolean in_widget;
+
+  /* Invalidations waiting for the next frame */
+  gboolean sort_pending;
+  gboolean filter_pending;
+  gboolean headers_pending;
+  guint invalidate_tick_id;
 } GtkListBoxPrivate;
 
 typedef struct
@@ -128,6 +134,8 @@ G_DEFINE_TYPE_WITH_PRIVATE (GtkListBoxRow, gtk_list_box_row, GTK_TYPE_BIN)
 static void                 gtk_list_box_update_selected              (GtkListBox          *list_box,
                                                                        GtkListBoxRow       *row);
 static void                 gtk_list_box_apply_filter_all             (GtkListBox          *list_box);
+static void                 gtk_list_box_flush_invalidations          (GtkListBox          *list_box);
+static void                 gtk_list_box_do_reseparate                (GtkListBox          *list_box);
 static void                 gtk_list_box_update_header                (GtkListBox          *list_box,
                                                                        GSequenceIter       *iter);
 static GSequenceIter *      gtk_list_box_get_next_visible             (GtkListBox          *list_box,
@@ -509,6 +517,8 @@ gtk_list_box_get_row_at_index (GtkListBox *list_box,
 
   g_return_val_if_fail (list_box != NULL, NULL);
 
+  gtk_list_box_flush_invalidations (list_box);
+
   iter = g_sequence_get_iter_at_pos (priv->children, index_);
   if (iter)
     return g_sequence_get (iter);
@@ -538,6 +548,8 @@ gtk_list_box_get_row_at_y (GtkListBox *list_box,
 
   g_return_val_if_fail (list_box != NULL, NULL);
 
+  gtk_list_box_flush_invalidations (list_box);
+
   /* TODO: This should use g_sequence_search */
 
   found_row = NULL;
@@ -816,6 +828,95 @@ gtk_list_box_set_header_func (GtkListBox                 *list_box,
   gtk_list_box_invalidate_headers (list_box);
 }
 
+static gint
+do_sort (GtkListBoxRow *a,
+         GtkListBoxRow *b,
+         GtkListBox *list_box)
+{
+  GtkListBoxPrivate *priv = gtk_list_box_get_instance_private (list_box);
+
+  return priv->sort_func (a, b, priv->sort_func_target);
+}
+
+/* Applies sort, filter and header invalidations that were queued
+ * with gtk_list_box_queue_invalidations(). Anything that depends on
+ * the order or visibility of the rows outside of the frame cycle has
+ * to call this first.
+ */
+static void
+gtk_list_box_flush_invalidations (GtkListBox *list_box)
+{
+  GtkListBoxPrivate *priv = gtk_list_box_get_instance_private (list_box);
+
+  if (priv->invalidate_tick_id != 0)
+    {
+      gtk_widget_remove_tick_callback (GTK_WIDGET (list_box), priv->invalidate_tick_id);
+      priv->invalidate_tick_id = 0;
+    }
+
+  if (!priv->sort_pending && !priv->filter_pending && !priv->headers_pending)
+    return;
+
+  if (priv->sort_pending)
+    {
+      priv->sort_pending = FALSE;
+      if (priv->sort_func != NULL)
+        g_sequence_sort (priv->children,
+                         (GCompareDataFunc)do_sort, list_box);
+    }
+
+  if (priv->filter_pending)
+    {
+      priv->filter_pending = FALSE;
+      gtk_list_box_apply_filter_all (list_box);
+    }
+
+  if (priv->headers_pending)
+    {
+      priv->headers_pending = FALSE;
+      if (gtk_widget_get_visible (GTK_WIDGET (list_box)))
+        gtk_list_box_do_reseparate (list_box);
+    }
+
+  gtk_widget_queue_resize (GTK_WIDGET (list_box));
+}
+
+static gboolean
+gtk_list_box_invalidate_tick (GtkWidget     *widget,
+                              GdkFrameClock *frame_clock,
+                              gpointer       user_data)
+{
+  GtkListBoxPrivate *priv = gtk_list_box_get_instance_private (GTK_LIST_BOX (widget));
+
+  priv->invalidate_tick_id = 0;
+  gtk_list_box_flush_invalidations (GTK_LIST_BOX (widget));
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Each invalidation re-sorts, re-filters or re-separates all rows,
+ * so when the list box is on screen they are collected and applied
+ * once, before the next frame is laid out.
+ */
+static void
+gtk_list_box_queue_invalidations (GtkListBox *list_box)
+{
+  GtkListBoxPrivate *priv = gtk_list_box_get_instance_private (list_box);
+
+  if (priv->invalidate_tick_id != 0)
+    return;
+
+  if (!gtk_widget_get_realized (GTK_WIDGET (list_box)))
+    {
+      gtk_list_box_flush_invalidations (list_box);
+      return;
+    }
+
+  priv->invalidate_tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (list_box),
+                                                           gtk_list_box_invalidate_tick,
+                                                           NULL, NULL);
+}
+
 /**
  * gtk_list_box_invalidate_filter:
  * @list_box: a #GtkListBox
@@ -830,22 +931,14 @@ gtk_list_box_set_header_func (GtkListBox                 *list_box,
  */
 void
 gtk_list_box_invalidate_filter (GtkListBox *list_box)
-{
-  g_return_if_fail (list_box != NULL);
-
-  gtk_list_box_apply_filter_all (list_box);
-  gtk_list_box_invalidate_headers (list_box);
-  gtk_widget_queue_resize (GTK_WIDGET (list_box));
-}
-
-static gint
-do_sort (GtkListBoxRow *a,
-         GtkListBoxRow *b,
-         GtkListBox *list_box)
 {
   GtkListBoxPrivate *priv = gtk_list_box_get_instance_private (list_box);
 
-  return priv->sort_func (a, b, priv->sort_func_target);
+  g_return_if_fail (list_box != NULL);
+
+  priv->filter_pending = TRUE;
+  priv->headers_pending = TRUE;
+  gtk_list_box_queue_invalidations (list_box);
 }
 
 /**
@@ -865,10 +958,9 @@ gtk_list_box_invalidate_sort (GtkListBox *list_box)
 
   g_return_if_fail (list_box != NULL);
 
-  g_sequence_sort (priv->children,
-                   (GCompareDataFunc)do_sort, list_box);
-  gtk_list_box_invalidate_headers (list_box);
-  gtk_widget_queue_resize (GTK_WIDGET (list_box));
+  priv->sort_pending = TRUE;
+  priv->headers_pending = TRUE;
+  gtk_list_box_queue_invalidations (list_box);
 }
 
 static void
@@ -899,12 +991,15 @@ gtk_list_box_do_reseparate (GtkListBox *list_box)
 void
 gtk_list_box_invalidate_headers (GtkListBox *list_box)
 {
+  GtkListBoxPrivate *priv = gtk_list_box_get_instance_private (list_box);
+
   g_return_if_fail (list_box != NULL);
 
   if (!gtk_widget_get_visible (GTK_WIDGET (list_box)))
     return;
 
-  gtk_list_box_do_reseparate (list_box);
+  priv->headers_pending = TRUE;
+  gtk_list_box_queue_invalidations (list_box);
 }
 
 /**
@@ -953,16 +1048,19 @@ gtk_list_box_got_row_changed (GtkListBox    *list_box,
   g_return_if_fail (list_box != NULL);
   g_return_if_fail (row != NULL);
 
+  /* Parts that are invalidated for all rows already are left to
+   * the pending full pass */
   prev_next = gtk_list_box_get_next_visible (list_box, row_priv->iter);
-  if (priv->sort_func != NULL)
+  if (priv->sort_func != NULL && !priv->sort_pending)
     {
       g_sequence_sort_changed (row_priv->iter,
                                (GCompareDataFunc)do_sort,
                                list_box);
       gtk_widget_queue_resize (GTK_WIDGET (list_box));
     }
-  gtk_list_box_apply_filter (list_box, row);
-  if (gtk_widget_get_visible (GTK_WIDGET (list_box)))
+  if (!priv->filter_pending)
+    gtk_list_box_apply_filter (list_box, row);
+  if (gtk_widget_get_visible (GTK_WIDGET (list_box)) && !priv->headers_pending)
     {
       next = gtk_list_box_get_next_visible (list_box, row_priv->iter);
       gtk_list_box_update_header (list_box, row_priv->iter);
@@ -1333,6 +1431,8 @@ gtk_list_box_real_focus (GtkWidget        *widget,
   GtkWidget *focus_child;
   GtkListBoxRow *next_focus_row;
 
+  gtk_list_box_flush_invalidations (list_box);
+
   focus_child = gtk_container_get_focus_child ((GtkContainer*) list_box);
   next_focus_row = NULL;
   if (focus_child != NULL)
@@ -2225,6 +2325,8 @@ gtk_list_box_real_move_cursor (GtkListBox      *list_box,
   gint start_y;
   gint end_y;
 
+  gtk_list_box_flush_invalidations (list_box);
+
   modify_selection_pressed = FALSE;
 
   if (gtk_get_current_event_state (&state))
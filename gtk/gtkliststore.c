@@ -2327,6 +2327,90 @@ gtk_list_store_insert_with_valuesv (GtkListStore *list_store,
   gtk_tree_path_free (path);
 }
 
+/**
+ * gtk_list_store_insert_many:
+ * @list_store: A #GtkListStore
+ * @position: position to insert the first new row, or -1 to append
+ * @n_rows: the number of rows to insert
+ * @columns: (array length=n_values): an array of column numbers
+ * @values: (array): an array of @n_rows times @n_values GValues, the
+ *     values of the first row followed by those of the second row and
+ *     so on
+ * @n_values: the number of values per row, the length of @columns
+ *
+ * Inserts @n_rows rows starting at @position, filled in with @values.
+ * This is the same as calling gtk_list_store_insert_with_valuesv()
+ * with increasing positions, but the position of the new rows is
+ * only looked up once.
+ *
+ * A #GtkTreeModel::row-inserted signal is still emitted for every
+ * row once it has been filled in, so that views and proxy models
+ * never see rows they have not been told about.
+ *
+ * Since: 3.12
+ */
+void
+gtk_list_store_insert_many (GtkListStore *list_store,
+                            gint          position,
+                            gint          n_rows,
+                            gint         *columns,
+                            GValue       *values,
+                            gint          n_values)
+{
+  GtkListStorePrivate *priv;
+  GSequenceIter *ptr;
+  GtkTreeIter iter;
+  gint length, i;
+
+  g_return_if_fail (GTK_IS_LIST_STORE (list_store));
+  g_return_if_fail (n_rows >= 0);
+  g_return_if_fail (n_rows == 0 || n_values == 0 || (columns != NULL && values != NULL));
+
+  priv = list_store->priv;
+
+  if (n_rows == 0)
+    return;
+
+  priv->columns_dirty = TRUE;
+
+  length = g_sequence_get_length (priv->seq);
+  if (position > length || position < 0)
+    position = length;
+
+  /* The new rows all go before this one */
+  ptr = g_sequence_get_iter_at_pos (priv->seq, position);
+
+  for (i = 0; i < n_rows; i++)
+    {
+      GtkTreePath *path;
+      gboolean changed = FALSE;
+      gboolean maybe_need_sort = FALSE;
+
+      iter.stamp = priv->stamp;
+      iter.user_data = g_sequence_insert_before (ptr, NULL);
+
+      priv->length++;
+
+      gtk_list_store_set_vector_internal (list_store, &iter,
+                                          &changed, &maybe_need_sort,
+                                          columns, values + i * n_values,
+                                          n_values);
+
+      /* Don't emit rows_reordered here */
+      if (maybe_need_sort && GTK_LIST_STORE_IS_SORTED (list_store))
+        g_sequence_sort_changed_iter (iter.user_data,
+                                      gtk_list_store_compare_func,
+                                      list_store);
+
+      /* Not incremented, because handlers of the previous row may
+       * have changed the store; this is cheap for a GSequence.
+       */
+      path = gtk_list_store_get_path (GTK_TREE_MODEL (list_store), &iter);
+      gtk_tree_model_row_inserted (GTK_TREE_MODEL (list_store), path, &iter);
+      gtk_tree_path_free (path);
+    }
+}
+
 /* GtkBuildable custom tag implementation
  *
  * <columns>
@@ -107,6 +107,12 @@ void          gtk_list_store_insert_with_valuesv (GtkListStore *list_store,
 						  gint         *columns,
 						  GValue       *values,
 						  gint          n_values);
+void          gtk_list_store_insert_many         (GtkListStore *list_store,
+						  gint          position,
+						  gint          n_rows,
+						  gint         *columns,
+						  GValue       *values,
+						  gint          n_values);
 void          gtk_list_store_prepend          (GtkListStore *list_store,
 					       GtkTreeIter  *iter);
 void          gtk_list_store_append           (GtkListStore *list_store,
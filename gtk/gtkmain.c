@@ -109,6 +109,11 @@
 #undef STRICT
 #endif
 
+#ifdef G_OS_UNIX
+#include <signal.h>
+#include <glib-unix.h>
+#endif
+
 #include "gtkintl.h"
 
 #include "gtkaccelmapprivate.h"
@@ -238,6 +243,20 @@ static GSList *key_snoopers = NULL;
 
 static guint debug_flags = 0;              /* Global GTK debug flag */
 
+static const struct {
+  const char *name;
+  const char *description;
+} counter_info[GTK_N_COUNTERS] = {
+  { "style-contexts", "Number of live GtkStyleContexts" },
+  { "css-computed-values", "Number of live GtkCssComputedValues" },
+  { "css-values", "Number of live GtkCssValues" },
+  { "rbtree-nodes", "Number of allocated GtkRBTree nodes" },
+  { "pixel-cache-bytes", "Bytes held in pixel cache tiles" }
+};
+
+static gint64 counters[GTK_N_COUNTERS];
+static guint counter_ids[GTK_N_COUNTERS];
+
 gboolean enable_gtk2_workaround = FALSE;
 gboolean enable_gtk3_emulation = FALSE;
 
@@ -256,7 +275,9 @@ static const GDebugKey gtk_debug_keys[] = {
   {"printing", GTK_DEBUG_PRINTING},
   {"builder", GTK_DEBUG_BUILDER},
   {"size-request", GTK_DEBUG_SIZE_REQUEST},
-  {"no-css-cache", GTK_DEBUG_NO_CSS_CACHE}
+  {"no-css-cache", GTK_DEBUG_NO_CSS_CACHE},
+  {"css-sections", GTK_DEBUG_CSS_SECTIONS},
+  {"memory", GTK_DEBUG_MEMORY}
 };
 #endif /* G_ENABLE_DEBUG */
 
@@ -810,14 +831,65 @@ gettext_initialization (void)
 #endif  
 }
 
+void
+_gtk_counter_add (GtkCounter counter,
+                  gint64     delta)
+{
+  counters[counter] += delta;
+
+  if (G_UNLIKELY (counter_ids[counter] != 0))
+    gdk_profiler_set_int_counter_libgtk_only (counter_ids[counter],
+                                              g_get_monotonic_time () * 1000,
+                                              counters[counter]);
+}
+
+void
+_gtk_counters_dump (void)
+{
+  int i;
+
+  for (i = 0; i < GTK_N_COUNTERS; i++)
+    g_message ("%s: %" G_GINT64_FORMAT, counter_info[i].name, counters[i]);
+}
+
+#ifdef G_OS_UNIX
+static gboolean
+dump_counters_cb (gpointer data)
+{
+  _gtk_counters_dump ();
+
+  return G_SOURCE_CONTINUE;
+}
+#endif
+
+static void
+counters_initialization (void)
+{
+  int i;
+
+  /* Returns 0 unless the profiler is capturing */
+  for (i = 0; i < GTK_N_COUNTERS; i++)
+    counter_ids[i] = gdk_profiler_define_int_counter_libgtk_only (counter_info[i].name,
+                                                                  counter_info[i].description);
+
+#ifdef G_OS_UNIX
+  if (debug_flags & GTK_DEBUG_MEMORY)
+    g_unix_signal_add (SIGUSR1, dump_counters_cb, NULL);
+#endif
+}
+
 static void
 do_post_parse_initialization (int    *argc,
                               char ***argv)
 {
+  gint64 begin;
+
   if (gtk_initialized)
     return;
 
+  begin = gdk_profiler_begin_mark_libgtk_only ();
   gettext_initialization ();
+  gdk_profiler_end_mark_libgtk_only (begin, "gtk-init", "gettext");
 
 #ifdef SIGPIPE
   signal (SIGPIPE, SIG_IGN);
@@ -835,17 +907,24 @@ do_post_parse_initialization (int    *argc,
   if (debug_flags & GTK_DEBUG_UPDATES)
     gdk_window_set_debug_updates (TRUE);
 
+  counters_initialization ();
+
   gtk_widget_set_default_direction (gtk_get_locale_direction ());
 
+  begin = gdk_profiler_begin_mark_libgtk_only ();
   _gtk_ensure_resources ();
+  gdk_profiler_end_mark_libgtk_only (begin, "gtk-init", "resources");
 
+  begin = gdk_profiler_begin_mark_libgtk_only ();
   _gtk_accel_map_init ();
+  gdk_profiler_end_mark_libgtk_only (begin, "gtk-init", "accel-map");
 
   /* Set the 'initialized' flag.
    */
   gtk_initialized = TRUE;
 
   /* load gtk modules */
+  begin = gdk_profiler_begin_mark_libgtk_only ();
   if (gtk_modules_string)
     {
       _gtk_modules_init (argc, argv, gtk_modules_string->str);
@@ -855,8 +934,11 @@ do_post_parse_initialization (int    *argc,
     {
       _gtk_modules_init (argc, argv, NULL);
     }
+  gdk_profiler_end_mark_libgtk_only (begin, "gtk-init", "modules");
 
+  begin = gdk_profiler_begin_mark_libgtk_only ();
   _gtk_accessibility_init ();
+  gdk_profiler_end_mark_libgtk_only (begin, "gtk-init", "accessibility");
 }
 
 
@@ -31,6 +31,8 @@ struct _GtkMenuTracker
   gpointer                  user_data;
 
   GtkMenuTrackerSection    *toplevel;
+
+  guint                     flush_id;
 };
 
 struct _GtkMenuTrackerSection
@@ -43,6 +45,12 @@ struct _GtkMenuTrackerSection
   guint       with_separators : 1;
   guint       has_separator   : 1;
   guint       is_fake         : 1;
+  guint       pending         : 1;
+
+  /* The changes to the model not applied yet, merged into one */
+  gint        pending_position;
+  gint        pending_removed;
+  gint        pending_added;
 
   gulong      handler;
 };
@@ -88,6 +96,42 @@ gtk_menu_tracker_section_find_model (GtkMenuTrackerSection *section,
   return FALSE;
 }
 
+/* Like gtk_menu_tracker_section_find_model(), but finds the first
+ * section with changes that have not been applied yet.  Parents are
+ * found before their children.
+ */
+static GtkMenuTrackerSection *
+gtk_menu_tracker_section_find_pending (GtkMenuTrackerSection *section,
+                                       gint                  *offset)
+{
+  GSList *item;
+
+  if (section->has_separator)
+    (*offset)++;
+
+  if (section->pending)
+    return section;
+
+  for (item = section->items; item; item = item->next)
+    {
+      GtkMenuTrackerSection *subsection = item->data;
+
+      if (subsection)
+        {
+          GtkMenuTrackerSection *found_section;
+
+          found_section = gtk_menu_tracker_section_find_pending (subsection, offset);
+
+          if (found_section)
+            return found_section;
+        }
+      else
+        (*offset)++;
+    }
+
+  return NULL;
+}
+
 /* this is responsible for syncing the showing of a separator for a
  * single subsection (and its children).
  *
@@ -367,24 +411,17 @@ gtk_menu_tracker_add_items (GtkMenuTracker         *tracker,
 }
 
 static void
-gtk_menu_tracker_model_changed (GMenuModel *model,
-                                gint        position,
-                                gint        removed,
-                                gint        added,
-                                gpointer    user_data)
+gtk_menu_tracker_section_apply_change (GtkMenuTracker        *tracker,
+                                       GtkMenuTrackerSection *section,
+                                       gint                   offset,
+                                       gint                   position,
+                                       gint                   removed,
+                                       gint                   added)
 {
-  GtkMenuTracker *tracker = user_data;
-  GtkMenuTrackerSection *section;
   GSList **change_point;
-  gint offset = 0;
   gint i;
 
-  /* First find which section the changed model corresponds to, and the
-   * position of that section within the overall menu.
-   */
-  section = gtk_menu_tracker_section_find_model (tracker->toplevel, model, &offset);
-
-  /* Next, seek through that section to the change point.  This gives us
+  /* Seek through the section to the change point.  This gives us
    * the correct GSList** to make the change to and also finds the final
    * offset at which we will make the changes (by measuring the number
    * of items within each item of the section before the change point).
@@ -408,12 +445,84 @@ gtk_menu_tracker_model_changed (GMenuModel *model,
    * would do by appending.
    */
   gtk_menu_tracker_remove_items (tracker, change_point, offset, removed);
-  gtk_menu_tracker_add_items (tracker, section, change_point, offset, model, position, added);
+  gtk_menu_tracker_add_items (tracker, section, change_point, offset, section->model, position, added);
+}
+
+static gboolean
+gtk_menu_tracker_flush (gpointer user_data)
+{
+  GtkMenuTracker *tracker = user_data;
+  GtkMenuTrackerSection *section;
+  gint offset = 0;
+
+  tracker->flush_id = 0;
+
+  /* Applying the changes of a section can free its subsections, along
+   * with their pending changes, so always start over from the top.
+   */
+  while ((section = gtk_menu_tracker_section_find_pending (tracker->toplevel, &offset)))
+    {
+      section->pending = FALSE;
+      gtk_menu_tracker_section_apply_change (tracker, section, offset,
+                                             section->pending_position,
+                                             section->pending_removed,
+                                             section->pending_added);
+      offset = 0;
+    }
 
   /* The offsets for insertion/removal of separators will be all over
    * the place, however...
    */
   gtk_menu_tracker_section_sync_separators (tracker->toplevel, tracker, 0, FALSE, NULL, 0);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gtk_menu_tracker_model_changed (GMenuModel *model,
+                                gint        position,
+                                gint        removed,
+                                gint        added,
+                                gpointer    user_data)
+{
+  GtkMenuTracker *tracker = user_data;
+  GtkMenuTrackerSection *section;
+  gint offset = 0;
+
+  section = gtk_menu_tracker_section_find_model (tracker->toplevel, model, &offset);
+
+  /* Models are often changed one item at a time, for example when
+   * repopulating a list of recent files.  Instead of updating the menu
+   * for each of those changes, we merge all the changes to a section
+   * into one, and apply them together when the main loop is idle.  The
+   * items are read from the model at that time.
+   */
+  if (!section->pending)
+    {
+      section->pending = TRUE;
+      section->pending_position = position;
+      section->pending_removed = removed;
+      section->pending_added = added;
+    }
+  else
+    {
+      gint start, end, delta;
+
+      /* Find the range covering both changes in the current model.
+       * After the end of it, the current model is shifted by delta
+       * compared to the model before the pending changes.
+       */
+      start = MIN (section->pending_position, position);
+      end = MAX (section->pending_position + section->pending_added, position + removed);
+      delta = section->pending_added - section->pending_removed;
+
+      section->pending_position = start;
+      section->pending_removed = end - delta - start;
+      section->pending_added = end - removed + added - start;
+    }
+
+  if (tracker->flush_id == 0)
+    tracker->flush_id = g_idle_add_full (G_PRIORITY_HIGH_IDLE, gtk_menu_tracker_flush, tracker, NULL);
 }
 
 static void
@@ -476,7 +585,9 @@ gtk_menu_tracker_section_new (GtkMenuTracker *tracker,
  * when it creates the tracker.
  *
  * Future changes to @model will result in more calls to @insert_func
- * and @remove_func.
+ * and @remove_func.  Changes are collected and applied together from
+ * an idle handler, so that a series of changes to @model only updates
+ * the menu once.
  *
  * The position argument to both functions is the linear 0-based
  * position in the menu at which the item in question should be inserted
@@ -518,6 +629,7 @@ gtk_menu_tracker_new (GtkActionObservable      *observable,
   tracker->insert_func = insert_func;
   tracker->remove_func = remove_func;
   tracker->user_data = user_data;
+  tracker->flush_id = 0;
 
   tracker->toplevel = gtk_menu_tracker_section_new (tracker, model, with_separators, FALSE, 0, action_namespace);
   gtk_menu_tracker_section_sync_separators (tracker->toplevel, tracker, 0, FALSE, NULL, 0);
@@ -556,6 +668,8 @@ gtk_menu_tracker_new_for_item_submenu (GtkMenuTrackerItem       *item,
 void
 gtk_menu_tracker_free (GtkMenuTracker *tracker)
 {
+  if (tracker->flush_id)
+    g_source_remove (tracker->flush_id);
   gtk_menu_tracker_section_free (tracker->toplevel);
   g_object_unref (tracker->observable);
   g_slice_free (GtkMenuTracker, tracker);
@@ -473,7 +473,8 @@ static void gtk_notebook_draw_arrow          (GtkNotebook      *notebook,
 /*** GtkNotebook Size Allocate Functions ***/
 static void gtk_notebook_pages_allocate      (GtkNotebook      *notebook);
 static gboolean gtk_notebook_page_allocate   (GtkNotebook      *notebook,
-                                              GtkNotebookPage  *page);
+                                              GtkNotebookPage  *page,
+                                              gboolean          after_current);
 static void gtk_notebook_calc_tabs           (GtkNotebook      *notebook,
                                               GList            *start,
                                               GList           **end,
@@ -6420,6 +6421,7 @@ gtk_notebook_pages_allocate (GtkNotebook *notebook)
   gint tab_space, min, max, remaining_space;
   gint expanded_tabs;
   gboolean tab_allocations_changed = FALSE;
+  gboolean after_current;
 
   if (!priv->show_tabs || !priv->children || !priv->cur_page)
     return;
@@ -6447,11 +6449,18 @@ gtk_notebook_pages_allocate (GtkNotebook *notebook)
     }
 
   children = priv->children;
+  after_current = FALSE;
 
   while (children)
     {
-      if (gtk_notebook_page_allocate (notebook, GTK_NOTEBOOK_PAGE (children)))
+      GtkNotebookPage *page = GTK_NOTEBOOK_PAGE (children);
+
+      if (gtk_notebook_page_allocate (notebook, page, after_current))
         tab_allocations_changed = TRUE;
+
+      if (page == priv->cur_page)
+        after_current = TRUE;
+
       children = children->next;
     }
 
@@ -6462,9 +6471,14 @@ gtk_notebook_pages_allocate (GtkNotebook *notebook)
     gtk_notebook_redraw_tabs (notebook);
 }
 
+/* @after_current tells whether @page comes after the current page,
+ * which the caller knows from walking the page list; looking it up
+ * here would make allocating all tabs quadratic in their number.
+ */
 static gboolean
 gtk_notebook_page_allocate (GtkNotebook     *notebook,
-                            GtkNotebookPage *page)
+                            GtkNotebookPage *page,
+                            gboolean         after_current)
 {
   GtkWidget *widget = GTK_WIDGET (notebook);
   GtkNotebookPrivate *priv = notebook->priv;
@@ -6524,8 +6538,7 @@ gtk_notebook_page_allocate (GtkNotebook     *notebook,
            */
           if (page != priv->cur_page && tab_overlap > tab_curvature + MIN (tab_padding.left, tab_padding.right))
             {
-              if (gtk_notebook_page_num (notebook, page->child) >
-                  gtk_notebook_page_num (notebook, priv->cur_page->child))
+              if (after_current)
                 {
                   child_allocation.x += tab_overlap - tab_curvature - tab_padding.left;
                   child_allocation.width -= tab_overlap - tab_curvature - tab_padding.left;
@@ -6571,8 +6584,7 @@ gtk_notebook_page_allocate (GtkNotebook     *notebook,
            */
           if (page != priv->cur_page && tab_overlap > tab_curvature + MIN (tab_padding.top, tab_padding.bottom))
             {
-              if (gtk_notebook_page_num (notebook, page->child) >
-                  gtk_notebook_page_num (notebook, priv->cur_page->child))
+              if (after_current)
                 {
                   child_allocation.y += tab_overlap - tab_curvature - tab_padding.top;
                   child_allocation.height -= tab_overlap - tab_curvature - tab_padding.top;
@@ -19,30 +19,50 @@
 
 #include "gtkpixelcacheprivate.h"
 
+#include "gtkprivate.h"
+
 #define BLOW_CACHE_TIMEOUT_SEC 20
 
-/* The extra size of the offscreen surface we allocate
+/* The extra size around the view we render in advance
    to make scrolling more efficient */
 #define DEFAULT_EXTRA_SIZE 64
 
-/* When resizing viewport we allow this extra
-   size to avoid constantly reallocating when resizing */
-#define ALLOW_SMALLER_SIZE 32
-#define ALLOW_LARGER_SIZE 32
+/* The canvas is cached in square tiles of this size, so that
+   scrolling only needs to render the tiles that become visible */
+#define TILE_SIZE 256
+
+/* How much memory the tiles of all caches may use together
+   before the least recently used ones are thrown away */
+#define DEFAULT_MEMORY_BUDGET (32 * 1024 * 1024)
+
+/* Surfaces of freed tiles that are kept around to be reused,
+   possibly by the cache of a different window */
+#define MAX_SPARE_SURFACES 4
+
+typedef struct _GtkPixelCacheTile GtkPixelCacheTile;
+
+struct _GtkPixelCacheTile {
+  GtkPixelCache *cache;
+  GList link;      /* in tile_lru */
+
+  gint64 key;      /* position in tiles, see tile_key() */
+  int x;           /* position in canvas coordinates */
+  int y;
 
-struct _GtkPixelCache {
   cairo_surface_t *surface;
-  cairo_content_t content;
+  /* in tile coordinates, may be null if not dirty */
+  cairo_region_t *dirty;
 
-  /* Valid if surface != NULL */
-  int surface_x;
-  int surface_y;
-  int surface_w;
-  int surface_h;
-  double surface_scale;
+  guint serial;    /* draw_serial of the last draw using the tile */
+};
+
+struct _GtkPixelCache {
+  cairo_content_t content;
 
-  /* may be null if not dirty */
-  cairo_region_t *surface_dirty;
+  GHashTable *tiles;
+  /* Valid if there are tiles */
+  cairo_content_t tile_content;
+  int tile_scale;
 
   guint timeout_tag;
 
@@ -50,12 +70,189 @@ struct _GtkPixelCache {
   guint extra_height;
 };
 
+/* All tiles of all caches, most recently used first */
+static GQueue tile_lru = G_QUEUE_INIT;
+static GSList *spare_surfaces = NULL;
+static guint n_spare_surfaces = 0;
+static gsize tile_memory = 0;
+static gsize tile_memory_budget = DEFAULT_MEMORY_BUDGET;
+static guint draw_serial = 0;
+
+static gsize
+tile_memory_size (int scale)
+{
+  return (gsize) TILE_SIZE * TILE_SIZE * scale * scale * 4;
+}
+
+/* Rounds down, also for negative coordinates */
+static int
+tile_index (int coord)
+{
+  if (coord >= 0)
+    return coord / TILE_SIZE;
+  else
+    return - ((- coord + TILE_SIZE - 1) / TILE_SIZE);
+}
+
+static gint64
+tile_key (int x,
+          int y)
+{
+  return ((gint64) x << 32) | (guint32) y;
+}
+
+static void
+spare_surface_destroy (cairo_surface_t *surface)
+{
+  gsize size = tile_memory_size (GPOINTER_TO_INT (cairo_surface_get_user_data (surface, &tile_lru)));
+
+  tile_memory -= size;
+  _gtk_counter_add (GTK_COUNTER_PIXEL_CACHE_BYTES, - (gint64) size);
+  cairo_surface_destroy (surface);
+}
+
+static void
+gtk_pixel_cache_tile_free (GtkPixelCacheTile *tile)
+{
+  g_queue_unlink (&tile_lru, &tile->link);
+
+  if (n_spare_surfaces < MAX_SPARE_SURFACES)
+    {
+      spare_surfaces = g_slist_prepend (spare_surfaces, tile->surface);
+      n_spare_surfaces++;
+    }
+  else
+    spare_surface_destroy (tile->surface);
+
+  if (tile->dirty)
+    cairo_region_destroy (tile->dirty);
+
+  g_slice_free (GtkPixelCacheTile, tile);
+}
+
+/* Makes room for @needed more bytes, but never throws away
+   tiles that the current draw is using */
+static void
+gtk_pixel_cache_trim (gsize needed)
+{
+  while (tile_memory + needed > tile_memory_budget)
+    {
+      GtkPixelCacheTile *tile;
+      cairo_surface_t *surface;
+
+      if (spare_surfaces)
+        {
+          surface = spare_surfaces->data;
+          spare_surfaces = g_slist_delete_link (spare_surfaces, spare_surfaces);
+          n_spare_surfaces--;
+          spare_surface_destroy (surface);
+          continue;
+        }
+
+      if (tile_lru.tail == NULL)
+        break;
+
+      tile = tile_lru.tail->data;
+      if (tile->serial == draw_serial)
+        break;
+
+      g_hash_table_remove (tile->cache->tiles, &tile->key);
+    }
+}
+
+static cairo_surface_t *
+gtk_pixel_cache_get_tile_surface (GtkPixelCache *cache,
+                                  GdkWindow     *window)
+{
+  cairo_surface_t *surface;
+  GSList *l;
+
+  if (spare_surfaces)
+    {
+      /* Only reuse surfaces that are compatible with this window */
+      surface = gdk_window_create_similar_surface (window, cache->tile_content, 1, 1);
+
+      for (l = spare_surfaces; l; l = l->next)
+        {
+          cairo_surface_t *spare = l->data;
+
+          if (cairo_surface_get_type (spare) == cairo_surface_get_type (surface) &&
+              cairo_surface_get_device (spare) == cairo_surface_get_device (surface) &&
+              cairo_surface_get_content (spare) == cache->tile_content &&
+              GPOINTER_TO_INT (cairo_surface_get_user_data (spare, &tile_lru)) == cache->tile_scale)
+            {
+              spare_surfaces = g_slist_delete_link (spare_surfaces, l);
+              n_spare_surfaces--;
+              cairo_surface_destroy (surface);
+              return spare;
+            }
+        }
+
+      cairo_surface_destroy (surface);
+    }
+
+  gtk_pixel_cache_trim (tile_memory_size (cache->tile_scale));
+
+  surface = gdk_window_create_similar_surface (window, cache->tile_content,
+                                               TILE_SIZE, TILE_SIZE);
+  cairo_surface_set_user_data (surface, &tile_lru,
+                               GINT_TO_POINTER (cache->tile_scale), NULL);
+  tile_memory += tile_memory_size (cache->tile_scale);
+  _gtk_counter_add (GTK_COUNTER_PIXEL_CACHE_BYTES, tile_memory_size (cache->tile_scale));
+
+  return surface;
+}
+
+static GtkPixelCacheTile *
+gtk_pixel_cache_get_tile (GtkPixelCache *cache,
+                          GdkWindow     *window,
+                          int            x,
+                          int            y)
+{
+  cairo_rectangle_int_t r;
+  GtkPixelCacheTile *tile;
+  gint64 key;
+
+  key = tile_key (x, y);
+  tile = g_hash_table_lookup (cache->tiles, &key);
+  if (tile)
+    {
+      g_queue_unlink (&tile_lru, &tile->link);
+      g_queue_push_head_link (&tile_lru, &tile->link);
+    }
+  else
+    {
+      tile = g_slice_new0 (GtkPixelCacheTile);
+      tile->cache = cache;
+      tile->link.data = tile;
+      tile->key = key;
+      tile->x = x * TILE_SIZE;
+      tile->y = y * TILE_SIZE;
+      tile->surface = gtk_pixel_cache_get_tile_surface (cache, window);
+
+      r.x = 0;
+      r.y = 0;
+      r.width = TILE_SIZE;
+      r.height = TILE_SIZE;
+      tile->dirty = cairo_region_create_rectangle (&r);
+
+      g_hash_table_insert (cache->tiles, &tile->key, tile);
+      g_queue_push_head_link (&tile_lru, &tile->link);
+    }
+
+  tile->serial = draw_serial;
+
+  return tile;
+}
+
 GtkPixelCache *
 _gtk_pixel_cache_new ()
 {
   GtkPixelCache *cache;
 
   cache = g_new0 (GtkPixelCache, 1);
+  cache->tiles = g_hash_table_new_full (g_int64_hash, g_int64_equal,
+                                        NULL, (GDestroyNotify) gtk_pixel_cache_tile_free);
   cache->extra_width = DEFAULT_EXTRA_SIZE;
   cache->extra_height = DEFAULT_EXTRA_SIZE;
 
@@ -71,11 +268,7 @@ _gtk_pixel_cache_free (GtkPixelCache *cache)
   if (cache->timeout_tag)
     g_source_remove (cache->timeout_tag);
 
-  if (cache->surface != NULL)
-    cairo_surface_destroy (cache->surface);
-
-  if (cache->surface_dirty != NULL)
-    cairo_region_destroy (cache->surface_dirty);
+  g_hash_table_destroy (cache->tiles);
 
   g_free (cache);
 }
@@ -109,231 +302,101 @@ _gtk_pixel_cache_set_content (GtkPixelCache   *cache,
   _gtk_pixel_cache_invalidate (cache, NULL);
 }
 
+/* Limits the memory used by the tiles of all caches together.
+   Tiles that are visible are never thrown away, so the limit
+   may be exceeded while drawing huge views. */
+void
+_gtk_pixel_cache_set_memory_budget (gsize budget)
+{
+  tile_memory_budget = budget ? budget : DEFAULT_MEMORY_BUDGET;
+  gtk_pixel_cache_trim (0);
+}
+
 /* Region is in canvas coordinates */
 void
 _gtk_pixel_cache_invalidate (GtkPixelCache *cache,
 			     cairo_region_t *region)
 {
   cairo_rectangle_int_t r;
-  cairo_region_t *free_region = NULL;
+  cairo_region_t *tile_region;
+  GHashTableIter iter;
+  gpointer value;
 
-  if (cache->surface == NULL ||
-      (region != NULL && cairo_region_is_empty (region)))
+  if (region != NULL && cairo_region_is_empty (region))
     return;
 
-  if (region == NULL)
-    {
-      r.x = cache->surface_x;
-      r.y = cache->surface_y;
-      r.width = cache->surface_w;
-      r.height = cache->surface_h;
-
-      free_region = region =
-	cairo_region_create_rectangle (&r);
-    }
-
-  if (cache->surface_dirty == NULL)
-    {
-      cache->surface_dirty = cairo_region_copy (region);
-      cairo_region_translate (cache->surface_dirty,
-			      -cache->surface_x,
-			      -cache->surface_y);
-    }
-  else
+  g_hash_table_iter_init (&iter, cache->tiles);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
     {
-      cairo_region_translate (region,
-			      -cache->surface_x,
-			      -cache->surface_y);
-      cairo_region_union (cache->surface_dirty, region);
-      cairo_region_translate (region,
-			      cache->surface_x,
-			      cache->surface_y);
+      GtkPixelCacheTile *tile = value;
+
+      r.x = tile->x;
+      r.y = tile->y;
+      r.width = TILE_SIZE;
+      r.height = TILE_SIZE;
+
+      if (region == NULL)
+        tile_region = cairo_region_create_rectangle (&r);
+      else if (cairo_region_contains_rectangle (region, &r) == CAIRO_REGION_OVERLAP_OUT)
+        continue;
+      else
+        {
+          tile_region = cairo_region_copy (region);
+          cairo_region_intersect_rectangle (tile_region, &r);
+        }
+
+      cairo_region_translate (tile_region, -tile->x, -tile->y);
+
+      if (tile->dirty == NULL)
+        tile->dirty = tile_region;
+      else
+        {
+          cairo_region_union (tile->dirty, tile_region);
+          cairo_region_destroy (tile_region);
+        }
     }
-
-  if (free_region)
-    cairo_region_destroy (free_region);
-
-  r.x = 0;
-  r.y = 0;
-  r.width = cache->surface_w;
-  r.height = cache->surface_h;
-
-  cairo_region_intersect_rectangle (cache->surface_dirty, &r);
 }
 
-static void
-_gtk_pixel_cache_create_surface_if_needed (GtkPixelCache         *cache,
-					   GdkWindow             *window,
-					   cairo_rectangle_int_t *view_rect,
-					   cairo_rectangle_int_t *canvas_rect)
+static cairo_content_t
+gtk_pixel_cache_get_content (GtkPixelCache *cache,
+                             GdkWindow     *window)
 {
-  cairo_rectangle_int_t rect;
-  int surface_w, surface_h;
-  cairo_content_t content;
   cairo_pattern_t *bg;
   double red, green, blue, alpha;
 
-  content = cache->content;
-  if (!content)
-    {
-      content = CAIRO_CONTENT_COLOR_ALPHA;
-      bg = gdk_window_get_background_pattern (window);
-      if (bg != NULL &&
-          cairo_pattern_get_type (bg) == CAIRO_PATTERN_TYPE_SOLID &&
-          cairo_pattern_get_rgba (bg, &red, &green, &blue, &alpha) == CAIRO_STATUS_SUCCESS &&
-          alpha == 1.0)
-        content = CAIRO_CONTENT_COLOR;
-    }
+  if (cache->content)
+    return cache->content;
 
-  surface_w = view_rect->width;
-  if (canvas_rect->width > surface_w)
-    surface_w = MIN (surface_w + cache->extra_width, canvas_rect->width);
-
-  surface_h = view_rect->height;
-  if (canvas_rect->height > surface_h)
-    surface_h = MIN (surface_h + cache->extra_height, canvas_rect->height);
-
-  /* If current surface can't fit view_rect or is too large, kill it */
-  if (cache->surface != NULL &&
-      (cairo_surface_get_content (cache->surface) != content ||
-       cache->surface_w < MAX(view_rect->width, surface_w - ALLOW_SMALLER_SIZE) ||
-       cache->surface_w > surface_w + ALLOW_LARGER_SIZE ||
-       cache->surface_h < MAX(view_rect->height, surface_h - ALLOW_SMALLER_SIZE) ||
-       cache->surface_h > surface_h + ALLOW_LARGER_SIZE ||
-       cache->surface_scale != gdk_window_get_scale_factor (window)))
-    {
-      cairo_surface_destroy (cache->surface);
-      cache->surface = NULL;
-      if (cache->surface_dirty)
-	cairo_region_destroy (cache->surface_dirty);
-      cache->surface_dirty = NULL;
-    }
+  bg = gdk_window_get_background_pattern (window);
+  if (bg != NULL &&
+      cairo_pattern_get_type (bg) == CAIRO_PATTERN_TYPE_SOLID &&
+      cairo_pattern_get_rgba (bg, &red, &green, &blue, &alpha) == CAIRO_STATUS_SUCCESS &&
+      alpha == 1.0)
+    return CAIRO_CONTENT_COLOR;
 
-  /* Don't allocate a surface if view >= canvas, as we won't
-     be scrolling then anyway */
-  if (cache->surface == NULL &&
-      (view_rect->width < canvas_rect->width ||
-       view_rect->height < canvas_rect->height))
-    {
-      cache->surface_x = -canvas_rect->x;
-      cache->surface_y = -canvas_rect->y;
-      cache->surface_w = surface_w;
-      cache->surface_h = surface_h;
-      cache->surface_scale = gdk_window_get_scale_factor (window);
-
-      cache->surface =
-	gdk_window_create_similar_surface (window, content,
-					   surface_w, surface_h);
-      rect.x = 0;
-      rect.y = 0;
-      rect.width = surface_w;
-      rect.height = surface_h;
-      cache->surface_dirty =
-	cairo_region_create_rectangle (&rect);
-    }
+  return CAIRO_CONTENT_COLOR_ALPHA;
 }
 
-void
-_gtk_pixel_cache_set_position (GtkPixelCache         *cache,
-			       cairo_rectangle_int_t *view_rect,
-			       cairo_rectangle_int_t *canvas_rect)
+static void
+gtk_pixel_cache_repaint_tile (GtkPixelCacheTile     *tile,
+                              GtkPixelCacheDrawFunc  draw,
+                              cairo_rectangle_int_t *view_rect,
+                              cairo_rectangle_int_t *canvas_rect,
+                              gpointer               user_data)
 {
-  cairo_rectangle_int_t r, view_pos;
-  cairo_region_t *copy_region;
-  int new_surf_x, new_surf_y;
   cairo_t *backing_cr;
+  cairo_region_t *region_dirty = tile->dirty;
 
-  if (cache->surface == NULL)
-    return;
+  tile->dirty = NULL;
 
-  /* Position of view inside canvas */
-  view_pos.x = -canvas_rect->x;
-  view_pos.y = -canvas_rect->y;
-  view_pos.width = view_rect->width;
-  view_pos.height = view_rect->height;
-
-  /* Reposition so all is visible */
-  if (view_pos.x < cache->surface_x ||
-      view_pos.x + view_pos.width >
-      cache->surface_x + cache->surface_w ||
-      view_pos.y < cache->surface_y ||
-      view_pos.y + view_pos.height >
-      cache->surface_y + cache->surface_h)
+  if (!cairo_region_is_empty (region_dirty))
     {
-      new_surf_x = cache->surface_x;
-      if (view_pos.x < cache->surface_x)
-	new_surf_x = MAX (view_pos.x + view_pos.width - cache->surface_w, 0);
-      else if (view_pos.x + view_pos.width >
-	       cache->surface_x + cache->surface_w)
-	new_surf_x = MIN (view_pos.x, canvas_rect->width - cache->surface_w);
-
-      new_surf_y = cache->surface_y;
-      if (view_pos.y < cache->surface_y)
-	new_surf_y = MAX (view_pos.y + view_pos.height - cache->surface_h, 0);
-      else if (view_pos.y + view_pos.height >
-	       cache->surface_y + cache->surface_h)
-	new_surf_y = MIN (view_pos.y, canvas_rect->height - cache->surface_h);
-
-      r.x = 0;
-      r.y = 0;
-      r.width = cache->surface_w;
-      r.height = cache->surface_h;
-      copy_region = cairo_region_create_rectangle (&r);
-
-      if (cache->surface_dirty)
-	{
-	  cairo_region_subtract (copy_region, cache->surface_dirty);
-	  cairo_region_destroy (cache->surface_dirty);
-	  cache->surface_dirty = NULL;
-	}
-
-      cairo_region_translate (copy_region,
-			      cache->surface_x - new_surf_x,
-			      cache->surface_y - new_surf_y);
-      cairo_region_intersect_rectangle (copy_region, &r);
-
-      backing_cr = cairo_create (cache->surface);
-      gdk_cairo_region (backing_cr, copy_region);
-      cairo_set_operator (backing_cr, CAIRO_OPERATOR_SOURCE);
-      cairo_clip (backing_cr);
-      cairo_push_group (backing_cr);
-      cairo_set_source_surface (backing_cr, cache->surface,
-				cache->surface_x - new_surf_x,
-				cache->surface_y - new_surf_y);
-      cairo_paint (backing_cr);
-      cairo_pop_group_to_source (backing_cr);
-      cairo_paint (backing_cr);
-      cairo_destroy (backing_cr);
-
-      cache->surface_x = new_surf_x;
-      cache->surface_y = new_surf_y;
-
-      cairo_region_xor_rectangle (copy_region, &r);
-      cache->surface_dirty = copy_region;
-    }
-}
-
-void
-_gtk_pixel_cache_repaint (GtkPixelCache *cache,
-			  GtkPixelCacheDrawFunc draw,
-			  cairo_rectangle_int_t *view_rect,
-			  cairo_rectangle_int_t *canvas_rect,
-			  gpointer user_data)
-{
-  cairo_t *backing_cr;
-  cairo_region_t *region_dirty = cache->surface_dirty;
-  cache->surface_dirty = NULL;
-
-  if (cache->surface &&
-      region_dirty &&
-      !cairo_region_is_empty (region_dirty))
-    {
-      backing_cr = cairo_create (cache->surface);
+      backing_cr = cairo_create (tile->surface);
       gdk_cairo_region (backing_cr, region_dirty);
       cairo_clip (backing_cr);
       cairo_translate (backing_cr,
-		       -cache->surface_x - canvas_rect->x - view_rect->x,
-		       -cache->surface_y - canvas_rect->y - view_rect->y);
+		       -tile->x - canvas_rect->x - view_rect->x,
+		       -tile->y - canvas_rect->y - view_rect->y);
 
       cairo_save (backing_cr);
       cairo_set_source_rgba (backing_cr,
@@ -347,8 +410,32 @@ _gtk_pixel_cache_repaint (GtkPixelCache *cache,
       cairo_destroy (backing_cr);
     }
 
-  if (region_dirty)
-    cairo_region_destroy (region_dirty);
+  cairo_region_destroy (region_dirty);
+}
+
+/* Makes sure all tiles covering @area (in canvas coordinates)
+   exist and are up to date. Returns one of them. */
+static GtkPixelCacheTile *
+gtk_pixel_cache_update_tiles (GtkPixelCache         *cache,
+                              GdkWindow             *window,
+                              cairo_rectangle_int_t *area,
+                              cairo_rectangle_int_t *view_rect,
+                              cairo_rectangle_int_t *canvas_rect,
+                              GtkPixelCacheDrawFunc  draw,
+                              gpointer               user_data)
+{
+  GtkPixelCacheTile *tile = NULL;
+  int x, y;
+
+  for (y = tile_index (area->y); y * TILE_SIZE < area->y + area->height; y++)
+    for (x = tile_index (area->x); x * TILE_SIZE < area->x + area->width; x++)
+      {
+        tile = gtk_pixel_cache_get_tile (cache, window, x, y);
+        if (tile->dirty)
+          gtk_pixel_cache_repaint_tile (tile, draw, view_rect, canvas_rect, user_data);
+      }
+
+  return tile;
 }
 
 static gboolean
@@ -358,14 +445,7 @@ blow_cache_cb  (gpointer user_data)
 
   cache->timeout_tag = 0;
 
-  if (cache->surface)
-    {
-      cairo_surface_destroy (cache->surface);
-      cache->surface = NULL;
-      if (cache->surface_dirty)
-	cairo_region_destroy (cache->surface_dirty);
-      cache->surface_dirty = NULL;
-    }
+  g_hash_table_remove_all (cache->tiles);
 
   return G_SOURCE_REMOVE;
 }
@@ -395,28 +475,92 @@ _gtk_pixel_cache_draw (GtkPixelCache *cache,
 		       GtkPixelCacheDrawFunc draw,
 		       gpointer user_data)
 {
+  cairo_rectangle_int_t view_pos, area, canvas_area;
+  cairo_content_t content;
+  GtkPixelCacheTile *tile;
+  gboolean use_tiles;
+  int x, y, scale;
+
   if (cache->timeout_tag)
     g_source_remove (cache->timeout_tag);
 
   cache->timeout_tag = g_timeout_add_seconds (BLOW_CACHE_TIMEOUT_SEC,
 					      blow_cache_cb, cache);
 
-  _gtk_pixel_cache_create_surface_if_needed (cache, window,
-					     view_rect, canvas_rect);
-  _gtk_pixel_cache_set_position (cache, view_rect, canvas_rect);
-  _gtk_pixel_cache_repaint (cache, draw, view_rect, canvas_rect, user_data);
+  draw_serial++;
 
-  if (cache->surface && context_is_unscaled (cr) &&
-      /* Don't use backing surface if rendering elsewhere */
-      cairo_surface_get_type (cache->surface) == cairo_surface_get_type (cairo_get_target (cr)))
+  /* Don't cache anything if view >= canvas, as we won't
+     be scrolling then anyway */
+  use_tiles = (view_rect->width < canvas_rect->width ||
+               view_rect->height < canvas_rect->height) &&
+              context_is_unscaled (cr);
+
+  if (use_tiles)
+    {
+      content = gtk_pixel_cache_get_content (cache, window);
+      scale = gdk_window_get_scale_factor (window);
+      if (content != cache->tile_content || scale != cache->tile_scale)
+        {
+          g_hash_table_remove_all (cache->tiles);
+          cache->tile_content = content;
+          cache->tile_scale = scale;
+        }
+
+      /* Position of view inside canvas */
+      view_pos.x = -canvas_rect->x;
+      view_pos.y = -canvas_rect->y;
+      view_pos.width = view_rect->width;
+      view_pos.height = view_rect->height;
+
+      /* Only render ahead where there is something to scroll to */
+      canvas_area.x = 0;
+      canvas_area.y = 0;
+      canvas_area.width = canvas_rect->width;
+      canvas_area.height = canvas_rect->height;
+      gdk_rectangle_union (&canvas_area, &view_pos, &canvas_area);
+
+      area.x = view_pos.x - cache->extra_width / 2;
+      area.y = view_pos.y - cache->extra_height / 2;
+      area.width = view_pos.width + cache->extra_width;
+      area.height = view_pos.height + cache->extra_height;
+
+      tile = NULL;
+      if (gdk_rectangle_intersect (&area, &canvas_area, &area))
+        tile = gtk_pixel_cache_update_tiles (cache, window, &area,
+                                             view_rect, canvas_rect,
+                                             draw, user_data);
+
+      /* Don't use the tiles if rendering elsewhere */
+      use_tiles = tile != NULL &&
+                  cairo_surface_get_type (tile->surface) == cairo_surface_get_type (cairo_get_target (cr));
+    }
+
+  if (use_tiles)
     {
       cairo_save (cr);
-      cairo_set_source_surface (cr, cache->surface,
-				cache->surface_x + view_rect->x + canvas_rect->x,
-				cache->surface_y + view_rect->y + canvas_rect->y);
       cairo_rectangle (cr, view_rect->x, view_rect->y,
 		       view_rect->width, view_rect->height);
-      cairo_fill (cr);
+      cairo_clip (cr);
+
+      for (y = tile_index (view_pos.y); y * TILE_SIZE < view_pos.y + view_pos.height; y++)
+        for (x = tile_index (view_pos.x); x * TILE_SIZE < view_pos.x + view_pos.width; x++)
+          {
+            gint64 key = tile_key (x, y);
+
+            tile = g_hash_table_lookup (cache->tiles, &key);
+            if (tile == NULL)
+              continue;
+
+            cairo_set_source_surface (cr, tile->surface,
+                                      tile->x + view_rect->x + canvas_rect->x,
+                                      tile->y + view_rect->y + canvas_rect->y);
+            cairo_rectangle (cr,
+                             tile->x + view_rect->x + canvas_rect->x,
+                             tile->y + view_rect->y + canvas_rect->y,
+                             TILE_SIZE, TILE_SIZE);
+            cairo_fill (cr);
+          }
+
       cairo_restore (cr);
     }
   else
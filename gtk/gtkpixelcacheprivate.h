@@ -49,6 +49,7 @@ void           _gtk_pixel_cache_set_extra_size (GtkPixelCache         *cache,
                                                 guint                  extra_height);
 void           _gtk_pixel_cache_set_content    (GtkPixelCache         *cache,
                                                 cairo_content_t        content);
+void           _gtk_pixel_cache_set_memory_budget (gsize               budget);
 
 
 G_END_DECLS
@@ -145,6 +145,15 @@ struct _GtkPlacesSidebar {
 	gboolean devices_header_added;
 	gboolean bookmarks_header_added;
 
+	/* rows being collected by update_places() */
+	GPtrArray *new_rows;
+	guint update_places_id;
+
+	/* file infos of bookmarks and shortcuts, queried asynchronously */
+	GHashTable *file_infos;
+	GHashTable *pending_file_infos;
+	GCancellable *file_info_cancellable;
+
 	/* DnD */
 	GList     *drag_list; /* list of GFile */
 	gboolean  drag_data_received;
@@ -427,23 +436,51 @@ get_icon_size (GtkPlacesSidebar *sidebar)
 		return 16;
 }
 
-static GtkTreeIter
+/* A row of the model, as collected by update_places() before
+ * it is merged into the store
+ */
+typedef struct {
+	PlaceType place_type;
+	SectionType section_type;
+	char *name;
+	GIcon *icon;
+	char *uri;
+	GDrive *drive;
+	GVolume *volume;
+	GMount *mount;
+	int index;
+	char *tooltip;
+	char *heading_text;
+	gboolean show_eject_button;
+} PlaceRow;
+
+static void
+place_row_free (PlaceRow *row)
+{
+	g_free (row->name);
+	g_clear_object (&row->icon);
+	g_free (row->uri);
+	g_clear_object (&row->drive);
+	g_clear_object (&row->volume);
+	g_clear_object (&row->mount);
+	g_free (row->tooltip);
+	g_free (row->heading_text);
+	g_slice_free (PlaceRow, row);
+}
+
+static void
 add_heading (GtkPlacesSidebar *sidebar,
 	     SectionType section_type,
 	     const gchar *title)
 {
-	GtkTreeIter iter;
+	PlaceRow *row;
 
-	gtk_list_store_append (sidebar->store, &iter);
-	gtk_list_store_set (sidebar->store, &iter,
-			    PLACES_SIDEBAR_COLUMN_ROW_TYPE, PLACES_HEADING,
-			    PLACES_SIDEBAR_COLUMN_SECTION_TYPE, section_type,
-			    PLACES_SIDEBAR_COLUMN_HEADING_TEXT, title,
-			    PLACES_SIDEBAR_COLUMN_EJECT, FALSE,
-			    PLACES_SIDEBAR_COLUMN_NO_EJECT, TRUE,
-			    -1);
+	row = g_slice_new0 (PlaceRow);
+	row->place_type = PLACES_HEADING;
+	row->section_type = section_type;
+	row->heading_text = g_strdup (title);
 
-	return iter;
+	g_ptr_array_add (sidebar->new_rows, row);
 }
 
 static void
@@ -485,7 +522,7 @@ add_place (GtkPlacesSidebar *sidebar,
 	   const int index,
 	   const char *tooltip)
 {
-	GtkTreeIter           iter;
+	PlaceRow *row;
 	gboolean show_eject, show_unmount;
 	gboolean show_eject_button;
 
@@ -504,24 +541,240 @@ add_place (GtkPlacesSidebar *sidebar,
 		show_eject_button = (show_unmount || show_eject);
 	}
 
-	gtk_list_store_append (sidebar->store, &iter);
-	gtk_list_store_set (sidebar->store, &iter,
-			    PLACES_SIDEBAR_COLUMN_GICON, icon,
-			    PLACES_SIDEBAR_COLUMN_NAME, name,
-			    PLACES_SIDEBAR_COLUMN_URI, uri,
-			    PLACES_SIDEBAR_COLUMN_DRIVE, drive,
-			    PLACES_SIDEBAR_COLUMN_VOLUME, volume,
-			    PLACES_SIDEBAR_COLUMN_MOUNT, mount,
-			    PLACES_SIDEBAR_COLUMN_ROW_TYPE, place_type,
-			    PLACES_SIDEBAR_COLUMN_INDEX, index,
-			    PLACES_SIDEBAR_COLUMN_EJECT, show_eject_button,
-			    PLACES_SIDEBAR_COLUMN_NO_EJECT, !show_eject_button,
-			    PLACES_SIDEBAR_COLUMN_BOOKMARK, place_type != PLACES_BOOKMARK,
-			    PLACES_SIDEBAR_COLUMN_TOOLTIP, tooltip,
-			    PLACES_SIDEBAR_COLUMN_SECTION_TYPE, section_type,
+	row = g_slice_new0 (PlaceRow);
+	row->place_type = place_type;
+	row->section_type = section_type;
+	row->name = g_strdup (name);
+	row->icon = icon ? g_object_ref (icon) : NULL;
+	row->uri = g_strdup (uri);
+	row->drive = drive ? g_object_ref (drive) : NULL;
+	row->volume = volume ? g_object_ref (volume) : NULL;
+	row->mount = mount ? g_object_ref (mount) : NULL;
+	row->index = index;
+	row->tooltip = g_strdup (tooltip);
+	row->show_eject_button = show_eject_button;
+
+	g_ptr_array_add (sidebar->new_rows, row);
+}
+
+static PlaceRow *
+get_place_row (GtkPlacesSidebar *sidebar,
+	       GtkTreeIter      *iter)
+{
+	PlaceRow *row;
+
+	row = g_slice_new0 (PlaceRow);
+	gtk_tree_model_get (GTK_TREE_MODEL (sidebar->store), iter,
+			    PLACES_SIDEBAR_COLUMN_ROW_TYPE, &row->place_type,
+			    PLACES_SIDEBAR_COLUMN_SECTION_TYPE, &row->section_type,
+			    PLACES_SIDEBAR_COLUMN_NAME, &row->name,
+			    PLACES_SIDEBAR_COLUMN_GICON, &row->icon,
+			    PLACES_SIDEBAR_COLUMN_URI, &row->uri,
+			    PLACES_SIDEBAR_COLUMN_DRIVE, &row->drive,
+			    PLACES_SIDEBAR_COLUMN_VOLUME, &row->volume,
+			    PLACES_SIDEBAR_COLUMN_MOUNT, &row->mount,
+			    PLACES_SIDEBAR_COLUMN_INDEX, &row->index,
+			    PLACES_SIDEBAR_COLUMN_TOOLTIP, &row->tooltip,
+			    PLACES_SIDEBAR_COLUMN_HEADING_TEXT, &row->heading_text,
+			    PLACES_SIDEBAR_COLUMN_EJECT, &row->show_eject_button,
+			    -1);
+
+	return row;
+}
+
+static void
+set_place_row (GtkPlacesSidebar *sidebar,
+	       GtkTreeIter      *iter,
+	       PlaceRow         *row)
+{
+	gtk_list_store_set (sidebar->store, iter,
+			    PLACES_SIDEBAR_COLUMN_GICON, row->icon,
+			    PLACES_SIDEBAR_COLUMN_NAME, row->name,
+			    PLACES_SIDEBAR_COLUMN_URI, row->uri,
+			    PLACES_SIDEBAR_COLUMN_DRIVE, row->drive,
+			    PLACES_SIDEBAR_COLUMN_VOLUME, row->volume,
+			    PLACES_SIDEBAR_COLUMN_MOUNT, row->mount,
+			    PLACES_SIDEBAR_COLUMN_ROW_TYPE, row->place_type,
+			    PLACES_SIDEBAR_COLUMN_INDEX, row->index,
+			    PLACES_SIDEBAR_COLUMN_EJECT, row->show_eject_button,
+			    PLACES_SIDEBAR_COLUMN_NO_EJECT, !row->show_eject_button,
+			    PLACES_SIDEBAR_COLUMN_BOOKMARK, row->place_type != PLACES_BOOKMARK &&
+							    row->place_type != PLACES_HEADING,
+			    PLACES_SIDEBAR_COLUMN_TOOLTIP, row->tooltip,
+			    PLACES_SIDEBAR_COLUMN_SECTION_TYPE, row->section_type,
+			    PLACES_SIDEBAR_COLUMN_HEADING_TEXT, row->heading_text,
 			    -1);
 }
 
+/* Whether two rows stand for the same place, so that the
+ * row in the store can be updated rather than replaced
+ */
+static gboolean
+place_row_same_place (PlaceRow *a,
+		      PlaceRow *b)
+{
+	return a->place_type == b->place_type &&
+	       a->section_type == b->section_type &&
+	       a->drive == b->drive &&
+	       a->volume == b->volume &&
+	       a->mount == b->mount &&
+	       g_strcmp0 (a->uri, b->uri) == 0 &&
+	       g_strcmp0 (a->heading_text, b->heading_text) == 0;
+}
+
+static gboolean
+place_row_equal (PlaceRow *a,
+		 PlaceRow *b)
+{
+	return place_row_same_place (a, b) &&
+	       a->index == b->index &&
+	       a->show_eject_button == b->show_eject_button &&
+	       g_strcmp0 (a->name, b->name) == 0 &&
+	       g_strcmp0 (a->tooltip, b->tooltip) == 0 &&
+	       (a->icon == b->icon ||
+		(a->icon != NULL && b->icon != NULL && g_icon_equal (a->icon, b->icon)));
+}
+
+/* Merges the rows collected by update_places() into the store,
+ * touching only the rows that changed. Rows for the same place
+ * are kept in the store, and so is the selection on them.
+ */
+static void
+merge_new_rows (GtkPlacesSidebar *sidebar)
+{
+	GtkTreeModel *model = GTK_TREE_MODEL (sidebar->store);
+	GPtrArray *old_rows;
+	GArray *old_iters;
+	GtkTreeIter iter;
+	guint i, j, k;
+
+	/* list store iters persist, so we can hold on to them */
+	old_rows = g_ptr_array_new_with_free_func ((GDestroyNotify) place_row_free);
+	old_iters = g_array_new (FALSE, FALSE, sizeof (GtkTreeIter));
+
+	if (gtk_tree_model_get_iter_first (model, &iter)) {
+		do {
+			g_ptr_array_add (old_rows, get_place_row (sidebar, &iter));
+			g_array_append_val (old_iters, iter);
+		} while (gtk_tree_model_iter_next (model, &iter));
+	}
+
+	j = 0;
+	for (i = 0; i < sidebar->new_rows->len; i++) {
+		PlaceRow *row = g_ptr_array_index (sidebar->new_rows, i);
+
+		for (k = j; k < old_rows->len; k++) {
+			if (place_row_same_place (g_ptr_array_index (old_rows, k), row))
+				break;
+		}
+
+		if (k < old_rows->len) {
+			/* rows in between went away or moved further down */
+			for (; j < k; j++)
+				gtk_list_store_remove (sidebar->store,
+						       &g_array_index (old_iters, GtkTreeIter, j));
+
+			if (!place_row_equal (g_ptr_array_index (old_rows, k), row))
+				set_place_row (sidebar, &g_array_index (old_iters, GtkTreeIter, k), row);
+			j++;
+		} else {
+			if (j < old_rows->len)
+				gtk_list_store_insert_before (sidebar->store, &iter,
+							      &g_array_index (old_iters, GtkTreeIter, j));
+			else
+				gtk_list_store_append (sidebar->store, &iter);
+			set_place_row (sidebar, &iter, row);
+		}
+	}
+
+	for (; j < old_rows->len; j++)
+		gtk_list_store_remove (sidebar->store,
+				       &g_array_index (old_iters, GtkTreeIter, j));
+
+	g_array_free (old_iters, TRUE);
+	g_ptr_array_unref (old_rows);
+}
+
+static void
+free_file_info (gpointer data)
+{
+	if (data)
+		g_object_unref (data);
+}
+
+static void
+file_info_query_cb (GObject      *source_object,
+		    GAsyncResult *res,
+		    gpointer      user_data);
+
+static void queue_update_places (GtkPlacesSidebar *sidebar);
+
+/* Returns the cached file info for @file, or %NULL if the query
+ * failed or is still running; in the latter case the places are
+ * updated again when it finishes.
+ */
+static GFileInfo *
+lookup_file_info (GtkPlacesSidebar *sidebar,
+		  GFile            *file)
+{
+	GFileInfo *info;
+	char *uri;
+
+	uri = g_file_get_uri (file);
+
+	if (g_hash_table_lookup_extended (sidebar->file_infos, uri, NULL, (gpointer *) &info)) {
+		g_free (uri);
+		return info;
+	}
+
+	if (g_hash_table_contains (sidebar->pending_file_infos, uri)) {
+		g_free (uri);
+		return NULL;
+	}
+
+	g_hash_table_add (sidebar->pending_file_infos, uri);
+
+	if (sidebar->file_info_cancellable == NULL)
+		sidebar->file_info_cancellable = g_cancellable_new ();
+
+	g_file_query_info_async (file,
+				 "standard::display-name,standard::icon,standard::symbolic-icon",
+				 G_FILE_QUERY_INFO_NONE,
+				 G_PRIORITY_DEFAULT,
+				 sidebar->file_info_cancellable,
+				 file_info_query_cb,
+				 sidebar);
+
+	return NULL;
+}
+
+static void
+file_info_query_cb (GObject      *source_object,
+		    GAsyncResult *res,
+		    gpointer      user_data)
+{
+	GtkPlacesSidebar *sidebar;
+	GFileInfo *info;
+	GError *error = NULL;
+	char *uri;
+
+	info = g_file_query_info_finish (G_FILE (source_object), res, &error);
+	if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		g_error_free (error);
+		return;
+	}
+	g_clear_error (&error);
+
+	sidebar = GTK_PLACES_SIDEBAR (user_data);
+
+	uri = g_file_get_uri (G_FILE (source_object));
+	g_hash_table_remove (sidebar->pending_file_infos, uri);
+	/* a failed query is remembered as NULL */
+	g_hash_table_insert (sidebar->file_infos, uri, info);
+
+	queue_update_places (sidebar);
+}
+
 static GIcon *
 special_directory_get_gicon (GUserDirectory directory)
 {
@@ -696,30 +949,23 @@ static gboolean
 file_is_shown (GtkPlacesSidebar *sidebar,
                GFile            *file)
 {
-  GtkTreeIter iter;
-  gchar *uri;
+  guint i;
 
-  if (!gtk_tree_model_get_iter_first (GTK_TREE_MODEL (sidebar->store), &iter))
-    return FALSE;
-
-  do
+  for (i = 0; i < sidebar->new_rows->len; i++)
     {
-      gtk_tree_model_get (GTK_TREE_MODEL (sidebar->store), &iter,
-                          PLACES_SIDEBAR_COLUMN_URI, &uri,
-                          -1);
-      if (uri)
+      PlaceRow *row = g_ptr_array_index (sidebar->new_rows, i);
+
+      if (row->uri)
         {
           GFile *other;
           gboolean found;
-          other = g_file_new_for_uri (uri);
-          g_free (uri);
+          other = g_file_new_for_uri (row->uri);
           found = g_file_equal (file, other);
           g_object_unref (other);
           if (found)
             return TRUE;
         }
     }
-  while (gtk_tree_model_iter_next (GTK_TREE_MODEL (sidebar->store), &iter));
 
   return FALSE;
 }
@@ -741,12 +987,8 @@ add_application_shortcuts (GtkPlacesSidebar *sidebar)
 		if (file_is_shown (sidebar, file))
 			continue;
 			
-		/* FIXME: we are getting file info synchronously.  We may want to do it async at some point. */
-		info = g_file_query_info (file,
-					  "standard::display-name,standard::icon",
-					  G_FILE_QUERY_INFO_NONE,
-					  NULL,
-					  NULL); /* NULL-GError */
+		/* the shortcut shows up once its info has been queried */
+		info = lookup_file_info (sidebar, file);
 
 		if (info) {
 			char *uri;
@@ -768,8 +1010,6 @@ add_application_shortcuts (GtkPlacesSidebar *sidebar)
 
 			g_free (uri);
 			g_free (tooltip);
-
-			g_object_unref (info);
 		}
 	}
 }
@@ -806,6 +1046,11 @@ update_places (GtkPlacesSidebar *sidebar)
 	char *tooltip;
 	GList *network_mounts, *network_volumes;
 
+	if (sidebar->update_places_id != 0) {
+		g_source_remove (sidebar->update_places_id);
+		sidebar->update_places_id = 0;
+	}
+
 	/* save original selection */
 	if (get_selected_iter (sidebar, &iter)) {
 		gtk_tree_model_get (GTK_TREE_MODEL (sidebar->store),
@@ -814,7 +1059,7 @@ update_places (GtkPlacesSidebar *sidebar)
 	} else
 		original_uri = NULL;
 
-	gtk_list_store_clear (sidebar->store);
+	sidebar->new_rows = g_ptr_array_new_with_free_func ((GDestroyNotify) place_row_free);
 
 	sidebar->devices_header_added = FALSE;
 	sidebar->bookmarks_header_added = FALSE;
@@ -1098,12 +1343,10 @@ update_places (GtkPlacesSidebar *sidebar)
       if (sidebar->local_only && !is_native)
         continue;
 
-      /* FIXME: we are getting file info synchronously.  We may want to do it async at some point. */
-      info = g_file_query_info (root,
-                                "standard::display-name,standard::icon",
-                                G_FILE_QUERY_INFO_NONE,
-                                NULL,
-                                NULL); /* NULL-GError */
+      /* until the info is known, the bookmark is shown with a
+       * fallback name and icon and updated later
+       */
+      info = lookup_file_info (sidebar, root);
 
       bookmark_name = _gtk_bookmarks_manager_get_bookmark_label (sidebar->bookmarks_manager, root);
       if (bookmark_name == NULL && info != NULL)
@@ -1119,7 +1362,7 @@ update_places (GtkPlacesSidebar *sidebar)
             }
         }
 
-      if (info)
+      if (info && g_file_info_get_symbolic_icon (info))
         icon = g_object_ref (g_file_info_get_symbolic_icon (info));
       else
         icon = g_themed_icon_new_with_default_fallbacks (is_native ? ICON_NAME_FOLDER : ICON_NAME_FOLDER_NETWORK);
@@ -1136,9 +1379,7 @@ update_places (GtkPlacesSidebar *sidebar)
       g_free (mount_uri);
       g_free (tooltip);
       g_free (bookmark_name);
-
-      if (info)
-        g_object_unref (info);
+      g_object_unref (icon);
     }
 
   g_slist_foreach (bookmarks, (GFunc) g_object_unref, NULL);
@@ -1221,8 +1462,16 @@ update_places (GtkPlacesSidebar *sidebar)
   g_list_free_full (network_volumes, g_object_unref);
   g_list_free_full (network_mounts, g_object_unref);
 
+	merge_new_rows (sidebar);
+	g_ptr_array_unref (sidebar->new_rows);
+	sidebar->new_rows = NULL;
+
+	/* restore original selection, if its row went away */
+	if (original_uri && get_selected_iter (sidebar, &iter)) {
+		g_free (original_uri);
+		original_uri = NULL;
+	}
 
-	/* restore original selection */
 	if (original_uri) {
 		GFile *restore;
 
@@ -1234,12 +1483,33 @@ update_places (GtkPlacesSidebar *sidebar)
 	}
 }
 
+static gboolean
+update_places_idle (gpointer data)
+{
+	GtkPlacesSidebar *sidebar = GTK_PLACES_SIDEBAR (data);
+
+	sidebar->update_places_id = 0;
+	update_places (sidebar);
+
+	return FALSE;
+}
+
+/* Plugging in a device emits a burst of volume monitor signals;
+ * handle them all with a single update.
+ */
+static void
+queue_update_places (GtkPlacesSidebar *sidebar)
+{
+	if (sidebar->update_places_id == 0)
+		sidebar->update_places_id = gdk_threads_add_idle (update_places_idle, sidebar);
+}
+
 static void
 mount_added_callback (GVolumeMonitor *volume_monitor,
 		      GMount *mount,
 		      GtkPlacesSidebar *sidebar)
 {
-	update_places (sidebar);
+	queue_update_places (sidebar);
 }
 
 static void
@@ -1247,7 +1517,7 @@ mount_removed_callback (GVolumeMonitor *volume_monitor,
 			GMount *mount,
 			GtkPlacesSidebar *sidebar)
 {
-	update_places (sidebar);
+	queue_update_places (sidebar);
 }
 
 static void
@@ -1255,7 +1525,7 @@ mount_changed_callback (GVolumeMonitor *volume_monitor,
 			GMount *mount,
 			GtkPlacesSidebar *sidebar)
 {
-	update_places (sidebar);
+	queue_update_places (sidebar);
 }
 
 static void
@@ -1263,7 +1533,7 @@ volume_added_callback (GVolumeMonitor *volume_monitor,
 		       GVolume *volume,
 		       GtkPlacesSidebar *sidebar)
 {
-	update_places (sidebar);
+	queue_update_places (sidebar);
 }
 
 static void
@@ -1271,7 +1541,7 @@ volume_removed_callback (GVolumeMonitor *volume_monitor,
 			 GVolume *volume,
 			 GtkPlacesSidebar *sidebar)
 {
-	update_places (sidebar);
+	queue_update_places (sidebar);
 }
 
 static void
@@ -1279,7 +1549,7 @@ volume_changed_callback (GVolumeMonitor *volume_monitor,
 			 GVolume *volume,
 			 GtkPlacesSidebar *sidebar)
 {
-	update_places (sidebar);
+	queue_update_places (sidebar);
 }
 
 static void
@@ -1287,7 +1557,7 @@ drive_disconnected_callback (GVolumeMonitor *volume_monitor,
 			     GDrive         *drive,
 			     GtkPlacesSidebar *sidebar)
 {
-	update_places (sidebar);
+	queue_update_places (sidebar);
 }
 
 static void
@@ -1295,7 +1565,7 @@ drive_connected_callback (GVolumeMonitor *volume_monitor,
 			  GDrive         *drive,
 			  GtkPlacesSidebar *sidebar)
 {
-	update_places (sidebar);
+	queue_update_places (sidebar);
 }
 
 static void
@@ -1303,7 +1573,7 @@ drive_changed_callback (GVolumeMonitor *volume_monitor,
 			GDrive         *drive,
 			GtkPlacesSidebar *sidebar)
 {
-	update_places (sidebar);
+	queue_update_places (sidebar);
 }
 
 static gboolean
@@ -3779,6 +4049,11 @@ gtk_places_sidebar_init (GtkPlacesSidebar *sidebar)
 
 	sidebar->shortcuts = NULL;
 
+	sidebar->file_infos = g_hash_table_new_full (g_str_hash, g_str_equal,
+						     g_free, free_file_info);
+	sidebar->pending_file_infos = g_hash_table_new_full (g_str_hash, g_str_equal,
+							     g_free, NULL);
+
 	gtk_widget_set_size_request (GTK_WIDGET (sidebar), 140, 280);
 
 	gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (sidebar),
@@ -4109,6 +4384,19 @@ gtk_places_sidebar_dispose (GObject *object)
 		g_clear_object (&sidebar->hostnamed_cancellable);
 	}
 
+	if (sidebar->update_places_id != 0) {
+		g_source_remove (sidebar->update_places_id);
+		sidebar->update_places_id = 0;
+	}
+
+	if (sidebar->file_info_cancellable != NULL) {
+		g_cancellable_cancel (sidebar->file_info_cancellable);
+		g_clear_object (&sidebar->file_info_cancellable);
+	}
+
+	g_clear_pointer (&sidebar->file_infos, g_hash_table_unref);
+	g_clear_pointer (&sidebar->pending_file_infos, g_hash_table_unref);
+
 	g_clear_object (&sidebar->hostnamed_proxy);
 	g_free (sidebar->hostname);
 	sidebar->hostname = NULL;
@@ -22,6 +22,7 @@
 #define __GTK_PRINT_OPERATION_PRIVATE_H__
 
 #include "gtkprintoperation.h"
+#include "gtkprintpreviewcacheprivate.h"
 
 G_BEGIN_DECLS
 
@@ -57,6 +58,7 @@ struct _GtkPrintOperationPrivate
   guint support_selection  : 1;
   guint has_selection      : 1;
   guint embed_page_setup   : 1;
+  guint concurrent_drawing : 1;
 
   GtkPageDrawingState      page_drawing_state;
 
@@ -64,6 +66,10 @@ struct _GtkPrintOperationPrivate
   guint show_progress_timeout_id;
 
   GtkPrintContext *print_context;
+
+  GtkPrintPreviewCache *preview_cache;
+  gpointer preview_render;       /* page being recorded for the cache */
+  GList *preview_prerenders;     /* pages being recorded in threads */
   
   GtkPrintPages print_pages;
   GtkPageRange *page_ranges;
@@ -143,19 +143,52 @@ enum
   PROP_EMBED_PAGE_SETUP,
   PROP_HAS_SELECTION,
   PROP_SUPPORT_SELECTION,
-  PROP_N_PAGES_TO_PRINT
+  PROP_N_PAGES_TO_PRINT,
+  PROP_CONCURRENT_DRAWING
 };
 
 static guint signals[LAST_SIGNAL] = { 0 };
 static int job_nr = 0;
 typedef struct _PrintPagesData PrintPagesData;
+typedef struct _PageRender PageRender;
+
+/* Maximum number of worker threads used for concurrent drawing */
+#define MAX_RENDER_THREADS 8
+
+/* How long the main loop blocks waiting for the next page to
+ * be drawn before it gives other sources a chance to run
+ */
+#define RENDER_WAIT_TIMEOUT (20 * G_TIME_SPAN_MILLISECOND)
+
+struct _PageRender
+{
+  gint page_nr;
+  gint page_position;
+  GtkPageSetup *page_setup;
+  GtkPrintContext *print_context;
+  cairo_surface_t *recording;
+  cairo_matrix_t device_matrix;
+  gboolean finished;
+};
 
 static void          preview_iface_init      (GtkPrintOperationPreviewIface *iface);
 static GtkPageSetup *create_page_setup       (GtkPrintOperation             *op);
 static void          common_render_page      (GtkPrintOperation             *op,
 					      gint                           page_nr);
+static void          common_render_page_full (GtkPrintOperation             *op,
+					      gint                           page_nr,
+					      GtkPageSetup                  *page_setup,
+					      PageRender                    *render);
 static void          increment_page_sequence (PrintPagesData *data);
 static void          prepare_data            (PrintPagesData *data);
+static void          finish_page_renders     (PrintPagesData *data);
+static PageRender   *page_render_new         (GtkPrintOperation             *op,
+					      gint                           page_nr,
+					      gint                           page_position,
+					      GtkPageSetup                  *page_setup);
+static void          finish_preview_render   (GtkPrintOperation             *op);
+static void          prerender_preview_page  (GtkPrintOperation             *op,
+					      gint                           page_nr);
 static void          clamp_page_ranges       (PrintPagesData *data);
 
 
@@ -203,6 +236,10 @@ gtk_print_operation_finalize (GObject *object)
   if (priv->print_context)
     g_object_unref (priv->print_context);
 
+  if (priv->preview_cache)
+    _gtk_print_preview_cache_free (priv->preview_cache);
+  g_list_free (priv->preview_prerenders);
+
   g_free (priv->export_filename);
   g_free (priv->job_name);
   g_free (priv->custom_tab_label);
@@ -246,6 +283,7 @@ gtk_print_operation_init (GtkPrintOperation *operation)
   priv->support_selection = FALSE;
   priv->has_selection = FALSE;
   priv->embed_page_setup = FALSE;
+  priv->concurrent_drawing = FALSE;
 
   priv->page_drawing_state = GTK_PAGE_DRAWING_STATE_READY;
 
@@ -262,15 +300,50 @@ gtk_print_operation_init (GtkPrintOperation *operation)
   priv->job_name = g_strdup_printf (_("%s job #%d"), appname, ++job_nr);
 }
 
+/* Memory budget for the rasterized pages of the preview cache */
+#define PREVIEW_CACHE_BUDGET (64 * 1024 * 1024)
+
 static void
 preview_iface_render_page (GtkPrintOperationPreview *preview,
 			   gint                      page_nr)
 {
-
   GtkPrintOperation *op;
+  GtkPrintOperationPrivate *priv;
+  GtkPageSetup *page_setup;
+  PageRender *render;
 
   op = GTK_PRINT_OPERATION (preview);
-  common_render_page (op, page_nr);
+  priv = op->priv;
+
+  if (priv->preview_cache == NULL)
+    priv->preview_cache = _gtk_print_preview_cache_new (PREVIEW_CACHE_BUDGET);
+
+  page_setup = create_page_setup (op);
+
+  g_signal_emit (op, signals[REQUEST_PAGE_SETUP], 0,
+		 priv->print_context, page_nr, page_setup);
+
+  if (_gtk_print_preview_cache_has_page (priv->preview_cache, page_nr))
+    common_render_page_full (op, page_nr, page_setup, NULL);
+  else
+    {
+      /* Draw the page into a recording for the cache; it is
+       * shown from there in finish_preview_render().
+       */
+      render = page_render_new (op, page_nr, priv->page_position, page_setup);
+
+      priv->preview_render = render;
+      priv->page_drawing_state = GTK_PAGE_DRAWING_STATE_DRAWING;
+
+      g_signal_emit (op, signals[DRAW_PAGE], 0,
+		     render->print_context, page_nr);
+
+      if (priv->page_drawing_state == GTK_PAGE_DRAWING_STATE_DRAWING)
+	gtk_print_operation_draw_page_finish (op);
+    }
+
+  prerender_preview_page (op, page_nr - 1);
+  prerender_preview_page (op, page_nr + 1);
 }
 
 static void
@@ -281,6 +354,14 @@ preview_iface_end_preview (GtkPrintOperationPreview *preview)
   
   op = GTK_PRINT_OPERATION (preview);
 
+  if (op->priv->preview_cache)
+    {
+      _gtk_print_preview_cache_free (op->priv->preview_cache);
+      op->priv->preview_cache = NULL;
+    }
+  g_list_free (op->priv->preview_prerenders);
+  op->priv->preview_prerenders = NULL;
+
   g_signal_emit (op, signals[END_PRINT], 0, op->priv->print_context);
 
   if (op->priv->rloop)
@@ -422,6 +503,9 @@ gtk_print_operation_set_property (GObject      *object,
     case PROP_EMBED_PAGE_SETUP:
       gtk_print_operation_set_embed_page_setup (op, g_value_get_boolean (value));
       break;
+    case PROP_CONCURRENT_DRAWING:
+      gtk_print_operation_set_concurrent_drawing (op, g_value_get_boolean (value));
+      break;
     case PROP_HAS_SELECTION:
       gtk_print_operation_set_has_selection (op, g_value_get_boolean (value));
       break;
@@ -490,6 +574,9 @@ gtk_print_operation_get_property (GObject    *object,
     case PROP_EMBED_PAGE_SETUP:
       g_value_set_boolean (value, priv->embed_page_setup);
       break;
+    case PROP_CONCURRENT_DRAWING:
+      g_value_set_boolean (value, priv->concurrent_drawing);
+      break;
     case PROP_HAS_SELECTION:
       g_value_set_boolean (value, priv->has_selection);
       break;
@@ -528,6 +615,13 @@ struct _PrintPagesData
   gboolean initialized;
   gboolean is_preview;
   gboolean done;
+
+  /* concurrent drawing */
+  GThreadPool *render_pool;
+  GQueue render_queue;
+  gint dispatch_position;
+  GMutex render_mutex;
+  GCond render_cond;
 };
 
 typedef struct
@@ -604,8 +698,11 @@ preview_print_idle (gpointer data)
         {
           increment_page_sequence (pop->pages_data);
 
+          /* Every page is drawn once into the preview file,
+           * so don't go through the preview cache
+           */
           if (!pop->pages_data->done)
-            gtk_print_operation_preview_render_page (pop->preview, pop->pages_data->page);
+            common_render_page (op, pop->pages_data->page);
           else
             done = priv->page_drawing_state == GTK_PAGE_DRAWING_STATE_READY;
         }
@@ -1429,6 +1526,26 @@ gtk_print_operation_class_init (GtkPrintOperationClass *class)
 						     G_MAXINT,
 						     -1,
 						     GTK_PARAM_READABLE));
+
+  /**
+   * GtkPrintOperation:concurrent-drawing:
+   *
+   * If %TRUE, the #GtkPrintOperation::draw-page signal is emitted from
+   * worker threads, so that several pages are drawn at the same time.
+   * Each page is drawn into its own #GtkPrintContext and the results
+   * are added to the print job in page order.
+   *
+   * See gtk_print_operation_set_concurrent_drawing().
+   *
+   * Since: 3.10
+   */
+  g_object_class_install_property (gobject_class,
+				   PROP_CONCURRENT_DRAWING,
+				   g_param_spec_boolean ("concurrent-drawing",
+							 P_("Concurrent Drawing"),
+							 P_("TRUE if pages may be drawn concurrently in worker threads"),
+							 FALSE,
+							 GTK_PARAM_READWRITE));
 }
 
 /**
@@ -2313,6 +2430,8 @@ print_pages_idle_done (gpointer user_data)
   if (data->progress)
     gtk_widget_destroy (data->progress);
 
+  finish_page_renders (data);
+
   if (priv->rloop && !data->is_preview) 
     g_main_loop_quit (priv->rloop);
 
@@ -2431,6 +2550,62 @@ gtk_print_operation_get_embed_page_setup (GtkPrintOperation *op)
   return op->priv->embed_page_setup;
 }
 
+/**
+ * gtk_print_operation_set_concurrent_drawing:
+ * @op: a #GtkPrintOperation
+ * @concurrent_drawing: %TRUE to draw pages in worker threads
+ *
+ * Sets whether pages are drawn concurrently. If @concurrent_drawing
+ * is %TRUE, the #GtkPrintOperation::draw-page signal is emitted from
+ * a pool of worker threads, and each emission gets its own
+ * #GtkPrintContext. The handler must therefore be thread-safe and
+ * must only use the cairo context and the page setup of the
+ * #GtkPrintContext it was given; it must not call GTK+ functions.
+ * The #GtkPrintOperation::request-page-setup signal is still emitted
+ * in the main thread, before the page is handed to a worker.
+ *
+ * Print previews always draw pages in the main thread, and
+ * gtk_print_operation_set_defer_drawing() must not be used in this
+ * mode.
+ *
+ * Since: 3.10
+ **/
+void
+gtk_print_operation_set_concurrent_drawing (GtkPrintOperation *op,
+                                            gboolean           concurrent_drawing)
+{
+  GtkPrintOperationPrivate *priv;
+
+  g_return_if_fail (GTK_IS_PRINT_OPERATION (op));
+
+  priv = op->priv;
+
+  concurrent_drawing = concurrent_drawing != FALSE;
+  if (priv->concurrent_drawing != concurrent_drawing)
+    {
+      priv->concurrent_drawing = concurrent_drawing;
+      g_object_notify (G_OBJECT (op), "concurrent-drawing");
+    }
+}
+
+/**
+ * gtk_print_operation_get_concurrent_drawing:
+ * @op: a #GtkPrintOperation
+ *
+ * Gets the value of #GtkPrintOperation:concurrent-drawing property.
+ *
+ * Returns: whether pages are drawn in worker threads
+ *
+ * Since: 3.10
+ */
+gboolean
+gtk_print_operation_get_concurrent_drawing (GtkPrintOperation *op)
+{
+  g_return_val_if_fail (GTK_IS_PRINT_OPERATION (op), FALSE);
+
+  return op->priv->concurrent_drawing;
+}
+
 /**
  * gtk_print_operation_draw_page_finish:
  * @op: a #GtkPrintOperation
@@ -2452,6 +2627,12 @@ gtk_print_operation_draw_page_finish (GtkPrintOperation *op)
   GtkPageSetup *page_setup;
   GtkPrintContext *print_context;
   cairo_t *cr;
+
+  if (priv->preview_render)
+    {
+      finish_preview_render (op);
+      return;
+    }
   
   print_context = priv->print_context;
   page_setup = gtk_print_context_get_page_setup (print_context);
@@ -2467,22 +2648,22 @@ gtk_print_operation_draw_page_finish (GtkPrintOperation *op)
   priv->page_drawing_state = GTK_PAGE_DRAWING_STATE_READY;
 }
 
+/* Sets up the print context for page_nr and either emits ::draw-page
+ * or, if the page was already drawn by a worker thread, replays its
+ * recording. Takes ownership of page_setup.
+ */
 static void
-common_render_page (GtkPrintOperation *op,
-		    gint               page_nr)
+common_render_page_full (GtkPrintOperation *op,
+			 gint               page_nr,
+			 GtkPageSetup      *page_setup,
+			 PageRender        *render)
 {
   GtkPrintOperationPrivate *priv = op->priv;
-  GtkPageSetup *page_setup;
   GtkPrintContext *print_context;
   cairo_t *cr;
 
   print_context = priv->print_context;
   
-  page_setup = create_page_setup (op);
-  
-  g_signal_emit (op, signals[REQUEST_PAGE_SETUP], 0, 
-		 print_context, page_nr, page_setup);
-  
   _gtk_print_context_set_page_setup (print_context, page_setup);
   
   priv->start_page (op, print_context, page_setup);
@@ -2686,13 +2867,334 @@ common_render_page (GtkPrintOperation *op,
   
   priv->page_drawing_state = GTK_PAGE_DRAWING_STATE_DRAWING;
 
-  g_signal_emit (op, signals[DRAW_PAGE], 0, 
-		 print_context, page_nr);
+  if (render)
+    {
+      /* The recording is in the device units of the worker's
+       * context, so undo the unit scaling before painting it.
+       */
+      cairo_transform (cr, &render->device_matrix);
+      cairo_set_source_surface (cr, render->recording, 0, 0);
+      cairo_paint (cr);
+    }
+  else if (priv->preview_cache &&
+	   _gtk_print_preview_cache_paint (priv->preview_cache, page_nr, cr))
+    {
+      _gtk_print_preview_cache_prefetch (priv->preview_cache, page_nr - 1, cr);
+      _gtk_print_preview_cache_prefetch (priv->preview_cache, page_nr + 1, cr);
+    }
+  else
+    g_signal_emit (op, signals[DRAW_PAGE], 0, 
+		   print_context, page_nr);
 
   if (priv->page_drawing_state == GTK_PAGE_DRAWING_STATE_DRAWING)
     gtk_print_operation_draw_page_finish (op);
 }
 
+static void
+common_render_page (GtkPrintOperation *op,
+		    gint               page_nr)
+{
+  GtkPageSetup *page_setup;
+
+  page_setup = create_page_setup (op);
+  
+  g_signal_emit (op, signals[REQUEST_PAGE_SETUP], 0, 
+		 op->priv->print_context, page_nr, page_setup);
+
+  common_render_page_full (op, page_nr, page_setup, NULL);
+}
+
+static void
+page_render_free (PageRender *render)
+{
+  if (render->page_setup)
+    g_object_unref (render->page_setup);
+  g_object_unref (render->print_context);
+  cairo_surface_destroy (render->recording);
+  g_slice_free (PageRender, render);
+}
+
+static void
+render_page_thread (gpointer data,
+		    gpointer user_data)
+{
+  PageRender *render = data;
+  PrintPagesData *pages_data = user_data;
+  GtkPrintOperation *op = pages_data->op;
+
+  if (!op->priv->cancelled)
+    g_signal_emit (op, signals[DRAW_PAGE], 0,
+		   render->print_context, render->page_nr);
+
+  cairo_surface_flush (render->recording);
+
+  g_mutex_lock (&pages_data->render_mutex);
+  render->finished = TRUE;
+  g_cond_broadcast (&pages_data->render_cond);
+  g_mutex_unlock (&pages_data->render_mutex);
+}
+
+/* Sets up a print context that records into a surface of its own,
+ * for drawing page_nr outside of the print context of op. Takes
+ * ownership of page_setup.
+ */
+static PageRender *
+page_render_new (GtkPrintOperation *op,
+		 gint               page_nr,
+		 gint               page_position,
+		 GtkPageSetup      *page_setup)
+{
+  GtkPrintOperationPrivate *priv = op->priv;
+  PageRender *render;
+  cairo_matrix_t matrix;
+  cairo_t *cr;
+  gdouble top, bottom, left, right;
+
+  render = g_slice_new0 (PageRender);
+  render->page_nr = page_nr;
+  render->page_position = page_position;
+  render->page_setup = page_setup;
+
+  render->recording = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA, NULL);
+  cr = cairo_create (render->recording);
+
+  render->print_context = _gtk_print_context_new (op);
+  gtk_print_context_set_cairo_context (render->print_context, cr,
+				       gtk_print_context_get_dpi_x (priv->print_context),
+				       gtk_print_context_get_dpi_y (priv->print_context));
+  cairo_destroy (cr);
+
+  if (gtk_print_context_get_hard_margins (priv->print_context,
+					  &top, &bottom, &left, &right))
+    _gtk_print_context_set_hard_margins (render->print_context,
+					 top, bottom, left, right);
+  _gtk_print_context_set_page_setup (render->print_context, render->page_setup);
+
+  cr = gtk_print_context_get_cairo_context (render->print_context);
+  cairo_get_matrix (cr, &matrix);
+  render->device_matrix = matrix;
+  cairo_matrix_invert (&render->device_matrix);
+
+  return render;
+}
+
+/* Hands out pages to the worker threads, keeping a bounded number
+ * of drawn but not yet printed pages around.
+ */
+static void
+dispatch_page_renders (PrintPagesData *data)
+{
+  GtkPrintOperationPrivate *priv = data->op->priv;
+  guint max_renders;
+
+  max_renders = 2 * g_thread_pool_get_max_threads (data->render_pool);
+
+  while (!data->done && !priv->cancelled &&
+         g_queue_get_length (&data->render_queue) < max_renders)
+    {
+      PageRender *render;
+      GtkPageSetup *page_setup;
+      gint page_position;
+
+      page_position = priv->page_position;
+      priv->page_position = data->dispatch_position;
+      increment_page_sequence (data);
+      data->dispatch_position = priv->page_position;
+      priv->page_position = page_position;
+
+      if (data->done)
+        break;
+
+      page_setup = create_page_setup (data->op);
+      g_signal_emit (data->op, signals[REQUEST_PAGE_SETUP], 0,
+		     priv->print_context, data->page, page_setup);
+
+      render = page_render_new (data->op, data->page,
+				data->dispatch_position, page_setup);
+      g_queue_push_tail (&data->render_queue, render);
+      g_thread_pool_push (data->render_pool, render, NULL);
+    }
+}
+
+static void
+finish_page_renders (PrintPagesData *data)
+{
+  if (data->render_pool == NULL)
+    return;
+
+  g_thread_pool_free (data->render_pool, TRUE, TRUE);
+  data->render_pool = NULL;
+
+  g_queue_foreach (&data->render_queue, (GFunc) page_render_free, NULL);
+  g_queue_clear (&data->render_queue);
+
+  g_mutex_clear (&data->render_mutex);
+  g_cond_clear (&data->render_cond);
+}
+
+static void
+finish_preview_render (GtkPrintOperation *op)
+{
+  GtkPrintOperationPrivate *priv = op->priv;
+  PageRender *render = priv->preview_render;
+  GtkPageSetup *page_setup;
+
+  priv->preview_render = NULL;
+
+  cairo_surface_flush (render->recording);
+
+  page_setup = render->page_setup;
+  render->page_setup = NULL;
+
+  if (priv->preview_cache)
+    {
+      _gtk_print_preview_cache_insert (priv->preview_cache, render->page_nr,
+				       render->recording, &render->device_matrix);
+      common_render_page_full (op, render->page_nr, page_setup, NULL);
+    }
+  else
+    common_render_page_full (op, render->page_nr, page_setup, render);
+
+  page_render_free (render);
+}
+
+static void
+prerender_thread (GTask        *task,
+		  gpointer      source_object,
+		  gpointer      task_data,
+		  GCancellable *cancellable)
+{
+  PageRender *render = task_data;
+
+  g_signal_emit (source_object, signals[DRAW_PAGE], 0,
+		 render->print_context, render->page_nr);
+
+  cairo_surface_flush (render->recording);
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+prerender_done (GObject      *source,
+		GAsyncResult *result,
+		gpointer      user_data)
+{
+  GtkPrintOperation *op = GTK_PRINT_OPERATION (source);
+  GtkPrintOperationPrivate *priv = op->priv;
+  PageRender *render;
+  GList *l;
+
+  render = g_task_get_task_data (G_TASK (result));
+
+  /* The list is cleared when the preview ends */
+  l = g_list_find (priv->preview_prerenders, render);
+  if (l == NULL)
+    return;
+
+  priv->preview_prerenders = g_list_delete_link (priv->preview_prerenders, l);
+
+  if (priv->preview_cache &&
+      !_gtk_print_preview_cache_has_page (priv->preview_cache, render->page_nr))
+    _gtk_print_preview_cache_insert (priv->preview_cache, render->page_nr,
+				     render->recording, &render->device_matrix);
+}
+
+/* Draws a neighbour of the page being previewed in a worker thread,
+ * so that paging to it is quick. This is only done if the application
+ * allowed concurrent drawing, since it emits ::draw-page in a thread.
+ */
+static void
+prerender_preview_page (GtkPrintOperation *op,
+			gint               page_nr)
+{
+  GtkPrintOperationPrivate *priv = op->priv;
+  GtkPageSetup *page_setup;
+  PageRender *render;
+  GTask *task;
+  GList *l;
+
+  if (!priv->concurrent_drawing || priv->preview_cache == NULL)
+    return;
+
+  if (page_nr < 0 || page_nr >= priv->nr_of_pages)
+    return;
+
+  if (_gtk_print_preview_cache_has_page (priv->preview_cache, page_nr))
+    return;
+
+  for (l = priv->preview_prerenders; l; l = l->next)
+    {
+      render = l->data;
+      if (render->page_nr == page_nr)
+	return;
+    }
+
+  page_setup = create_page_setup (op);
+  g_signal_emit (op, signals[REQUEST_PAGE_SETUP], 0,
+		 priv->print_context, page_nr, page_setup);
+
+  render = page_render_new (op, page_nr, priv->page_position, page_setup);
+  priv->preview_prerenders = g_list_prepend (priv->preview_prerenders, render);
+
+  task = g_task_new (op, NULL, prerender_done, NULL);
+  g_task_set_task_data (task, render, (GDestroyNotify) page_render_free);
+  g_task_set_priority (task, G_PRIORITY_LOW);
+  g_task_run_in_thread (task, prerender_thread);
+  g_object_unref (task);
+}
+
+/* Prints the next page in sequence once its worker is done with it.
+ * Returns TRUE when all pages have been printed.
+ */
+static gboolean
+render_pages_concurrently (PrintPagesData *data)
+{
+  GtkPrintOperationPrivate *priv = data->op->priv;
+  PageRender *render;
+  gboolean finished;
+
+  if (data->render_pool == NULL)
+    {
+      g_mutex_init (&data->render_mutex);
+      g_cond_init (&data->render_cond);
+      g_queue_init (&data->render_queue);
+      data->dispatch_position = priv->page_position;
+      data->render_pool = g_thread_pool_new (render_page_thread, data,
+                                             CLAMP (g_get_num_processors (), 1, MAX_RENDER_THREADS),
+                                             FALSE, NULL);
+    }
+
+  dispatch_page_renders (data);
+
+  render = g_queue_peek_head (&data->render_queue);
+  if (render == NULL)
+    return data->done;
+
+  g_mutex_lock (&data->render_mutex);
+  if (!render->finished)
+    {
+      gint64 end_time = g_get_monotonic_time () + RENDER_WAIT_TIMEOUT;
+
+      while (!render->finished)
+        if (!g_cond_wait_until (&data->render_cond, &data->render_mutex, end_time))
+          break;
+    }
+  finished = render->finished;
+  g_mutex_unlock (&data->render_mutex);
+
+  if (!finished)
+    return FALSE;
+
+  g_queue_pop_head (&data->render_queue);
+
+  priv->page_position = render->page_position;
+  common_render_page_full (data->op, render->page_nr, render->page_setup, render);
+  render->page_setup = NULL;
+  page_render_free (render);
+
+  return FALSE;
+}
+
 static void
 prepare_data (PrintPagesData *data)
 {
@@ -2892,12 +3394,17 @@ print_pages_idle (gpointer user_data)
           goto out;
         }
 
-      increment_page_sequence (data);
-
-      if (!data->done)
-        common_render_page (data->op, data->page);
+      if (priv->concurrent_drawing && !data->is_preview)
+        done = render_pages_concurrently (data);
       else
-        done = priv->page_drawing_state == GTK_PAGE_DRAWING_STATE_READY;
+        {
+          increment_page_sequence (data);
+
+          if (!data->done)
+            common_render_page (data->op, data->page);
+          else
+            done = priv->page_drawing_state == GTK_PAGE_DRAWING_STATE_READY;
+        }
 
  out:
 
@@ -2911,6 +3418,7 @@ print_pages_idle (gpointer user_data)
 
       if (done && !data->is_preview)
         {
+          finish_page_renders (data);
           g_signal_emit (data->op, signals[END_PRINT], 0, priv->print_context);
           priv->end_run (data->op, priv->is_sync, priv->cancelled);
         }
@@ -277,6 +277,9 @@ void                    gtk_print_operation_set_embed_page_setup   (GtkPrintOper
                                                                     gboolean            embed);
 gboolean                gtk_print_operation_get_embed_page_setup   (GtkPrintOperation  *op);
 gint                    gtk_print_operation_get_n_pages_to_print   (GtkPrintOperation  *op);
+void                    gtk_print_operation_set_concurrent_drawing (GtkPrintOperation  *op,
+                                                                    gboolean            concurrent_drawing);
+gboolean                gtk_print_operation_get_concurrent_drawing (GtkPrintOperation  *op);
 
 GtkPageSetup           *gtk_print_run_page_setup_dialog            (GtkWindow          *parent,
                                                                     GtkPageSetup       *page_setup,
@@ -125,6 +125,12 @@ gtk_print_operation_preview_base_init (gpointer g_iface)
  * Note that this function requires a suitable cairo context to 
  * be associated with the print context. 
  *
+ * #GtkPrintOperation only emits #GtkPrintOperation::draw-page the
+ * first time a page is rendered; later calls for the same page
+ * replay what was drawn then, until the preview ends. If
+ * #GtkPrintOperation:concurrent-drawing is set, the pages next
+ * to @page_nr are also drawn ahead of time in a worker thread.
+ *
  * Since: 2.10 
  */
 void    
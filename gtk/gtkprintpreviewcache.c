@@ -0,0 +1,444 @@
+/* GTK - The GIMP Toolkit
+ * Copyright (C) 2013 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkprintpreviewcacheprivate.h"
+
+#include <gio/gio.h>
+#include <math.h>
+
+/* The preview cache keeps the pages of a print preview as recording
+ * surfaces, so that paging back and forth or zooming does not emit
+ * ::draw-page again. In addition, each page may have a raster image
+ * made at the scale it was last shown at; those are made in worker
+ * threads, for the page being shown and for its neighbours, and are
+ * what counts towards the memory budget.
+ */
+
+#define MAX_CACHED_PAGES 32
+#define MAX_RASTER_SIZE 8192
+
+typedef struct
+{
+  volatile gint ref_count;
+  gint page_nr;
+
+  /* Held while the recording is replayed, since raster threads
+   * replay it too
+   */
+  GMutex mutex;
+  cairo_surface_t *recording;
+  cairo_matrix_t device_matrix;
+  cairo_rectangle_t extents;
+
+  cairo_surface_t *raster;
+  gdouble raster_scale_x;
+  gdouble raster_scale_y;
+  gsize raster_size;
+
+  GCancellable *raster_cancellable;
+  gdouble pending_scale_x;
+  gdouble pending_scale_y;
+
+  GList link;
+} CachedPage;
+
+struct _GtkPrintPreviewCache
+{
+  GHashTable *pages;
+  GQueue lru;           /* most recently shown first */
+  gsize budget;
+  gsize size;
+};
+
+typedef struct
+{
+  CachedPage *page;
+  gdouble scale_x;
+  gdouble scale_y;
+} RasterJob;
+
+static CachedPage *
+cached_page_ref (CachedPage *page)
+{
+  g_atomic_int_inc (&page->ref_count);
+
+  return page;
+}
+
+static void
+cached_page_unref (CachedPage *page)
+{
+  if (!g_atomic_int_dec_and_test (&page->ref_count))
+    return;
+
+  g_mutex_clear (&page->mutex);
+  cairo_surface_destroy (page->recording);
+  if (page->raster)
+    cairo_surface_destroy (page->raster);
+  g_slice_free (CachedPage, page);
+}
+
+static void
+cached_page_cancel_raster (CachedPage *page)
+{
+  if (page->raster_cancellable)
+    {
+      g_cancellable_cancel (page->raster_cancellable);
+      g_object_unref (page->raster_cancellable);
+      page->raster_cancellable = NULL;
+    }
+}
+
+static void
+drop_raster (GtkPrintPreviewCache *cache,
+             CachedPage           *page)
+{
+  if (page->raster == NULL)
+    return;
+
+  cairo_surface_destroy (page->raster);
+  page->raster = NULL;
+  cache->size -= page->raster_size;
+  page->raster_size = 0;
+}
+
+static void
+remove_page (GtkPrintPreviewCache *cache,
+             CachedPage           *page)
+{
+  cached_page_cancel_raster (page);
+  drop_raster (cache, page);
+  g_queue_unlink (&cache->lru, &page->link);
+  g_hash_table_remove (cache->pages, GINT_TO_POINTER (page->page_nr));
+}
+
+static void
+evict (GtkPrintPreviewCache *cache)
+{
+  GList *l, *prev;
+
+  for (l = cache->lru.tail; l && cache->size > cache->budget; l = prev)
+    {
+      prev = l->prev;
+      drop_raster (cache, l->data);
+    }
+
+  while (g_queue_get_length (&cache->lru) > MAX_CACHED_PAGES)
+    remove_page (cache, cache->lru.tail->data);
+}
+
+static gboolean
+same_scale (gdouble a,
+            gdouble b)
+{
+  return fabs (a - b) < 1e-4 * MAX (fabs (a), fabs (b));
+}
+
+/* Rasters are only useful on surfaces that are rasterized anyway,
+ * and only when the page is not rotated or mirrored.
+ */
+static gboolean
+get_target_matrix (CachedPage     *page,
+                   cairo_t        *cr,
+                   cairo_matrix_t *matrix)
+{
+  cairo_matrix_t user_matrix;
+
+  switch ((int) cairo_surface_get_type (cairo_get_target (cr)))
+    {
+    case CAIRO_SURFACE_TYPE_IMAGE:
+    case CAIRO_SURFACE_TYPE_XLIB:
+    case CAIRO_SURFACE_TYPE_XCB:
+    case CAIRO_SURFACE_TYPE_WIN32:
+    case CAIRO_SURFACE_TYPE_QUARTZ:
+    case CAIRO_SURFACE_TYPE_QUARTZ_IMAGE:
+      break;
+    default:
+      return FALSE;
+    }
+
+  cairo_get_matrix (cr, &user_matrix);
+  cairo_matrix_multiply (matrix, &page->device_matrix, &user_matrix);
+
+  return matrix->xy == 0 && matrix->yx == 0 &&
+         matrix->xx > 0 && matrix->yy > 0;
+}
+
+static cairo_surface_t *
+rasterize (CachedPage *page,
+           gdouble     scale_x,
+           gdouble     scale_y)
+{
+  cairo_surface_t *surface;
+  cairo_t *cr;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                        ceil (page->extents.width * scale_x),
+                                        ceil (page->extents.height * scale_y));
+  cr = cairo_create (surface);
+  cairo_scale (cr, scale_x, scale_y);
+  cairo_translate (cr, - page->extents.x, - page->extents.y);
+  cairo_set_source_surface (cr, page->recording, 0, 0);
+  cairo_paint (cr);
+  cairo_destroy (cr);
+
+  return surface;
+}
+
+static void
+raster_job_free (RasterJob *job)
+{
+  cached_page_unref (job->page);
+  g_slice_free (RasterJob, job);
+}
+
+static void
+raster_thread (GTask        *task,
+               gpointer      source_object,
+               gpointer      task_data,
+               GCancellable *cancellable)
+{
+  RasterJob *job = task_data;
+  cairo_surface_t *surface;
+
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
+  g_mutex_lock (&job->page->mutex);
+  surface = rasterize (job->page, job->scale_x, job->scale_y);
+  g_mutex_unlock (&job->page->mutex);
+
+  g_task_return_pointer (task, surface, (GDestroyNotify) cairo_surface_destroy);
+}
+
+static void
+raster_done (GObject      *source,
+             GAsyncResult *result,
+             gpointer      user_data)
+{
+  GtkPrintPreviewCache *cache;
+  cairo_surface_t *surface;
+  CachedPage *page;
+  RasterJob *job;
+
+  /* The cache cancels all jobs before it goes away, so it is
+   * only safe to look at once we know this one wasn't cancelled.
+   */
+  surface = g_task_propagate_pointer (G_TASK (result), NULL);
+  if (surface == NULL)
+    return;
+
+  cache = user_data;
+  job = g_task_get_task_data (G_TASK (result));
+  page = job->page;
+
+  g_object_unref (page->raster_cancellable);
+  page->raster_cancellable = NULL;
+
+  drop_raster (cache, page);
+  page->raster = surface;
+  page->raster_scale_x = job->scale_x;
+  page->raster_scale_y = job->scale_y;
+  page->raster_size = cairo_image_surface_get_stride (surface) *
+                      cairo_image_surface_get_height (surface);
+  cache->size += page->raster_size;
+
+  evict (cache);
+}
+
+static void
+start_raster (GtkPrintPreviewCache *cache,
+              CachedPage           *page,
+              gdouble               scale_x,
+              gdouble               scale_y)
+{
+  RasterJob *job;
+  GTask *task;
+
+  if (page->raster &&
+      same_scale (page->raster_scale_x, scale_x) &&
+      same_scale (page->raster_scale_y, scale_y))
+    return;
+
+  if (page->raster_cancellable &&
+      same_scale (page->pending_scale_x, scale_x) &&
+      same_scale (page->pending_scale_y, scale_y))
+    return;
+
+  cached_page_cancel_raster (page);
+
+  if (page->extents.width <= 0 || page->extents.height <= 0 ||
+      page->extents.width * scale_x > MAX_RASTER_SIZE ||
+      page->extents.height * scale_y > MAX_RASTER_SIZE ||
+      page->extents.width * scale_x * page->extents.height * scale_y * 4 > cache->budget)
+    return;
+
+  job = g_slice_new (RasterJob);
+  job->page = cached_page_ref (page);
+  job->scale_x = scale_x;
+  job->scale_y = scale_y;
+
+  page->raster_cancellable = g_cancellable_new ();
+  page->pending_scale_x = scale_x;
+  page->pending_scale_y = scale_y;
+
+  task = g_task_new (NULL, page->raster_cancellable, raster_done, cache);
+  g_task_set_task_data (task, job, (GDestroyNotify) raster_job_free);
+  g_task_set_priority (task, G_PRIORITY_LOW);
+  g_task_run_in_thread (task, raster_thread);
+  g_object_unref (task);
+}
+
+GtkPrintPreviewCache *
+_gtk_print_preview_cache_new (gsize budget)
+{
+  GtkPrintPreviewCache *cache;
+
+  cache = g_slice_new0 (GtkPrintPreviewCache);
+  cache->pages = g_hash_table_new_full (NULL, NULL,
+                                        NULL, (GDestroyNotify) cached_page_unref);
+  g_queue_init (&cache->lru);
+  cache->budget = budget;
+
+  return cache;
+}
+
+void
+_gtk_print_preview_cache_free (GtkPrintPreviewCache *cache)
+{
+  GList *l;
+
+  for (l = cache->lru.head; l; l = l->next)
+    cached_page_cancel_raster (l->data);
+
+  g_hash_table_destroy (cache->pages);
+  g_slice_free (GtkPrintPreviewCache, cache);
+}
+
+gboolean
+_gtk_print_preview_cache_has_page (GtkPrintPreviewCache *cache,
+                                   gint                  page_nr)
+{
+  return g_hash_table_contains (cache->pages, GINT_TO_POINTER (page_nr));
+}
+
+/* Takes a reference on @recording. @device_matrix maps the device
+ * space of @recording to the user space pages are drawn in.
+ */
+void
+_gtk_print_preview_cache_insert (GtkPrintPreviewCache *cache,
+                                 gint                  page_nr,
+                                 cairo_surface_t      *recording,
+                                 const cairo_matrix_t *device_matrix)
+{
+  CachedPage *page;
+
+  page = g_hash_table_lookup (cache->pages, GINT_TO_POINTER (page_nr));
+  if (page)
+    remove_page (cache, page);
+
+  page = g_slice_new0 (CachedPage);
+  page->ref_count = 1;
+  page->page_nr = page_nr;
+  g_mutex_init (&page->mutex);
+  page->recording = cairo_surface_reference (recording);
+  page->device_matrix = *device_matrix;
+  page->link.data = page;
+
+  cairo_recording_surface_ink_extents (recording,
+                                       &page->extents.x, &page->extents.y,
+                                       &page->extents.width, &page->extents.height);
+
+  g_hash_table_insert (cache->pages, GINT_TO_POINTER (page_nr), page);
+  g_queue_push_head_link (&cache->lru, &page->link);
+
+  evict (cache);
+}
+
+/* Paints page @page_nr in the user space of @cr, using the raster
+ * if there is one at the right scale and the recording otherwise.
+ * Returns %FALSE if the page is not in the cache.
+ */
+gboolean
+_gtk_print_preview_cache_paint (GtkPrintPreviewCache *cache,
+                                gint                  page_nr,
+                                cairo_t              *cr)
+{
+  CachedPage *page;
+  cairo_matrix_t matrix;
+
+  page = g_hash_table_lookup (cache->pages, GINT_TO_POINTER (page_nr));
+  if (page == NULL)
+    return FALSE;
+
+  g_queue_unlink (&cache->lru, &page->link);
+  g_queue_push_head_link (&cache->lru, &page->link);
+
+  if (get_target_matrix (page, cr, &matrix))
+    {
+      if (page->raster &&
+          same_scale (page->raster_scale_x, matrix.xx) &&
+          same_scale (page->raster_scale_y, matrix.yy))
+        {
+          cairo_save (cr);
+          cairo_identity_matrix (cr);
+          cairo_set_source_surface (cr, page->raster,
+                                    floor (matrix.x0 + page->extents.x * matrix.xx + 0.5),
+                                    floor (matrix.y0 + page->extents.y * matrix.yy + 0.5));
+          cairo_paint (cr);
+          cairo_restore (cr);
+
+          return TRUE;
+        }
+
+      start_raster (cache, page, matrix.xx, matrix.yy);
+    }
+
+  /* This blocks if a raster thread is replaying the same
+   * page, which is fine; the raster is about to be ready.
+   */
+  g_mutex_lock (&page->mutex);
+  cairo_save (cr);
+  cairo_transform (cr, &page->device_matrix);
+  cairo_set_source_surface (cr, page->recording, 0, 0);
+  cairo_paint (cr);
+  cairo_restore (cr);
+  g_mutex_unlock (&page->mutex);
+
+  return TRUE;
+}
+
+/* Starts making a raster of page @page_nr, if it is in the cache,
+ * for painting it with the current transformation of @cr.
+ */
+void
+_gtk_print_preview_cache_prefetch (GtkPrintPreviewCache *cache,
+                                   gint                  page_nr,
+                                   cairo_t              *cr)
+{
+  CachedPage *page;
+  cairo_matrix_t matrix;
+
+  page = g_hash_table_lookup (cache->pages, GINT_TO_POINTER (page_nr));
+  if (page == NULL)
+    return;
+
+  if (get_target_matrix (page, cr, &matrix))
+    start_raster (cache, page, matrix.xx, matrix.yy);
+}
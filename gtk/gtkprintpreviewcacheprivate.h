@@ -0,0 +1,46 @@
+/* GTK - The GIMP Toolkit
+ * Copyright (C) 2013 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_PRINT_PREVIEW_CACHE_PRIVATE_H__
+#define __GTK_PRINT_PREVIEW_CACHE_PRIVATE_H__
+
+#include <cairo.h>
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GtkPrintPreviewCache GtkPrintPreviewCache;
+
+GtkPrintPreviewCache * _gtk_print_preview_cache_new      (gsize                 budget);
+void                   _gtk_print_preview_cache_free     (GtkPrintPreviewCache *cache);
+
+gboolean               _gtk_print_preview_cache_has_page (GtkPrintPreviewCache *cache,
+                                                          gint                  page_nr);
+void                   _gtk_print_preview_cache_insert   (GtkPrintPreviewCache *cache,
+                                                          gint                  page_nr,
+                                                          cairo_surface_t      *recording,
+                                                          const cairo_matrix_t *device_matrix);
+gboolean               _gtk_print_preview_cache_paint    (GtkPrintPreviewCache *cache,
+                                                          gint                  page_nr,
+                                                          cairo_t              *cr);
+void                   _gtk_print_preview_cache_prefetch (GtkPrintPreviewCache *cache,
+                                                          gint                  page_nr,
+                                                          cairo_t              *cr);
+
+G_END_DECLS
+
+#endif /* __GTK_PRINT_PREVIEW_CACHE_PRIVATE_H__ */
@@ -97,6 +97,22 @@ gboolean _gtk_single_string_accumulator   (GSignalInvocationHint *ihint,
 
 gboolean _gtk_button_event_triggers_context_menu (GdkEventButton *event);
 
+/* Live counts of internal objects and cache sizes, reported as profiler
+ * counters and dumped on SIGUSR1 with GTK_DEBUG=memory.
+ */
+typedef enum {
+  GTK_COUNTER_STYLE_CONTEXTS,
+  GTK_COUNTER_CSS_COMPUTED_VALUES,
+  GTK_COUNTER_CSS_VALUES,
+  GTK_COUNTER_RBTREE_NODES,
+  GTK_COUNTER_PIXEL_CACHE_BYTES,
+  GTK_N_COUNTERS
+} GtkCounter;
+
+void     _gtk_counter_add                        (GtkCounter      counter,
+                                                  gint64          delta);
+void     _gtk_counters_dump                      (void);
+
 gboolean _gtk_translate_keyboard_accel_state     (GdkKeymap       *keymap,
                                                   guint            hardware_keycode,
                                                   GdkModifierType  state,
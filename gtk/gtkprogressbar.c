@@ -127,6 +127,10 @@ static void     gtk_progress_bar_act_mode_leave   (GtkProgressBar *progress);
 static void     gtk_progress_bar_finalize         (GObject        *object);
 static void     gtk_progress_bar_set_orientation  (GtkProgressBar *progress,
                                                    GtkOrientation  orientation);
+static void     gtk_progress_bar_get_activity     (GtkProgressBar *progress,
+                                                   GtkOrientation  orientation,
+                                                   gint           *offset,
+                                                   gint           *amount);
 
 G_DEFINE_TYPE_WITH_CODE (GtkProgressBar, gtk_progress_bar, GTK_TYPE_WIDGET,
                          G_IMPLEMENT_INTERFACE (GTK_TYPE_ORIENTABLE, NULL))
@@ -581,8 +585,10 @@ tick_cb (GtkWidget     *widget,
 {
   GtkProgressBar *pbar = GTK_PROGRESS_BAR (widget);
   GtkProgressBarPrivate *priv = pbar->priv;
+  GtkAllocation allocation;
   gint64 frame2;
   gdouble fraction;
+  gint old_offset, old_amount, offset, amount, start, end;
 
   frame2 = gdk_frame_clock_get_frame_time (frame_clock);
   if (priv->frame1 == 0)
@@ -607,6 +613,8 @@ tick_cb (GtkWidget     *widget,
 
   priv->frame1 = frame2;
 
+  gtk_progress_bar_get_activity (pbar, priv->orientation, &old_offset, &old_amount);
+
   /* advance the block */
   if (priv->activity_dir == 0)
     {
@@ -627,7 +635,29 @@ tick_cb (GtkWidget     *widget,
         }
     }
 
-  gtk_widget_queue_draw (widget);
+  /* The text is drawn in a different color where the block covers
+   * it, so then all of it may need a redraw.
+   */
+  if (priv->show_text)
+    {
+      gtk_widget_queue_draw (widget);
+      return G_SOURCE_CONTINUE;
+    }
+
+  /* Otherwise only redraw the strip the block moved over */
+  gtk_progress_bar_get_activity (pbar, priv->orientation, &offset, &amount);
+  start = MIN (old_offset, offset);
+  end = MAX (old_offset + old_amount, offset + amount);
+
+  gtk_widget_get_allocation (widget, &allocation);
+  if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
+    gtk_widget_queue_draw_area (widget,
+                                allocation.x + start, allocation.y,
+                                end - start, allocation.height);
+  else
+    gtk_widget_queue_draw_area (widget,
+                                allocation.x, allocation.y + start,
+                                allocation.width, end - start);
 
   return G_SOURCE_CONTINUE;
 }
@@ -1074,7 +1104,13 @@ gtk_progress_bar_set_fraction (GtkProgressBar *pbar,
 
   priv = pbar->priv;
 
-  priv->fraction = CLAMP (fraction, 0.0, 1.0);
+  fraction = CLAMP (fraction, 0.0, 1.0);
+
+  /* Data feeds tend to set the same value over and over */
+  if (fraction == priv->fraction && !priv->activity_mode)
+    return;
+
+  priv->fraction = fraction;
   gtk_progress_bar_set_activity_mode (pbar, FALSE);
   gtk_widget_queue_draw (GTK_WIDGET (pbar));
 
@@ -115,6 +115,10 @@ struct _GtkRangePrivate
   gint  slide_initial_coordinate;
   gint  slider_start;                /* Slider range along the long dimension, in widget->window coords */
   gint  slider_end;
+  gint  trough_start;                /* Space the slider moves in, along the long dimension */
+  gint  trough_end;
+
+  gdouble layout_value;              /* Value the slider was last positioned for */
 
   /* Steppers are: < > ---- < >
    *               a b      c d
@@ -239,6 +243,9 @@ static void gtk_range_move_slider              (GtkRange         *range,
 static gboolean      gtk_range_scroll                   (GtkRange      *range,
                                                          GtkScrollType  scroll);
 static gboolean      gtk_range_update_mouse_location    (GtkRange      *range);
+static void          gtk_range_calc_slider_position     (GtkRange      *range,
+                                                         gdouble        adjustment_value);
+static void          gtk_range_calc_stepper_sensitivity (GtkRange      *range);
 static void          gtk_range_calc_layout              (GtkRange      *range,
 							 gdouble	adjustment_value);
 static void          gtk_range_calc_marks               (GtkRange      *range);
@@ -358,6 +365,8 @@ gtk_range_class_init (GtkRangeClass *class)
                   _gtk_marshal_VOID__DOUBLE,
                   G_TYPE_NONE, 1,
                   G_TYPE_DOUBLE);
+  g_signal_set_va_marshaller (signals[ADJUST_BOUNDS], G_TYPE_FROM_CLASS (gobject_class),
+                              _gtk_marshal_VOID__DOUBLEv);
   
   /**
    * GtkRange::move-slider:
@@ -901,6 +910,7 @@ gtk_range_set_flippable (GtkRange *range,
   if (flippable != priv->flippable)
     {
       priv->flippable = flippable;
+      priv->need_recalc = TRUE;
 
       gtk_widget_queue_draw (GTK_WIDGET (range));
     }
@@ -2621,7 +2631,6 @@ gtk_range_button_press (GtkWidget      *widget,
 	  /* recalc slider, so we can set slide_initial_slider_position
            * properly
            */
-	  priv->need_recalc = TRUE;
           gtk_range_calc_layout (range, new_value);
 
 	  /* defer adjustment updates to update_slider_position() in order
@@ -2914,6 +2923,9 @@ static void
 gtk_range_state_flags_changed (GtkWidget     *widget,
                                GtkStateFlags  previous_state)
 {
+  /* The trough margin is looked up for the current state */
+  GTK_RANGE (widget)->priv->need_recalc = TRUE;
+
   if (!gtk_widget_is_sensitive (widget))
     stop_scrolling (GTK_RANGE (widget));
 }
@@ -2926,11 +2938,11 @@ gtk_range_state_flags_changed (GtkWidget     *widget,
     if (rectangle1.height != rectangle2.height) return TRUE; \
   }
 
+/* Whether anything but the slider position changed */
 static gboolean
 layout_changed (GtkRangePrivate *priv1,
 		GtkRangePrivate *priv2)
 {
-  check_rectangle (priv1->slider, priv2->slider);
   check_rectangle (priv1->trough, priv2->trough);
   check_rectangle (priv1->stepper_a, priv2->stepper_a);
   check_rectangle (priv1->stepper_d, priv2->stepper_d);
@@ -2940,9 +2952,53 @@ layout_changed (GtkRangePrivate *priv1,
   if (priv1->upper_sensitive != priv2->upper_sensitive) return TRUE;
   if (priv1->lower_sensitive != priv2->lower_sensitive) return TRUE;
 
+  if (priv1->orientation == GTK_ORIENTATION_VERTICAL)
+    {
+      if (priv1->slider.height != priv2->slider.height) return TRUE;
+    }
+  else
+    {
+      if (priv1->slider.width != priv2->slider.width) return TRUE;
+    }
+
   return FALSE;
 }
 
+/* Queues a redraw of the part of the trough the slider moved
+ * through, across the whole range. This also covers the trough
+ * highlight of ranges with an origin, which ends below the slider.
+ */
+static void
+gtk_range_queue_draw_slider_move (GtkRange           *range,
+                                  const GdkRectangle *old_slider)
+{
+  GtkRangePrivate *priv = range->priv;
+  GtkWidget *widget = GTK_WIDGET (range);
+  GtkAllocation allocation;
+  GdkRectangle area;
+
+  gdk_rectangle_union (old_slider, &priv->slider, &area);
+
+  if (priv->orientation == GTK_ORIENTATION_VERTICAL)
+    {
+      area.x = priv->range_rect.x;
+      area.width = priv->range_rect.width;
+    }
+  else
+    {
+      area.y = priv->range_rect.y;
+      area.height = priv->range_rect.height;
+    }
+
+  gtk_widget_get_allocation (widget, &allocation);
+
+  gtk_widget_queue_draw_area (widget,
+                              allocation.x + area.x,
+                              allocation.y + area.y,
+                              area.width,
+                              area.height);
+}
+
 static void
 gtk_range_adjustment_changed (GtkAdjustment *adjustment,
 			      gpointer       data)
@@ -2976,7 +3032,6 @@ gtk_range_adjustment_value_changed (GtkAdjustment *adjustment,
   GtkRangePrivate *priv = range->priv;
   GtkRangePrivate priv_aux = *priv;
 
-  priv->need_recalc = TRUE;
   gtk_range_calc_layout (range, gtk_adjustment_get_value (priv->adjustment));
   
   /* now check whether the layout changed  */
@@ -2985,6 +3040,11 @@ gtk_range_adjustment_value_changed (GtkAdjustment *adjustment,
     {
       gtk_widget_queue_draw (GTK_WIDGET (range));
     }
+  else if (priv->slider.x != priv_aux.slider.x ||
+           priv->slider.y != priv_aux.slider.y)
+    {
+      gtk_range_queue_draw_slider_move (range, &priv_aux.slider);
+    }
 
   /* Note that we don't round off to priv->round_digits here.
    * that's because it's really broken to change a value
@@ -3562,8 +3622,20 @@ gtk_range_calc_layout (GtkRange *range,
   GtkStyleContext *context;
   GtkStateFlags state;
 
+  /* Everything but the slider position only depends on the
+   * allocation, the style and the adjustment bounds
+   */
   if (!priv->need_recalc)
-    return;
+    {
+      if (adjustment_value != priv->layout_value)
+        {
+          gtk_range_calc_slider_position (range, adjustment_value);
+          gtk_range_update_mouse_location (range);
+          gtk_range_calc_stepper_sensitivity (range);
+        }
+
+      return;
+    }
 
   /* If we have a too-small allocation, we prefer the steppers over
    * the trough/slider, probably the steppers are a more useful
@@ -3712,9 +3784,9 @@ gtk_range_calc_layout (GtkRange *range,
       priv->slider.x = priv->trough.x + focus_width + trough_border;
       priv->slider.width = priv->trough.width - (focus_width + trough_border) * 2;
 
-      /* Compute slider position/length */
+      /* Compute slider length */
       {
-        gint y, bottom, top, height;
+        gint bottom, top, height;
         
         top = priv->trough.y;
         bottom = priv->trough.y + priv->trough.height;
@@ -3740,24 +3812,10 @@ gtk_range_calc_layout (GtkRange *range,
           height = priv->min_slider_size;
 
         height = MIN (height, priv->trough.height);
-        
-        y = top;
 
-	if (gtk_adjustment_get_upper (priv->adjustment) - gtk_adjustment_get_lower (priv->adjustment) - gtk_adjustment_get_page_size (priv->adjustment) != 0)
-	  y += (bottom - top - height) * ((adjustment_value - gtk_adjustment_get_lower (priv->adjustment)) /
-					  (gtk_adjustment_get_upper (priv->adjustment) - gtk_adjustment_get_lower (priv->adjustment) - gtk_adjustment_get_page_size (priv->adjustment)));
-
-        y = CLAMP (y, top, bottom);
-        
-        if (should_invert (range))
-          y = bottom - (y - top + height);
-        
-        priv->slider.y = y;
         priv->slider.height = height;
-
-        /* These are publically exported */
-        priv->slider_start = priv->slider.y;
-        priv->slider_end = priv->slider.y + priv->slider.height;
+        priv->trough_start = top;
+        priv->trough_end = bottom;
       }
     }
   else
@@ -3860,9 +3918,9 @@ gtk_range_calc_layout (GtkRange *range,
       priv->slider.y = priv->trough.y + focus_width + trough_border;
       priv->slider.height = priv->trough.height - (focus_width + trough_border) * 2;
 
-      /* Compute slider position/length */
+      /* Compute slider length */
       {
-        gint x, left, right, width;
+        gint left, right, width;
         
         left = priv->trough.x;
         right = priv->trough.x + priv->trough.width;
@@ -3888,28 +3946,68 @@ gtk_range_calc_layout (GtkRange *range,
           width = priv->min_slider_size;
 
         width = MIN (width, priv->trough.width);
-        
-        x = left;
 
-	if (gtk_adjustment_get_upper (priv->adjustment) - gtk_adjustment_get_lower (priv->adjustment) - gtk_adjustment_get_page_size (priv->adjustment) != 0)
-          x += (right - left - width) * ((adjustment_value - gtk_adjustment_get_lower (priv->adjustment)) /
-                                         (gtk_adjustment_get_upper (priv->adjustment) - gtk_adjustment_get_lower (priv->adjustment) - gtk_adjustment_get_page_size (priv->adjustment)));
-        
-        x = CLAMP (x, left, right);
-        
-        if (should_invert (range))
-          x = right - (x - left + width);
-        
-        priv->slider.x = x;
         priv->slider.width = width;
-
-        /* These are publically exported */
-        priv->slider_start = priv->slider.x;
-        priv->slider_end = priv->slider.x + priv->slider.width;
+        priv->trough_start = left;
+        priv->trough_end = right;
       }
     }
-  
+
+  priv->need_recalc = FALSE;
+  priv->recalc_marks = TRUE;
+
+  gtk_range_calc_slider_position (range, adjustment_value);
   gtk_range_update_mouse_location (range);
+  gtk_range_calc_stepper_sensitivity (range);
+}
+
+/* Positions the slider along the trough computed by the last
+ * full layout
+ */
+static void
+gtk_range_calc_slider_position (GtkRange *range,
+                                gdouble   adjustment_value)
+{
+  GtkRangePrivate *priv = range->priv;
+  gdouble lower, upper, page_size;
+  gint pos, length;
+
+  lower = gtk_adjustment_get_lower (priv->adjustment);
+  upper = gtk_adjustment_get_upper (priv->adjustment);
+  page_size = gtk_adjustment_get_page_size (priv->adjustment);
+
+  if (priv->orientation == GTK_ORIENTATION_VERTICAL)
+    length = priv->slider.height;
+  else
+    length = priv->slider.width;
+
+  pos = priv->trough_start;
+
+  if (upper - lower - page_size != 0)
+    pos += (priv->trough_end - priv->trough_start - length) *
+           ((adjustment_value - lower) / (upper - lower - page_size));
+
+  pos = CLAMP (pos, priv->trough_start, priv->trough_end);
+
+  if (should_invert (range))
+    pos = priv->trough_end - (pos - priv->trough_start + length);
+
+  if (priv->orientation == GTK_ORIENTATION_VERTICAL)
+    priv->slider.y = pos;
+  else
+    priv->slider.x = pos;
+
+  /* These are publically exported */
+  priv->slider_start = pos;
+  priv->slider_end = pos + length;
+
+  priv->layout_value = adjustment_value;
+}
+
+static void
+gtk_range_calc_stepper_sensitivity (GtkRange *range)
+{
+  GtkRangePrivate *priv = range->priv;
 
   switch (priv->upper_sensitivity)
     {
@@ -3980,6 +4078,9 @@ gtk_range_calc_marks (GtkRange *range)
   GtkRangePrivate *priv = range->priv;
   gint i;
 
+  /* A full layout invalidates the mark positions */
+  gtk_range_calc_layout (range, gtk_adjustment_get_value (priv->adjustment));
+
   if (!priv->recalc_marks)
     return;
 
@@ -3987,7 +4088,6 @@ gtk_range_calc_marks (GtkRange *range)
 
   for (i = 0; i < priv->n_marks; i++)
     {
-      priv->need_recalc = TRUE;
       gtk_range_calc_layout (range, priv->marks[i]);
       if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
         priv->mark_pos[i] = priv->slider.x + priv->slider.width / 2;
@@ -3995,7 +4095,7 @@ gtk_range_calc_marks (GtkRange *range)
         priv->mark_pos[i] = priv->slider.y + priv->slider.height / 2;
     }
 
-  priv->need_recalc = TRUE;
+  gtk_range_calc_layout (range, gtk_adjustment_get_value (priv->adjustment));
 }
 
 static gboolean
@@ -4028,14 +4128,9 @@ gtk_range_real_change_value (GtkRange     *range,
       value = floor ((value * power) + 0.5) / power;
     }
 
+  /* The value-changed handler redraws what moved */
   if (gtk_adjustment_get_value (priv->adjustment) != value)
-    {
-      priv->need_recalc = TRUE;
-
-      gtk_widget_queue_draw (GTK_WIDGET (range));
-
-      gtk_adjustment_set_value (priv->adjustment, value);
-    }
+    gtk_adjustment_set_value (priv->adjustment, value);
   return FALSE;
 }
 
@@ -4215,4 +4310,5 @@ _gtk_range_set_steppers (GtkRange      *range,
   range->priv->has_stepper_b = has_b;
   range->priv->has_stepper_c = has_c;
   range->priv->has_stepper_d = has_d;
+  range->priv->need_recalc = TRUE;
 }
@@ -20,10 +20,12 @@
 #include "config.h"
 #include "gtkrbtree.h"
 #include "gtkdebug.h"
+#include "gtkprivate.h"
 
 static GtkRBNode * _gtk_rbnode_new                (GtkRBTree  *tree,
 						   gint        height);
-static void        _gtk_rbnode_free               (GtkRBNode  *node);
+static void        _gtk_rbnode_free               (GtkRBTree  *tree,
+                                                   GtkRBNode  *node);
 static void        _gtk_rbnode_rotate_left        (GtkRBTree  *tree,
 						   GtkRBNode  *node);
 static void        _gtk_rbnode_rotate_right       (GtkRBTree  *tree,
@@ -55,11 +57,74 @@ _gtk_rbtree_is_nil (GtkRBNode *node)
   return node == &nil;
 }
 
+/* The first chunk of a tree holds MIN_CHUNK_NODES nodes, every
+ * further one twice as many as the one before, up to MAX_CHUNK_NODES.
+ */
+#define MIN_CHUNK_NODES 16
+#define MAX_CHUNK_NODES 1024
+
+struct _GtkRBNodeChunk
+{
+  GtkRBNodeChunk *next;
+  guint n_nodes;
+  guint n_used;
+  GtkRBNode nodes[1];
+};
+
+static GtkRBNodeChunk *
+_gtk_rbtree_add_chunk (GtkRBTree *tree,
+                       guint      n_nodes)
+{
+  GtkRBNodeChunk *chunk;
+
+  chunk = g_malloc (G_STRUCT_OFFSET (GtkRBNodeChunk, nodes) + n_nodes * sizeof (GtkRBNode));
+  chunk->n_nodes = n_nodes;
+  chunk->n_used = 0;
+  chunk->next = tree->chunks;
+  tree->chunks = chunk;
+
+  _gtk_counter_add (GTK_COUNTER_RBTREE_NODES, n_nodes);
+
+  return chunk;
+}
+
+static void
+_gtk_rbtree_free_chunks (GtkRBTree *tree)
+{
+  GtkRBNodeChunk *chunk, *next;
+
+  for (chunk = tree->chunks; chunk; chunk = next)
+    {
+      next = chunk->next;
+      _gtk_counter_add (GTK_COUNTER_RBTREE_NODES, - (gint64) chunk->n_nodes);
+      g_free (chunk);
+    }
+
+  tree->chunks = NULL;
+  tree->free_nodes = NULL;
+}
+
 static GtkRBNode *
 _gtk_rbnode_new (GtkRBTree *tree,
 		 gint       height)
 {
-  GtkRBNode *node = g_slice_new (GtkRBNode);
+  GtkRBNodeChunk *chunk = tree->chunks;
+  GtkRBNode *node;
+
+  if (tree->free_nodes)
+    {
+      node = tree->free_nodes;
+      tree->free_nodes = node->parent;
+    }
+  else
+    {
+      if (chunk == NULL)
+        chunk = _gtk_rbtree_add_chunk (tree, MIN_CHUNK_NODES);
+      else if (chunk->n_used == chunk->n_nodes)
+        chunk = _gtk_rbtree_add_chunk (tree, MIN (2 * chunk->n_nodes, MAX_CHUNK_NODES));
+
+      node = &chunk->nodes[chunk->n_used++];
+    }
 
   node->left = (GtkRBNode *) &nil;
   node->right = (GtkRBNode *) &nil;
@@ -73,7 +138,8 @@ _gtk_rbnode_new (GtkRBTree *tree,
 }
 
 static void
-_gtk_rbnode_free (GtkRBNode *node)
+_gtk_rbnode_free (GtkRBTree *tree,
+                  GtkRBNode *node)
 {
 #ifdef G_ENABLE_DEBUG
   if (gtk_get_debug_flags () & GTK_DEBUG_TREE)
@@ -87,7 +153,8 @@ _gtk_rbnode_free (GtkRBNode *node)
       node->flags = 0;
     }
 #endif
-  g_slice_free (GtkRBNode, node);
+  node->parent = tree->free_nodes;
+  tree->free_nodes = node;
 }
 
 static void
@@ -334,6 +401,8 @@ _gtk_rbtree_new (void)
   retval = g_new (GtkRBTree, 1);
   retval->parent_tree = NULL;
   retval->parent_node = NULL;
+  retval->chunks = NULL;
+  retval->free_nodes = NULL;
 
   retval->root = (GtkRBNode *) &nil;
 
@@ -347,8 +416,6 @@ _gtk_rbtree_free_helper (GtkRBTree  *tree,
 {
   if (node->children)
     _gtk_rbtree_free (node->children);
-
-  _gtk_rbnode_free (node);
 }
 
 void
@@ -363,6 +430,7 @@ _gtk_rbtree_free (GtkRBTree *tree)
   if (tree->parent_node &&
       tree->parent_node->children == tree)
     tree->parent_node->children = NULL;
+  _gtk_rbtree_free_chunks (tree);
   g_free (tree);
 }
 
@@ -490,6 +558,89 @@ _gtk_rbtree_insert_after (GtkRBTree *tree,
   return node;
 }
 
+static GtkRBNode *
+_gtk_rbtree_fill_range (GtkRBTree *tree,
+                        GtkRBNode *parent,
+                        guint      n_nodes,
+                        guint      depth,
+                        guint      red_depth,
+                        gint       height,
+                        guint      flags)
+{
+  GtkRBNode *node;
+  guint n_left;
+
+  if (n_nodes == 0)
+    return (GtkRBNode *) &nil;
+
+  n_left = n_nodes / 2;
+
+  node = _gtk_rbnode_new (tree, height);
+  node->flags = (depth == red_depth ? GTK_RBNODE_RED : GTK_RBNODE_BLACK) | flags;
+  node->parent = parent;
+  node->left = _gtk_rbtree_fill_range (tree, node, n_left,
+                                       depth + 1, red_depth, height, flags);
+  node->right = _gtk_rbtree_fill_range (tree, node, n_nodes - n_left - 1,
+                                        depth + 1, red_depth, height, flags);
+  node->count = n_nodes;
+  node->total_count = n_nodes;
+  node->offset = n_nodes * height;
+
+  return node;
+}
+
+/*
+ * _gtk_rbtree_fill:
+ * @tree: an empty tree
+ * @n_nodes: the number of nodes to add
+ * @height: the height of every node
+ * @valid: whether the nodes are valid
+ *
+ * Fills @tree with @n_nodes nodes of the same height. This is the
+ * same as calling _gtk_rbtree_insert_after() @n_nodes times, but
+ * takes linear time: the tree is built balanced right away, so
+ * there is no rebalancing and no walking up to the root per node.
+ */
+void
+_gtk_rbtree_fill (GtkRBTree *tree,
+                  guint      n_nodes,
+                  gint       height,
+                  gboolean   valid)
+{
+  guint red_depth, flags;
+
+  g_return_if_fail (_gtk_rbtree_is_nil (tree->root));
+
+  if (n_nodes == 0)
+    return;
+
+  /* Splitting at the middle leaves all nil leaves within one level
+   * of each other; coloring the bottom level red, if it is not
+   * full, gives every path the same number of black nodes.
+   */
+  if ((n_nodes & (n_nodes + 1)) == 0)
+    red_depth = G_MAXUINT;
+  else
+    red_depth = g_bit_storage (n_nodes) - 1;
+
+  flags = valid ? 0 : GTK_RBNODE_INVALID | GTK_RBNODE_DESCENDANTS_INVALID;
+
+  /* Put all the nodes into one chunk, in the order they are created */
+  if (tree->free_nodes == NULL)
+    _gtk_rbtree_add_chunk (tree, n_nodes);
+
+  tree->root = _gtk_rbtree_fill_range (tree, (GtkRBNode *) &nil, n_nodes,
+                                       0, red_depth, height, flags);
+
+  gtk_rbnode_adjust (tree->parent_tree, tree->parent_node,
+                     0, n_nodes, n_nodes * height);
+
+#ifdef G_ENABLE_DEBUG  
+  if (gtk_get_debug_flags () & GTK_DEBUG_TREE)
+    _gtk_rbtree_test (G_STRLOC, tree);
+#endif
+}
+
 GtkRBNode *
 _gtk_rbtree_insert_before (GtkRBTree *tree,
 			   GtkRBNode *current,
@@ -740,31 +891,82 @@ _gtk_rbtree_mark_invalid (GtkRBTree *tree)
   while ((node = _gtk_rbtree_next (tree, node)) != NULL);
 }
 
+typedef struct {
+  gint height;
+  gboolean mark_valid;
+} FixedHeight;
+
+static void fixed_height_tree (GtkRBTree   *tree,
+                               FixedHeight *fixed);
+
+static void
+fixed_height_prepare (GtkRBTree *tree,
+                      GtkRBNode *node,
+                      gpointer   data)
+{
+  node->offset = GTK_RBNODE_GET_HEIGHT (node);
+}
+
+static void
+fixed_height_fixup (GtkRBTree *tree,
+                    GtkRBNode *node,
+                    gpointer   data)
+{
+  FixedHeight *fixed = data;
+
+  if (node->children)
+    fixed_height_tree (node->children, fixed);
+
+  if (GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_INVALID))
+    {
+      node->offset = fixed->height;
+      if (fixed->mark_valid)
+        {
+          GTK_RBNODE_UNSET_FLAG (node, GTK_RBNODE_INVALID);
+          GTK_RBNODE_UNSET_FLAG (node, GTK_RBNODE_COLUMN_INVALID);
+        }
+    }
+
+  node->offset += node->left->offset + node->right->offset;
+  if (node->children)
+    node->offset += node->children->root->offset;
+  _fixup_validation (tree, node);
+}
+
+/* Like reordering, this first reduces every offset to the node's own
+ * height and then sums them up again, so that the whole tree is
+ * updated in one pass instead of walking up to the root per node.
+ */
+static void
+fixed_height_tree (GtkRBTree   *tree,
+                   FixedHeight *fixed)
+{
+  if (_gtk_rbtree_is_nil (tree->root))
+    return;
+
+  _gtk_rbtree_traverse (tree, tree->root, G_PRE_ORDER, fixed_height_prepare, NULL);
+  _gtk_rbtree_traverse (tree, tree->root, G_POST_ORDER, fixed_height_fixup, fixed);
+}
+
 void
 _gtk_rbtree_set_fixed_height (GtkRBTree *tree,
 			      gint       height,
 			      gboolean   mark_valid)
 {
-  GtkRBNode *node;
+  FixedHeight fixed;
+  gint old_offset;
 
-  if (tree == NULL)
+  if (tree == NULL || _gtk_rbtree_is_nil (tree->root))
     return;
 
-  node = _gtk_rbtree_first (tree);
+  fixed.height = height;
+  fixed.mark_valid = mark_valid;
 
-  do
-    {
-      if (GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_INVALID))
-        {
-	  _gtk_rbtree_node_set_height (tree, node, height);
-	  if (mark_valid)
-	    _gtk_rbtree_node_mark_valid (tree, node);
-	}
+  old_offset = tree->root->offset;
+  fixed_height_tree (tree, &fixed);
 
-      if (node->children)
-	_gtk_rbtree_set_fixed_height (node->children, height, mark_valid);
-    }
-  while ((node = _gtk_rbtree_next (tree, node)) != NULL);
+  gtk_rbnode_adjust (tree->parent_tree, tree->parent_node,
+                     0, 0, tree->root->offset - old_offset);
 }
 
 static void
@@ -1226,7 +1428,11 @@ _gtk_rbtree_remove_node (GtkRBTree *tree,
                          y_height - node_height);
     }
 
-  _gtk_rbnode_free (node);
+  _gtk_rbnode_free (tree, node);
+
+  /* Give the memory back once the last node is gone */
+  if (_gtk_rbtree_is_nil (tree->root))
+    _gtk_rbtree_free_chunks (tree);
 
 #ifdef G_ENABLE_DEBUG  
   if (gtk_get_debug_flags () & GTK_DEBUG_TREE)
@@ -49,6 +49,7 @@ typedef enum
 typedef struct _GtkRBTree GtkRBTree;
 typedef struct _GtkRBNode GtkRBNode;
 typedef struct _GtkRBTreeView GtkRBTreeView;
+typedef struct _GtkRBNodeChunk GtkRBNodeChunk;
 
 typedef void (*GtkRBTreeTraverseFunc) (GtkRBTree  *tree,
                                        GtkRBNode  *node,
@@ -59,20 +60,31 @@ struct _GtkRBTree
   GtkRBNode *root;
   GtkRBTree *parent_tree;
   GtkRBNode *parent_node;
+
+  /* The nodes of a tree are allocated from chunks owned by the
+   * tree, so that neighbouring nodes tend to be close in memory.
+   * Removed nodes are kept in free_nodes, linked through ->parent.
+   */
+  GtkRBNodeChunk *chunks;
+  GtkRBNode *free_nodes;
 };
 
 struct _GtkRBNode
 {
   guint flags : 14;
 
-  GtkRBNode *left;
-  GtkRBNode *right;
-  GtkRBNode *parent;
-
   /* count is the number of nodes beneath us, plus 1 for ourselves.
    * i.e. node->left->count + node->right->count + 1
+   *
+   * It is kept next to flags so that neither needs padding; there
+   * is one node per visible row.
    */
   gint count;
+
+  GtkRBNode *left;
+  GtkRBNode *right;
+  GtkRBNode *parent;
+
   /* count the number of total nodes beneath us, including nodes
    * of children trees.
    * i.e. node->left->count + node->right->count + node->children->root->count + 1
@@ -111,6 +123,10 @@ GtkRBNode *_gtk_rbtree_insert_after     (GtkRBTree              *tree,
 					 GtkRBNode              *node,
 					 gint                    height,
 					 gboolean                valid);
+void       _gtk_rbtree_fill             (GtkRBTree              *tree,
+					 guint                   n_nodes,
+					 gint                    height,
+					 gboolean                valid);
 void       _gtk_rbtree_remove_node      (GtkRBTree              *tree,
 					 GtkRBNode              *node);
 gboolean   _gtk_rbtree_is_nil           (GtkRBNode              *node);
@@ -135,6 +135,7 @@ struct _GtkRecentChooserDefault
  
   guint load_id;
   GList *recent_items;
+  GList *next_item;
   gint n_recent_items;
   gint loaded_items;
   guint load_state;
@@ -373,6 +374,7 @@ _gtk_recent_chooser_default_init (GtkRecentChooserDefault *impl)
   impl->current_filter = NULL;
 
   impl->recent_items = NULL;
+  impl->next_item = NULL;
   impl->n_recent_items = 0;
   impl->loaded_items = 0;
   
@@ -807,12 +809,13 @@ load_recent_items (gpointer user_data)
         }
         
       impl->n_recent_items = g_list_length (impl->recent_items);
+      impl->next_item = impl->recent_items;
       impl->loaded_items = 0;
       impl->load_state = LOAD_PRELOAD;
     }
   
-  info = (GtkRecentInfo *) g_list_nth_data (impl->recent_items,
-                                            impl->loaded_items);
+  info = (GtkRecentInfo *) impl->next_item->data;
+  impl->next_item = impl->next_item->next;
   g_assert (info);
 
   uri = gtk_recent_info_get_uri (info);
@@ -840,6 +843,7 @@ load_recent_items (gpointer user_data)
       g_list_free_full (impl->recent_items, (GDestroyNotify) gtk_recent_info_unref);
       
       impl->recent_items = NULL;
+      impl->next_item = NULL;
       impl->n_recent_items = 0;
       impl->loaded_items = 0;
 
@@ -887,7 +891,90 @@ cleanup_after_load (gpointer user_data)
   set_busy_cursor (impl, FALSE);
 }
 
-/* clears the current model and reloads the recently used resources */
+/* brings a loaded model in line with the current list of items,
+ * touching only the rows of items that were added, removed, moved
+ * or changed
+ */
+static void
+update_recent_items (GtkRecentChooserDefault *impl)
+{
+  GtkTreeModel *model = GTK_TREE_MODEL (impl->recent_store);
+  GHashTable *rows;
+  GtkTreeIter iter, pos;
+  gboolean pos_valid;
+  GHashTableIter hash_iter;
+  GtkTreeIter *row;
+  GList *items, *l;
+
+  items = gtk_recent_chooser_get_items (GTK_RECENT_CHOOSER (impl));
+
+  /* list store iters persist, so we can keep them around */
+  rows = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                g_free, (GDestroyNotify) gtk_tree_iter_free);
+  if (gtk_tree_model_get_iter_first (model, &iter))
+    {
+      do
+        {
+          gchar *uri;
+
+          gtk_tree_model_get (model, &iter, RECENT_URI_COLUMN, &uri, -1);
+          g_hash_table_insert (rows, uri, gtk_tree_iter_copy (&iter));
+        }
+      while (gtk_tree_model_iter_next (model, &iter));
+    }
+
+  pos_valid = gtk_tree_model_get_iter_first (model, &pos);
+
+  for (l = items; l != NULL; l = l->next)
+    {
+      GtkRecentInfo *info = l->data;
+      GtkRecentInfo *old_info;
+      const gchar *uri;
+
+      uri = gtk_recent_info_get_uri (info);
+
+      row = g_hash_table_lookup (rows, uri);
+      if (row == NULL)
+        {
+          gtk_list_store_insert_before (impl->recent_store, &iter,
+                                        pos_valid ? &pos : NULL);
+          gtk_list_store_set (impl->recent_store, &iter,
+                              RECENT_URI_COLUMN, uri,
+                              RECENT_DISPLAY_NAME_COLUMN, gtk_recent_info_get_display_name (info),
+                              RECENT_INFO_COLUMN, info,
+                              -1);
+          continue;
+        }
+
+      if (pos_valid && row->user_data == pos.user_data)
+        pos_valid = gtk_tree_model_iter_next (model, &pos);
+      else
+        gtk_list_store_move_before (impl->recent_store, row,
+                                    pos_valid ? &pos : NULL);
+
+      gtk_tree_model_get (model, row, RECENT_INFO_COLUMN, &old_info, -1);
+      if (gtk_recent_info_get_modified (old_info) != gtk_recent_info_get_modified (info))
+        gtk_list_store_set (impl->recent_store, row,
+                            RECENT_DISPLAY_NAME_COLUMN, gtk_recent_info_get_display_name (info),
+                            RECENT_INFO_COLUMN, info,
+                            -1);
+      gtk_recent_info_unref (old_info);
+
+      g_hash_table_remove (rows, uri);
+    }
+
+  /* what is left are the rows of items that went away */
+  g_hash_table_iter_init (&hash_iter, rows);
+  while (g_hash_table_iter_next (&hash_iter, NULL, (gpointer *) &row))
+    gtk_list_store_remove (impl->recent_store, row);
+
+  g_hash_table_unref (rows);
+  g_list_free_full (items, (GDestroyNotify) gtk_recent_info_unref);
+}
+
+/* reloads the recently used resources; a model that has already
+ * been loaded is updated in place, otherwise it is refilled
+ */
 static void
 reload_recent_items (GtkRecentChooserDefault *impl)
 {
@@ -899,9 +986,6 @@ reload_recent_items (GtkRecentChooserDefault *impl)
   
   widget = GTK_WIDGET (impl);
 
-  gtk_tree_view_set_model (GTK_TREE_VIEW (impl->recent_view), NULL);
-  gtk_list_store_clear (impl->recent_store);
-  
   if (!impl->icon_theme)
     impl->icon_theme = get_icon_theme_for_widget (widget);
 
@@ -911,6 +995,16 @@ reload_recent_items (GtkRecentChooserDefault *impl)
   if (!impl->limit_set)
     impl->limit = get_recent_files_limit (widget);
 
+  if (impl->load_state == LOAD_FINISHED &&
+      gtk_tree_view_get_model (GTK_TREE_VIEW (impl->recent_view)) == GTK_TREE_MODEL (impl->recent_store))
+    {
+      update_recent_items (impl);
+      return;
+    }
+
+  gtk_tree_view_set_model (GTK_TREE_VIEW (impl->recent_view), NULL);
+  gtk_list_store_clear (impl->recent_store);
+
   set_busy_cursor (impl, TRUE);
 
   impl->load_state = LOAD_EMPTY;
@@ -962,6 +962,7 @@ gtk_recent_chooser_menu_dispose_items (GtkRecentChooserMenu *menu)
 typedef struct
 {
   GList *items;
+  GList *next_item;
   gint n_items;
   gint loaded_items;
   gint displayed_items;
@@ -976,6 +977,7 @@ create_menu_populate_data (GtkRecentChooserMenu *menu)
 
   pdata = g_slice_new (MenuPopulateData);
   pdata->items = NULL;
+  pdata->next_item = NULL;
   pdata->n_items = 0;
   pdata->loaded_items = 0;
   pdata->displayed_items = 0;
@@ -1021,10 +1023,12 @@ idle_populate_func (gpointer data)
         gtk_widget_hide (pdata->placeholder);
       
       pdata->n_items = g_list_length (pdata->items);
+      pdata->next_item = pdata->items;
       pdata->loaded_items = 0;
     }
 
-  info = g_list_nth_data (pdata->items, pdata->loaded_items);
+  info = pdata->next_item->data;
+  pdata->next_item = pdata->next_item->next;
   item = gtk_recent_chooser_menu_create_item (pdata->menu,
                                               info,
 					      pdata->displayed_items);
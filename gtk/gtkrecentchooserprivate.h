@@ -50,6 +50,8 @@ void              _gtk_recent_chooser_set_use_action_appearance (GtkRecentChoose
 								 gboolean           use_appearance);
 gboolean          _gtk_recent_chooser_get_use_action_appearance (GtkRecentChooser  *recent_chooser);
 
+guint             _gtk_recent_filter_get_serial              (GtkRecentFilter   *filter);
+
 G_END_DECLS
 
 #endif /* ! __GTK_RECENT_CHOOSER_PRIVATE_H__ */
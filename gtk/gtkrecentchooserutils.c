@@ -294,24 +294,65 @@ delegate_item_activated (GtkRecentChooser *receiver,
   _gtk_recent_chooser_item_activated (GTK_RECENT_CHOOSER (user_data));
 }
 
+/* MRU and LRU sorting compare the modification times, which are
+ * fetched once per item rather than once per comparison
+ */
+typedef struct
+{
+  GtkRecentInfo *info;
+  time_t modified;
+} SortKey;
+
 static gint
-sort_recent_items_mru (GtkRecentInfo *a,
-		       GtkRecentInfo *b,
-		       gpointer       unused)
+sort_keys_mru (gconstpointer a,
+	       gconstpointer b,
+	       gpointer      unused)
 {
-  g_assert (a != NULL && b != NULL);
-  
-  return gtk_recent_info_get_modified (b) - gtk_recent_info_get_modified (a);
+  const SortKey *key_a = a;
+  const SortKey *key_b = b;
+
+  if (key_a->modified != key_b->modified)
+    return key_a->modified < key_b->modified ? 1 : -1;
+
+  return 0;
 }
 
 static gint
-sort_recent_items_lru (GtkRecentInfo *a,
-		       GtkRecentInfo *b,
-		       gpointer       unused)
+sort_keys_lru (gconstpointer a,
+	       gconstpointer b,
+	       gpointer      unused)
 {
-  g_assert (a != NULL && b != NULL);
-  
-  return -1 * (gtk_recent_info_get_modified (b) - gtk_recent_info_get_modified (a));
+  return - sort_keys_mru (a, b, unused);
+}
+
+static GList *
+sort_recent_items_by_time (GList             *items,
+			   GtkRecentSortType  sort_type)
+{
+  SortKey *keys;
+  GList *l;
+  guint n_items, i;
+
+  n_items = g_list_length (items);
+  keys = g_new (SortKey, n_items);
+
+  for (l = items, i = 0; l != NULL; l = l->next, i++)
+    {
+      keys[i].info = l->data;
+      keys[i].modified = gtk_recent_info_get_modified (l->data);
+    }
+
+  /* g_qsort_with_data() is stable, like g_list_sort() */
+  g_qsort_with_data (keys, n_items, sizeof (SortKey),
+		     sort_type == GTK_RECENT_SORT_MRU ? sort_keys_mru : sort_keys_lru,
+		     NULL);
+
+  for (l = items, i = 0; l != NULL; l = l->next, i++)
+    l->data = keys[i].info;
+
+  g_free (keys);
+
+  return items;
 }
 
 typedef struct
@@ -397,6 +438,104 @@ get_is_recent_filtered (GtkRecentFilter *filter,
   return !retval;
 }
 
+/* Whether an item is filtered out by the filter, local-only and
+ * show-private only depends on the item, and an item only changes
+ * together with its modification time. We remember the outcome per
+ * URI, so that reloading after a change of the recent manager only
+ * runs the filter on the items that changed.
+ */
+typedef struct
+{
+  GtkRecentFilter *filter;
+  guint filter_serial;
+  gboolean local_only;
+  gboolean show_private;
+  gint64 day;
+  GHashTable *results;
+} FilterCache;
+
+typedef struct
+{
+  time_t modified;
+  gboolean filtered;
+} FilterResult;
+
+static void
+filter_cache_free (FilterCache *cache)
+{
+  g_hash_table_unref (cache->results);
+  g_slice_free (FilterCache, cache);
+}
+
+static FilterCache *
+get_filter_cache (GtkRecentChooser *chooser,
+		  GtkRecentFilter  *filter,
+		  gboolean          local_only,
+		  gboolean          show_private)
+{
+  static GQuark quark = 0;
+  FilterCache *cache;
+  gint64 day;
+
+  if (G_UNLIKELY (quark == 0))
+    quark = g_quark_from_static_string ("gtk-recent-chooser-filter-cache");
+
+  /* the age of items changes once a day */
+  day = g_get_real_time () / (G_USEC_PER_SEC * (gint64) 86400);
+
+  cache = g_object_get_qdata (G_OBJECT (chooser), quark);
+  if (cache != NULL &&
+      cache->filter == filter &&
+      cache->filter_serial == _gtk_recent_filter_get_serial (filter) &&
+      cache->local_only == local_only &&
+      cache->show_private == show_private &&
+      cache->day == day)
+    return cache;
+
+  cache = g_slice_new (FilterCache);
+  cache->filter = filter;
+  cache->filter_serial = _gtk_recent_filter_get_serial (filter);
+  cache->local_only = local_only;
+  cache->show_private = show_private;
+  cache->day = day;
+  cache->results = g_hash_table_new_full (g_str_hash, g_str_equal,
+					  g_free, g_free);
+
+  g_object_set_qdata_full (G_OBJECT (chooser), quark, cache,
+			   (GDestroyNotify) filter_cache_free);
+
+  return cache;
+}
+
+static gboolean
+get_is_recent_filtered_cached (FilterCache     *cache,
+			       GtkRecentInfo   *info)
+{
+  FilterResult *result;
+  const gchar *uri;
+  time_t modified;
+
+  uri = gtk_recent_info_get_uri (info);
+  modified = gtk_recent_info_get_modified (info);
+
+  result = g_hash_table_lookup (cache->results, uri);
+  if (result == NULL)
+    {
+      result = g_new (FilterResult, 1);
+      g_hash_table_insert (cache->results, g_strdup (uri), result);
+    }
+  else if (result->modified == modified)
+    return result->filtered;
+
+  result->modified = modified;
+  result->filtered =
+    get_is_recent_filtered (cache->filter, info) ||
+    (cache->local_only && !gtk_recent_info_is_local (info)) ||
+    (!cache->show_private && gtk_recent_info_get_private_hint (info));
+
+  return result->filtered;
+}
+
 /*
  * _gtk_recent_chooser_get_items:
  * @chooser: a #GtkRecentChooser
@@ -445,6 +584,7 @@ _gtk_recent_chooser_get_items (GtkRecentChooser  *chooser,
       gboolean local_only = FALSE;
       gboolean show_private = FALSE;
       gboolean show_not_found = FALSE;
+      FilterCache *cache;
 
       g_object_get (G_OBJECT (chooser),
                     "local-only", &local_only,
@@ -452,22 +592,23 @@ _gtk_recent_chooser_get_items (GtkRecentChooser  *chooser,
                     "show-not-found", &show_not_found,
                     NULL);
 
+      cache = get_filter_cache (chooser, filter, local_only, show_private);
+
+      /* drop the results of items that have gone away */
+      if (g_hash_table_size (cache->results) > 2 * g_list_length (items))
+        g_hash_table_remove_all (cache->results);
+
       filter_items = NULL;
       for (l = items; l != NULL; l = l->next)
         {
           GtkRecentInfo *info = l->data;
           gboolean remove_item = FALSE;
 
-          if (get_is_recent_filtered (filter, info))
-            remove_item = TRUE;
-          
-          if (local_only && !gtk_recent_info_is_local (info))
+          if (get_is_recent_filtered_cached (cache, info))
             remove_item = TRUE;
 
-          if (!show_private && gtk_recent_info_get_private_hint (info))
-            remove_item = TRUE;
-
-          if (!show_not_found && !gtk_recent_info_exists (info))
+          /* files may go away without the item changing */
+          if (!remove_item && !show_not_found && !gtk_recent_info_exists (info))
             remove_item = TRUE;
           
           if (!remove_item)
@@ -490,10 +631,9 @@ _gtk_recent_chooser_get_items (GtkRecentChooser  *chooser,
       compare_func = NULL;
       break;
     case GTK_RECENT_SORT_MRU:
-      compare_func = (GCompareDataFunc) sort_recent_items_mru;
-      break;
     case GTK_RECENT_SORT_LRU:
-      compare_func = (GCompareDataFunc) sort_recent_items_lru;
+      items = sort_recent_items_by_time (items, sort_type);
+      compare_func = NULL;
       break;
     case GTK_RECENT_SORT_CUSTOM:
       compare_func = (GCompareDataFunc) sort_recent_items_proxy;
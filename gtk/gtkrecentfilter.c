@@ -82,6 +82,7 @@
 #include <gdk-pixbuf/gdk-pixbuf.h>
 
 #include "gtkrecentfilter.h"
+#include "gtkrecentchooserprivate.h"
 #include "gtkbuildable.h"
 #include "gtkintl.h"
 #include "gtkprivate.h"
@@ -121,6 +122,8 @@ struct _GtkRecentFilter
   GSList *rules;
   
   GtkRecentFilterFlags needed;
+
+  guint serial;
 };
 
 struct _GtkRecentFilterClass
@@ -494,6 +497,16 @@ recent_filter_add_rule (GtkRecentFilter *filter,
 {
   filter->needed |= rule->needed;
   filter->rules = g_slist_append (filter->rules, rule);
+  filter->serial++;
+}
+
+/* Changes whenever a rule is added, so that cached
+ * results of the filter can be checked for validity
+ */
+guint
+_gtk_recent_filter_get_serial (GtkRecentFilter *filter)
+{
+  return filter->serial;
 }
 
 /**
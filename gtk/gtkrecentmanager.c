@@ -113,12 +113,27 @@
 /* the file where we store the recently used items */
 #define GTK_RECENTLY_USED_FILE	"recently-used.xbel"
 
+/* changes are appended to a journal next to the recently used items
+ * file, and folded into it once the journal grows past this size
+ */
+#define JOURNAL_SUFFIX		".journal"
+#define JOURNAL_MAGIC		"GtkRJnl1"
+#define JOURNAL_MAGIC_LEN	8
+#define JOURNAL_MAX_SIZE	(64 * 1024)
+
 /* return all items by default */
 #define DEFAULT_LIMIT	-1
 
 /* keep in sync with xdgmime */
 #define GTK_RECENT_DEFAULT_MIME	"application/octet-stream"
 
+typedef enum
+{
+  JOURNAL_ADD = 1,
+  JOURNAL_REMOVE,
+  JOURNAL_MOVE
+} JournalOp;
+
 typedef struct
 {
   gchar *name;
@@ -168,14 +183,25 @@ struct _GtkRecentInfo
 struct _GtkRecentManagerPrivate
 {
   gchar *filename;
+  gchar *journal_filename;
 
   guint is_dirty : 1;
+  guint needs_compaction : 1;
   
   gint size;
 
   GBookmarkFile *recent_items;
 
+  /* the state of the files when we last read them */
+  time_t filename_mtime;
+  goffset filename_size;
+  gsize journal_offset;
+
+  /* records not yet appended to the journal */
+  GByteArray *journal_pending;
+
   GFileMonitor *monitor;
+  GFileMonitor *journal_monitor;
 
   guint changed_timeout;
   guint changed_age;
@@ -218,6 +244,8 @@ static void     gtk_recent_manager_enabled_changed     (GtkRecentManager  *manag
 
 
 static void build_recent_items_list (GtkRecentManager  *manager);
+static void sync_recent_items_list  (GtkRecentManager  *manager);
+static void write_recent_items_list (GtkRecentManager  *manager);
 static void purge_recent_items_list (GtkRecentManager  *manager,
                                      GError           **error);
 
@@ -351,6 +379,7 @@ gtk_recent_manager_init (GtkRecentManager *manager)
 
   priv->size = 0;
   priv->filename = NULL;
+  priv->journal_pending = g_byte_array_new ();
 
   settings = gtk_settings_get_default ();
   g_signal_connect_swapped (settings, "notify::gtk-recent-files-enabled",
@@ -398,6 +427,20 @@ gtk_recent_manager_get_property (GObject               *object,
     }
 } 
 
+static void
+remove_monitor (GtkRecentManager  *manager,
+                GFileMonitor     **monitor)
+{
+  if (*monitor == NULL)
+    return;
+
+  g_signal_handlers_disconnect_by_func (*monitor,
+                                        G_CALLBACK (gtk_recent_manager_monitor_changed),
+                                        manager);
+  g_object_unref (*monitor);
+  *monitor = NULL;
+}
+
 static void
 gtk_recent_manager_finalize (GObject *object)
 {
@@ -405,10 +448,13 @@ gtk_recent_manager_finalize (GObject *object)
   GtkRecentManagerPrivate *priv = manager->priv;
 
   g_free (priv->filename);
+  g_free (priv->journal_filename);
 
   if (priv->recent_items != NULL)
     g_bookmark_file_free (priv->recent_items);
 
+  g_byte_array_unref (priv->journal_pending);
+
   G_OBJECT_CLASS (gtk_recent_manager_parent_class)->finalize (object);
 }
 
@@ -418,14 +464,8 @@ gtk_recent_manager_dispose (GObject *gobject)
   GtkRecentManager *manager = GTK_RECENT_MANAGER (gobject);
   GtkRecentManagerPrivate *priv = manager->priv;
 
-  if (priv->monitor != NULL)
-    {
-      g_signal_handlers_disconnect_by_func (priv->monitor,
-                                            G_CALLBACK (gtk_recent_manager_monitor_changed),
-                                            manager);
-      g_object_unref (priv->monitor);
-      priv->monitor = NULL;
-    }
+  remove_monitor (manager, &priv->monitor);
+  remove_monitor (manager, &priv->journal_monitor);
 
   if (priv->changed_timeout != 0)
     {
@@ -444,6 +484,414 @@ gtk_recent_manager_dispose (GObject *gobject)
   G_OBJECT_CLASS (gtk_recent_manager_parent_class)->dispose (gobject);
 }
 
+/* The journal
+ *
+ * Rewriting the whole recently used items file for every added item,
+ * and having every other application parse all of it again, gets
+ * expensive once the file grows. Instead, changes are appended to a
+ * journal, and instances watching the files only need to read the
+ * records they have not seen yet. Once the journal grows too large,
+ * or when the list is cleared or clamped, the journal is folded into
+ * the items file and removed.
+ *
+ * A journal starts with JOURNAL_MAGIC, followed by records: a 32-bit
+ * little-endian size, then the operation, a 64-bit little-endian time
+ * stamp and a list of nul-terminated strings.
+ */
+static void
+journal_append_string (GByteArray  *buffer,
+                       const gchar *str)
+{
+  if (str == NULL)
+    str = "";
+
+  g_byte_array_append (buffer, (const guint8 *) str, strlen (str) + 1);
+}
+
+static guint
+journal_begin_record (GByteArray *buffer,
+                      JournalOp   op)
+{
+  guint start = buffer->len;
+  guint8 op_byte = op;
+  gint64 stamp;
+
+  stamp = GINT64_TO_LE ((gint64) time (NULL));
+
+  g_byte_array_set_size (buffer, start + sizeof (guint32));
+  g_byte_array_append (buffer, &op_byte, 1);
+  g_byte_array_append (buffer, (const guint8 *) &stamp, sizeof (stamp));
+
+  return start;
+}
+
+static void
+journal_end_record (GByteArray *buffer,
+                    guint       start)
+{
+  guint32 size;
+
+  size = GUINT32_TO_LE (buffer->len - start - sizeof (guint32));
+  memcpy (buffer->data + start, &size, sizeof (size));
+}
+
+typedef struct
+{
+  const guint8 *data;
+  gsize len;
+  gsize pos;
+} JournalReader;
+
+static const gchar *
+journal_read_string (JournalReader *reader)
+{
+  const gchar *str;
+  const guint8 *end;
+
+  if (reader->pos >= reader->len)
+    return NULL;
+
+  str = (const gchar *) reader->data + reader->pos;
+  end = memchr (str, '\0', reader->len - reader->pos);
+  if (end == NULL)
+    return NULL;
+
+  reader->pos = end - reader->data + 1;
+
+  return str;
+}
+
+static void
+journal_replay_record (GBookmarkFile *items,
+                       const guint8  *data,
+                       gsize          len)
+{
+  JournalReader reader = { data, len, 1 + sizeof (gint64) };
+  const gchar *uri, *str;
+  gint64 stamp;
+
+  if (len < reader.pos)
+    return;
+
+  memcpy (&stamp, data + 1, sizeof (stamp));
+  stamp = GINT64_FROM_LE (stamp);
+
+  uri = journal_read_string (&reader);
+  if (uri == NULL || *uri == '\0')
+    return;
+
+  switch (data[0])
+    {
+    case JOURNAL_ADD:
+      {
+        const gchar *title, *description, *mime_type, *app_name, *app_exec;
+        gboolean is_new;
+
+        title = journal_read_string (&reader);
+        description = journal_read_string (&reader);
+        mime_type = journal_read_string (&reader);
+        app_name = journal_read_string (&reader);
+        app_exec = journal_read_string (&reader);
+        if (app_exec == NULL || reader.pos >= reader.len)
+          return;
+
+        is_new = !g_bookmark_file_has_item (items, uri);
+
+        if (*title != '\0')
+          g_bookmark_file_set_title (items, uri, title);
+        if (*description != '\0')
+          g_bookmark_file_set_description (items, uri, description);
+        g_bookmark_file_set_mime_type (items, uri, mime_type);
+        g_bookmark_file_set_is_private (items, uri, data[reader.pos++] != 0);
+
+        while ((str = journal_read_string (&reader)) != NULL && *str != '\0')
+          g_bookmark_file_add_group (items, uri, str);
+
+        /* a negative count adds one registration */
+        g_bookmark_file_set_app_info (items, uri, app_name, app_exec,
+                                      -1, (time_t) stamp, NULL);
+
+        if (is_new)
+          g_bookmark_file_set_added (items, uri, (time_t) stamp);
+        g_bookmark_file_set_modified (items, uri, (time_t) stamp);
+      }
+      break;
+
+    case JOURNAL_REMOVE:
+      g_bookmark_file_remove_item (items, uri, NULL);
+      break;
+
+    case JOURNAL_MOVE:
+      str = journal_read_string (&reader);
+      if (str != NULL && g_bookmark_file_has_item (items, uri))
+        g_bookmark_file_move_item (items, uri, *str != '\0' ? str : NULL, NULL);
+      break;
+
+    default:
+      break;
+    }
+}
+
+/* returns the number of bytes of complete records */
+static gsize
+journal_replay (GBookmarkFile *items,
+                const guint8  *data,
+                gsize          len)
+{
+  gsize pos = 0;
+
+  while (len - pos >= sizeof (guint32))
+    {
+      guint32 size;
+
+      memcpy (&size, data + pos, sizeof (size));
+      size = GUINT32_FROM_LE (size);
+      if (size > len - pos - sizeof (guint32))
+        break;
+
+      journal_replay_record (items, data + pos + sizeof (guint32), size);
+      pos += sizeof (guint32) + size;
+    }
+
+  return pos;
+}
+
+/* applies the records added to the journal since we last read it;
+ * returns %FALSE if the journal has been folded into the items file
+ * in the meantime, and the whole list needs to be read again
+ */
+static gboolean
+journal_read (GtkRecentManager *manager)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  GError *error = NULL;
+  gchar *contents;
+  gsize length;
+
+  if (!g_file_get_contents (priv->journal_filename, &contents, &length, &error))
+    {
+      gboolean retval = TRUE;
+
+      if (error->domain == G_FILE_ERROR &&
+          error->code == G_FILE_ERROR_NOENT)
+        retval = (priv->journal_offset == 0);
+      else
+        filename_warning ("Attempting to read the recently used resources "
+                          "journal at `%s', but failed: %s.",
+                          priv->journal_filename,
+                          error->message);
+
+      g_error_free (error);
+
+      return retval;
+    }
+
+  if (length < priv->journal_offset)
+    {
+      g_free (contents);
+      return FALSE;
+    }
+
+  if (priv->journal_offset == 0 && length > 0)
+    {
+      if (length < JOURNAL_MAGIC_LEN)
+        {
+          g_free (contents);
+          return TRUE;
+        }
+
+      if (memcmp (contents, JOURNAL_MAGIC, JOURNAL_MAGIC_LEN) != 0)
+        {
+          filename_warning ("The recently used resources journal at `%s' "
+                            "is not valid, and will be discarded.",
+                            priv->journal_filename);
+          priv->needs_compaction = TRUE;
+          g_free (contents);
+          return TRUE;
+        }
+
+      priv->journal_offset = JOURNAL_MAGIC_LEN;
+    }
+
+  if (length > priv->journal_offset)
+    {
+      if (!priv->recent_items)
+        priv->recent_items = g_bookmark_file_new ();
+
+      priv->journal_offset += journal_replay (priv->recent_items,
+                                              (const guint8 *) contents + priv->journal_offset,
+                                              length - priv->journal_offset);
+    }
+
+  g_free (contents);
+
+  return TRUE;
+}
+
+static void
+journal_write (GtkRecentManager *manager)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  FILE *journal;
+  long size;
+  gboolean failed;
+
+  if (priv->journal_pending->len == 0)
+    return;
+
+  journal = g_fopen (priv->journal_filename, "ab");
+  if (journal == NULL)
+    {
+      filename_warning ("Attempting to store changes into `%s', "
+                        "but failed: %s",
+                        priv->journal_filename,
+                        g_strerror (errno));
+      return;
+    }
+
+  fseek (journal, 0, SEEK_END);
+  size = ftell (journal);
+
+  failed = FALSE;
+  if (size == 0)
+    {
+      failed = fwrite (JOURNAL_MAGIC, JOURNAL_MAGIC_LEN, 1, journal) != 1;
+      size = JOURNAL_MAGIC_LEN;
+    }
+
+  if (!failed)
+    failed = fwrite (priv->journal_pending->data, priv->journal_pending->len, 1, journal) != 1;
+
+  if (fclose (journal) != 0 || failed)
+    {
+      filename_warning ("Attempting to store changes into `%s', "
+                        "but failed: %s",
+                        priv->journal_filename,
+                        g_strerror (errno));
+      return;
+    }
+
+  if (size == JOURNAL_MAGIC_LEN && g_chmod (priv->journal_filename, 0600) < 0)
+    {
+      filename_warning ("Attempting to set the permissions of `%s', "
+                        "but failed: %s",
+                        priv->journal_filename,
+                        g_strerror (errno));
+    }
+
+  /* we read everything up to our own records before writing */
+  priv->journal_offset = size + priv->journal_pending->len;
+  g_byte_array_set_size (priv->journal_pending, 0);
+}
+
+static void
+update_filename_stamp (GtkRecentManager *manager)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  GStatBuf stat_buf;
+
+  if (g_stat (priv->filename, &stat_buf) == 0)
+    {
+      priv->filename_mtime = stat_buf.st_mtime;
+      priv->filename_size = stat_buf.st_size;
+    }
+  else
+    {
+      priv->filename_mtime = 0;
+      priv->filename_size = 0;
+    }
+}
+
+static gboolean
+filename_changed (GtkRecentManager *manager)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  GStatBuf stat_buf;
+
+  if (g_stat (priv->filename, &stat_buf) != 0)
+    return priv->filename_mtime != 0;
+
+  return stat_buf.st_mtime != priv->filename_mtime ||
+         stat_buf.st_size != priv->filename_size;
+}
+
+static void
+update_size (GtkRecentManager *manager)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  gint size;
+
+  if (!priv->recent_items)
+    return;
+
+  size = g_bookmark_file_get_size (priv->recent_items);
+  if (priv->size != size)
+    {
+      priv->size = size;
+
+      g_object_notify (G_OBJECT (manager), "size");
+    }
+}
+
+/* brings the items list up to date with the changes made by other
+ * instances, reading the whole file only if it has been rewritten
+ */
+static void
+sync_recent_items_list (GtkRecentManager *manager)
+{
+  if (filename_changed (manager) || !journal_read (manager))
+    build_recent_items_list (manager);
+  else
+    update_size (manager);
+}
+
+/* stores our changes, either by appending them to the journal or by
+ * writing the whole list and discarding the journal
+ */
+static void
+write_recent_items_list (GtkRecentManager *manager)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  GError *write_error;
+
+  if (!priv->needs_compaction &&
+      priv->journal_offset + priv->journal_pending->len < JOURNAL_MAX_SIZE)
+    {
+      journal_write (manager);
+      return;
+    }
+
+  write_error = NULL;
+  g_bookmark_file_to_file (priv->recent_items, priv->filename, &write_error);
+  if (write_error)
+    {
+      filename_warning ("Attempting to store changes into `%s', "
+                        "but failed: %s",
+                        priv->filename,
+                        write_error->message);
+      g_error_free (write_error);
+
+      /* keep the journal, it has changes the file does not have */
+      return;
+    }
+
+  if (g_chmod (priv->filename, 0600) < 0)
+    {
+      filename_warning ("Attempting to set the permissions of `%s', "
+                        "but failed: %s",
+                        priv->filename,
+                        g_strerror (errno));
+    }
+
+  g_unlink (priv->journal_filename);
+
+  priv->journal_offset = 0;
+  g_byte_array_set_size (priv->journal_pending, 0);
+  priv->needs_compaction = FALSE;
+
+  update_filename_stamp (manager);
+}
+
 static void
 gtk_recent_manager_enabled_changed (GtkRecentManager *manager)
 {
@@ -460,13 +908,17 @@ gtk_recent_manager_real_changed (GtkRecentManager *manager)
 
   if (priv->is_dirty)
     {
-      GError *write_error;
-      
-      /* we are marked as dirty, so we dump the content of our
+      /* we are marked as dirty, so we store the changes to our
        * recently used items list
        */
       g_assert (priv->filename != NULL);
 
+      /* pick up the changes of other instances first, unless we
+       * are about to overwrite them anyway
+       */
+      if (!priv->needs_compaction)
+        sync_recent_items_list (manager);
+
       if (!priv->recent_items)
         {
           /* if no container object has been defined, we create a new
@@ -474,6 +926,7 @@ gtk_recent_manager_real_changed (GtkRecentManager *manager)
            */
           priv->recent_items = g_bookmark_file_new ();
 	  priv->size = 0;
+          priv->needs_compaction = TRUE;
 	}
       else
         {
@@ -490,29 +943,13 @@ gtk_recent_manager_real_changed (GtkRecentManager *manager)
             {
               g_bookmark_file_free (priv->recent_items);
               priv->recent_items = g_bookmark_file_new ();
+              priv->needs_compaction = TRUE;
             }
           else if (age > 0)
             gtk_recent_manager_clamp_to_age (manager, age);
         }
 
-      write_error = NULL;
-      g_bookmark_file_to_file (priv->recent_items, priv->filename, &write_error);
-      if (write_error)
-        {
-          filename_warning ("Attempting to store changes into `%s', "
-			    "but failed: %s",
-			    priv->filename,
-			    write_error->message);
-	  g_error_free (write_error);
-	}
-
-      if (g_chmod (priv->filename, 0600) < 0)
-        {
-          filename_warning ("Attempting to set the permissions of `%s', "
-                            "but failed: %s",
-                            priv->filename,
-                            g_strerror (errno));
-        }
+      write_recent_items_list (manager);
 
       /* mark us as clean */
       priv->is_dirty = FALSE;
@@ -520,10 +957,10 @@ gtk_recent_manager_real_changed (GtkRecentManager *manager)
   else
     {
       /* we are not marked as dirty, so we have been called
-       * because the recently used resources file has been
+       * because the recently used resources files have been
        * changed (and not from us).
        */
-      build_recent_items_list (manager);
+      sync_recent_items_list (manager);
     }
 
   g_object_thaw_notify (G_OBJECT (manager));
@@ -575,13 +1012,42 @@ get_default_filename (void)
                            NULL);
 }
 
+static GFileMonitor *
+add_monitor (GtkRecentManager *manager,
+             const gchar      *filename)
+{
+  GFileMonitor *monitor;
+  GFile *file;
+  GError *error;
+
+  file = g_file_new_for_path (filename);
+
+  error = NULL;
+  monitor = g_file_monitor_file (file, G_FILE_MONITOR_NONE, NULL, &error);
+  if (error)
+    {
+      filename_warning ("Unable to monitor `%s': %s\n"
+                        "The GtkRecentManager will not update its contents "
+                        "if the file is changed from other instances",
+                        filename,
+                        error->message);
+      g_error_free (error);
+    }
+  else
+    g_signal_connect (monitor, "changed",
+                      G_CALLBACK (gtk_recent_manager_monitor_changed),
+                      manager);
+
+  g_object_unref (file);
+
+  return monitor;
+}
+
 static void
 gtk_recent_manager_set_filename (GtkRecentManager *manager,
 				 const gchar      *filename)
 {
   GtkRecentManagerPrivate *priv;
-  GFile *file;
-  GError *error;
   
   g_assert (GTK_IS_RECENT_MANAGER (manager));
 
@@ -597,15 +1063,11 @@ gtk_recent_manager_set_filename (GtkRecentManager *manager,
   if (priv->filename)
     {
       g_free (priv->filename);
+      g_free (priv->journal_filename);
+      priv->journal_filename = NULL;
 
-      if (priv->monitor)
-        {
-          g_signal_handlers_disconnect_by_func (priv->monitor,
-                                                G_CALLBACK (gtk_recent_manager_monitor_changed),
-                                                manager);
-          g_object_unref (priv->monitor);
-          priv->monitor = NULL;
-        }
+      remove_monitor (manager, &priv->monitor);
+      remove_monitor (manager, &priv->journal_monitor);
 
       if (!filename || *filename == '\0')
         return;
@@ -621,31 +1083,21 @@ gtk_recent_manager_set_filename (GtkRecentManager *manager,
     }
 
   g_assert (priv->filename != NULL);
-  file = g_file_new_for_path (priv->filename);
+  priv->journal_filename = g_strconcat (priv->filename, JOURNAL_SUFFIX, NULL);
 
-  error = NULL;
-  priv->monitor = g_file_monitor_file (file, G_FILE_MONITOR_NONE, NULL, &error);
-  if (error)
-    {
-      filename_warning ("Unable to monitor `%s': %s\n"
-                        "The GtkRecentManager will not update its contents "
-                        "if the file is changed from other instances",
-                        priv->filename,
-                        error->message);
-      g_error_free (error);
-    }
-  else
-    g_signal_connect (priv->monitor, "changed",
-                      G_CALLBACK (gtk_recent_manager_monitor_changed),
-                      manager);
+  priv->monitor = add_monitor (manager, priv->filename);
+  priv->journal_monitor = add_monitor (manager, priv->journal_filename);
 
-  g_object_unref (file);
+  /* changes made for the previous file are not carried over */
+  g_byte_array_set_size (priv->journal_pending, 0);
+  priv->needs_compaction = FALSE;
 
   priv->is_dirty = FALSE;
   build_recent_items_list (manager);
 }
 
-/* reads the recently used resources file and builds the items list.
+/* reads the recently used resources file and its journal, and builds
+ * the items list; changes not yet written are applied on top of it.
  * we keep the items list inside the parser object, and build the
  * RecentInfo object only on user's demand to avoid useless replication.
  * this function resets the dirty bit of the manager.
@@ -655,7 +1107,6 @@ build_recent_items_list (GtkRecentManager *manager)
 {
   GtkRecentManagerPrivate *priv = manager->priv;
   GError *read_error;
-  gint size;
 
   g_assert (priv->filename != NULL);
   
@@ -689,17 +1140,24 @@ build_recent_items_list (GtkRecentManager *manager)
 
       g_error_free (read_error);
     }
-  else
+
+  update_filename_stamp (manager);
+
+  priv->journal_offset = 0;
+  journal_read (manager);
+
+  if (priv->journal_pending->len > 0)
     {
-      size = g_bookmark_file_get_size (priv->recent_items);
-      if (priv->size != size)
-        {
-          priv->size = size;
+      if (!priv->recent_items)
+        priv->recent_items = g_bookmark_file_new ();
 
-          g_object_notify (G_OBJECT (manager), "size");
-        }
+      journal_replay (priv->recent_items,
+                      priv->journal_pending->data,
+                      priv->journal_pending->len);
     }
 
+  update_size (manager);
+
   priv->is_dirty = FALSE;
 }
 
@@ -896,6 +1354,8 @@ gtk_recent_manager_add_full (GtkRecentManager     *manager,
   GtkRecentManagerPrivate *priv;
   GtkSettings *settings;
   gboolean enabled;
+  guint8 is_private;
+  guint start;
   
   g_return_val_if_fail (GTK_IS_RECENT_MANAGER (manager), FALSE);
   g_return_val_if_fail (uri != NULL, FALSE);
@@ -988,6 +1448,25 @@ gtk_recent_manager_add_full (GtkRecentManager     *manager,
   
   g_bookmark_file_set_is_private (priv->recent_items, uri,
 		  		  data->is_private);
+
+  start = journal_begin_record (priv->journal_pending, JOURNAL_ADD);
+  journal_append_string (priv->journal_pending, uri);
+  journal_append_string (priv->journal_pending, data->display_name);
+  journal_append_string (priv->journal_pending, data->description);
+  journal_append_string (priv->journal_pending, data->mime_type);
+  journal_append_string (priv->journal_pending, data->app_name);
+  journal_append_string (priv->journal_pending, data->app_exec);
+  is_private = data->is_private ? 1 : 0;
+  g_byte_array_append (priv->journal_pending, &is_private, 1);
+  if (data->groups)
+    {
+      gint j;
+
+      for (j = 0; (data->groups)[j] != NULL; j++)
+        journal_append_string (priv->journal_pending, (data->groups)[j]);
+    }
+  journal_append_string (priv->journal_pending, NULL);
+  journal_end_record (priv->journal_pending, start);
   
   /* mark us as dirty, so that when emitting the "changed" signal we
    * will dump our changes
@@ -1019,6 +1498,7 @@ gtk_recent_manager_remove_item (GtkRecentManager  *manager,
 {
   GtkRecentManagerPrivate *priv;
   GError *remove_error = NULL;
+  guint start;
 
   g_return_val_if_fail (GTK_IS_RECENT_MANAGER (manager), FALSE);
   g_return_val_if_fail (uri != NULL, FALSE);
@@ -1052,6 +1532,10 @@ gtk_recent_manager_remove_item (GtkRecentManager  *manager,
       return FALSE;
     }
 
+  start = journal_begin_record (priv->journal_pending, JOURNAL_REMOVE);
+  journal_append_string (priv->journal_pending, uri);
+  journal_end_record (priv->journal_pending, start);
+
   priv->is_dirty = TRUE;
   gtk_recent_manager_changed (manager);
   
@@ -1234,6 +1718,7 @@ gtk_recent_manager_move_item (GtkRecentManager  *recent_manager,
 {
   GtkRecentManagerPrivate *priv;
   GError *move_error;
+  guint start;
 
   g_return_val_if_fail (GTK_IS_RECENT_MANAGER (recent_manager), FALSE);
   g_return_val_if_fail (uri != NULL, FALSE);
@@ -1274,6 +1759,11 @@ gtk_recent_manager_move_item (GtkRecentManager  *recent_manager,
       return FALSE;
     }
 
+  start = journal_begin_record (priv->journal_pending, JOURNAL_MOVE);
+  journal_append_string (priv->journal_pending, uri);
+  journal_append_string (priv->journal_pending, new_uri);
+  journal_end_record (priv->journal_pending, start);
+
   priv->is_dirty = TRUE;
   gtk_recent_manager_changed (recent_manager);
 
@@ -1337,6 +1827,7 @@ purge_recent_items_list (GtkRecentManager  *manager,
   priv->size = 0;
 
   /* emit the changed signal, to ensure that the purge is written */
+  priv->needs_compaction = TRUE;
   priv->is_dirty = TRUE;
   gtk_recent_manager_changed (manager);
 }
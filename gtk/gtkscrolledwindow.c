@@ -1905,6 +1905,41 @@ gtk_scrolled_window_scroll_event (GtkWidget      *widget,
   scrolled_window = GTK_SCROLLED_WINDOW (widget);
   priv = scrolled_window->priv;
 
+  if (event->direction == GDK_SCROLL_SMOOTH)
+    {
+      gdouble delta_x, delta_y;
+      gboolean handled = FALSE;
+
+      if (!gdk_event_get_scroll_deltas ((GdkEvent *) event, &delta_x, &delta_y))
+        return FALSE;
+
+      /* Smooth scroll deltas are fractions of a wheel step; keep the
+       * fractional part in the adjustment value instead of rounding
+       * to whole steps, so touchpad scrolling moves continuously.
+       */
+      if (delta_x != 0.0 && priv->hscrollbar && gtk_widget_get_visible (priv->hscrollbar))
+        {
+          GtkAdjustment *adjustment = gtk_range_get_adjustment (GTK_RANGE (priv->hscrollbar));
+          gdouble delta;
+
+          delta = _gtk_range_get_wheel_delta (GTK_RANGE (priv->hscrollbar), GDK_SCROLL_RIGHT) * delta_x;
+          gtk_adjustment_set_value (adjustment, gtk_adjustment_get_value (adjustment) + delta);
+          handled = TRUE;
+        }
+
+      if (delta_y != 0.0 && priv->vscrollbar && gtk_widget_get_visible (priv->vscrollbar))
+        {
+          GtkAdjustment *adjustment = gtk_range_get_adjustment (GTK_RANGE (priv->vscrollbar));
+          gdouble delta;
+
+          delta = _gtk_range_get_wheel_delta (GTK_RANGE (priv->vscrollbar), GDK_SCROLL_DOWN) * delta_y;
+          gtk_adjustment_set_value (adjustment, gtk_adjustment_get_value (adjustment) + delta);
+          handled = TRUE;
+        }
+
+      return handled;
+    }
+
   if (event->direction == GDK_SCROLL_UP || event->direction == GDK_SCROLL_DOWN)
     range = priv->vscrollbar;
   else
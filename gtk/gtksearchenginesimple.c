@@ -22,18 +22,6 @@
 
 #include "config.h"
 
-/* these must be defined even when HAVE_GNU_FTW is not defined
- * because (really) old versions of GNU libc have ftw.h but do
- * export ftw() and friends only if _XOPEN_SOURCE and _GNU_SOURCE
- * are defined. see bug #444097.
- */
-#define _XOPEN_SOURCE 500
-#define _GNU_SOURCE 
-
-#ifdef HAVE_FTW_H
-#include <ftw.h>
-#endif
-
 #include <gdk/gdk.h>
 
 #include "gtksearchenginesimple.h"
@@ -41,29 +29,89 @@
 
 #include <string.h>
 
+#ifdef G_OS_UNIX
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #define BATCH_SIZE 500
 
+/* The folders are walked by several threads. Each has its own queue
+ * of folders to read; it takes work from the end of its own queue,
+ * and when that is empty, steals from the start of the others.
+ */
+#define MAX_WALKERS 8
+
+/* Symbolic links are not followed, so this only guards against
+ * absurdly deep trees
+ */
+#define MAX_DEPTH 64
+
+/* How long the hits of a search are kept for refining it, in
+ * microseconds
+ */
+#define CACHE_LIFETIME (60 * G_USEC_PER_SEC)
+
+typedef struct
+{
+  gchar *path;
+  gint depth;
+} WalkFolder;
+
+typedef struct
+{
+  GMutex lock;
+  GQueue folders;
+} WalkQueue;
+
 typedef struct 
 {
   GtkSearchEngineSimple *engine;
   
   gchar *path;
   gchar **words;
-  GList *found_list;
-  
+
+  /* filenames to filter instead of walking the folders, if the
+   * query refines a recent one
+   */
+  GPtrArray *cached_hits;
+
+#ifdef G_OS_UNIX
+  /* the walk, shared by the walker threads */
+  dev_t device;
+  WalkQueue queues[MAX_WALKERS];
+  guint n_queues;
+  volatile gint n_pending_folders;
+#endif
+
+  /* protected by lock: */
+  GMutex lock;
   gint n_processed_files;
   GList *uri_hits;
+  GPtrArray *all_hits;
   
   /* accessed on both threads: */
   volatile gboolean cancelled;
 } SearchThreadData;
 
+typedef struct
+{
+  gchar *path;
+  gchar **words;
+  GPtrArray *hits;
+  gint64 time;
+} SearchCache;
 
 struct _GtkSearchEngineSimplePrivate 
 {
   GtkQuery *query;
   
   SearchThreadData *active_search;
+
+  SearchCache *cache;
   
   gboolean query_finished;
 };
@@ -71,6 +119,18 @@ struct _GtkSearchEngineSimplePrivate
 
 G_DEFINE_TYPE (GtkSearchEngineSimple, _gtk_search_engine_simple, GTK_TYPE_SEARCH_ENGINE);
 
+static void
+search_cache_free (SearchCache *cache)
+{
+  if (cache == NULL)
+    return;
+
+  g_free (cache->path);
+  g_strfreev (cache->words);
+  g_ptr_array_unref (cache->hits);
+  g_free (cache);
+}
+
 static void
 gtk_search_engine_simple_dispose (GObject *object)
 {
@@ -91,14 +151,45 @@ gtk_search_engine_simple_dispose (GObject *object)
       priv->active_search->cancelled = TRUE;
       priv->active_search = NULL;
     }
+
+  search_cache_free (priv->cache);
+  priv->cache = NULL;
   
   G_OBJECT_CLASS (_gtk_search_engine_simple_parent_class)->dispose (object);
 }
 
+/* Whether every hit of @words is also a hit of @old_words, which is
+ * the case if each old word is contained in one of the new ones.
+ */
+static gboolean
+words_refine (gchar **old_words,
+              gchar **words)
+{
+  gint i, j;
+
+  for (i = 0; old_words[i] != NULL; i++)
+    {
+      if (old_words[i][0] == '\0')
+        continue;
+
+      for (j = 0; words[j] != NULL; j++)
+        {
+          if (strstr (words[j], old_words[i]) != NULL)
+            break;
+        }
+
+      if (words[j] == NULL)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 static SearchThreadData *
 search_thread_data_new (GtkSearchEngineSimple *engine,
 			GtkQuery              *query)
 {
+  SearchCache *cache = engine->priv->cache;
   SearchThreadData *data;
   char *text, *lower, *uri;
   
@@ -119,6 +210,15 @@ search_thread_data_new (GtkSearchEngineSimple *engine,
   data->words = g_strsplit (lower, " ", -1);
   g_free (text);
   g_free (lower);
+
+  if (cache != NULL &&
+      g_get_monotonic_time () - cache->time < CACHE_LIFETIME &&
+      strcmp (cache->path, data->path) == 0 &&
+      words_refine (cache->words, data->words))
+    data->cached_hits = g_ptr_array_ref (cache->hits);
+
+  g_mutex_init (&data->lock);
+  data->all_hits = g_ptr_array_new_with_free_func (g_free);
   
   return data;
 }
@@ -129,6 +229,11 @@ search_thread_data_free (SearchThreadData *data)
   g_object_unref (data->engine);
   g_free (data->path);
   g_strfreev (data->words);
+  if (data->cached_hits)
+    g_ptr_array_unref (data->cached_hits);
+  if (data->all_hits)
+    g_ptr_array_unref (data->all_hits);
+  g_mutex_clear (&data->lock);
   g_free (data);
 }
 
@@ -136,13 +241,35 @@ static gboolean
 search_thread_done_idle (gpointer user_data)
 {
   SearchThreadData *data;
+  GtkSearchEngineSimplePrivate *priv;
 
   data = user_data;
+  priv = data->engine->priv;
   
   if (!data->cancelled)
-    _gtk_search_engine_finished (GTK_SEARCH_ENGINE (data->engine));
+    {
+      SearchCache *cache;
+
+      /* Keep the hits, so that refining the query doesn't
+       * need to walk the folders again
+       */
+      cache = g_new (SearchCache, 1);
+      cache->path = data->path;
+      cache->words = data->words;
+      cache->hits = data->all_hits;
+      cache->time = g_get_monotonic_time ();
+      data->path = NULL;
+      data->words = NULL;
+      data->all_hits = NULL;
+
+      search_cache_free (priv->cache);
+      priv->cache = cache;
+
+      _gtk_search_engine_finished (GTK_SEARCH_ENGINE (data->engine));
+    }
      
-  data->engine->priv->active_search = NULL;
+  if (priv->active_search == data)
+    priv->active_search = NULL;
   search_thread_data_free (data);
   
   return FALSE;
@@ -174,6 +301,7 @@ search_thread_add_hits_idle (gpointer user_data)
   return FALSE;
 }
 
+/* Called with data->lock held */
 static void
 send_batch (SearchThreadData *data)
 {
@@ -193,100 +321,302 @@ send_batch (SearchThreadData *data)
   data->uri_hits = NULL;
 }
 
-static GPrivate search_thread_data;
-
-#ifdef HAVE_FTW_H
-static int
-search_visit_func (const char        *fpath,
-		   const struct stat *sb,
-		   int                typeflag,
-		   struct FTW        *ftwbuf)
+static gboolean
+name_matches (SearchThreadData *data,
+              const gchar      *name)
 {
-  SearchThreadData *data;
-  gint i;
-  const gchar *name;
   gchar *lower_name;
-  gchar *uri;
   gboolean hit;
-  gboolean is_hidden;
-
-  data = (SearchThreadData*)g_private_get (&search_thread_data);
-
-  if (data->cancelled)
-#ifdef HAVE_GNU_FTW
-    return FTW_STOP;
-#else
-    return 1;
-#endif /* HAVE_GNU_FTW */
+  gint i;
 
-  name = strrchr (fpath, '/');
-  if (name)
-    name++;
-  else
-    name = fpath;
+  lower_name = g_ascii_strdown (name, -1);
 
-  is_hidden = *name == '.';
-	
-  hit = FALSE;
-  
-  if (!is_hidden) 
+  hit = TRUE;
+  for (i = 0; data->words[i] != NULL; i++) 
     {
-      lower_name = g_ascii_strdown (name, -1);
-      
-      hit = TRUE;
-      for (i = 0; data->words[i] != NULL; i++) 
-	{
-	  if (strstr (lower_name, data->words[i]) == NULL) 
-	    {
-	      hit = FALSE;
-	      break;
-	    }
-	}
-      g_free (lower_name);
+      if (strstr (lower_name, data->words[i]) == NULL) 
+        {
+          hit = FALSE;
+          break;
+        }
     }
+  g_free (lower_name);
+
+  return hit;
+}
+
+/* Reports the hits of one folder, or of the cache, and counts the
+ * files that were looked at. Takes ownership of @hits.
+ */
+static void
+add_hits (SearchThreadData *data,
+          GPtrArray        *hits,
+          gint              n_processed_files)
+{
+  guint i;
 
-  if (hit) 
+  g_mutex_lock (&data->lock);
+
+  for (i = 0; i < hits->len; i++)
     {
-      uri = g_filename_to_uri (fpath, NULL, NULL);
-      data->uri_hits = g_list_prepend (data->uri_hits, uri);
+      gchar *path = g_ptr_array_index (hits, i);
+
+      data->uri_hits = g_list_prepend (data->uri_hits,
+                                       g_filename_to_uri (path, NULL, NULL));
+      g_ptr_array_add (data->all_hits, path);
     }
 
-  data->n_processed_files++;
-  
+  data->n_processed_files += n_processed_files;
   if (data->n_processed_files > BATCH_SIZE)
     send_batch (data);
 
-#ifdef HAVE_GNU_FTW
-  if (is_hidden)
-    return FTW_SKIP_SUBTREE;
-  else
-    return FTW_CONTINUE;
-#else
-  return 0;
-#endif /* HAVE_GNU_FTW */
+  g_mutex_unlock (&data->lock);
+
+  g_ptr_array_free (hits, FALSE);
 }
-#endif /* HAVE_FTW_H */
+
+static void
+search_filter_cached_hits (SearchThreadData *data)
+{
+  GPtrArray *hits;
+  guint i;
+
+  hits = g_ptr_array_new ();
+
+  for (i = 0; i < data->cached_hits->len && !data->cancelled; i++)
+    {
+      const gchar *path = g_ptr_array_index (data->cached_hits, i);
+      gchar *name = g_path_get_basename (path);
+
+      if (name_matches (data, name))
+        g_ptr_array_add (hits, g_strdup (path));
+
+      g_free (name);
+    }
+
+  add_hits (data, hits, i);
+}
+
+#ifdef G_OS_UNIX
+
+static void
+walk_queue_push (WalkQueue   *queue,
+                 const gchar *path,
+                 gint         depth)
+{
+  WalkFolder *folder;
+
+  folder = g_slice_new (WalkFolder);
+  folder->path = g_strdup (path);
+  folder->depth = depth;
+
+  g_mutex_lock (&queue->lock);
+  g_queue_push_tail (&queue->folders, folder);
+  g_mutex_unlock (&queue->lock);
+}
+
+static WalkFolder *
+walk_next_folder (SearchThreadData *data,
+                  guint             walker)
+{
+  WalkFolder *folder;
+  guint i;
+
+  g_mutex_lock (&data->queues[walker].lock);
+  folder = g_queue_pop_tail (&data->queues[walker].folders);
+  g_mutex_unlock (&data->queues[walker].lock);
+
+  /* Steal the oldest folder of another walker; it is likely
+   * to have the largest subtree
+   */
+  for (i = 1; folder == NULL && i < data->n_queues; i++)
+    {
+      WalkQueue *queue = &data->queues[(walker + i) % data->n_queues];
+
+      g_mutex_lock (&queue->lock);
+      folder = g_queue_pop_head (&queue->folders);
+      g_mutex_unlock (&queue->lock);
+    }
+
+  return folder;
+}
+
+static void
+walk_folder (SearchThreadData *data,
+             guint             walker,
+             WalkFolder       *folder)
+{
+  GPtrArray *hits;
+  struct dirent *entry;
+  DIR *dir;
+  int fd;
+  gint n_processed_files = 0;
+
+  fd = open (folder->path, O_RDONLY | O_DIRECTORY | O_NOFOLLOW);
+  if (fd < 0)
+    return;
+
+  dir = fdopendir (fd);
+  if (dir == NULL)
+    {
+      close (fd);
+      return;
+    }
+
+  hits = g_ptr_array_new ();
+
+  while (!data->cancelled && (entry = readdir (dir)) != NULL)
+    {
+      const gchar *name = entry->d_name;
+      gchar *path;
+
+      /* Also skips "." and ".." */
+      if (name[0] == '.')
+        continue;
+
+      n_processed_files++;
+      path = NULL;
+
+      if (name_matches (data, name))
+        {
+          path = g_build_filename (folder->path, name, NULL);
+          g_ptr_array_add (hits, path);
+        }
+
+#ifdef _DIRENT_HAVE_D_TYPE
+      if (entry->d_type != DT_DIR && entry->d_type != DT_UNKNOWN)
+        continue;
+#endif
+
+      if (folder->depth + 1 < MAX_DEPTH)
+        {
+          struct stat st;
+
+          /* Symbolic links are not followed, and other file
+           * systems are not searched
+           */
+          if (fstatat (fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+            continue;
+
+          if (S_ISDIR (st.st_mode) && st.st_dev == data->device)
+            {
+              gchar *subfolder;
+
+              subfolder = path ? g_strdup (path) : g_build_filename (folder->path, name, NULL);
+              g_atomic_int_inc (&data->n_pending_folders);
+              walk_queue_push (&data->queues[walker], subfolder, folder->depth + 1);
+              g_free (subfolder);
+            }
+        }
+    }
+
+  closedir (dir);
+
+  add_hits (data, hits, n_processed_files);
+}
+
+typedef struct
+{
+  SearchThreadData *data;
+  guint walker;
+} Walker;
+
+static gpointer
+walker_thread_func (gpointer user_data)
+{
+  Walker *walker = user_data;
+  SearchThreadData *data = walker->data;
+
+  while (!data->cancelled && g_atomic_int_get (&data->n_pending_folders) > 0)
+    {
+      WalkFolder *folder;
+
+      folder = walk_next_folder (data, walker->walker);
+      if (folder == NULL)
+        {
+          /* Others are still reading folders that may have
+           * subfolders; wait for them to show up
+           */
+          g_usleep (100);
+          continue;
+        }
+
+      walk_folder (data, walker->walker, folder);
+      g_atomic_int_add (&data->n_pending_folders, -1);
+
+      g_free (folder->path);
+      g_slice_free (WalkFolder, folder);
+    }
+
+  return NULL;
+}
+
+static void
+search_walk (SearchThreadData *data)
+{
+  Walker walkers[MAX_WALKERS];
+  GThread *threads[MAX_WALKERS];
+  struct stat st;
+  WalkFolder *folder;
+  guint i;
+
+  if (stat (data->path, &st) != 0 || !S_ISDIR (st.st_mode))
+    return;
+
+  data->device = st.st_dev;
+  data->n_queues = CLAMP (g_get_num_processors (), 1, MAX_WALKERS);
+  for (i = 0; i < data->n_queues; i++)
+    {
+      g_mutex_init (&data->queues[i].lock);
+      g_queue_init (&data->queues[i].folders);
+      walkers[i].data = data;
+      walkers[i].walker = i;
+    }
+
+  data->n_pending_folders = 1;
+  walk_queue_push (&data->queues[0], data->path, 0);
+
+  for (i = 1; i < data->n_queues; i++)
+    threads[i] = g_thread_new ("file-search-walker", walker_thread_func, &walkers[i]);
+
+  walker_thread_func (&walkers[0]);
+
+  for (i = 1; i < data->n_queues; i++)
+    g_thread_join (threads[i]);
+
+  /* Left over when cancelled */
+  for (i = 0; i < data->n_queues; i++)
+    {
+      while ((folder = g_queue_pop_head (&data->queues[i].folders)) != NULL)
+        {
+          g_free (folder->path);
+          g_slice_free (WalkFolder, folder);
+        }
+      g_mutex_clear (&data->queues[i].lock);
+    }
+}
+
+#endif /* G_OS_UNIX */
 
 static gpointer 
 search_thread_func (gpointer user_data)
 {
-#ifdef HAVE_FTW_H
   SearchThreadData *data;
   
   data = user_data;
-  
-  g_private_set (&search_thread_data, data);
 
-  nftw (data->path, search_visit_func, 20,
-#ifdef HAVE_GNU_FTW
-        FTW_ACTIONRETVAL |
+  if (data->cached_hits)
+    search_filter_cached_hits (data);
+#ifdef G_OS_UNIX
+  else
+    search_walk (data);
 #endif
-        FTW_PHYS);
 
+  g_mutex_lock (&data->lock);
   send_batch (data);
+  g_mutex_unlock (&data->lock);
   
   gdk_threads_add_idle (search_thread_done_idle, data);
-#endif /* HAVE_FTW_H */
   
   return NULL;
 }
@@ -376,7 +706,7 @@ _gtk_search_engine_simple_init (GtkSearchEngineSimple *engine)
 GtkSearchEngine *
 _gtk_search_engine_simple_new (void)
 {
-#ifdef HAVE_FTW_H
+#ifdef G_OS_UNIX
   return g_object_new (GTK_TYPE_SEARCH_ENGINE_SIMPLE, NULL);
 #else
   return NULL;
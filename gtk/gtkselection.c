@@ -174,6 +174,7 @@ struct _GtkRetrievalInfo
   guint32 idle_time;		/* Number of seconds since we last heard
 				   from selection owner */
   guchar   *buffer;		/* Buffer in which to accumulate results */
+  gint	   buffer_size;		/* Allocated size of buffer */
   gint	   offset;		/* Current offset in buffer, -1 indicates
 				   not yet started */
   guint32 notify_time;		/* Timestamp from SelectionNotify */
@@ -1085,6 +1086,7 @@ gtk_selection_convert (GtkWidget *widget,
   info->target = target;
   info->idle_time = 0;
   info->buffer = NULL;
+  info->buffer_size = 0;
   info->offset = -1;
   
   /* Check if this process has current owner. If so, call handler
@@ -2421,6 +2423,7 @@ _gtk_selection_request (GtkWidget *widget,
       if (data.length < 0)
 	{
 	  info->conversions[i].property = GDK_NONE;
+	  info->conversions[i].offset = -1;
 	  continue;
 	}
       
@@ -2683,8 +2686,15 @@ gtk_selection_incr_timeout (GtkIncrInfo *info)
     {
       if (tmp_list && info->idle_time >= IDLE_ABORT_TIME)
 	{
+	  gint i;
+
 	  current_incrs = g_list_remove_link (current_incrs, tmp_list);
 	  g_list_free (tmp_list);
+
+	  /* The requestor gave up; drop the data we were still sending */
+	  for (i = 0; i < info->num_conversions; i++)
+	    if (info->conversions[i].offset >= 0)
+	      g_free (info->conversions[i].data.data);
 	}
       
       g_free (info->conversions);
@@ -2859,10 +2869,9 @@ _gtk_selection_property_notify (GtkWidget	*widget,
 				       &type, &format);
   gdk_property_delete (window, event->atom);
 
-  /* We could do a lot better efficiency-wise by paying attention to
-     what length was sent in the initial INCR transaction, instead of
-     doing memory allocation at every step. But its only guaranteed to
-     be a _lower bound_ (pretty useless!) */
+  /* The length sent in the initial INCR transaction is only a
+     _lower bound_, so grow the buffer geometrically instead; that
+     keeps the total copying linear in the size of the transfer. */
   
   if (length == 0 || type == GDK_NONE)		/* final zero length portion */
     {
@@ -2874,6 +2883,12 @@ _gtk_selection_property_notify (GtkWidget	*widget,
 				      (type == GDK_NONE) ?  NULL : info->buffer,
 				      (type == GDK_NONE) ?  -1 : info->offset,
 				      info->notify_time);
+
+      /* Don't hold on to a large transfer until the timeout runs */
+      g_free (info->buffer);
+      info->buffer = NULL;
+      info->buffer_size = 0;
+      g_free (new_buffer);
     }
   else				/* append on newly arrived data */
     {
@@ -2884,6 +2899,7 @@ _gtk_selection_property_notify (GtkWidget	*widget,
 		     length);
 #endif
 	  info->buffer = new_buffer;
+	  info->buffer_size = length + 1;
 	  info->offset = length;
 	}
       else
@@ -2893,8 +2909,14 @@ _gtk_selection_property_notify (GtkWidget	*widget,
 	  g_message ("Appending %d bytes at offset %d",
 		     length,info->offset);
 #endif
+	  if (info->offset + length + 1 > info->buffer_size)
+	    {
+	      info->buffer_size = MAX (2 * info->buffer_size,
+				       info->offset + length + 1);
+	      info->buffer = g_realloc (info->buffer, info->buffer_size);
+	    }
+
 	  /* We copy length+1 bytes to preserve guaranteed null termination */
-	  info->buffer = g_realloc (info->buffer, info->offset+length+1);
 	  memcpy (info->buffer + info->offset, new_buffer, length+1);
 	  info->offset += length;
 	  g_free (new_buffer);
@@ -117,6 +117,14 @@ struct _GtkSettingsPrivate
   GtkStyleProperties *style;
   GtkCssValue *default_font_family;
   GtkCssValue *default_font_size;
+
+  /* XSETTINGS changes are applied in one go, see
+   * _gtk_settings_handle_event()
+   */
+  guint apply_xsettings_id;
+  guint batching_notify      : 1;
+  guint pending_style_reset  : 1;
+  guint pending_style_update : 1;
 };
 
 typedef enum
@@ -137,6 +145,8 @@ struct _GtkSettingsPropertyValue
 {
   GValue value;
   GtkSettingsSource source;
+  /* The XSETTING string parsed on first access, if initialized */
+  GValue parsed_xsetting;
 };
 
 enum {
@@ -298,9 +308,9 @@ gtk_settings_init (GtkSettings *settings)
 
   priv->theme_provider = gtk_css_provider_new ();
 
-  /* build up property array for all yet existing properties and queue
-   * notification for them (at least notification for internal properties
-   * will instantly be caught)
+  /* build up property array for all yet existing properties. They are
+   * not notified; nothing can be listening yet and the screen isn't set,
+   * so values are only looked up (and XSETTINGS parsed) when first read.
    */
   pspecs = g_object_class_list_properties (G_OBJECT_GET_CLASS (settings), NULL);
   for (p = pspecs; *p; p++)
@@ -320,7 +330,6 @@ gtk_settings_init (GtkSettings *settings)
       g_value_init (&priv->property_values[i].value, value_type);
       g_param_value_set_default (pspec, &priv->property_values[i].value);
 
-      g_object_notify (G_OBJECT (settings), pspec->name);
       priv->property_values[i].source = GTK_SETTINGS_SOURCE_DEFAULT;
       i++;
     }
@@ -1618,9 +1627,16 @@ gtk_settings_finalize (GObject *object)
   object_list = g_slist_remove (object_list, settings);
 
   for (i = 0; i < class_n_properties; i++)
-    g_value_unset (&priv->property_values[i].value);
+    {
+      g_value_unset (&priv->property_values[i].value);
+      if (G_IS_VALUE (&priv->property_values[i].parsed_xsetting))
+        g_value_unset (&priv->property_values[i].parsed_xsetting);
+    }
   g_free (priv->property_values);
 
+  if (priv->apply_xsettings_id)
+    g_source_remove (priv->apply_xsettings_id);
+
   g_datalist_clear (&priv->queued_settings);
 
   settings_update_provider (priv->screen, &priv->theme_provider, NULL);
@@ -1804,16 +1820,24 @@ gtk_settings_get_property (GObject     *object,
     }
   else
     {
+      GtkSettingsPropertyValue *property_value = &priv->property_values[property_id - 1];
       GValue val = { 0, };
 
+      if (property_value->source != GTK_SETTINGS_SOURCE_APPLICATION &&
+          G_IS_VALUE (&property_value->parsed_xsetting))
+        {
+          g_value_copy (&property_value->parsed_xsetting, value);
+          return;
+        }
+
       /* Try to get xsetting as a string and parse it. */
 
       g_value_init (&val, G_TYPE_STRING);
 
-      if (priv->property_values[property_id - 1].source == GTK_SETTINGS_SOURCE_APPLICATION ||
+      if (property_value->source == GTK_SETTINGS_SOURCE_APPLICATION ||
           !gdk_screen_get_setting (priv->screen, pspec->name, &val))
         {
-          g_value_copy (&priv->property_values[property_id - 1].value, value);
+          g_value_copy (&property_value->value, value);
         }
       else
         {
@@ -1832,6 +1856,10 @@ gtk_settings_get_property (GObject     *object,
             {
               g_value_copy (&tmp_value, value);
               g_param_value_validate (pspec, value);
+
+              /* Keep it until the XSETTING changes */
+              g_value_init (&property_value->parsed_xsetting, G_VALUE_TYPE (value));
+              g_value_copy (value, &property_value->parsed_xsetting);
             }
           else
             {
@@ -1861,6 +1889,28 @@ settings_invalidate_style (GtkSettings *settings)
   _gtk_style_provider_private_changed (GTK_STYLE_PROVIDER_PRIVATE (settings));
 }
 
+/* Invalidates the settings style if @update_style and restyles all
+ * widgets. While a batch of XSETTINGS changes is applied, this only
+ * happens once, at the end.
+ */
+static void
+settings_reset_widgets (GtkSettings *settings,
+                        gboolean     update_style)
+{
+  GtkSettingsPrivate *priv = settings->priv;
+
+  if (priv->batching_notify)
+    {
+      priv->pending_style_reset = TRUE;
+      priv->pending_style_update |= update_style;
+      return;
+    }
+
+  if (update_style)
+    settings_invalidate_style (settings);
+  gtk_style_context_reset_widgets (priv->screen);
+}
+
 static void
 gtk_settings_notify (GObject    *object,
                      GParamSpec *pspec)
@@ -1883,12 +1933,10 @@ gtk_settings_notify (GObject    *object,
       break;
     case PROP_COLOR_SCHEME:
       settings_update_color_scheme (settings);
-      settings_invalidate_style (settings);
-      gtk_style_context_reset_widgets (priv->screen);
+      settings_reset_widgets (settings, TRUE);
       break;
     case PROP_FONT_NAME:
-      settings_invalidate_style (settings);
-      gtk_style_context_reset_widgets (priv->screen);
+      settings_reset_widgets (settings, TRUE);
       break;
     case PROP_KEY_THEME_NAME:
       settings_update_key_theme (settings);
@@ -1903,18 +1951,18 @@ gtk_settings_notify (GObject    *object,
        * widgets with gtk_widget_style_set(), and also causes more
        * recomputation than necessary.
        */
-      gtk_style_context_reset_widgets (priv->screen);
+      settings_reset_widgets (settings, FALSE);
       break;
     case PROP_XFT_ANTIALIAS:
     case PROP_XFT_HINTING:
     case PROP_XFT_HINTSTYLE:
     case PROP_XFT_RGBA:
       settings_update_font_options (settings);
-      gtk_style_context_reset_widgets (priv->screen);
+      settings_reset_widgets (settings, FALSE);
       break;
     case PROP_FONTCONFIG_TIMESTAMP:
       if (settings_update_fontconfig (settings))
-        gtk_style_context_reset_widgets (priv->screen);
+        settings_reset_widgets (settings, FALSE);
       break;
     case PROP_CURSOR_THEME_NAME:
     case PROP_CURSOR_THEME_SIZE:
@@ -2088,6 +2136,7 @@ settings_install_property_parser (GtkSettingsClass   *class,
 
       priv->property_values = g_renew (GtkSettingsPropertyValue, priv->property_values, class_n_properties);
       priv->property_values[class_n_properties - 1].value.g_type = 0;
+      priv->property_values[class_n_properties - 1].parsed_xsetting.g_type = 0;
       g_value_init (&priv->property_values[class_n_properties - 1].value, G_PARAM_SPEC_VALUE_TYPE (pspec));
       g_param_value_set_default (pspec, &priv->property_values[class_n_properties - 1].value);
       priv->property_values[class_n_properties - 1].source = GTK_SETTINGS_SOURCE_DEFAULT;
@@ -2634,22 +2683,66 @@ gtk_rc_property_parse_border (const GParamSpec *pspec,
   return success;
 }
 
+static gboolean
+apply_xsettings (gpointer data)
+{
+  GtkSettings *settings = data;
+  GtkSettingsPrivate *priv = settings->priv;
+
+  priv->apply_xsettings_id = 0;
+
+  /* Emits the notifications queued by _gtk_settings_handle_event() */
+  priv->batching_notify = TRUE;
+  g_object_thaw_notify (G_OBJECT (settings));
+  priv->batching_notify = FALSE;
+
+  if (priv->pending_style_reset)
+    {
+      gboolean update_style = priv->pending_style_update;
+
+      priv->pending_style_reset = FALSE;
+      priv->pending_style_update = FALSE;
+      settings_reset_widgets (settings, update_style);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+/* A change of the XSETTINGS manager property is delivered as one
+ * GDK_SETTING event per changed setting, all queued at once. Instead
+ * of restyling for each of them, notifications are held back until
+ * the events are drained and the widgets are reset only once.
+ */
 void
 _gtk_settings_handle_event (GdkEventSetting *event)
 {
   GdkScreen *screen;
   GtkSettings *settings;
+  GtkSettingsPrivate *priv;
   GParamSpec *pspec;
   guint property_id;
 
   screen = gdk_window_get_screen (event->window);
   settings = gtk_settings_get_for_screen (screen);
+  priv = settings->priv;
   pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (settings), event->name);
 
   if (pspec)
     {
       property_id = pspec->param_id;
 
+      if (property_id > 0 && property_id <= class_n_properties &&
+          G_IS_VALUE (&priv->property_values[property_id - 1].parsed_xsetting))
+        g_value_unset (&priv->property_values[property_id - 1].parsed_xsetting);
+
+      if (priv->apply_xsettings_id == 0)
+        {
+          g_object_freeze_notify (G_OBJECT (settings));
+          priv->apply_xsettings_id =
+            gdk_threads_add_idle_full (G_PRIORITY_HIGH_IDLE,
+                                       apply_xsettings, settings, NULL);
+        }
+
       if (property_id == PROP_COLOR_SCHEME)
         {
           GValue value = { 0, };
@@ -3028,6 +3121,7 @@ settings_update_theme (GtkSettings *settings)
   gchar *theme_name;
   gchar *theme_dir;
   gchar *path;
+  gint64 begin;
 
   g_object_get (settings,
                 "gtk-application-prefer-dark-theme", &prefer_dark_theme,
@@ -3035,9 +3129,11 @@ settings_update_theme (GtkSettings *settings)
 
   theme_name = get_theme_name (settings);
 
+  begin = gdk_profiler_begin_mark_libgtk_only ();
   _gtk_css_provider_load_named (priv->theme_provider,
                                 theme_name,
                                 prefer_dark_theme ? "dark" : NULL);
+  gdk_profiler_end_mark_libgtk_only (begin, "theme-load", theme_name);
 
   /* reload per-theme settings */
   theme_dir = _gtk_css_provider_get_theme_dir ();
@@ -3316,10 +3412,12 @@ gtk_settings_load_from_key_file (GtkSettings       *settings,
   gchar **keys;
   gsize n_keys;
   gint i;
+  gint64 begin;
 
   error = NULL;
   keys = NULL;
 
+  begin = gdk_profiler_begin_mark_libgtk_only ();
   keyfile = g_key_file_new ();
 
   if (!g_key_file_load_from_file (keyfile, path, G_KEY_FILE_NONE, &error))
@@ -3424,4 +3522,6 @@ gtk_settings_load_from_key_file (GtkSettings       *settings,
  out:
   g_strfreev (keys);
   g_key_file_free (keyfile);
+
+  gdk_profiler_end_mark_libgtk_only (begin, "settings-load", path);
 }
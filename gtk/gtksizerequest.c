@@ -271,6 +271,7 @@ gtk_widget_query_size_for_orientation (GtkWidget        *widget,
       _gtk_size_request_cache_commit (cache,
                                       orientation,
                                       for_size,
+                                      _gtk_widget_class_get_request_cache_size (widget_class),
                                       min_size,
                                       nat_size,
 				      min_baseline,
@@ -378,6 +379,94 @@ _gtk_widget_compute_size_for_orientation (GtkWidget        *widget,
     *natural = nat_result;
 }
 
+/* Queries every size that was cached in @old_cache, an earlier copy
+ * of the request cache of @widget, again. Returns %TRUE if any of the
+ * results, or the request mode, changed, ie if the parent would lay
+ * out @widget differently now.
+ *
+ * Only the widget's own sizes are compared, like the cache stores
+ * them. For a widget in size groups, the sizes of the groups cannot
+ * have changed if the widget's own sizes did not.
+ */
+gboolean
+_gtk_widget_remeasure (GtkWidget *widget,
+                       gpointer   old_cache)
+{
+  SizeRequestCache *old = old_cache;
+  gint min, nat, min_baseline, nat_baseline;
+  gboolean changed = FALSE;
+  guint i;
+
+  if (old->request_mode_valid &&
+      gtk_widget_get_request_mode (widget) != old->request_mode)
+    changed = TRUE;
+
+  if (!changed && old->flags[GTK_ORIENTATION_HORIZONTAL].cached_size_valid)
+    {
+      gtk_widget_query_size_for_orientation (widget, GTK_ORIENTATION_HORIZONTAL, -1,
+                                             &min, &nat, NULL, NULL);
+      changed = min != old->cached_size_x.minimum_size ||
+                nat != old->cached_size_x.natural_size;
+    }
+
+  if (!changed && old->flags[GTK_ORIENTATION_VERTICAL].cached_size_valid)
+    {
+      gtk_widget_query_size_for_orientation (widget, GTK_ORIENTATION_VERTICAL, -1,
+                                             &min, &nat, &min_baseline, &nat_baseline);
+      changed = min != old->cached_size_y.minimum_size ||
+                nat != old->cached_size_y.natural_size ||
+                min_baseline != old->cached_size_y.minimum_baseline ||
+                nat_baseline != old->cached_size_y.natural_baseline;
+    }
+
+  /* Both ends of a cached range must still give the same result */
+  for (i = 0; !changed && i < old->flags[GTK_ORIENTATION_HORIZONTAL].n_cached_requests; i++)
+    {
+      SizeRequestX *request = old->requests_x[i];
+
+      gtk_widget_query_size_for_orientation (widget, GTK_ORIENTATION_HORIZONTAL,
+                                             request->lower_for_size,
+                                             &min, &nat, NULL, NULL);
+      changed = min != request->cached_size.minimum_size ||
+                nat != request->cached_size.natural_size;
+
+      if (!changed && request->upper_for_size != request->lower_for_size)
+        {
+          gtk_widget_query_size_for_orientation (widget, GTK_ORIENTATION_HORIZONTAL,
+                                                 request->upper_for_size,
+                                                 &min, &nat, NULL, NULL);
+          changed = min != request->cached_size.minimum_size ||
+                    nat != request->cached_size.natural_size;
+        }
+    }
+
+  for (i = 0; !changed && i < old->flags[GTK_ORIENTATION_VERTICAL].n_cached_requests; i++)
+    {
+      SizeRequestY *request = old->requests_y[i];
+
+      gtk_widget_query_size_for_orientation (widget, GTK_ORIENTATION_VERTICAL,
+                                             request->lower_for_size,
+                                             &min, &nat, &min_baseline, &nat_baseline);
+      changed = min != request->cached_size.minimum_size ||
+                nat != request->cached_size.natural_size ||
+                min_baseline != request->cached_size.minimum_baseline ||
+                nat_baseline != request->cached_size.natural_baseline;
+
+      if (!changed && request->upper_for_size != request->lower_for_size)
+        {
+          gtk_widget_query_size_for_orientation (widget, GTK_ORIENTATION_VERTICAL,
+                                                 request->upper_for_size,
+                                                 &min, &nat, &min_baseline, &nat_baseline);
+          changed = min != request->cached_size.minimum_size ||
+                    nat != request->cached_size.natural_size ||
+                    min_baseline != request->cached_size.minimum_baseline ||
+                    nat_baseline != request->cached_size.natural_baseline;
+        }
+    }
+
+  return changed;
+}
+
 /**
  * gtk_widget_get_request_mode:
  * @widget: a #GtkWidget instance
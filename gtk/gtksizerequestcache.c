@@ -25,6 +25,12 @@
 
 #include <string.h>
 
+#include <gdk/gdk.h>
+
+/* Hit and miss counts since the last _gtk_size_request_cache_report() */
+static guint n_hits = 0;
+static guint n_misses = 0;
+
 void
 _gtk_size_request_cache_init (SizeRequestCache *cache)
 {
@@ -32,34 +38,36 @@ _gtk_size_request_cache_init (SizeRequestCache *cache)
 }
 
 static void
-free_sizes_x (SizeRequestX **sizes)
+free_sizes_x (SizeRequestX **sizes,
+              guint          n_sizes)
 {
-  gint i;
+  guint i;
 
-  for (i = 0; i < GTK_SIZE_REQUEST_CACHED_SIZES && sizes[i] != NULL; i++)
+  for (i = 0; i < n_sizes && sizes[i] != NULL; i++)
     g_slice_free (SizeRequestX, sizes[i]);
 
-  g_slice_free1 (sizeof (SizeRequestY *) * GTK_SIZE_REQUEST_CACHED_SIZES, sizes);
+  g_slice_free1 (sizeof (SizeRequestX *) * n_sizes, sizes);
 }
 
 static void
-free_sizes_y (SizeRequestY **sizes)
+free_sizes_y (SizeRequestY **sizes,
+              guint          n_sizes)
 {
-  gint i;
+  guint i;
 
-  for (i = 0; i < GTK_SIZE_REQUEST_CACHED_SIZES && sizes[i] != NULL; i++)
+  for (i = 0; i < n_sizes && sizes[i] != NULL; i++)
     g_slice_free (SizeRequestY, sizes[i]);
 
-  g_slice_free1 (sizeof (SizeRequestY *) * GTK_SIZE_REQUEST_CACHED_SIZES, sizes);
+  g_slice_free1 (sizeof (SizeRequestY *) * n_sizes, sizes);
 }
 
 void
 _gtk_size_request_cache_free (SizeRequestCache *cache)
 {
   if (cache->requests_x)
-    free_sizes_x (cache->requests_x);
-  if (cache->requests_x)
-    free_sizes_y (cache->requests_y);
+    free_sizes_x (cache->requests_x, cache->max_cached_requests);
+  if (cache->requests_y)
+    free_sizes_y (cache->requests_y, cache->max_cached_requests);
 }
 
 void
@@ -69,10 +77,30 @@ _gtk_size_request_cache_clear (SizeRequestCache *cache)
   _gtk_size_request_cache_init (cache);
 }
 
+/* The for_size entries are kept in most recently used order, so that
+ * the entry that gets evicted when the cache is full is the one that
+ * was not looked at for the longest time. This moves entry @i to the
+ * front.
+ */
+static void
+move_to_front (gpointer *sizes,
+               guint     i)
+{
+  gpointer size;
+
+  if (i == 0)
+    return;
+
+  size = sizes[i];
+  memmove (sizes + 1, sizes, sizeof (gpointer) * i);
+  sizes[0] = size;
+}
+
 void
 _gtk_size_request_cache_commit (SizeRequestCache *cache,
                                 GtkOrientation    orientation,
                                 gint              for_size,
+                                guint             max_sizes,
                                 gint              minimum_size,
                                 gint              natural_size,
 				gint              minimum_baseline,
@@ -106,13 +134,19 @@ _gtk_size_request_cache_commit (SizeRequestCache *cache,
       return;
     }
 
+  /* The limit is fixed once the first for_size array is allocated,
+   * both arrays have the same length.
+   */
+  if (cache->requests_x == NULL && cache->requests_y == NULL)
+    cache->max_cached_requests = CLAMP (max_sizes, 1, GTK_SIZE_REQUEST_MAX_CACHED_SIZES);
+  max_sizes = cache->max_cached_requests;
+
   /* Check if the minimum_size and natural_size is already
    * in the cache and if this result can be used to extend
    * that cache entry 
    */
   n_sizes = cache->flags[orientation].n_cached_requests;
 
-
   if (orientation == GTK_ORIENTATION_HORIZONTAL)
     {
       SizeRequestX **cached_sizes;
@@ -126,31 +160,25 @@ _gtk_size_request_cache_commit (SizeRequestCache *cache,
 	    {
 	      cached_sizes[i]->lower_for_size = MIN (cached_sizes[i]->lower_for_size, for_size);
 	      cached_sizes[i]->upper_for_size = MAX (cached_sizes[i]->upper_for_size, for_size);
+	      move_to_front ((gpointer *) cached_sizes, i);
 	      return;
 	    }
 	}
 
-      /* If not found, pull a new size from the cache, the returned size cache
-       * will immediately be used to cache the new computed size so we go ahead
-       * and increment the last_cached_request right away */
-      if (n_sizes < GTK_SIZE_REQUEST_CACHED_SIZES)
-	{
-	  cache->flags[orientation].n_cached_requests++;
-	  cache->flags[orientation].last_cached_request = cache->flags[orientation].n_cached_requests - 1;
-	}
-      else
-	{
-	  if (++cache->flags[orientation].last_cached_request == GTK_SIZE_REQUEST_CACHED_SIZES)
-	    cache->flags[orientation].last_cached_request = 0;
-	}
-
       if (cache->requests_x == NULL)
-	cache->requests_x = g_slice_alloc0 (sizeof (SizeRequestX *) * GTK_SIZE_REQUEST_CACHED_SIZES);
+	cache->requests_x = g_slice_alloc0 (sizeof (SizeRequestX *) * max_sizes);
+
+      /* If not found, take a free slot or reuse the least recently
+       * used entry, and move it to the front */
+      if (n_sizes < max_sizes)
+	cache->flags[orientation].n_cached_requests = ++n_sizes;
 
-      if (cache->requests_x[cache->flags[orientation].last_cached_request] == NULL)
-	cache->requests_x[cache->flags[orientation].last_cached_request] = g_slice_new (SizeRequestX);
+      if (cache->requests_x[n_sizes - 1] == NULL)
+	cache->requests_x[n_sizes - 1] = g_slice_new (SizeRequestX);
 
-      cached_size = cache->requests_x[cache->flags[orientation].last_cached_request];
+      move_to_front ((gpointer *) cache->requests_x, n_sizes - 1);
+
+      cached_size = cache->requests_x[0];
       cached_size->lower_for_size = for_size;
       cached_size->upper_for_size = for_size;
       cached_size->cached_size.minimum_size = minimum_size;
@@ -171,31 +199,25 @@ _gtk_size_request_cache_commit (SizeRequestCache *cache,
 	    {
 	      cached_sizes[i]->lower_for_size = MIN (cached_sizes[i]->lower_for_size, for_size);
 	      cached_sizes[i]->upper_for_size = MAX (cached_sizes[i]->upper_for_size, for_size);
+	      move_to_front ((gpointer *) cached_sizes, i);
 	      return;
 	    }
 	}
 
-      /* If not found, pull a new size from the cache, the returned size cache
-       * will immediately be used to cache the new computed size so we go ahead
-       * and increment the last_cached_request right away */
-      if (n_sizes < GTK_SIZE_REQUEST_CACHED_SIZES)
-	{
-	  cache->flags[orientation].n_cached_requests++;
-	  cache->flags[orientation].last_cached_request = cache->flags[orientation].n_cached_requests - 1;
-	}
-      else
-	{
-	  if (++cache->flags[orientation].last_cached_request == GTK_SIZE_REQUEST_CACHED_SIZES)
-	    cache->flags[orientation].last_cached_request = 0;
-	}
-
       if (cache->requests_y == NULL)
-	cache->requests_y = g_slice_alloc0 (sizeof (SizeRequestY *) * GTK_SIZE_REQUEST_CACHED_SIZES);
+	cache->requests_y = g_slice_alloc0 (sizeof (SizeRequestY *) * max_sizes);
+
+      /* If not found, take a free slot or reuse the least recently
+       * used entry, and move it to the front */
+      if (n_sizes < max_sizes)
+	cache->flags[orientation].n_cached_requests = ++n_sizes;
 
-      if (cache->requests_y[cache->flags[orientation].last_cached_request] == NULL)
-	cache->requests_y[cache->flags[orientation].last_cached_request] = g_slice_new (SizeRequestY);
+      if (cache->requests_y[n_sizes - 1] == NULL)
+	cache->requests_y[n_sizes - 1] = g_slice_new (SizeRequestY);
 
-      cached_size = cache->requests_y[cache->flags[orientation].last_cached_request];
+      move_to_front ((gpointer *) cache->requests_y, n_sizes - 1);
+
+      cached_size = cache->requests_y[0];
       cached_size->lower_for_size = for_size;
       cached_size->upper_for_size = for_size;
       cached_size->cached_size.minimum_size = minimum_size;
@@ -241,6 +263,7 @@ _gtk_size_request_cache_lookup (SizeRequestCache *cache,
 		  cur->upper_for_size >= for_size)
 		{
 		  result = &cur->cached_size;
+		  move_to_front ((gpointer *) cache->requests_x, i);
 		  break;
 		}
 	    }
@@ -248,6 +271,7 @@ _gtk_size_request_cache_lookup (SizeRequestCache *cache,
 
       if (result)
 	{
+	  n_hits++;
 	  *minimum = result->minimum_size;
 	  *natural = result->natural_size;
 	  *minimum_baseline = -1;
@@ -255,7 +279,10 @@ _gtk_size_request_cache_lookup (SizeRequestCache *cache,
 	  return TRUE;
 	}
       else
-	return FALSE;
+	{
+	  n_misses++;
+	  return FALSE;
+	}
     }
   else
     {
@@ -279,6 +306,7 @@ _gtk_size_request_cache_lookup (SizeRequestCache *cache,
 		  cur->upper_for_size >= for_size)
 		{
 		  result = &cur->cached_size;
+		  move_to_front ((gpointer *) cache->requests_y, i);
 		  break;
 		}
 	    }
@@ -286,6 +314,7 @@ _gtk_size_request_cache_lookup (SizeRequestCache *cache,
 
       if (result)
 	{
+	  n_hits++;
 	  *minimum = result->minimum_size;
 	  *natural = result->natural_size;
 	  *minimum_baseline = result->minimum_baseline;
@@ -293,7 +322,38 @@ _gtk_size_request_cache_lookup (SizeRequestCache *cache,
 	  return TRUE;
 	}
       else
-	return FALSE;
+	{
+	  n_misses++;
+	  return FALSE;
+	}
     }
 }
 
+/* Hands the number of cache hits and misses since the last call to
+ * the profiler, and resets them. Called once per layout phase.
+ */
+void
+_gtk_size_request_cache_report (void)
+{
+  static guint hits_counter = 0;
+  static guint misses_counter = 0;
+  gint64 now;
+
+  if (n_hits == 0 && n_misses == 0)
+    return;
+
+  if (hits_counter == 0)
+    {
+      hits_counter = gdk_profiler_define_int_counter_libgtk_only ("size-request-cache-hits",
+                                                                  "Size requests answered from the cache per layout");
+      misses_counter = gdk_profiler_define_int_counter_libgtk_only ("size-request-cache-misses",
+                                                                    "Size requests computed per layout");
+    }
+
+  now = g_get_monotonic_time ();
+  gdk_profiler_set_int_counter_libgtk_only (hits_counter, now * 1000, n_hits);
+  gdk_profiler_set_int_counter_libgtk_only (misses_counter, now * 1000, n_misses);
+
+  n_hits = 0;
+  n_misses = 0;
+}
@@ -38,6 +38,12 @@ G_BEGIN_DECLS
  */
 #define GTK_SIZE_REQUEST_CACHED_SIZES   (5)
 
+/* Widget classes that get asked for many different for_sizes
+ * during a resize, like wrapping labels, can ask for more, see
+ * _gtk_widget_class_set_request_cache_size().
+ */
+#define GTK_SIZE_REQUEST_MAX_CACHED_SIZES (15)
+
 typedef struct {
   gint minimum_size;
   gint natural_size;
@@ -73,9 +79,9 @@ typedef struct {
 
   GtkSizeRequestMode request_mode   : 3;
   guint       request_mode_valid    : 1;
+  guint       max_cached_requests   : 4;
   struct {
-    guint       n_cached_requests   : 3;
-    guint       last_cached_request : 3;
+    guint       n_cached_requests   : 4;
     guint       cached_size_valid   : 1;
   }           flags[2];
 } SizeRequestCache;
@@ -87,6 +93,7 @@ void            _gtk_size_request_cache_clear                   (SizeRequestCach
 void            _gtk_size_request_cache_commit                  (SizeRequestCache       *cache,
                                                                  GtkOrientation          orientation,
                                                                  gint                    for_size,
+                                                                 guint                   max_sizes,
                                                                  gint                    minimum_size,
                                                                  gint                    natural_size,
                                                                  gint                    minimum_baseline,
@@ -98,6 +105,7 @@ gboolean        _gtk_size_request_cache_lookup                  (SizeRequestCach
                                                                  gint                   *natural,
                                                                  gint                   *minimum_baseline,
                                                                  gint                   *natural_baseline);
+void            _gtk_size_request_cache_report                  (void);
 
 G_END_DECLS
 
@@ -125,6 +125,7 @@ typedef struct {
   GtkStackChildInfo *last_visible_child;
   cairo_surface_t *last_visible_surface;
   GtkAllocation last_visible_surface_allocation;
+  GtkWidget *cached_child;
   gdouble transition_pos;
   guint tick_id;
   gint64 start_time;
@@ -715,6 +716,41 @@ get_bin_window_y (GtkStack      *stack,
   return y;
 }
 
+/* During crossfade and under transitions the incoming child is drawn
+ * again on every frame, although only the way it is blended changes.
+ * Keeping its output around for the duration of the transition saves
+ * redoing its ::draw; anything the child changes still shows up, as
+ * queueing a redraw drops the cached output.
+ */
+static void
+gtk_stack_cache_visible_child (GtkStack *stack)
+{
+  GtkStackPrivate *priv = gtk_stack_get_instance_private (stack);
+  GtkWidget *child;
+
+  if (priv->cached_child != NULL || priv->visible_child == NULL)
+    return;
+
+  child = priv->visible_child->widget;
+  if (!gtk_widget_get_cache_draw (child))
+    {
+      gtk_widget_set_cache_draw (child, TRUE);
+      priv->cached_child = child;
+    }
+}
+
+static void
+gtk_stack_uncache_child (GtkStack *stack)
+{
+  GtkStackPrivate *priv = gtk_stack_get_instance_private (stack);
+
+  if (priv->cached_child != NULL)
+    {
+      gtk_widget_set_cache_draw (priv->cached_child, FALSE);
+      priv->cached_child = NULL;
+    }
+}
+
 static gboolean
 gtk_stack_set_transition_position (GtkStack *stack,
                                    gdouble   pos)
@@ -723,7 +759,6 @@ gtk_stack_set_transition_position (GtkStack *stack,
   gboolean done;
 
   priv->transition_pos = pos;
-  gtk_widget_queue_draw (GTK_WIDGET (stack));
 
   if (priv->bin_window != NULL &&
       (priv->active_transition_type == GTK_STACK_TRANSITION_TYPE_SLIDE_LEFT ||
@@ -737,9 +772,23 @@ gtk_stack_set_transition_position (GtkStack *stack,
     {
       GtkAllocation allocation;
       gtk_widget_get_allocation (GTK_WIDGET (stack), &allocation);
+
+      /* Moving the bin window copies what is already drawn of the new
+       * child, so only the newly exposed part of it gets redrawn. The
+       * old child is painted from its snapshot on the view window,
+       * which only needs a redraw if the snapshot moves too.
+       */
       gdk_window_move (priv->bin_window,
                        get_bin_window_x (stack, &allocation), get_bin_window_y (stack, &allocation));
+
+      if (priv->active_transition_type == GTK_STACK_TRANSITION_TYPE_SLIDE_LEFT ||
+          priv->active_transition_type == GTK_STACK_TRANSITION_TYPE_SLIDE_RIGHT ||
+          priv->active_transition_type == GTK_STACK_TRANSITION_TYPE_SLIDE_UP ||
+          priv->active_transition_type == GTK_STACK_TRANSITION_TYPE_SLIDE_DOWN)
+        gdk_window_invalidate_rect (priv->view_window, NULL, FALSE);
     }
+  else
+    gtk_widget_queue_draw (GTK_WIDGET (stack));
 
   done = pos >= 1.0;
 
@@ -754,6 +803,8 @@ gtk_stack_set_transition_position (GtkStack *stack,
 
   if (done)
     {
+      gtk_stack_uncache_child (stack);
+
       if (priv->last_visible_surface != NULL)
         {
           cairo_surface_destroy (priv->last_visible_surface);
@@ -869,6 +920,14 @@ gtk_stack_start_transition (GtkStack               *stack,
       priv->start_time = gdk_frame_clock_get_frame_time (gtk_widget_get_frame_clock (widget));
       priv->end_time = priv->start_time + (transition_duration * 1000);
       priv->active_transition_type = effective_transition_type (stack, transition_type);
+
+      if (priv->active_transition_type == GTK_STACK_TRANSITION_TYPE_CROSSFADE ||
+          priv->active_transition_type == GTK_STACK_TRANSITION_TYPE_UNDER_UP ||
+          priv->active_transition_type == GTK_STACK_TRANSITION_TYPE_UNDER_DOWN ||
+          priv->active_transition_type == GTK_STACK_TRANSITION_TYPE_UNDER_LEFT ||
+          priv->active_transition_type == GTK_STACK_TRANSITION_TYPE_UNDER_RIGHT)
+        gtk_stack_cache_visible_child (stack);
+
       gtk_stack_schedule_ticks (stack);
     }
   else
@@ -907,6 +966,8 @@ set_visible_child (GtkStack               *stack,
   if (child_info == priv->visible_child)
     return;
 
+  gtk_stack_uncache_child (stack);
+
   if (priv->last_visible_child)
     gtk_widget_set_child_visible (priv->last_visible_child->widget, FALSE);
   priv->last_visible_child = NULL;
@@ -85,6 +85,7 @@ typedef struct _GtkStylePrivate GtkStylePrivate;
 struct _GtkStylePrivate {
   GtkStyleContext *context;
   gulong context_changed_id;
+  guint needs_update : 1;
 };
 
 enum {
@@ -721,6 +722,7 @@ gtk_style_update_from_context (GtkStyle *style)
   gint i;
 
   priv = GTK_STYLE_GET_PRIVATE (style);
+  priv->needs_update = FALSE;
 
   for (state = GTK_STATE_NORMAL; state <= GTK_STATE_INSENSITIVE; state++)
     {
@@ -792,11 +794,31 @@ gtk_style_update_from_context (GtkStyle *style)
     }
 }
 
+/* Most widgets never look at their GtkStyle after it was created,
+ * so only copy the values out of the context once it is used again.
+ */
 static void
 style_context_changed (GtkStyleContext *context,
                        gpointer         user_data)
 {
-  gtk_style_update_from_context (GTK_STYLE (user_data));
+  GtkStylePrivate *priv;
+
+  priv = GTK_STYLE_GET_PRIVATE (user_data);
+  priv->needs_update = TRUE;
+}
+
+/* Brings the fields of @style up to date with its context, if the
+ * context changed since they were last filled in.
+ */
+void
+_gtk_style_ensure_updated (GtkStyle *style)
+{
+  GtkStylePrivate *priv;
+
+  priv = GTK_STYLE_GET_PRIVATE (style);
+
+  if (priv->needs_update)
+    gtk_style_update_from_context (style);
 }
 
 static void
@@ -831,6 +853,8 @@ gtk_style_copy (GtkStyle *style)
   GtkStyle *new_style;
   
   g_return_val_if_fail (GTK_IS_STYLE (style), NULL);
+
+  _gtk_style_ensure_updated (style);
   
   new_style = GTK_STYLE_GET_CLASS (style)->clone (style);
   GTK_STYLE_GET_CLASS (style)->copy (new_style, style);
@@ -688,6 +688,7 @@ GtkStyle*     _gtk_style_new_for_path        (GdkScreen          *screen,
 void          _gtk_style_shade               (const GdkColor     *a,
                                               GdkColor           *b,
                                               gdouble             k);
+void          _gtk_style_ensure_updated      (GtkStyle           *style);
 
 gboolean   gtk_style_has_context    (GtkStyle *style);
 
@@ -19,11 +19,17 @@
 
 #include "gtkstylecascadeprivate.h"
 
+#include "gtkcsscomputedvaluesprivate.h"
 #include "gtkstyleprovider.h"
 #include "gtkstyleproviderprivate.h"
+#include "gtkwidgetpathprivate.h"
+
+/* Number of cached styles at which we start looking for unused ones */
+#define GTK_STYLE_CASCADE_CACHE_PRUNE_SIZE 256
 
 typedef struct _GtkStyleCascadeIter GtkStyleCascadeIter;
 typedef struct _GtkStyleProviderData GtkStyleProviderData;
+typedef struct _GtkStyleCacheKey GtkStyleCacheKey;
 
 struct _GtkStyleCascadeIter {
   int parent_index; /* pointing at last index that was returned, not next one that should be returned */
@@ -37,6 +43,67 @@ struct _GtkStyleProviderData
   guint changed_signal_id;
 };
 
+struct _GtkStyleCacheKey
+{
+  GtkWidgetPath *path;
+  GtkStateFlags state;
+  int scale;
+  GtkCssComputedValues *parent_values;
+};
+
+static GtkStyleCacheKey *
+style_cache_key_new (const GtkWidgetPath  *path,
+                     GtkStateFlags         state,
+                     int                   scale,
+                     GtkCssComputedValues *parent_values)
+{
+  GtkStyleCacheKey *key;
+
+  key = g_slice_new (GtkStyleCacheKey);
+  key->path = gtk_widget_path_ref ((GtkWidgetPath *) path);
+  key->state = state;
+  key->scale = scale;
+  key->parent_values = parent_values ? g_object_ref (parent_values) : NULL;
+
+  return key;
+}
+
+static void
+style_cache_key_free (gpointer data)
+{
+  GtkStyleCacheKey *key = data;
+
+  gtk_widget_path_unref (key->path);
+  if (key->parent_values)
+    g_object_unref (key->parent_values);
+
+  g_slice_free (GtkStyleCacheKey, key);
+}
+
+static guint
+style_cache_key_hash (gconstpointer data)
+{
+  const GtkStyleCacheKey *key = data;
+
+  return _gtk_widget_path_hash (key->path)
+         ^ (key->state << 8)
+         ^ key->scale
+         ^ g_direct_hash (key->parent_values);
+}
+
+static gboolean
+style_cache_key_equal (gconstpointer data1,
+                       gconstpointer data2)
+{
+  const GtkStyleCacheKey *key1 = data1;
+  const GtkStyleCacheKey *key2 = data2;
+
+  return key1->state == key2->state &&
+         key1->scale == key2->scale &&
+         key1->parent_values == key2->parent_values &&
+         _gtk_widget_path_equal (key1->path, key2->path);
+}
+
 static GtkStyleProvider *
 gtk_style_cascade_iter_next (GtkStyleCascade     *cascade,
                              GtkStyleCascadeIter *iter)
@@ -273,6 +340,21 @@ gtk_style_cascade_get_change (GtkStyleProviderPrivate *provider,
   return change;
 }
 
+static void
+gtk_style_cascade_clear_style_cache (GtkStyleCascade *cascade)
+{
+  if (cascade->style_cache)
+    g_hash_table_remove_all (cascade->style_cache);
+}
+
+static void
+gtk_style_cascade_changed (GtkStyleProviderPrivate *provider)
+{
+  /* Every change of the cascade may change the result of a lookup,
+   * so none of the shared styles can be trusted anymore. */
+  gtk_style_cascade_clear_style_cache (GTK_STYLE_CASCADE (provider));
+}
+
 static void
 gtk_style_cascade_provider_private_iface_init (GtkStyleProviderPrivateInterface *iface)
 {
@@ -281,6 +363,7 @@ gtk_style_cascade_provider_private_iface_init (GtkStyleProviderPrivateInterface
   iface->get_keyframes = gtk_style_cascade_get_keyframes;
   iface->lookup = gtk_style_cascade_lookup;
   iface->get_change = gtk_style_cascade_get_change;
+  iface->changed = gtk_style_cascade_changed;
 }
 
 G_DEFINE_TYPE_EXTENDED (GtkStyleCascade, _gtk_style_cascade, G_TYPE_OBJECT, 0,
@@ -296,6 +379,11 @@ gtk_style_cascade_dispose (GObject *object)
 
   _gtk_style_cascade_set_parent (cascade, NULL);
   g_array_unref (cascade->providers);
+  if (cascade->style_cache)
+    {
+      g_hash_table_unref (cascade->style_cache);
+      cascade->style_cache = NULL;
+    }
 
   G_OBJECT_CLASS (_gtk_style_cascade_parent_class)->dispose (object);
 }
@@ -381,6 +469,8 @@ _gtk_style_cascade_set_parent (GtkStyleCascade *cascade,
     }
 
   cascade->parent = parent;
+
+  gtk_style_cascade_clear_style_cache (cascade);
 }
 
 void
@@ -438,3 +528,115 @@ _gtk_style_cascade_remove_provider (GtkStyleCascade  *cascade,
     }
 }
 
+
+/*
+ * _gtk_style_cascade_lookup_style:
+ * @cascade: a #GtkStyleCascade
+ * @path: the path that was used to look up the style
+ * @state: the state flags that were used for matching
+ * @scale: the scale the values were computed for
+ * @parent_values: (allow-none): the values of the parent style
+ *
+ * Looks for computed values previously added with
+ * _gtk_style_cascade_add_style() for the same arguments. This allows
+ * style contexts with identical paths to share their styles instead
+ * of each of them doing selector matching and computing values.
+ *
+ * The returned values are shared and must not be modified.
+ *
+ * Returns: (transfer full) (allow-none): the shared values or %NULL
+ */
+GtkCssComputedValues *
+_gtk_style_cascade_lookup_style (GtkStyleCascade      *cascade,
+                                 const GtkWidgetPath  *path,
+                                 GtkStateFlags         state,
+                                 int                   scale,
+                                 GtkCssComputedValues *parent_values)
+{
+  GtkStyleCacheKey key;
+  GtkCssComputedValues *values;
+
+  g_return_val_if_fail (GTK_IS_STYLE_CASCADE (cascade), NULL);
+  g_return_val_if_fail (path != NULL, NULL);
+
+  if (cascade->style_cache == NULL)
+    return NULL;
+
+  key.path = (GtkWidgetPath *) path;
+  key.state = state;
+  key.scale = scale;
+  key.parent_values = parent_values;
+
+  values = g_hash_table_lookup (cascade->style_cache, &key);
+  if (values == NULL)
+    return NULL;
+
+  return g_object_ref (values);
+}
+
+static gboolean
+style_cache_entry_is_unused (gpointer key,
+                             gpointer value,
+                             gpointer unused)
+{
+  /* only the cache holds a reference */
+  return G_OBJECT (value)->ref_count == 1;
+}
+
+/*
+ * _gtk_style_cascade_add_style:
+ * @cascade: a #GtkStyleCascade
+ * @path: the path that was used to look up the style
+ * @state: the state flags that were used for matching
+ * @scale: the scale the values were computed for
+ * @parent_values: (allow-none): the values of the parent style
+ * @values: the computed values
+ *
+ * Adds @values to the cache of shared styles. From now on, @values
+ * must be treated as immutable, because others may be using it.
+ * This is the case for values that do not run animations or
+ * transitions and that were computed from immutable @parent_values.
+ *
+ * The cache is cleared whenever @cascade changes.
+ */
+void
+_gtk_style_cascade_add_style (GtkStyleCascade      *cascade,
+                              const GtkWidgetPath  *path,
+                              GtkStateFlags         state,
+                              int                   scale,
+                              GtkCssComputedValues *parent_values,
+                              GtkCssComputedValues *values)
+{
+  g_return_if_fail (GTK_IS_STYLE_CASCADE (cascade));
+  g_return_if_fail (path != NULL);
+  g_return_if_fail (GTK_IS_CSS_COMPUTED_VALUES (values));
+
+  if (cascade->style_cache == NULL)
+    {
+      cascade->style_cache = g_hash_table_new_full (style_cache_key_hash,
+                                                    style_cache_key_equal,
+                                                    style_cache_key_free,
+                                                    g_object_unref);
+      cascade->style_cache_prune_size = GTK_STYLE_CASCADE_CACHE_PRUNE_SIZE;
+    }
+
+  g_hash_table_replace (cascade->style_cache,
+                        style_cache_key_new (path, state, scale, parent_values),
+                        g_object_ref (values));
+
+  if (g_hash_table_size (cascade->style_cache) >= cascade->style_cache_prune_size)
+    {
+      g_hash_table_foreach_remove (cascade->style_cache,
+                                   style_cache_entry_is_unused,
+                                   NULL);
+      /* Dropping unused values may have released parent values that are
+       * only kept alive by their children's keys, so loop until stable. */
+      while (g_hash_table_foreach_remove (cascade->style_cache,
+                                          style_cache_entry_is_unused,
+                                          NULL) > 0)
+        ;
+
+      cascade->style_cache_prune_size = MAX (GTK_STYLE_CASCADE_CACHE_PRUNE_SIZE,
+                                             2 * g_hash_table_size (cascade->style_cache));
+    }
+}
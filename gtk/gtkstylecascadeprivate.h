@@ -20,6 +20,7 @@
 
 #include <gdk/gdk.h>
 #include <gtk/gtkstyleproviderprivate.h>
+#include "gtk/gtkcsstypesprivate.h"
 
 G_BEGIN_DECLS
 
@@ -39,6 +40,9 @@ struct _GtkStyleCascade
 
   GtkStyleCascade *parent;
   GArray *providers;
+
+  GHashTable *style_cache;        /* (path, state, scale, parent values) => shared GtkCssComputedValues */
+  guint style_cache_prune_size;
 };
 
 struct _GtkStyleCascadeClass
@@ -60,6 +64,17 @@ void                  _gtk_style_cascade_add_provider           (GtkStyleCascade
 void                  _gtk_style_cascade_remove_provider        (GtkStyleCascade     *cascade,
                                                                  GtkStyleProvider    *provider);
 
+GtkCssComputedValues *_gtk_style_cascade_lookup_style           (GtkStyleCascade     *cascade,
+                                                                 const GtkWidgetPath *path,
+                                                                 GtkStateFlags        state,
+                                                                 int                  scale,
+                                                                 GtkCssComputedValues *parent_values);
+void                  _gtk_style_cascade_add_style              (GtkStyleCascade     *cascade,
+                                                                 const GtkWidgetPath *path,
+                                                                 GtkStateFlags        state,
+                                                                 int                  scale,
+                                                                 GtkCssComputedValues *parent_values,
+                                                                 GtkCssComputedValues *values);
 
 G_END_DECLS
 
@@ -349,6 +349,7 @@ struct StyleData
   GtkCssComputedValues *store;
   GArray *property_cache;
   guint ref_count;
+  guint shared : 1;     /* store is shared via the cascade and must not be modified */
 };
 
 struct _GtkStyleContextPrivate
@@ -366,14 +367,16 @@ struct _GtkStyleContextPrivate
   gint scale;
 
   GdkFrameClock *frame_clock;
-  guint frame_clock_update_id;
 
   GtkCssChange relevant_changes;
+  GtkCssChange subtree_changes;   /* union of relevant changes of all descendants */
   GtkCssChange pending_changes;
 
   const GtkBitmask *invalidating_context;
   guint animating : 1;
+  guint ticking : 1;
   guint invalid : 1;
+  guint deferred : 1;   /* validation was skipped while the widget was hidden */
 };
 
 enum {
@@ -726,6 +729,9 @@ gtk_style_context_init (GtkStyleContext *style_context)
   priv->screen = gdk_screen_get_default ();
   priv->relevant_changes = GTK_CSS_CHANGE_ANY;
 
+  _gtk_counter_add (GTK_COUNTER_STYLE_CONTEXTS, 1);
+  priv->subtree_changes = GTK_CSS_CHANGE_ANY;
+
   /* Create default info store */
   priv->info = style_info_new ();
   priv->info->state_flags = GTK_STATE_FLAG_DIR_LTR;
@@ -734,11 +740,26 @@ gtk_style_context_init (GtkStyleContext *style_context)
                                  _gtk_style_cascade_get_for_screen (priv->screen));
 }
 
+/* All animating style contexts sharing a frame clock are ticked from
+ * a single handler, so a frame with many animations costs one signal
+ * emission and one restyle of the toplevel.
+ */
+typedef struct {
+  GPtrArray *contexts;
+  gulong update_id;
+} AnimationTicker;
+
+static GQuark quark_animation_ticker = 0;
+
 static void
-gtk_style_context_update (GdkFrameClock  *clock,
-                          GtkStyleContext *context)
+animation_ticker_update (GdkFrameClock   *clock,
+                         AnimationTicker *ticker)
 {
-  _gtk_style_context_queue_invalidate (context, GTK_CSS_CHANGE_ANIMATE);
+  guint i;
+
+  for (i = 0; i < ticker->contexts->len; i++)
+    _gtk_style_context_queue_invalidate (g_ptr_array_index (ticker->contexts, i),
+                                         GTK_CSS_CHANGE_ANIMATE);
 }
 
 static gboolean
@@ -753,29 +774,54 @@ static void
 gtk_style_context_disconnect_update (GtkStyleContext *context)
 {
   GtkStyleContextPrivate *priv = context->priv;
+  AnimationTicker *ticker;
 
-  if (priv->frame_clock && priv->frame_clock_update_id)
-    {
-      g_signal_handler_disconnect (priv->frame_clock,
-                                   priv->frame_clock_update_id);
-      priv->frame_clock_update_id = 0;
-      gdk_frame_clock_end_updating (priv->frame_clock);
-    }
+  if (priv->frame_clock == NULL || !priv->ticking)
+    return;
+
+  priv->ticking = FALSE;
+
+  ticker = g_object_get_qdata (G_OBJECT (priv->frame_clock), quark_animation_ticker);
+  g_ptr_array_remove_fast (ticker->contexts, context);
+  if (ticker->contexts->len > 0)
+    return;
+
+  g_signal_handler_disconnect (priv->frame_clock, ticker->update_id);
+  gdk_frame_clock_end_updating (priv->frame_clock);
+  g_object_set_qdata (G_OBJECT (priv->frame_clock), quark_animation_ticker, NULL);
+
+  g_ptr_array_free (ticker->contexts, TRUE);
+  g_slice_free (AnimationTicker, ticker);
 }
 
 static void
 gtk_style_context_connect_update (GtkStyleContext *context)
 {
   GtkStyleContextPrivate *priv = context->priv;
+  AnimationTicker *ticker;
+
+  if (priv->frame_clock == NULL || priv->ticking)
+    return;
+
+  priv->ticking = TRUE;
+
+  if (G_UNLIKELY (quark_animation_ticker == 0))
+    quark_animation_ticker = g_quark_from_static_string ("gtk-style-context-animation-ticker");
 
-  if (priv->frame_clock && priv->frame_clock_update_id == 0)
+  ticker = g_object_get_qdata (G_OBJECT (priv->frame_clock), quark_animation_ticker);
+  if (ticker == NULL)
     {
-      priv->frame_clock_update_id = g_signal_connect (priv->frame_clock,
-                                                      "update",
-                                                      G_CALLBACK (gtk_style_context_update),
-                                                      context);
+      ticker = g_slice_new (AnimationTicker);
+      ticker->contexts = g_ptr_array_new ();
+      ticker->update_id = g_signal_connect (priv->frame_clock,
+                                            "update",
+                                            G_CALLBACK (animation_ticker_update),
+                                            ticker);
       gdk_frame_clock_begin_updating (priv->frame_clock);
+      g_object_set_qdata (G_OBJECT (priv->frame_clock), quark_animation_ticker, ticker);
     }
+
+  g_ptr_array_add (ticker->contexts, context);
 }
 
 static void
@@ -865,6 +911,8 @@ gtk_style_context_finalize (GObject *object)
   while (priv->info)
     priv->info = style_info_pop (priv->info);
 
+  _gtk_counter_add (GTK_COUNTER_STYLE_CONTEXTS, -1);
+
   G_OBJECT_CLASS (gtk_style_context_parent_class)->finalize (object);
 }
 
@@ -975,22 +1023,22 @@ create_query_path (GtkStyleContext *context,
 }
 
 static void
-build_properties (GtkStyleContext      *context,
-                  GtkCssComputedValues *values,
-                  GtkStyleInfo         *info,
-                  const GtkBitmask     *relevant_changes)
+build_properties_for_path (GtkStyleContext      *context,
+                           GtkCssComputedValues *values,
+                           const GtkWidgetPath  *path,
+                           GtkStateFlags         state,
+                           GtkCssComputedValues *parent_values,
+                           const GtkBitmask     *relevant_changes)
 {
   GtkStyleContextPrivate *priv;
   GtkCssMatcher matcher;
-  GtkWidgetPath *path;
   GtkCssLookup *lookup;
 
   priv = context->priv;
 
-  path = create_query_path (context, info);
   lookup = _gtk_css_lookup_new (relevant_changes);
 
-  if (_gtk_css_matcher_init (&matcher, path, info->state_flags))
+  if (_gtk_css_matcher_init (&matcher, path, state))
     _gtk_style_provider_private_lookup (GTK_STYLE_PROVIDER_PRIVATE (priv->cascade),
                                         &matcher,
                                         lookup);
@@ -999,9 +1047,108 @@ build_properties (GtkStyleContext      *context,
                            GTK_STYLE_PROVIDER_PRIVATE (priv->cascade),
 			   priv->scale,
                            values,
-                           priv->parent ? style_data_lookup (priv->parent)->store : NULL);
+                           parent_values);
 
   _gtk_css_lookup_free (lookup);
+}
+
+static void
+build_properties (GtkStyleContext      *context,
+                  GtkCssComputedValues *values,
+                  GtkStyleInfo         *info,
+                  const GtkBitmask     *relevant_changes)
+{
+  GtkStyleContextPrivate *priv;
+  GtkWidgetPath *path;
+
+  priv = context->priv;
+
+  path = create_query_path (context, info);
+
+  build_properties_for_path (context,
+                             values,
+                             path,
+                             info->state_flags,
+                             priv->parent ? style_data_lookup (priv->parent)->store : NULL,
+                             relevant_changes);
+
+  gtk_widget_path_free (path);
+}
+
+/* Fills in data->store, either by reusing values another context
+ * with an identical path computed or by computing them ourselves.
+ */
+static void
+style_data_compute (GtkStyleContext *context,
+                    StyleData       *data,
+                    GtkStyleInfo    *info)
+{
+  GtkStyleContextPrivate *priv;
+  GtkCssComputedValues *parent_values;
+  GtkWidgetPath *path;
+  gboolean shareable;
+
+  priv = context->priv;
+
+  g_assert (data->store == NULL);
+
+  /* Sharing only works if our parent's values are immutable, too.
+   * Otherwise they might get updated in place and the shared values
+   * would not reflect that. */
+  if (priv->parent)
+    {
+      StyleData *parent_data = style_data_lookup (priv->parent);
+
+      parent_values = parent_data->store;
+      shareable = parent_data->shared;
+    }
+  else
+    {
+      parent_values = NULL;
+      shareable = TRUE;
+    }
+
+  if (G_UNLIKELY (gtk_get_debug_flags () & GTK_DEBUG_NO_CSS_CACHE))
+    shareable = FALSE;
+
+  path = create_query_path (context, info);
+
+  if (shareable)
+    {
+      data->store = _gtk_style_cascade_lookup_style (priv->cascade,
+                                                     path,
+                                                     info->state_flags,
+                                                     priv->scale,
+                                                     parent_values);
+      if (data->store)
+        {
+          data->shared = TRUE;
+          gtk_widget_path_free (path);
+          return;
+        }
+    }
+
+  data->store = _gtk_css_computed_values_new ();
+  data->shared = FALSE;
+  build_properties_for_path (context,
+                             data->store,
+                             path,
+                             info->state_flags,
+                             parent_values,
+                             NULL);
+
+  /* Values that may animate get modified in place, so they can't be shared */
+  if (shareable && !_gtk_css_computed_values_may_animate (data->store))
+    {
+      _gtk_style_cascade_add_style (priv->cascade,
+                                    path,
+                                    info->state_flags,
+                                    priv->scale,
+                                    parent_values,
+                                    data->store);
+      data->shared = TRUE;
+    }
+
   gtk_widget_path_free (path);
 }
 
@@ -1029,14 +1176,12 @@ style_data_lookup (GtkStyleContext *context)
     }
 
   data = style_data_new ();
-  data->store = _gtk_css_computed_values_new ();
+  style_data_compute (context, data, info);
   style_info_set_data (info, data);
   g_hash_table_insert (priv->style_data,
                        style_info_copy (info),
                        data);
 
-  build_properties (context, data->store, info, NULL);
-
   return data;
 }
 
@@ -1057,6 +1202,24 @@ style_data_lookup_for_state (GtkStyleContext *context,
   return data;
 }
 
+/* Call this whenever the relevant changes of @context or any of its
+ * descendants become unknown, so our ancestors stop skipping us
+ * during validation.
+ */
+static void
+gtk_style_context_reset_subtree_changes (GtkStyleContext *context)
+{
+  GtkStyleContext *parent;
+
+  for (parent = context->priv->parent; parent; parent = parent->priv->parent)
+    {
+      if (parent->priv->subtree_changes == GTK_CSS_CHANGE_ANY)
+        break;
+
+      parent->priv->subtree_changes = GTK_CSS_CHANGE_ANY;
+    }
+}
+
 static void
 gtk_style_context_set_invalid (GtkStyleContext *context,
                                gboolean         invalid)
@@ -1324,7 +1487,8 @@ gtk_style_context_remove_provider_for_screen (GdkScreen        *screen,
  * location might not be available for various reasons, such as the
  * property being overridden, @property not naming a supported CSS
  * property or tracking of definitions being disabled for performance
- * reasons.
+ * reasons. Definitions are only tracked when running with
+ * <literal>GTK_DEBUG=css-sections</literal>.
  *
  * Shorthand CSS properties cannot be queried for a location and will
  * always return %NULL.
@@ -1703,6 +1867,8 @@ gtk_style_context_set_parent (GtkStyleContext *context,
 
   priv->parent = parent;
 
+  gtk_style_context_reset_subtree_changes (context);
+
   g_object_notify (G_OBJECT (context), "parent");
   _gtk_style_context_queue_invalidate (context, GTK_CSS_CHANGE_ANY_PARENT | GTK_CSS_CHANGE_ANY_SIBLING);
 }
@@ -3106,6 +3272,7 @@ gtk_style_context_update_cache (GtkStyleContext  *context,
                                 const GtkBitmask *parent_changes)
 {
   GtkStyleContextPrivate *priv;
+  GtkCssComputedValues *parent_values;
   GHashTableIter iter;
   gpointer key, value;
 
@@ -3113,6 +3280,7 @@ gtk_style_context_update_cache (GtkStyleContext  *context,
     return;
 
   priv = context->priv;
+  parent_values = priv->parent ? style_data_lookup (priv->parent)->store : NULL;
 
   g_hash_table_iter_init (&iter, priv->style_data);
   while (g_hash_table_iter_next (&iter, &key, &value))
@@ -3124,7 +3292,27 @@ gtk_style_context_update_cache (GtkStyleContext  *context,
       changes = _gtk_css_computed_values_compute_dependencies (data->store, parent_changes);
 
       if (!_gtk_bitmask_is_empty (changes))
-	build_properties (context, data->store, info, changes);
+        {
+          if (data->shared)
+            {
+              /* Others use these values, so we can't update them in place.
+               * But siblings with the same path will likely find the
+               * new values in the cascade already. */
+              g_object_unref (data->store);
+              data->store = NULL;
+              style_data_compute (context, data, info);
+            }
+          else
+            {
+              /* Values that are just copies of the parent's values don't
+               * need a lookup, so only do one for the rest. */
+              if (parent_values)
+                changes = _gtk_css_computed_values_update_inherited (data->store, parent_values, changes);
+
+              if (!_gtk_bitmask_is_empty (changes))
+                build_properties (context, data->store, info, changes);
+            }
+        }
 
       _gtk_bitmask_free (changes);
     }
@@ -3179,6 +3367,7 @@ gtk_style_context_needs_full_revalidate (GtkStyleContext  *context,
   if (change & GTK_STYLE_CONTEXT_RADICAL_CHANGE)
     {
       priv->relevant_changes = GTK_CSS_CHANGE_ANY;
+      gtk_style_context_reset_subtree_changes (context);
     }
   else
     {
@@ -3230,6 +3419,62 @@ gtk_style_context_should_create_transitions (GtkStyleContext *context)
   return animate;
 }
 
+/* Checks if validating @context would neither change its values nor
+ * those of any of its descendants so we can skip the whole subtree.
+ */
+static gboolean
+gtk_style_context_can_skip_validate (GtkStyleContext  *context,
+                                     GtkCssChange      change,
+                                     const GtkBitmask *parent_changes)
+{
+  GtkStyleContextPrivate *priv = context->priv;
+
+  if (priv->invalid || priv->pending_changes || priv->deferred)
+    return FALSE;
+
+  if (priv->info->data == NULL)
+    return FALSE;
+
+  if (!_gtk_bitmask_is_empty (parent_changes))
+    return FALSE;
+
+  if (change & GTK_CSS_CHANGE_FORCE_INVALIDATE)
+    return FALSE;
+
+  if (G_UNLIKELY (gtk_get_debug_flags () & GTK_DEBUG_NO_CSS_CACHE))
+    return FALSE;
+
+  if (priv->relevant_changes & change)
+    return FALSE;
+
+  if (priv->subtree_changes & _gtk_css_change_for_child (change))
+    return FALSE;
+
+  return TRUE;
+}
+
+/* Hidden widgets are neither measured nor drawn, so there is no point
+ * in keeping their styles up to date. Their subtree is validated
+ * again once they are shown, see _gtk_style_context_validate_deferred().
+ */
+static gboolean
+gtk_style_context_can_defer_validate (GtkStyleContext *context)
+{
+  GtkStyleContextPrivate *priv = context->priv;
+
+  if (priv->widget == NULL)
+    return FALSE;
+
+  /* The first lookup happens on demand anyway */
+  if (priv->info->data == NULL)
+    return FALSE;
+
+  if (G_UNLIKELY (gtk_get_debug_flags () & GTK_DEBUG_NO_CSS_CACHE))
+    return FALSE;
+
+  return !gtk_widget_get_visible (priv->widget);
+}
+
 void
 _gtk_style_context_validate (GtkStyleContext  *context,
                              gint64            timestamp,
@@ -3240,6 +3485,7 @@ _gtk_style_context_validate (GtkStyleContext  *context,
   GtkStyleInfo *info;
   StyleData *current;
   GtkBitmask *changes;
+  GtkCssChange subtree_changes;
   GSList *list;
 
   g_return_if_fail (GTK_IS_STYLE_CONTEXT (context));
@@ -3247,6 +3493,7 @@ _gtk_style_context_validate (GtkStyleContext  *context,
   priv = context->priv;
 
   change |= priv->pending_changes;
+  priv->deferred = FALSE;
   
   /* If you run your application with
    *   GTK_DEBUG=no-css-cache
@@ -3353,14 +3600,51 @@ _gtk_style_context_validate (GtkStyleContext  *context,
     }
 
   change = _gtk_css_change_for_child (change);
+  subtree_changes = 0;
   for (list = priv->children; list; list = list->next)
     {
-      _gtk_style_context_validate (list->data, timestamp, change, changes);
+      GtkStyleContext *child = list->data;
+
+      if (gtk_style_context_can_skip_validate (child, change, changes))
+        ;
+      else if (gtk_style_context_can_defer_validate (child))
+        {
+          /* Keep the pending changes, but let new invalidations
+           * below the child propagate */
+          child->priv->deferred = TRUE;
+          gtk_style_context_set_invalid (child, FALSE);
+        }
+      else
+        _gtk_style_context_validate (child, timestamp, change, changes);
+
+      subtree_changes |= child->priv->relevant_changes | child->priv->subtree_changes;
     }
+  priv->subtree_changes = subtree_changes;
 
   _gtk_bitmask_free (changes);
 }
 
+/**
+ * _gtk_style_context_validate_deferred:
+ * @context: a #GtkStyleContext
+ *
+ * Queues a full validation of @context if validating it was skipped
+ * while its widget was hidden. The changes it missed aren't known, so
+ * everything is looked up again.
+ **/
+void
+_gtk_style_context_validate_deferred (GtkStyleContext *context)
+{
+  g_return_if_fail (GTK_IS_STYLE_CONTEXT (context));
+
+  if (!context->priv->deferred)
+    return;
+
+  /* An invalid context doesn't propagate new invalidations */
+  gtk_style_context_set_invalid (context, FALSE);
+  _gtk_style_context_queue_invalidate (context, GTK_CSS_CHANGE_SOURCE);
+}
+
 void
 _gtk_style_context_queue_invalidate (GtkStyleContext *context,
                                      GtkCssChange     change)
@@ -3660,6 +3944,73 @@ gtk_style_context_get_margin (GtkStyleContext *context,
   margin->right = right;
 }
 
+/* The font description of a computed style, together with the values
+ * it was built from. Computed values are immutable, so as long as the
+ * store still holds the same values (animations replace them), the
+ * description is still correct and can be returned without building
+ * it again.
+ */
+typedef struct {
+  PangoFontDescription *description;
+  GtkCssValue *values[5];
+} FontCache;
+
+static const guint font_cache_properties[5] = {
+  GTK_CSS_PROPERTY_FONT_FAMILY,
+  GTK_CSS_PROPERTY_FONT_SIZE,
+  GTK_CSS_PROPERTY_FONT_STYLE,
+  GTK_CSS_PROPERTY_FONT_VARIANT,
+  GTK_CSS_PROPERTY_FONT_WEIGHT
+};
+
+static void
+font_cache_free (FontCache *cache)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (cache->values); i++)
+    {
+      if (cache->values[i])
+        _gtk_css_value_unref (cache->values[i]);
+    }
+
+  pango_font_description_free (cache->description);
+  g_slice_free (FontCache, cache);
+}
+
+static gboolean
+font_cache_is_valid (FontCache            *cache,
+                     GtkCssComputedValues *values)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (cache->values); i++)
+    {
+      if (cache->values[i] != _gtk_css_computed_values_get_value (values, font_cache_properties[i]))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+font_cache_update (FontCache            *cache,
+                   GtkCssComputedValues *values)
+{
+  GtkCssValue *value;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (cache->values); i++)
+    {
+      value = _gtk_css_computed_values_get_value (values, font_cache_properties[i]);
+      if (value)
+        _gtk_css_value_ref (value);
+      if (cache->values[i])
+        _gtk_css_value_unref (cache->values[i]);
+      cache->values[i] = value;
+    }
+}
+
 /**
  * gtk_style_context_get_font:
  * @context: a #GtkStyleContext
@@ -3681,7 +4032,8 @@ gtk_style_context_get_font (GtkStyleContext *context,
 {
   GtkStyleContextPrivate *priv;
   StyleData *data;
-  PangoFontDescription *description, *previous;
+  PangoFontDescription *description;
+  FontCache *cache;
 
   g_return_val_if_fail (GTK_IS_STYLE_CONTEXT (context), NULL);
 
@@ -3692,24 +4044,30 @@ gtk_style_context_get_font (GtkStyleContext *context,
 
   /* Yuck, fonts are created on-demand but we don't return a ref.
    * Do bad things to achieve this requirement */
+  cache = g_object_get_data (G_OBJECT (data->store), "font-cache-for-get_font");
+  if (cache && font_cache_is_valid (cache, data->store))
+    return cache->description;
+
   gtk_style_context_get (context, state, "font", &description, NULL);
-  
-  previous = g_object_get_data (G_OBJECT (data->store), "font-cache-for-get_font");
 
-  if (previous)
+  if (cache)
     {
-      pango_font_description_merge (previous, description, TRUE);
+      pango_font_description_merge (cache->description, description, TRUE);
       pango_font_description_free (description);
-      description = previous;
+      description = cache->description;
     }
   else
     {
+      cache = g_slice_new0 (FontCache);
+      cache->description = description;
       g_object_set_data_full (G_OBJECT (data->store),
                               "font-cache-for-get_font",
-                              description,
-                              (GDestroyNotify) pango_font_description_free);
+                              cache,
+                              (GDestroyNotify) font_cache_free);
     }
 
+  font_cache_update (cache, data->store);
+
   return description;
 }
 
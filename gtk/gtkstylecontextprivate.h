@@ -42,6 +42,7 @@ void           _gtk_style_context_validate                   (GtkStyleContext *c
                                                               gint64           timestamp,
                                                               GtkCssChange     change,
                                                               const GtkBitmask*parent_changes);
+void           _gtk_style_context_validate_deferred          (GtkStyleContext *context);
 void           _gtk_style_context_queue_invalidate           (GtkStyleContext *context,
                                                               GtkCssChange     change);
 gboolean       _gtk_style_context_check_region_name          (const gchar     *str);
@@ -213,6 +213,15 @@ struct _GtkTextBTree {
   guint end_iter_segment_stamp;
   
   GHashTable *child_anchor_table;
+
+  /* Range of text, in char offsets, whose redisplay is delayed
+   * because of an open tag batch; tag_batch_start is -1 if the
+   * range is empty.
+   */
+  guint tag_batch_depth;
+  gint tag_batch_start;
+  gint tag_batch_end;
+  guint tag_batch_affects_size : 1;
 };
 
 
@@ -263,6 +272,7 @@ static gboolean          gtk_text_btree_node_has_tag             (GtkTextBTreeNo
                                                                   GtkTextTag       *tag);
 
 static void             segments_changed                (GtkTextBTree     *tree);
+static void             flush_tag_batch                 (GtkTextBTree     *tree);
 static void             chars_changed                   (GtkTextBTree     *tree);
 static void             summary_list_destroy            (Summary          *summary);
 static GtkTextLine     *gtk_text_line_new               (void);
@@ -412,6 +422,7 @@ _gtk_text_btree_new (GtkTextTagTable *table,
   tree->root_node = root_node;
   tree->table = table;
   tree->views = NULL;
+  tree->tag_batch_start = -1;
 
   /* Set these to values that are unlikely to be found
    * in random memory garbage, and also avoid
@@ -756,6 +767,9 @@ _gtk_text_btree_delete (GtkTextIter *start,
  
   if (gtk_get_debug_flags () & GTK_DEBUG_TEXT)
     _gtk_text_btree_check (tree);
+
+  /* Char offsets of a pending tag batch are about to change */
+  flush_tag_batch (tree);
   
   /* Broadcast the need for redisplay before we break the iterators */
   DV (g_print ("invalidating due to deleting some text (%s)\n", G_STRLOC));
@@ -1086,6 +1100,39 @@ _gtk_text_btree_delete (GtkTextIter *start,
   gtk_text_btree_resolve_bidi (start, end);
 }
 
+/* Like pango_find_paragraph_boundary(), but skips over the text
+ * before the next candidate delimiter a byte at a time instead of
+ * a character at a time, which matters for very long inserts.
+ * Pango still looks at the delimiter itself, so "\r\n" and friends
+ * are handled exactly as before.
+ */
+static void
+find_paragraph_boundary (const gchar *text,
+                         gint         len,
+                         gint        *delim,
+                         gint        *eol)
+{
+  const guchar *p = (const guchar *) text;
+  const guchar *end = p + len;
+
+  while (p < end)
+    {
+      if (*p == '\n' || *p == '\r')
+        break;
+
+      /* U+2029 PARAGRAPH SEPARATOR */
+      if (*p == 0xe2 && end - p >= 3 && p[1] == 0x80 && p[2] == 0xa9)
+        break;
+
+      p++;
+    }
+
+  pango_find_paragraph_boundary ((const gchar *) p, end - p, delim, eol);
+
+  *delim += (const gchar *) p - text;
+  *eol += (const gchar *) p - text;
+}
+
 void
 _gtk_text_btree_insert (GtkTextIter *iter,
                         const gchar *text,
@@ -1130,6 +1177,8 @@ _gtk_text_btree_insert (GtkTextIter *iter,
   start_line = line;
   start_byte_index = gtk_text_iter_get_line_index (iter);
 
+  flush_tag_batch (tree);
+
   /* Get our insertion segment split. Note this assumes line allows
    * char insertions, which isn't true of the "last" line. But iter
    * should not be on that line, as we assert here.
@@ -1156,10 +1205,10 @@ _gtk_text_btree_insert (GtkTextIter *iter,
     {
       sol = eol;
       
-      pango_find_paragraph_boundary (text + sol,
-                                     len - sol,
-                                     &delim,
-                                     &eol);      
+      find_paragraph_boundary (text + sol,
+                               len - sol,
+                               &delim,
+                               &eol);
 
       /* make these relative to the start of the text */
       delim += sol;
@@ -1269,6 +1318,8 @@ insert_pixbuf_or_widget_segment (GtkTextIter        *iter,
   tree = _gtk_text_iter_get_btree (iter);
   start_byte_offset = gtk_text_iter_get_line_index (iter);
 
+  flush_tag_batch (tree);
+
   prevPtr = gtk_text_line_segment_split (iter);
   if (prevPtr == NULL)
     {
@@ -1743,6 +1794,32 @@ queue_tag_redisplay (GtkTextBTree      *tree,
                      const GtkTextIter *start,
                      const GtkTextIter *end)
 {
+  if (tree->tag_batch_depth > 0)
+    {
+      gboolean affects_size = _gtk_text_tag_affects_size (tag);
+
+      if (affects_size || _gtk_text_tag_affects_nonsize_appearance (tag))
+        {
+          gint start_offset = gtk_text_iter_get_offset (start);
+          gint end_offset = gtk_text_iter_get_offset (end);
+
+          if (tree->tag_batch_start < 0)
+            {
+              tree->tag_batch_start = start_offset;
+              tree->tag_batch_end = end_offset;
+            }
+          else
+            {
+              tree->tag_batch_start = MIN (tree->tag_batch_start, start_offset);
+              tree->tag_batch_end = MAX (tree->tag_batch_end, end_offset);
+            }
+
+          tree->tag_batch_affects_size |= affects_size;
+        }
+
+      return;
+    }
+
   if (_gtk_text_tag_affects_size (tag))
     {
       DV (g_print ("invalidating due to size-affecting tag (%s)\n", G_STRLOC));
@@ -1757,6 +1834,54 @@ queue_tag_redisplay (GtkTextBTree      *tree,
   /* We don't need to do anything if the tag doesn't affect display */
 }
 
+static void
+flush_tag_batch (GtkTextBTree *tree)
+{
+  GtkTextIter start, end;
+
+  if (tree->tag_batch_start < 0)
+    return;
+
+  _gtk_text_btree_get_iter_at_char (tree, &start, tree->tag_batch_start);
+  _gtk_text_btree_get_iter_at_char (tree, &end, tree->tag_batch_end);
+
+  if (tree->tag_batch_affects_size)
+    {
+      DV (g_print ("invalidating due to a tag batch (%s)\n", G_STRLOC));
+      _gtk_text_btree_invalidate_region (tree, &start, &end, FALSE);
+    }
+  else
+    redisplay_region (tree, &start, &end, FALSE);
+
+  tree->tag_batch_start = -1;
+  tree->tag_batch_affects_size = FALSE;
+}
+
+/*
+ * _gtk_text_btree_begin_tag_batch:
+ * @tree: a #GtkTextBTree
+ *
+ * Until the matching _gtk_text_btree_end_tag_batch(), tagging text
+ * doesn't invalidate or redisplay the tagged range; instead, the
+ * union of all tagged ranges is invalidated once at the end. Calls
+ * nest.
+ */
+void
+_gtk_text_btree_begin_tag_batch (GtkTextBTree *tree)
+{
+  tree->tag_batch_depth++;
+}
+
+void
+_gtk_text_btree_end_tag_batch (GtkTextBTree *tree)
+{
+  g_return_if_fail (tree->tag_batch_depth > 0);
+
+  tree->tag_batch_depth--;
+  if (tree->tag_batch_depth == 0)
+    flush_tag_batch (tree);
+}
+
 void
 _gtk_text_btree_tag (const GtkTextIter *start_orig,
                      const GtkTextIter *end_orig,
@@ -4154,7 +4279,11 @@ _gtk_text_line_byte_to_char_offsets (GtkTextLine *line,
 
   if (seg->type == &gtk_text_char_type)
     {
-      *seg_char_offset = g_utf8_strlen (seg->body.chars, offset);
+      /* Optimize the case where no chars use > 1 byte */
+      if (seg->byte_count == seg->char_count)
+        *seg_char_offset = offset;
+      else
+        *seg_char_offset = g_utf8_strlen (seg->body.chars, offset);
 
       g_assert (*seg_char_offset < seg->char_count);
 
@@ -4201,8 +4330,11 @@ _gtk_text_line_char_to_byte_offsets (GtkTextLine *line,
     {
       const char *p;
 
+      /* Optimize the case where no chars use > 1 byte */
+      if (seg->byte_count == seg->char_count)
+        p = seg->body.chars + offset;
       /* if in the last fourth of the segment walk backwards */
-      if (seg->char_count - offset < seg->char_count / 4)
+      else if (seg->char_count - offset < seg->char_count / 4)
         p = g_utf8_offset_to_pointer (seg->body.chars + seg->byte_count, 
                                       offset - seg->char_count);
       else
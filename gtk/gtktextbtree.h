@@ -116,6 +116,8 @@ void _gtk_text_btree_tag (const GtkTextIter *start,
                           const GtkTextIter *end,
                           GtkTextTag        *tag,
                           gboolean           apply);
+void _gtk_text_btree_begin_tag_batch (GtkTextBTree *tree);
+void _gtk_text_btree_end_tag_batch   (GtkTextBTree *tree);
 
 /* "Getters" */
 
@@ -37,6 +37,7 @@
 #include "gtktextbuffer.h"
 #include "gtktextbufferrichtext.h"
 #include "gtktextbtree.h"
+#include "gtktexthistoryprivate.h"
 #include "gtktextiterprivate.h"
 #include "gtktexttagprivate.h"
 #include "gtkprivate.h"
@@ -75,6 +76,9 @@ struct _GtkTextBufferPrivate
 
   GtkTextLogAttrCache *log_attr_cache;
 
+  /* NULL unless undo is enabled */
+  GtkTextHistory *history;
+
   guint user_action_count;
 
   /* Whether the buffer has been modified since last save */
@@ -813,6 +817,9 @@ gtk_text_buffer_finalize (GObject *object)
 
   priv->log_attr_cache = NULL;
 
+  if (priv->history)
+    _gtk_text_history_free (priv->history);
+
   gtk_text_buffer_free_target_lists (buffer);
 
   G_OBJECT_CLASS (gtk_text_buffer_parent_class)->finalize (object);
@@ -887,8 +894,220 @@ gtk_text_buffer_set_text (GtkTextBuffer *buffer,
   g_object_notify (G_OBJECT (buffer), "text");
 }
 
+/**
+ * gtk_text_buffer_load_from_stream:
+ * @buffer: a #GtkTextBuffer
+ * @stream: a #GInputStream with UTF-8 text
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @error: return location for a #GError, or %NULL
+ *
+ * Replaces the contents of @buffer with the contents of @stream, like
+ * gtk_text_buffer_set_text() does.
+ *
+ * All of @stream is read before @buffer is changed, and the text is
+ * then inserted in one go, so this is a lot faster for large files
+ * than inserting the text piece by piece. @stream is read
+ * synchronously and is not closed.
+ *
+ * If reading fails or the text is not valid UTF-8, @buffer is left
+ * unchanged and %FALSE is returned.
+ *
+ * Returns: %TRUE if the contents of @buffer were replaced
+ *
+ * Since: 3.12
+ */
+gboolean
+gtk_text_buffer_load_from_stream (GtkTextBuffer  *buffer,
+                                  GInputStream   *stream,
+                                  GCancellable   *cancellable,
+                                  GError        **error)
+{
+  GOutputStream *output;
+  const gchar *data, *invalid;
+  gsize size;
+  gboolean retval = FALSE;
+
+  g_return_val_if_fail (GTK_IS_TEXT_BUFFER (buffer), FALSE);
+  g_return_val_if_fail (G_IS_INPUT_STREAM (stream), FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  output = g_memory_output_stream_new (NULL, 0, g_realloc, g_free);
+
+  if (g_output_stream_splice (output, stream,
+                              G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+                              cancellable, error) < 0)
+    goto out;
+
+  data = g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (output));
+  size = g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (output));
+
+  if (size > G_MAXINT)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NO_SPACE,
+                           _("The text is too large"));
+      goto out;
+    }
+
+  if (size > 0 && !g_utf8_validate (data, size, &invalid))
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                   _("Invalid UTF-8 text at byte %" G_GSIZE_FORMAT),
+                   (gsize) (invalid - data));
+      goto out;
+    }
+
+  gtk_text_buffer_set_text (buffer, size > 0 ? data : "", size);
+  retval = TRUE;
+
+ out:
+  g_object_unref (output);
+
+  return retval;
+}
+
  
 
+typedef struct
+{
+  gchar *text;
+  gchar *str;
+  gboolean case_insensitive;
+} FindAllData;
+
+static void
+find_all_data_free (FindAllData *data)
+{
+  g_free (data->text);
+  g_free (data->str);
+  g_slice_free (FindAllData, data);
+}
+
+static void
+find_all_thread (GTask        *task,
+                 gpointer      source_object,
+                 gpointer      task_data,
+                 GCancellable *cancellable)
+{
+  FindAllData *data = task_data;
+  GArray *matches;
+
+  matches = _gtk_text_search_all (data->text, data->str,
+                                  data->case_insensitive, cancellable);
+
+  if (g_task_return_error_if_cancelled (task))
+    g_array_unref (matches);
+  else
+    g_task_return_pointer (task, matches, (GDestroyNotify) g_array_unref);
+}
+
+/**
+ * gtk_text_buffer_find_all_async:
+ * @buffer: a #GtkTextBuffer
+ * @str: a search string, not empty
+ * @flags: flags affecting how the search is done
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @callback: (scope async): a #GAsyncReadyCallback to call when
+ *     the search is done
+ * @user_data: (closure): the data to pass to @callback
+ *
+ * Finds all occurrences of @str in @buffer, in the same way that
+ * repeated calls to gtk_text_iter_forward_search() would, each one
+ * starting at the end of the previous match.
+ *
+ * The text of @buffer is copied when this function is called and
+ * searched in a thread, so the search does not block the main loop.
+ * The matches are reported as character offsets into the text as
+ * it was when this function was called.
+ *
+ * Only %GTK_TEXT_SEARCH_CASE_INSENSITIVE is supported in @flags;
+ * other flags make the search fail with %G_IO_ERROR_NOT_SUPPORTED.
+ *
+ * Since: 3.12
+ */
+void
+gtk_text_buffer_find_all_async (GtkTextBuffer       *buffer,
+                                const gchar         *str,
+                                GtkTextSearchFlags   flags,
+                                GCancellable        *cancellable,
+                                GAsyncReadyCallback  callback,
+                                gpointer             user_data)
+{
+  GTask *task;
+  FindAllData *data;
+  GtkTextIter start, end;
+
+  g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
+  g_return_if_fail (str != NULL && *str != '\0');
+
+  task = g_task_new (buffer, cancellable, callback, user_data);
+
+  if (flags & ~GTK_TEXT_SEARCH_CASE_INSENSITIVE)
+    {
+      g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                               "Only case insensitive searches are supported");
+      g_object_unref (task);
+      return;
+    }
+
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+
+  data = g_slice_new (FindAllData);
+  data->text = gtk_text_iter_get_slice (&start, &end);
+  data->str = g_strdup (str);
+  data->case_insensitive = (flags & GTK_TEXT_SEARCH_CASE_INSENSITIVE) != 0;
+  g_task_set_task_data (task, data, (GDestroyNotify) find_all_data_free);
+
+  g_task_run_in_thread (task, find_all_thread);
+  g_object_unref (task);
+}
+
+/**
+ * gtk_text_buffer_find_all_finish:
+ * @buffer: a #GtkTextBuffer
+ * @result: a #GAsyncResult
+ * @offsets: (out) (transfer full): return location for the offsets
+ *     of the matches
+ * @n_matches: (out): return location for the number of matches
+ * @error: return location for a #GError, or %NULL
+ *
+ * Finishes a search started with gtk_text_buffer_find_all_async().
+ *
+ * @offsets is set to an array of 2 × @n_matches character offsets,
+ * holding the start and the end of every match in order. Free it
+ * with g_free().
+ *
+ * Returns: %TRUE if the search completed, %FALSE on error
+ *
+ * Since: 3.12
+ */
+gboolean
+gtk_text_buffer_find_all_finish (GtkTextBuffer  *buffer,
+                                 GAsyncResult   *result,
+                                 gint          **offsets,
+                                 gint           *n_matches,
+                                 GError        **error)
+{
+  GArray *matches;
+
+  g_return_val_if_fail (GTK_IS_TEXT_BUFFER (buffer), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, buffer), FALSE);
+  g_return_val_if_fail (offsets != NULL, FALSE);
+  g_return_val_if_fail (n_matches != NULL, FALSE);
+
+  matches = g_task_propagate_pointer (G_TASK (result), error);
+  if (matches == NULL)
+    {
+      *offsets = NULL;
+      *n_matches = 0;
+      return FALSE;
+    }
+
+  *n_matches = matches->len / 2;
+  *offsets = (gint *) g_array_free (matches, FALSE);
+
+  return TRUE;
+}
+
 /*
  * Insertion
  */
@@ -902,7 +1121,15 @@ gtk_text_buffer_real_insert_text (GtkTextBuffer *buffer,
   g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
   g_return_if_fail (iter != NULL);
   
-  _gtk_text_btree_insert (iter, text, len);
+  if (buffer->priv->history)
+    {
+      gint offset = gtk_text_iter_get_offset (iter);
+
+      _gtk_text_btree_insert (iter, text, len);
+      _gtk_text_history_text_inserted (buffer->priv->history, offset, text, len);
+    }
+  else
+    _gtk_text_btree_insert (iter, text, len);
 
   g_signal_emit (buffer, signals[CHANGED], 0);
   g_object_notify (G_OBJECT (buffer), "cursor-position");
@@ -1617,6 +1844,23 @@ gtk_text_buffer_real_delete_range (GtkTextBuffer *buffer,
   g_return_if_fail (start != NULL);
   g_return_if_fail (end != NULL);
 
+  if (buffer->priv->history &&
+      _gtk_text_history_is_recording (buffer->priv->history))
+    {
+      gint start_offset = gtk_text_iter_get_offset (start);
+      gint end_offset = gtk_text_iter_get_offset (end);
+      gchar *text = gtk_text_iter_get_text (start, end);
+
+      /* Pixbufs and child anchors can't be put back */
+      if (g_utf8_strlen (text, -1) == end_offset - start_offset)
+        _gtk_text_history_text_deleted (buffer->priv->history, start_offset, text);
+      else
+        {
+          _gtk_text_history_clear (buffer->priv->history);
+          g_free (text);
+        }
+    }
+
   _gtk_text_btree_delete (start, end);
 
   /* may have deleted the selection... */
@@ -1907,6 +2151,9 @@ gtk_text_buffer_real_insert_pixbuf (GtkTextBuffer *buffer,
                                     GtkTextIter   *iter,
                                     GdkPixbuf     *pixbuf)
 { 
+  if (buffer->priv->history)
+    _gtk_text_history_clear (buffer->priv->history);
+
   _gtk_text_btree_insert_pixbuf (iter, pixbuf);
 
   g_signal_emit (buffer, signals[CHANGED], 0);
@@ -1951,6 +2198,9 @@ gtk_text_buffer_real_insert_anchor (GtkTextBuffer      *buffer,
                                     GtkTextIter        *iter,
                                     GtkTextChildAnchor *anchor)
 {
+  if (buffer->priv->history)
+    _gtk_text_history_clear (buffer->priv->history);
+
   _gtk_text_btree_insert_child_anchor (iter, anchor);
 
   g_signal_emit (buffer, signals[CHANGED], 0);
@@ -4112,6 +4362,9 @@ gtk_text_buffer_begin_user_action (GtkTextBuffer *buffer)
   
   if (buffer->priv->user_action_count == 1)
     {
+      if (buffer->priv->history)
+        _gtk_text_history_begin_group (buffer->priv->history);
+
       /* Outermost nested user action begin emits the signal */
       g_signal_emit (buffer, signals[BEGIN_USER_ACTION], 0);
     }
@@ -4136,9 +4389,207 @@ gtk_text_buffer_end_user_action (GtkTextBuffer *buffer)
     {
       /* Ended the outermost-nested user action end, so emit the signal */
       g_signal_emit (buffer, signals[END_USER_ACTION], 0);
+
+      if (buffer->priv->history)
+        _gtk_text_history_end_group (buffer->priv->history);
     }
 }
 
+/**
+ * gtk_text_buffer_begin_tag_batch:
+ * @buffer: a #GtkTextBuffer
+ *
+ * Starts a batch of tag changes. Until the matching
+ * gtk_text_buffer_end_tag_batch(), applying or removing tags does
+ * not redraw or relayout the affected text right away; the text
+ * spanned by all the changes is updated once, when the batch ends.
+ *
+ * This makes applying many tags at once, e.g. for syntax
+ * highlighting, a lot cheaper. Inserting or deleting text while a
+ * batch is open is allowed, but updates the pending text first.
+ *
+ * Batches can be nested; only the outermost one has an effect.
+ *
+ * Since: 3.12
+ */
+void
+gtk_text_buffer_begin_tag_batch (GtkTextBuffer *buffer)
+{
+  g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
+
+  _gtk_text_btree_begin_tag_batch (get_btree (buffer));
+}
+
+/**
+ * gtk_text_buffer_end_tag_batch:
+ * @buffer: a #GtkTextBuffer
+ *
+ * Ends a batch of tag changes started with
+ * gtk_text_buffer_begin_tag_batch().
+ *
+ * Since: 3.12
+ */
+void
+gtk_text_buffer_end_tag_batch (GtkTextBuffer *buffer)
+{
+  g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
+
+  _gtk_text_btree_end_tag_batch (get_btree (buffer));
+}
+
+/**
+ * gtk_text_buffer_set_enable_undo:
+ * @buffer: a #GtkTextBuffer
+ * @enable_undo: whether to keep an undo history
+ *
+ * Sets whether @buffer records the changes made to its text, so that
+ * they can be undone with gtk_text_buffer_undo() and redone with
+ * gtk_text_buffer_redo().
+ *
+ * The changes made between gtk_text_buffer_begin_user_action() and
+ * gtk_text_buffer_end_user_action() are undone as one. Consecutive
+ * characters typed or erased one at a time are undone a word at a
+ * time.
+ *
+ * Only text is recorded, not tags. Inserting or deleting a pixbuf or
+ * a child anchor can't be undone and clears the history.
+ *
+ * Disabling undo drops the history.
+ *
+ * Since: 3.12
+ */
+void
+gtk_text_buffer_set_enable_undo (GtkTextBuffer *buffer,
+                                 gboolean       enable_undo)
+{
+  GtkTextBufferPrivate *priv;
+
+  g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
+
+  priv = buffer->priv;
+  enable_undo = enable_undo != FALSE;
+
+  if (enable_undo == (priv->history != NULL))
+    return;
+
+  if (enable_undo)
+    {
+      priv->history = _gtk_text_history_new ();
+
+      /* Group the rest of a user action that is already going on */
+      if (priv->user_action_count > 0)
+        _gtk_text_history_begin_group (priv->history);
+    }
+  else
+    {
+      _gtk_text_history_free (priv->history);
+      priv->history = NULL;
+    }
+}
+
+/**
+ * gtk_text_buffer_get_enable_undo:
+ * @buffer: a #GtkTextBuffer
+ *
+ * Returns whether @buffer keeps an undo history. See
+ * gtk_text_buffer_set_enable_undo().
+ *
+ * Returns: %TRUE if undo is enabled
+ *
+ * Since: 3.12
+ */
+gboolean
+gtk_text_buffer_get_enable_undo (GtkTextBuffer *buffer)
+{
+  g_return_val_if_fail (GTK_IS_TEXT_BUFFER (buffer), FALSE);
+
+  return buffer->priv->history != NULL;
+}
+
+/**
+ * gtk_text_buffer_get_can_undo:
+ * @buffer: a #GtkTextBuffer
+ *
+ * Returns whether there is a change that gtk_text_buffer_undo()
+ * would revert.
+ *
+ * Returns: %TRUE if there is something to undo
+ *
+ * Since: 3.12
+ */
+gboolean
+gtk_text_buffer_get_can_undo (GtkTextBuffer *buffer)
+{
+  g_return_val_if_fail (GTK_IS_TEXT_BUFFER (buffer), FALSE);
+
+  return buffer->priv->history != NULL &&
+         _gtk_text_history_get_can_undo (buffer->priv->history);
+}
+
+/**
+ * gtk_text_buffer_get_can_redo:
+ * @buffer: a #GtkTextBuffer
+ *
+ * Returns whether there is an undone change that
+ * gtk_text_buffer_redo() would apply again.
+ *
+ * Returns: %TRUE if there is something to redo
+ *
+ * Since: 3.12
+ */
+gboolean
+gtk_text_buffer_get_can_redo (GtkTextBuffer *buffer)
+{
+  g_return_val_if_fail (GTK_IS_TEXT_BUFFER (buffer), FALSE);
+
+  return buffer->priv->history != NULL &&
+         _gtk_text_history_get_can_redo (buffer->priv->history);
+}
+
+/**
+ * gtk_text_buffer_undo:
+ * @buffer: a #GtkTextBuffer
+ *
+ * Reverts the last group of changes recorded in the undo history,
+ * and places the cursor where they happened. Does nothing if there
+ * is nothing to undo.
+ *
+ * This must not be called from within a user action.
+ *
+ * Since: 3.12
+ */
+void
+gtk_text_buffer_undo (GtkTextBuffer *buffer)
+{
+  g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
+  g_return_if_fail (buffer->priv->user_action_count == 0);
+
+  if (buffer->priv->history)
+    _gtk_text_history_undo (buffer->priv->history, buffer);
+}
+
+/**
+ * gtk_text_buffer_redo:
+ * @buffer: a #GtkTextBuffer
+ *
+ * Applies again the last group of changes reverted with
+ * gtk_text_buffer_undo(). Any other change to the buffer forgets
+ * what could be redone.
+ *
+ * This must not be called from within a user action.
+ *
+ * Since: 3.12
+ */
+void
+gtk_text_buffer_redo (GtkTextBuffer *buffer)
+{
+  g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
+  g_return_if_fail (buffer->priv->user_action_count == 0);
+
+  if (buffer->priv->history)
+    _gtk_text_history_redo (buffer->priv->history, buffer);
+}
+
 static void
 gtk_text_buffer_free_target_lists (GtkTextBuffer *buffer)
 {
@@ -162,6 +162,22 @@ GtkTextTagTable* gtk_text_buffer_get_tag_table (GtkTextBuffer  *buffer);
 void gtk_text_buffer_set_text          (GtkTextBuffer *buffer,
                                         const gchar   *text,
                                         gint           len);
+gboolean gtk_text_buffer_load_from_stream (GtkTextBuffer  *buffer,
+                                           GInputStream   *stream,
+                                           GCancellable   *cancellable,
+                                           GError        **error);
+
+void     gtk_text_buffer_find_all_async  (GtkTextBuffer       *buffer,
+                                          const gchar         *str,
+                                          GtkTextSearchFlags   flags,
+                                          GCancellable        *cancellable,
+                                          GAsyncReadyCallback  callback,
+                                          gpointer             user_data);
+gboolean gtk_text_buffer_find_all_finish (GtkTextBuffer       *buffer,
+                                          GAsyncResult        *result,
+                                          gint               **offsets,
+                                          gint                *n_matches,
+                                          GError             **error);
 
 /* Insert into the buffer */
 void gtk_text_buffer_insert            (GtkTextBuffer *buffer,
@@ -381,6 +397,17 @@ gboolean        gtk_text_buffer_delete_selection        (GtkTextBuffer *buffer,
 void            gtk_text_buffer_begin_user_action       (GtkTextBuffer *buffer);
 void            gtk_text_buffer_end_user_action         (GtkTextBuffer *buffer);
 
+void            gtk_text_buffer_begin_tag_batch         (GtkTextBuffer *buffer);
+void            gtk_text_buffer_end_tag_batch           (GtkTextBuffer *buffer);
+
+void            gtk_text_buffer_set_enable_undo         (GtkTextBuffer *buffer,
+                                                         gboolean       enable_undo);
+gboolean        gtk_text_buffer_get_enable_undo         (GtkTextBuffer *buffer);
+gboolean        gtk_text_buffer_get_can_undo            (GtkTextBuffer *buffer);
+gboolean        gtk_text_buffer_get_can_redo            (GtkTextBuffer *buffer);
+void            gtk_text_buffer_undo                    (GtkTextBuffer *buffer);
+void            gtk_text_buffer_redo                    (GtkTextBuffer *buffer);
+
 GtkTargetList * gtk_text_buffer_get_copy_target_list    (GtkTextBuffer *buffer);
 GtkTargetList * gtk_text_buffer_get_paste_target_list   (GtkTextBuffer *buffer);
 
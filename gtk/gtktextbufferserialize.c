@@ -635,19 +635,24 @@ _gtk_text_buffer_serialize_rich_text (GtkTextBuffer     *register_buffer,
   serialize_text (content_buffer, &context);
   serialize_tags (&context);
 
+  /* Put the header and the tag table in front of the text in place,
+   * rather than copying everything into a new string, so that we
+   * never hold two copies of the text.
+   */
   text = g_string_new (NULL);
   serialize_section_header (text, "GTKTEXTBUFFERCONTENTS-0001",
                             context.tag_table_str->len + context.text_str->len);
-
   g_string_append_len (text, context.tag_table_str->str, context.tag_table_str->len);
-  g_string_append_len (text, context.text_str->str, context.text_str->len);
+
+  g_string_prepend_len (context.text_str, text->str, text->len);
+  g_string_free (text, TRUE);
+  text = context.text_str;
 
   context.pixbufs = g_list_reverse (context.pixbufs);
   serialize_pixbufs (&context, text);
 
   g_hash_table_destroy (context.tags);
   g_list_free (context.pixbufs);
-  g_string_free (context.text_str, TRUE);
   g_string_free (context.tag_table_str, TRUE);
   g_hash_table_destroy (context.tag_id_tags);
 
@@ -1679,48 +1684,69 @@ static void
 insert_text (ParseInfo   *info,
 	     GtkTextIter *iter)
 {
-  GtkTextIter start_iter;
-  GtkTextMark *mark;
+  GtkTextIter start_iter, end_iter;
+  GString *text;
   GList *tmp;
   GSList *tags;
+  gint offset;
 
-  start_iter = *iter;
+  offset = gtk_text_iter_get_offset (iter);
 
-  mark = gtk_text_buffer_create_mark (info->buffer, "deserialize_insert_point",
-  				      &start_iter, TRUE);
+  /* Insert all the text between pixbufs in one go instead of span
+   * by span, and only apply the tags afterwards, so that the buffer
+   * doesn't have to split its segments and invalidate its views
+   * once per span.
+   */
+  text = g_string_new (NULL);
 
-  tmp = info->spans;
-  while (tmp)
+  for (tmp = info->spans; tmp; tmp = tmp->next)
     {
       TextSpan *span = tmp->data;
 
       if (span->text)
-	gtk_text_buffer_insert (info->buffer, iter, span->text, -1);
+	g_string_append (text, span->text);
       else
 	{
+	  if (text->len > 0)
+	    {
+	      gtk_text_buffer_insert (info->buffer, iter, text->str, text->len);
+	      g_string_truncate (text, 0);
+	    }
+
 	  gtk_text_buffer_insert_pixbuf (info->buffer, iter, span->pixbuf);
 	  g_object_unref (span->pixbuf);
 	}
-      gtk_text_buffer_get_iter_at_mark (info->buffer, &start_iter, mark);
+    }
 
-      /* Apply tags */
-      tags = span->tags;
-      while (tags)
-	{
-	  GtkTextTag *tag = tags->data;
+  if (text->len > 0)
+    gtk_text_buffer_insert (info->buffer, iter, text->str, text->len);
 
-	  gtk_text_buffer_apply_tag (info->buffer, tag,
-				     &start_iter, iter);
+  g_string_free (text, TRUE);
 
-	  tags = tags->next;
-	}
+  /* Apply tags */
+  gtk_text_buffer_begin_tag_batch (info->buffer);
 
-      gtk_text_buffer_move_mark (info->buffer, mark, iter);
+  for (tmp = info->spans; tmp; tmp = tmp->next)
+    {
+      TextSpan *span = tmp->data;
+      gint n_chars;
 
-      tmp = tmp->next;
+      n_chars = span->text ? g_utf8_strlen (span->text, -1) : 1;
+
+      if (span->tags)
+	{
+	  gtk_text_buffer_get_iter_at_offset (info->buffer, &start_iter, offset);
+	  gtk_text_buffer_get_iter_at_offset (info->buffer, &end_iter, offset + n_chars);
+
+	  for (tags = span->tags; tags; tags = tags->next)
+	    gtk_text_buffer_apply_tag (info->buffer, tags->data,
+				       &start_iter, &end_iter);
+	}
+
+      offset += n_chars;
     }
 
-  gtk_text_buffer_delete_mark (info->buffer, mark);
+  gtk_text_buffer_end_tag_batch (info->buffer);
 }
 
 
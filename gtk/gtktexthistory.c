@@ -0,0 +1,400 @@
+/* GTK - The GIMP Toolkit
+ * Copyright (C) 2013 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtktexthistoryprivate.h"
+
+#include <string.h>
+
+/* The undo history of a GtkTextBuffer.
+ *
+ * Every change to the buffer is recorded as an action: the text that
+ * was inserted or deleted, and where, as character offsets. Actions
+ * done between the outermost gtk_text_buffer_begin_user_action() and
+ * gtk_text_buffer_end_user_action() form one group, and are undone
+ * and redone together; a change done outside of a user action is a
+ * group of its own.
+ *
+ * Groups made of a single one-character change are merged with the
+ * previous group if they continue it, so that undoing after typing a
+ * word removes the whole word rather than its last letter.
+ *
+ * Only text is recorded. Changes that involve pixbufs or child
+ * anchors can't be undone and clear the history.
+ */
+
+typedef enum
+{
+  ACTION_INSERT,
+  ACTION_DELETE
+} ActionKind;
+
+typedef struct
+{
+  ActionKind kind;
+  gint start;
+  gint end;
+  gchar *text;
+} Action;
+
+typedef struct
+{
+  GPtrArray *actions;
+  guint coalescable : 1;
+} Group;
+
+struct _GtkTextHistory
+{
+  GQueue undo_groups;
+  GQueue redo_groups;
+
+  Group *current;
+  guint depth;
+
+  guint applying : 1;
+};
+
+static Action *
+action_new (ActionKind  kind,
+            gint        start,
+            gchar      *text)
+{
+  Action *action;
+
+  action = g_slice_new (Action);
+  action->kind = kind;
+  action->start = start;
+  action->end = start + g_utf8_strlen (text, -1);
+  action->text = text;
+
+  return action;
+}
+
+static void
+action_free (gpointer data)
+{
+  Action *action = data;
+
+  g_free (action->text);
+  g_slice_free (Action, action);
+}
+
+static Group *
+group_new (void)
+{
+  Group *group;
+
+  group = g_slice_new (Group);
+  group->actions = g_ptr_array_new_with_free_func (action_free);
+  group->coalescable = FALSE;
+
+  return group;
+}
+
+static void
+group_free (gpointer data)
+{
+  Group *group = data;
+
+  g_ptr_array_unref (group->actions);
+  g_slice_free (Group, group);
+}
+
+static void
+clear_groups (GQueue *groups)
+{
+  Group *group;
+
+  while ((group = g_queue_pop_head (groups)) != NULL)
+    group_free (group);
+}
+
+GtkTextHistory *
+_gtk_text_history_new (void)
+{
+  GtkTextHistory *history;
+
+  history = g_slice_new0 (GtkTextHistory);
+  g_queue_init (&history->undo_groups);
+  g_queue_init (&history->redo_groups);
+
+  return history;
+}
+
+void
+_gtk_text_history_free (GtkTextHistory *history)
+{
+  clear_groups (&history->undo_groups);
+  clear_groups (&history->redo_groups);
+  if (history->current)
+    group_free (history->current);
+
+  g_slice_free (GtkTextHistory, history);
+}
+
+/*
+ * _gtk_text_history_clear:
+ * @history: a text history
+ *
+ * Forgets everything that could be undone or redone, including the
+ * changes made so far in the current group.
+ */
+void
+_gtk_text_history_clear (GtkTextHistory *history)
+{
+  clear_groups (&history->undo_groups);
+  clear_groups (&history->redo_groups);
+
+  if (history->current)
+    g_ptr_array_set_size (history->current->actions, 0);
+}
+
+void
+_gtk_text_history_begin_group (GtkTextHistory *history)
+{
+  if (history->depth++ == 0)
+    history->current = group_new ();
+}
+
+/* Merges @group into the group on top of the undo stack if both are
+ * typing (or erasing) at the same place. A group that starts with
+ * white space ends the word before it and is kept apart.
+ */
+static gboolean
+coalesce_group (GtkTextHistory *history,
+                Group          *group)
+{
+  Group *prev_group;
+  Action *action, *prev;
+  gunichar c;
+  gchar *text;
+
+  if (group->actions->len != 1)
+    return FALSE;
+
+  action = g_ptr_array_index (group->actions, 0);
+  if (action->end - action->start != 1)
+    return FALSE;
+
+  group->coalescable = TRUE;
+
+  prev_group = g_queue_peek_head (&history->undo_groups);
+  if (prev_group == NULL || !prev_group->coalescable)
+    return FALSE;
+
+  prev = g_ptr_array_index (prev_group->actions, 0);
+  if (prev->kind != action->kind)
+    return FALSE;
+
+  c = g_utf8_get_char (action->text);
+
+  if (action->kind == ACTION_INSERT)
+    {
+      gunichar last;
+
+      if (action->start != prev->end)
+        return FALSE;
+
+      last = g_utf8_get_char (g_utf8_prev_char (prev->text + strlen (prev->text)));
+      if (g_unichar_isspace (c) && !g_unichar_isspace (last))
+        return FALSE;
+
+      text = g_strconcat (prev->text, action->text, NULL);
+      prev->end = action->end;
+    }
+  else if (action->end == prev->start)
+    {
+      /* Backspace */
+      text = g_strconcat (action->text, prev->text, NULL);
+      prev->start = action->start;
+    }
+  else if (action->start == prev->start)
+    {
+      /* Delete */
+      text = g_strconcat (prev->text, action->text, NULL);
+      prev->end++;
+    }
+  else
+    return FALSE;
+
+  g_free (prev->text);
+  prev->text = text;
+
+  group_free (group);
+
+  return TRUE;
+}
+
+void
+_gtk_text_history_end_group (GtkTextHistory *history)
+{
+  Group *group;
+
+  if (history->depth == 0)
+    return;
+
+  if (--history->depth > 0)
+    return;
+
+  group = history->current;
+  history->current = NULL;
+
+  if (group->actions->len == 0)
+    group_free (group);
+  else if (!coalesce_group (history, group))
+    g_queue_push_head (&history->undo_groups, group);
+}
+
+/*
+ * _gtk_text_history_is_recording:
+ * @history: a text history
+ *
+ * Returns %FALSE while @history is undoing or redoing, when changes to
+ * the buffer must not be recorded. Callers use this to avoid copying
+ * the text of a change that won't be kept.
+ */
+gboolean
+_gtk_text_history_is_recording (GtkTextHistory *history)
+{
+  return !history->applying;
+}
+
+static void
+add_action (GtkTextHistory *history,
+            Action         *action)
+{
+  clear_groups (&history->redo_groups);
+
+  _gtk_text_history_begin_group (history);
+  g_ptr_array_add (history->current->actions, action);
+  _gtk_text_history_end_group (history);
+}
+
+void
+_gtk_text_history_text_inserted (GtkTextHistory *history,
+                                 gint            offset,
+                                 const gchar    *text,
+                                 gint            len)
+{
+  if (history->applying)
+    return;
+
+  add_action (history, action_new (ACTION_INSERT, offset, g_strndup (text, len)));
+}
+
+/*
+ * _gtk_text_history_text_deleted:
+ * @history: a text history
+ * @offset: the character offset where the deleted text started
+ * @text: (transfer full): the deleted text
+ */
+void
+_gtk_text_history_text_deleted (GtkTextHistory *history,
+                                gint            offset,
+                                gchar          *text)
+{
+  if (history->applying)
+    {
+      g_free (text);
+      return;
+    }
+
+  add_action (history, action_new (ACTION_DELETE, offset, text));
+}
+
+gboolean
+_gtk_text_history_get_can_undo (GtkTextHistory *history)
+{
+  return !g_queue_is_empty (&history->undo_groups);
+}
+
+gboolean
+_gtk_text_history_get_can_redo (GtkTextHistory *history)
+{
+  return !g_queue_is_empty (&history->redo_groups);
+}
+
+/* Reverts @action if @undo is %TRUE, or does it again otherwise,
+ * and places the cursor where the change happened.
+ */
+static void
+apply_action (GtkTextBuffer *buffer,
+              Action        *action,
+              gboolean       undo)
+{
+  GtkTextIter start, end;
+
+  gtk_text_buffer_get_iter_at_offset (buffer, &start, action->start);
+
+  if ((action->kind == ACTION_INSERT) == undo)
+    {
+      gtk_text_buffer_get_iter_at_offset (buffer, &end, action->end);
+      gtk_text_buffer_delete (buffer, &start, &end);
+    }
+  else
+    gtk_text_buffer_insert (buffer, &start, action->text, -1);
+
+  gtk_text_buffer_place_cursor (buffer, &start);
+}
+
+static void
+apply_group (GtkTextHistory *history,
+             GtkTextBuffer  *buffer,
+             GQueue         *from,
+             GQueue         *to,
+             gboolean        undo)
+{
+  Group *group;
+  guint i, n;
+
+  g_return_if_fail (history->depth == 0);
+
+  group = g_queue_pop_head (from);
+  if (group == NULL)
+    return;
+
+  history->applying = TRUE;
+  gtk_text_buffer_begin_user_action (buffer);
+
+  n = group->actions->len;
+  for (i = 0; i < n; i++)
+    apply_action (buffer,
+                  g_ptr_array_index (group->actions, undo ? n - i - 1 : i),
+                  undo);
+
+  gtk_text_buffer_end_user_action (buffer);
+  history->applying = FALSE;
+
+  /* Typing after an undo or redo starts a new group */
+  group->coalescable = FALSE;
+  g_queue_push_head (to, group);
+}
+
+void
+_gtk_text_history_undo (GtkTextHistory *history,
+                        GtkTextBuffer  *buffer)
+{
+  apply_group (history, buffer, &history->undo_groups, &history->redo_groups, TRUE);
+}
+
+void
+_gtk_text_history_redo (GtkTextHistory *history,
+                        GtkTextBuffer  *buffer)
+{
+  apply_group (history, buffer, &history->redo_groups, &history->undo_groups, FALSE);
+}
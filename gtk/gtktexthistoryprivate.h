@@ -0,0 +1,52 @@
+/* GTK - The GIMP Toolkit
+ * Copyright (C) 2013 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_TEXT_HISTORY_PRIVATE_H__
+#define __GTK_TEXT_HISTORY_PRIVATE_H__
+
+#include "gtktextbuffer.h"
+
+G_BEGIN_DECLS
+
+typedef struct _GtkTextHistory GtkTextHistory;
+
+GtkTextHistory * _gtk_text_history_new           (void);
+void             _gtk_text_history_free          (GtkTextHistory *history);
+void             _gtk_text_history_clear         (GtkTextHistory *history);
+
+void             _gtk_text_history_begin_group   (GtkTextHistory *history);
+void             _gtk_text_history_end_group     (GtkTextHistory *history);
+
+gboolean         _gtk_text_history_is_recording  (GtkTextHistory *history);
+void             _gtk_text_history_text_inserted (GtkTextHistory *history,
+                                                  gint            offset,
+                                                  const gchar    *text,
+                                                  gint            len);
+void             _gtk_text_history_text_deleted  (GtkTextHistory *history,
+                                                  gint            offset,
+                                                  gchar          *text);
+
+gboolean         _gtk_text_history_get_can_undo  (GtkTextHistory *history);
+gboolean         _gtk_text_history_get_can_redo  (GtkTextHistory *history);
+void             _gtk_text_history_undo          (GtkTextHistory *history,
+                                                  GtkTextBuffer  *buffer);
+void             _gtk_text_history_redo          (GtkTextHistory *history,
+                                                  GtkTextBuffer  *buffer);
+
+G_END_DECLS
+
+#endif /* __GTK_TEXT_HISTORY_PRIVATE_H__ */
@@ -2388,8 +2388,11 @@ gtk_text_iter_backward_chars (GtkTextIter *iter, gint count)
           const char *p;
           gint new_byte_offset;
 
+          /* Optimize the case where no chars use > 1 byte */
+          if (real->segment->byte_count == real->segment->char_count)
+            p = real->segment->body.chars + real->segment_byte_offset - count;
           /* if in the last fourth of the segment walk backwards */
-          if (count < real->segment_char_offset / 4)
+          else if (count < real->segment_char_offset / 4)
             p = g_utf8_offset_to_pointer (real->segment->body.chars + real->segment_byte_offset, 
                                           -count);
           else
@@ -4965,6 +4968,155 @@ gtk_text_iter_forward_search (const GtkTextIter *iter,
   return retval;
 }
 
+/* Returns the start of the line after the one containing @p, the
+ * same way the btree splits text into lines.
+ */
+static const gchar *
+text_next_line (const gchar *p,
+                const gchar *end)
+{
+  gint delim, next;
+
+  pango_find_paragraph_boundary (p, end - p, &delim, &next);
+
+  return p + next;
+}
+
+/* Like lines_match(), but on plain text instead of on the buffer */
+static gboolean
+text_lines_match (const gchar  *p,
+                  const gchar  *end,
+                  const gchar **lines,
+                  gboolean      case_insensitive,
+                  const gchar **match_start,
+                  const gchar **match_end)
+{
+  const gchar *line_end;
+  const gchar *found;
+  gint i;
+
+  for (i = 0; lines[i] != NULL; i++)
+    {
+      gsize len = strlen (lines[i]);
+
+      /* No more text, but lines[i] is nonempty */
+      if (p == end)
+        return FALSE;
+
+      line_end = text_next_line (p, end);
+
+      if (i == 0)
+        {
+          if (!case_insensitive)
+            found = g_strstr_len (p, line_end - p, lines[i]);
+          else
+            {
+              gchar *line_text = g_strndup (p, line_end - p);
+
+              found = utf8_strcasestr (line_text, lines[i]);
+              if (found)
+                found = p + (found - line_text);
+              g_free (line_text);
+            }
+
+          if (found == NULL)
+            return FALSE;
+
+          *match_start = found;
+        }
+      else
+        {
+          /* If it's not the first line, we have to match from the
+           * start of the line.
+           */
+          if ((!case_insensitive &&
+               ((gsize) (line_end - p) >= len && strncmp (p, lines[i], len) == 0)) ||
+              (case_insensitive &&
+               utf8_caselessnmatch (p, lines[i], line_end - p, len)))
+            found = p;
+          else
+            return FALSE;
+        }
+
+      /* Go to end of search string */
+      if (!case_insensitive)
+        p = found + len;
+      else
+        p = pointer_from_offset_skipping_decomp (found, g_utf8_strlen (lines[i], -1));
+    }
+
+  *match_end = p;
+
+  return TRUE;
+}
+
+/*
+ * _gtk_text_search_all:
+ * @text: nul-terminated text, as returned by gtk_text_iter_get_slice()
+ * @str: a search string
+ * @case_insensitive: whether to ignore case
+ * @cancellable: (allow-none): a #GCancellable
+ *
+ * Finds all non-overlapping matches of @str in @text, with the same
+ * rules as gtk_text_iter_forward_search() uses without the
+ * %GTK_TEXT_SEARCH_VISIBLE_ONLY and %GTK_TEXT_SEARCH_TEXT_ONLY flags.
+ * This only looks at @text, so it may be called from any thread.
+ *
+ * Returns: an array of #gint holding the start and end character
+ *   offsets of every match
+ */
+GArray *
+_gtk_text_search_all (const gchar  *text,
+                      const gchar  *str,
+                      gboolean      case_insensitive,
+                      GCancellable *cancellable)
+{
+  GArray *matches;
+  gchar **lines;
+  const gchar *p, *end;
+  gint offset;
+
+  g_return_val_if_fail (text != NULL, NULL);
+  g_return_val_if_fail (str != NULL && *str != '\0', NULL);
+
+  matches = g_array_new (FALSE, FALSE, sizeof (gint));
+  lines = strbreakup (str, "\n", -1, NULL, case_insensitive);
+
+  p = text;
+  end = text + strlen (text);
+  offset = 0;
+
+  while (p != end && !g_cancellable_is_cancelled (cancellable))
+    {
+      const gchar *match_start, *match_end;
+      gint start_offset, end_offset;
+
+      if (text_lines_match (p, end, (const gchar **) lines,
+                            case_insensitive, &match_start, &match_end))
+        {
+          start_offset = offset + g_utf8_strlen (p, match_start - p);
+          end_offset = start_offset + g_utf8_strlen (match_start, match_end - match_start);
+
+          g_array_append_val (matches, start_offset);
+          g_array_append_val (matches, end_offset);
+
+          p = match_end;
+          offset = end_offset;
+        }
+      else
+        {
+          const gchar *next = text_next_line (p, end);
+
+          offset += g_utf8_strlen (p, next - p);
+          p = next;
+        }
+    }
+
+  g_strfreev (lines);
+
+  return matches;
+}
+
 static gboolean
 vectors_equal_ignoring_trailing (gchar    **vec1,
                                  gchar    **vec2,
@@ -43,6 +43,11 @@ gboolean            _gtk_text_iter_backward_indexable_segment (GtkTextIter
 gint                _gtk_text_iter_get_segment_byte           (const GtkTextIter *iter);
 gint                _gtk_text_iter_get_segment_char           (const GtkTextIter *iter);
 
+GArray *            _gtk_text_search_all                      (const gchar       *text,
+                                                               const gchar       *str,
+                                                               gboolean           case_insensitive,
+                                                               GCancellable      *cancellable);
+
 
 /* debug */
 void _gtk_text_iter_check (const GtkTextIter *iter);
@@ -98,8 +98,31 @@ struct _GtkTextLayoutPrivate
      direction only influences the direction of the cursor line.
   */
   GtkTextLine *cursor_line;
+
+  /* Recently used line displays, most recent first. Only lines that
+   * have line data for this layout are cached, so that the cache
+   * hears about them being freed through free_line_data.
+   */
+  GQueue display_cache;
+  GHashTable *display_cache_lines; /* GtkTextLine -> link in display_cache */
+  gsize display_cache_size;
+};
+
+typedef struct _DisplayCacheEntry DisplayCacheEntry;
+
+struct _DisplayCacheEntry
+{
+  GtkTextLineDisplay *display;
+  gsize size;
 };
 
+/* The budget of the line display cache. The size of an entry is
+ * estimated from the length of its paragraph, PangoLayouts take
+ * roughly that many bytes per byte of text once they are shaped.
+ */
+#define DISPLAY_CACHE_SIZE (2 * 1024 * 1024)
+#define DISPLAY_CACHE_BYTES_PER_TEXT_BYTE 48
+
 static GtkTextLineData *gtk_text_layout_real_wrap (GtkTextLayout *layout,
                                                    GtkTextLine *line,
                                                    /* may be NULL */
@@ -116,6 +139,7 @@ static void gtk_text_layout_real_invalidate_cursors(GtkTextLayout     *layout,
 static void gtk_text_layout_invalidate_cache       (GtkTextLayout     *layout,
 						    GtkTextLine       *line,
 						    gboolean           cursors_only);
+static void gtk_text_layout_clear_display_cache    (GtkTextLayout     *layout);
 static void gtk_text_layout_invalidate_cursor_line (GtkTextLayout     *layout,
 						    gboolean           cursors_only);
 static void gtk_text_layout_real_free_line_data    (GtkTextLayout     *layout,
@@ -194,12 +218,7 @@ gtk_text_layout_dispose (GObject *object)
   g_clear_object (&layout->ltr_context);
   g_clear_object (&layout->rtl_context);
 
-  if (layout->one_display_cache)
-    {
-      GtkTextLineDisplay *tmp_display = layout->one_display_cache;
-      layout->one_display_cache = NULL;
-      gtk_text_layout_free_line_display (layout, tmp_display);
-    }
+  gtk_text_layout_clear_display_cache (layout);
 
   if (layout->preedit_attrs != NULL)
     {
@@ -219,6 +238,8 @@ gtk_text_layout_finalize (GObject *object)
 
   g_free (layout->preedit_string);
 
+  g_hash_table_destroy (GTK_TEXT_LAYOUT_GET_PRIVATE (layout)->display_cache_lines);
+
   G_OBJECT_CLASS (gtk_text_layout_parent_class)->finalize (object);
 }
 
@@ -279,7 +300,12 @@ gtk_text_layout_class_init (GtkTextLayoutClass *klass)
 static void
 gtk_text_layout_init (GtkTextLayout *text_layout)
 {
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (text_layout);
+
   text_layout->cursor_visible = TRUE;
+
+  g_queue_init (&priv->display_cache);
+  priv->display_cache_lines = g_hash_table_new (NULL, NULL);
 }
 
 GtkTextLayout*
@@ -316,6 +342,8 @@ gtk_text_layout_set_buffer (GtkTextLayout *layout,
 
   if (layout->buffer)
     {
+      gtk_text_layout_clear_display_cache (layout);
+
       _gtk_text_btree_remove_view (_gtk_text_buffer_get_btree (layout->buffer),
                                   layout);
 
@@ -638,15 +666,21 @@ text_layout_changed (GtkTextLayout *layout,
                      gint           new_height,
                      gboolean       cursors_only)
 {
-  /* Check if the range intersects our cached line display,
-   * and invalidate the cached line if so.
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *l, *next;
+
+  /* Check if the range intersects our cached line displays,
+   * and invalidate the cached lines if so.
    */
-  if (layout->one_display_cache)
+  for (l = priv->display_cache.head; l; l = next)
     {
-      GtkTextLine *line = layout->one_display_cache->line;
+      DisplayCacheEntry *entry = l->data;
+      GtkTextLine *line = entry->display->line;
       gint cache_y = _gtk_text_btree_find_line_top (_gtk_text_buffer_get_btree (layout->buffer),
 						    line, layout);
-      gint cache_height = layout->one_display_cache->height;
+      gint cache_height = entry->display->height;
+
+      next = l->next;
 
       if (cache_y + cache_height > y && cache_y < y + old_height)
 	gtk_text_layout_invalidate_cache (layout, line, cursors_only);
@@ -816,14 +850,66 @@ gtk_text_layout_invalidate_all (GtkTextLayout *layout)
   gtk_text_layout_invalidate (layout, &start, &end);
 }
 
+static void
+gtk_text_layout_uncache_display (GtkTextLayout *layout,
+                                 GList         *link)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  DisplayCacheEntry *entry = link->data;
+  GtkTextLineDisplay *display = entry->display;
+
+  g_hash_table_remove (priv->display_cache_lines, display->line);
+  g_queue_delete_link (&priv->display_cache, link);
+  priv->display_cache_size -= entry->size;
+  g_slice_free (DisplayCacheEntry, entry);
+
+  gtk_text_layout_free_line_display (layout, display);
+}
+
+static void
+gtk_text_layout_cache_display (GtkTextLayout      *layout,
+                               GtkTextLineDisplay *display,
+                               gsize               text_length)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  DisplayCacheEntry *entry;
+
+  entry = g_slice_new (DisplayCacheEntry);
+  entry->display = display;
+  entry->size = sizeof (GtkTextLineDisplay) + text_length * DISPLAY_CACHE_BYTES_PER_TEXT_BYTE;
+
+  g_queue_push_head (&priv->display_cache, entry);
+  g_hash_table_insert (priv->display_cache_lines, display->line, priv->display_cache.head);
+  priv->display_cache_size += entry->size;
+
+  /* Evict least recently used displays, but always keep the new one */
+  while (priv->display_cache_size > DISPLAY_CACHE_SIZE &&
+         priv->display_cache.tail != priv->display_cache.head)
+    gtk_text_layout_uncache_display (layout, priv->display_cache.tail);
+}
+
+static void
+gtk_text_layout_clear_display_cache (GtkTextLayout *layout)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  while (priv->display_cache.head)
+    gtk_text_layout_uncache_display (layout, priv->display_cache.head);
+}
+
 static void
 gtk_text_layout_invalidate_cache (GtkTextLayout *layout,
                                   GtkTextLine   *line,
 				  gboolean       cursors_only)
 {
-  if (layout->one_display_cache && line == layout->one_display_cache->line)
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *link;
+
+  link = g_hash_table_lookup (priv->display_cache_lines, line);
+  if (link)
     {
-      GtkTextLineDisplay *display = layout->one_display_cache;
+      DisplayCacheEntry *entry = link->data;
+      GtkTextLineDisplay *display = entry->display;
 
       if (cursors_only)
 	{
@@ -834,10 +920,7 @@ gtk_text_layout_invalidate_cache (GtkTextLayout *layout,
 	  display->has_block_cursor = FALSE;
 	}
       else
-	{
-	  layout->one_display_cache = NULL;
-	  gtk_text_layout_free_line_display (layout, display);
-	}
+	gtk_text_layout_uncache_display (layout, link);
     }
 }
 
@@ -929,13 +1012,24 @@ gtk_text_layout_real_invalidate_cursors (GtkTextLayout     *layout,
 					 const GtkTextIter *start,
 					 const GtkTextIter *end)
 {
-  /* Check if the range intersects our cached line display,
-   * and invalidate the cached line if so.
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *l;
+
+  if (gtk_text_iter_compare (start, end) > 0)
+    {
+      const GtkTextIter *tmp = start;
+      start = end;
+      end = tmp;
+    }
+
+  /* Check if the range intersects our cached line displays,
+   * and invalidate the cached lines if so.
    */
-  if (layout->one_display_cache)
+  for (l = priv->display_cache.head; l; l = l->next)
     {
+      DisplayCacheEntry *entry = l->data;
       GtkTextIter line_start, line_end;
-      GtkTextLine *line = layout->one_display_cache->line;
+      GtkTextLine *line = entry->display->line;
 
       gtk_text_layout_get_iter_at_line (layout, &line_start, line, 0);
 
@@ -943,13 +1037,6 @@ gtk_text_layout_real_invalidate_cursors (GtkTextLayout     *layout,
       if (!gtk_text_iter_ends_line (&line_end))
 	gtk_text_iter_forward_to_line_end (&line_end);
 
-      if (gtk_text_iter_compare (start, end) > 0)
-	{
-	  const GtkTextIter *tmp = start;
-	  start = end;
-	  end = tmp;
-	}
-
       if (gtk_text_iter_compare (&line_start, end) <= 0 &&
 	  gtk_text_iter_compare (start, &line_end) <= 0)
 	{
@@ -2141,27 +2228,30 @@ gtk_text_layout_get_line_display (GtkTextLayout *layout,
   PangoDirection base_dir;
   GPtrArray *tags;
   gboolean initial_toggle_segments;
+  GList *link;
   
   g_return_val_if_fail (line != NULL, NULL);
 
-  if (layout->one_display_cache)
+  link = g_hash_table_lookup (priv->display_cache_lines, line);
+  if (link)
     {
-      if (line == layout->one_display_cache->line &&
-          (size_only || !layout->one_display_cache->size_only))
+      display = ((DisplayCacheEntry *) link->data)->display;
+
+      if (size_only || !display->size_only)
 	{
+          /* move to the front */
+          g_queue_unlink (&priv->display_cache, link);
+          g_queue_push_head_link (&priv->display_cache, link);
+
 	  if (!size_only)
-            update_text_display_cursors (layout, line, layout->one_display_cache);
-	  return layout->one_display_cache;
+            update_text_display_cursors (layout, line, display);
+	  return display;
 	}
       else
-        {
-          GtkTextLineDisplay *tmp_display = layout->one_display_cache;
-          layout->one_display_cache = NULL;
-          gtk_text_layout_free_line_display (layout, tmp_display);
-        }
+        gtk_text_layout_uncache_display (layout, link);
     }
 
-  DV (g_print ("creating one line display cache (%s)\n", G_STRLOC));
+  DV (g_print ("creating line display (%s)\n", G_STRLOC));
 
   display = g_slice_new0 (GtkTextLineDisplay);
 
@@ -2480,7 +2570,8 @@ gtk_text_layout_get_line_display (GtkTextLayout *layout,
   if (tags != NULL)
     g_ptr_array_free (tags, TRUE);
 
-  layout->one_display_cache = display;
+  if (_gtk_text_line_get_data (line, layout) != NULL)
+    gtk_text_layout_cache_display (layout, display, layout_byte_offset);
 
   if (saw_widget)
     allocate_child_widgets (layout, display);
@@ -2492,7 +2583,11 @@ void
 gtk_text_layout_free_line_display (GtkTextLayout      *layout,
                                    GtkTextLineDisplay *display)
 {
-  if (display != layout->one_display_cache)
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *link;
+
+  link = g_hash_table_lookup (priv->display_cache_lines, display->line);
+  if (link == NULL || ((DisplayCacheEntry *) link->data)->display != display)
     {
       if (display->layout)
         g_object_unref (display->layout);
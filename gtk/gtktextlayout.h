@@ -145,8 +145,8 @@ struct _GtkTextLayout
    * over long runs with the same style. */
   GtkTextAttributes *one_style_cache;
 
-  /* A cache of one line display. Getting the same line
-   * many times in a row is the most common case.
+  /* Unused, line displays are cached in the private
+   * structure now.
    */
   GtkTextLineDisplay *one_display_cache;
 
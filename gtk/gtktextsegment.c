@@ -260,6 +260,7 @@ static GtkTextLineSegment *
 char_segment_split_func (GtkTextLineSegment *seg, int index)
 {
   GtkTextLineSegment *new1, *new2;
+  gint len2, chars1;
 
   g_assert (index < seg->byte_count);
 
@@ -268,16 +269,31 @@ char_segment_split_func (GtkTextLineSegment *seg, int index)
       char_segment_self_check (seg);
     }
 
-  new1 = _gtk_char_segment_new (seg->body.chars, index);
-  new2 = _gtk_char_segment_new (seg->body.chars + index, seg->byte_count - index);
+  /* Only the second half is copied; seg is cut down to the first
+   * half in place. Count the characters of the shorter half.
+   */
+  len2 = seg->byte_count - index;
+  if (index <= len2)
+    chars1 = g_utf8_strlen (seg->body.chars, index);
+  else
+    chars1 = seg->char_count - g_utf8_strlen (seg->body.chars + index, len2);
+
+  new2 = g_malloc (CSEG_SIZE (len2));
+  new2->type = &gtk_text_char_type;
+  new2->next = seg->next;
+  new2->byte_count = len2;
+  new2->char_count = seg->char_count - chars1;
+  memcpy (new2->body.chars, seg->body.chars + index, len2);
+  new2->body.chars[len2] = '\0';
+
+  new1 = g_realloc (seg, CSEG_SIZE (index));
+  new1->byte_count = index;
+  new1->char_count = chars1;
+  new1->body.chars[index] = '\0';
+  new1->next = new2;
 
   g_assert (gtk_text_byte_begins_utf8_char (new1->body.chars));
   g_assert (gtk_text_byte_begins_utf8_char (new2->body.chars));
-  g_assert (new1->byte_count + new2->byte_count == seg->byte_count);
-  g_assert (new1->char_count + new2->char_count == seg->char_count);
-
-  new1->next = new2;
-  new2->next = seg->next;
 
   if (gtk_get_debug_flags () & GTK_DEBUG_TEXT)
     {
@@ -285,7 +301,6 @@ char_segment_split_func (GtkTextLineSegment *seg, int index)
       char_segment_self_check (new2);
     }
 
-  g_free (seg);
   return new1;
 }
 
@@ -327,20 +342,21 @@ char_segment_cleanup_func (GtkTextLineSegment *segPtr, GtkTextLine *line)
       return segPtr;
     }
 
-  newPtr =
-    _gtk_char_segment_new_from_two_strings (segPtr->body.chars, 
-					    segPtr->byte_count,
-					    segPtr->char_count,
-                                            segPtr2->body.chars, 
-					    segPtr2->byte_count,
-					    segPtr2->char_count);
+  /* Grow the first segment instead of copying both into a new one;
+   * for long lines realloc() can usually do that without copying.
+   */
+  newPtr = g_realloc (segPtr, CSEG_SIZE (segPtr->byte_count + segPtr2->byte_count));
+  memcpy (newPtr->body.chars + newPtr->byte_count,
+          segPtr2->body.chars, segPtr2->byte_count);
+  newPtr->byte_count += segPtr2->byte_count;
+  newPtr->char_count += segPtr2->char_count;
+  newPtr->body.chars[newPtr->byte_count] = '\0';
 
   newPtr->next = segPtr2->next;
 
   if (gtk_get_debug_flags () & GTK_DEBUG_TEXT)
     char_segment_self_check (newPtr);
 
-  g_free (segPtr);
   g_free (segPtr2);
   return newPtr;
 }
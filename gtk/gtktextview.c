@@ -119,6 +119,11 @@
 
 #define SPACE_FOR_CURSOR 1
 
+/* How long, in microseconds, a single run of the incremental
+ * validation idle may take
+ */
+#define INCREMENTAL_VALIDATE_TIME 8000
+
 #define GTK_TEXT_VIEW_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GTK_TYPE_TEXT_VIEW, GtkTextViewPrivate))
 
 typedef struct _GtkTextWindow GtkTextWindow;
@@ -3851,10 +3856,21 @@ incremental_validate_callback (gpointer data)
 {
   GtkTextView *text_view = data;
   gboolean result = TRUE;
+  gint64 end_time;
 
   DV(g_print(G_STRLOC"\n"));
-  
-  gtk_text_layout_validate (text_view->priv->layout, 2000);
+
+  /* Validate chunks of lines until the time for this run is used up,
+   * instead of a fixed number of pixels, so that large buffers don't
+   * take thousands of idles (and adjustment updates) to validate.
+   * The run ends early when input is waiting or a frame is due.
+   */
+  end_time = _gtk_widget_get_idle_deadline (GTK_WIDGET (text_view),
+                                            INCREMENTAL_VALIDATE_TIME);
+  do
+    gtk_text_layout_validate (text_view->priv->layout, 2000);
+  while (!gtk_text_layout_is_valid (text_view->priv->layout) &&
+         g_get_monotonic_time () < end_time);
 
   gtk_text_view_update_adjustments (text_view);
   
@@ -72,12 +72,18 @@ _gtk_theming_background_paint_color (GtkThemingBackground *bg,
      (_gtk_style_context_peek_property (bg->context, GTK_CSS_PROPERTY_BACKGROUND_CLIP), 
       n_values - 1));
 
+  /* Most widgets have a transparent background, don't bother */
+  if (bg->bg_color.alpha == 0 &&
+      cairo_get_operator (cr) == CAIRO_OPERATOR_OVER)
+    return;
+
+  /* Filling the box is cheaper than clipping to it and painting,
+   * because a rounded clip needs a mask. */
   cairo_save (cr);
   _gtk_rounded_box_path (gtk_theming_background_get_box (bg, clip), cr);
-  cairo_clip (cr);
 
   gdk_cairo_set_source_rgba (cr, &bg->bg_color);
-  cairo_paint (cr);
+  cairo_fill (cr);
 
   cairo_restore (cr);
 }
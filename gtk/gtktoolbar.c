@@ -1500,6 +1500,7 @@ gtk_toolbar_size_allocate (GtkWidget     *widget,
   GtkToolbarPrivate *priv = toolbar->priv;
   GtkAllocation *allocations;
   ItemState *new_states;
+  gint *item_sizes;
   GtkAllocation arrow_allocation;
   GtkBorder padding;
   gint arrow_size;
@@ -1562,16 +1563,21 @@ gtk_toolbar_size_allocate (GtkWidget     *widget,
   n_items = g_list_length (priv->content);
   allocations = g_new0 (GtkAllocation, n_items);
   new_states = g_new0 (ItemState, n_items);
+  item_sizes = g_new0 (gint, n_items);
 
+  /* Each item is measured only once per allocation, the size is
+   * needed both to find out whether we overflow and for placing it.
+   */
   needed_size = 0;
   need_arrow = FALSE;
-  for (list = priv->content; list != NULL; list = list->next)
+  for (list = priv->content, i = 0; list != NULL; list = list->next, ++i)
     {
       ToolbarContent *content = list->data;
 
       if (toolbar_content_visible (content, toolbar))
         {
-          needed_size += get_item_size (toolbar, content);
+          item_sizes[i] = get_item_size (toolbar, content);
+          needed_size += item_sizes[i];
 
           /* Do we need an arrow?
            *
@@ -1607,7 +1613,7 @@ gtk_toolbar_size_allocate (GtkWidget     *widget,
           continue;
         }
 
-      item_size = get_item_size (toolbar, content);
+      item_size = item_sizes[i];
       if (item_size <= size && !overflowing)
         {
           size -= item_size;
@@ -1817,7 +1823,10 @@ gtk_toolbar_size_allocate (GtkWidget     *widget,
       toolbar_content_set_state (content, new_states[i]);
     }
 
-  if (priv->menu && priv->need_rebuild)
+  /* The menu is rebuilt when it is shown, so only bother while it is
+   * open */
+  if (priv->menu && priv->need_rebuild &&
+      gtk_widget_get_visible (GTK_WIDGET (priv->menu)))
     rebuild_menu (toolbar);
 
   if (need_arrow)
@@ -1836,6 +1845,7 @@ gtk_toolbar_size_allocate (GtkWidget     *widget,
 
   g_free (allocations);
   g_free (new_states);
+  g_free (item_sizes);
 }
 
 static void
@@ -249,11 +249,17 @@ enum {
 
 static guint tree_model_signals[LAST_SIGNAL] = { 0 };
 
+/* Paths are almost always shallow, so the indices of those live
+ * in the path itself instead of in a separate allocation
+ */
+#define GTK_TREE_PATH_INLINE_DEPTH 8
+
 struct _GtkTreePath
 {
   gint depth;    /* Number of elements */
   gint alloc;    /* Number of allocated elements */
   gint *indices;
+  gint inline_indices[GTK_TREE_PATH_INLINE_DEPTH];
 };
 
 typedef struct
@@ -362,6 +368,8 @@ gtk_tree_model_base_init (gpointer g_class)
                       G_TYPE_NONE, 2,
                       GTK_TYPE_TREE_PATH | G_SIGNAL_TYPE_STATIC_SCOPE,
                       GTK_TYPE_TREE_ITER);
+      g_signal_set_va_marshaller (tree_model_signals[ROW_CHANGED], GTK_TYPE_TREE_MODEL,
+                                  _gtk_marshal_VOID__BOXED_BOXEDv);
 
       /* We need to get notification about structure changes
        * to update row references., so instead of using the
@@ -420,6 +428,8 @@ gtk_tree_model_base_init (gpointer g_class)
                       G_TYPE_NONE, 2,
                       GTK_TYPE_TREE_PATH | G_SIGNAL_TYPE_STATIC_SCOPE,
                       GTK_TYPE_TREE_ITER);
+      g_signal_set_va_marshaller (tree_model_signals[ROW_HAS_CHILD_TOGGLED], GTK_TYPE_TREE_MODEL,
+                                  _gtk_marshal_VOID__BOXED_BOXEDv);
 
       /**
        * GtkTreeModel::row-deleted:
@@ -596,6 +606,44 @@ gtk_tree_path_new (void)
   return retval;
 }
 
+/* Makes room for @length indices in a path that has none yet */
+static void
+gtk_tree_path_alloc_indices (GtkTreePath *path,
+                             gint         length)
+{
+  if (length <= GTK_TREE_PATH_INLINE_DEPTH)
+    {
+      path->alloc = GTK_TREE_PATH_INLINE_DEPTH;
+      path->indices = path->inline_indices;
+    }
+  else
+    {
+      path->alloc = length;
+      path->indices = g_new (gint, length);
+    }
+}
+
+/* Doubles the room for indices, leaving @offset free slots in front */
+static void
+gtk_tree_path_grow_indices (GtkTreePath *path,
+                            gint         offset)
+{
+  gint *indices;
+
+  if (path->alloc == 0)
+    {
+      gtk_tree_path_alloc_indices (path, 1);
+      return;
+    }
+
+  path->alloc *= 2;
+  indices = g_new (gint, path->alloc);
+  memcpy (indices + offset, path->indices, path->depth * sizeof (gint));
+  if (path->indices != path->inline_indices)
+    g_free (path->indices);
+  path->indices = indices;
+}
+
 /**
  * gtk_tree_path_new_from_string:
  * @path: The string representation of a path
@@ -704,9 +752,8 @@ gtk_tree_path_new_from_indicesv (gint *indices,
   g_return_val_if_fail (indices != NULL && length != 0, NULL);
 
   path = gtk_tree_path_new ();
-  path->alloc = length;
+  gtk_tree_path_alloc_indices (path, length);
   path->depth = length;
-  path->indices = g_new (gint, length);
   memcpy (path->indices, indices, length * sizeof (gint));
 
   return path;
@@ -790,14 +837,7 @@ gtk_tree_path_append_index (GtkTreePath *path,
   g_return_if_fail (index_ >= 0);
 
   if (path->depth == path->alloc)
-    {
-      gint *indices;
-      path->alloc = MAX (path->alloc * 2, 1);
-      indices = g_new (gint, path->alloc);
-      memcpy (indices, path->indices, path->depth * sizeof (gint));
-      g_free (path->indices);
-      path->indices = indices;
-    }
+    gtk_tree_path_grow_indices (path, 0);
 
   path->depth += 1;
   path->indices[path->depth - 1] = index_;
@@ -817,14 +857,7 @@ gtk_tree_path_prepend_index (GtkTreePath *path,
                              gint       index)
 {
   if (path->depth == path->alloc)
-    {
-      gint *indices;
-      path->alloc = MAX (path->alloc * 2, 1);
-      indices = g_new (gint, path->alloc);
-      memcpy (indices + 1, path->indices, path->depth * sizeof (gint));
-      g_free (path->indices);
-      path->indices = indices;
-    }
+    gtk_tree_path_grow_indices (path, 1);
   else if (path->depth > 0)
     memmove (path->indices + 1, path->indices, path->depth * sizeof (gint));
 
@@ -910,7 +943,8 @@ gtk_tree_path_free (GtkTreePath *path)
   if (!path)
     return;
 
-  g_free (path->indices);
+  if (path->indices != path->inline_indices)
+    g_free (path->indices);
   g_slice_free (GtkTreePath, path);
 }
 
@@ -929,10 +963,10 @@ gtk_tree_path_copy (const GtkTreePath *path)
 
   g_return_val_if_fail (path != NULL, NULL);
 
-  retval = g_slice_new (GtkTreePath);
+  retval = gtk_tree_path_new ();
+  if (path->indices != NULL)
+    gtk_tree_path_alloc_indices (retval, path->depth);
   retval->depth = path->depth;
-  retval->alloc = retval->depth;
-  retval->indices = g_new (gint, path->alloc);
   memcpy (retval->indices, path->indices, path->depth * sizeof (gint));
   return retval;
 }
@@ -300,6 +300,14 @@ struct _GtkTreeModelFilterPrivate
   gulong has_child_toggled_id;
   gulong deleted_id;
   gulong reordered_id;
+
+  /* incremental refilter */
+  guint refilter_id;
+  GtkTreePath *refilter_path;
+
+  /* automatic cache clearing */
+  guint cache_timeout;
+  guint cache_timeout_id;
 };
 
 /* properties */
@@ -322,6 +330,11 @@ enum
 #  define GTK_TREE_MODEL_FILTER_CACHE_CHILD_ITERS(filter) (FALSE)
 #endif
 
+/* The time gtk_tree_model_filter_refilter_incremental() spends
+ * re-evaluating rows per main loop iteration.
+ */
+#define REFILTER_TIME_PER_IDLE 5000 /* microseconds */
+
 /* Defining this constant enables more assertions, which will be
  * helpful when debugging the code.
  */
@@ -468,6 +481,14 @@ static void         gtk_tree_model_filter_unref_path                      (GtkTr
                                                                            int                     depth);
 static void         gtk_tree_model_filter_set_root                        (GtkTreeModelFilter     *filter,
                                                                            GtkTreePath            *root);
+static void         gtk_tree_model_filter_refilter_stop                   (GtkTreeModelFilter     *filter);
+static void         gtk_tree_model_filter_queue_clear_cache               (GtkTreeModelFilter     *filter);
+static void         gtk_tree_model_filter_refilter_child_inserted         (GtkTreeModelFilter     *filter,
+                                                                           GtkTreePath            *c_path);
+static void         gtk_tree_model_filter_refilter_child_deleted          (GtkTreeModelFilter     *filter,
+                                                                           GtkTreePath            *c_path);
+static void         gtk_tree_model_filter_refilter_child_reordered        (GtkTreeModelFilter     *filter,
+                                                                           GtkTreePath            *c_path);
 
 static GtkTreePath *gtk_real_tree_model_filter_convert_child_path_to_path (GtkTreeModelFilter     *filter,
                                                                            GtkTreePath            *child_path,
@@ -829,7 +850,10 @@ gtk_tree_model_filter_build_level (GtkTreeModelFilter *filter,
       tmp_level = tmp_level->parent_level;
     }
   if (new_level != filter->priv->root)
-    filter->priv->zero_ref_count++;
+    {
+      filter->priv->zero_ref_count++;
+      gtk_tree_model_filter_queue_clear_cache (filter);
+    }
 
   i = 0;
 
@@ -2150,6 +2174,8 @@ gtk_tree_model_filter_row_inserted (GtkTreeModel *c_model,
       free_c_path = TRUE;
     }
 
+  gtk_tree_model_filter_refilter_child_inserted (filter, c_path);
+
   if (c_iter)
     real_c_iter = *c_iter;
   else
@@ -2555,6 +2581,8 @@ gtk_tree_model_filter_row_deleted (GtkTreeModel *c_model,
 
   g_return_if_fail (c_path != NULL);
 
+  gtk_tree_model_filter_refilter_child_deleted (filter, c_path);
+
   /* special case the deletion of an ancestor of the virtual root */
   if (filter->priv->virtual_root &&
       (gtk_tree_path_is_ancestor (c_path, filter->priv->virtual_root) ||
@@ -2739,6 +2767,8 @@ gtk_tree_model_filter_rows_reordered (GtkTreeModel *c_model,
 
   g_return_if_fail (new_order != NULL);
 
+  gtk_tree_model_filter_refilter_child_reordered (filter, c_path);
+
   if (c_path == NULL || gtk_tree_path_get_depth (c_path) == 0)
     {
       length = gtk_tree_model_iter_n_children (c_model, NULL);
@@ -3571,7 +3601,10 @@ gtk_tree_model_filter_real_unref_node (GtkTreeModel *model,
             }
 
           if (filter->priv->root != level)
-            filter->priv->zero_ref_count++;
+            {
+              filter->priv->zero_ref_count++;
+              gtk_tree_model_filter_queue_clear_cache (filter);
+            }
 
 #ifdef MODEL_FILTER_DEBUG
           g_assert (filter->priv->zero_ref_count >= 0);
@@ -3653,6 +3686,14 @@ gtk_tree_model_filter_set_model (GtkTreeModelFilter *filter,
 
   if (filter->priv->child_model)
     {
+      gtk_tree_model_filter_refilter_stop (filter);
+
+      if (filter->priv->cache_timeout_id)
+        {
+          g_source_remove (filter->priv->cache_timeout_id);
+          filter->priv->cache_timeout_id = 0;
+        }
+
       g_signal_handler_disconnect (filter->priv->child_model,
                                    filter->priv->changed_id);
       g_signal_handler_disconnect (filter->priv->child_model,
@@ -4275,12 +4316,237 @@ gtk_tree_model_filter_refilter (GtkTreeModelFilter *filter)
 {
   g_return_if_fail (GTK_IS_TREE_MODEL_FILTER (filter));
 
+  /* a full refilter supersedes any pending incremental one */
+  gtk_tree_model_filter_refilter_stop (filter);
+
   /* S L O W */
   gtk_tree_model_foreach (filter->priv->child_model,
                           gtk_tree_model_filter_refilter_helper,
                           filter);
 }
 
+/* Moves @iter and @path to the next row of @model in the order
+ * gtk_tree_model_foreach() visits them.
+ */
+static gboolean
+gtk_tree_model_filter_refilter_next (GtkTreeModel *model,
+                                     GtkTreeIter  *iter,
+                                     GtkTreePath  *path)
+{
+  GtkTreeIter tmp;
+
+  if (gtk_tree_model_iter_children (model, &tmp, iter))
+    {
+      *iter = tmp;
+      gtk_tree_path_down (path);
+      return TRUE;
+    }
+
+  while (TRUE)
+    {
+      tmp = *iter;
+      if (gtk_tree_model_iter_next (model, &tmp))
+        {
+          *iter = tmp;
+          gtk_tree_path_next (path);
+          return TRUE;
+        }
+
+      if (!gtk_tree_model_iter_parent (model, &tmp, iter))
+        return FALSE;
+
+      *iter = tmp;
+      gtk_tree_path_up (path);
+    }
+}
+
+static gboolean
+gtk_tree_model_filter_refilter_idle (gpointer data)
+{
+  GtkTreeModelFilter *filter = GTK_TREE_MODEL_FILTER (data);
+  GtkTreeModelFilterPrivate *priv = filter->priv;
+  GtkTreePath *path = priv->refilter_path;
+  guint id = priv->refilter_id;
+  GtkTreeIter iter;
+  gint64 end_time;
+
+  if (!gtk_tree_model_get_iter (priv->child_model, &iter, path))
+    goto done;
+
+  end_time = g_get_monotonic_time () + REFILTER_TIME_PER_IDLE;
+
+  do
+    {
+      gtk_tree_model_filter_row_changed (priv->child_model, path, &iter, filter);
+
+      /* A handler restarted or stopped the walk, possibly by
+       * changing the child model. Pick up the new state on the
+       * next iteration.
+       */
+      if (priv->refilter_id != id || priv->refilter_path != path)
+        return G_SOURCE_CONTINUE;
+
+      if (!GTK_TREE_MODEL_FILTER_CACHE_CHILD_ITERS (filter) &&
+          !gtk_tree_model_get_iter (priv->child_model, &iter, path))
+        goto done;
+
+      if (!gtk_tree_model_filter_refilter_next (priv->child_model, &iter, path))
+        goto done;
+    }
+  while (g_get_monotonic_time () < end_time);
+
+  return G_SOURCE_CONTINUE;
+
+done:
+  gtk_tree_path_free (priv->refilter_path);
+  priv->refilter_path = NULL;
+  priv->refilter_id = 0;
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gtk_tree_model_filter_refilter_stop (GtkTreeModelFilter *filter)
+{
+  GtkTreeModelFilterPrivate *priv = filter->priv;
+
+  if (priv->refilter_id == 0)
+    return;
+
+  g_source_remove (priv->refilter_id);
+  priv->refilter_id = 0;
+  gtk_tree_path_free (priv->refilter_path);
+  priv->refilter_path = NULL;
+}
+
+static void
+gtk_tree_model_filter_refilter_restart (GtkTreeModelFilter *filter)
+{
+  GtkTreeModelFilterPrivate *priv = filter->priv;
+  GtkTreePath *old_path = priv->refilter_path;
+
+  /* allocate before freeing, a running walk notices the restart
+   * by the path changing
+   */
+  priv->refilter_path = gtk_tree_path_new_first ();
+  if (old_path)
+    gtk_tree_path_free (old_path);
+
+  if (priv->refilter_id == 0)
+    priv->refilter_id =
+      gdk_threads_add_idle_full (G_PRIORITY_DEFAULT_IDLE,
+                                 gtk_tree_model_filter_refilter_idle,
+                                 filter, NULL);
+}
+
+/* Returns the depth at which @c_path is a sibling of a row on the
+ * way to the refilter cursor, or 0 if it is not.
+ */
+static gint
+gtk_tree_model_filter_refilter_sibling_depth (GtkTreeModelFilter *filter,
+                                              GtkTreePath        *c_path)
+{
+  gint *indices, *cursor;
+  gint depth, i;
+
+  depth = gtk_tree_path_get_depth (c_path);
+  if (depth == 0 || depth > gtk_tree_path_get_depth (filter->priv->refilter_path))
+    return 0;
+
+  indices = gtk_tree_path_get_indices (c_path);
+  cursor = gtk_tree_path_get_indices (filter->priv->refilter_path);
+
+  for (i = 0; i < depth - 1; i++)
+    if (indices[i] != cursor[i])
+      return 0;
+
+  return depth;
+}
+
+/* The refilter cursor is a child path. When rows are inserted or
+ * deleted before it, it is shifted so that the walk neither skips
+ * nor repeats rows; if its own row goes away, the walk starts over.
+ */
+static void
+gtk_tree_model_filter_refilter_child_inserted (GtkTreeModelFilter *filter,
+                                               GtkTreePath        *c_path)
+{
+  gint *cursor;
+  gint depth;
+
+  if (filter->priv->refilter_id == 0)
+    return;
+
+  depth = gtk_tree_model_filter_refilter_sibling_depth (filter, c_path);
+  if (depth == 0)
+    return;
+
+  cursor = gtk_tree_path_get_indices (filter->priv->refilter_path);
+  if (gtk_tree_path_get_indices (c_path)[depth - 1] <= cursor[depth - 1])
+    cursor[depth - 1]++;
+}
+
+static void
+gtk_tree_model_filter_refilter_child_deleted (GtkTreeModelFilter *filter,
+                                              GtkTreePath        *c_path)
+{
+  gint *cursor;
+  gint depth, index;
+
+  if (filter->priv->refilter_id == 0)
+    return;
+
+  depth = gtk_tree_model_filter_refilter_sibling_depth (filter, c_path);
+  if (depth == 0)
+    return;
+
+  cursor = gtk_tree_path_get_indices (filter->priv->refilter_path);
+  index = gtk_tree_path_get_indices (c_path)[depth - 1];
+  if (index < cursor[depth - 1])
+    cursor[depth - 1]--;
+  else if (index == cursor[depth - 1])
+    gtk_tree_model_filter_refilter_restart (filter);
+}
+
+static void
+gtk_tree_model_filter_refilter_child_reordered (GtkTreeModelFilter *filter,
+                                                GtkTreePath        *c_path)
+{
+  if (filter->priv->refilter_id == 0)
+    return;
+
+  if (c_path == NULL ||
+      gtk_tree_path_get_depth (c_path) == 0 ||
+      gtk_tree_path_is_ancestor (c_path, filter->priv->refilter_path))
+    gtk_tree_model_filter_refilter_restart (filter);
+}
+
+/**
+ * gtk_tree_model_filter_refilter_incremental:
+ * @filter: A #GtkTreeModelFilter.
+ *
+ * Like gtk_tree_model_filter_refilter(), but re-evaluates the rows
+ * from an idle handler, a few milliseconds at a time, so that the
+ * user interface stays responsive while a large model is filtered.
+ * The visibility changes of each chunk are emitted together, in
+ * between redraws.
+ *
+ * Calling this function again while a refilter is in progress
+ * cancels it and starts over from the first row, which is what
+ * type-to-filter entries want on every keystroke. A call to
+ * gtk_tree_model_filter_refilter() cancels it as well.
+ *
+ * Since: 3.12
+ */
+void
+gtk_tree_model_filter_refilter_incremental (GtkTreeModelFilter *filter)
+{
+  g_return_if_fail (GTK_IS_TREE_MODEL_FILTER (filter));
+  g_return_if_fail (filter->priv->child_model != NULL);
+
+  gtk_tree_model_filter_refilter_restart (filter);
+}
+
 /**
  * gtk_tree_model_filter_clear_cache:
  * @filter: A #GtkTreeModelFilter.
@@ -4303,3 +4569,83 @@ gtk_tree_model_filter_clear_cache (GtkTreeModelFilter *filter)
     gtk_tree_model_filter_clear_cache_helper (filter,
                                               FILTER_LEVEL (filter->priv->root));
 }
+
+static gboolean
+gtk_tree_model_filter_clear_cache_timeout (gpointer data)
+{
+  GtkTreeModelFilter *filter = data;
+
+  filter->priv->cache_timeout_id = 0;
+  gtk_tree_model_filter_clear_cache (filter);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gtk_tree_model_filter_queue_clear_cache (GtkTreeModelFilter *filter)
+{
+  if (filter->priv->cache_timeout == 0 ||
+      filter->priv->cache_timeout_id != 0)
+    return;
+
+  filter->priv->cache_timeout_id =
+    gdk_threads_add_timeout_seconds (filter->priv->cache_timeout,
+                                     gtk_tree_model_filter_clear_cache_timeout,
+                                     filter);
+}
+
+/**
+ * gtk_tree_model_filter_set_cache_timeout:
+ * @filter: A #GtkTreeModelFilter.
+ * @seconds: the delay, or 0 to never clear the cache automatically
+ *
+ * Makes @filter call gtk_tree_model_filter_clear_cache() by itself,
+ * within @seconds of a level of the model losing its last reference. This
+ * keeps the memory used by @filter proportional to the rows that are
+ * actually shown, for example in a tree view where rows are expanded
+ * and collapsed a lot.
+ *
+ * Only use this if iters into @filter are either reffed with
+ * gtk_tree_model_ref_node() or not kept across main loop iterations,
+ * because clearing the cache invalidates all unreffed iters.
+ *
+ * Since: 3.12
+ */
+void
+gtk_tree_model_filter_set_cache_timeout (GtkTreeModelFilter *filter,
+                                         guint               seconds)
+{
+  g_return_if_fail (GTK_IS_TREE_MODEL_FILTER (filter));
+
+  if (filter->priv->cache_timeout == seconds)
+    return;
+
+  filter->priv->cache_timeout = seconds;
+
+  if (filter->priv->cache_timeout_id)
+    {
+      g_source_remove (filter->priv->cache_timeout_id);
+      filter->priv->cache_timeout_id = 0;
+    }
+
+  if (filter->priv->zero_ref_count > 0)
+    gtk_tree_model_filter_queue_clear_cache (filter);
+}
+
+/**
+ * gtk_tree_model_filter_get_cache_timeout:
+ * @filter: A #GtkTreeModelFilter.
+ *
+ * Gets the value set by gtk_tree_model_filter_set_cache_timeout().
+ *
+ * Returns: the delay in seconds, or 0
+ *
+ * Since: 3.12
+ */
+guint
+gtk_tree_model_filter_get_cache_timeout (GtkTreeModelFilter *filter)
+{
+  g_return_val_if_fail (GTK_IS_TREE_MODEL_FILTER (filter), 0);
+
+  return filter->priv->cache_timeout;
+}
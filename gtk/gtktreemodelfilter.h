@@ -139,7 +139,11 @@ GtkTreePath  *gtk_tree_model_filter_convert_path_to_child_path (GtkTreeModelFilt
 
 /* extras */
 void          gtk_tree_model_filter_refilter                   (GtkTreeModelFilter           *filter);
+void          gtk_tree_model_filter_refilter_incremental       (GtkTreeModelFilter           *filter);
 void          gtk_tree_model_filter_clear_cache                (GtkTreeModelFilter           *filter);
+void          gtk_tree_model_filter_set_cache_timeout          (GtkTreeModelFilter           *filter,
+                                                                guint                         seconds);
+guint         gtk_tree_model_filter_get_cache_timeout          (GtkTreeModelFilter           *filter);
 
 G_END_DECLS
 
@@ -285,6 +285,10 @@ struct _GtkTreeModelSortPrivate
   gulong has_child_toggled_id;
   gulong deleted_id;
   gulong reordered_id;
+
+  /* automatic cache clearing */
+  guint cache_timeout;
+  guint cache_timeout_id;
 };
 
 /* Set this to 0 to disable caching of child iterators.  This
@@ -446,6 +450,7 @@ static gint         gtk_tree_model_sort_offset_compare_func (gconstpointer     a
                                                              gpointer          user_data);
 static void         gtk_tree_model_sort_clear_cache_helper  (GtkTreeModelSort *tree_model_sort,
                                                              SortLevel        *level);
+static void         gtk_tree_model_sort_queue_clear_cache   (GtkTreeModelSort *tree_model_sort);
 
 
 G_DEFINE_TYPE_WITH_CODE (GtkTreeModelSort, gtk_tree_model_sort, G_TYPE_OBJECT,
@@ -1652,7 +1657,10 @@ gtk_tree_model_sort_real_unref_node (GtkTreeModel *tree_model,
 	}
 
       if (priv->root != level)
-	priv->zero_ref_count++;
+        {
+          priv->zero_ref_count++;
+          gtk_tree_model_sort_queue_clear_cache (tree_model_sort);
+        }
     }
 }
 
@@ -1900,6 +1908,352 @@ gtk_tree_model_sort_offset_compare_func (gconstpointer a,
   return retval;
 }
 
+/* Sorting with sort keys
+ *
+ * When a column is sorted with the default compare function, the
+ * values can be read from the child model once up front, strings
+ * turned into collation keys, and the comparisons done on a plain
+ * array without calling back into the child model. Large levels
+ * sort that array on several threads, the child model is only ever
+ * touched from the main thread.
+ */
+
+#define SORT_KEYS_MIN_LENGTH 1024
+#define PARALLEL_SORT_MIN_LENGTH (64 * 1024)
+#define PARALLEL_SORT_MAX_THREADS 8
+
+typedef enum {
+  SORT_KEY_INT,
+  SORT_KEY_UINT,
+  SORT_KEY_DOUBLE,
+  SORT_KEY_STRING
+} SortKeyType;
+
+typedef struct {
+  union {
+    gint64 i;
+    guint64 u;
+    gdouble d;
+    gchar *s;
+  } v;
+  gint index; /* position before sorting, breaks ties */
+  SortElt *elt;
+} SortKey;
+
+typedef struct {
+  SortKeyType type;
+  gboolean descending;
+} SortKeyOrder;
+
+typedef struct {
+  SortKey *src;
+  SortKey *dest;
+  gsize start, mid, end;
+  const SortKeyOrder *order;
+} SortKeyJob;
+
+static gint
+sort_key_compare (gconstpointer a,
+                  gconstpointer b,
+                  gpointer      user_data)
+{
+  const SortKey *ka = a;
+  const SortKey *kb = b;
+  const SortKeyOrder *order = user_data;
+  gint retval;
+
+  switch (order->type)
+    {
+    case SORT_KEY_INT:
+      retval = (ka->v.i > kb->v.i) - (ka->v.i < kb->v.i);
+      break;
+    case SORT_KEY_UINT:
+      retval = (ka->v.u > kb->v.u) - (ka->v.u < kb->v.u);
+      break;
+    case SORT_KEY_DOUBLE:
+      retval = (ka->v.d > kb->v.d) - (ka->v.d < kb->v.d);
+      break;
+    case SORT_KEY_STRING:
+      retval = strcmp (ka->v.s, kb->v.s);
+      break;
+    default:
+      g_assert_not_reached ();
+      retval = 0;
+    }
+
+  if (order->descending)
+    retval = -retval;
+
+  if (retval == 0)
+    retval = ka->index - kb->index;
+
+  return retval;
+}
+
+static gpointer
+sort_key_job_run (gpointer user_data)
+{
+  SortKeyJob *job = user_data;
+  gsize i, j, k;
+
+  if (job->dest == NULL)
+    {
+      g_qsort_with_data (job->src + job->start, job->end - job->start,
+                         sizeof (SortKey), sort_key_compare,
+                         (gpointer) job->order);
+      return NULL;
+    }
+
+  i = job->start;
+  j = job->mid;
+  k = job->start;
+  while (i < job->mid && j < job->end)
+    {
+      if (sort_key_compare (&job->src[i], &job->src[j], (gpointer) job->order) <= 0)
+        job->dest[k++] = job->src[i++];
+      else
+        job->dest[k++] = job->src[j++];
+    }
+  while (i < job->mid)
+    job->dest[k++] = job->src[i++];
+  while (j < job->end)
+    job->dest[k++] = job->src[j++];
+
+  return NULL;
+}
+
+/* Runs @jobs, all but the first on their own thread */
+static void
+sort_key_jobs_run (SortKeyJob *jobs,
+                   guint       n_jobs)
+{
+  GThread *threads[PARALLEL_SORT_MAX_THREADS];
+  guint i;
+
+  for (i = 1; i < n_jobs; i++)
+    threads[i] = g_thread_new ("gtk-sort", sort_key_job_run, &jobs[i]);
+
+  sort_key_job_run (&jobs[0]);
+
+  for (i = 1; i < n_jobs; i++)
+    g_thread_join (threads[i]);
+}
+
+/* Sorts the chunks of @keys in parallel and then merges pairs of
+ * neighboring chunks, also in parallel, until one is left.
+ */
+static void
+sort_keys (SortKey            *keys,
+           gsize               n_keys,
+           const SortKeyOrder *order)
+{
+  SortKeyJob jobs[PARALLEL_SORT_MAX_THREADS];
+  gsize bounds[PARALLEL_SORT_MAX_THREADS + 1];
+  SortKey *src, *dest, *tmp;
+  guint n_chunks, n_threads, i;
+
+  n_threads = MIN (g_get_num_processors (), PARALLEL_SORT_MAX_THREADS);
+  for (n_chunks = 1; n_chunks * 2 <= n_threads; n_chunks *= 2)
+    ;
+
+  if (n_keys < PARALLEL_SORT_MIN_LENGTH || n_chunks == 1)
+    {
+      g_qsort_with_data (keys, n_keys, sizeof (SortKey),
+                         sort_key_compare, (gpointer) order);
+      return;
+    }
+
+  for (i = 0; i <= n_chunks; i++)
+    bounds[i] = n_keys * i / n_chunks;
+
+  for (i = 0; i < n_chunks; i++)
+    {
+      jobs[i].src = keys;
+      jobs[i].dest = NULL;
+      jobs[i].start = bounds[i];
+      jobs[i].mid = bounds[i + 1];
+      jobs[i].end = bounds[i + 1];
+      jobs[i].order = order;
+    }
+  sort_key_jobs_run (jobs, n_chunks);
+
+  src = keys;
+  dest = tmp = g_new (SortKey, n_keys);
+
+  for (; n_chunks > 1; n_chunks /= 2)
+    {
+      for (i = 0; i < n_chunks / 2; i++)
+        {
+          jobs[i].src = src;
+          jobs[i].dest = dest;
+          jobs[i].start = bounds[2 * i];
+          jobs[i].mid = bounds[2 * i + 1];
+          jobs[i].end = bounds[2 * i + 2];
+          jobs[i].order = order;
+        }
+      sort_key_jobs_run (jobs, n_chunks / 2);
+
+      for (i = 0; i <= n_chunks / 2; i++)
+        bounds[i] = bounds[2 * i];
+
+      dest = src;
+      src = jobs[0].dest;
+    }
+
+  if (src != keys)
+    memcpy (keys, src, n_keys * sizeof (SortKey));
+
+  g_free (tmp);
+}
+
+static gboolean
+gtk_tree_model_sort_sort_level_by_keys (GtkTreeModelSort *tree_model_sort,
+                                        SortLevel        *level,
+                                        SortData         *data)
+{
+  GtkTreeModelSortPrivate *priv = tree_model_sort->priv;
+  GSequenceIter *siter, *end_siter;
+  SortKeyOrder order;
+  SortKey *keys;
+  gint column, n_keys, i;
+  GType type;
+
+  if (data->sort_func != _gtk_tree_data_list_compare_func)
+    return FALSE;
+
+  n_keys = g_sequence_get_length (level->seq);
+  if (n_keys < SORT_KEYS_MIN_LENGTH)
+    return FALSE;
+
+  column = GPOINTER_TO_INT (data->sort_data);
+  type = gtk_tree_model_get_column_type (priv->child_model, column);
+
+  switch (G_TYPE_FUNDAMENTAL (type))
+    {
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_CHAR:
+    case G_TYPE_INT:
+    case G_TYPE_LONG:
+    case G_TYPE_INT64:
+    case G_TYPE_ENUM:
+      order.type = SORT_KEY_INT;
+      break;
+    case G_TYPE_UCHAR:
+    case G_TYPE_UINT:
+    case G_TYPE_ULONG:
+    case G_TYPE_UINT64:
+    case G_TYPE_FLAGS:
+      order.type = SORT_KEY_UINT;
+      break;
+    case G_TYPE_FLOAT:
+    case G_TYPE_DOUBLE:
+      order.type = SORT_KEY_DOUBLE;
+      break;
+    case G_TYPE_STRING:
+      order.type = SORT_KEY_STRING;
+      break;
+    default:
+      /* Let the compare function warn */
+      return FALSE;
+    }
+  order.descending = priv->order == GTK_SORT_DESCENDING;
+
+  keys = g_new (SortKey, n_keys);
+
+  i = 0;
+  end_siter = g_sequence_get_end_iter (level->seq);
+  for (siter = g_sequence_get_begin_iter (level->seq);
+       siter != end_siter;
+       siter = g_sequence_iter_next (siter))
+    {
+      SortElt *elt = g_sequence_get (siter);
+      GValue value = G_VALUE_INIT;
+      GtkTreeIter child_iter;
+      const gchar *str;
+
+      if (GTK_TREE_MODEL_SORT_CACHE_CHILD_ITERS (tree_model_sort))
+        child_iter = elt->iter;
+      else
+        {
+          data->parent_path_indices [data->parent_path_depth-1] = elt->offset;
+          gtk_tree_model_get_iter (GTK_TREE_MODEL (priv->child_model), &child_iter, data->parent_path);
+        }
+
+      gtk_tree_model_get_value (priv->child_model, &child_iter, column, &value);
+
+      switch (G_TYPE_FUNDAMENTAL (type))
+        {
+        case G_TYPE_BOOLEAN:
+          keys[i].v.i = g_value_get_boolean (&value);
+          break;
+        case G_TYPE_CHAR:
+          keys[i].v.i = g_value_get_schar (&value);
+          break;
+        case G_TYPE_INT:
+          keys[i].v.i = g_value_get_int (&value);
+          break;
+        case G_TYPE_LONG:
+          keys[i].v.i = g_value_get_long (&value);
+          break;
+        case G_TYPE_INT64:
+          keys[i].v.i = g_value_get_int64 (&value);
+          break;
+        case G_TYPE_ENUM:
+          keys[i].v.i = g_value_get_enum (&value);
+          break;
+        case G_TYPE_UCHAR:
+          keys[i].v.u = g_value_get_uchar (&value);
+          break;
+        case G_TYPE_UINT:
+          keys[i].v.u = g_value_get_uint (&value);
+          break;
+        case G_TYPE_ULONG:
+          keys[i].v.u = g_value_get_ulong (&value);
+          break;
+        case G_TYPE_UINT64:
+          keys[i].v.u = g_value_get_uint64 (&value);
+          break;
+        case G_TYPE_FLAGS:
+          keys[i].v.u = g_value_get_flags (&value);
+          break;
+        case G_TYPE_FLOAT:
+          keys[i].v.d = g_value_get_float (&value);
+          break;
+        case G_TYPE_DOUBLE:
+          keys[i].v.d = g_value_get_double (&value);
+          break;
+        case G_TYPE_STRING:
+          /* strcmp() on these orders like g_utf8_collate() */
+          str = g_value_get_string (&value);
+          keys[i].v.s = g_utf8_collate_key (str ? str : "", -1);
+          break;
+        default:
+          g_assert_not_reached ();
+        }
+
+      g_value_unset (&value);
+
+      keys[i].index = i;
+      keys[i].elt = elt;
+      i++;
+    }
+
+  sort_keys (keys, n_keys, &order);
+
+  /* Moving every element to the end in order leaves them sorted */
+  for (i = 0; i < n_keys; i++)
+    g_sequence_move (keys[i].elt->siter, end_siter);
+
+  if (order.type == SORT_KEY_STRING)
+    {
+      for (i = 0; i < n_keys; i++)
+        g_free (keys[i].v.s);
+    }
+  g_free (keys);
+
+  return TRUE;
+}
+
 static void
 gtk_tree_model_sort_sort_level (GtkTreeModelSort *tree_model_sort,
 				SortLevel        *level,
@@ -1948,7 +2302,7 @@ gtk_tree_model_sort_sort_level (GtkTreeModelSort *tree_model_sort,
   if (data.sort_func == NO_SORT_FUNC)
     g_sequence_sort (level->seq, gtk_tree_model_sort_offset_compare_func,
                      &data);
-  else
+  else if (!gtk_tree_model_sort_sort_level_by_keys (tree_model_sort, level, &data))
     g_sequence_sort (level->seq, gtk_tree_model_sort_compare_func, &data);
 
   free_sort_data (&data);
@@ -2146,6 +2500,12 @@ gtk_tree_model_sort_set_model (GtkTreeModelSort *tree_model_sort,
 
   if (priv->child_model)
     {
+      if (priv->cache_timeout_id)
+        {
+          g_source_remove (priv->cache_timeout_id);
+          priv->cache_timeout_id = 0;
+        }
+
       g_signal_handler_disconnect (priv->child_model,
                                    priv->changed_id);
       g_signal_handler_disconnect (priv->child_model,
@@ -2536,7 +2896,10 @@ gtk_tree_model_sort_build_level (GtkTreeModelSort *tree_model_sort,
     }
 
   if (new_level != priv->root)
-    priv->zero_ref_count++;
+    {
+      priv->zero_ref_count++;
+      gtk_tree_model_sort_queue_clear_cache (tree_model_sort);
+    }
 
   for (i = 0; i < length; i++)
     {
@@ -2747,6 +3110,91 @@ gtk_tree_model_sort_clear_cache (GtkTreeModelSort *tree_model_sort)
     gtk_tree_model_sort_clear_cache_helper (tree_model_sort, (SortLevel *)tree_model_sort->priv->root);
 }
 
+static gboolean
+gtk_tree_model_sort_clear_cache_timeout (gpointer data)
+{
+  GtkTreeModelSort *tree_model_sort = data;
+
+  tree_model_sort->priv->cache_timeout_id = 0;
+  gtk_tree_model_sort_clear_cache (tree_model_sort);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gtk_tree_model_sort_queue_clear_cache (GtkTreeModelSort *tree_model_sort)
+{
+  GtkTreeModelSortPrivate *priv = tree_model_sort->priv;
+
+  if (priv->cache_timeout == 0 || priv->cache_timeout_id != 0)
+    return;
+
+  priv->cache_timeout_id =
+    gdk_threads_add_timeout_seconds (priv->cache_timeout,
+                                     gtk_tree_model_sort_clear_cache_timeout,
+                                     tree_model_sort);
+}
+
+/**
+ * gtk_tree_model_sort_set_cache_timeout:
+ * @tree_model_sort: A #GtkTreeModelSort
+ * @seconds: the delay, or 0 to never clear the cache automatically
+ *
+ * Makes @tree_model_sort call gtk_tree_model_sort_clear_cache() by
+ * itself, within @seconds of a level of the model losing its last
+ * reference. This keeps the memory used by @tree_model_sort
+ * proportional to the rows that are actually shown.
+ *
+ * Only use this if iters into @tree_model_sort are either reffed
+ * with gtk_tree_model_ref_node() or not kept across main loop
+ * iterations, because clearing the cache invalidates all unreffed
+ * iters.
+ *
+ * Since: 3.12
+ */
+void
+gtk_tree_model_sort_set_cache_timeout (GtkTreeModelSort *tree_model_sort,
+                                       guint             seconds)
+{
+  GtkTreeModelSortPrivate *priv;
+
+  g_return_if_fail (GTK_IS_TREE_MODEL_SORT (tree_model_sort));
+
+  priv = tree_model_sort->priv;
+
+  if (priv->cache_timeout == seconds)
+    return;
+
+  priv->cache_timeout = seconds;
+
+  if (priv->cache_timeout_id)
+    {
+      g_source_remove (priv->cache_timeout_id);
+      priv->cache_timeout_id = 0;
+    }
+
+  if (priv->zero_ref_count > 0)
+    gtk_tree_model_sort_queue_clear_cache (tree_model_sort);
+}
+
+/**
+ * gtk_tree_model_sort_get_cache_timeout:
+ * @tree_model_sort: A #GtkTreeModelSort
+ *
+ * Gets the value set by gtk_tree_model_sort_set_cache_timeout().
+ *
+ * Returns: the delay in seconds, or 0
+ *
+ * Since: 3.12
+ */
+guint
+gtk_tree_model_sort_get_cache_timeout (GtkTreeModelSort *tree_model_sort)
+{
+  g_return_val_if_fail (GTK_IS_TREE_MODEL_SORT (tree_model_sort), 0);
+
+  return tree_model_sort->priv->cache_timeout;
+}
+
 static gboolean
 gtk_tree_model_sort_iter_is_valid_helper (GtkTreeIter *iter,
 					  SortLevel   *level)
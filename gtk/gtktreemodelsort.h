@@ -77,6 +77,9 @@ void          gtk_tree_model_sort_convert_iter_to_child_iter (GtkTreeModelSort *
 							      GtkTreeIter      *sorted_iter);
 void          gtk_tree_model_sort_reset_default_sort_func    (GtkTreeModelSort *tree_model_sort);
 void          gtk_tree_model_sort_clear_cache                (GtkTreeModelSort *tree_model_sort);
+void          gtk_tree_model_sort_set_cache_timeout          (GtkTreeModelSort *tree_model_sort,
+                                                              guint             seconds);
+guint         gtk_tree_model_sort_get_cache_timeout          (GtkTreeModelSort *tree_model_sort);
 gboolean      gtk_tree_model_sort_iter_is_valid              (GtkTreeModelSort *tree_model_sort,
                                                               GtkTreeIter      *iter);
 
@@ -146,6 +146,9 @@ void		  _gtk_tree_view_column_cell_render      (GtkTreeViewColumn  *tree_column,
 void		  _gtk_tree_view_column_cell_set_dirty	 (GtkTreeViewColumn  *tree_column,
 							  gboolean            install_handler);
 gboolean          _gtk_tree_view_column_cell_get_dirty   (GtkTreeViewColumn  *tree_column);
+void              _gtk_tree_view_column_set_widest_node  (GtkTreeViewColumn  *tree_column,
+                                                          GtkRBNode          *node);
+GtkRBNode        *_gtk_tree_view_column_get_widest_node  (GtkTreeViewColumn  *tree_column);
 GdkWindow        *_gtk_tree_view_column_get_window       (GtkTreeViewColumn  *column);
 
 void              _gtk_tree_view_column_push_padding          (GtkTreeViewColumn  *column,
@@ -0,0 +1,403 @@
+/* GTK - The GIMP Toolkit
+ * Copyright (C) 2013 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtktreesearchindexprivate.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* A prefix index over one column of a flat model, used by the
+ * interactive search of GtkTreeView.
+ *
+ * keys holds the search key of every row, in row order; it is NULL
+ * for rows whose value can't be turned into a string. order holds
+ * the rows that have a key, sorted by key and then by row. All
+ * rows whose key starts with a given prefix are then next to each
+ * other in order, and can be found with two binary searches.
+ *
+ * Row insertions and deletions shift the row numbers in order,
+ * but never change their relative order, so the index is kept up
+ * to date without looking at any other row.
+ */
+
+struct _GtkTreeSearchIndex
+{
+  GtkTreeModel *model;
+  gint column;
+
+  GPtrArray *keys;
+  GArray *order;
+};
+
+#define ORDER(index, i) (g_array_index ((index)->order, gint, (i)))
+#define KEY(index, row) ((const gchar *) g_ptr_array_index ((index)->keys, (row)))
+
+/*
+ * _gtk_tree_search_index_make_key:
+ * @str: a string
+ *
+ * Normalizes and casefolds @str, the way the default search equal
+ * function of GtkTreeView compares strings.
+ *
+ * Returns: a newly allocated string or %NULL
+ */
+gchar *
+_gtk_tree_search_index_make_key (const gchar *str)
+{
+  gchar *normalized, *key;
+
+  normalized = g_utf8_normalize (str, -1, G_NORMALIZE_ALL);
+  if (normalized == NULL)
+    return NULL;
+
+  key = g_utf8_casefold (normalized, -1);
+  g_free (normalized);
+
+  return key;
+}
+
+static gchar *
+gtk_tree_search_index_get_key (GtkTreeSearchIndex *index,
+                               GtkTreeIter        *iter)
+{
+  GValue value = G_VALUE_INIT;
+  GValue transformed = G_VALUE_INIT;
+  const gchar *str;
+  gchar *key = NULL;
+
+  gtk_tree_model_get_value (index->model, iter, index->column, &value);
+
+  g_value_init (&transformed, G_TYPE_STRING);
+
+  if (g_value_transform (&value, &transformed))
+    {
+      str = g_value_get_string (&transformed);
+      if (str)
+        key = _gtk_tree_search_index_make_key (str);
+    }
+
+  g_value_unset (&transformed);
+  g_value_unset (&value);
+
+  return key;
+}
+
+static gint
+gtk_tree_search_index_compare (GtkTreeSearchIndex *index,
+                               const gchar        *key,
+                               gint                row,
+                               gint                other_row)
+{
+  gint cmp;
+
+  cmp = strcmp (key, KEY (index, other_row));
+  if (cmp != 0)
+    return cmp;
+
+  return row - other_row;
+}
+
+static gint
+gtk_tree_search_index_sort_func (gconstpointer a,
+                                 gconstpointer b,
+                                 gpointer      data)
+{
+  GtkTreeSearchIndex *index = data;
+  gint row_a = *(const gint *) a;
+  gint row_b = *(const gint *) b;
+
+  return gtk_tree_search_index_compare (index, KEY (index, row_a), row_a, row_b);
+}
+
+/* Returns the position in order at which @row, with @key, is or
+ * would be.
+ */
+static guint
+gtk_tree_search_index_find (GtkTreeSearchIndex *index,
+                            const gchar        *key,
+                            gint                row)
+{
+  guint lo = 0, hi = index->order->len;
+
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (gtk_tree_search_index_compare (index, key, row, ORDER (index, mid)) > 0)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return lo;
+}
+
+/* Returns the first position in order whose key, cut to the length
+ * of @prefix, compares greater than @prefix (if @after is %TRUE) or
+ * not less than @prefix (if @after is %FALSE).
+ */
+static guint
+gtk_tree_search_index_find_prefix (GtkTreeSearchIndex *index,
+                                   const gchar        *prefix,
+                                   gsize               len,
+                                   gboolean            after)
+{
+  guint lo = 0, hi = index->order->len;
+
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+      gint cmp = strncmp (KEY (index, ORDER (index, mid)), prefix, len);
+
+      if (cmp < 0 || (after && cmp == 0))
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return lo;
+}
+
+static void
+gtk_tree_search_index_add (GtkTreeSearchIndex *index,
+                           gint                row)
+{
+  const gchar *key = KEY (index, row);
+  guint pos;
+
+  if (key == NULL)
+    return;
+
+  pos = gtk_tree_search_index_find (index, key, row);
+  g_array_insert_val (index->order, pos, row);
+}
+
+static void
+gtk_tree_search_index_remove (GtkTreeSearchIndex *index,
+                              gint                row)
+{
+  const gchar *key = KEY (index, row);
+  guint pos;
+
+  if (key == NULL)
+    return;
+
+  pos = gtk_tree_search_index_find (index, key, row);
+  g_assert (pos < index->order->len && ORDER (index, pos) == row);
+  g_array_remove_index (index->order, pos);
+}
+
+/*
+ * _gtk_tree_search_index_new:
+ * @model: a flat model
+ * @column: the column to index
+ *
+ * Reads the search keys of all rows of @model. The index does not
+ * keep a reference on @model and has to be told about every change
+ * to it.
+ */
+GtkTreeSearchIndex *
+_gtk_tree_search_index_new (GtkTreeModel *model,
+                            gint          column)
+{
+  GtkTreeSearchIndex *index;
+  GtkTreeIter iter;
+  gint n_rows, row;
+
+  n_rows = gtk_tree_model_iter_n_children (model, NULL);
+
+  index = g_slice_new (GtkTreeSearchIndex);
+  index->model = model;
+  index->column = column;
+  index->keys = g_ptr_array_new_full (n_rows, g_free);
+  index->order = g_array_sized_new (FALSE, FALSE, sizeof (gint), n_rows);
+
+  if (gtk_tree_model_get_iter_first (model, &iter))
+    {
+      row = 0;
+      do
+        {
+          gchar *key = gtk_tree_search_index_get_key (index, &iter);
+
+          g_ptr_array_add (index->keys, key);
+          if (key)
+            g_array_append_val (index->order, row);
+          row++;
+        }
+      while (gtk_tree_model_iter_next (model, &iter));
+    }
+
+  g_qsort_with_data (index->order->data, index->order->len, sizeof (gint),
+                     gtk_tree_search_index_sort_func, index);
+
+  return index;
+}
+
+void
+_gtk_tree_search_index_free (GtkTreeSearchIndex *index)
+{
+  g_ptr_array_unref (index->keys);
+  g_array_free (index->order, TRUE);
+
+  g_slice_free (GtkTreeSearchIndex, index);
+}
+
+void
+_gtk_tree_search_index_row_changed (GtkTreeSearchIndex *index,
+                                    gint                row,
+                                    GtkTreeIter        *iter)
+{
+  g_return_if_fail (row >= 0 && (guint) row < index->keys->len);
+
+  gtk_tree_search_index_remove (index, row);
+
+  g_free (g_ptr_array_index (index->keys, row));
+  g_ptr_array_index (index->keys, row) = gtk_tree_search_index_get_key (index, iter);
+
+  gtk_tree_search_index_add (index, row);
+}
+
+void
+_gtk_tree_search_index_row_inserted (GtkTreeSearchIndex *index,
+                                     gint                row,
+                                     GtkTreeIter        *iter)
+{
+  guint i;
+
+  g_return_if_fail (row >= 0 && (guint) row <= index->keys->len);
+
+  for (i = 0; i < index->order->len; i++)
+    if (ORDER (index, i) >= row)
+      ORDER (index, i)++;
+
+  /* There is no g_ptr_array_insert() yet, so grow and shift by hand */
+  g_ptr_array_add (index->keys, NULL);
+  memmove (index->keys->pdata + row + 1,
+           index->keys->pdata + row,
+           (index->keys->len - row - 1) * sizeof (gpointer));
+  g_ptr_array_index (index->keys, row) = gtk_tree_search_index_get_key (index, iter);
+
+  gtk_tree_search_index_add (index, row);
+}
+
+void
+_gtk_tree_search_index_row_deleted (GtkTreeSearchIndex *index,
+                                    gint                row)
+{
+  guint i;
+
+  g_return_if_fail (row >= 0 && (guint) row < index->keys->len);
+
+  gtk_tree_search_index_remove (index, row);
+  g_ptr_array_remove_index (index->keys, row);
+
+  for (i = 0; i < index->order->len; i++)
+    if (ORDER (index, i) > row)
+      ORDER (index, i)--;
+}
+
+void
+_gtk_tree_search_index_rows_reordered (GtkTreeSearchIndex *index,
+                                       gint               *new_order)
+{
+  gpointer *old_keys;
+  gint *new_rows;
+  guint i, n_rows;
+
+  n_rows = index->keys->len;
+  old_keys = g_memdup (index->keys->pdata, n_rows * sizeof (gpointer));
+  new_rows = g_new (gint, n_rows);
+
+  for (i = 0; i < n_rows; i++)
+    {
+      index->keys->pdata[i] = old_keys[new_order[i]];
+      new_rows[new_order[i]] = i;
+    }
+
+  for (i = 0; i < index->order->len; i++)
+    ORDER (index, i) = new_rows[ORDER (index, i)];
+
+  /* rows with equal keys may have changed their relative order */
+  g_qsort_with_data (index->order->data, index->order->len, sizeof (gint),
+                     gtk_tree_search_index_sort_func, index);
+
+  g_free (new_rows);
+  g_free (old_keys);
+}
+
+static gint
+compare_rows (gconstpointer a,
+              gconstpointer b)
+{
+  return *(const gint *) a - *(const gint *) b;
+}
+
+/*
+ * _gtk_tree_search_index_lookup:
+ * @index: a search index
+ * @text: the text to search for
+ * @n: which match to look for, starting at 1
+ *
+ * Finds the rows whose key starts with the key of @text.
+ *
+ * Returns: the @n-th of these rows, in model order, or -1 if there
+ *   are fewer than @n matches.
+ */
+gint
+_gtk_tree_search_index_lookup (GtkTreeSearchIndex *index,
+                               const gchar        *text,
+                               gint                n)
+{
+  gchar *prefix;
+  gsize len;
+  guint first, last, i;
+  gint result = -1;
+
+  g_return_val_if_fail (n >= 1, -1);
+
+  prefix = _gtk_tree_search_index_make_key (text);
+  if (prefix == NULL)
+    return -1;
+
+  len = strlen (prefix);
+  first = gtk_tree_search_index_find_prefix (index, prefix, len, FALSE);
+  last = gtk_tree_search_index_find_prefix (index, prefix, len, TRUE);
+  g_free (prefix);
+
+  if (last - first < (guint) n)
+    return -1;
+
+  if (n == 1)
+    {
+      result = ORDER (index, first);
+      for (i = first + 1; i < last; i++)
+        result = MIN (result, ORDER (index, i));
+    }
+  else
+    {
+      gint *rows;
+
+      rows = g_memdup (&ORDER (index, first), (last - first) * sizeof (gint));
+      qsort (rows, last - first, sizeof (gint), compare_rows);
+      result = rows[n - 1];
+      g_free (rows);
+    }
+
+  return result;
+}
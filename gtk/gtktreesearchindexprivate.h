@@ -0,0 +1,50 @@
+/* GTK - The GIMP Toolkit
+ * Copyright (C) 2013 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_TREE_SEARCH_INDEX_PRIVATE_H__
+#define __GTK_TREE_SEARCH_INDEX_PRIVATE_H__
+
+#include "gtktreemodel.h"
+
+G_BEGIN_DECLS
+
+typedef struct _GtkTreeSearchIndex GtkTreeSearchIndex;
+
+GtkTreeSearchIndex * _gtk_tree_search_index_new           (GtkTreeModel       *model,
+                                                           gint                column);
+void                 _gtk_tree_search_index_free          (GtkTreeSearchIndex *index);
+
+gchar *              _gtk_tree_search_index_make_key      (const gchar        *str);
+
+void                 _gtk_tree_search_index_row_changed   (GtkTreeSearchIndex *index,
+                                                           gint                row,
+                                                           GtkTreeIter        *iter);
+void                 _gtk_tree_search_index_row_inserted  (GtkTreeSearchIndex *index,
+                                                           gint                row,
+                                                           GtkTreeIter        *iter);
+void                 _gtk_tree_search_index_row_deleted   (GtkTreeSearchIndex *index,
+                                                           gint                row);
+void                 _gtk_tree_search_index_rows_reordered (GtkTreeSearchIndex *index,
+                                                           gint               *new_order);
+
+gint                 _gtk_tree_search_index_lookup        (GtkTreeSearchIndex *index,
+                                                           const gchar        *text,
+                                                           gint                n);
+
+G_END_DECLS
+
+#endif /* __GTK_TREE_SEARCH_INDEX_PRIVATE_H__ */
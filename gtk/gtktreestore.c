@@ -76,12 +76,18 @@ struct _GtkTreeStorePrivate
   GtkTreeIterCompareFunc default_sort_func;
   gpointer default_sort_data;
   GDestroyNotify default_sort_destroy;
+  GHashTable *levels;
   guint columns_dirty : 1;
 };
 
 
 #define G_NODE(node) ((GNode *)node)
 #define GTK_TREE_STORE_IS_SORTED(tree) (((GtkTreeStore*)(tree))->priv->sort_column_id != GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID)
+/* Levels with at least this many children get an index for
+ * looking up the nth child
+ */
+#define LEVEL_INDEX_THRESHOLD 64
+
 #define VALID_ITER(iter, tree_store) ((iter)!= NULL && (iter)->user_data != NULL && ((GtkTreeStore*)(tree_store))->priv->stamp == (iter)->stamp)
 
 static void         gtk_tree_store_tree_model_init (GtkTreeModelIface *iface);
@@ -130,6 +136,7 @@ static void gtk_tree_store_set_column_type (GtkTreeStore *tree_store,
 					    GType         type);
 
 static void gtk_tree_store_increment_stamp (GtkTreeStore  *tree_store);
+static void gtk_tree_store_invalidate_levels (GtkTreeStore *tree_store);
 
 
 /* DND interfaces */
@@ -486,6 +493,9 @@ gtk_tree_store_finalize (GObject *object)
   _gtk_tree_data_list_header_free (priv->sort_list);
   g_free (priv->column_headers);
 
+  if (priv->levels)
+    g_hash_table_unref (priv->levels);
+
   if (priv->default_sort_destroy)
     {
       GDestroyNotify d = priv->default_sort_destroy;
@@ -773,6 +783,44 @@ gtk_tree_store_iter_n_children (GtkTreeModel *tree_model,
   return i;
 }
 
+/* Looking up a child by position in a GNode means walking the sibling
+ * list, which makes path lookups in large levels slow. So large levels
+ * get an array of their children, which is dropped whenever the
+ * structure of the tree changes.
+ */
+static GNode *
+gtk_tree_store_nth_child_node (GtkTreeStore *tree_store,
+                               GNode        *parent_node,
+                               gint          n)
+{
+  GtkTreeStorePrivate *priv = tree_store->priv;
+  GPtrArray *children;
+
+  if (n < LEVEL_INDEX_THRESHOLD)
+    return g_node_nth_child (parent_node, n);
+
+  if (priv->levels == NULL)
+    priv->levels = g_hash_table_new_full (NULL, NULL, NULL,
+                                          (GDestroyNotify) g_ptr_array_unref);
+
+  children = g_hash_table_lookup (priv->levels, parent_node);
+  if (children == NULL)
+    {
+      GNode *node;
+
+      children = g_ptr_array_new ();
+      for (node = parent_node->children; node; node = node->next)
+        g_ptr_array_add (children, node);
+
+      g_hash_table_insert (priv->levels, parent_node, children);
+    }
+
+  if ((guint) n >= children->len)
+    return NULL;
+
+  return g_ptr_array_index (children, n);
+}
+
 static gboolean
 gtk_tree_store_iter_nth_child (GtkTreeModel *tree_model,
 			       GtkTreeIter  *iter,
@@ -791,7 +839,7 @@ gtk_tree_store_iter_nth_child (GtkTreeModel *tree_model,
   else
     parent_node = parent->user_data;
 
-  child = g_node_nth_child (parent_node, n);
+  child = gtk_tree_store_nth_child_node (tree_store, parent_node, n);
 
   if (child)
     {
@@ -1229,6 +1277,7 @@ gtk_tree_store_remove (GtkTreeStore *tree_store,
   path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), iter);
   g_node_destroy (G_NODE (iter->user_data));
 
+  gtk_tree_store_invalidate_levels (tree_store);
   gtk_tree_model_row_deleted (GTK_TREE_MODEL (tree_store), path);
 
   if (parent != G_NODE (priv->root))
@@ -1307,6 +1356,7 @@ gtk_tree_store_insert (GtkTreeStore *tree_store,
   g_node_insert (parent_node, position, new_node);
 
   path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), iter);
+  gtk_tree_store_invalidate_levels (tree_store);
   gtk_tree_model_row_inserted (GTK_TREE_MODEL (tree_store), path, iter);
 
   if (parent_node != priv->root)
@@ -1383,6 +1433,7 @@ gtk_tree_store_insert_before (GtkTreeStore *tree_store,
   iter->user_data = new_node;
 
   path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), iter);
+  gtk_tree_store_invalidate_levels (tree_store);
   gtk_tree_model_row_inserted (GTK_TREE_MODEL (tree_store), path, iter);
 
   if (parent_node != priv->root)
@@ -1465,6 +1516,7 @@ gtk_tree_store_insert_after (GtkTreeStore *tree_store,
   iter->user_data = new_node;
 
   path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), iter);
+  gtk_tree_store_invalidate_levels (tree_store);
   gtk_tree_model_row_inserted (GTK_TREE_MODEL (tree_store), path, iter);
 
   if (parent_node != priv->root)
@@ -1562,6 +1614,7 @@ gtk_tree_store_insert_with_values (GtkTreeStore *tree_store,
     gtk_tree_store_sort_iter_changed (tree_store, iter, priv->sort_column_id, FALSE);
 
   path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), iter);
+  gtk_tree_store_invalidate_levels (tree_store);
   gtk_tree_model_row_inserted (GTK_TREE_MODEL (tree_store), path, iter);
 
   if (parent_node != priv->root)
@@ -1640,6 +1693,7 @@ gtk_tree_store_insert_with_valuesv (GtkTreeStore *tree_store,
     gtk_tree_store_sort_iter_changed (tree_store, iter, priv->sort_column_id, FALSE);
 
   path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), iter);
+  gtk_tree_store_invalidate_levels (tree_store);
   gtk_tree_model_row_inserted (GTK_TREE_MODEL (tree_store), path, iter);
 
   if (parent_node != priv->root)
@@ -1656,6 +1710,119 @@ gtk_tree_store_insert_with_valuesv (GtkTreeStore *tree_store,
   validate_tree ((GtkTreeStore *)tree_store);
 }
 
+/**
+ * gtk_tree_store_insert_many:
+ * @tree_store: A #GtkTreeStore
+ * @parent: (allow-none): A valid #GtkTreeIter, or %NULL
+ * @position: position to insert the first new row, or -1 to append
+ * @n_rows: the number of rows to insert
+ * @columns: (array length=n_values): an array of column numbers
+ * @values: (array): an array of @n_rows times @n_values GValues, the
+ *     values of the first row followed by those of the second row and
+ *     so on
+ * @n_values: the number of values per row, the length of @columns
+ *
+ * Inserts @n_rows children of @parent starting at @position, filled
+ * in with @values. This is the same as calling
+ * gtk_tree_store_insert_with_valuesv() with increasing positions,
+ * but takes linear instead of quadratic time: finding a child by
+ * position and computing its path both walk all siblings before it,
+ * and this is only done for the first new row.
+ *
+ * A #GtkTreeModel::row-inserted signal is still emitted for every
+ * row once it has been filled in. Handlers must not add or remove
+ * children of @parent while the rows are inserted.
+ *
+ * Since: 3.12
+ */
+void
+gtk_tree_store_insert_many (GtkTreeStore *tree_store,
+                            GtkTreeIter  *parent,
+                            gint          position,
+                            gint          n_rows,
+                            gint         *columns,
+                            GValue       *values,
+                            gint          n_values)
+{
+  GtkTreeStorePrivate *priv = tree_store->priv;
+  GtkTreePath *path = NULL;
+  GNode *parent_node;
+  GNode *new_node;
+  GNode *prev = NULL;
+  GtkTreeIter iter;
+  gboolean had_children;
+  gint i;
+
+  g_return_if_fail (GTK_IS_TREE_STORE (tree_store));
+  g_return_if_fail (n_rows >= 0);
+  g_return_if_fail (n_rows == 0 || n_values == 0 || (columns != NULL && values != NULL));
+
+  if (parent)
+    g_return_if_fail (VALID_ITER (parent, tree_store));
+
+  if (n_rows == 0)
+    return;
+
+  if (parent)
+    parent_node = parent->user_data;
+  else
+    parent_node = priv->root;
+
+  priv->columns_dirty = TRUE;
+
+  had_children = parent_node->children != NULL;
+
+  for (i = 0; i < n_rows; i++)
+    {
+      gboolean changed = FALSE;
+      gboolean maybe_need_sort = FALSE;
+
+      new_node = g_node_new (NULL);
+
+      iter.stamp = priv->stamp;
+      iter.user_data = new_node;
+      if (prev == NULL)
+        g_node_insert (parent_node, position, new_node);
+      else
+        g_node_insert_after (parent_node, prev, new_node);
+
+      gtk_tree_store_set_vector_internal (tree_store, &iter,
+                                          &changed, &maybe_need_sort,
+                                          columns, values + i * n_values,
+                                          n_values);
+
+      if (maybe_need_sort && GTK_TREE_STORE_IS_SORTED (tree_store))
+        {
+          gtk_tree_store_sort_iter_changed (tree_store, &iter, priv->sort_column_id, FALSE);
+          g_clear_pointer (&path, gtk_tree_path_free);
+        }
+
+      if (path == NULL)
+        path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), &iter);
+      else
+        gtk_tree_path_next (path);
+
+      gtk_tree_store_invalidate_levels (tree_store);
+      gtk_tree_model_row_inserted (GTK_TREE_MODEL (tree_store), path, &iter);
+
+      if (!had_children && parent_node != priv->root)
+        {
+          GtkTreePath *parent_path = gtk_tree_path_copy (path);
+
+          gtk_tree_path_up (parent_path);
+          gtk_tree_model_row_has_child_toggled (GTK_TREE_MODEL (tree_store), parent_path, parent);
+          gtk_tree_path_free (parent_path);
+          had_children = TRUE;
+        }
+
+      prev = new_node;
+    }
+
+  gtk_tree_path_free (path);
+
+  validate_tree ((GtkTreeStore *)tree_store);
+}
+
 /**
  * gtk_tree_store_prepend:
  * @tree_store: A #GtkTreeStore
@@ -1698,6 +1865,7 @@ gtk_tree_store_prepend (GtkTreeStore *tree_store,
       g_node_prepend (parent_node, G_NODE (iter->user_data));
 
       path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), iter);
+      gtk_tree_store_invalidate_levels (tree_store);
       gtk_tree_model_row_inserted (GTK_TREE_MODEL (tree_store), path, iter);
 
       if (parent_node != priv->root)
@@ -1757,6 +1925,7 @@ gtk_tree_store_append (GtkTreeStore *tree_store,
       g_node_append (parent_node, G_NODE (iter->user_data));
 
       path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), iter);
+      gtk_tree_store_invalidate_levels (tree_store);
       gtk_tree_model_row_inserted (GTK_TREE_MODEL (tree_store), path, iter);
 
       if (parent_node != priv->root)
@@ -1871,6 +2040,15 @@ gtk_tree_store_increment_stamp (GtkTreeStore *tree_store)
   while (priv->stamp == 0);
 }
 
+static void
+gtk_tree_store_invalidate_levels (GtkTreeStore *tree_store)
+{
+  GtkTreeStorePrivate *priv = tree_store->priv;
+
+  if (priv->levels)
+    g_hash_table_remove_all (priv->levels);
+}
+
 /**
  * gtk_tree_store_clear:
  * @tree_store: a #GtkTreeStore
@@ -2331,6 +2509,7 @@ gtk_tree_store_reorder (GtkTreeStore *tree_store,
     path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), parent);
   else
     path = gtk_tree_path_new ();
+  gtk_tree_store_invalidate_levels (tree_store);
   gtk_tree_model_rows_reordered (GTK_TREE_MODEL (tree_store), path,
 				 parent, new_order);
   gtk_tree_path_free (path);
@@ -2473,6 +2652,7 @@ gtk_tree_store_swap (GtkTreeStore *tree_store,
     else
       order[i] = i;
 
+  gtk_tree_store_invalidate_levels (tree_store);
   gtk_tree_model_rows_reordered (GTK_TREE_MODEL (tree_store), path_a,
 				 parent_node == tree_store->priv->root
 				 ? NULL : &parent, order);
@@ -2778,12 +2958,14 @@ gtk_tree_store_move (GtkTreeStore *tree_store,
     {
       tmppath = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), 
 					 &parent_iter);
+      gtk_tree_store_invalidate_levels (tree_store);
       gtk_tree_model_rows_reordered (GTK_TREE_MODEL (tree_store),
 				     tmppath, &parent_iter, order);
     }
   else
     {
       tmppath = gtk_tree_path_new ();
+      gtk_tree_store_invalidate_levels (tree_store);
       gtk_tree_model_rows_reordered (GTK_TREE_MODEL (tree_store),
 				     tmppath, NULL, order);
     }
@@ -2961,6 +3143,7 @@ gtk_tree_store_sort_helper (GtkTreeStore *tree_store,
   iter.stamp = tree_store->priv->stamp;
   iter.user_data = parent;
   path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), &iter);
+  gtk_tree_store_invalidate_levels (tree_store);
   gtk_tree_model_rows_reordered (GTK_TREE_MODEL (tree_store),
 				 path, &iter, new_order);
   gtk_tree_path_free (path);
@@ -3190,6 +3373,7 @@ gtk_tree_store_sort_iter_changed (GtkTreeStore *tree_store,
   tmp_iter.user_data = node->parent;
   tmp_path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), &tmp_iter);
 
+  gtk_tree_store_invalidate_levels (tree_store);
   gtk_tree_model_rows_reordered (GTK_TREE_MODEL (tree_store),
 				 tmp_path, &tmp_iter,
 				 new_order);
@@ -115,6 +115,13 @@ void          gtk_tree_store_insert_with_valuesv (GtkTreeStore *tree_store,
 						  gint         *columns,
 						  GValue       *values,
 						  gint          n_values);
+void          gtk_tree_store_insert_many         (GtkTreeStore *tree_store,
+						  GtkTreeIter  *parent,
+						  gint          position,
+						  gint          n_rows,
+						  gint         *columns,
+						  GValue       *values,
+						  gint          n_values);
 void          gtk_tree_store_prepend          (GtkTreeStore *tree_store,
 					       GtkTreeIter  *iter,
 					       GtkTreeIter  *parent);
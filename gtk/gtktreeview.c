@@ -27,6 +27,7 @@
 #include "gtkrbtree.h"
 #include "gtktreednd.h"
 #include "gtktreeprivate.h"
+#include "gtktreesearchindexprivate.h"
 #include "gtkcellrenderer.h"
 #include "gtkmarshalers.h"
 #include "gtkbuildable.h"
@@ -239,6 +240,7 @@ typedef enum {
 #define GTK_TREE_VIEW_TIME_MS_PER_IDLE 30
 #define SCROLL_EDGE_SIZE 15
 #define GTK_TREE_VIEW_SEARCH_DIALOG_TIMEOUT 5000
+#define GTK_TREE_VIEW_SEARCH_INDEX_MIN_ROWS 10000
 #define AUTO_EXPAND_TIMEOUT 500
 
 /* Translate from bin_window coordinates to rbtree (tree coordinates) and
@@ -435,6 +437,7 @@ struct _GtkTreeViewPrivate
   GtkWidget *search_entry;
   gulong search_entry_changed_id;
   guint typeselect_flush_timeout;
+  GtkTreeSearchIndex *search_index;
 
   /* Grid and tree lines */
   GtkTreeViewGridLines grid_lines;
@@ -707,7 +710,8 @@ static gboolean validate_row             (GtkTreeView *tree_view,
 					  GtkTreePath *path);
 static void     validate_visible_area    (GtkTreeView *tree_view);
 static gboolean do_validate_rows         (GtkTreeView *tree_view,
-					  gboolean     queue_resize);
+					  gboolean     queue_resize,
+					  gint64       end_time);
 static gboolean validate_rows            (GtkTreeView *tree_view);
 static void     install_presize_handler  (GtkTreeView *tree_view);
 static void     install_scroll_sync_handler (GtkTreeView *tree_view);
@@ -840,6 +844,7 @@ static gboolean gtk_tree_view_search_key_press_event    (GtkWidget        *entry
 static gboolean gtk_tree_view_search_move               (GtkWidget        *window,
 							 GtkTreeView      *tree_view,
 							 gboolean          up);
+static void     gtk_tree_view_free_search_index         (GtkTreeView      *tree_view);
 static gboolean gtk_tree_view_search_equal_func         (GtkTreeModel     *model,
 							 gint              column,
 							 const gchar      *key,
@@ -2425,7 +2430,8 @@ gtk_tree_view_get_preferred_width (GtkWidget *widget,
   /* we validate some rows initially just to make sure we have some size.
    * In practice, with a lot of static lists, this should get a good width.
    */
-  do_validate_rows (tree_view, FALSE);
+  do_validate_rows (tree_view, FALSE,
+                    g_get_monotonic_time () + GTK_TREE_VIEW_TIME_MS_PER_IDLE * 1000);
   
   tree_view->priv->minimum_width = 0;
   tree_view->priv->natural_width = 0;
@@ -4740,6 +4746,8 @@ gtk_tree_view_bin_draw (GtkWidget      *widget,
   gint bin_window_height;
   GtkTreePath *drag_dest_path;
   GList *first_column, *last_column;
+  GList *start_column;
+  gint start_offset, start_n_col;
   gint vertical_separator;
   gint horizontal_separator;
   gboolean allow_rules;
@@ -4846,6 +4854,29 @@ gtk_tree_view_bin_draw (GtkWidget      *widget,
        first_column = first_column->next)
     ;
 
+  /* Columns that end left of the clip area are the same for every
+   * row, so find the first one that needs drawing only once.
+   */
+  start_offset = 0;
+  start_n_col = 0;
+  for (start_column = (rtl ? g_list_last (tree_view->priv->columns) : g_list_first (tree_view->priv->columns));
+       start_column;
+       start_column = (rtl ? start_column->prev : start_column->next))
+    {
+      GtkTreeViewColumn *column = start_column->data;
+      gint width;
+
+      if (!gtk_tree_view_column_get_visible (column))
+        continue;
+
+      width = gtk_tree_view_column_get_width (column);
+      if (start_offset + width >= clip.x)
+        break;
+
+      start_offset += width;
+      start_n_col++;
+    }
+
   /* Actually process the expose event.  To do this, we want to
    * start at the first node of the event, and walk the tree in
    * order, drawing each successive node.
@@ -4858,14 +4889,14 @@ gtk_tree_view_bin_draw (GtkWidget      *widget,
       gboolean is_separator = FALSE;
       gboolean is_first = FALSE;
       gboolean is_last = FALSE;
-      gint n_col = 0;
+      gint n_col = start_n_col;
 
       parity = !parity;
       is_separator = row_is_separator (tree_view, &iter, NULL);
 
       max_height = gtk_tree_view_get_row_height (tree_view, node);
 
-      cell_offset = 0;
+      cell_offset = start_offset;
       highlight_x = 0; /* should match x coord of first cell */
       expander_cell_width = 0;
 
@@ -4880,25 +4911,33 @@ gtk_tree_view_bin_draw (GtkWidget      *widget,
       if (GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_IS_SELECTED))
         flags |= GTK_CELL_RENDERER_SELECTED;
 
-      /* we *need* to set cell data on all cells before the call
-       * to _has_can_focus_cell, else _has_can_focus_cell() does not
-       * return a correct value.
+      /* we *need* to set cell data on all visible cells before the
+       * call to _has_can_focus_cell, else _has_can_focus_cell() does
+       * not return a correct value. It only matters for the cursor
+       * row, which keeps wide views from setting cell data on every
+       * column of every row.
        */
-      for (list = (rtl ? g_list_last (tree_view->priv->columns) : g_list_first (tree_view->priv->columns));
-	   list;
-	   list = (rtl ? list->prev : list->next))
+      has_can_focus_cell = FALSE;
+      if (node == tree_view->priv->cursor_node)
         {
-	  GtkTreeViewColumn *column = list->data;
-	  gtk_tree_view_column_cell_set_cell_data (column,
-						   tree_view->priv->model,
-						   &iter,
-						   GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_IS_PARENT),
-						   node->children?TRUE:FALSE);
-        }
+          for (list = tree_view->priv->columns; list; list = list->next)
+            {
+              GtkTreeViewColumn *column = list->data;
 
-      has_can_focus_cell = gtk_tree_view_has_can_focus_cell (tree_view);
+              if (!gtk_tree_view_column_get_visible (column))
+                continue;
 
-      for (list = (rtl ? g_list_last (tree_view->priv->columns) : g_list_first (tree_view->priv->columns));
+              gtk_tree_view_column_cell_set_cell_data (column,
+                                                       tree_view->priv->model,
+                                                       &iter,
+                                                       GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_IS_PARENT),
+                                                       node->children?TRUE:FALSE);
+            }
+
+          has_can_focus_cell = gtk_tree_view_has_can_focus_cell (tree_view);
+        }
+
+      for (list = start_column;
 	   list;
 	   list = (rtl ? list->prev : list->next))
 	{
@@ -4911,11 +4950,14 @@ gtk_tree_view_bin_draw (GtkWidget      *widget,
 	  if (!gtk_tree_view_column_get_visible (column))
             continue;
 
+          /* the remaining columns are right of the clip area */
+	  if (cell_offset > clip.x + clip.width)
+	    break;
+
           n_col++;
           width = gtk_tree_view_column_get_width (column);
 
-	  if (cell_offset > clip.x + clip.width ||
-	      cell_offset + width < clip.x)
+	  if (cell_offset + width < clip.x)
 	    {
 	      cell_offset += width;
 	      continue;
@@ -6132,7 +6174,10 @@ validate_row (GtkTreeView *tree_view,
       new_width = _gtk_tree_view_column_get_requested_width (column);
 
       if (new_width > original_width)
-	retval = TRUE;
+        {
+          _gtk_tree_view_column_set_widest_node (column, node);
+	  retval = TRUE;
+        }
     }
 
   if (draw_hgrid_lines)
@@ -6556,7 +6601,7 @@ initialize_fixed_height_mode (GtkTreeView *tree_view)
  */
 
 static gboolean
-do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
+do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize, gint64 end_time)
 {
   static gboolean prevent_recursion_hack = FALSE;
 
@@ -6566,12 +6611,11 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
   gint retval = TRUE;
   GtkTreePath *path = NULL;
   GtkTreeIter iter;
-  GTimer *timer;
   gint i = 0;
 
   gint y = -1;
-  gint prev_height = -1;
-  gboolean fixed_height = TRUE;
+  gint64 total_height = 0;
+  gint n_measured = 0;
 
   g_assert (tree_view);
 
@@ -6590,9 +6634,6 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
       return FALSE;
     }
 
-  timer = g_timer_new ();
-  g_timer_start (timer);
-
   do
     {
       gboolean changed = FALSE;
@@ -6669,23 +6710,25 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
 
       if (!tree_view->priv->fixed_height_check)
         {
-	  gint height;
-
-	  height = gtk_tree_view_get_row_height (tree_view, node);
-	  if (prev_height < 0)
-	    prev_height = height;
-	  else if (prev_height != height)
-	    fixed_height = FALSE;
+	  total_height += gtk_tree_view_get_row_height (tree_view, node);
+	  n_measured++;
 	}
 
       i++;
     }
-  while (g_timer_elapsed (timer, NULL) < GTK_TREE_VIEW_TIME_MS_PER_IDLE / 1000.);
+  while (g_get_monotonic_time () < end_time);
 
   if (!tree_view->priv->fixed_height_check)
    {
-     if (fixed_height)
-       _gtk_rbtree_set_fixed_height (tree_view->priv->tree, prev_height, FALSE);
+     /* Give the rows we have not measured yet the average height of
+      * the first batch. They stay invalid and are measured later, but
+      * the scrollbars are about right from the start instead of
+      * growing with every idle, which for large models with rows of
+      * different heights takes many seconds to converge.
+      */
+     if (n_measured > 0)
+       _gtk_rbtree_set_fixed_height (tree_view->priv->tree,
+                                     total_height / n_measured, FALSE);
 
      tree_view->priv->fixed_height_check = 1;
    }
@@ -6730,7 +6773,6 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
     }
 
   if (path) gtk_tree_path_free (path);
-  g_timer_destroy (timer);
 
   return retval;
 }
@@ -6789,7 +6831,12 @@ validate_rows (GtkTreeView *tree_view)
       return G_SOURCE_CONTINUE;
     }
 
-  retval = do_validate_rows (tree_view, TRUE);
+  /* Don't hold up input or the next frame while validating in the
+   * background
+   */
+  retval = do_validate_rows (tree_view, TRUE,
+                             _gtk_widget_get_idle_deadline (GTK_WIDGET (tree_view),
+                                                            GTK_TREE_VIEW_TIME_MS_PER_IDLE * 1000));
   
   if (! retval && tree_view->priv->validate_rows_timer)
     {
@@ -8736,6 +8783,16 @@ gtk_tree_view_row_changed (GtkTreeModel *model,
   else if (iter == NULL)
     gtk_tree_model_get_iter (model, iter, path);
 
+  if (tree_view->priv->search_index)
+    {
+      if (iter && gtk_tree_path_get_depth (path) == 1)
+        _gtk_tree_search_index_row_changed (tree_view->priv->search_index,
+                                            gtk_tree_path_get_indices (path)[0],
+                                            iter);
+      else
+        gtk_tree_view_free_search_index (tree_view);
+    }
+
   if (_gtk_tree_view_find_node (tree_view,
 				path,
 				&tree,
@@ -8766,7 +8823,12 @@ gtk_tree_view_row_changed (GtkTreeModel *model,
           if (!gtk_tree_view_column_get_visible (column))
             continue;
 
-          if (gtk_tree_view_column_get_sizing (column) == GTK_TREE_VIEW_COLUMN_AUTOSIZE)
+          /* Revalidating the row is enough to make the column grow.
+           * It can only shrink if the row was the widest one, only then
+           * all rows need to be measured again.
+           */
+          if (gtk_tree_view_column_get_sizing (column) == GTK_TREE_VIEW_COLUMN_AUTOSIZE &&
+              _gtk_tree_view_column_get_widest_node (column) == node)
             {
               _gtk_tree_view_column_cell_set_dirty (column, TRUE);
             }
@@ -8813,6 +8875,16 @@ gtk_tree_view_row_inserted (GtkTreeModel *model,
   else if (iter == NULL)
     gtk_tree_model_get_iter (model, iter, path);
 
+  if (tree_view->priv->search_index)
+    {
+      if (iter && gtk_tree_path_get_depth (path) == 1)
+        _gtk_tree_search_index_row_inserted (tree_view->priv->search_index,
+                                             gtk_tree_path_get_indices (path)[0],
+                                             iter);
+      else
+        gtk_tree_view_free_search_index (tree_view);
+    }
+
   if (tree_view->priv->tree == NULL)
     tree_view->priv->tree = _gtk_rbtree_new ();
 
@@ -9012,6 +9084,15 @@ gtk_tree_view_row_deleted (GtkTreeModel *model,
 
   g_return_if_fail (path != NULL);
 
+  if (tree_view->priv->search_index)
+    {
+      if (gtk_tree_path_get_depth (path) == 1)
+        _gtk_tree_search_index_row_deleted (tree_view->priv->search_index,
+                                            gtk_tree_path_get_indices (path)[0]);
+      else
+        gtk_tree_view_free_search_index (tree_view);
+    }
+
   gtk_tree_row_reference_deleted (G_OBJECT (data), path);
 
   if (_gtk_tree_view_find_node (tree_view, path, &tree, &node))
@@ -9149,6 +9230,15 @@ gtk_tree_view_rows_reordered (GtkTreeModel *model,
   if (len < 2)
     return;
 
+  if (tree_view->priv->search_index)
+    {
+      if (iter == NULL)
+        _gtk_tree_search_index_rows_reordered (tree_view->priv->search_index,
+                                               new_order);
+      else
+        gtk_tree_view_free_search_index (tree_view);
+    }
+
   gtk_tree_row_reference_reordered (G_OBJECT (data),
 				    parent,
 				    iter,
@@ -9315,6 +9405,28 @@ gtk_tree_view_build_tree (GtkTreeView *tree_view,
   GtkRBNode *temp = NULL;
   GtkTreePath *path = NULL;
 
+  if (tree_view->priv->is_list && _gtk_rbtree_is_nil (tree->root))
+    {
+      guint n_rows = 0;
+
+      /* Flat models get their tree built in one go, which is linear
+       * instead of rebalancing after every row.
+       */
+      do
+        {
+          gtk_tree_model_ref_node (tree_view->priv->model, iter);
+          n_rows++;
+        }
+      while (gtk_tree_model_iter_next (tree_view->priv->model, iter));
+
+      if (tree_view->priv->fixed_height > 0)
+        _gtk_rbtree_fill (tree, n_rows, tree_view->priv->fixed_height, TRUE);
+      else
+        _gtk_rbtree_fill (tree, n_rows, 0, FALSE);
+
+      return;
+    }
+
   do
     {
       gtk_tree_model_ref_node (tree_view->priv->model, iter);
@@ -11278,6 +11390,7 @@ gtk_tree_view_set_model (GtkTreeView  *tree_view,
 
       g_object_unref (tree_view->priv->model);
 
+      gtk_tree_view_free_search_index (tree_view);
       tree_view->priv->search_column = -1;
       tree_view->priv->fixed_height_check = 0;
       tree_view->priv->fixed_height = -1;
@@ -14708,6 +14821,7 @@ gtk_tree_view_set_search_column (GtkTreeView *tree_view,
   if (tree_view->priv->search_column == column)
     return;
 
+  gtk_tree_view_free_search_index (tree_view);
   tree_view->priv->search_column = column;
   g_object_notify (G_OBJECT (tree_view), "search-column");
 }
@@ -14757,6 +14871,8 @@ gtk_tree_view_set_search_equal_func (GtkTreeView                *tree_view,
   tree_view->priv->search_destroy = search_destroy;
   if (tree_view->priv->search_equal_func == NULL)
     tree_view->priv->search_equal_func = gtk_tree_view_search_equal_func;
+
+  gtk_tree_view_free_search_index (tree_view);
 }
 
 /**
@@ -15245,10 +15361,8 @@ gtk_tree_view_search_equal_func (GtkTreeModel *model,
 {
   gboolean retval = TRUE;
   const gchar *str;
-  gchar *normalized_string;
-  gchar *normalized_key;
-  gchar *case_normalized_string = NULL;
-  gchar *case_normalized_key = NULL;
+  gchar *case_normalized_string;
+  gchar *case_normalized_key;
   GValue value = G_VALUE_INIT;
   GValue transformed = G_VALUE_INIT;
 
@@ -15271,27 +15385,92 @@ gtk_tree_view_search_equal_func (GtkTreeModel *model,
       return TRUE;
     }
 
-  normalized_string = g_utf8_normalize (str, -1, G_NORMALIZE_ALL);
-  normalized_key = g_utf8_normalize (key, -1, G_NORMALIZE_ALL);
+  /* the search index relies on keys being made the same way */
+  case_normalized_string = _gtk_tree_search_index_make_key (str);
+  case_normalized_key = _gtk_tree_search_index_make_key (key);
 
-  if (normalized_string && normalized_key)
-    {
-      case_normalized_string = g_utf8_casefold (normalized_string, -1);
-      case_normalized_key = g_utf8_casefold (normalized_key, -1);
-
-      if (strncmp (case_normalized_key, case_normalized_string, strlen (case_normalized_key)) == 0)
-        retval = FALSE;
-    }
+  if (case_normalized_string && case_normalized_key &&
+      strncmp (case_normalized_key, case_normalized_string, strlen (case_normalized_key)) == 0)
+    retval = FALSE;
 
   g_value_unset (&transformed);
-  g_free (normalized_key);
-  g_free (normalized_string);
   g_free (case_normalized_key);
   g_free (case_normalized_string);
 
   return retval;
 }
 
+static void
+gtk_tree_view_free_search_index (GtkTreeView *tree_view)
+{
+  if (tree_view->priv->search_index)
+    {
+      _gtk_tree_search_index_free (tree_view->priv->search_index);
+      tree_view->priv->search_index = NULL;
+    }
+}
+
+/* Large flat models are searched with a prefix index over the search
+ * column when the default equal function is used. The index is built
+ * on the first search once the model is big enough, and is kept up
+ * to date from the model signals after that.
+ *
+ * Returns %FALSE if the index can't be used. Otherwise, @path is set
+ * to the @n-th match, or to %NULL if there is none.
+ */
+static gboolean
+gtk_tree_view_search_iter_indexed (GtkTreeView      *tree_view,
+                                   GtkTreeModel     *model,
+                                   GtkTreeIter      *iter,
+                                   const gchar      *text,
+                                   gint             *count,
+                                   gint              n,
+                                   GtkTreePath     **path)
+{
+  gint row;
+
+  if (!tree_view->priv->is_list ||
+      tree_view->priv->search_equal_func != gtk_tree_view_search_equal_func ||
+      tree_view->priv->search_column < 0)
+    {
+      gtk_tree_view_free_search_index (tree_view);
+      return FALSE;
+    }
+
+  if (tree_view->priv->search_index == NULL)
+    {
+      if (tree_view->priv->tree == NULL ||
+          tree_view->priv->tree->root->count < GTK_TREE_VIEW_SEARCH_INDEX_MIN_ROWS)
+        return FALSE;
+
+      tree_view->priv->search_index =
+        _gtk_tree_search_index_new (model, tree_view->priv->search_column);
+    }
+
+  /* The walk in gtk_tree_view_search_iter() always starts at the
+   * first row, so the n-th match in model order is what it finds.
+   */
+  row = _gtk_tree_search_index_lookup (tree_view->priv->search_index,
+                                       text, n - *count);
+  if (row < 0)
+    {
+      *path = NULL;
+      return TRUE;
+    }
+
+  *count = n;
+  *path = gtk_tree_path_new_from_indices (row, -1);
+  if (!gtk_tree_model_get_iter (model, iter, *path))
+    {
+      /* the index is out of sync with the model */
+      gtk_tree_path_free (*path);
+      gtk_tree_view_free_search_index (tree_view);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
 static gboolean
 gtk_tree_view_search_iter (GtkTreeModel     *model,
 			   GtkTreeSelection *selection,
@@ -15306,6 +15485,21 @@ gtk_tree_view_search_iter (GtkTreeModel     *model,
 
   GtkTreeView *tree_view = gtk_tree_selection_get_tree_view (selection);
 
+  if (gtk_tree_view_search_iter_indexed (tree_view, model, iter,
+                                         text, count, n, &path))
+    {
+      if (path == NULL)
+        return FALSE;
+
+      gtk_tree_view_scroll_to_cell (tree_view, path, NULL,
+                                    TRUE, 0.5, 0.0);
+      gtk_tree_selection_select_iter (selection, iter);
+      gtk_tree_view_real_set_cursor (tree_view, path, CLAMP_NODE);
+      gtk_tree_path_free (path);
+
+      return TRUE;
+    }
+
   path = gtk_tree_model_get_path (model, iter);
   _gtk_tree_view_find_node (tree_view, path, &tree, &node);
 
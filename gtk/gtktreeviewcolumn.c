@@ -147,6 +147,11 @@ struct _GtkTreeViewColumnPrivate
   gint min_width;
   gint max_width;
 
+  /* The row that last made the column wider. Only used for comparing,
+   * it may point to a row that was removed since.
+   */
+  GtkRBNode *widest_node;
+
   /* dragging columns */
   gint drag_x;
   gint drag_y;
@@ -3047,6 +3052,7 @@ _gtk_tree_view_column_cell_set_dirty (GtkTreeViewColumn *tree_column,
   priv->dirty = TRUE;
   priv->padding = 0;
   priv->width = 0;
+  priv->widest_node = NULL;
 
   /* Issue a manual reset on the context to have all
    * sizes re-requested for the context.
@@ -3071,6 +3077,19 @@ _gtk_tree_view_column_cell_get_dirty (GtkTreeViewColumn  *tree_column)
   return tree_column->priv->dirty;
 }
 
+void
+_gtk_tree_view_column_set_widest_node (GtkTreeViewColumn *tree_column,
+                                       GtkRBNode         *node)
+{
+  tree_column->priv->widest_node = node;
+}
+
+GtkRBNode *
+_gtk_tree_view_column_get_widest_node (GtkTreeViewColumn *tree_column)
+{
+  return tree_column->priv->widest_node;
+}
+
 /**
  * gtk_tree_view_column_cell_get_position:
  * @tree_column: a #GtkTreeViewColumn
@@ -382,6 +382,8 @@ static GtkAction * gtk_ui_manager_real_get_action (GtkUIManager      *manager,
                                                    const gchar       *path);
 static void        queue_update                   (GtkUIManager      *manager);
 static void        dirty_all_nodes                (GtkUIManager      *manager);
+static void        dirty_group_nodes              (GtkUIManager      *manager,
+                                                   GtkActionGroup    *action_group);
 static void        mark_node_dirty                (GNode             *node);
 static GNode     * get_child_node                 (GtkUIManager      *manager,
                                                    GNode             *parent,
@@ -994,8 +996,8 @@ gtk_ui_manager_insert_action_group (GtkUIManager   *manager,
 		    "object-signal::post-activate", G_CALLBACK (cb_proxy_post_activate), manager,
 		    NULL);
 
-  /* dirty all nodes, as action bindings may change */
-  dirty_all_nodes (manager);
+  /* dirty the nodes whose action bindings may change */
+  dirty_group_nodes (manager, action_group);
 
   g_signal_emit (manager, ui_manager_signals[ACTIONS_CHANGED], 0);
 }
@@ -1030,8 +1032,8 @@ gtk_ui_manager_remove_action_group (GtkUIManager   *manager,
                        NULL);
   g_object_unref (action_group);
 
-  /* dirty all nodes, as action bindings may change */
-  dirty_all_nodes (manager);
+  /* dirty the nodes whose action bindings may change */
+  dirty_group_nodes (manager, action_group);
 
   g_signal_emit (manager, ui_manager_signals[ACTIONS_CHANGED], 0);
 }
@@ -3145,6 +3147,38 @@ dirty_all_nodes (GtkUIManager *manager)
   queue_update (manager);
 }
 
+static gboolean
+dirty_group_traverse_func (GNode   *node,
+                           gpointer data)
+{
+  GtkActionGroup *action_group = data;
+  Node *info = NODE_INFO (node);
+  NodeUIReference *ref;
+
+  if (info->uifiles == NULL)
+    return FALSE;
+
+  /* Only nodes whose action name is provided by the group can
+   * bind to a different action when the group comes or goes.
+   */
+  ref = info->uifiles->data;
+  if (gtk_action_group_get_action (action_group,
+                                   g_quark_to_string (ref->action_quark)) != NULL)
+    mark_node_dirty (node);
+
+  return FALSE;
+}
+
+static void
+dirty_group_nodes (GtkUIManager   *manager,
+                   GtkActionGroup *action_group)
+{
+  g_node_traverse (manager->private_data->root_node,
+		   G_PRE_ORDER, G_TRAVERSE_ALL, -1,
+		   dirty_group_traverse_func, action_group);
+  queue_update (manager);
+}
+
 static void
 mark_node_dirty (GNode *node)
 {
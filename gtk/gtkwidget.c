@@ -465,10 +465,16 @@ struct _GtkWidgetPrivate
   guint opacity_group         : 1;
   guint norender_children     : 1;
   guint norender              : 1; /* Don't expose windows, instead recurse via draw */
+  guint cache_draw            : 1;
 
   guint8 alpha;
   guint8 user_alpha;
 
+  /* The recorded output of ::draw for cache_draw widgets, and the
+   * expose window it was recorded for */
+  cairo_surface_t *draw_cache;
+  GdkWindow *draw_cache_window;
+
   /* The widget's name. If the widget does not have a name
    * (the name is NULL), then its name (as returned by
    * "gtk_widget_get_name") is its class's name.
@@ -497,9 +503,18 @@ struct _GtkWidgetPrivate
   GtkAllocation allocation;
   gint allocated_baseline;
 
+  /* The allocation as handed out by the parent, before adjustment */
+  GtkAllocation allocated_size;
+  gint allocated_size_baseline;
+
   /* The widget's requested sizes */
   SizeRequestCache requests;
 
+  /* The requested sizes from before the first of the changes
+   * queued with _gtk_widget_queue_resize_if_changed() since the
+   * last layout phase */
+  SizeRequestCache *old_requests;
+
   /* actions attached to this or any parent widget */
   GtkActionMuxer *muxer;
 
@@ -532,6 +547,7 @@ struct _GtkWidgetClassPrivate
   GType accessible_type;
   AtkRole accessible_role;
   GtkWidgetTemplate *template;
+  guint request_cache_size;
 };
 
 enum {
@@ -1248,6 +1264,8 @@ gtk_widget_class_init (GtkWidgetClass *klass)
   klass->priv->accessible_role = ATK_ROLE_INVALID;
   klass->get_accessible = gtk_widget_real_get_accessible;
 
+  klass->priv->request_cache_size = GTK_SIZE_REQUEST_CACHED_SIZES;
+
   klass->adjust_size_request = gtk_widget_real_adjust_size_request;
   klass->adjust_baseline_request = gtk_widget_real_adjust_baseline_request;
   klass->adjust_size_allocation = gtk_widget_real_adjust_size_allocation;
@@ -1876,6 +1894,8 @@ gtk_widget_class_init (GtkWidgetClass *klass)
 		  _gtk_marshal_VOID__BOXED,
 		  G_TYPE_NONE, 1,
 		  GDK_TYPE_RECTANGLE | G_SIGNAL_TYPE_STATIC_SCOPE);
+  g_signal_set_va_marshaller (widget_signals[SIZE_ALLOCATE], G_TYPE_FROM_CLASS (klass),
+                              _gtk_marshal_VOID__BOXEDv);
 
   /**
    * GtkWidget::state-changed:
@@ -1896,6 +1916,8 @@ gtk_widget_class_init (GtkWidgetClass *klass)
 		  _gtk_marshal_VOID__ENUM,
 		  G_TYPE_NONE, 1,
 		  GTK_TYPE_STATE_TYPE);
+  g_signal_set_va_marshaller (widget_signals[STATE_CHANGED], G_TYPE_FROM_CLASS (klass),
+                              _gtk_marshal_VOID__ENUMv);
 
   /**
    * GtkWidget::state-flags-changed:
@@ -1916,6 +1938,8 @@ gtk_widget_class_init (GtkWidgetClass *klass)
                   _gtk_marshal_VOID__FLAGS,
                   G_TYPE_NONE, 1,
                   GTK_TYPE_STATE_FLAGS);
+  g_signal_set_va_marshaller (widget_signals[STATE_FLAGS_CHANGED], G_TYPE_FROM_CLASS (klass),
+                              _gtk_marshal_VOID__FLAGSv);
 
   /**
    * GtkWidget::parent-set:
@@ -1935,6 +1959,8 @@ gtk_widget_class_init (GtkWidgetClass *klass)
 		  _gtk_marshal_VOID__OBJECT,
 		  G_TYPE_NONE, 1,
 		  GTK_TYPE_WIDGET);
+  g_signal_set_va_marshaller (widget_signals[PARENT_SET], G_TYPE_FROM_CLASS (klass),
+                              _gtk_marshal_VOID__OBJECTv);
 
   /**
    * GtkWidget::hierarchy-changed:
@@ -1957,6 +1983,8 @@ gtk_widget_class_init (GtkWidgetClass *klass)
 		  _gtk_marshal_VOID__OBJECT,
 		  G_TYPE_NONE, 1,
 		  GTK_TYPE_WIDGET);
+  g_signal_set_va_marshaller (widget_signals[HIERARCHY_CHANGED], G_TYPE_FROM_CLASS (klass),
+                              _gtk_marshal_VOID__OBJECTv);
 
   /**
    * GtkWidget::style-set:
@@ -1983,6 +2011,8 @@ gtk_widget_class_init (GtkWidgetClass *klass)
 		  _gtk_marshal_VOID__OBJECT,
 		  G_TYPE_NONE, 1,
 		  GTK_TYPE_STYLE);
+  g_signal_set_va_marshaller (widget_signals[STYLE_SET], G_TYPE_FROM_CLASS (klass),
+                              _gtk_marshal_VOID__OBJECTv);
 
   /**
    * GtkWidget::style-updated:
@@ -2020,6 +2050,8 @@ gtk_widget_class_init (GtkWidgetClass *klass)
 		  _gtk_marshal_VOID__ENUM,
 		  G_TYPE_NONE, 1,
 		  GTK_TYPE_TEXT_DIRECTION);
+  g_signal_set_va_marshaller (widget_signals[DIRECTION_CHANGED], G_TYPE_FROM_CLASS (klass),
+                              _gtk_marshal_VOID__ENUMv);
 
   /**
    * GtkWidget::grab-notify:
@@ -2045,6 +2077,8 @@ gtk_widget_class_init (GtkWidgetClass *klass)
 		  _gtk_marshal_VOID__BOOLEAN,
 		  G_TYPE_NONE, 1,
 		  G_TYPE_BOOLEAN);
+  g_signal_set_va_marshaller (widget_signals[GRAB_NOTIFY], G_TYPE_FROM_CLASS (klass),
+                              _gtk_marshal_VOID__BOOLEANv);
 
   /**
    * GtkWidget::child-notify:
@@ -2064,6 +2098,8 @@ gtk_widget_class_init (GtkWidgetClass *klass)
 		   g_cclosure_marshal_VOID__PARAM,
 		   G_TYPE_NONE, 1,
 		   G_TYPE_PARAM);
+  g_signal_set_va_marshaller (widget_signals[CHILD_NOTIFY], G_TYPE_FROM_CLASS (klass),
+                              g_cclosure_marshal_VOID__PARAMv);
 
   /**
    * GtkWidget::draw:
@@ -2139,6 +2175,8 @@ gtk_widget_class_init (GtkWidgetClass *klass)
 		  _gtk_marshal_BOOLEAN__ENUM,
 		  G_TYPE_BOOLEAN, 1,
 		  GTK_TYPE_DIRECTION_TYPE);
+  g_signal_set_va_marshaller (widget_signals[FOCUS], G_TYPE_FROM_CLASS (klass),
+                              _gtk_marshal_BOOLEAN__ENUMv);
 
   /**
    * GtkWidget::move-focus:
@@ -3240,6 +3278,8 @@ gtk_widget_class_init (GtkWidgetClass *klass)
 		  _gtk_marshal_BOOLEAN__BOXED,
 		  G_TYPE_BOOLEAN, 1,
 		  GDK_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
+  g_signal_set_va_marshaller (widget_signals[VISIBILITY_NOTIFY_EVENT], G_TYPE_FROM_CLASS (klass),
+                              _gtk_marshal_BOOLEAN__BOXEDv);
 
   /**
    * GtkWidget::window-state-event:
@@ -3363,6 +3403,8 @@ gtk_widget_class_init (GtkWidgetClass *klass)
 		  G_TYPE_INT,
 		  G_TYPE_BOOLEAN,
 		  GTK_TYPE_TOOLTIP);
+  g_signal_set_va_marshaller (widget_signals[QUERY_TOOLTIP], G_TYPE_FROM_CLASS (klass),
+                              _gtk_marshal_BOOLEAN__INT_INT_BOOLEAN_OBJECTv);
 
   /**
    * GtkWidget::popup-menu
@@ -3432,6 +3474,8 @@ gtk_widget_class_init (GtkWidgetClass *klass)
 		  _gtk_marshal_VOID__OBJECT,
 		  G_TYPE_NONE, 1,
 		  GDK_TYPE_SCREEN);
+  g_signal_set_va_marshaller (widget_signals[SCREEN_CHANGED], G_TYPE_FROM_CLASS (klass),
+                              _gtk_marshal_VOID__OBJECTv);
 
   /**
    * GtkWidget::can-activate-accel:
@@ -4175,6 +4219,32 @@ gtk_widget_new (GType        type,
   return widget;
 }
 
+static void
+gtk_widget_drop_draw_cache (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = widget->priv;
+
+  if (priv->draw_cache)
+    {
+      cairo_surface_destroy (priv->draw_cache);
+      priv->draw_cache = NULL;
+      priv->draw_cache_window = NULL;
+    }
+}
+
+/* The recorded output of a widget includes that of its children,
+ * so a change to @widget makes the caches of all its ancestors
+ * stale too.
+ */
+static void
+gtk_widget_invalidate_draw_cache (GtkWidget *widget)
+{
+  GtkWidget *w;
+
+  for (w = widget; w != NULL; w = w->priv->parent)
+    gtk_widget_drop_draw_cache (w);
+}
+
 static inline void
 gtk_widget_queue_draw_child (GtkWidget *widget)
 {
@@ -4418,6 +4488,9 @@ gtk_widget_real_show (GtkWidget *widget)
     {
       priv->visible = TRUE;
 
+      if (priv->context)
+        _gtk_style_context_validate_deferred (priv->context);
+
       if (priv->parent &&
 	  gtk_widget_get_mapped (priv->parent) &&
           gtk_widget_get_child_visible (widget) &&
@@ -4595,6 +4668,7 @@ gtk_widget_map (GtkWidget *widget)
 
       g_signal_emit (widget, widget_signals[MAP], 0);
 
+      gtk_widget_invalidate_draw_cache (widget);
       if (!gtk_widget_get_has_window (widget))
         gdk_window_invalidate_rect (priv->window, &priv->allocation, FALSE);
 
@@ -4625,6 +4699,7 @@ gtk_widget_unmap (GtkWidget *widget)
     {
       gtk_widget_push_verify_invariants (widget);
 
+      gtk_widget_invalidate_draw_cache (widget);
       if (!gtk_widget_get_has_window (widget))
 	gdk_window_invalidate_rect (priv->window, &priv->allocation, FALSE);
       _gtk_tooltip_hide (widget);
@@ -5139,6 +5214,27 @@ gtk_widget_unrealize (GtkWidget *widget)
  * Draw queueing.
  *****************************************/
 
+/* Drops the draw cache and returns whether @widget is currently
+ * shown, i.e. whether queueing a redraw on its window makes sense.
+ */
+static gboolean
+gtk_widget_prepare_queue_draw (GtkWidget *widget)
+{
+  GtkWidget *w;
+
+  gtk_widget_invalidate_draw_cache (widget);
+
+  if (!gtk_widget_get_realized (widget))
+    return FALSE;
+
+  /* Just return if the widget or one of its ancestors isn't mapped */
+  for (w = widget; w != NULL; w = w->priv->parent)
+    if (!gtk_widget_get_mapped (w))
+      return FALSE;
+
+  return TRUE;
+}
+
 /**
  * gtk_widget_queue_draw_region:
  * @widget: a #GtkWidget
@@ -5161,22 +5257,12 @@ void
 gtk_widget_queue_draw_region (GtkWidget            *widget,
                               const cairo_region_t *region)
 {
-  GtkWidgetPrivate *priv;
-  GtkWidget *w;
-
   g_return_if_fail (GTK_IS_WIDGET (widget));
 
-  priv = widget->priv;
-
-  if (!gtk_widget_get_realized (widget))
+  if (!gtk_widget_prepare_queue_draw (widget))
     return;
 
-  /* Just return if the widget or one of its ancestors isn't mapped */
-  for (w = widget; w != NULL; w = w->priv->parent)
-    if (!gtk_widget_get_mapped (w))
-      return;
-
-  gdk_window_invalidate_region (priv->window, region, TRUE);
+  gdk_window_invalidate_region (widget->priv->window, region, TRUE);
 }
 
 /**
@@ -5204,18 +5290,21 @@ gtk_widget_queue_draw_area (GtkWidget *widget,
 			    gint       height)
 {
   GdkRectangle rect;
-  cairo_region_t *region;
 
   g_return_if_fail (GTK_IS_WIDGET (widget));
 
+  /* Check first, so that no region gets created for widgets that
+   * aren't drawn anyway.
+   */
+  if (!gtk_widget_prepare_queue_draw (widget))
+    return;
+
   rect.x = x;
   rect.y = y;
   rect.width = width;
   rect.height = height;
 
-  region = cairo_region_create_rectangle (&rect);
-  gtk_widget_queue_draw_region (widget, region);
-  cairo_region_destroy (region);
+  gdk_window_invalidate_rect (widget->priv->window, &rect, TRUE);
 }
 
 /**
@@ -5285,6 +5374,101 @@ gtk_widget_queue_resize_no_redraw (GtkWidget *widget)
   _gtk_size_group_queue_resize (widget, 0);
 }
 
+static void
+gtk_widget_drop_old_requests (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = widget->priv;
+
+  if (priv->old_requests == NULL)
+    return;
+
+  _gtk_size_request_cache_free (priv->old_requests);
+  g_slice_free (SizeRequestCache, priv->old_requests);
+  priv->old_requests = NULL;
+}
+
+/* Like gtk_widget_queue_resize(), but meant for widgets whose content
+ * changed in a way that often leaves the size request alone, such as
+ * a label getting new text. The widget is re-measured at the next
+ * layout phase and if none of the sizes its parent asked for changed,
+ * only the widget itself is allocated again, instead of every
+ * container up to the toplevel.
+ *
+ * Since the check is deferred, a widget that changes many times per
+ * frame is only measured once, against the sizes it had before the
+ * first change.
+ *
+ * This also works for widgets in size groups: as long as the widget's
+ * own sizes stay the same, none of the other widgets in its groups
+ * need to be measured again.
+ */
+void
+_gtk_widget_queue_resize_if_changed (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = widget->priv;
+
+  if (!priv->visible ||
+      priv->parent == NULL ||
+      priv->alloc_needed ||
+      (priv->old_requests == NULL &&
+       !priv->requests.flags[GTK_ORIENTATION_HORIZONTAL].cached_size_valid &&
+       !priv->requests.flags[GTK_ORIENTATION_VERTICAL].cached_size_valid) ||
+      !_gtk_container_queue_reallocate (widget))
+    {
+      gtk_widget_drop_old_requests (widget);
+      gtk_widget_queue_resize (widget);
+      return;
+    }
+
+  if (priv->old_requests)
+    {
+      /* Anything measured since the last change is outdated now */
+      _gtk_size_request_cache_clear (&priv->requests);
+    }
+  else
+    {
+      priv->old_requests = g_slice_new (SizeRequestCache);
+      *priv->old_requests = priv->requests;
+      _gtk_size_request_cache_init (&priv->requests);
+    }
+}
+
+/* Called by the resize container for widgets queued by
+ * _gtk_widget_queue_resize_if_changed(). */
+void
+_gtk_widget_reallocate (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = widget->priv;
+  gboolean changed;
+
+  /* Already done, or taken care of by a full resize */
+  if (priv->old_requests == NULL)
+    return;
+
+  if (!priv->visible || priv->parent == NULL || priv->alloc_needed)
+    {
+      gtk_widget_drop_old_requests (widget);
+      return;
+    }
+
+  changed = _gtk_widget_remeasure (widget, priv->old_requests);
+  gtk_widget_drop_old_requests (widget);
+
+  if (changed)
+    {
+      gtk_widget_queue_resize (widget);
+      return;
+    }
+
+  priv->alloc_needed = TRUE;
+  gtk_widget_size_allocate_with_baseline (widget,
+                                          &priv->allocated_size,
+                                          priv->allocated_size_baseline);
+
+  if (gtk_widget_get_realized (widget))
+    gtk_widget_queue_draw (widget);
+}
+
 /**
  * gtk_widget_get_frame_clock:
  * @widget: a #GtkWidget
@@ -5522,6 +5706,9 @@ gtk_widget_size_allocate_with_baseline (GtkWidget     *widget,
   /* Preserve request/allocate ordering */
   priv->alloc_needed = FALSE;
 
+  priv->allocated_size = *allocation;
+  priv->allocated_size_baseline = baseline;
+
   old_allocation = priv->allocation;
   old_baseline = priv->allocated_baseline;
   real_allocation = *allocation;
@@ -5614,6 +5801,8 @@ gtk_widget_size_allocate_with_baseline (GtkWidget     *widget,
   if (!alloc_needed && !size_changed && !position_changed && !baseline_changed)
     goto out;
 
+  gtk_widget_invalidate_draw_cache (widget);
+
   priv->allocated_baseline = baseline;
   g_signal_emit (widget, widget_signals[SIZE_ALLOCATE], 0, &real_allocation);
 
@@ -6451,6 +6640,73 @@ gtk_widget_get_clip_draw (GtkWidget *widget)
   return TRUE;
 }
 
+/* Replays the recorded output of ::draw onto @cr, recording it
+ * first if the widget changed since the last time. The whole widget
+ * is recorded, not just the area that needs to be redrawn, so that
+ * the recording can be used for later exposes too.
+ */
+static void
+gtk_widget_draw_cached (GtkWidget *widget,
+                        cairo_t   *cr,
+                        gboolean   clip_to_size)
+{
+  GtkWidgetPrivate *priv = widget->priv;
+  cairo_surface_t *surface;
+  GdkEventExpose *event;
+  GdkWindow *event_window;
+
+  event = _gtk_cairo_get_event (cr);
+  event_window = event ? event->window : NULL;
+
+  if (priv->draw_cache && priv->draw_cache_window != event_window)
+    gtk_widget_drop_draw_cache (widget);
+
+  if (priv->draw_cache)
+    surface = cairo_surface_reference (priv->draw_cache);
+  else
+    {
+      cairo_t *record_cr;
+      gboolean result;
+
+      surface = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA, NULL);
+      priv->draw_cache = cairo_surface_reference (surface);
+      priv->draw_cache_window = event_window;
+
+      record_cr = cairo_create (surface);
+      gtk_cairo_set_event (record_cr, event);
+
+      if (clip_to_size)
+        {
+          cairo_rectangle (record_cr,
+                           0, 0,
+                           priv->allocation.width,
+                           priv->allocation.height);
+          cairo_clip (record_cr);
+        }
+
+      /* If the widget queues a redraw of itself while drawing, the
+       * recording is dropped again, but still used for this draw.
+       */
+      g_signal_emit (widget, widget_signals[DRAW],
+                     0, record_cr,
+                     &result);
+
+      if (cairo_status (record_cr) && event)
+        g_warning ("drawing failure for widget `%s': %s",
+                   G_OBJECT_TYPE_NAME (widget),
+                   cairo_status_to_string (cairo_status (record_cr)));
+
+      cairo_destroy (record_cr);
+    }
+
+  cairo_save (cr);
+  cairo_set_source_surface (cr, surface, 0, 0);
+  cairo_paint (cr);
+  cairo_restore (cr);
+
+  cairo_surface_destroy (surface);
+}
+
 /* code shared by gtk_container_propagate_draw() and
  * gtk_widget_draw()
  */
@@ -6466,6 +6722,20 @@ _gtk_widget_draw_internal (GtkWidget *widget,
 
   if (clip_to_size)
     {
+      GdkRectangle clip, area;
+
+      /* Cull widgets outside of the area being drawn before pushing
+       * a clip for them; most children of a large container are.
+       */
+      area.x = 0;
+      area.y = 0;
+      area.width = widget->priv->allocation.width;
+      area.height = widget->priv->allocation.height;
+
+      if (!gdk_cairo_get_clip_rectangle (cr, &clip) ||
+          !gdk_rectangle_intersect (&clip, &area, NULL))
+        return;
+
       cairo_rectangle (cr,
                        0, 0,
                        widget->priv->allocation.width,
@@ -6477,9 +6747,12 @@ _gtk_widget_draw_internal (GtkWidget *widget,
     {
       gboolean result;
 
-      g_signal_emit (widget, widget_signals[DRAW],
-                     0, cr,
-                     &result);
+      if (widget->priv->cache_draw)
+        gtk_widget_draw_cached (widget, cr, clip_to_size);
+      else
+        g_signal_emit (widget, widget_signals[DRAW],
+                       0, cr,
+                       &result);
 
       if (cairo_status (cr) &&
           _gtk_cairo_get_event (cr))
@@ -7308,11 +7581,14 @@ gtk_widget_real_style_updated (GtkWidget *widget)
   gtk_widget_update_alpha (widget);
 
   if (priv->style != NULL &&
-      priv->style != gtk_widget_get_default_style ())
+      priv->style != gtk_widget_get_default_style () &&
+      (GTK_WIDGET_GET_CLASS (widget)->style_set != gtk_widget_real_style_set ||
+       g_signal_has_handler_pending (widget, widget_signals[STYLE_SET], 0, FALSE)))
     {
       /* Trigger ::style-set for old
        * widgets not listening to this
        */
+      _gtk_style_ensure_updated (priv->style);
       g_signal_emit (widget,
                      widget_signals[STYLE_SET],
                      0,
@@ -8091,6 +8367,9 @@ _gtk_widget_set_visible_flag (GtkWidget *widget,
 
   priv->visible = visible;
 
+  if (visible && priv->context)
+    _gtk_style_context_validate_deferred (priv->context);
+
   if (!visible)
     {
       priv->allocation.x = -1;
@@ -8447,6 +8726,61 @@ gtk_widget_get_double_buffered (GtkWidget *widget)
   return widget->priv->double_buffered;
 }
 
+/**
+ * gtk_widget_set_cache_draw:
+ * @widget: a #GtkWidget
+ * @cache_draw: %TRUE to keep what @widget draws between frames
+ *
+ * Sets whether @widget records the output of its #GtkWidget::draw
+ * signal and reuses it as long as the widget doesn't change,
+ * instead of drawing again on every expose. The recording includes
+ * the children of @widget, and is thrown away when a redraw of the
+ * widget or one of its children is queued, or when they are
+ * allocated, restyled, mapped or unmapped.
+ *
+ * This is only useful for widgets that are expensive to draw, but
+ * don't change often. It must not be used for widgets whose drawing
+ * depends on anything else than their own state, or that invalidate
+ * their windows directly with gdk_window_invalidate_rect() rather
+ * than gtk_widget_queue_draw(), as these would keep showing stale
+ * content.
+ *
+ * Since: 3.12
+ **/
+void
+gtk_widget_set_cache_draw (GtkWidget *widget,
+                           gboolean   cache_draw)
+{
+  g_return_if_fail (GTK_IS_WIDGET (widget));
+
+  cache_draw = (cache_draw != FALSE);
+
+  if (widget->priv->cache_draw != cache_draw)
+    {
+      widget->priv->cache_draw = cache_draw;
+      gtk_widget_drop_draw_cache (widget);
+    }
+}
+
+/**
+ * gtk_widget_get_cache_draw:
+ * @widget: a #GtkWidget
+ *
+ * Determines whether the widget keeps what it draws between frames.
+ * See gtk_widget_set_cache_draw().
+ *
+ * Return value: %TRUE if the output of @widget is cached
+ *
+ * Since: 3.12
+ **/
+gboolean
+gtk_widget_get_cache_draw (GtkWidget *widget)
+{
+  g_return_val_if_fail (GTK_IS_WIDGET (widget), FALSE);
+
+  return widget->priv->cache_draw;
+}
+
 /**
  * gtk_widget_set_redraw_on_allocate:
  * @widget: a #GtkWidget
@@ -8821,6 +9155,8 @@ gtk_widget_get_style (GtkWidget *widget)
                                   NULL);
 
     }
+  else
+    _gtk_style_ensure_updated (priv->style);
 
   return priv->style;
 }
@@ -9924,21 +10260,18 @@ static void
 update_pango_context (GtkWidget    *widget,
 		      PangoContext *context)
 {
-  PangoFontDescription *font_desc;
   GtkStyleContext *style_context;
 
+  /* The description is shared by all widgets with the same computed
+   * style, and Pango keeps its caches if it did not change
+   */
   style_context = gtk_widget_get_style_context (widget);
-  gtk_style_context_get (style_context,
-                         gtk_widget_get_state_flags (widget),
-                         "font", &font_desc,
-                         NULL);
-
-  pango_context_set_font_description (context, font_desc);
+  pango_context_set_font_description (context,
+                                      gtk_style_context_get_font (style_context,
+                                                                  gtk_widget_get_state_flags (widget)));
   pango_context_set_base_dir (context,
 			      gtk_widget_get_direction (widget) == GTK_TEXT_DIR_LTR ?
 			      PANGO_DIRECTION_LTR : PANGO_DIRECTION_RTL);
-
-  pango_font_description_free (font_desc);
 }
 
 static void
@@ -11826,6 +12159,9 @@ gtk_widget_finalize (GObject *object)
     }
 
   _gtk_size_request_cache_free (&priv->requests);
+  gtk_widget_drop_old_requests (widget);
+
+  gtk_widget_drop_draw_cache (widget);
 
   if (g_object_is_floating (object))
     g_warning ("A floating object was finalized. This means that someone\n"
@@ -13122,6 +13458,35 @@ gtk_widget_class_set_accessible_role (GtkWidgetClass *widget_class,
   priv->accessible_role = role;
 }
 
+/*
+ * _gtk_widget_class_set_request_cache_size:
+ * @widget_class: a #GtkWidgetClass
+ * @n_sizes: how many height-for-width (or width-for-height) results
+ *     to cache per widget and orientation
+ *
+ * Widgets that are typically asked for many different for_sizes
+ * while a window gets resized, and that are expensive to measure,
+ * can use this to keep more results around. The value is inherited
+ * by subclasses and capped at %GTK_SIZE_REQUEST_MAX_CACHED_SIZES.
+ *
+ * This function should only be called from class init functions of widgets.
+ */
+void
+_gtk_widget_class_set_request_cache_size (GtkWidgetClass *widget_class,
+                                          guint           n_sizes)
+{
+  g_return_if_fail (GTK_IS_WIDGET_CLASS (widget_class));
+  g_return_if_fail (n_sizes > 0);
+
+  widget_class->priv->request_cache_size = MIN (n_sizes, GTK_SIZE_REQUEST_MAX_CACHED_SIZES);
+}
+
+guint
+_gtk_widget_class_get_request_cache_size (GtkWidgetClass *widget_class)
+{
+  return widget_class->priv->request_cache_size;
+}
+
 /**
  * _gtk_widget_peek_accessible:
  * @widget: a #GtkWidget
@@ -16090,6 +16455,8 @@ _gtk_widget_style_context_invalidated (GtkWidget *widget)
       widget->priv->path = NULL;
     }
 
+  gtk_widget_invalidate_draw_cache (widget);
+
   if (gtk_widget_get_realized (widget))
     g_signal_emit (widget, widget_signals[STYLE_UPDATED], 0);
   else
@@ -16229,6 +16596,53 @@ _gtk_widget_get_action_muxer (GtkWidget *widget)
   return widget->priv->muxer;
 }
 
+/* The shortest slice idle work gets, so that it always makes progress */
+#define MIN_IDLE_SLICE 1000
+
+/*
+ * _gtk_widget_get_idle_deadline:
+ * @widget: a #GtkWidget
+ * @budget: the longest time the work may take, in microseconds
+ *
+ * Returns the monotonic time at which background work for @widget,
+ * like validating rows or lines, should stop and return to the main
+ * loop. That is at most @budget from now. While the frame clock is
+ * running, the work must not run into the next frame, and it gets
+ * only a minimal slice if there are events waiting.
+ */
+gint64
+_gtk_widget_get_idle_deadline (GtkWidget *widget,
+                               gint64     budget)
+{
+  GdkFrameClock *frame_clock;
+  gint64 now, deadline;
+
+  now = g_get_monotonic_time ();
+  deadline = now + budget;
+
+  if (gdk_events_pending ())
+    return now + MIN (budget, MIN_IDLE_SLICE);
+
+  frame_clock = gtk_widget_get_frame_clock (widget);
+  if (frame_clock)
+    {
+      gint64 frame_time, refresh_interval, presentation_time;
+      gint64 next_frame;
+
+      frame_time = gdk_frame_clock_get_frame_time (frame_clock);
+      gdk_frame_clock_get_refresh_info (frame_clock, frame_time,
+                                        &refresh_interval, &presentation_time);
+      next_frame = frame_time + refresh_interval;
+
+      /* Leave a quarter of the frame for updating the layout and painting */
+      if (next_frame > now)
+        deadline = MIN (deadline,
+                        MAX (now + MIN_IDLE_SLICE, next_frame - refresh_interval / 4));
+    }
+
+  return deadline;
+}
+
 /**
  * gtk_widget_insert_action_group:
  * @widget: a #GtkWidget
@@ -858,6 +858,11 @@ gboolean              gtk_widget_get_app_paintable      (GtkWidget    *widget);
 void                  gtk_widget_set_double_buffered    (GtkWidget    *widget,
 							 gboolean      double_buffered);
 gboolean              gtk_widget_get_double_buffered    (GtkWidget    *widget);
+GDK_AVAILABLE_IN_3_12
+void                  gtk_widget_set_cache_draw         (GtkWidget    *widget,
+                                                         gboolean      cache_draw);
+GDK_AVAILABLE_IN_3_12
+gboolean              gtk_widget_get_cache_draw         (GtkWidget    *widget);
 
 void                  gtk_widget_set_redraw_on_allocate (GtkWidget    *widget,
 							 gboolean      redraw_on_allocate);
@@ -22,7 +22,7 @@
 #include <string.h>
 
 #include "gtkwidget.h"
-#include "gtkwidgetpath.h"
+#include "gtkwidgetpathprivate.h"
 #include "gtkstylecontextprivate.h"
 
 /**
@@ -95,6 +95,14 @@ struct GtkPathElement
   GArray *classes;
   GtkWidgetPath *siblings;
   guint sibling_index;
+
+  /* Copying a path shares the regions and classes of its elements,
+   * which are copied again before they get modified. Paths are
+   * copied a lot more often than modified, see
+   * gtk_container_get_path_for_child().
+   */
+  guint regions_shared : 1;
+  guint classes_shared : 1;
 };
 
 struct _GtkWidgetPath
@@ -129,6 +137,8 @@ static void
 gtk_path_element_copy (GtkPathElement       *dest,
                        const GtkPathElement *src)
 {
+  GtkPathElement *shared = (GtkPathElement *) src;
+
   memset (dest, 0, sizeof (GtkPathElement));
 
   dest->type = src->type;
@@ -139,23 +149,56 @@ gtk_path_element_copy (GtkPathElement       *dest,
 
   if (src->regions)
     {
-      GHashTableIter iter;
-      gpointer key, value;
-
-      g_hash_table_iter_init (&iter, src->regions);
-      dest->regions = g_hash_table_new (NULL, NULL);
-
-      while (g_hash_table_iter_next (&iter, &key, &value))
-        g_hash_table_insert (dest->regions, key, value);
+      dest->regions = g_hash_table_ref (src->regions);
+      dest->regions_shared = shared->regions_shared = TRUE;
     }
 
   if (src->classes)
     {
-      dest->classes = g_array_new (FALSE, FALSE, sizeof (GQuark));
-      g_array_append_vals (dest->classes, src->classes->data, src->classes->len);
+      dest->classes = g_array_ref (src->classes);
+      dest->classes_shared = shared->classes_shared = TRUE;
     }
 }
 
+/* Makes sure the regions of @elem aren't shared with another path
+ * before they get modified */
+static void
+gtk_path_element_unshare_regions (GtkPathElement *elem)
+{
+  GHashTable *regions;
+  GHashTableIter iter;
+  gpointer key, value;
+
+  if (!elem->regions_shared)
+    return;
+
+  regions = g_hash_table_new (NULL, NULL);
+
+  g_hash_table_iter_init (&iter, elem->regions);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    g_hash_table_insert (regions, key, value);
+
+  g_hash_table_unref (elem->regions);
+  elem->regions = regions;
+  elem->regions_shared = FALSE;
+}
+
+static void
+gtk_path_element_unshare_classes (GtkPathElement *elem)
+{
+  GArray *classes;
+
+  if (!elem->classes_shared)
+    return;
+
+  classes = g_array_new (FALSE, FALSE, sizeof (GQuark));
+  g_array_append_vals (classes, elem->classes->data, elem->classes->len);
+
+  g_array_unref (elem->classes);
+  elem->classes = classes;
+  elem->classes_shared = FALSE;
+}
+
 /**
  * gtk_widget_path_copy:
  * @path: a #GtkWidgetPath
@@ -237,10 +280,10 @@ gtk_widget_path_unref (GtkWidgetPath *path)
       elem = &g_array_index (path->elems, GtkPathElement, i);
 
       if (elem->regions)
-        g_hash_table_destroy (elem->regions);
+        g_hash_table_unref (elem->regions);
 
       if (elem->classes)
-        g_array_free (elem->classes, TRUE);
+        g_array_unref (elem->classes);
 
       if (elem->siblings)
         gtk_widget_path_unref (elem->siblings);
@@ -732,6 +775,8 @@ gtk_widget_path_iter_add_class (GtkWidgetPath *path,
 
   if (!elem->classes)
     elem->classes = g_array_new (FALSE, FALSE, sizeof (GQuark));
+  else
+    gtk_path_element_unshare_classes (elem);
 
   for (i = 0; i < elem->classes->len; i++)
     {
@@ -804,6 +849,7 @@ gtk_widget_path_iter_remove_class (GtkWidgetPath *path,
         break;
       else if (quark == qname)
         {
+          gtk_path_element_unshare_classes (elem);
           g_array_remove_index (elem->classes, i);
           break;
         }
@@ -838,7 +884,10 @@ gtk_widget_path_iter_clear_classes (GtkWidgetPath *path,
     return;
 
   if (elem->classes->len > 0)
-    g_array_remove_range (elem->classes, 0, elem->classes->len);
+    {
+      gtk_path_element_unshare_classes (elem);
+      g_array_remove_range (elem->classes, 0, elem->classes->len);
+    }
 }
 
 /**
@@ -1007,6 +1056,8 @@ gtk_widget_path_iter_add_region (GtkWidgetPath  *path,
 
   if (!elem->regions)
     elem->regions = g_hash_table_new (NULL, NULL);
+  else
+    gtk_path_element_unshare_regions (elem);
 
   g_hash_table_insert (elem->regions,
                        GUINT_TO_POINTER (qname),
@@ -1046,8 +1097,12 @@ gtk_widget_path_iter_remove_region (GtkWidgetPath *path,
 
   elem = &g_array_index (path->elems, GtkPathElement, pos);
 
-  if (elem->regions)
-    g_hash_table_remove (elem->regions, GUINT_TO_POINTER (qname));
+  if (elem->regions &&
+      g_hash_table_contains (elem->regions, GUINT_TO_POINTER (qname)))
+    {
+      gtk_path_element_unshare_regions (elem);
+      g_hash_table_remove (elem->regions, GUINT_TO_POINTER (qname));
+    }
 }
 
 /**
@@ -1074,8 +1129,11 @@ gtk_widget_path_iter_clear_regions (GtkWidgetPath *path,
 
   elem = &g_array_index (path->elems, GtkPathElement, pos);
 
-  if (elem->regions)
-    g_hash_table_remove_all (elem->regions);
+  if (elem->regions && g_hash_table_size (elem->regions) > 0)
+    {
+      gtk_path_element_unshare_regions (elem);
+      g_hash_table_remove_all (elem->regions);
+    }
 }
 
 /**
@@ -1295,3 +1353,181 @@ gtk_widget_path_has_parent (const GtkWidgetPath *path,
 
   return FALSE;
 }
+
+static guint
+gtk_path_element_hash (const GtkPathElement *elem)
+{
+  guint i, hash;
+
+  hash = g_direct_hash (GSIZE_TO_POINTER (elem->type));
+  hash = (hash << 5) + elem->name;
+
+  if (elem->classes)
+    {
+      for (i = 0; i < elem->classes->len; i++)
+        hash = (hash << 5) + g_array_index (elem->classes, GQuark, i);
+    }
+
+  if (elem->regions)
+    {
+      GHashTableIter iter;
+      gpointer key, value;
+
+      /* hash table iteration order is undefined, so combine commutatively */
+      g_hash_table_iter_init (&iter, elem->regions);
+      while (g_hash_table_iter_next (&iter, &key, &value))
+        hash ^= GPOINTER_TO_UINT (key) * 33 + GPOINTER_TO_UINT (value);
+    }
+
+  if (elem->siblings)
+    hash = (hash << 5) + elem->sibling_index + 1;
+
+  return hash;
+}
+
+static gboolean
+gtk_path_element_equal (const GtkPathElement *elem1,
+                        const GtkPathElement *elem2)
+{
+  guint n_classes1, n_classes2;
+  guint n_regions1, n_regions2;
+
+  if (elem1->type != elem2->type ||
+      elem1->name != elem2->name)
+    return FALSE;
+
+  n_classes1 = elem1->classes ? elem1->classes->len : 0;
+  n_classes2 = elem2->classes ? elem2->classes->len : 0;
+  if (n_classes1 != n_classes2)
+    return FALSE;
+  /* classes are kept sorted, see gtk_widget_path_iter_add_class() */
+  if (n_classes1 > 0 &&
+      memcmp (elem1->classes->data, elem2->classes->data, n_classes1 * sizeof (GQuark)) != 0)
+    return FALSE;
+
+  n_regions1 = elem1->regions ? g_hash_table_size (elem1->regions) : 0;
+  n_regions2 = elem2->regions ? g_hash_table_size (elem2->regions) : 0;
+  if (n_regions1 != n_regions2)
+    return FALSE;
+  if (n_regions1 > 0)
+    {
+      GHashTableIter iter;
+      gpointer key, value, other;
+
+      g_hash_table_iter_init (&iter, elem1->regions);
+      while (g_hash_table_iter_next (&iter, &key, &value))
+        {
+          if (!g_hash_table_lookup_extended (elem2->regions, key, NULL, &other) ||
+              value != other)
+            return FALSE;
+        }
+    }
+
+  if ((elem1->siblings == NULL) != (elem2->siblings == NULL))
+    return FALSE;
+  if (elem1->siblings)
+    {
+      if (elem1->sibling_index != elem2->sibling_index)
+        return FALSE;
+      if (!_gtk_widget_path_equal (elem1->siblings, elem2->siblings))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/*
+ * _gtk_widget_path_hash:
+ * @path: a #GtkWidgetPath
+ *
+ * Computes a hash value for @path that is consistent with
+ * _gtk_widget_path_equal(), so paths can be used as keys in
+ * a #GHashTable.
+ *
+ * Returns: the hash value
+ */
+guint
+_gtk_widget_path_hash (gconstpointer path)
+{
+  const GtkWidgetPath *p = path;
+  guint i, hash = 0;
+
+  for (i = 0; i < p->elems->len; i++)
+    hash = hash * 31 + gtk_path_element_hash (&g_array_index (p->elems, GtkPathElement, i));
+
+  return hash;
+}
+
+/*
+ * _gtk_widget_path_equal:
+ * @path1: a #GtkWidgetPath
+ * @path2: another #GtkWidgetPath
+ *
+ * Checks if the two paths describe the same widget hierarchy, that
+ * is, if matching CSS selectors against them will give identical
+ * results for identical state.
+ *
+ * Returns: %TRUE if the paths are equal
+ */
+gboolean
+_gtk_widget_path_equal (gconstpointer path1,
+                        gconstpointer path2)
+{
+  const GtkWidgetPath *p1 = path1;
+  const GtkWidgetPath *p2 = path2;
+  guint i;
+
+  if (p1 == p2)
+    return TRUE;
+
+  if (p1->elems->len != p2->elems->len)
+    return FALSE;
+
+  for (i = 0; i < p1->elems->len; i++)
+    {
+      if (!gtk_path_element_equal (&g_array_index (p1->elems, GtkPathElement, i),
+                                   &g_array_index (p2->elems, GtkPathElement, i)))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/*
+ * _gtk_widget_path_iter_get_qclasses:
+ * @path: a #GtkWidgetPath
+ * @pos: position to query, -1 for the path head
+ * @n_classes: (out): return location for the number of classes
+ *
+ * Returns the sorted class quarks of the element at @pos without
+ * allocating a list, for matching code that needs to look at all
+ * of them.
+ *
+ * Returns: (transfer none): the class quarks, or %NULL if the
+ *   element has no classes
+ */
+const GQuark *
+_gtk_widget_path_iter_get_qclasses (const GtkWidgetPath *path,
+                                    gint                 pos,
+                                    guint               *n_classes)
+{
+  GtkPathElement *elem;
+
+  g_return_val_if_fail (path != NULL, NULL);
+  g_return_val_if_fail (path->elems->len != 0, NULL);
+  g_return_val_if_fail (n_classes != NULL, NULL);
+
+  if (pos < 0 || pos >= path->elems->len)
+    pos = path->elems->len - 1;
+
+  elem = &g_array_index (path->elems, GtkPathElement, pos);
+
+  if (!elem->classes || elem->classes->len == 0)
+    {
+      *n_classes = 0;
+      return NULL;
+    }
+
+  *n_classes = elem->classes->len;
+  return (const GQuark *) elem->classes->data;
+}
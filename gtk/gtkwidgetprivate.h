@@ -48,6 +48,8 @@ void         _gtk_widget_set_shadowed       (GtkWidget *widget,
 gboolean     _gtk_widget_get_alloc_needed   (GtkWidget *widget);
 void         _gtk_widget_set_alloc_needed   (GtkWidget *widget,
                                              gboolean   alloc_needed);
+void         _gtk_widget_queue_resize_if_changed (GtkWidget *widget);
+void         _gtk_widget_reallocate         (GtkWidget *widget);
 
 void         _gtk_widget_add_sizegroup         (GtkWidget    *widget,
 						gpointer      group);
@@ -75,6 +77,8 @@ void _gtk_widget_compute_size_for_orientation  (GtkWidget         *widget,
                                                 gint              *natural_size,
 						gint              *minimum_baseline,
 						gint              *natural_baseline);
+gboolean _gtk_widget_remeasure                 (GtkWidget         *widget,
+                                                gpointer           old_cache);
 void _gtk_widget_get_preferred_size_for_size   (GtkWidget         *widget,
                                                 GtkOrientation     orientation,
                                                 gint               size,
@@ -126,6 +130,9 @@ void              _gtk_widget_synthesize_crossing          (GtkWidget       *fro
                                                             GdkCrossingMode  mode);
 
 gpointer          _gtk_widget_peek_request_cache           (GtkWidget *widget);
+void              _gtk_widget_class_set_request_cache_size (GtkWidgetClass *widget_class,
+                                                            guint           n_sizes);
+guint             _gtk_widget_class_get_request_cache_size (GtkWidgetClass *widget_class);
 
 void              _gtk_widget_buildable_finish_accelerator (GtkWidget *widget,
                                                             GtkWidget *toplevel,
@@ -139,6 +146,9 @@ void              _gtk_widget_style_context_invalidated    (GtkWidget    *widget
 void              _gtk_widget_update_parent_muxer          (GtkWidget    *widget);
 GtkActionMuxer *  _gtk_widget_get_action_muxer             (GtkWidget    *widget);
 
+gint64            _gtk_widget_get_idle_deadline            (GtkWidget    *widget,
+                                                            gint64        budget);
+
 G_END_DECLS
 
 #endif /* __GTK_WIDGET_PRIVATE_H__ */
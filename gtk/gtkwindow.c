@@ -541,6 +541,7 @@ static gboolean     sent_startup_notification = FALSE;
 
 static GQuark       quark_gtk_embedded = 0;
 static GQuark       quark_gtk_window_key_hash = 0;
+static GQuark       quark_gtk_window_key_entries = 0;
 static GQuark       quark_gtk_window_icon_info = 0;
 static GQuark       quark_gtk_buildable_accels = 0;
 
@@ -673,6 +674,7 @@ gtk_window_class_init (GtkWindowClass *klass)
   
   quark_gtk_embedded = g_quark_from_static_string ("gtk-embedded");
   quark_gtk_window_key_hash = g_quark_from_static_string ("gtk-window-key-hash");
+  quark_gtk_window_key_entries = g_quark_from_static_string ("gtk-window-key-entries");
   quark_gtk_window_icon_info = g_quark_from_static_string ("gtk-window-icon-info");
   quark_gtk_buildable_accels = g_quark_from_static_string ("gtk-window-buildable-accels");
 
@@ -11572,13 +11574,6 @@ _gtk_window_keys_foreach (GtkWindow                *window,
     gtk_application_foreach_accel_keys (window->priv->application, window, func, func_data);
 }
 
-static void
-gtk_window_keys_changed (GtkWindow *window)
-{
-  gtk_window_free_key_hash (window);
-  gtk_window_get_key_hash (window);
-}
-
 typedef struct _GtkWindowKeyEntry GtkWindowKeyEntry;
 
 struct _GtkWindowKeyEntry
@@ -11588,31 +11583,60 @@ struct _GtkWindowKeyEntry
   guint is_mnemonic : 1;
 };
 
+static GtkWindowKeyEntry *
+window_key_entry_new (guint           keyval,
+                      GdkModifierType modifiers,
+                      gboolean        is_mnemonic)
+{
+  GtkWindowKeyEntry *entry = g_slice_new (GtkWindowKeyEntry);
+
+  entry->keyval = keyval;
+  entry->modifiers = modifiers;
+  entry->is_mnemonic = is_mnemonic;
+
+  return entry;
+}
+
 static void 
 window_key_entry_destroy (gpointer data)
 {
   g_slice_free (GtkWindowKeyEntry, data);
 }
 
-static void
-add_to_key_hash (GtkWindow      *window,
-		 guint           keyval,
-		 GdkModifierType modifiers,
-		 gboolean        is_mnemonic,
-		 gpointer        data)
+static guint
+window_key_entry_hash (gconstpointer data)
 {
-  GtkKeyHash *key_hash = data;
+  const GtkWindowKeyEntry *entry = data;
 
-  GtkWindowKeyEntry *entry = g_slice_new (GtkWindowKeyEntry);
+  return entry->keyval ^ (entry->modifiers << 8) ^ entry->is_mnemonic;
+}
 
-  entry->keyval = keyval;
-  entry->modifiers = modifiers;
-  entry->is_mnemonic = is_mnemonic;
+static gboolean
+window_key_entry_equal (gconstpointer a,
+                        gconstpointer b)
+{
+  const GtkWindowKeyEntry *entry_a = a;
+  const GtkWindowKeyEntry *entry_b = b;
+
+  return entry_a->keyval == entry_b->keyval &&
+         entry_a->modifiers == entry_b->modifiers &&
+         entry_a->is_mnemonic == entry_b->is_mnemonic;
+}
+
+static GtkWindowKeyEntry *
+add_to_key_hash (GtkKeyHash        *key_hash,
+                 GtkWindowKeyEntry *key)
+{
+  GtkWindowKeyEntry *entry;
+  guint keyval;
+
+  entry = window_key_entry_new (key->keyval, key->modifiers, key->is_mnemonic);
+  keyval = entry->keyval;
 
   /* GtkAccelGroup stores lowercased accelerators. To deal
    * with this, if <Shift> was specified, uppercase.
    */
-  if (modifiers & GDK_SHIFT_MASK)
+  if (entry->modifiers & GDK_SHIFT_MASK)
     {
       if (keyval == GDK_KEY_Tab)
 	keyval = GDK_KEY_ISO_Left_Tab;
@@ -11621,6 +11645,115 @@ add_to_key_hash (GtkWindow      *window,
     }
   
   _gtk_key_hash_add_entry (key_hash, keyval, entry->modifiers, entry);
+
+  return entry;
+}
+
+static void
+count_key (GtkWindow      *window,
+           guint           keyval,
+           GdkModifierType modifiers,
+           gboolean        is_mnemonic,
+           gpointer        data)
+{
+  GHashTable *wanted = data;
+  GtkWindowKeyEntry *key;
+  guint count;
+
+  key = window_key_entry_new (keyval, modifiers, is_mnemonic);
+  count = GPOINTER_TO_UINT (g_hash_table_lookup (wanted, key));
+  g_hash_table_replace (wanted, key, GUINT_TO_POINTER (count + 1));
+}
+
+static void
+free_key_entries (GHashTable *entries)
+{
+  GHashTableIter iter;
+  gpointer list;
+
+  g_hash_table_iter_init (&iter, entries);
+  while (g_hash_table_iter_next (&iter, NULL, &list))
+    g_slist_free (list);
+
+  g_hash_table_unref (entries);
+}
+
+/* Brings the key hash in line with the current accelerators and
+ * mnemonics. @entries maps each distinct key to the entries that
+ * are in the key hash for it, so that only keys that were added or
+ * removed touch the key hash; the keycode lookup of the key hash,
+ * which needs to query the keymap, stays valid for everything else.
+ */
+static void
+gtk_window_update_key_hash (GtkWindow  *window,
+                            GtkKeyHash *key_hash,
+                            GHashTable *entries)
+{
+  GHashTable *wanted;
+  GHashTableIter iter;
+  gpointer key, value;
+
+  wanted = g_hash_table_new_full (window_key_entry_hash, window_key_entry_equal,
+                                  window_key_entry_destroy, NULL);
+  _gtk_window_keys_foreach (window, count_key, wanted);
+
+  g_hash_table_iter_init (&iter, entries);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      GSList *list = value;
+      guint count, n;
+
+      count = GPOINTER_TO_UINT (g_hash_table_lookup (wanted, key));
+      n = g_slist_length (list);
+
+      for (; n > count; n--)
+        {
+          _gtk_key_hash_remove_entry (key_hash, list->data);
+          list = g_slist_delete_link (list, list);
+        }
+
+      for (; n < count; n++)
+        {
+          list = g_slist_prepend (list, add_to_key_hash (key_hash, key));
+        }
+
+      g_hash_table_remove (wanted, key);
+
+      if (list)
+        g_hash_table_iter_replace (&iter, list);
+      else
+        g_hash_table_iter_remove (&iter);
+    }
+
+  g_hash_table_iter_init (&iter, wanted);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      GtkWindowKeyEntry *entry = key;
+      GSList *list = NULL;
+      guint count;
+
+      for (count = GPOINTER_TO_UINT (value); count > 0; count--)
+        {
+          list = g_slist_prepend (list, add_to_key_hash (key_hash, entry));
+        }
+
+      g_hash_table_insert (entries,
+                           window_key_entry_new (entry->keyval, entry->modifiers, entry->is_mnemonic),
+                           list);
+    }
+
+  g_hash_table_unref (wanted);
+}
+
+static void
+gtk_window_keys_changed (GtkWindow *window)
+{
+  GtkKeyHash *key_hash = g_object_get_qdata (G_OBJECT (window), quark_gtk_window_key_hash);
+
+  /* Otherwise it gets built on the next key press */
+  if (key_hash)
+    gtk_window_update_key_hash (window, key_hash,
+                                g_object_get_qdata (G_OBJECT (window), quark_gtk_window_key_entries));
 }
 
 static GtkKeyHash *
@@ -11628,14 +11761,19 @@ gtk_window_get_key_hash (GtkWindow *window)
 {
   GdkScreen *screen = gtk_window_check_screen (window);
   GtkKeyHash *key_hash = g_object_get_qdata (G_OBJECT (window), quark_gtk_window_key_hash);
+  GHashTable *entries;
   
   if (key_hash)
     return key_hash;
   
   key_hash = _gtk_key_hash_new (gdk_keymap_get_for_display (gdk_screen_get_display (screen)),
 				(GDestroyNotify)window_key_entry_destroy);
-  _gtk_window_keys_foreach (window, add_to_key_hash, key_hash);
+  entries = g_hash_table_new_full (window_key_entry_hash, window_key_entry_equal,
+                                   window_key_entry_destroy, NULL);
+  gtk_window_update_key_hash (window, key_hash, entries);
   g_object_set_qdata (G_OBJECT (window), quark_gtk_window_key_hash, key_hash);
+  g_object_set_qdata_full (G_OBJECT (window), quark_gtk_window_key_entries,
+                           entries, (GDestroyNotify) free_key_entries);
 
   return key_hash;
 }
@@ -11646,6 +11784,7 @@ gtk_window_free_key_hash (GtkWindow *window)
   GtkKeyHash *key_hash = g_object_get_qdata (G_OBJECT (window), quark_gtk_window_key_hash);
   if (key_hash)
     {
+      g_object_set_qdata (G_OBJECT (window), quark_gtk_window_key_entries, NULL);
       _gtk_key_hash_free (key_hash);
       g_object_set_qdata (G_OBJECT (window), quark_gtk_window_key_hash, NULL);
     }
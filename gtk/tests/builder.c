@@ -2333,6 +2333,75 @@ test_add_objects (void)
   g_object_unref (builder);
 }
 
+static void
+test_lazy (void)
+{
+  GtkBuilder *builder;
+  GError *error;
+  GSList *objects;
+  GObject *window, *label, *spin, *adjustment;
+  const gchar buffer[] =
+    "<interface>"
+    "  <object class=\"GtkWindow\" id=\"window1\" lazy=\"true\">"
+    "    <child>"
+    "      <object class=\"GtkLabel\" id=\"label1\">"
+    "        <property name=\"label\" translatable=\"no\">lazy label</property>"
+    "      </object>"
+    "    </child>"
+    "  </object>"
+    "  <object class=\"GtkAdjustment\" id=\"adjustment1\" lazy=\"true\"/>"
+    "  <object class=\"GtkSpinButton\" id=\"spinbutton1\">"
+    "    <property name=\"adjustment\">adjustment1</property>"
+    "  </object>"
+    "</interface>";
+  const gchar buffer2[] =
+    "<interface>"
+    "  <object class=\"GtkWindow\" id=\"window1\">"
+    "    <child>"
+    "      <object class=\"GtkLabel\" id=\"label1\" lazy=\"true\"/>"
+    "    </child>"
+    "  </object>"
+    "</interface>";
+
+  error = NULL;
+  builder = gtk_builder_new ();
+  gtk_builder_add_from_string (builder, buffer, -1, &error);
+  g_assert_no_error (error);
+
+  /* Referring to a lazy object constructs it */
+  spin = gtk_builder_get_object (builder, "spinbutton1");
+  g_assert (GTK_IS_SPIN_BUTTON (spin));
+  adjustment = gtk_builder_get_object (builder, "adjustment1");
+  g_assert (GTK_IS_ADJUSTMENT (adjustment));
+  g_assert (gtk_spin_button_get_adjustment (GTK_SPIN_BUTTON (spin)) == GTK_ADJUSTMENT (adjustment));
+
+  objects = gtk_builder_get_objects (builder);
+  g_assert_cmpint (g_slist_length (objects), ==, 2);
+  g_slist_free (objects);
+
+  /* Asking for a child constructs the whole toplevel */
+  label = gtk_builder_get_object (builder, "label1");
+  g_assert (GTK_IS_LABEL (label));
+  g_assert_cmpstr (gtk_label_get_label (GTK_LABEL (label)), ==, "lazy label");
+  window = gtk_builder_get_object (builder, "window1");
+  g_assert (GTK_IS_WINDOW (window));
+  g_assert (gtk_widget_get_parent (GTK_WIDGET (label)) == GTK_WIDGET (window));
+
+  objects = gtk_builder_get_objects (builder);
+  g_assert_cmpint (g_slist_length (objects), ==, 4);
+  g_slist_free (objects);
+
+  gtk_widget_destroy (GTK_WIDGET (window));
+  g_object_unref (builder);
+
+  /* Only toplevels can be lazy */
+  builder = gtk_builder_new ();
+  gtk_builder_add_from_string (builder, buffer2, -1, &error);
+  g_assert_error (error, GTK_BUILDER_ERROR, GTK_BUILDER_ERROR_INVALID_ATTRIBUTE);
+  g_error_free (error);
+  g_object_unref (builder);
+}
+
 static GtkWidget *
 get_parent_menubar (GtkWidget *menuitem)
 {
@@ -2719,6 +2788,7 @@ main (int argc, char **argv)
   g_test_add_func ("/Builder/PangoAttributes", test_pango_attributes);
   g_test_add_func ("/Builder/Requires", test_requires);
   g_test_add_func ("/Builder/AddObjects", test_add_objects);
+  g_test_add_func ("/Builder/Lazy", test_lazy);
   g_test_add_func ("/Builder/Menus", test_menus);
   g_test_add_func ("/Builder/MessageArea", test_message_area);
   g_test_add_func ("/Builder/MessageDialog", test_message_dialog);
@@ -0,0 +1,181 @@
+/* Extensive GtkColumnStore tests.
+ * Copyright (C) 2013 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+
+#include "treemodel.h"
+
+static void
+column_store_test_append (void)
+{
+  GtkColumnStore *store;
+  GtkTreeIter iter;
+  gint i;
+
+  store = gtk_column_store_new (3, G_TYPE_INT, G_TYPE_DOUBLE, G_TYPE_STRING);
+
+  for (i = 0; i < 100; i++)
+    {
+      gtk_column_store_append (store, &iter);
+      g_assert (gtk_column_store_iter_is_valid (store, &iter));
+      gtk_column_store_set (store, &iter,
+                            0, i,
+                            1, i / 2.0,
+                            2, i % 2 ? "odd" : "even",
+                            -1);
+    }
+
+  g_assert_cmpint (gtk_tree_model_iter_n_children (GTK_TREE_MODEL (store), NULL), ==, 100);
+
+  g_assert (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter));
+  for (i = 0; i < 100; i++)
+    {
+      gint n;
+      gdouble d;
+      gchar *s;
+
+      gtk_tree_model_get (GTK_TREE_MODEL (store), &iter,
+                          0, &n,
+                          1, &d,
+                          2, &s,
+                          -1);
+      g_assert_cmpint (n, ==, i);
+      g_assert_cmpfloat (d, ==, i / 2.0);
+      g_assert_cmpstr (s, ==, i % 2 ? "odd" : "even");
+      g_free (s);
+
+      g_assert (gtk_tree_model_iter_next (GTK_TREE_MODEL (store), &iter) == (i < 99));
+    }
+
+  g_object_unref (store);
+}
+
+static void
+column_store_test_insert_remove (void)
+{
+  GtkColumnStore *store;
+  GtkTreeIter iter, first;
+  GtkTreePath *path;
+  gint n;
+
+  store = gtk_column_store_new (1, G_TYPE_INT);
+
+  gtk_column_store_append (store, &first);
+  gtk_column_store_set (store, &first, 0, 1, -1);
+  gtk_column_store_append (store, &iter);
+  gtk_column_store_set (store, &iter, 0, 3, -1);
+
+  /* Appending keeps other iters valid */
+  g_assert (gtk_column_store_iter_is_valid (store, &first));
+
+  gtk_column_store_insert (store, &iter, 1);
+  gtk_column_store_set (store, &iter, 0, 2, -1);
+
+  /* Inserting in the middle does not */
+  g_assert (!gtk_column_store_iter_is_valid (store, &first));
+
+  path = gtk_tree_model_get_path (GTK_TREE_MODEL (store), &iter);
+  g_assert_cmpint (gtk_tree_path_get_indices (path)[0], ==, 1);
+  gtk_tree_path_free (path);
+
+  g_assert (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &iter, NULL, 0));
+  g_assert (gtk_column_store_remove (store, &iter));
+  gtk_tree_model_get (GTK_TREE_MODEL (store), &iter, 0, &n, -1);
+  g_assert_cmpint (n, ==, 2);
+
+  g_assert (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &iter, NULL, 1));
+  g_assert (!gtk_column_store_remove (store, &iter));
+  g_assert_cmpint (gtk_tree_model_iter_n_children (GTK_TREE_MODEL (store), NULL), ==, 1);
+
+  gtk_column_store_clear (store);
+  g_assert_cmpint (gtk_tree_model_iter_n_children (GTK_TREE_MODEL (store), NULL), ==, 0);
+  g_assert (!gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter));
+
+  g_object_unref (store);
+}
+
+static void
+column_store_test_signals (void)
+{
+  GtkColumnStore *store;
+  SignalMonitor *monitor;
+  GtkTreeIter iter;
+
+  store = gtk_column_store_new (1, G_TYPE_STRING);
+  monitor = signal_monitor_new (GTK_TREE_MODEL (store));
+
+  signal_monitor_append_signal (monitor, ROW_INSERTED, "0");
+  gtk_column_store_append (store, &iter);
+  signal_monitor_assert_is_empty (monitor);
+
+  signal_monitor_append_signal (monitor, ROW_CHANGED, "0");
+  gtk_column_store_set (store, &iter, 0, "Row content", -1);
+  signal_monitor_assert_is_empty (monitor);
+
+  signal_monitor_append_signal (monitor, ROW_INSERTED, "0");
+  gtk_column_store_insert (store, &iter, 0);
+  signal_monitor_assert_is_empty (monitor);
+
+  signal_monitor_append_signal (monitor, ROW_DELETED, "1");
+  signal_monitor_append_signal (monitor, ROW_DELETED, "0");
+  gtk_column_store_clear (store);
+  signal_monitor_assert_is_empty (monitor);
+
+  signal_monitor_free (monitor);
+  g_object_unref (store);
+}
+
+static void
+column_store_test_tree_view (void)
+{
+  GtkColumnStore *store;
+  GtkWidget *view;
+  GtkTreeIter iter;
+  gint i;
+
+  store = gtk_column_store_new (1, G_TYPE_STRING);
+  for (i = 0; i < 10; i++)
+    {
+      gtk_column_store_append (store, &iter);
+      gtk_column_store_set (store, &iter, 0, "Row content", -1);
+    }
+
+  view = gtk_tree_view_new_with_model (GTK_TREE_MODEL (store));
+  g_object_ref_sink (view);
+
+  g_assert (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &iter, NULL, 4));
+  gtk_column_store_remove (store, &iter);
+  gtk_column_store_insert (store, &iter, 2);
+
+  g_object_unref (view);
+  g_object_unref (store);
+}
+
+/* main */
+
+void
+register_column_store_tests (void)
+{
+  g_test_add_func ("/ColumnStore/append",
+                   column_store_test_append);
+  g_test_add_func ("/ColumnStore/insert-remove",
+                   column_store_test_insert_remove);
+  g_test_add_func ("/ColumnStore/signals",
+                   column_store_test_signals);
+  g_test_add_func ("/ColumnStore/tree-view",
+                   column_store_test_tree_view);
+}
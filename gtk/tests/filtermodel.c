@@ -3570,6 +3570,65 @@ ref_count_cleanup (void)
   g_object_unref (ref_model);
 }
 
+static gboolean
+quit_loop (gpointer data)
+{
+  g_main_loop_quit (data);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+ref_count_cleanup_timeout (void)
+{
+  GtkTreeIter grandparent1, grandparent2, parent1, parent2;
+  GtkTreeIter iter_parent1, iter_parent2;
+  GtkTreeModel *model;
+  GtkTreeModelRefCount *ref_model;
+  GtkTreeModel *filter_model;
+  GtkWidget *tree_view;
+  GMainLoop *loop;
+
+  model = gtk_tree_model_ref_count_new ();
+  ref_model = GTK_TREE_MODEL_REF_COUNT (model);
+
+  gtk_tree_store_append (GTK_TREE_STORE (model), &grandparent1, NULL);
+  gtk_tree_store_append (GTK_TREE_STORE (model), &grandparent2, NULL);
+  gtk_tree_store_append (GTK_TREE_STORE (model), &parent1, &grandparent2);
+  gtk_tree_store_append (GTK_TREE_STORE (model), &iter_parent1, &parent1);
+  gtk_tree_store_append (GTK_TREE_STORE (model), &parent2, &grandparent2);
+  gtk_tree_store_append (GTK_TREE_STORE (model), &iter_parent2, &parent2);
+
+  filter_model = gtk_tree_model_filter_new (model, NULL);
+  gtk_tree_model_filter_set_cache_timeout (GTK_TREE_MODEL_FILTER (filter_model), 1);
+  g_assert_cmpuint (gtk_tree_model_filter_get_cache_timeout (GTK_TREE_MODEL_FILTER (filter_model)), ==, 1);
+
+  tree_view = gtk_tree_view_new_with_model (filter_model);
+  gtk_tree_view_expand_all (GTK_TREE_VIEW (tree_view));
+  gtk_widget_destroy (tree_view);
+
+  assert_node_ref_count (ref_model, &iter_parent1, 1);
+  assert_node_ref_count (ref_model, &iter_parent2, 1);
+
+  /* Once the timeout ran, the same levels are gone as with
+   * gtk_tree_model_filter_clear_cache().
+   */
+  loop = g_main_loop_new (NULL, FALSE);
+  g_timeout_add (1500, quit_loop, loop);
+  g_main_loop_run (loop);
+  g_main_loop_unref (loop);
+
+  assert_node_ref_count (ref_model, &grandparent1, 1);
+  assert_node_ref_count (ref_model, &grandparent2, 1);
+  assert_node_ref_count (ref_model, &parent1, 1);
+  assert_node_ref_count (ref_model, &parent2, 0);
+  assert_node_ref_count (ref_model, &iter_parent1, 0);
+  assert_node_ref_count (ref_model, &iter_parent2, 0);
+
+  g_object_unref (filter_model);
+  g_object_unref (ref_model);
+}
+
 static void
 ref_count_row_ref (void)
 {
@@ -6762,6 +6821,71 @@ specific_bug_659022_row_deleted_free_level (void)
   g_object_unref (model);
 }
 
+static gboolean
+refilter_incremental_visible_func (GtkTreeModel *model,
+                                   GtkTreeIter  *iter,
+                                   gpointer      data)
+{
+  gint value;
+
+  gtk_tree_model_get (model, iter, 0, &value, -1);
+
+  return value < *(gint *) data;
+}
+
+static void
+refilter_incremental (void)
+{
+  GtkListStore *store;
+  GtkTreeModel *filter;
+  GtkTreeIter iter;
+  gint threshold = 0;
+  gint i;
+
+  store = gtk_list_store_new (1, G_TYPE_INT);
+  for (i = 0; i < 10000; i++)
+    gtk_list_store_insert_with_values (store, NULL, i, 0, i, -1);
+
+  filter = gtk_tree_model_filter_new (GTK_TREE_MODEL (store), NULL);
+  gtk_tree_model_filter_set_visible_func (GTK_TREE_MODEL_FILTER (filter),
+                                          refilter_incremental_visible_func,
+                                          &threshold, NULL);
+  g_assert_cmpint (gtk_tree_model_iter_n_children (filter, NULL), ==, 0);
+
+  /* Nothing happens until the main loop runs */
+  threshold = 5000;
+  gtk_tree_model_filter_refilter_incremental (GTK_TREE_MODEL_FILTER (filter));
+  g_assert_cmpint (gtk_tree_model_iter_n_children (filter, NULL), ==, 0);
+
+  /* A newer request restarts the walk */
+  threshold = 7000;
+  gtk_tree_model_filter_refilter_incremental (GTK_TREE_MODEL_FILTER (filter));
+
+  /* Changes to the child model while the walk runs are picked up */
+  gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &iter, NULL, 0);
+  gtk_list_store_remove (store, &iter);
+
+  while (gtk_events_pending ())
+    gtk_main_iteration ();
+
+  g_assert_cmpint (gtk_tree_model_iter_n_children (filter, NULL), ==, 6999);
+
+  /* A synchronous refilter cancels a pending incremental one */
+  threshold = 100;
+  gtk_tree_model_filter_refilter_incremental (GTK_TREE_MODEL_FILTER (filter));
+  threshold = 200;
+  gtk_tree_model_filter_refilter (GTK_TREE_MODEL_FILTER (filter));
+  g_assert_cmpint (gtk_tree_model_iter_n_children (filter, NULL), ==, 199);
+
+  threshold = 100;
+  while (gtk_events_pending ())
+    gtk_main_iteration ();
+  g_assert_cmpint (gtk_tree_model_iter_n_children (filter, NULL), ==, 199);
+
+  g_object_unref (filter);
+  g_object_unref (store);
+}
+
 /* main */
 
 void
@@ -7030,6 +7154,8 @@ register_filter_model_tests (void)
                    ref_count_filter_row_length_gt_1_visible_children);
   g_test_add_func ("/TreeModelFilter/ref-count/cleanup",
                    ref_count_cleanup);
+  g_test_add_func ("/TreeModelFilter/ref-count/cleanup/timeout",
+                   ref_count_cleanup_timeout);
   g_test_add_func ("/TreeModelFilter/ref-count/row-ref",
                    ref_count_row_ref);
 
@@ -7093,6 +7219,9 @@ register_filter_model_tests (void)
   g_test_add_func ("/TreeModelFilter/specific/virtual-ref-leaf-and-remove-ancestor",
                    specific_virtual_ref_leaf_and_remove_ancestor);
 
+  g_test_add_func ("/TreeModelFilter/refilter/incremental",
+                   refilter_incremental);
+
   g_test_add_func ("/TreeModelFilter/specific/bug-301558",
                    specific_bug_301558);
   g_test_add_func ("/TreeModelFilter/specific/bug-311955",
@@ -137,6 +137,64 @@ check_model (ListStore *fixture,
 }
 
 /* insertion */
+static void
+list_store_test_insert_many_row_inserted (GtkTreeModel *model,
+                                          GtkTreePath  *path,
+                                          GtkTreeIter  *iter,
+                                          gpointer      data)
+{
+  gint *n_inserted = data;
+  gint value;
+
+  /* Every row is complete when it is announced */
+  gtk_tree_model_get (model, iter, 0, &value, -1);
+  g_assert_cmpint (gtk_tree_path_get_indices (path)[0], ==, value);
+  (*n_inserted)++;
+}
+
+static void
+list_store_test_insert_many (void)
+{
+  GtkListStore *store;
+  GtkTreeIter iter;
+  GValue values[4] = { G_VALUE_INIT, };
+  gint columns[1] = { 0 };
+  gint n_inserted = 0;
+  gint i;
+
+  store = gtk_list_store_new (1, G_TYPE_INT);
+  gtk_list_store_insert_with_values (store, NULL, 0, 0, 0, -1);
+  gtk_list_store_insert_with_values (store, NULL, 1, 0, 5, -1);
+
+  g_signal_connect (store, "row-inserted",
+                    G_CALLBACK (list_store_test_insert_many_row_inserted),
+                    &n_inserted);
+
+  for (i = 0; i < 4; i++)
+    {
+      g_value_init (&values[i], G_TYPE_INT);
+      g_value_set_int (&values[i], i + 1);
+    }
+
+  gtk_list_store_insert_many (store, 1, 4, columns, values, 1);
+  g_assert_cmpint (n_inserted, ==, 4);
+  g_assert_cmpint (gtk_tree_model_iter_n_children (GTK_TREE_MODEL (store), NULL), ==, 6);
+
+  g_assert (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter));
+  for (i = 0; i < 6; i++)
+    {
+      gint value;
+
+      gtk_tree_model_get (GTK_TREE_MODEL (store), &iter, 0, &value, -1);
+      g_assert_cmpint (value, ==, i);
+      g_assert (gtk_tree_model_iter_next (GTK_TREE_MODEL (store), &iter) == (i < 5));
+    }
+
+  for (i = 0; i < 4; i++)
+    g_value_unset (&values[i]);
+  g_object_unref (store);
+}
+
 static void
 list_store_test_insert_high_values (void)
 {
@@ -1006,6 +1064,8 @@ register_list_store_tests (void)
   /* insertion */
   g_test_add_func ("/ListStore/insert-high-values",
 	           list_store_test_insert_high_values);
+  g_test_add_func ("/ListStore/insert-many",
+	           list_store_test_insert_many);
   g_test_add_func ("/ListStore/append",
 		   list_store_test_append);
   g_test_add_func ("/ListStore/prepend",
@@ -1032,6 +1032,92 @@ sorted_insert (void)
 }
 
 
+static void
+check_sorted (GtkTreeModel *sort_model,
+              gint          column,
+              GtkSortType   order)
+{
+  GtkTreeIter iter;
+  gchar *prev = NULL;
+  gint prev_n = 0;
+  gint n_rows = 0;
+  gboolean valid;
+
+  for (valid = gtk_tree_model_get_iter_first (sort_model, &iter);
+       valid;
+       valid = gtk_tree_model_iter_next (sort_model, &iter))
+    {
+      gchar *str;
+      gint n;
+
+      gtk_tree_model_get (sort_model, &iter, 0, &n, 1, &str, -1);
+
+      if (n_rows > 0)
+        {
+          gint cmp;
+
+          if (column == 0)
+            cmp = (n > prev_n) - (n < prev_n);
+          else
+            cmp = g_utf8_collate (str, prev);
+
+          if (order == GTK_SORT_ASCENDING)
+            g_assert_cmpint (cmp, >=, 0);
+          else
+            g_assert_cmpint (cmp, <=, 0);
+        }
+
+      g_free (prev);
+      prev = str;
+      prev_n = n;
+      n_rows++;
+    }
+
+  g_free (prev);
+  g_assert_cmpint (n_rows, ==, gtk_tree_model_iter_n_children (sort_model, NULL));
+}
+
+static void
+sort_large_level (void)
+{
+  const gchar *words[] = { "zebra", "Apple", "apple", "\303\251clair", "banana", "Zoo", "10", "9" };
+  GtkListStore *store;
+  GtkTreeModel *sort_model;
+  gint i;
+
+  /* Large enough to be sorted with extracted sort keys, and on
+   * several threads where there are several processors.
+   */
+  store = gtk_list_store_new (2, G_TYPE_INT, G_TYPE_STRING);
+  for (i = 0; i < 100000; i++)
+    {
+      gchar *str = g_strdup_printf ("%s %d", words[i % G_N_ELEMENTS (words)], (i * 7919) % 1000);
+
+      gtk_list_store_insert_with_values (store, NULL, -1,
+                                         0, (i * 7919) % 100003 - 50000,
+                                         1, str,
+                                         -1);
+      g_free (str);
+    }
+
+  sort_model = gtk_tree_model_sort_new_with_model (GTK_TREE_MODEL (store));
+
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (sort_model),
+                                        0, GTK_SORT_ASCENDING);
+  check_sorted (sort_model, 0, GTK_SORT_ASCENDING);
+
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (sort_model),
+                                        0, GTK_SORT_DESCENDING);
+  check_sorted (sort_model, 0, GTK_SORT_DESCENDING);
+
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (sort_model),
+                                        1, GTK_SORT_ASCENDING);
+  check_sorted (sort_model, 1, GTK_SORT_ASCENDING);
+
+  g_object_unref (sort_model);
+  g_object_unref (store);
+}
+
 static void
 specific_bug_300089 (void)
 {
@@ -1233,6 +1319,9 @@ register_sort_model_tests (void)
   g_test_add_func ("/TreeModelSort/sorted-insert",
                    sorted_insert);
 
+  g_test_add_func ("/TreeModelSort/sort-large-level",
+                   sort_large_level);
+
   g_test_add_func ("/TreeModelSort/specific/bug-300089",
                    specific_bug_300089);
   g_test_add_func ("/TreeModelSort/specific/bug-364946",
@@ -252,6 +252,24 @@ test_match (void)
   gtk_style_context_get_color (context, GTK_STATE_FLAG_NORMAL, &color);
   g_assert (gdk_rgba_equal (&color, &expected));
 
+  data = "* { color: #fff }\n"
+         ".button GtkButton { color: #f00 }\n"
+         "GtkButton GtkButton { color: #f00 }\n"
+         "#mywindow #mywindow { color: #f00 }";
+  gtk_css_provider_load_from_data (provider, data, -1, &error);
+  g_assert_no_error (error);
+  gtk_style_context_invalidate (context);
+  gtk_style_context_get_color (context, GTK_STATE_FLAG_NORMAL, &color);
+  g_assert (gdk_rgba_equal (&color, &expected));
+
+  data = "* { color: #f00 }\n"
+         "GtkOrientable > GtkButton { color: #fff }";
+  gtk_css_provider_load_from_data (provider, data, -1, &error);
+  g_assert_no_error (error);
+  gtk_style_context_invalidate (context);
+  gtk_style_context_get_color (context, GTK_STATE_FLAG_NORMAL, &color);
+  g_assert (gdk_rgba_equal (&color, &expected));
+
   g_object_unref (provider);
   g_object_unref (context);
 }
@@ -1267,6 +1267,310 @@ test_get_set(void)
   g_object_unref (buffer);
 }
 
+static void
+check_load_from_stream (GtkTextBuffer *buffer,
+                        const gchar   *str,
+                        gint           n_lines)
+{
+  GInputStream *stream;
+  GtkTextIter start, end;
+  GError *error = NULL;
+  gchar *text;
+
+  stream = g_memory_input_stream_new_from_data (str, -1, NULL);
+  g_assert (gtk_text_buffer_load_from_stream (buffer, stream, NULL, &error));
+  g_assert_no_error (error);
+  g_object_unref (stream);
+
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  text = gtk_text_iter_get_text (&start, &end);
+  g_assert_cmpstr (text, ==, str);
+  g_free (text);
+
+  g_assert_cmpint (gtk_text_buffer_get_line_count (buffer), ==, n_lines);
+}
+
+static void
+test_load_from_stream (void)
+{
+  GtkTextBuffer *buffer;
+  GInputStream *stream;
+  GtkTextIter start, end;
+  GError *error = NULL;
+  gchar *text;
+
+  buffer = gtk_text_buffer_new (NULL);
+
+  check_load_from_stream (buffer, "", 1);
+  check_load_from_stream (buffer, "Hello", 1);
+  check_load_from_stream (buffer, "Hello\nBar\r\nFoo\rBaz", 4);
+  check_load_from_stream (buffer, "Hello\xe2\x80\xa9Bar\xe2\x80\x9c\n", 3);
+
+  /* Invalid text leaves the buffer alone */
+  stream = g_memory_input_stream_new_from_data ("Foo\xff", -1, NULL);
+  g_assert (!gtk_text_buffer_load_from_stream (buffer, stream, NULL, &error));
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+  g_clear_error (&error);
+  g_object_unref (stream);
+
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  text = gtk_text_iter_get_text (&start, &end);
+  g_assert_cmpstr (text, ==, "Hello\xe2\x80\xa9Bar\xe2\x80\x9c\n");
+  g_free (text);
+
+  g_object_unref (buffer);
+}
+
+static void
+find_all_done (GObject      *source,
+               GAsyncResult *result,
+               gpointer      data)
+{
+  GArray *expected = data;
+  GError *error = NULL;
+  gint *offsets;
+  gint n_matches, i;
+
+  g_assert (gtk_text_buffer_find_all_finish (GTK_TEXT_BUFFER (source), result,
+                                             &offsets, &n_matches, &error));
+  g_assert_no_error (error);
+
+  g_assert_cmpint (n_matches * 2, ==, expected->len);
+  for (i = 0; i < n_matches * 2; i++)
+    g_assert_cmpint (offsets[i], ==, g_array_index (expected, gint, i));
+
+  g_free (offsets);
+  gtk_main_quit ();
+}
+
+static void
+check_find_all (const gchar        *text,
+                const gchar        *str,
+                GtkTextSearchFlags  flags)
+{
+  GtkTextBuffer *buffer;
+  GtkTextIter iter, match_start, match_end;
+  GArray *expected;
+
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_text (buffer, text, -1);
+
+  /* The matches have to be the ones forward_search() finds */
+  expected = g_array_new (FALSE, FALSE, sizeof (gint));
+  gtk_text_buffer_get_start_iter (buffer, &iter);
+  while (gtk_text_iter_forward_search (&iter, str, flags,
+                                       &match_start, &match_end, NULL))
+    {
+      gint offset;
+
+      offset = gtk_text_iter_get_offset (&match_start);
+      g_array_append_val (expected, offset);
+      offset = gtk_text_iter_get_offset (&match_end);
+      g_array_append_val (expected, offset);
+
+      iter = match_end;
+    }
+
+  gtk_text_buffer_find_all_async (buffer, str, flags, NULL,
+                                  find_all_done, expected);
+  gtk_main ();
+
+  g_array_unref (expected);
+  g_object_unref (buffer);
+}
+
+static void
+test_find_all (void)
+{
+  check_find_all ("foo bar foo\nbarfoo\n", "foo", 0);
+  check_find_all ("foo bar foo\nbarfoo\n", "Foo", 0);
+  check_find_all ("foo bar Foo\nbarFOO\n", "foo", GTK_TEXT_SEARCH_CASE_INSENSITIVE);
+  check_find_all ("aaaa", "aa", 0);
+  check_find_all ("one foo\nbar two foo\nbar\n", "foo\nbar", 0);
+  check_find_all ("\303\200 x \303\240\n\303\200", "\303\240", GTK_TEXT_SEARCH_CASE_INSENSITIVE);
+  check_find_all ("\303\200 x \303\240\n\303\200", "a\314\200", GTK_TEXT_SEARCH_CASE_INSENSITIVE);
+}
+
+static void
+test_tag_batch (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextTag *tag;
+  GtkTextIter start, end;
+  gint i;
+
+  buffer = gtk_text_buffer_new (NULL);
+  tag = gtk_text_buffer_create_tag (buffer, "bold", "weight", PANGO_WEIGHT_BOLD, NULL);
+  gtk_text_buffer_set_text (buffer, "one two three four five six", -1);
+
+  gtk_text_buffer_begin_tag_batch (buffer);
+  gtk_text_buffer_begin_tag_batch (buffer);
+
+  for (i = 0; i < 27; i += 4)
+    {
+      gtk_text_buffer_get_iter_at_offset (buffer, &start, i);
+      gtk_text_buffer_get_iter_at_offset (buffer, &end, i + 2);
+      gtk_text_buffer_apply_tag (buffer, tag, &start, &end);
+    }
+
+  gtk_text_buffer_end_tag_batch (buffer);
+
+  /* Changing the text flushes the batch */
+  gtk_text_buffer_get_start_iter (buffer, &start);
+  gtk_text_buffer_insert (buffer, &start, "zero ", -1);
+
+  gtk_text_buffer_get_iter_at_offset (buffer, &start, 5);
+  g_assert (gtk_text_iter_has_tag (&start, tag));
+  gtk_text_buffer_get_iter_at_offset (buffer, &start, 0);
+  g_assert (!gtk_text_iter_has_tag (&start, tag));
+
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  gtk_text_buffer_remove_tag (buffer, tag, &start, &end);
+
+  gtk_text_buffer_end_tag_batch (buffer);
+
+  gtk_text_buffer_get_iter_at_offset (buffer, &start, 5);
+  g_assert (!gtk_text_iter_has_tag (&start, tag));
+
+  g_object_unref (buffer);
+}
+
+static void
+test_serialize (void)
+{
+  GtkTextBuffer *buffer, *copy;
+  GtkTextTag *tag;
+  GtkTextIter start, end;
+  GdkAtom format;
+  GError *error = NULL;
+  guint8 *data;
+  gsize length;
+  gchar *text;
+  gint i;
+
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_create_tag (buffer, "bold", "weight", PANGO_WEIGHT_BOLD, NULL);
+  gtk_text_buffer_set_text (buffer, "one two\nthree four\nfive", -1);
+
+  gtk_text_buffer_get_iter_at_offset (buffer, &start, 4);
+  gtk_text_buffer_get_iter_at_offset (buffer, &end, 13);
+  gtk_text_buffer_apply_tag_by_name (buffer, "bold", &start, &end);
+
+  format = gtk_text_buffer_register_serialize_tagset (buffer, NULL);
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  data = gtk_text_buffer_serialize (buffer, buffer, format, &start, &end, &length);
+
+  copy = gtk_text_buffer_new (gtk_text_buffer_get_tag_table (buffer));
+  format = gtk_text_buffer_register_deserialize_tagset (copy, NULL);
+  gtk_text_buffer_get_start_iter (copy, &start);
+  g_assert (gtk_text_buffer_deserialize (copy, copy, format, &start, data, length, &error));
+  g_assert_no_error (error);
+  g_free (data);
+
+  gtk_text_buffer_get_bounds (copy, &start, &end);
+  text = gtk_text_iter_get_text (&start, &end);
+  g_assert_cmpstr (text, ==, "one two\nthree four\nfive");
+  g_free (text);
+
+  tag = gtk_text_tag_table_lookup (gtk_text_buffer_get_tag_table (copy), "bold");
+  for (i = 0; i < 24; i++)
+    {
+      gtk_text_buffer_get_iter_at_offset (copy, &start, i);
+      g_assert (gtk_text_iter_has_tag (&start, tag) == (i >= 4 && i < 13));
+    }
+
+  g_object_unref (copy);
+  g_object_unref (buffer);
+}
+
+static void
+check_undo_text (GtkTextBuffer *buffer,
+                 const gchar   *expected)
+{
+  GtkTextIter start, end;
+  gchar *text;
+
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  text = gtk_text_iter_get_slice (&start, &end);
+  g_assert_cmpstr (text, ==, expected);
+  g_free (text);
+}
+
+static void
+test_undo (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextIter iter, end;
+  const gchar *typed = "one two";
+  gint i;
+
+  buffer = gtk_text_buffer_new (NULL);
+  g_assert (!gtk_text_buffer_get_enable_undo (buffer));
+  gtk_text_buffer_set_text (buffer, "foo", -1);
+  gtk_text_buffer_set_enable_undo (buffer, TRUE);
+  g_assert (!gtk_text_buffer_get_can_undo (buffer));
+
+  /* Typing is undone a word at a time */
+  for (i = 0; typed[i]; i++)
+    {
+      gtk_text_buffer_get_end_iter (buffer, &iter);
+      gtk_text_buffer_insert_interactive (buffer, &iter, typed + i, 1, TRUE);
+    }
+  check_undo_text (buffer, "fooone two");
+
+  gtk_text_buffer_undo (buffer);
+  check_undo_text (buffer, "fooone");
+  gtk_text_buffer_undo (buffer);
+  check_undo_text (buffer, "foo");
+  g_assert (!gtk_text_buffer_get_can_undo (buffer));
+
+  gtk_text_buffer_redo (buffer);
+  check_undo_text (buffer, "fooone");
+  g_assert (gtk_text_buffer_get_can_redo (buffer));
+
+  /* A new change drops what could be redone */
+  gtk_text_buffer_get_start_iter (buffer, &iter);
+  gtk_text_buffer_insert (buffer, &iter, "x", -1);
+  g_assert (!gtk_text_buffer_get_can_redo (buffer));
+  gtk_text_buffer_undo (buffer);
+  check_undo_text (buffer, "fooone");
+
+  /* Backspacing is merged too */
+  for (i = 0; i < 3; i++)
+    {
+      gtk_text_buffer_get_end_iter (buffer, &iter);
+      gtk_text_buffer_backspace (buffer, &iter, TRUE, TRUE);
+    }
+  check_undo_text (buffer, "foo");
+  gtk_text_buffer_undo (buffer);
+  check_undo_text (buffer, "fooone");
+
+  /* A user action is undone as one */
+  gtk_text_buffer_begin_user_action (buffer);
+  gtk_text_buffer_get_start_iter (buffer, &iter);
+  gtk_text_buffer_get_iter_at_offset (buffer, &end, 3);
+  gtk_text_buffer_delete (buffer, &iter, &end);
+  gtk_text_buffer_insert (buffer, &iter, "bar ", -1);
+  gtk_text_buffer_end_user_action (buffer);
+  check_undo_text (buffer, "bar one");
+
+  gtk_text_buffer_undo (buffer);
+  check_undo_text (buffer, "fooone");
+  gtk_text_buffer_redo (buffer);
+  check_undo_text (buffer, "bar one");
+
+  /* Child anchors can't be undone */
+  gtk_text_buffer_get_start_iter (buffer, &iter);
+  gtk_text_buffer_create_child_anchor (buffer, &iter);
+  g_assert (!gtk_text_buffer_get_can_undo (buffer));
+  g_assert (!gtk_text_buffer_get_can_redo (buffer));
+
+  gtk_text_buffer_set_enable_undo (buffer, FALSE);
+  g_assert (!gtk_text_buffer_get_enable_undo (buffer));
+
+  g_object_unref (buffer);
+}
+
 static void
 test_fill_empty (void)
 {
@@ -1339,6 +1643,11 @@ main (int argc, char** argv)
   g_test_add_func ("/TextBuffer/Marks", test_marks);
   g_test_add_func ("/TextBuffer/Empty buffer", test_empty_buffer);
   g_test_add_func ("/TextBuffer/Get and Set", test_get_set);
+  g_test_add_func ("/TextBuffer/Load from stream", test_load_from_stream);
+  g_test_add_func ("/TextBuffer/Find all", test_find_all);
+  g_test_add_func ("/TextBuffer/Tag batch", test_tag_batch);
+  g_test_add_func ("/TextBuffer/Serialize", test_serialize);
+  g_test_add_func ("/TextBuffer/Undo", test_undo);
   g_test_add_func ("/TextBuffer/Fill and Empty", test_fill_empty);
   g_test_add_func ("/TextBuffer/Tag", test_tag);
   
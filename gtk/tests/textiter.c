@@ -257,6 +257,41 @@ test_search_caseless (void)
   check_found_backward ("This is some \303\200\n\303\200 text", "a\u0300\na\u0300", flags, 13, 16, "\303\200\n\303\200");
 }
 
+static void
+check_offsets (const gchar *str)
+{
+  GtkTextBuffer *buffer;
+  GtkTextIter iter;
+  const gchar *p;
+  gint offset;
+
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_text (buffer, str, -1);
+
+  for (p = str, offset = 0; *p; p = g_utf8_next_char (p), offset++)
+    {
+      gtk_text_buffer_get_iter_at_offset (buffer, &iter, offset);
+      g_assert_cmpint (gtk_text_iter_get_line_index (&iter), ==, p - str);
+      g_assert (gtk_text_iter_get_char (&iter) == g_utf8_get_char (p));
+
+      gtk_text_buffer_get_iter_at_line_index (buffer, &iter, 0, p - str);
+      g_assert_cmpint (gtk_text_iter_get_offset (&iter), ==, offset);
+
+      gtk_text_buffer_get_end_iter (buffer, &iter);
+      gtk_text_iter_backward_chars (&iter, g_utf8_strlen (p, -1));
+      g_assert_cmpint (gtk_text_iter_get_line_index (&iter), ==, p - str);
+    }
+
+  g_object_unref (buffer);
+}
+
+static void
+test_offsets (void)
+{
+  check_offsets ("All plain ASCII characters");
+  check_offsets ("Some \303\200 non-ASCII \342\202\254 ones");
+}
+
 int
 main (int argc, char** argv)
 {
@@ -266,6 +301,7 @@ main (int argc, char** argv)
   g_test_add_func ("/TextIter/Search Full Buffer", test_full_buffer);
   g_test_add_func ("/TextIter/Search", test_search);
   g_test_add_func ("/TextIter/Search Caseless", test_search_caseless);
+  g_test_add_func ("/TextIter/Offsets", test_offsets);
 
   return g_test_run();
 }
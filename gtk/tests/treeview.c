@@ -228,6 +228,58 @@ test_row_separator_height (void)
   gtk_widget_destroy (tree_view);
 }
 
+static void
+test_fixed_height_list (void)
+{
+  GtkListStore *store;
+  GtkWidget *window;
+  GtkWidget *tree_view;
+  GtkTreePath *path;
+  GdkRectangle first, rect;
+  gint i;
+
+  store = gtk_list_store_new (1, G_TYPE_STRING);
+  for (i = 0; i < 1000; i++)
+    gtk_list_store_insert_with_values (store, NULL, i, 0, "Row content", -1);
+
+  window = gtk_offscreen_window_new ();
+
+  tree_view = gtk_tree_view_new ();
+  gtk_tree_view_insert_column_with_attributes (GTK_TREE_VIEW (tree_view),
+                                               0,
+                                               "Test",
+                                               gtk_cell_renderer_text_new (),
+                                               "text", 0,
+                                               NULL);
+  gtk_tree_view_column_set_sizing (gtk_tree_view_get_column (GTK_TREE_VIEW (tree_view), 0),
+                                   GTK_TREE_VIEW_COLUMN_FIXED);
+  gtk_tree_view_set_fixed_height_mode (GTK_TREE_VIEW (tree_view), TRUE);
+  gtk_tree_view_set_model (GTK_TREE_VIEW (tree_view), GTK_TREE_MODEL (store));
+
+  gtk_container_add (GTK_CONTAINER (window), tree_view);
+  gtk_widget_show_all (window);
+
+  path = gtk_tree_path_new_first ();
+  gtk_tree_view_get_background_area (GTK_TREE_VIEW (tree_view),
+                                     path, NULL, &first);
+  gtk_tree_path_free (path);
+  g_assert_cmpint (first.height, >, 0);
+
+  for (i = 1; i < 1000; i += 111)
+    {
+      path = gtk_tree_path_new_from_indices (i, -1);
+      gtk_tree_view_get_background_area (GTK_TREE_VIEW (tree_view),
+                                         path, NULL, &rect);
+      gtk_tree_path_free (path);
+
+      g_assert_cmpint (rect.height, ==, first.height);
+      g_assert_cmpint (rect.y, ==, first.y + i * first.height);
+    }
+
+  gtk_widget_destroy (window);
+  g_object_unref (store);
+}
+
 int
 main (int    argc,
       char **argv)
@@ -240,6 +292,8 @@ main (int    argc,
                    test_select_collapsed_row);
   g_test_add_func ("/TreeView/sizing/row-separator-height",
                    test_row_separator_height);
+  g_test_add_func ("/TreeView/sizing/fixed-height-list",
+                   test_fixed_height_list);
 
   return g_test_run ();
 }
@@ -0,0 +1,628 @@
+/* updatecsscache.c
+ * Copyright (C) 2013 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Writes the cache files read by gtkcsscache.c, see there for the
+ * file format. We only need to understand enough CSS to find
+ * comments and top-level @import rules, everything else is copied
+ * verbatim and left to the real parser.
+ */
+
+#include "config.h"
+
+#include <locale.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <glib/gi18n.h>
+
+static gboolean force_update = FALSE;
+static gboolean quiet = FALSE;
+static gboolean validate = FALSE;
+
+#define CACHE_SUFFIX ".cache"
+
+#define MAJOR_VERSION 1
+#define MINOR_VERSION 0
+
+#define HEADER_SIZE 20
+#define FILE_SIZE 16
+#define CHUNK_SIZE 8
+
+#define GET_UINT16(cache, offset) (GUINT16_FROM_BE (*(guint16 *)((cache) + (offset))))
+#define GET_UINT32(cache, offset) (GUINT32_FROM_BE (*(guint32 *)((cache) + (offset))))
+
+typedef struct {
+  char *path;
+  guint64 mtime;
+  guint32 size;
+} SourceFile;
+
+typedef struct {
+  guint file;
+  GString *text;
+} Chunk;
+
+typedef struct {
+  GPtrArray *files;
+  GPtrArray *chunks;
+  GSList *stack;
+} Builder;
+
+static void
+source_file_free (SourceFile *file)
+{
+  g_free (file->path);
+  g_slice_free (SourceFile, file);
+}
+
+static void
+chunk_free (Chunk *chunk)
+{
+  g_string_free (chunk->text, TRUE);
+  g_slice_free (Chunk, chunk);
+}
+
+static char *
+make_absolute (const char *path)
+{
+  char *cwd, *result;
+
+  if (g_path_is_absolute (path))
+    return g_strdup (path);
+
+  cwd = g_get_current_dir ();
+  result = g_build_filename (cwd, path, NULL);
+  g_free (cwd);
+
+  return result;
+}
+
+static const char *
+skip_comment (const char *p,
+              GString    *text)
+{
+  /* Keep the newlines so line numbers in error messages stay right */
+  for (p += 2; *p; p++)
+    {
+      if (p[0] == '*' && p[1] == '/')
+        return p + 2;
+      if (*p == '\n' && text)
+        g_string_append_c (text, '\n');
+    }
+
+  return p;
+}
+
+static const char *
+skip_string (const char *p)
+{
+  char quote = *p;
+
+  for (p++; *p && *p != quote && *p != '\n'; p++)
+    {
+      if (*p == '\\' && p[1] != '\0')
+        p++;
+    }
+
+  return *p == quote ? p + 1 : p;
+}
+
+static const char *
+skip_whitespace (const char *p)
+{
+  for (;;)
+    {
+      if (g_ascii_isspace (*p))
+        p++;
+      else if (p[0] == '/' && p[1] == '*')
+        p = skip_comment (p, NULL);
+      else
+        return p;
+    }
+}
+
+/* Copies one statement, up to the ';' or the '}' that closes it */
+static const char *
+copy_statement (const char *p,
+                GString    *text)
+{
+  int depth = 0;
+
+  while (*p)
+    {
+      if (p[0] == '/' && p[1] == '*')
+        {
+          p = skip_comment (p, text);
+          g_string_append_c (text, ' ');
+          continue;
+        }
+
+      if (*p == '"' || *p == '\'')
+        {
+          const char *end = skip_string (p);
+
+          g_string_append_len (text, p, end - p);
+          p = end;
+          continue;
+        }
+
+      g_string_append_c (text, *p);
+
+      if (*p == '{')
+        depth++;
+      else if (*p == '}' && --depth <= 0)
+        return p + 1;
+      else if (*p == ';' && depth == 0)
+        return p + 1;
+
+      p++;
+    }
+
+  return p;
+}
+
+/* Parses the target of an @import rule at @p, which points
+ * right after the keyword. Returns %NULL if this doesn't look
+ * like an @import we can follow.
+ */
+static char *
+parse_import (const char  *p,
+              const char  *dir,
+              const char **end)
+{
+  const char *start;
+  char *target, *scheme, *path;
+  gboolean url;
+
+  p = skip_whitespace (p);
+
+  url = g_ascii_strncasecmp (p, "url(", 4) == 0;
+  if (url)
+    p = skip_whitespace (p + 4);
+
+  if (*p == '"' || *p == '\'')
+    {
+      start = p + 1;
+      p = skip_string (p);
+      if (p == start || p[-1] != *(start - 1))
+        return NULL;
+      target = g_strndup (start, p - start - 1);
+    }
+  else
+    return NULL;
+
+  if (url)
+    {
+      p = skip_whitespace (p);
+      if (*p != ')')
+        {
+          g_free (target);
+          return NULL;
+        }
+      p++;
+    }
+
+  p = skip_whitespace (p);
+  if (*p != ';' || strchr (target, '\\'))
+    {
+      g_free (target);
+      return NULL;
+    }
+
+  *end = p + 1;
+
+  scheme = g_uri_parse_scheme (target);
+  if (scheme == NULL)
+    path = g_path_is_absolute (target) ? g_strdup (target) : g_build_filename (dir, target, NULL);
+  else if (g_ascii_strcasecmp (scheme, "file") == 0)
+    path = g_filename_from_uri (target, NULL, NULL);
+  else
+    path = NULL;
+
+  g_free (scheme);
+  g_free (target);
+
+  return path;
+}
+
+static guint
+builder_add_file (Builder     *builder,
+                  const char  *path,
+                  GStatBuf    *st)
+{
+  SourceFile *file;
+  guint i;
+
+  for (i = 0; i < builder->files->len; i++)
+    {
+      file = g_ptr_array_index (builder->files, i);
+      if (strcmp (file->path, path) == 0)
+        return i;
+    }
+
+  file = g_slice_new (SourceFile);
+  file->path = g_strdup (path);
+  file->mtime = st->st_mtime;
+  file->size = st->st_size;
+  g_ptr_array_add (builder->files, file);
+
+  return builder->files->len - 1;
+}
+
+static gboolean
+builder_add_source (Builder     *builder,
+                    const char  *path)
+{
+  GStatBuf st;
+  char *contents, *dir;
+  const char *p;
+  Chunk *chunk = NULL;
+  guint index, line, chunk_lines;
+  GError *error = NULL;
+
+  if (g_slist_find_custom (builder->stack, path, (GCompareFunc) strcmp))
+    {
+      g_printerr (_("Loading '%s' would recurse\n"), path);
+      return FALSE;
+    }
+
+  if (g_stat (path, &st) < 0 ||
+      !g_file_get_contents (path, &contents, NULL, &error))
+    {
+      g_printerr (_("Failed to read %s: %s\n"), path,
+                  error ? error->message : g_strerror (errno));
+      g_clear_error (&error);
+      return FALSE;
+    }
+
+  index = builder_add_file (builder, path, &st);
+  dir = g_path_get_dirname (path);
+  builder->stack = g_slist_prepend (builder->stack, (char *) path);
+
+  line = 0;
+  chunk_lines = 0;
+  p = contents;
+  while (*p)
+    {
+      const char *start, *end;
+      char *import;
+
+      start = p;
+      p = skip_whitespace (p);
+      for (; start < p; start++)
+        {
+          if (*start == '\n')
+            line++;
+        }
+
+      if (*p == '\0')
+        break;
+
+      if (g_ascii_strncasecmp (p, "@import", 7) == 0 &&
+          (import = parse_import (p + 7, dir, &end)) != NULL)
+        {
+          gboolean success;
+
+          success = builder_add_source (builder, import);
+          g_free (import);
+          if (!success)
+            goto fail;
+
+          for (; p < end; p++)
+            {
+              if (*p == '\n')
+                line++;
+            }
+          chunk = NULL;
+          continue;
+        }
+
+      if (chunk == NULL)
+        {
+          chunk = g_slice_new (Chunk);
+          chunk->file = index;
+          chunk->text = g_string_new (NULL);
+          g_ptr_array_add (builder->chunks, chunk);
+          chunk_lines = 0;
+        }
+
+      /* pad so the parser counts lines like in the source file */
+      for (; chunk_lines < line; chunk_lines++)
+        g_string_append_c (chunk->text, '\n');
+      if (chunk->text->len > 0)
+        g_string_append_c (chunk->text, ' ');
+
+      start = p;
+      p = copy_statement (p, chunk->text);
+      for (; start < p; start++)
+        {
+          if (*start == '\n')
+            line++;
+        }
+      chunk_lines = line;
+    }
+
+  builder->stack = g_slist_remove (builder->stack, path);
+  g_free (dir);
+  g_free (contents);
+  return TRUE;
+
+fail:
+  builder->stack = g_slist_remove (builder->stack, path);
+  g_free (dir);
+  g_free (contents);
+  return FALSE;
+}
+
+static void
+append_uint16 (GString *data, guint16 value)
+{
+  value = GUINT16_TO_BE (value);
+  g_string_append_len (data, (const char *) &value, 2);
+}
+
+static void
+append_uint32 (GString *data, guint32 value)
+{
+  value = GUINT32_TO_BE (value);
+  g_string_append_len (data, (const char *) &value, 4);
+}
+
+static void
+set_uint32 (GString *data, guint offset, guint32 value)
+{
+  value = GUINT32_TO_BE (value);
+  memcpy (data->str + offset, &value, 4);
+}
+
+static guint32
+append_string (GString *data, const char *str, gsize len)
+{
+  guint32 offset = data->len;
+
+  g_string_append_len (data, str, len);
+  g_string_append_c (data, '\0');
+  while (data->len % 4)
+    g_string_append_c (data, '\0');
+
+  return offset;
+}
+
+static GString *
+builder_write (Builder *builder)
+{
+  GString *data;
+  guint32 file_list_offset, chunk_list_offset;
+  guint i;
+
+  data = g_string_new (NULL);
+
+  file_list_offset = HEADER_SIZE;
+  chunk_list_offset = file_list_offset + builder->files->len * FILE_SIZE;
+
+  append_uint16 (data, MAJOR_VERSION);
+  append_uint16 (data, MINOR_VERSION);
+  append_uint32 (data, builder->files->len);
+  append_uint32 (data, file_list_offset);
+  append_uint32 (data, builder->chunks->len);
+  append_uint32 (data, chunk_list_offset);
+
+  for (i = 0; i < builder->files->len; i++)
+    {
+      SourceFile *file = g_ptr_array_index (builder->files, i);
+
+      append_uint32 (data, 0);
+      append_uint32 (data, file->mtime >> 32);
+      append_uint32 (data, file->mtime & 0xffffffff);
+      append_uint32 (data, file->size);
+    }
+
+  for (i = 0; i < builder->chunks->len; i++)
+    {
+      Chunk *chunk = g_ptr_array_index (builder->chunks, i);
+
+      append_uint32 (data, chunk->file);
+      append_uint32 (data, 0);
+    }
+
+  for (i = 0; i < builder->files->len; i++)
+    {
+      SourceFile *file = g_ptr_array_index (builder->files, i);
+
+      set_uint32 (data, file_list_offset + i * FILE_SIZE,
+                  append_string (data, file->path, strlen (file->path)));
+    }
+
+  for (i = 0; i < builder->chunks->len; i++)
+    {
+      Chunk *chunk = g_ptr_array_index (builder->chunks, i);
+
+      set_uint32 (data, chunk_list_offset + i * CHUNK_SIZE + 4,
+                  append_string (data, chunk->text->str, chunk->text->len));
+    }
+
+  return data;
+}
+
+/* Returns %TRUE if @cache_path is a well-formed cache for @path
+ * and none of the files it was built from changed since. This
+ * mirrors what GTK+ checks before using the cache.
+ */
+static gboolean
+is_cache_valid (const char *path,
+                const char *cache_path)
+{
+  GMappedFile *map;
+  const char *cache;
+  gsize size;
+  guint32 n_files, file_list_offset, n_chunks, chunk_list_offset, i;
+  gboolean valid = FALSE;
+
+  map = g_mapped_file_new (cache_path, FALSE, NULL);
+  if (map == NULL)
+    return FALSE;
+
+  cache = g_mapped_file_get_contents (map);
+  size = g_mapped_file_get_length (map);
+
+  if (size < HEADER_SIZE || GET_UINT16 (cache, 0) != MAJOR_VERSION)
+    goto out;
+
+  n_files = GET_UINT32 (cache, 4);
+  file_list_offset = GET_UINT32 (cache, 8);
+  n_chunks = GET_UINT32 (cache, 12);
+  chunk_list_offset = GET_UINT32 (cache, 16);
+
+  if (n_files == 0 || file_list_offset % 4 || chunk_list_offset % 4 ||
+      (guint64) file_list_offset + (guint64) n_files * FILE_SIZE > size ||
+      (guint64) chunk_list_offset + (guint64) n_chunks * CHUNK_SIZE > size)
+    goto out;
+
+  for (i = 0; i < n_files; i++)
+    {
+      guint32 offset = file_list_offset + i * FILE_SIZE;
+      guint32 path_offset = GET_UINT32 (cache, offset);
+      guint64 mtime;
+      GStatBuf st;
+
+      if (path_offset >= size ||
+          memchr (cache + path_offset, '\0', size - path_offset) == NULL)
+        goto out;
+
+      if (i == 0 && strcmp (cache + path_offset, path) != 0)
+        goto out;
+
+      mtime = ((guint64) GET_UINT32 (cache, offset + 4) << 32) | GET_UINT32 (cache, offset + 8);
+      if (g_stat (cache + path_offset, &st) < 0 ||
+          (guint64) st.st_mtime != mtime ||
+          (guint64) st.st_size != GET_UINT32 (cache, offset + 12))
+        goto out;
+    }
+
+  for (i = 0; i < n_chunks; i++)
+    {
+      guint32 offset = chunk_list_offset + i * CHUNK_SIZE;
+      guint32 text_offset = GET_UINT32 (cache, offset + 4);
+
+      if (GET_UINT32 (cache, offset) >= n_files ||
+          text_offset >= size ||
+          memchr (cache + text_offset, '\0', size - text_offset) == NULL)
+        goto out;
+    }
+
+  valid = TRUE;
+
+out:
+  g_mapped_file_unref (map);
+
+  return valid;
+}
+
+static gboolean
+build_cache (const char *path,
+             const char *cache_path)
+{
+  Builder builder;
+  GString *data;
+  GError *error = NULL;
+  gboolean success;
+
+  builder.files = g_ptr_array_new_with_free_func ((GDestroyNotify) source_file_free);
+  builder.chunks = g_ptr_array_new_with_free_func ((GDestroyNotify) chunk_free);
+  builder.stack = NULL;
+
+  success = builder_add_source (&builder, path);
+
+  if (success)
+    {
+      data = builder_write (&builder);
+
+      success = g_file_set_contents (cache_path, data->str, data->len, &error);
+      if (!success)
+        {
+          g_printerr (_("Failed to write cache file: %s\n"), error->message);
+          g_error_free (error);
+        }
+
+      g_string_free (data, TRUE);
+    }
+
+  g_ptr_array_unref (builder.files);
+  g_ptr_array_unref (builder.chunks);
+
+  if (success && !quiet)
+    g_printerr (_("Cache file created successfully.\n"));
+
+  return success;
+}
+
+static GOptionEntry args[] = {
+  { "force", 'f', 0, G_OPTION_ARG_NONE, &force_update, N_("Overwrite an existing cache, even if up to date"), NULL },
+  { "quiet", 'q', 0, G_OPTION_ARG_NONE, &quiet, N_("Turn off verbose output"), NULL },
+  { "validate", 'v', 0, G_OPTION_ARG_NONE, &validate, N_("Validate existing CSS cache"), NULL },
+  { NULL }
+};
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  char *path, *cache_path;
+  int status;
+
+  setlocale (LC_ALL, "");
+
+#ifdef ENABLE_NLS
+  bindtextdomain (GETTEXT_PACKAGE, GTK_LOCALEDIR);
+#ifdef HAVE_BIND_TEXTDOMAIN_CODESET
+  bind_textdomain_codeset (GETTEXT_PACKAGE, "UTF-8");
+#endif
+#endif
+
+  context = g_option_context_new ("CSSFILE");
+  g_option_context_add_main_entries (context, args, GETTEXT_PACKAGE);
+
+  if (!g_option_context_parse (context, &argc, &argv, NULL) || argc < 2)
+    {
+      g_printerr (_("No CSS file given.\n"));
+      return 1;
+    }
+
+  path = make_absolute (argv[1]);
+  cache_path = g_strconcat (path, CACHE_SUFFIX, NULL);
+
+  if (validate)
+    {
+      status = is_cache_valid (path, cache_path) ? 0 : 1;
+      if (status != 0 && !quiet)
+        g_printerr (_("Not a valid CSS cache: %s\n"), cache_path);
+    }
+  else if (!force_update && is_cache_valid (path, cache_path))
+    status = 0;
+  else
+    status = build_cache (path, cache_path) ? 0 : 1;
+
+  g_free (cache_path);
+  g_free (path);
+  g_option_context_free (context);
+
+  return status;
+}
@@ -170,6 +170,7 @@ typedef struct
   gboolean has_pixdata;
   guint32 offset;
   guint size;
+  gchar *load_path;
 } ImageData;
 
 typedef struct 
@@ -189,6 +190,7 @@ typedef struct
 
 static GHashTable *image_data_hash = NULL;
 static GHashTable *icon_data_hash = NULL;
+static GPtrArray *pending_image_data = NULL;
 
 typedef struct
 {
@@ -474,7 +476,6 @@ maybe_cache_image_data (Image       *image,
   if (!index_only && !image->image_data && 
       (g_str_has_suffix (path, ".png") || g_str_has_suffix (path, ".xpm")))
     {
-      GdkPixbuf *pixbuf;
       ImageData *idata;
       gchar *path2;
 
@@ -511,16 +512,13 @@ maybe_cache_image_data (Image       *image,
 	    g_hash_table_insert (image_data_hash, g_strdup (path2), idata);  
 	}
 
-      if (!idata->has_pixdata)
+      /* Decoding is the slow part, it is done for all images
+       * at once after scanning, see load_pending_image_data()
+       */
+      if (!idata->has_pixdata && !idata->load_path)
 	{
-	  pixbuf = gdk_pixbuf_new_from_file (path, NULL);
-	  
-	  if (pixbuf) 
-	    {
-	      gdk_pixdata_from_pixbuf (&idata->pixdata, pixbuf, FALSE);
-	      idata->size = idata->pixdata.length + 8;
-	      idata->has_pixdata = TRUE;
-	    }
+	  idata->load_path = g_strdup (path);
+	  g_ptr_array_add (pending_image_data, idata);
 	}
 
       image->image_data = idata;
@@ -529,6 +527,54 @@ maybe_cache_image_data (Image       *image,
     }
 }
 
+static void
+load_image_data (gpointer data,
+                 gpointer user_data)
+{
+  ImageData *idata = data;
+  GdkPixbuf *pixbuf;
+
+  pixbuf = gdk_pixbuf_new_from_file (idata->load_path, NULL);
+
+  if (pixbuf)
+    {
+      gdk_pixdata_from_pixbuf (&idata->pixdata, pixbuf, FALSE);
+      idata->size = idata->pixdata.length + 8;
+      idata->has_pixdata = TRUE;
+    }
+
+  g_clear_pointer (&idata->load_path, g_free);
+}
+
+/* Every image only touches its own ImageData, so they
+ * can be decoded on all processors in parallel
+ */
+static void
+load_pending_image_data (void)
+{
+  GThreadPool *pool = NULL;
+  gint n_threads;
+  guint i;
+
+  n_threads = MIN (g_get_num_processors (), pending_image_data->len);
+
+  if (n_threads > 1)
+    pool = g_thread_pool_new (load_image_data, NULL, n_threads, TRUE, NULL);
+
+  for (i = 0; i < pending_image_data->len; i++)
+    {
+      if (pool)
+        g_thread_pool_push (pool, g_ptr_array_index (pending_image_data, i), NULL);
+      else
+        load_image_data (g_ptr_array_index (pending_image_data, i), NULL);
+    }
+
+  if (pool)
+    g_thread_pool_free (pool, FALSE, TRUE);
+
+  g_ptr_array_set_size (pending_image_data, 0);
+}
+
 static void
 maybe_cache_icon_data (Image       *image,
                        const gchar *path)
@@ -1516,8 +1562,10 @@ opentmp:
   image_data_hash = g_hash_table_new (g_str_hash, g_str_equal);
   icon_data_hash = g_hash_table_new (g_str_hash, g_str_equal);
   string_pool = g_hash_table_new (g_str_hash, g_str_equal);
+  pending_image_data = g_ptr_array_new ();
  
   directories = scan_directory (path, NULL, files, NULL, 0);
+  load_pending_image_data ();
 
   if (g_hash_table_size (files) == 0)
     {
@@ -345,6 +345,20 @@ gtk_cups_request_ipp_add_string (GtkCupsRequest *request,
                 value);
 }
 
+void
+gtk_cups_request_ipp_add_integer (GtkCupsRequest *request,
+                                  ipp_tag_t       group,
+                                  ipp_tag_t       tag,
+                                  const char     *name,
+                                  int             value)
+{
+  ippAddInteger (request->ipp_request,
+                 group,
+                 tag,
+                 name,
+                 value);
+}
+
 void            
 gtk_cups_request_ipp_add_strings (GtkCupsRequest    *request,
 				  ipp_tag_t          group,
@@ -159,6 +159,11 @@ void                    gtk_cups_request_ipp_add_string    (GtkCupsRequest     *
 							    const char         *name,
 							    const char         *charset,
 							    const char         *value);
+void                    gtk_cups_request_ipp_add_integer   (GtkCupsRequest     *request,
+							    ipp_tag_t           group,
+							    ipp_tag_t           tag,
+							    const char         *name,
+							    int                 value);
 void                    gtk_cups_request_ipp_add_strings   (GtkCupsRequest     *request,
 							    ipp_tag_t           group,
 							    ipp_tag_t           tag,
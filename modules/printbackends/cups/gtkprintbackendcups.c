@@ -82,6 +82,17 @@ typedef struct _GtkPrintBackendCupsClass GtkPrintBackendCupsClass;
 #define AVAHI_SERVER_IFACE "org.freedesktop.Avahi.Server"
 #define AVAHI_SERVICE_BROWSER_IFACE "org.freedesktop.Avahi.ServiceBrowser"
 #define AVAHI_SERVICE_RESOLVER_IFACE "org.freedesktop.Avahi.ServiceResolver"
+
+#define CUPSD_NOTIFIER_IFACE "org.cups.cupsd.Notifier"
+#define CUPSD_NOTIFIER_PATH "/org/cups/cupsd/Notifier"
+
+/* lease of the subscription to printer events, in seconds */
+#define SUBSCRIPTION_DURATION 3600
+
+/* while subscribed to printer events, the printer list is polled
+ * only in case a notification got lost
+ */
+#define SUBSCRIBED_POLL_INTERVAL 30000
 #endif
 
 /* define this to see warnings about ignored ppd options */
@@ -156,6 +167,10 @@ struct _GtkPrintBackendCups
   guint            avahi_service_browser_subscription_ids[2];
   gchar           *avahi_service_browser_paths[2];
   GCancellable    *avahi_cancellable;
+
+  gint             cups_subscription_id;
+  guint            cups_subscription_renewal;
+  guint            cupsd_notifier_subscription_id;
 #endif
 };
 
@@ -225,6 +240,15 @@ static gboolean             request_auth_info                       (gpointer
 
 #ifdef HAVE_CUPS_API_1_6
 static void                 avahi_request_printer_list              (GtkPrintBackendCups              *cups_backend);
+static void                 cups_create_subscription                (GtkPrintBackendCups              *cups_backend);
+static void                 cups_cancel_subscription                (GtkPrintBackendCups              *cups_backend);
+static void                 cupsd_notifier_signal_handler           (GDBusConnection                  *connection,
+                                                                     const gchar                      *sender_name,
+                                                                     const gchar                      *object_path,
+                                                                     const gchar                      *interface_name,
+                                                                     const gchar                      *signal_name,
+                                                                     GVariant                         *parameters,
+                                                                     gpointer                          user_data);
 #endif
 
 static void
@@ -609,13 +633,17 @@ add_cups_options (const gchar *key,
     gtk_cups_request_encode_option (request, key, value);
 }
 
+/* Sends the job; @http is the connection to the printer if it was
+ * found with Avahi, and %NULL for the printers of the CUPS server
+ */
 static void
-gtk_print_backend_cups_print_stream (GtkPrintBackend         *print_backend,
-                                     GtkPrintJob             *job,
-				     GIOChannel              *data_io,
-				     GtkPrintJobCompleteFunc  callback,
-				     gpointer                 user_data,
-				     GDestroyNotify           dnotify)
+cups_print_stream_request (GtkPrintBackend         *print_backend,
+                           GtkPrintJob             *job,
+                           GIOChannel              *data_io,
+                           GtkPrintJobCompleteFunc  callback,
+                           gpointer                 user_data,
+                           GDestroyNotify           dnotify,
+                           http_t                  *http)
 {
   GtkPrinterCups *cups_printer;
   CupsPrintStreamData *ps;
@@ -624,57 +652,22 @@ gtk_print_backend_cups_print_stream (GtkPrintBackend         *print_backend,
   GtkPrintSettings *settings;
   const gchar *title;
   char  printer_absolute_uri[HTTP_MAX_URI];
-  http_t *http = NULL;
-
-  GTK_NOTE (PRINTING,
-            g_print ("CUPS Backend: %s\n", G_STRFUNC));
 
   cups_printer = GTK_PRINTER_CUPS (gtk_print_job_get_printer (job));
   settings = gtk_print_job_get_settings (job);
 
-#ifdef HAVE_CUPS_API_1_6
-  if (cups_printer->avahi_browsed)
+  if (http)
     {
-      http = httpConnect (cups_printer->hostname, cups_printer->port);
-      if (http)
-        {
-          request = gtk_cups_request_new_with_username (http,
-                                                        GTK_CUPS_POST,
-                                                        IPP_PRINT_JOB,
-                                                        data_io,
-                                                        cups_printer->hostname,
-                                                        cups_printer->device_uri,
-                                                        GTK_PRINT_BACKEND_CUPS (print_backend)->username);
-          g_snprintf (printer_absolute_uri, HTTP_MAX_URI, "%s", cups_printer->printer_uri);
-        }
-      else
-        {
-          GError *error = NULL;
-
-          GTK_NOTE (PRINTING,
-                    g_warning ("CUPS Backend: Error connecting to %s:%d",
-                               cups_printer->hostname,
-                               cups_printer->port));
-
-          error = g_error_new (gtk_print_error_quark (),
-                               GTK_CUPS_ERROR_GENERAL,
-                               "Error connecting to %s",
-                               cups_printer->hostname);
-
-          gtk_print_job_set_status (job, GTK_PRINT_STATUS_FINISHED_ABORTED);
-
-          if (callback)
-            {
-              callback (job, user_data, error);
-            }
-
-          g_clear_error (&error);
-
-          return;
-        }
+      request = gtk_cups_request_new_with_username (http,
+                                                    GTK_CUPS_POST,
+                                                    IPP_PRINT_JOB,
+                                                    data_io,
+                                                    cups_printer->hostname,
+                                                    cups_printer->device_uri,
+                                                    GTK_PRINT_BACKEND_CUPS (print_backend)->username);
+      g_snprintf (printer_absolute_uri, HTTP_MAX_URI, "%s", cups_printer->printer_uri);
     }
   else
-#endif
     {
       request = gtk_cups_request_new_with_username (NULL,
                                                     GTK_CUPS_POST,
@@ -732,6 +725,178 @@ gtk_print_backend_cups_print_stream (GtkPrintBackend         *print_backend,
                         (GDestroyNotify)cups_free_print_stream_data);
 }
 
+#ifdef HAVE_CUPS_API_1_6
+typedef struct
+{
+  gchar *host;
+  gint   port;
+} CupsConnectData;
+
+static void
+cups_connect_data_free (CupsConnectData *data)
+{
+  g_free (data->host);
+  g_free (data);
+}
+
+static void
+cups_http_connect_thread (GTask        *task,
+                          gpointer      source_object,
+                          gpointer      task_data,
+                          GCancellable *cancellable)
+{
+  CupsConnectData *data = task_data;
+  http_t *http;
+
+  http = httpConnect (data->host, data->port);
+  if (http)
+    g_task_return_pointer (task, http, (GDestroyNotify) httpClose);
+  else
+    g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED,
+                             "Error connecting to %s:%d",
+                             data->host, data->port);
+}
+
+/* httpConnect() looks up the host and connects synchronously, which
+ * can take a long time for unreachable servers, so it is done in a
+ * thread
+ */
+static void
+cups_http_connect_async (const gchar         *host,
+                         gint                 port,
+                         GAsyncReadyCallback  callback,
+                         gpointer             user_data)
+{
+  CupsConnectData *data;
+  GTask *task;
+
+  data = g_new0 (CupsConnectData, 1);
+  data->host = g_strdup (host);
+  data->port = port;
+
+  task = g_task_new (NULL, NULL, callback, user_data);
+  g_task_set_task_data (task, data, (GDestroyNotify) cups_connect_data_free);
+  g_task_run_in_thread (task, cups_http_connect_thread);
+  g_object_unref (task);
+}
+
+static http_t *
+cups_http_connect_finish (GAsyncResult  *result,
+                          GError       **error)
+{
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+typedef struct {
+  GtkPrintBackend *print_backend;
+  GtkPrintJob *job;
+  GIOChannel *data_io;
+  GtkPrintJobCompleteFunc callback;
+  gpointer user_data;
+  GDestroyNotify dnotify;
+} CupsPrintStreamConnectData;
+
+static void
+cups_print_stream_connected (GObject      *source_object,
+                             GAsyncResult *result,
+                             gpointer      user_data)
+{
+  CupsPrintStreamConnectData *data = user_data;
+  GError *error = NULL;
+  http_t *http;
+
+  gdk_threads_enter ();
+
+  http = cups_http_connect_finish (result, &error);
+  if (http)
+    {
+      cups_print_stream_request (data->print_backend,
+                                 data->job,
+                                 data->data_io,
+                                 data->callback,
+                                 data->user_data,
+                                 data->dnotify,
+                                 http);
+    }
+  else
+    {
+      GtkPrinterCups *cups_printer;
+
+      cups_printer = GTK_PRINTER_CUPS (gtk_print_job_get_printer (data->job));
+
+      GTK_NOTE (PRINTING,
+                g_warning ("CUPS Backend: Error connecting to %s:%d",
+                           cups_printer->hostname,
+                           cups_printer->port));
+
+      g_clear_error (&error);
+      error = g_error_new (gtk_print_error_quark (),
+                           GTK_CUPS_ERROR_GENERAL,
+                           "Error connecting to %s",
+                           cups_printer->hostname);
+
+      gtk_print_job_set_status (data->job, GTK_PRINT_STATUS_FINISHED_ABORTED);
+
+      if (data->callback)
+        {
+          data->callback (data->job, data->user_data, error);
+        }
+
+      g_clear_error (&error);
+    }
+
+  g_object_unref (data->print_backend);
+  g_object_unref (data->job);
+  g_io_channel_unref (data->data_io);
+  g_free (data);
+
+  gdk_threads_leave ();
+}
+#endif
+
+static void
+gtk_print_backend_cups_print_stream (GtkPrintBackend         *print_backend,
+                                     GtkPrintJob             *job,
+				     GIOChannel              *data_io,
+				     GtkPrintJobCompleteFunc  callback,
+				     gpointer                 user_data,
+				     GDestroyNotify           dnotify)
+{
+#ifdef HAVE_CUPS_API_1_6
+  GtkPrinterCups *cups_printer;
+#endif
+
+  GTK_NOTE (PRINTING,
+            g_print ("CUPS Backend: %s\n", G_STRFUNC));
+
+#ifdef HAVE_CUPS_API_1_6
+  cups_printer = GTK_PRINTER_CUPS (gtk_print_job_get_printer (job));
+
+  if (cups_printer->avahi_browsed)
+    {
+      CupsPrintStreamConnectData *data;
+
+      data = g_new0 (CupsPrintStreamConnectData, 1);
+      data->print_backend = g_object_ref (print_backend);
+      data->job = g_object_ref (job);
+      data->data_io = g_io_channel_ref (data_io);
+      data->callback = callback;
+      data->user_data = user_data;
+      data->dnotify = dnotify;
+
+      cups_http_connect_async (cups_printer->hostname,
+                               cups_printer->port,
+                               cups_print_stream_connected,
+                               data);
+      return;
+    }
+#endif
+
+  cups_print_stream_request (print_backend, job, data_io,
+                             callback, user_data, dnotify,
+                             NULL);
+}
+
 void overwrite_and_free (gpointer data)
 {
   gchar *password = (gchar *) data;
@@ -781,6 +946,10 @@ gtk_print_backend_cups_init (GtkPrintBackendCups *backend_cups)
       backend_cups->avahi_service_browser_paths[i] = NULL;
       backend_cups->avahi_service_browser_subscription_ids[i] = 0;
     }
+
+  backend_cups->cups_subscription_id = 0;
+  backend_cups->cups_subscription_renewal = 0;
+  backend_cups->cupsd_notifier_subscription_id = 0;
 #endif
 
   cups_get_local_default_printer (backend_cups);
@@ -847,6 +1016,21 @@ gtk_print_backend_cups_dispose (GObject *object)
 #ifdef HAVE_CUPS_API_1_6
   g_cancellable_cancel (backend_cups->avahi_cancellable);
 
+  if (backend_cups->cups_subscription_renewal > 0)
+    {
+      g_source_remove (backend_cups->cups_subscription_renewal);
+      backend_cups->cups_subscription_renewal = 0;
+    }
+
+  if (backend_cups->cupsd_notifier_subscription_id > 0)
+    {
+      g_dbus_connection_signal_unsubscribe (backend_cups->dbus_connection,
+                                            backend_cups->cupsd_notifier_subscription_id);
+      backend_cups->cupsd_notifier_subscription_id = 0;
+    }
+
+  cups_cancel_subscription (backend_cups);
+
   for (i = 0; i < 2; i++)
     {
       if (backend_cups->avahi_service_browser_subscription_ids[i] > 0)
@@ -2471,16 +2655,23 @@ done:
   gdk_threads_leave ();
 }
 
+typedef struct
+{
+  gchar               *printer_uri;
+  GtkPrintBackendCups *backend;
+} AvahiPrinterInfoData;
+
 static void
-cups_request_avahi_printer_info (const gchar         *printer_uri,
-                                 const gchar         *host,
-                                 gint                 port,
-                                 GtkPrintBackendCups *backend)
+cups_request_avahi_printer_info_connected (GObject      *source_object,
+                                           GAsyncResult *result,
+                                           gpointer      user_data)
 {
-  GtkCupsRequest *request;
-  http_t         *http;
+  AvahiPrinterInfoData *data = user_data;
+  GtkPrintBackendCups  *backend = data->backend;
+  GtkCupsRequest       *request;
+  http_t               *http;
 
-  http = httpConnect (host, port);
+  http = cups_http_connect_finish (result, NULL);
   if (http)
     {
       request = gtk_cups_request_new_with_username (http,
@@ -2494,7 +2685,7 @@ cups_request_avahi_printer_info (const gchar         *printer_uri,
       gtk_cups_request_set_ipp_version (request, 1, 1);
 
       gtk_cups_request_ipp_add_string (request, IPP_TAG_OPERATION, IPP_TAG_URI,
-                                       "printer-uri", NULL, printer_uri);
+                                       "printer-uri", NULL, data->printer_uri);
 
       gtk_cups_request_ipp_add_strings (request, IPP_TAG_OPERATION, IPP_TAG_KEYWORD,
                                         "requested-attributes", G_N_ELEMENTS (printer_attrs),
@@ -2506,6 +2697,27 @@ cups_request_avahi_printer_info (const gchar         *printer_uri,
                             http,
                             (GDestroyNotify) httpClose);
     }
+
+  g_free (data->printer_uri);
+  g_object_unref (data->backend);
+  g_free (data);
+}
+
+static void
+cups_request_avahi_printer_info (const gchar         *printer_uri,
+                                 const gchar         *host,
+                                 gint                 port,
+                                 GtkPrintBackendCups *backend)
+{
+  AvahiPrinterInfoData *data;
+
+  data = g_new0 (AvahiPrinterInfoData, 1);
+  data->printer_uri = g_strdup (printer_uri);
+  data->backend = g_object_ref (backend);
+
+  cups_http_connect_async (host, port,
+                           cups_request_avahi_printer_info_connected,
+                           data);
 }
 
 typedef struct
@@ -3004,6 +3216,24 @@ avahi_create_browsers (GObject      *source_object,
   cups_backend = GTK_PRINT_BACKEND_CUPS (user_data);
   cups_backend->dbus_connection = dbus_connection;
 
+  /*
+   * cupsd tells about changes to its printers on the system bus,
+   * once we have subscribed to them.
+   */
+  cups_backend->cupsd_notifier_subscription_id =
+    g_dbus_connection_signal_subscribe  (cups_backend->dbus_connection,
+                                         NULL,
+                                         CUPSD_NOTIFIER_IFACE,
+                                         NULL,
+                                         CUPSD_NOTIFIER_PATH,
+                                         NULL,
+                                         G_DBUS_SIGNAL_FLAGS_NONE,
+                                         cupsd_notifier_signal_handler,
+                                         cups_backend,
+                                         NULL);
+
+  cups_create_subscription (cups_backend);
+
   /*
    * We need to subscribe to signals of service browser before
    * we actually create it because it starts to emit them right
@@ -3376,6 +3606,201 @@ cups_request_printer_list (GtkPrintBackendCups *cups_backend)
   return TRUE;
 }
 
+#ifdef HAVE_CUPS_API_1_6
+static void
+cupsd_notifier_signal_handler (GDBusConnection *connection,
+                               const gchar     *sender_name,
+                               const gchar     *object_path,
+                               const gchar     *interface_name,
+                               const gchar     *signal_name,
+                               GVariant        *parameters,
+                               gpointer         user_data)
+{
+  GtkPrintBackendCups *cups_backend = GTK_PRINT_BACKEND_CUPS (user_data);
+
+  GTK_NOTE (PRINTING,
+            g_print ("CUPS Backend: %s - %s\n", G_STRFUNC, signal_name));
+
+  gdk_threads_enter ();
+
+  if (cups_backend->cups_subscription_id > 0)
+    cups_request_printer_list (cups_backend);
+
+  gdk_threads_leave ();
+}
+
+static gboolean cups_renew_subscription (gpointer data);
+
+static void
+cups_create_subscription_cb (GtkPrintBackendCups *cups_backend,
+                             GtkCupsResult       *result,
+                             gpointer             user_data)
+{
+  ipp_attribute_t *attr;
+  ipp_t *response;
+
+  gdk_threads_enter ();
+
+  GTK_NOTE (PRINTING,
+            g_print ("CUPS Backend: %s\n", G_STRFUNC));
+
+  cups_backend->cups_subscription_id = 0;
+
+  if (!gtk_cups_result_is_error (result))
+    {
+      response = gtk_cups_result_get_response (result);
+      attr = ippFindAttribute (response, "notify-subscription-id", IPP_TAG_INTEGER);
+      if (attr != NULL)
+        cups_backend->cups_subscription_id = ippGetInteger (attr, 0);
+    }
+
+  if (cups_backend->cups_subscription_id > 0)
+    {
+      if (cups_backend->cups_subscription_renewal == 0)
+        cups_backend->cups_subscription_renewal =
+          gdk_threads_add_timeout_seconds (SUBSCRIPTION_DURATION - 60,
+                                           cups_renew_subscription,
+                                           cups_backend);
+
+      /* Changes are notified from now on, so stop polling the list */
+      if (cups_backend->list_printers_poll > 0)
+        {
+          g_source_remove (cups_backend->list_printers_poll);
+          cups_backend->list_printers_attempts = -1;
+          cups_backend->list_printers_poll = gdk_threads_add_timeout (SUBSCRIBED_POLL_INTERVAL,
+                                               (GSourceFunc) cups_request_printer_list,
+                                               cups_backend);
+        }
+    }
+  else
+    {
+      GTK_NOTE (PRINTING,
+                g_warning ("CUPS Backend: Error subscribing to printer events: %s",
+                           gtk_cups_result_is_error (result) ?
+                             gtk_cups_result_get_error_string (result) : ""));
+
+      /* Without notifications, go back to polling the list */
+      if (cups_backend->list_printers_poll > 0 &&
+          cups_backend->list_printers_attempts == -1)
+        {
+          g_source_remove (cups_backend->list_printers_poll);
+          cups_backend->list_printers_poll = gdk_threads_add_timeout (200,
+                                               (GSourceFunc) cups_request_printer_list,
+                                               cups_backend);
+        }
+    }
+
+  gdk_threads_leave ();
+}
+
+/* Subscribes to the changes of the printers, which cupsd then
+ * signals on the system bus; renews the subscription if there
+ * already is one
+ */
+static void
+cups_create_subscription (GtkPrintBackendCups *cups_backend)
+{
+  static const char * const events[] = {
+    "printer-added",
+    "printer-deleted",
+    "printer-stopped",
+    "printer-state-changed",
+    "printer-config-changed"
+  };
+  GtkCupsRequest *request;
+  gint operation;
+
+  operation = cups_backend->cups_subscription_id > 0 ?
+    IPP_RENEW_SUBSCRIPTION : IPP_CREATE_PRINTER_SUBSCRIPTION;
+
+  request = gtk_cups_request_new_with_username (NULL,
+                                                GTK_CUPS_POST,
+                                                operation,
+                                                NULL,
+                                                NULL,
+                                                NULL,
+                                                cups_backend->username);
+
+  gtk_cups_request_ipp_add_string (request, IPP_TAG_OPERATION, IPP_TAG_URI,
+                                   "printer-uri", NULL, "/");
+
+  if (operation == IPP_RENEW_SUBSCRIPTION)
+    {
+      gtk_cups_request_ipp_add_integer (request, IPP_TAG_OPERATION, IPP_TAG_INTEGER,
+                                        "notify-subscription-id",
+                                        cups_backend->cups_subscription_id);
+    }
+  else
+    {
+      gtk_cups_request_ipp_add_strings (request, IPP_TAG_SUBSCRIPTION, IPP_TAG_KEYWORD,
+                                        "notify-events", G_N_ELEMENTS (events),
+                                        NULL, events);
+      gtk_cups_request_ipp_add_string (request, IPP_TAG_SUBSCRIPTION, IPP_TAG_URI,
+                                       "notify-recipient-uri", NULL, "dbus://");
+    }
+
+  gtk_cups_request_ipp_add_integer (request, IPP_TAG_SUBSCRIPTION, IPP_TAG_INTEGER,
+                                    "notify-lease-duration", SUBSCRIPTION_DURATION);
+
+  cups_request_execute (cups_backend,
+                        request,
+                        (GtkPrintCupsResponseCallbackFunc) cups_create_subscription_cb,
+                        NULL,
+                        NULL);
+}
+
+static gboolean
+cups_renew_subscription (gpointer data)
+{
+  GtkPrintBackendCups *cups_backend = GTK_PRINT_BACKEND_CUPS (data);
+
+  /* a failed renewal creates a new subscription */
+  cups_create_subscription (cups_backend);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+cups_cancel_subscription_cb (GtkPrintBackendCups *cups_backend,
+                             GtkCupsResult       *result,
+                             gpointer             user_data)
+{
+  GTK_NOTE (PRINTING,
+            g_print ("CUPS Backend: %s\n", G_STRFUNC));
+}
+
+static void
+cups_cancel_subscription (GtkPrintBackendCups *cups_backend)
+{
+  GtkCupsRequest *request;
+
+  if (cups_backend->cups_subscription_id <= 0)
+    return;
+
+  request = gtk_cups_request_new_with_username (NULL,
+                                                GTK_CUPS_POST,
+                                                IPP_CANCEL_SUBSCRIPTION,
+                                                NULL,
+                                                NULL,
+                                                NULL,
+                                                cups_backend->username);
+
+  gtk_cups_request_ipp_add_string (request, IPP_TAG_OPERATION, IPP_TAG_URI,
+                                   "printer-uri", NULL, "/");
+  gtk_cups_request_ipp_add_integer (request, IPP_TAG_OPERATION, IPP_TAG_INTEGER,
+                                    "notify-subscription-id",
+                                    cups_backend->cups_subscription_id);
+
+  cups_backend->cups_subscription_id = 0;
+
+  cups_request_execute (cups_backend,
+                        request,
+                        (GtkPrintCupsResponseCallbackFunc) cups_cancel_subscription_cb,
+                        NULL,
+                        NULL);
+}
+#endif
+
 static void
 cups_get_printer_list (GtkPrintBackend *backend)
 {
@@ -375,6 +375,7 @@ typedef struct {
   GtkPrintBackend *backend;
   GtkPrintJobCompleteFunc callback;
   GtkPrintJob *job;
+  GIOChannel *data_io;
   GFileOutputStream *target_io_stream;
   gpointer user_data;
   GDestroyNotify dnotify;
@@ -411,6 +412,9 @@ file_print_cb_locked (GtkPrintBackendFile *print_backend,
   if (ps->job)
     g_object_unref (ps->job);
 
+  if (ps->data_io)
+    g_io_channel_unref (ps->data_io);
+
   g_free (ps);
 }
 
@@ -426,57 +430,73 @@ file_print_cb (GtkPrintBackendFile *print_backend,
   GDK_THREADS_LEAVE ();
 }
 
-static gboolean
-file_write (GIOChannel   *source,
-            GIOCondition  con,
-            gpointer      user_data)
+/* Copies the spooled job to the target file. This runs in a thread,
+ * so that big jobs don't block the main loop while they are written.
+ */
+static void
+file_write_thread (GTask        *task,
+                   gpointer      source_object,
+                   gpointer      task_data,
+                   GCancellable *cancellable)
 {
   gchar buf[_STREAM_MAX_CHUNK_SIZE];
   gsize bytes_read;
   GError *error;
   GIOStatus read_status;
-  _PrintStreamData *ps = (_PrintStreamData *) user_data;
+  _PrintStreamData *ps = (_PrintStreamData *) task_data;
 
   error = NULL;
 
-  read_status =
-    g_io_channel_read_chars (source,
-                             buf,
-                             _STREAM_MAX_CHUNK_SIZE,
-                             &bytes_read,
-                             &error);
-
-  if (read_status != G_IO_STATUS_ERROR)
+  do
     {
-      gsize bytes_written;
-
-      g_output_stream_write_all (G_OUTPUT_STREAM (ps->target_io_stream),
+      read_status =
+        g_io_channel_read_chars (ps->data_io,
                                  buf,
-                                 bytes_read,
-                                 &bytes_written,
-                                 NULL,
+                                 _STREAM_MAX_CHUNK_SIZE,
+                                 &bytes_read,
                                  &error);
+
+      if (read_status == G_IO_STATUS_ERROR)
+        break;
+
+      if (bytes_read > 0 &&
+          !g_output_stream_write_all (G_OUTPUT_STREAM (ps->target_io_stream),
+                                      buf,
+                                      bytes_read,
+                                      NULL,
+                                      cancellable,
+                                      &error))
+        break;
+
+      GTK_NOTE (PRINTING,
+                g_print ("FILE Backend: Writting %i byte chunk to target file\n", bytes_read));
     }
+  while (read_status != G_IO_STATUS_EOF);
 
-  if (error != NULL || read_status == G_IO_STATUS_EOF)
-    {
-      file_print_cb (GTK_PRINT_BACKEND_FILE (ps->backend), error, user_data);
+  if (error != NULL)
+    g_task_return_error (task, error);
+  else
+    g_task_return_boolean (task, TRUE);
+}
 
-      if (error != NULL)
-        {
-          GTK_NOTE (PRINTING,
-                    g_print ("FILE Backend: %s\n", error->message));
+static void
+file_write_done (GObject      *source_object,
+                 GAsyncResult *result,
+                 gpointer      user_data)
+{
+  GError *error = NULL;
 
-          g_error_free (error);
-        }
+  g_task_propagate_boolean (G_TASK (result), &error);
 
-      return FALSE;
-    }
+  file_print_cb (GTK_PRINT_BACKEND_FILE (source_object), error, user_data);
 
-  GTK_NOTE (PRINTING,
-            g_print ("FILE Backend: Writting %i byte chunk to target file\n", bytes_read));
+  if (error != NULL)
+    {
+      GTK_NOTE (PRINTING,
+                g_print ("FILE Backend: %s\n", error->message));
 
-  return TRUE;
+      g_error_free (error);
+    }
 }
 
 static void
@@ -492,6 +512,7 @@ gtk_print_backend_file_print_stream (GtkPrintBackend        *print_backend,
   GtkPrintSettings *settings;
   gchar *uri;
   GFile *file = NULL;
+  GTask *task;
 
   settings = gtk_print_job_get_settings (job);
 
@@ -524,10 +545,12 @@ error:
       return;
     }
 
-  g_io_add_watch (data_io, 
-                  G_IO_IN | G_IO_PRI | G_IO_ERR | G_IO_HUP,
-                  (GIOFunc) file_write,
-                  ps);
+  ps->data_io = g_io_channel_ref (data_io);
+
+  task = g_task_new (print_backend, NULL, file_write_done, ps);
+  g_task_set_task_data (task, ps, NULL);
+  g_task_run_in_thread (task, file_write_thread);
+  g_object_unref (task);
 }
 
 static void
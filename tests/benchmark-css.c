@@ -0,0 +1,358 @@
+/* benchmark-css.c
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Times the CSS machinery in two parts.
+ *
+ * "parse" loads every .css file in the directories given with --dir
+ * (by default the tests/css/parser corpus) and every file given with
+ * --theme into a fresh GtkCssProvider, and reports the throughput.
+ * Parse errors are expected, the corpus tests them.
+ *
+ * "match" builds synthetic widget paths of varying depth and number of
+ * style classes, and times a full style lookup for them: selector
+ * matching, cascading and computing the values. The style rules come
+ * from the current theme plus the files given with --theme.
+ *
+ * The results are printed as tab separated values, one line per
+ * benchmark, with all times in microseconds:
+ *
+ *   benchmark  iterations  mean  min  max  extra
+ *
+ * where extra is MB/s for "parse" and lookups per second for "match".
+ * Lines starting with # are comments.
+ */
+
+#include <gtk/gtk.h>
+
+static gint iterations = 20;
+static gchar **dirs = NULL;
+static gchar **themes = NULL;
+
+static GOptionEntry entries[] = {
+  { "iterations", 'n', 0, G_OPTION_ARG_INT, &iterations, "How often to repeat each benchmark", "N" },
+  { "dir", 'd', 0, G_OPTION_ARG_FILENAME_ARRAY, &dirs, "Parse all CSS files in this directory", "DIR" },
+  { "theme", 't', 0, G_OPTION_ARG_FILENAME_ARRAY, &themes, "Parse this CSS file and use it for matching", "FILE" },
+  { NULL }
+};
+
+typedef struct {
+  gint64 total;
+  gint64 min;
+  gint64 max;
+  gint n;
+} Timing;
+
+static void
+timing_init (Timing *timing)
+{
+  timing->total = 0;
+  timing->min = G_MAXINT64;
+  timing->max = 0;
+  timing->n = 0;
+}
+
+static void
+timing_add (Timing *timing,
+            gint64  value)
+{
+  timing->total += value;
+  timing->min = MIN (timing->min, value);
+  timing->max = MAX (timing->max, value);
+  timing->n++;
+}
+
+static void
+timing_print (Timing      *timing,
+              const gchar *name,
+              gdouble      extra)
+{
+  g_print ("%s\t%d\t%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT "\t%.2f\n",
+           name, timing->n,
+           timing->n ? timing->total / timing->n : 0,
+           timing->n ? timing->min : 0,
+           timing->max,
+           extra);
+}
+
+static void
+parsing_error_cb (GtkCssProvider *provider,
+                  GtkCssSection  *section,
+                  const GError   *error,
+                  gpointer        data)
+{
+  /* The corpus is full of intentional errors */
+}
+
+static void
+add_css_files_in_directory (GPtrArray   *files,
+                            const gchar *path)
+{
+  GDir *dir;
+  const gchar *name;
+  GError *error = NULL;
+
+  dir = g_dir_open (path, 0, &error);
+  if (dir == NULL)
+    {
+      g_printerr ("%s\n", error->message);
+      g_error_free (error);
+      return;
+    }
+
+  while ((name = g_dir_read_name (dir)))
+    {
+      /* The .ref.css files are the printed results, skip them */
+      if (!g_str_has_suffix (name, ".css") ||
+          g_str_has_suffix (name, ".ref.css"))
+        continue;
+
+      g_ptr_array_add (files, g_build_filename (path, name, NULL));
+    }
+
+  g_dir_close (dir);
+}
+
+static void
+run_parse (void)
+{
+  GPtrArray *files;
+  GPtrArray *contents;
+  gsize total_size;
+  Timing timing;
+  guint i;
+  gint n;
+
+  files = g_ptr_array_new_with_free_func (g_free);
+
+  if (dirs)
+    {
+      for (i = 0; dirs[i]; i++)
+        add_css_files_in_directory (files, dirs[i]);
+    }
+  else if (!themes)
+    {
+      gchar *path;
+
+      path = g_build_filename (g_getenv ("srcdir") ? g_getenv ("srcdir") : ".",
+                               "css", "parser", NULL);
+      add_css_files_in_directory (files, path);
+      g_free (path);
+    }
+
+  if (themes)
+    {
+      for (i = 0; themes[i]; i++)
+        g_ptr_array_add (files, g_strdup (themes[i]));
+    }
+
+  /* Read everything up front, so that only parsing is timed */
+  contents = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
+  total_size = 0;
+  for (i = 0; i < files->len; i++)
+    {
+      gchar *data;
+      gsize size;
+      GError *error = NULL;
+
+      if (!g_file_get_contents (g_ptr_array_index (files, i), &data, &size, &error))
+        {
+          g_printerr ("%s\n", error->message);
+          g_error_free (error);
+          continue;
+        }
+
+      g_ptr_array_add (contents, g_bytes_new_take (data, size));
+      total_size += size;
+    }
+
+  g_print ("# parse: %u files, %" G_GSIZE_FORMAT " bytes\n", contents->len, total_size);
+
+  timing_init (&timing);
+
+  for (n = 0; n < iterations; n++)
+    {
+      gint64 begin;
+
+      begin = g_get_monotonic_time ();
+
+      for (i = 0; i < contents->len; i++)
+        {
+          GtkCssProvider *provider;
+          GBytes *bytes = g_ptr_array_index (contents, i);
+          gsize size;
+          const gchar *data;
+
+          data = g_bytes_get_data (bytes, &size);
+
+          provider = gtk_css_provider_new ();
+          g_signal_connect (provider, "parsing-error", G_CALLBACK (parsing_error_cb), NULL);
+          gtk_css_provider_load_from_data (provider, data, size, NULL);
+          g_object_unref (provider);
+        }
+
+      timing_add (&timing, g_get_monotonic_time () - begin);
+    }
+
+  timing_print (&timing, "parse",
+                timing.total ? (gdouble) total_size * timing.n / timing.total : 0);
+
+  g_ptr_array_unref (contents);
+  g_ptr_array_unref (files);
+}
+
+/* Cycles through a few common widget types below the window */
+static GType
+get_path_type (gint level)
+{
+  if (level == 0)
+    return GTK_TYPE_WINDOW;
+
+  switch (level % 5)
+    {
+    case 0:
+      return GTK_TYPE_BOX;
+    case 1:
+      return GTK_TYPE_GRID;
+    case 2:
+      return GTK_TYPE_NOTEBOOK;
+    case 3:
+      return GTK_TYPE_BUTTON;
+    default:
+      return GTK_TYPE_LABEL;
+    }
+}
+
+static GtkWidgetPath *
+create_path (gint depth,
+             gint n_classes)
+{
+  GtkWidgetPath *path;
+  gint i, j;
+
+  path = gtk_widget_path_new ();
+
+  for (i = 0; i < depth; i++)
+    {
+      gint pos;
+
+      pos = gtk_widget_path_append_type (path, get_path_type (i));
+
+      for (j = 0; j < n_classes; j++)
+        {
+          gchar *name;
+
+          name = g_strdup_printf ("class-%d", (i + j) % 16);
+          gtk_widget_path_iter_add_class (path, pos, name);
+          g_free (name);
+        }
+
+      if (i % 4 == 0)
+        {
+          gchar *name;
+
+          name = g_strdup_printf ("widget-%d", i);
+          gtk_widget_path_iter_set_name (path, pos, name);
+          g_free (name);
+        }
+    }
+
+  return path;
+}
+
+static void
+run_match (gint depth,
+           gint n_classes)
+{
+  GtkStyleContext *context;
+  GtkWidgetPath *path;
+  Timing timing;
+  gchar *name;
+  gint n;
+
+  path = create_path (depth, n_classes);
+  context = gtk_style_context_new ();
+  gtk_style_context_set_path (context, path);
+  gtk_widget_path_unref (path);
+
+  timing_init (&timing);
+
+  for (n = 0; n < iterations; n++)
+    {
+      GtkBorder border;
+      gint64 begin;
+
+      begin = g_get_monotonic_time ();
+
+      /* Drop the cached style, then query a property to force a new
+       * lookup */
+      G_GNUC_BEGIN_IGNORE_DEPRECATIONS;
+      gtk_style_context_invalidate (context);
+      G_GNUC_END_IGNORE_DEPRECATIONS;
+      gtk_style_context_get_border (context, GTK_STATE_FLAG_NORMAL, &border);
+
+      timing_add (&timing, g_get_monotonic_time () - begin);
+    }
+
+  name = g_strdup_printf ("match/depth-%d/classes-%d", depth, n_classes);
+  timing_print (&timing, name,
+                timing.total ? 1000000.0 * timing.n / timing.total : 0);
+  g_free (name);
+
+  g_object_unref (context);
+}
+
+int
+main (int argc, char *argv[])
+{
+  static const gint depths[] = { 4, 16, 64 };
+  static const gint class_counts[] = { 0, 2, 8 };
+  GError *error = NULL;
+  guint i, j;
+
+  if (!gtk_init_with_args (&argc, &argv, "- time CSS parsing and matching",
+                           entries, NULL, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      g_error_free (error);
+      return 1;
+    }
+
+  g_print ("# benchmark\titerations\tmean\tmin\tmax\textra\n");
+
+  run_parse ();
+
+  if (themes)
+    {
+      for (i = 0; themes[i]; i++)
+        {
+          GtkCssProvider *provider;
+
+          provider = gtk_css_provider_new ();
+          g_signal_connect (provider, "parsing-error", G_CALLBACK (parsing_error_cb), NULL);
+          gtk_css_provider_load_from_path (provider, themes[i], NULL);
+          gtk_style_context_add_provider_for_screen (gdk_screen_get_default (),
+                                                     GTK_STYLE_PROVIDER (provider),
+                                                     GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+          g_object_unref (provider);
+        }
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (depths); i++)
+    for (j = 0; j < G_N_ELEMENTS (class_counts); j++)
+      run_match (depths[i], class_counts[j]);
+
+  return 0;
+}
@@ -0,0 +1,336 @@
+/* benchmark-layout.c
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Builds synthetic widget trees in an offscreen window and times
+ * size requests, size allocation, style validation and drawing on
+ * them. Nothing is shown on screen, but a display is still needed;
+ * running it against broadwayd or Xvfb works.
+ *
+ * The results are printed as tab separated values, one line per
+ * tree and operation, with all times in microseconds:
+ *
+ *   tree  operation  iterations  mean  min  max
+ *
+ * Lines starting with # are comments. "restyle" is the layout phase
+ * after gtk_widget_reset_style() on the window, so it includes the
+ * relayout caused by the new style.
+ */
+
+#include <string.h>
+#include <gtk/gtk.h>
+
+typedef struct {
+  const gchar *name;
+  GtkWidget *(* create) (void);
+} Tree;
+
+static gint iterations = 20;
+static gchar *only_tree = NULL;
+static gdouble scale = 1.0;
+
+static GOptionEntry entries[] = {
+  { "iterations", 'n', 0, G_OPTION_ARG_INT, &iterations, "How often to repeat each operation", "N" },
+  { "tree", 't', 0, G_OPTION_ARG_STRING, &only_tree, "Only run the benchmarks for this tree", "NAME" },
+  { "scale", 's', 0, G_OPTION_ARG_DOUBLE, &scale, "Scale the size of the trees", "FACTOR" },
+  { NULL }
+};
+
+static const gchar *lorem =
+  "Lorem ipsum dolor sit amet, consectetur adipisicing elit, sed do "
+  "eiusmod tempor incididunt ut labore et dolore magna aliqua.";
+
+static gint
+scaled (gint n)
+{
+  return MAX (1, (gint) (n * scale));
+}
+
+static GtkWidget *
+create_deep_boxes (void)
+{
+  GtkWidget *top, *box, *child;
+  gint depth, i;
+
+  depth = scaled (200);
+
+  top = box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+  for (i = 0; i < depth; i++)
+    {
+      gchar *text;
+
+      text = g_strdup_printf ("Level %d", i);
+      gtk_box_pack_start (GTK_BOX (box), gtk_label_new (text), FALSE, FALSE, 0);
+      g_free (text);
+
+      child = gtk_box_new (i % 2 ? GTK_ORIENTATION_VERTICAL : GTK_ORIENTATION_HORIZONTAL, 0);
+      gtk_box_pack_start (GTK_BOX (box), child, TRUE, TRUE, 0);
+      box = child;
+    }
+
+  return top;
+}
+
+static GtkWidget *
+create_label_grid (void)
+{
+  GtkWidget *grid, *label;
+  gint rows, columns, x, y;
+
+  rows = columns = scaled (100);
+
+  grid = gtk_grid_new ();
+  for (y = 0; y < rows; y++)
+    for (x = 0; x < columns; x++)
+      {
+        label = gtk_label_new (lorem + (x + y) % 40);
+        gtk_label_set_line_wrap (GTK_LABEL (label), TRUE);
+        gtk_label_set_max_width_chars (GTK_LABEL (label), 20);
+        gtk_grid_attach (GTK_GRID (grid), label, x, y, 1, 1);
+      }
+
+  return grid;
+}
+
+static GtkWidget *
+create_nested_notebooks (void)
+{
+  GtkWidget *top, *notebook, *child;
+  gint depth, pages, i, j;
+
+  depth = scaled (20);
+  pages = 5;
+
+  top = notebook = gtk_notebook_new ();
+  for (i = 0; i < depth; i++)
+    {
+      child = gtk_notebook_new ();
+      gtk_notebook_append_page (GTK_NOTEBOOK (notebook), child, gtk_label_new ("Nested"));
+
+      for (j = 1; j < pages; j++)
+        gtk_notebook_append_page (GTK_NOTEBOOK (notebook),
+                                  gtk_label_new (lorem),
+                                  gtk_label_new ("Page"));
+
+      notebook = child;
+    }
+
+  gtk_notebook_append_page (GTK_NOTEBOOK (notebook), gtk_label_new (lorem), NULL);
+
+  return top;
+}
+
+static Tree trees[] = {
+  { "deep-boxes", create_deep_boxes },
+  { "label-grid", create_label_grid },
+  { "nested-notebooks", create_nested_notebooks }
+};
+
+typedef struct {
+  gint64 total;
+  gint64 min;
+  gint64 max;
+  gint n;
+} Timing;
+
+static void
+timing_init (Timing *timing)
+{
+  timing->total = 0;
+  timing->min = G_MAXINT64;
+  timing->max = 0;
+  timing->n = 0;
+}
+
+static void
+timing_add (Timing *timing,
+            gint64  duration)
+{
+  timing->total += duration;
+  timing->min = MIN (timing->min, duration);
+  timing->max = MAX (timing->max, duration);
+  timing->n++;
+}
+
+static void
+timing_print (Timing      *timing,
+              const gchar *tree,
+              const gchar *operation)
+{
+  if (timing->n == 0)
+    return;
+
+  g_print ("%s\t%s\t%d\t%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT "\n",
+           tree, operation, timing->n,
+           timing->total / timing->n, timing->min, timing->max);
+}
+
+/* The toplevel's resize handling is connected to the layout phase
+ * with g_signal_connect(), so the phase is bracketed by a handler
+ * connected before it and one connected after all of them.
+ */
+static gint64 layout_start;
+static gint64 layout_duration;
+static gboolean layout_done;
+
+static void
+layout_begin_cb (GdkFrameClock *clock)
+{
+  layout_start = g_get_monotonic_time ();
+}
+
+static void
+layout_end_cb (GdkFrameClock *clock)
+{
+  layout_duration = g_get_monotonic_time () - layout_start;
+  layout_done = TRUE;
+}
+
+static gint64
+run_layout_phase (GtkWidget *window)
+{
+  GdkFrameClock *clock;
+
+  clock = gtk_widget_get_frame_clock (window);
+
+  layout_done = FALSE;
+  gdk_frame_clock_request_phase (clock, GDK_FRAME_CLOCK_PHASE_LAYOUT);
+  while (!layout_done)
+    g_main_context_iteration (NULL, TRUE);
+
+  return layout_duration;
+}
+
+/* Throws away the cached size requests of every widget in the tree */
+static void
+invalidate_sizes (GtkWidget *widget,
+                  gpointer   data)
+{
+  gtk_widget_queue_resize_no_redraw (widget);
+
+  if (GTK_IS_CONTAINER (widget))
+    gtk_container_forall (GTK_CONTAINER (widget), invalidate_sizes, NULL);
+}
+
+static void
+run_tree (Tree *tree)
+{
+  GtkWidget *window, *root;
+  GdkFrameClock *clock;
+  GtkAllocation allocation;
+  gint min_width, nat_width, min_height, nat_height;
+  Timing create, measure, allocate, restyle, draw;
+  gint64 begin;
+  gint i;
+
+  timing_init (&create);
+  timing_init (&measure);
+  timing_init (&allocate);
+  timing_init (&restyle);
+  timing_init (&draw);
+
+  begin = g_get_monotonic_time ();
+  root = tree->create ();
+  timing_add (&create, g_get_monotonic_time () - begin);
+
+  window = gtk_offscreen_window_new ();
+  gtk_container_add (GTK_CONTAINER (window), root);
+  gtk_widget_show_all (window);
+
+  clock = gtk_widget_get_frame_clock (window);
+  g_signal_connect (clock, "layout", G_CALLBACK (layout_begin_cb), NULL);
+  g_signal_connect_after (clock, "layout", G_CALLBACK (layout_end_cb), NULL);
+
+  run_layout_phase (window);
+
+  for (i = 0; i < iterations; i++)
+    {
+      cairo_surface_t *surface;
+      cairo_t *cr;
+
+      invalidate_sizes (root, NULL);
+
+      begin = g_get_monotonic_time ();
+      gtk_widget_get_preferred_width (root, &min_width, &nat_width);
+      gtk_widget_get_preferred_height_for_width (root, nat_width, &min_height, &nat_height);
+      timing_add (&measure, g_get_monotonic_time () - begin);
+
+      /* Vary the width, so that height-for-width isn't just
+       * answered from the cache */
+      allocation.x = 0;
+      allocation.y = 0;
+      allocation.width = nat_width + i % 2;
+      allocation.height = nat_height;
+
+      begin = g_get_monotonic_time ();
+      gtk_widget_size_allocate (root, &allocation);
+      timing_add (&allocate, g_get_monotonic_time () - begin);
+
+      /* Let the window catch up with the sizes queued above */
+      run_layout_phase (window);
+
+      gtk_widget_reset_style (window);
+      timing_add (&restyle, run_layout_phase (window));
+
+      surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                            gtk_widget_get_allocated_width (root),
+                                            gtk_widget_get_allocated_height (root));
+      cr = cairo_create (surface);
+
+      begin = g_get_monotonic_time ();
+      gtk_widget_draw (root, cr);
+      timing_add (&draw, g_get_monotonic_time () - begin);
+
+      cairo_destroy (cr);
+      cairo_surface_destroy (surface);
+    }
+
+  g_signal_handlers_disconnect_by_func (clock, layout_begin_cb, NULL);
+  g_signal_handlers_disconnect_by_func (clock, layout_end_cb, NULL);
+  gtk_widget_destroy (window);
+
+  timing_print (&create, tree->name, "create");
+  timing_print (&measure, tree->name, "measure");
+  timing_print (&allocate, tree->name, "allocate");
+  timing_print (&restyle, tree->name, "restyle");
+  timing_print (&draw, tree->name, "draw");
+}
+
+int
+main (int argc, char *argv[])
+{
+  GError *error = NULL;
+  guint i;
+
+  if (!gtk_init_with_args (&argc, &argv, "- time layout operations",
+                           entries, NULL, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      g_error_free (error);
+      return 1;
+    }
+
+  g_print ("# tree\toperation\titerations\tmean\tmin\tmax\n");
+
+  for (i = 0; i < G_N_ELEMENTS (trees); i++)
+    {
+      if (only_tree && strcmp (only_tree, trees[i].name) != 0)
+        continue;
+
+      run_tree (&trees[i]);
+    }
+
+  return 0;
+}
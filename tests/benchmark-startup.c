@@ -0,0 +1,292 @@
+/* benchmark-startup.c
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Measures how long it takes to start up and show a first frame.
+ *
+ * Every run is a fresh process: with --runs=N the program runs itself
+ * N times and collects the results. A run initializes GTK, builds a
+ * toplevel window, either a built-in one or the first window in the
+ * UI definition given with --ui (such as
+ * demos/widget-factory/widget-factory.ui), shows it and quits after
+ * the first frame has been painted.
+ *
+ * The results are printed as JSON, one object per run, with all times
+ * in microseconds since main() was entered:
+ *
+ *   { "ui": ..., "init": ..., "first-frame": ...,
+ *     "peak-rss-kb": ..., "open-fds": ... }
+ *
+ * "open-fds" counts the file descriptors that are still open after
+ * the first frame, which catches leaked and cached files but not the
+ * ones that were opened and closed again. A display is needed, so run
+ * it against broadwayd or Xvfb to get headless numbers.
+ */
+
+#include <gtk/gtk.h>
+#ifdef G_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+static gint runs = 0;
+static gchar *ui_file = NULL;
+
+static GOptionEntry entries[] = {
+  { "runs", 'n', 0, G_OPTION_ARG_INT, &runs, "Start this many processes and collect their results", "N" },
+  { "ui", 'u', 0, G_OPTION_ARG_FILENAME, &ui_file, "Show the first window from this UI definition", "FILE" },
+  { NULL }
+};
+
+static gint64 start_time;
+static gint64 init_time;
+static gint64 first_frame_time;
+
+static glong
+get_peak_rss (void)
+{
+#ifdef G_OS_UNIX
+  struct rusage usage;
+
+  if (getrusage (RUSAGE_SELF, &usage) == 0)
+    return usage.ru_maxrss;
+#endif
+
+  return -1;
+}
+
+static gint
+count_open_fds (void)
+{
+  GDir *dir;
+  gint n;
+
+  dir = g_dir_open ("/proc/self/fd", 0, NULL);
+  if (dir == NULL)
+    return -1;
+
+  /* don't count the descriptor of the directory itself */
+  for (n = -1; g_dir_read_name (dir); n++)
+    ;
+
+  g_dir_close (dir);
+
+  return n;
+}
+
+static GtkWidget *
+create_window (void)
+{
+  GtkWidget *window, *box, *entry, *scrolled, *view, *buttons;
+  GtkListStore *store;
+  gint i;
+
+  window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+  gtk_window_set_default_size (GTK_WINDOW (window), 600, 400);
+
+  box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 6);
+  gtk_container_add (GTK_CONTAINER (window), box);
+
+  entry = gtk_search_entry_new ();
+  gtk_box_pack_start (GTK_BOX (box), entry, FALSE, FALSE, 0);
+
+  store = gtk_list_store_new (1, G_TYPE_STRING);
+  for (i = 0; i < 100; i++)
+    {
+      gchar *text;
+
+      text = g_strdup_printf ("Row %d", i);
+      gtk_list_store_insert_with_values (store, NULL, -1, 0, text, -1);
+      g_free (text);
+    }
+
+  view = gtk_tree_view_new_with_model (GTK_TREE_MODEL (store));
+  gtk_tree_view_insert_column_with_attributes (GTK_TREE_VIEW (view), -1, "Name",
+                                               gtk_cell_renderer_text_new (),
+                                               "text", 0, NULL);
+  g_object_unref (store);
+
+  scrolled = gtk_scrolled_window_new (NULL, NULL);
+  gtk_container_add (GTK_CONTAINER (scrolled), view);
+  gtk_box_pack_start (GTK_BOX (box), scrolled, TRUE, TRUE, 0);
+
+  buttons = gtk_button_box_new (GTK_ORIENTATION_HORIZONTAL);
+  gtk_box_pack_start (GTK_BOX (buttons), gtk_button_new_with_mnemonic ("_Cancel"), FALSE, FALSE, 0);
+  gtk_box_pack_start (GTK_BOX (buttons), gtk_button_new_with_mnemonic ("_OK"), FALSE, FALSE, 0);
+  gtk_box_pack_start (GTK_BOX (box), buttons, FALSE, FALSE, 0);
+
+  return window;
+}
+
+static GtkWidget *
+load_window (const gchar *filename)
+{
+  GtkBuilder *builder;
+  GtkWidget *window = NULL;
+  GError *error = NULL;
+  GSList *objects, *l;
+
+  builder = gtk_builder_new ();
+  if (!gtk_builder_add_from_file (builder, filename, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      g_error_free (error);
+      g_object_unref (builder);
+      return NULL;
+    }
+
+  objects = gtk_builder_get_objects (builder);
+  for (l = objects; l; l = l->next)
+    {
+      if (GTK_IS_WINDOW (l->data) &&
+          gtk_window_get_window_type (l->data) == GTK_WINDOW_TOPLEVEL)
+        {
+          window = l->data;
+          break;
+        }
+    }
+  g_slist_free (objects);
+
+  if (window == NULL)
+    g_printerr ("%s contains no toplevel window\n", filename);
+
+  g_object_unref (builder);
+
+  return window;
+}
+
+static void
+after_paint_cb (GdkFrameClock *clock,
+                gpointer       data)
+{
+  if (first_frame_time == 0)
+    {
+      first_frame_time = g_get_monotonic_time ();
+      gtk_main_quit ();
+    }
+}
+
+static void
+realize_cb (GtkWidget *window)
+{
+  g_signal_connect (gtk_widget_get_frame_clock (window), "after-paint",
+                    G_CALLBACK (after_paint_cb), NULL);
+}
+
+static gboolean
+run_once (void)
+{
+  GtkWidget *window;
+  gchar *name;
+
+  if (ui_file)
+    window = load_window (ui_file);
+  else
+    window = create_window ();
+
+  if (window == NULL)
+    return FALSE;
+
+  g_signal_connect (window, "realize", G_CALLBACK (realize_cb), NULL);
+  gtk_widget_show_all (window);
+
+  gtk_main ();
+
+  name = g_strescape (ui_file ? ui_file : "built-in", NULL);
+  g_print ("{ \"ui\": \"%s\", \"init\": %" G_GINT64_FORMAT ", \"first-frame\": %" G_GINT64_FORMAT ", "
+           "\"peak-rss-kb\": %ld, \"open-fds\": %d }",
+           name,
+           init_time - start_time,
+           first_frame_time - start_time,
+           get_peak_rss (),
+           count_open_fds ());
+  g_free (name);
+
+  gtk_widget_destroy (window);
+
+  return TRUE;
+}
+
+/* Runs the program again without --runs in a new process for every run,
+ * so that every run starts up from scratch
+ */
+static gboolean
+run_processes (const gchar *program)
+{
+  gchar *argv[4];
+  gint i;
+
+  argv[0] = (gchar *) program;
+  argv[1] = ui_file ? "--ui" : NULL;
+  argv[2] = ui_file;
+  argv[3] = NULL;
+
+  g_print ("[\n");
+
+  for (i = 0; i < runs; i++)
+    {
+      gchar *output;
+      gint status;
+      GError *error = NULL;
+
+      if (!g_spawn_sync (NULL, argv, NULL, G_SPAWN_SEARCH_PATH,
+                         NULL, NULL, &output, NULL, &status, &error))
+        {
+          g_printerr ("%s\n", error->message);
+          g_error_free (error);
+          return FALSE;
+        }
+
+      if (!g_spawn_check_exit_status (status, NULL))
+        {
+          g_free (output);
+          return FALSE;
+        }
+
+      g_print ("  %s%s\n", g_strstrip (output), i + 1 < runs ? "," : "");
+      g_free (output);
+    }
+
+  g_print ("]\n");
+
+  return TRUE;
+}
+
+int
+main (int argc, char *argv[])
+{
+  GError *error = NULL;
+
+  start_time = g_get_monotonic_time ();
+
+  if (!gtk_init_with_args (&argc, &argv, "- time startup",
+                           entries, NULL, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      g_error_free (error);
+      return 1;
+    }
+
+  init_time = g_get_monotonic_time ();
+
+  if (runs > 0)
+    return run_processes (argv[0]) ? 0 : 1;
+
+  if (!run_once ())
+    return 1;
+
+  g_print ("\n");
+
+  return 0;
+}
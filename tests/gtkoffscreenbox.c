@@ -623,8 +623,45 @@ static gboolean
 gtk_offscreen_box_damage (GtkWidget      *widget,
                           GdkEventExpose *event)
 {
-  gdk_window_invalidate_rect (gtk_widget_get_window (widget),
-                              NULL, FALSE);
+  GdkWindow *window = gtk_widget_get_window (widget);
+  cairo_rectangle_int_t rect;
+  double x[4], y[4];
+  double x1, y1, x2, y2;
+  int i, j;
+
+  /* Only invalidate the part of the box the damaged area of the
+   * offscreen window ends up in after the to-embedder transform.
+   */
+  for (i = 0; i < cairo_region_num_rectangles (event->region); i++)
+    {
+      cairo_region_get_rectangle (event->region, i, &rect);
+
+      gdk_window_coords_to_parent (event->window, rect.x, rect.y,
+                                   &x[0], &y[0]);
+      gdk_window_coords_to_parent (event->window, rect.x + rect.width, rect.y,
+                                   &x[1], &y[1]);
+      gdk_window_coords_to_parent (event->window, rect.x, rect.y + rect.height,
+                                   &x[2], &y[2]);
+      gdk_window_coords_to_parent (event->window, rect.x + rect.width, rect.y + rect.height,
+                                   &x[3], &y[3]);
+
+      x1 = x2 = x[0];
+      y1 = y2 = y[0];
+      for (j = 1; j < 4; j++)
+        {
+          x1 = MIN (x1, x[j]);
+          y1 = MIN (y1, y[j]);
+          x2 = MAX (x2, x[j]);
+          y2 = MAX (y2, y[j]);
+        }
+
+      rect.x = floor (x1);
+      rect.y = floor (y1);
+      rect.width = ceil (x2) - rect.x;
+      rect.height = ceil (y2) - rect.y;
+
+      gdk_window_invalidate_rect (window, &rect, FALSE);
+    }
 
   return TRUE;
 }
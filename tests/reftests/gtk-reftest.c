@@ -22,6 +22,7 @@
 
 #include "config.h"
 
+#include <stdlib.h>
 #include <string.h>
 #include <glib/gstdio.h>
 #include <gtk/gtk.h>
@@ -34,11 +35,38 @@ typedef enum {
 /* This is exactly the style information you've been looking for */
 #define GTK_STYLE_PROVIDER_PRIORITY_FORCE G_MAXUINT
 
+typedef enum {
+  PERF_STYLE,
+  PERF_LAYOUT,
+  PERF_DRAW,
+  N_PERF_PHASES
+} PerfPhase;
+
+static const char *perf_phase_names[N_PERF_PHASES] = {
+  "style",
+  "layout",
+  "draw"
+};
+
 static char *arg_output_dir = NULL;
+static int arg_perf_runs = 0;
+static char *arg_perf_baseline = NULL;
+static double arg_perf_tolerance = 0.25;
+static gboolean arg_perf_update_baseline = FALSE;
+
+static GKeyFile *perf_baseline = NULL;
 
 static const GOptionEntry test_args[] = {
   { "output",         'o', 0, G_OPTION_ARG_FILENAME, &arg_output_dir,
     "Directory to save image files to", "DIR" },
+  { "perf-runs",       0, 0, G_OPTION_ARG_INT, &arg_perf_runs,
+    "Also time style, layout and draw over N runs", "N" },
+  { "perf-baseline",   0, 0, G_OPTION_ARG_FILENAME, &arg_perf_baseline,
+    "Compare timings against the baseline in FILE", "FILE" },
+  { "perf-tolerance",  0, 0, G_OPTION_ARG_DOUBLE, &arg_perf_tolerance,
+    "Allowed slowdown against the baseline, as a fraction (default 0.25)", "FRACTION" },
+  { "perf-update-baseline", 0, 0, G_OPTION_ARG_NONE, &arg_perf_update_baseline,
+    "Store the measured timings in the baseline file instead of comparing", NULL },
   { NULL }
 };
 
@@ -460,6 +488,145 @@ compare_surfaces (const char *test_file,
   return diff;
 }
 
+static void
+lookup_style_recurse (GtkWidget *widget,
+                      gpointer   unused)
+{
+  GtkStyleContext *context;
+  GtkBorder border;
+
+  /* Querying a property makes the style context compute its style */
+  context = gtk_widget_get_style_context (widget);
+  gtk_style_context_get_border (context, gtk_style_context_get_state (context), &border);
+
+  if (GTK_IS_CONTAINER (widget))
+    gtk_container_forall (GTK_CONTAINER (widget), lookup_style_recurse, NULL);
+}
+
+static int
+compare_times (const void *a,
+               const void *b)
+{
+  gint64 t1 = *(const gint64 *) a;
+  gint64 t2 = *(const gint64 *) b;
+
+  return t1 < t2 ? -1 : (t1 > t2 ? 1 : 0);
+}
+
+/* Runs each phase @n_runs times on the shown toplevel of @ui_file and
+ * stores the median time of each phase, in microseconds, in @result.
+ */
+static void
+measure_ui_file (const char *ui_file,
+                 int         n_runs,
+                 gint64      result[N_PERF_PHASES])
+{
+  GtkWidget *window;
+  GtkBuilder *builder;
+  GtkAllocation allocation;
+  GtkRequisition requisition;
+  cairo_surface_t *surface;
+  GMainLoop *loop;
+  GError *error = NULL;
+  gint64 *times[N_PERF_PHASES];
+  gint64 start;
+  int i, phase;
+
+  builder = gtk_builder_new ();
+  gtk_builder_add_from_file (builder, ui_file, &error);
+  g_assert_no_error (error);
+  window = builder_get_toplevel (builder);
+  g_object_unref (builder);
+  g_assert (window);
+
+  gtk_widget_show (window);
+
+  loop = g_main_loop_new (NULL, FALSE);
+  gdk_event_handler_set (check_for_draw, loop, NULL);
+  g_main_loop_run (loop);
+  g_main_loop_unref (loop);
+
+  gtk_widget_get_allocation (window, &allocation);
+  surface = gdk_window_create_similar_surface (gtk_widget_get_window (window),
+                                               CAIRO_CONTENT_COLOR,
+                                               allocation.width,
+                                               allocation.height);
+
+  for (phase = 0; phase < N_PERF_PHASES; phase++)
+    times[phase] = g_new (gint64, n_runs);
+
+  for (i = 0; i < n_runs; i++)
+    {
+      cairo_t *cr;
+
+      start = g_get_monotonic_time ();
+      gtk_widget_reset_style (window);
+      lookup_style_recurse (window, NULL);
+      times[PERF_STYLE][i] = g_get_monotonic_time () - start;
+
+      start = g_get_monotonic_time ();
+      gtk_widget_queue_resize (window);
+      gtk_widget_get_preferred_size (window, &requisition, NULL);
+      gtk_widget_size_allocate (window, &allocation);
+      times[PERF_LAYOUT][i] = g_get_monotonic_time () - start;
+
+      cr = cairo_create (surface);
+      start = g_get_monotonic_time ();
+      gtk_widget_draw (window, cr);
+      cairo_surface_flush (surface);
+      times[PERF_DRAW][i] = g_get_monotonic_time () - start;
+      cairo_destroy (cr);
+    }
+
+  for (phase = 0; phase < N_PERF_PHASES; phase++)
+    {
+      qsort (times[phase], n_runs, sizeof (gint64), compare_times);
+      result[phase] = times[phase][n_runs / 2];
+      g_free (times[phase]);
+    }
+
+  cairo_surface_destroy (surface);
+  gtk_widget_destroy (window);
+}
+
+static void
+check_performance (const char *ui_file)
+{
+  gint64 result[N_PERF_PHASES];
+  char *test_name;
+  int phase;
+
+  measure_ui_file (ui_file, arg_perf_runs, result);
+
+  test_name = g_path_get_basename (ui_file);
+
+  for (phase = 0; phase < N_PERF_PHASES; phase++)
+    {
+      const char *name = perf_phase_names[phase];
+
+      g_test_message ("%s: %" G_GINT64_FORMAT " us", name, result[phase]);
+
+      if (arg_perf_update_baseline)
+        {
+          g_key_file_set_int64 (perf_baseline, test_name, name, result[phase]);
+        }
+      else if (g_key_file_has_key (perf_baseline, test_name, name, NULL))
+        {
+          gint64 baseline;
+
+          baseline = g_key_file_get_int64 (perf_baseline, test_name, name, NULL);
+          if (result[phase] > baseline * (1.0 + arg_perf_tolerance))
+            {
+              g_test_message ("%s regressed: %" G_GINT64_FORMAT " us, baseline %" G_GINT64_FORMAT " us",
+                              name, result[phase], baseline);
+              g_test_fail ();
+            }
+        }
+    }
+
+  g_free (test_name);
+}
+
 static void
 test_ui_file (GFile *file)
 {
@@ -494,6 +661,9 @@ test_ui_file (GFile *file)
       g_test_fail ();
     }
 
+  if (arg_perf_runs > 0)
+    check_performance (ui_file);
+
   remove_extra_css (provider);
 }
 
@@ -568,9 +738,28 @@ add_tests_for_files_in_directory (GFile *dir)
 int
 main (int argc, char **argv)
 {
+  int result;
+
   if (!parse_command_line (&argc, &argv))
     return 1;
 
+  if (arg_perf_runs > 0)
+    {
+      perf_baseline = g_key_file_new ();
+
+      if (arg_perf_baseline && !arg_perf_update_baseline)
+        {
+          GError *error = NULL;
+
+          if (!g_key_file_load_from_file (perf_baseline, arg_perf_baseline, 0, &error))
+            {
+              g_print ("could not load baseline: %s\n", error->message);
+              g_error_free (error);
+              return 1;
+            }
+        }
+    }
+
   if (argc < 2)
     {
       const char *basedir;
@@ -601,6 +790,29 @@ main (int argc, char **argv)
         }
     }
 
-  return g_test_run ();
+  result = g_test_run ();
+
+  if (perf_baseline)
+    {
+      if (arg_perf_baseline && arg_perf_update_baseline)
+        {
+          GError *error = NULL;
+          char *data;
+          gsize length;
+
+          data = g_key_file_to_data (perf_baseline, &length, NULL);
+          if (!g_file_set_contents (arg_perf_baseline, data, length, &error))
+            {
+              g_print ("could not save baseline: %s\n", error->message);
+              g_error_free (error);
+              result = 1;
+            }
+          g_free (data);
+        }
+
+      g_key_file_free (perf_baseline);
+    }
+
+  return result;
 }
 